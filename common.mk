@@ -79,24 +79,92 @@ IMG_TYPE ?= BOOT
 
 # use SWAP_UPGRADE = 0 for overwrite only mode, secondary image is simply
 # copied to primary slot after successful validation.
-# SWAP based upgrade is not supported in this code example.
+# use SWAP_UPGRADE = 1 for swap using status partition mode, the images in the
+# primary and secondary slots are swapped and the new image is booted in test
+# mode. The CM4 user app confirms the image, otherwise it is reverted on the
+# next reset. SWAP based upgrade is supported only in 2M devices.
 SWAP_UPGRADE ?= 0
 
-# Set to 1 when MCUboot needs to support external flash for the secondary slot.
-# Using external flash is not supported in this code example.
-# Default location is internal flash.
+# use DIRECT_XIP = 1 to boot the newest valid image directly from the slot it
+# is stored in (MCUboot direct-XIP). No image is copied between the slots.
+# BOOT images are linked to run from the primary slot and UPGRADE images from
+# the secondary slot. SWAP_UPGRADE is not used in this mode.
+DIRECT_XIP ?= 0
+
+# Set to 1 to place the secondary slot in the external QSPI NOR flash (SMIF,
+# memory slot configured in design.cyqspi). The internal flash used by the
+# secondary slot is then given to the CM4 app. Only overwrite-only mode is
+# supported. Default location is internal flash.
 USE_EXT_FLASH ?= 0
 
+# Set to 1 to refuse images older than the ones already booted (rollback
+# protection). The user apps are signed with a security counter derived from
+# their version (imgtool "-s auto"). The bootloader records the counter of
+# each image it boots in the protected storage and refuses images with a
+# lower counter. Once enabled, an older image can no longer be programmed or
+# transferred. Default is 0: any version can be installed.
+ROLLBACK_PROT ?= 0
+
+ifeq ($(ROLLBACK_PROT), 1)
+DEFINES+=MCUBOOT_HW_ROLLBACK_PROT
+endif
+
+# Set to 1 to transfer the DFU images encrypted. The CYACD2 files are
+# encrypted with AES-CTR using a random key per image, which is wrapped with
+# the key-encryption key (user key #1 of the bootloader secure key storage).
+# The CM0+ app unwraps the key for the CM4 app, which decrypts each row before
+# it is written.
+DFU_ENCRYPTION ?= 0
+
+# Key-encryption key in hex. It must match user key #1 in
+# proj_btldr_cm0p/source/cy_ps_keystorage.c. Both are all zeros by default,
+# which the build refuses with DFU_ENCRYPTION=1: provision your own key.
+DFU_KEK ?= 00000000000000000000000000000000
+
+ifeq ($(DFU_ENCRYPTION), 1)
+ifeq ($(subst 0,,$(DFU_KEK)),)
+$(error DFU_KEK is all zeros. Provision user key #1 in proj_btldr_cm0p/source/cy_ps_keystorage.c and set DFU_KEK to the same key)
+endif
+DEFINES+=DFU_ENCRYPTION
+endif
+
+# Set to 1 to send the hashes of the image chunks ahead of the image in the
+# DFU transfer. The CM4 app checks each chunk as soon as it is written, instead
+# of the whole image at the end. The Merkle root of the chunk hashes is signed
+# into the image. DFU_CHUNK_SIZE is the chunk size in bytes, a multiple of the
+# flash row size.
+DFU_CHUNK_HASH ?= 0
+DFU_CHUNK_SIZE ?= 4096
+
+ifeq ($(DFU_CHUNK_HASH), 1)
+DEFINES+=DFU_CHUNK_HASH
+endif
+
 # Use hardware accelerated Crypto for MbedTLS
 USE_CRYPTO_HW ?= 1
 
 # Override the default flash map used by MCUBoot
 DEFINES+=CY_FLASH_MAP_EXT_DESC
 
+# SMIF slave select of the external flash used when USE_EXT_FLASH=1, as used
+# by qspi_init_sfdp() (1 = slave select 0). The location of the secondary slot
+# in the external flash is part of the memory layout, see below.
+EXT_FLASH_SMIF_ID=1
+
+ifeq ($(USE_EXT_FLASH), 1)
+DEFINES+=CY_BOOT_USE_EXTERNAL_FLASH \
+         CY_BOOT_EXTERNAL_SMIF_ID=$(EXT_FLASH_SMIF_ID)
+endif
+
 # Add appropriate defines based on SWAP type.
-# Only SWAP using overwrite is supported in this code example
-ifeq ($(SWAP_UPGRADE), 0)
+# Only swap using status partition can be used with PSoC 6, see README.md
+ifeq ($(DIRECT_XIP), 1)
+DEFINES+=MCUBOOT_DIRECT_XIP
+else ifeq ($(SWAP_UPGRADE), 0)
 DEFINES+=MCUBOOT_OVERWRITE_ONLY
+else
+DEFINES+=MCUBOOT_SWAP_USING_SCRATCH=1 \
+         MCUBOOT_SWAP_USING_STATUS=1
 endif
 
 # Name of the key file, used in two places. 
@@ -107,8 +175,9 @@ endif
 SIGN_KEY_FILE_ECC=cypress-test-ec-p256
 
 # Name of the key file, used in one place. 
-# 1. Part of cy_ps_key_storage.c file and used for bootloader app validation
-#    by the flashboot.
+# 1. Converted to the public key of cy_ps_key_storage.c file by the bootloader
+#    app build (keys/cy_ps_public_key.h) and used for bootloader app
+#    validation by the flashboot.
 # 2. Passed as a parameter to the cymcuelftool module for signing the image
 #    using RSA in the bootloader app Makefile. The path of this key file is 
 #    set in the CM4 user app Makefile. 
@@ -120,20 +189,9 @@ SIGN_KEY_FILE_RSA=cypress-test-rsa-2048
 # Ensure that the values have no trailing white space. Linker will throw error
 # otherwise. 
 
-# The bootloader app is run by CM0+. Therefore, the scratch size and the
-# bootloader size are used with the linker script for the bootloader app. 
-# The slot sizes (primary, secondary) are used with the linker script
-# for the user apps run by CM0+ and CM4 CPUs. 
-
-# Default Flash and SRAM beginning 
-START_OF_FLASH=0x10000000
-START_OF_SRAM=0x08000000
-
-# Bootloader size = 112K
-CM0P_BTLDR_FLASH_SIZE=0x1C000
-
-# Protected Storage size = 16K
-PROTECTED_MEM_SIZE=0x4000
+# Size of the data handed over by the bootloader to the user apps = 2K
+# It is placed at the start of the shared SRAM.
+BOOT_SHARED_SRAM_SIZE=0x800
 
 SUPPORTED_TARGETS=CY8CPROTO-062S3-4343W CY8CKIT-062-WIFI-BT CY8CKIT-062-BLE CY8CPROTO-063-BLE \
                   CY8CPROTO-062-4343W CY8CKIT-062S2-43012
@@ -143,89 +201,52 @@ $(error Unsupported target. Please add the respective configuration for your BSP
 Additionally, add linker scripts inside the "shared/linker_script" folder for your BSP)
 endif
 
-# Flash and RAM size for MCUBoot Bootloader app run by CM0+
-ifeq ($(RENAMED_TARGET), CY8CPROTO-062S3-4343W)
-# CM0P App Flash Size = 64K
-# CM4 App Flash Size = 128K
-# CM0P Bootloader / App SRAM Size = 64K
-# Shared SRAM Size = 32K
-# CM4 App SRAM Size = 158K (160KB - 2KB reserved for system use) 
-CM0P_APP_FLASH_SIZE=0x10000
-CM4_APP_FLASH_SIZE=0x20000
-CM0P_BTLDR_SRAM_SIZE=0x10000
-CM0P_APP_SRAM_SIZE=0x10000
-SHARED_SRAM_SIZE=0x8000
-CM4_APP_SRAM_SIZE=0x27800
-endif
-ifeq ($(RENAMED_TARGET), $(filter $(RENAMED_TARGET), CY8CKIT-062-WIFI-BT CY8CKIT-062-BLE CY8CPROTO-063-BLE))
-# CM0P App Flash Size = 128K
-# CM4 App Flash Size = 320K
-# CM0P Bootloader / App SRAM Size = 64K
-# Shared SRAM Size = 32K
-# CM4 App SRAM Size = 158K (160KB - 2KB reserved for system use) 
-CM0P_APP_FLASH_SIZE=0x20000
-CM4_APP_FLASH_SIZE=0x50000
-CM0P_BTLDR_SRAM_SIZE=0x10000
-CM0P_APP_SRAM_SIZE=0x10000
-SHARED_SRAM_SIZE=0x8000
-CM4_APP_SRAM_SIZE=0x27800
-endif
-ifeq ($(RENAMED_TARGET), $(filter $(RENAMED_TARGET), CY8CPROTO-062-4343W CY8CKIT-062S2-43012))
-# CM0P App Flash Size = 128K
-# CM4 App Flash Size = 768K
-# CM0P Bootloader / App SRAM Size = 192K
-# Shared SRAM Size = 64K
-# CM4 App SRAM Size = 766K (768KB - 2KB reserved for system use)
-CM0P_APP_FLASH_SIZE=0x20000
-CM4_APP_FLASH_SIZE=0xC0000
-CM0P_BTLDR_SRAM_SIZE=0x30000
-CM0P_APP_SRAM_SIZE=0x30000
-SHARED_SRAM_SIZE=0x10000
-CM4_APP_SRAM_SIZE=0xBF800
-
-# Size of the scratch area used by MCUboot while swapping the image between
-# primary slot and secondary slot. Although defined, the SWAP using status
-# is not supported in this code example. It is left to the user to 
-# implement the same. 
-MCUBOOT_SCRATCH_SIZE=0x20000
-endif
-
-# Variables for flash start addresses. Note: Use ":=" to request make to evalulate
-# math expressions only once.
-CM0P_BTLDR_FLASH_START:=$(START_OF_FLASH)
-PROTECTED_MEM_START:=$(shell expr $$(( $(CM0P_BTLDR_FLASH_START) + $(CM0P_BTLDR_FLASH_SIZE) )) )
-CM0P_APP_FLASH_START:=$(shell expr $$(( $(PROTECTED_MEM_START) + $(PROTECTED_MEM_SIZE) )) )
-CM4_APP_FLASH_START:=$(shell expr $$(( $(CM0P_APP_FLASH_START) + $(CM0P_APP_FLASH_SIZE) )) )
-
-# Variables for SRAM start addresses
-CM0P_BTLDR_SRAM_START:=$(START_OF_SRAM)
-CM0P_APP_SRAM_START:=$(START_OF_SRAM)
-SHARED_SRAM_START:=$(shell expr $$(( $(START_OF_SRAM) + $(CM0P_APP_SRAM_SIZE))) )
-CM4_APP_SRAM_START:=$(shell expr $$(( $(SHARED_SRAM_START) + $(SHARED_SRAM_SIZE) )) )
-
-# Slot size includes the flash size of both the CM0P App and the CM4 App
-# One slot = MCUboot Header + App + TLV + Trailer (Trailer is not present for BOOT image)
-# The slot size should be:  (Total_Flash - BOOTLOADER_APP_FLASH_SIZE)/2 rounded down to nearest 512 bytes.
-# The RAM size of the User App is set in the linker script as given below.
-#   - The CM0p SRAM is reused between bootloader the CM0p user app
-#     CM0p RAM size = CM0P_APP_SRAM_SIZE = CM0P_BTLDR_SRAM_SIZE
-#   - CM4 RAM size = Total RAM available - 2 KB reserved for system use - CM0P_APP_SRAM_SIZE.
-MCUBOOT_SLOT_SIZE:=$(shell expr $$(( $(CM0P_APP_FLASH_SIZE) + $(CM4_APP_FLASH_SIZE) )) )
-
-# Total flash size = App1 size + App2 size
-TOTAL_APP_FLASH_SIZE:=$(shell expr $$(( $(MCUBOOT_SLOT_SIZE)*2)) )
-
-# Slot addresses and sizes needed by MCUBoot
-MCUBOOT_PRIMARY_SLOT_START_ADDR:=$(CM0P_APP_FLASH_START)
-MCUBOOT_SECONDARY_SLOT_START_ADDR:=$(shell expr $$(( $(CM0P_APP_FLASH_START) + $(MCUBOOT_SLOT_SIZE) )) )
-
-# Scratch start address needed for SWAP mode in 2M devices 
-# Note: SWAP is only supported in 2M devices
-ifeq ($(RENAMED_TARGET), $(filter $(RENAMED_TARGET), CY8CPROTO-062-4343W CY8CKIT-062S2-43012))
-MCUBOOT_SCRATCH_START_ADDR:=$(shell expr $$(( $(MCUBOOT_SECONDARY_SLOT_START_ADDR) + $(MCUBOOT_SLOT_SIZE) )) )
+# Memory layout of the target: flash and SRAM regions, MCUboot slots and the
+# SMPU configs of the bootloader. It is described in
+# shared/layout/TARGET_<target>/layout.json and generated from this
+# description into layout.mk (included below) and cy_ps_layout.h by
+# proj_btldr_cm0p/scripts/gen_layout.py. Run the script again after editing
+# the description; the bootloader pre-build step fails if the generated files
+# are out of date. See README.md.
+#
+# The regions are placed in the order of the description. The CM4 app flash
+# and SRAM are grown to use the space left, as long as every region protected
+# by the SMPU can still be described by its SMPU structs. With
+# USE_EXT_FLASH=1, the secondary slot is placed in the external flash and the
+# CM4 app gets the internal flash it used. The scratch area and swap status
+# partition of 2M devices stay reserved at the end of the flash.
+#
+# layout.mk sets:
+#   START_OF_FLASH, DEVICE_FLASH_SIZE, START_OF_SRAM, DEVICE_SRAM_SIZE
+#   CM0P_BTLDR_FLASH_START/SIZE, PROTECTED_MEM_START/SIZE,
+#   CM0P_APP_FLASH_START/SIZE, CM4_APP_FLASH_START/SIZE
+#   CM0P_BTLDR_SRAM_START/SIZE, CM0P_APP_SRAM_START/SIZE,
+#   SHARED_SRAM_START/SIZE, CM4_APP_SRAM_START/SIZE
+#   MCUBOOT_SLOT_SIZE - One slot = CM0P app + CM4 app
+#                       = MCUboot Header + App + TLV + Trailer
+#   MCUBOOT_PRIMARY_SLOT_START_ADDR, MCUBOOT_SECONDARY_SLOT_START_ADDR
+#   CM4_APP_SECONDARY_FLASH_START - CM4 app in the secondary slot
+#   MCUBOOT_SCRATCH_START_ADDR/SIZE, MCUBOOT_SWAP_STATUS_START_ADDR/SIZE
+#     - 2M devices only
+#   EXT_FLASH_START, EXT_FLASH_ERASE_SIZE, EXT_FLASH_SECONDARY_OFFSET
+#   MCUBOOT_HEADER_SIZE, MCUBOOT_MAX_IMG_SECTORS
+LAYOUT_DIR=../shared/layout/TARGET_$(RENAMED_TARGET)
+include $(LAYOUT_DIR)/layout.mk
+
+# Flash addresses the user apps are linked at. In direct-XIP mode, UPGRADE 
+# images run from the secondary slot, so the primary slot becomes the slot
+# that the DFU writes to.
+ifeq ($(DIRECT_XIP)$(IMG_TYPE), 1UPGRADE)
+CM0P_APP_LINK_START:=$(MCUBOOT_SECONDARY_SLOT_START_ADDR)
+CM4_APP_LINK_START:=$(CM4_APP_SECONDARY_FLASH_START)
+UPDATE_SLOT_LINK_START:=$(MCUBOOT_PRIMARY_SLOT_START_ADDR)
+else
+CM0P_APP_LINK_START:=$(CM0P_APP_FLASH_START)
+CM4_APP_LINK_START:=$(CM4_APP_FLASH_START)
+UPDATE_SLOT_LINK_START:=$(MCUBOOT_SECONDARY_SLOT_START_ADDR)
 endif
 
-# MCUBoot header size
+# MCUBOOT_HEADER_SIZE (layout.json)
 # Must be a multiple of 1024 because of the following reason. 
 # CM0p image starts right after the header and the CM0p image begins with the
 # interrupt vector table. The starting address of the table must be 1024-bytes
@@ -240,69 +261,93 @@ endif
 # 2. Passed to the imgtool while signing the image. The imgtool fills the space
 # of this size with zeroes and then adds the actual header from the beginning of
 # the image.
-MCUBOOT_HEADER_SIZE=0x400 
 
-# Maximum number of flash sectors (or rows) per image slot.
-# The maximum number of flash sectors for which swap status is tracked in
-# the image trailer. 
+# MCUBOOT_MAX_IMG_SECTORS (layout.mk)
+# Maximum number of flash sectors (or rows) per image slot for which swap
+# status is tracked in the image trailer: MCUBOOT_SLOT_SIZE/512 (PSoC 6 flash
+# row size), at least 32 (minimum accepted by the MCUBoot Library).
 # In the bootloader app, this value is used in DEFINE+= to override the macro
 # with the same name in "mcuboot/boot/cypress/MCUBootApp/config/mcuboot_config/mcuboot_config.h".
 # In the user app, this value is passed with "-M" option to the imgtool while 
 # signing the image. imgtool adds padding in the trailer area
 # depending on this value. 
-# This value can be simply set to MCUBOOT_SLOT_SIZE/FLASH_ROW_SIZE.
-# For PSoC 6, FLASH_ROW_SIZE=512 bytes.
-MCUBOOT_SECTOR_SIZE = 512
-
-# Minimum number of sectors accecpted by MCUBoot Library is 32
-MIN_IMG_SECTORS = 32
-
-# Number of flash sectors per image slot
-FLASH_IMG_SECTORS:= $(shell expr $$(( $(MCUBOOT_SLOT_SIZE) / $(MCUBOOT_SECTOR_SIZE) )) )
-
-# Maximum number of flash sectors (or rows) per image slot.
-MCUBOOT_MAX_IMG_SECTORS:= $(shell expr $$(( $(MIN_IMG_SECTORS) > $(FLASH_IMG_SECTORS) ? $(MIN_IMG_SECTORS) : $(FLASH_IMG_SECTORS) )) )
 
 # Number of images supported in case of multi-image bootloading. 
-# This application supports only up to 1 image.
+#   1 - The CM0p app and the CM4 app are signed and updated as one image.
+#   2 - The CM0p app (image 1) and the CM4 app (image 2) are signed and
+#       updated separately. Each image has its own primary and secondary slot
+#       and starts with its own MCUboot header. The secondary slots keep the
+#       same order as the primary slots.
 MCUBOOT_IMAGE_NUMBER ?= 1
 
+ifeq ($(MCUBOOT_IMAGE_NUMBER), 1)
+MCUBOOT_IMG1_SLOT_SIZE:=$(MCUBOOT_SLOT_SIZE)
+# The CM4 app directly follows the CM0p app inside the single image
+CM4_APP_HEADER_SIZE:=0
+else ifeq ($(MCUBOOT_IMAGE_NUMBER), 2)
+MCUBOOT_IMG1_SLOT_SIZE:=$(CM0P_APP_FLASH_SIZE)
+MCUBOOT_IMG2_SLOT_SIZE:=$(CM4_APP_FLASH_SIZE)
+MCUBOOT_IMG2_PRIMARY_SLOT_START_ADDR:=$(CM4_APP_FLASH_START)
+MCUBOOT_IMG2_SECONDARY_SLOT_START_ADDR:=$(CM4_APP_SECONDARY_FLASH_START)
+# The CM4 app image starts with its own MCUboot header
+CM4_APP_HEADER_SIZE:=$(MCUBOOT_HEADER_SIZE)
+ifeq ($(DIRECT_XIP), 1)
+$(error DIRECT_XIP is not supported with MCUBOOT_IMAGE_NUMBER=2)
+endif
+else
+$(error MCUBOOT_IMAGE_NUMBER must be 1 or 2)
+endif
+
 # The following defines describe the flash map used by MCUBoot
 DEFINES+=TARGET=$(RENAMED_TARGET) \
          CY_BOOT_BOOTLOADER_SIZE=$(CM0P_BTLDR_FLASH_SIZE) \
          CY_BOOT_PRIMARY_1_START_ADDRESS=$(MCUBOOT_PRIMARY_SLOT_START_ADDR) \
-         CY_BOOT_PRIMARY_1_SIZE=$(MCUBOOT_SLOT_SIZE) \
+         CY_BOOT_PRIMARY_1_SIZE=$(MCUBOOT_IMG1_SLOT_SIZE) \
          CY_BOOT_SECONDARY_1_START_ADDRESS=$(MCUBOOT_SECONDARY_SLOT_START_ADDR) \
-         CY_BOOT_SECONDARY_1_SIZE=$(MCUBOOT_SLOT_SIZE) \
+         CY_BOOT_SECONDARY_1_SIZE=$(MCUBOOT_IMG1_SLOT_SIZE) \
          CM0P_APP_FLASH_START=$(CM0P_APP_FLASH_START) \
          CM4_APP_FLASH_START=$(CM4_APP_FLASH_START) \
          PROTECTED_MEM_START=$(PROTECTED_MEM_START) \
+         PROTECTED_MEM_SIZE=$(PROTECTED_MEM_SIZE) \
          MCUBOOT_HEADER_SIZE=$(MCUBOOT_HEADER_SIZE) \
          CY_START_OF_FLASH=$(START_OF_FLASH) \
-         CY_START_OF_SRAM=$(SRAM_OF_FLASH) \
+         CY_START_OF_SRAM=$(START_OF_SRAM) \
          SHARED_SRAM_START=$(SHARED_SRAM_START) \
+         SHARED_SRAM_SIZE=$(SHARED_SRAM_SIZE) \
+         BOOT_SHARED_SRAM_SIZE=$(BOOT_SHARED_SRAM_SIZE) \
          CM4_APP_SRAM_START=$(CM4_APP_SRAM_START) \
          CM0P_BTLDR_SRAM_SIZE=$(CM0P_BTLDR_SRAM_SIZE)
          
-ifeq ($(RENAMED_TARGET), $(filter $(RENAMED_TARGET), CY8CPROTO-062-4343W CY8CKIT-062S2-43012))
+ifneq ($(MCUBOOT_SCRATCH_START_ADDR),)
 DEFINES+=CY_BOOT_SCRATCH_START_ADDRESS=$(MCUBOOT_SCRATCH_START_ADDR) \
-         CY_BOOT_SCRATCH_SIZE=$(MCUBOOT_SCRATCH_SIZE)
+         CY_BOOT_SCRATCH_SIZE=$(MCUBOOT_SCRATCH_SIZE) \
+         CY_BOOT_SWAP_STATUS_START_ADDRESS=$(MCUBOOT_SWAP_STATUS_START_ADDR) \
+         CY_BOOT_SWAP_STATUS_SIZE=$(MCUBOOT_SWAP_STATUS_SIZE)
+endif
+
+ifeq ($(MCUBOOT_IMAGE_NUMBER), 2)
+DEFINES+=CY_BOOT_PRIMARY_2_START_ADDRESS=$(MCUBOOT_IMG2_PRIMARY_SLOT_START_ADDR) \
+         CY_BOOT_PRIMARY_2_SIZE=$(MCUBOOT_IMG2_SLOT_SIZE) \
+         CY_BOOT_SECONDARY_2_START_ADDRESS=$(MCUBOOT_IMG2_SECONDARY_SLOT_START_ADDR) \
+         CY_BOOT_SECONDARY_2_SIZE=$(MCUBOOT_IMG2_SLOT_SIZE)
 endif
 
 # Toolchain specific linker flags
 ifeq ($(TOOLCHAIN), GCC_ARM)
 LDFLAGS+=-Wl,--defsym=ORIGIN_OF_FLASH=$(START_OF_FLASH),--defsym=ORIGIN_OF_SRAM=$(START_OF_SRAM)
 LDFLAGS+=-Wl,--defsym=CM0P_BTLDR_FLASH_SIZE=$(CM0P_BTLDR_FLASH_SIZE),--defsym=CM0P_APP_FLASH_SIZE=$(CM0P_APP_FLASH_SIZE),--defsym=CM4_APP_FLASH_SIZE=$(CM4_APP_FLASH_SIZE)
-LDFLAGS+=-Wl,--defsym=SECONDARY_SLOT_FLASH_START=$(MCUBOOT_SECONDARY_SLOT_START_ADDR)
-LDFLAGS+=-Wl,--defsym=PROT_STRG_SIZE=$(PROTECTED_MEM_SIZE),--defsym=PROTECTED_MEM_START=$(PROTECTED_MEM_START),--defsym=CM0P_APP_FLASH_START=$(CM0P_APP_FLASH_START)
-LDFLAGS+=-Wl,--defsym=CM4_APP_FLASH_START=$(CM4_APP_FLASH_START),--defsym=CM0P_BTLDR_SRAM_SIZE=$(CM0P_BTLDR_SRAM_SIZE),--defsym=CM0P_APP_SRAM_SIZE=$(CM0P_APP_SRAM_SIZE),--defsym=SHARED_SRAM_SIZE=$(SHARED_SRAM_SIZE),--defsym=CM4_APP_SRAM_SIZE=$(CM4_APP_SRAM_SIZE)
+LDFLAGS+=-Wl,--defsym=SECONDARY_SLOT_FLASH_START=$(UPDATE_SLOT_LINK_START)
+LDFLAGS+=-Wl,--defsym=PROT_STRG_SIZE=$(PROTECTED_MEM_SIZE),--defsym=PROTECTED_MEM_START=$(PROTECTED_MEM_START),--defsym=CM0P_APP_FLASH_START=$(CM0P_APP_LINK_START)
+LDFLAGS+=-Wl,--defsym=CM4_APP_FLASH_START=$(CM4_APP_LINK_START),--defsym=CM0P_BTLDR_SRAM_SIZE=$(CM0P_BTLDR_SRAM_SIZE),--defsym=CM0P_APP_SRAM_SIZE=$(CM0P_APP_SRAM_SIZE),--defsym=SHARED_SRAM_SIZE=$(SHARED_SRAM_SIZE),--defsym=CM4_APP_SRAM_SIZE=$(CM4_APP_SRAM_SIZE)
 LDFLAGS+=-Wl,--defsym=SHARED_SRAM_START=$(SHARED_SRAM_START),--defsym=CM4_APP_SRAM_START=$(CM4_APP_SRAM_START)
-LDFLAGS+=-Wl,--defsym=MCUBOOT_HEADER_SIZE=$(MCUBOOT_HEADER_SIZE)
+LDFLAGS+=-Wl,--defsym=BOOT_SHARED_SRAM_SIZE=$(BOOT_SHARED_SRAM_SIZE)
+LDFLAGS+=-Wl,--defsym=MCUBOOT_HEADER_SIZE=$(MCUBOOT_HEADER_SIZE),--defsym=CM4_APP_HEADER_SIZE=$(CM4_APP_HEADER_SIZE)
 LDFLAGS+=-Wl,--defsym=MCUBOOT_SLOT_SIZE=$(MCUBOOT_SLOT_SIZE)
 LDFLAGS+=-Wl,--defsym=TOTAL_APP_FLASH_SIZE=$(TOTAL_APP_FLASH_SIZE)
 
-ifeq ($(RENAMED_TARGET), $(filter $(RENAMED_TARGET), CY8CPROTO-062-4343W CY8CKIT-062S2-43012))
+ifneq ($(MCUBOOT_SCRATCH_START_ADDR),)
 LDFLAGS+=-Wl,--defsym=MCUBOOT_SCRATCH_START_ADDR=$(MCUBOOT_SCRATCH_START_ADDR),--defsym=MCUBOOT_SCRATCH_SIZE=$(MCUBOOT_SCRATCH_SIZE)
+LDFLAGS+=-Wl,--defsym=MCUBOOT_SWAP_STATUS_START_ADDR=$(MCUBOOT_SWAP_STATUS_START_ADDR),--defsym=MCUBOOT_SWAP_STATUS_SIZE=$(MCUBOOT_SWAP_STATUS_SIZE)
 endif
 
 else
@@ -310,9 +355,27 @@ $(error Only GCC_ARM is supported at this moment)
 endif
 
 # Check if SWAP upgrade is being requested on unsupported parts
+ifeq ($(DIRECT_XIP)$(SWAP_UPGRADE), 11)
+$(error SWAP_UPGRADE and DIRECT_XIP cannot be used together. Set one of them to 0)
+endif
+ifeq ($(USE_EXT_FLASH), 1)
+ifneq ($(SWAP_UPGRADE)$(DIRECT_XIP), 00)
+$(error USE_EXT_FLASH supports only the overwrite-only mode. Set SWAP_UPGRADE and DIRECT_XIP to 0)
+endif
+ifeq ($(MCUBOOT_IMAGE_NUMBER), 2)
+$(error USE_EXT_FLASH supports only MCUBOOT_IMAGE_NUMBER=1)
+endif
+# A chunk sent again after a hash mismatch would be programmed over the rows
+# already in the external flash, whose erase sectors are larger than a chunk
+ifeq ($(DFU_CHUNK_HASH), 1)
+$(error USE_EXT_FLASH does not support DFU_CHUNK_HASH. Set DFU_CHUNK_HASH to 0)
+endif
+endif
 ifeq ($(SWAP_UPGRADE), 1)
-$(error SWAP Upgrade feature is not supported in this code example. It is left to the users to implement it.\
+ifeq ($(MCUBOOT_SCRATCH_START_ADDR),)
+$(error SWAP Upgrade feature is supported only in 2M devices as the other devices have no space left for the scratch area.\
 Refer to the README.md file for more information.)
 endif
+endif
 
 include ../common_app.mk
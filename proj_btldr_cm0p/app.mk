@@ -46,16 +46,17 @@ INCLUDES+=\
 MCUBOOT_CY_PATH=$(MCUBOOT_PATH)/boot/cypress
 MCUBOOTAPP_PATH=$(MCUBOOT_CY_PATH)/MCUBootApp
 
+# The security counter hooks of MCUBootApp (cy_security_cnt.c) are replaced by
+# source/cy_ps_security_cnt.c, which keeps the counters in the protected storage.
 SOURCES+=\
     $(wildcard $(MCUBOOT_PATH)/boot/bootutil/src/*.c)\
     $(wildcard $(MCUBOOT_CY_PATH)/cy_flash_pal/flash_psoc6/cy_flash_map.c)\
     $(MCUBOOT_CY_PATH)/libs/retarget_io_pdl/cy_retarget_io_pdl.c\
     $(MCUBOOT_CY_PATH)/libs/watchdog/watchdog.c\
-    $(MCUBOOTAPP_PATH)/cy_security_cnt.c\
     $(MCUBOOTAPP_PATH)/keys.c
 
 # Do not include QSPI API from flash PAL when external flash is not used.
-ifeq ($(USE_EXTERNAL_FLASH), 1)  
+ifeq ($(USE_EXT_FLASH), 1)
 SOURCES+=\
     $(wildcard $(MCUBOOT_CY_PATH)/cy_flash_pal/flash_psoc6/cy_smif_psoc6.c)\
     $(wildcard $(MCUBOOT_CY_PATH)/cy_flash_pal/flash_psoc6/flash_qspi/*.c)
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import re
+import struct
+
+from elftools.elf.elffile import ELFFile
+
+# This script rebuilds the deferred bootloader log messages (CY_PS_BOOT_LOG)
+# of a bootloader built with BOOT_LOG_DEFERRED=1. The boot log record is printed as a "BOOT_LOG:<hex>" line by the CM4 user
+# application, or by the bootloader when it finds no bootable image. Each
+# entry holds a token, which is the offset of the format string in the
+# .cy_ps_log_fmt section of the bootloader ELF file, and the argument words.
+# With --baud, the script also reports what the messages would cost in a
+# BOOT_LOG_DEFERRED=0 build, which prints them synchronously on the debug
+# UART while the device boots, and the size of the format strings that the
+# deferred build does not program.
+# Example Usage:
+# boot_log.py build/CY8CPROTO-062-4343W/Debug/proj_btldr_cm0p.elf boot.log
+# boot_log.py build/CY8CPROTO-062-4343W/Debug/proj_btldr_cm0p.elf boot.log --baud 115200
+
+RECORD_PREFIX = "BOOT_LOG:"
+FMT_SECTION = ".cy_ps_log_fmt"
+
+# Must match cy_ps_boot_shared.h
+BOOT_LOG_MAGIC = 0x474F4C42
+BOOT_LOG_VERSION = 1
+BOOT_LOG_HEADER = struct.Struct("<IHHI")
+BOOT_LOG_TOKEN_MASK = 0x00FFFFFF
+BOOT_LOG_NARGS_POS = 24
+
+# Bytes BOOT_LOG_INF adds to each message ("[INF] " and the line end), and
+# bits per byte on the UART (8N1)
+SYNC_LOG_OVERHEAD = 8
+UART_BITS_PER_BYTE = 10
+
+# printf conversion specification, length modifiers are dropped
+SPEC_RE = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|j|z|t)?([diuxXocp%])")
+
+
+def read_strings(elf_path=str):
+    """Read the log format strings from the bootloader ELF file
+
+    Args:
+        elf_path: bootloader ELF file
+
+    Returns:
+        bytes: content of the format string section
+    """
+    with open(elf_path, "rb") as elf_file:
+        section = ELFFile(elf_file).get_section_by_name(FMT_SECTION)
+        if section is None:
+            raise ValueError(f"{elf_path} has no {FMT_SECTION} section")
+        return section.data()
+
+
+def format_message(fmt=str, args=list):
+    """Format a log message like the C printf
+
+    Args:
+        fmt: printf format string
+        args: 32-bit argument words
+
+    Returns:
+        str: formatted message
+    """
+    values = iter(args)
+
+    def convert(match):
+        flags, conv = match.groups()
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "p":
+            flags, conv = "#010", "x"
+        return f"%{flags}{conv}" % value
+
+    return SPEC_RE.sub(convert, fmt)
+
+
+def decode_record(raw=bytes, strings=bytes):
+    """Decode one boot log record
+
+    Args:
+        raw: record bytes
+        strings: content of the format string section
+
+    Returns:
+        list: log messages
+    """
+    magic, version, count, dropped = BOOT_LOG_HEADER.unpack_from(raw)
+    if magic != BOOT_LOG_MAGIC or version != BOOT_LOG_VERSION:
+        raise ValueError(f"Unsupported record: magic 0x{magic:08X}, version {version}")
+
+    words = struct.unpack_from(f"<{count}I", raw, BOOT_LOG_HEADER.size)
+    messages = list()
+    pos = 0
+    while pos < count:
+        token = words[pos] & BOOT_LOG_TOKEN_MASK
+        nargs = words[pos] >> BOOT_LOG_NARGS_POS
+        args = words[pos + 1:pos + 1 + nargs]
+        pos += 1 + nargs
+
+        end = strings.find(b"\0", token)
+        if token >= len(strings) or end < 0:
+            messages.append(f"<unknown token 0x{token:06X}> {' '.join(f'0x{a:08X}' for a in args)}")
+        else:
+            messages.append(format_message(strings[token:end].decode(errors="replace"), args))
+
+    if dropped:
+        messages.append(f"<{dropped} message(s) dropped>")
+    return messages
+
+
+def print_cost(messages, record_size, strings, baud):
+    """Print the synchronous UART cost of the messages of one boot
+
+    Args:
+        messages: log messages of the boot
+        record_size: size of the boot log record in bytes
+        strings: content of the format string section
+        baud: debug UART baud rate
+    """
+    sync_bytes = sum(len(message) + SYNC_LOG_OVERHEAD for message in messages)
+    sync_ms = sync_bytes * UART_BITS_PER_BYTE * 1000.0 / baud
+    line_bytes = len(RECORD_PREFIX) + 2 * record_size + 2
+    print(f"  {len(messages)} messages, {sync_bytes} bytes, {sync_ms:.1f} ms on the boot path "
+          f"when printed synchronously at {baud} baud")
+    print(f"  Deferred: {record_size}-byte record, printed later by the CM4 as a {line_bytes}-byte line; "
+          f"{len(strings)} bytes of format strings not programmed")
+
+
+def decode(elf_path, log_path, baud):
+    strings = read_strings(elf_path)
+    found = False
+    with open(log_path, "r", errors="ignore") as log:
+        for line in log:
+            pos = line.find(RECORD_PREFIX)
+            if pos >= 0:
+                found = True
+                raw = bytes.fromhex(line[pos + len(RECORD_PREFIX):].strip())
+                messages = decode_record(raw, strings)
+                for message in messages:
+                    print(f"[INF] {message}")
+                if baud:
+                    print_cost(messages, len(raw), strings, baud)
+
+    if not found:
+        raise ValueError(f"No boot log record found in {log_path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the deferred bootloader log")
+    parser.add_argument("elf", help="Bootloader ELF file the device was programmed with")
+    parser.add_argument("log", help="Serial terminal log")
+    parser.add_argument("--baud", type=int, default=0,
+                        help="Also report the UART time of the messages in a synchronous build at this baud rate")
+
+    args = parser.parse_args()
+    decode(args.elf, args.log, args.baud)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import struct
+
+# This script decodes the boot timing records printed by the CM4 user
+# application ("BOOT_TIMING:<hex>" lines) from a serial terminal log, and
+# compares the phase durations of two logs, e.g. captured with two builds.
+# Every boot found in a log is decoded and the durations are averaged.
+# Example Usage:
+# boot_timing.py decode boot.log
+# boot_timing.py compare baseline.log new.log
+
+RECORD_PREFIX = "BOOT_TIMING:"
+
+# Must match cy_ps_boot_shared.h
+BOOT_TIMING_MAGIC = 0x54544F42
+BOOT_TIMING_VERSION = 1
+BOOT_TIMING_HEADER = struct.Struct("<IHHI")
+BOOT_TIMING_MARK = struct.Struct("<II")
+PHASE_NAMES = ["init", "efuse", "prot_units", "boot_go", "do_boot"]
+
+
+def decode_record(raw=bytes):
+    """Decode one boot timing record
+
+    Args:
+        raw: record bytes
+
+    Returns:
+        list: (phase name, phase duration in us) tuples
+    """
+    magic, version, count, clock_hz = BOOT_TIMING_HEADER.unpack_from(raw)
+    if magic != BOOT_TIMING_MAGIC or version != BOOT_TIMING_VERSION:
+        raise ValueError(f"Unsupported record: magic 0x{magic:08X}, version {version}")
+
+    phases = list()
+    prev_ticks = 0
+    for i in range(count):
+        phase, ticks = BOOT_TIMING_MARK.unpack_from(
+            raw, BOOT_TIMING_HEADER.size + i * BOOT_TIMING_MARK.size)
+        name = PHASE_NAMES[phase] if phase < len(PHASE_NAMES) else f"phase{phase}"
+        phases.append((name, (ticks - prev_ticks) * 1e6 / clock_hz))
+        prev_ticks = ticks
+    return phases
+
+
+def read_log(path=str):
+    """Decode all boot timing records in a log and average them per phase
+
+    Args:
+        path: serial terminal log file
+
+    Returns:
+        tuple: number of boots, dict of phase name to average duration in us
+    """
+    records = list()
+    with open(path, "r", errors="ignore") as log:
+        for line in log:
+            pos = line.find(RECORD_PREFIX)
+            if pos >= 0:
+                hex_str = line[pos + len(RECORD_PREFIX):].strip()
+                records.append(decode_record(bytes.fromhex(hex_str)))
+
+    if not records:
+        raise ValueError(f"No boot timing record found in {path}")
+
+    totals = dict()
+    for record in records:
+        for name, duration in record:
+            totals[name] = totals.get(name, 0.0) + duration
+    return len(records), {name: total / len(records) for name, total in totals.items()}
+
+
+def decode(log_file):
+    boots, phases = read_log(log_file)
+    print(f"{log_file}: {boots} boot(s)")
+    print(f"{'Phase':<12} {'Time (us)':>12}")
+    for name, duration in phases.items():
+        print(f"{name:<12} {duration:>12.1f}")
+    print(f"{'total':<12} {sum(phases.values()):>12.1f}")
+
+
+def compare(base_file, new_file):
+    base_boots, base = read_log(base_file)
+    new_boots, new = read_log(new_file)
+    print(f"base: {base_file} ({base_boots} boot(s)), new: {new_file} ({new_boots} boot(s))")
+    print(f"{'Phase':<12} {'Base (us)':>12} {'New (us)':>12} {'Delta (us)':>12} {'Delta':>8}")
+
+    names = list(base) + [name for name in new if name not in base]
+    rows = [(name, base.get(name, 0.0), new.get(name, 0.0)) for name in names]
+    rows.append(("total", sum(base.values()), sum(new.values())))
+    for name, base_us, new_us in rows:
+        delta = new_us - base_us
+        percent = f"{delta * 100 / base_us:+.1f}%" if base_us else "n/a"
+        print(f"{name:<12} {base_us:>12.1f} {new_us:>12.1f} {delta:>+12.1f} {percent:>8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode and compare bootloader phase timing")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    decode_parser = subparsers.add_parser("decode", help="Print the phase timing of a log")
+    decode_parser.add_argument("log", help="Serial terminal log")
+
+    compare_parser = subparsers.add_parser("compare", help="Compare the phase timing of two logs")
+    compare_parser.add_argument("base", help="Serial terminal log of the baseline build")
+    compare_parser.add_argument("new", help="Serial terminal log of the new build")
+
+    args = parser.parse_args()
+    if args.command == "decode":
+        decode(args.log)
+    else:
+        compare(args.base, args.new)
+
+
+if __name__ == "__main__":
+    main()
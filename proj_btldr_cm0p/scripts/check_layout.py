@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import sys
+
+# This script checks a flash layout. gen_layout.py uses it to check every
+# layout it generates; it can also be run on its own to try out a custom
+# layout. It prints the layout and fails if an area is outside
+# the flash, is not row aligned or overlaps another area, if the slots of an
+# image are not usable by MCUboot, or if a region protected by the SMPU cannot
+# be described by one SMPU region. Areas in the external flash must start on
+# an erase sector instead.
+# Addresses and sizes are given as "start,size" in decimal or hex.
+# Example Usage:
+# check_layout.py --flash 0x10000000,0x100000 --header 0x400 \
+#     --area bootloader,0x10000000,0x1C000 \
+#     --image 0x10020000,0x10090000,0x70000 \
+#     --smpu cm0p_app,0x10020000,0x20000
+# check_layout.py --flash 0x10000000,0x100000 --header 0x400 \
+#     --image 0x10050000,0x18000000,0xB0000 --ext-flash 0x18000000,0x40000
+
+# PSoC 6 flash row size in bytes
+FLASH_ROW_SIZE = 512
+
+# The CM0+ and CM4 vector tables placed right after the MCUboot header must
+# be 1024 bytes aligned
+HEADER_ALIGN = 1024
+
+# Smallest SMPU region
+SMPU_MIN_REGION_SIZE = 256
+
+
+def parse_numbers(text=str, count=int):
+    """Split a comma separated list of numbers
+
+    Args:
+        text: argument value
+        count: expected number of values
+
+    Returns:
+        list: values
+    """
+    values = text.split(",")
+    if len(values) != count:
+        raise argparse.ArgumentTypeError(f"Expected {count} values in '{text}'")
+    try:
+        return [int(value, 0) for value in values]
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"Invalid number in '{text}'")
+
+
+def parse_area(text=str):
+    """Split a name,start,size argument
+
+    Args:
+        text: argument value
+
+    Returns:
+        tuple: name, start, size
+    """
+    name, _, numbers = text.partition(",")
+    return (name, *parse_numbers(numbers, 2))
+
+
+def check_layout(flash=tuple, header_size=int, areas=list, images=list, smpu_regions=list, ext_flash=None):
+    """Check the flash layout
+
+    Args:
+        flash: (start, size) of the flash
+        header_size: MCUboot header size
+        areas: (name, start, size) of the areas that are not image slots
+        images: (primary start, secondary start, slot size) per image
+        smpu_regions: (name, start, size) of the regions protected by one SMPU region
+        ext_flash: (start, erase size) of the external flash, or None
+
+    Returns:
+        tuple: list of (name, start, size) sorted by address, list of errors
+    """
+    errors = list()
+    layout = list(areas)
+    for index, (primary, secondary, size) in enumerate(images, start=1):
+        layout.append((f"image{index}_primary", primary, size))
+        layout.append((f"image{index}_secondary", secondary, size))
+        if size <= header_size:
+            errors.append(f"image{index}: slot size 0x{size:X} does not hold the 0x{header_size:X} header")
+    layout.sort(key=lambda area: area[1])
+
+    flash_start, flash_size = flash
+    for name, start, size in layout:
+        if size == 0:
+            errors.append(f"{name}: empty area")
+        if start % FLASH_ROW_SIZE or size % FLASH_ROW_SIZE:
+            errors.append(f"{name}: not aligned to the {FLASH_ROW_SIZE} byte flash row")
+        if ext_flash and start >= ext_flash[0]:
+            if start % ext_flash[1]:
+                errors.append(f"{name}: 0x{start:08X} is not aligned to the 0x{ext_flash[1]:X} byte external erase sector")
+        elif start < flash_start or start + size > flash_start + flash_size:
+            errors.append(f"{name}: 0x{start:08X}-0x{start + size:08X} is outside the flash")
+
+    for (name, start, size), (next_name, next_start, _) in zip(layout, layout[1:]):
+        if start + size > next_start:
+            errors.append(f"{name} overlaps {next_name}")
+
+    if header_size % HEADER_ALIGN:
+        errors.append(f"header size 0x{header_size:X} is not a multiple of {HEADER_ALIGN}")
+
+    for name, start, size in smpu_regions:
+        if size < SMPU_MIN_REGION_SIZE or size & (size - 1):
+            errors.append(f"SMPU {name}: size 0x{size:X} is not a power of two of at least {SMPU_MIN_REGION_SIZE}")
+        elif start % size:
+            errors.append(f"SMPU {name}: start 0x{start:08X} is not aligned to its size 0x{size:X}")
+
+    return layout, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check the flash layout of the bootloader and user apps")
+    parser.add_argument("--flash", required=True, type=lambda text: parse_numbers(text, 2),
+                        help="Flash start,size")
+    parser.add_argument("--header", required=True, type=lambda text: int(text, 0),
+                        help="MCUboot header size")
+    parser.add_argument("--area", action="append", default=list(), type=parse_area,
+                        help="Area that is not an image slot: name,start,size")
+    parser.add_argument("--image", action="append", required=True, type=lambda text: parse_numbers(text, 3),
+                        help="MCUboot image slots: primary start,secondary start,slot size")
+    parser.add_argument("--smpu", action="append", default=list(), type=parse_area,
+                        help="Region protected by one SMPU region: name,start,size")
+    parser.add_argument("--ext-flash", type=lambda text: parse_numbers(text, 2),
+                        help="External flash start,erase sector size")
+    args = parser.parse_args()
+
+    layout, errors = check_layout(args.flash, args.header, args.area, args.image, args.smpu, args.ext_flash)
+
+    print(f"{'Area':<20} {'Start':>10} {'End':>10} {'Size':>10}")
+    for name, start, size in layout:
+        print(f"{name:<20} 0x{start:08X} 0x{start + size:08X} 0x{size:08X}")
+
+    for error in errors:
+        print(f"Layout error: {error}", file=sys.stderr)
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import hashlib
+import struct
+
+from intelhex import IntelHex
+
+# This script creates the chunk hashes of an image for the DFU
+# (DFU_CHUNK_HASH=1). The image payload is split in chunks, and the chunk
+# hashes are the leaves of a Merkle tree with the tree shape of RFC 6962:
+#   leaf = SHA256(0x00 | chunk), node = SHA256(0x01 | left | right)
+# The "root" command prints the root of an unsigned image, which is signed
+# into the image as a protected TLV with the imgtool option --custom-tlv.
+# The "cyacd2" command adds the chunk hashes to the CYACD2 file of the signed
+# image, as rows ahead of the image rows, see dfu_chunk_hash.c.
+# Example Usage:
+# chunk_hash.py root -chunk=4096 cm4_app_UPGRADE_unsigned.hex
+# chunk_hash.py cyacd2 -chunk=4096 cm4_app_UPGRADE.cyacd2 cm4_app_UPGRADE.cyacd2
+# In a sparse CYACD2 file (hextocyacd2.py -erased), the rows left out hold the
+# erased value; pass it with -erased.
+
+# Must match dfu_chunk_hash.h
+CHUNK_HASH_ADDR = 0x60000000
+CHUNK_HASH_ROWS = 33
+CHUNK_HASH_MAGIC = 0x314B4843
+CHUNK_HASH_MAX_CHUNKS = 512
+CHUNK_HASH_TLV = 0xA0
+CHUNK_HASH_META = struct.Struct("<IIII32s")
+
+# Must match dfu_user.h
+IMAGE_MAGIC = 0x96F3B83D
+IMAGE_TLV_PROT_INFO_MAGIC = 0x6908
+IMAGE_HEADER = struct.Struct("<IIHHI")
+
+# Rows at this address and above hold data for the DFU (chunk hashes, erase
+# ranges) and are not part of the image
+DFU_META_ADDR = 0x60000000
+
+ROW_SIZE = 512
+
+
+def leaf_hash(chunk):
+    """Hashes a chunk of the image payload
+
+    Args:
+        chunk: Chunk data
+
+    Returns:
+        bytes: Leaf hash
+    """
+    return hashlib.sha256(b"\x00" + chunk).digest()
+
+
+def node_hash(left, right):
+    """Hashes two subtrees
+
+    Args:
+        left: Hash of the left subtree
+        right: Hash of the right subtree
+
+    Returns:
+        bytes: Node hash
+    """
+    return hashlib.sha256(b"\x01" + left + right).digest()
+
+
+def merkle_root(leaves):
+    """Calculates the Merkle root of a list of leaf hashes. The left subtree
+    holds the largest power of two leaves smaller than the leaf count.
+
+    Args:
+        leaves: List of leaf hashes
+
+    Returns:
+        bytes: Root hash
+    """
+    if len(leaves) == 1:
+        return leaves[0]
+    split = 1
+    while split * 2 < len(leaves):
+        split *= 2
+    return node_hash(merkle_root(leaves[:split]), merkle_root(leaves[split:]))
+
+
+def chunk_leaves(payload, chunk_size):
+    """Splits the image payload in chunks and hashes them
+
+    Args:
+        payload: Image payload, without the header and the TLV areas
+        chunk_size: Chunk size, a multiple of the flash row size
+
+    Returns:
+        list: Leaf hashes
+    """
+    leaves = [leaf_hash(payload[offset:offset + chunk_size])
+              for offset in range(0, len(payload), chunk_size)]
+    if not leaves or len(leaves) > CHUNK_HASH_MAX_CHUNKS:
+        raise ValueError(f"The image needs 1 to {CHUNK_HASH_MAX_CHUNKS} chunks, "
+                         f"not {len(leaves)}; change the chunk size")
+    return leaves
+
+
+def find_prot_tlv(image, offset, prot_tlv_size, tlv_type):
+    """Finds a TLV in the protected TLV area of an image
+
+    Args:
+        image: Image data from the start of the header
+        offset: Offset of the protected TLV area
+        prot_tlv_size: Size of the protected TLV area
+        tlv_type: TLV type
+
+    Returns:
+        bytes: TLV value, or None if the image has no such TLV
+    """
+    if prot_tlv_size == 0:
+        return None
+    magic, size = struct.unpack_from("<HH", image, offset)
+    if magic != IMAGE_TLV_PROT_INFO_MAGIC or size != prot_tlv_size:
+        raise ValueError("Bad protected TLV area")
+    end = offset + size
+    offset += 4
+    while offset + 4 <= end:
+        found_type, length = struct.unpack_from("<HH", image, offset)
+        offset += 4
+        if found_type == tlv_type:
+            return bytes(image[offset:offset + length])
+        offset += length
+    return None
+
+
+def read_cyacd2_rows(lines):
+    """Reads the rows of a CYACD2 file
+
+    Args:
+        lines: Lines of the CYACD2 file
+
+    Returns:
+        dict: Row data by row address
+    """
+    rows = {}
+    for line in lines[1:]:
+        if line.startswith(":"):
+            rows[int.from_bytes(bytes.fromhex(line[1:9]), 'little')] = bytes.fromhex(line[9:])
+    return rows
+
+
+def add_cyacd2_chunk_hashes(lines, chunk_size, erased_value=0):
+    """Adds the chunk hash rows to a CYACD2 file, ahead of the image rows
+
+    Args:
+        lines: Lines of the CYACD2 file
+        chunk_size: Chunk size, a multiple of the flash row size
+        erased_value: Value of the rows left out of a sparse file
+
+    Returns:
+        list: Lines of the CYACD2 file with the chunk hashes
+    """
+    rows = read_cyacd2_rows(lines)
+    if any(CHUNK_HASH_ADDR <= address < CHUNK_HASH_ADDR + CHUNK_HASH_ROWS * ROW_SIZE
+           for address in rows):
+        raise ValueError("The CYACD2 file already has the chunk hashes")
+    rows = {address: data for address, data in rows.items() if address < DFU_META_ADDR}
+    if not rows:
+        raise ValueError("The CYACD2 file has no rows")
+
+    # Image from the header at the first row
+    slot_start = min(rows)
+    image = bytearray()
+    for address in range(slot_start, max(rows) + ROW_SIZE, ROW_SIZE):
+        image += rows.get(address, bytes([erased_value]) * ROW_SIZE)
+
+    magic, _, header_size, prot_tlv_size, image_size = IMAGE_HEADER.unpack_from(image)
+    if magic != IMAGE_MAGIC:
+        raise ValueError("The first row has no image header")
+
+    leaves = chunk_leaves(bytes(image[header_size:header_size + image_size]), chunk_size)
+    root = merkle_root(leaves)
+
+    # The root must be the one signed into the image
+    signed_root = find_prot_tlv(image, header_size + image_size, prot_tlv_size, CHUNK_HASH_TLV)
+    if signed_root != root:
+        raise ValueError("The image is not signed with the root of its chunk hashes")
+
+    meta = CHUNK_HASH_META.pack(CHUNK_HASH_MAGIC, slot_start + header_size, image_size,
+                                chunk_size, root) + b"".join(leaves)
+    meta += bytes(-len(meta) % ROW_SIZE)
+
+    meta_lines = []
+    for offset in range(0, len(meta), ROW_SIZE):
+        address = (CHUNK_HASH_ADDR + offset).to_bytes(4, 'little').hex().upper()
+        meta_lines.append(f":{address}{meta[offset:offset + ROW_SIZE].hex().upper()}")
+
+    first_row = next(index for index, line in enumerate(lines) if line.startswith(":"))
+    return lines[:first_row] + meta_lines + lines[first_row:]
+
+
+def chunk_size_arg(var):
+    """Internal function to parse the chunk size
+
+    Args:
+        var (str): Chunk size
+
+    Returns:
+        int: The chunk size
+    """
+    size = int(var, 0)
+    if size <= 0 or size % ROW_SIZE != 0:
+        raise argparse.ArgumentTypeError(f"The chunk size must be a multiple of {ROW_SIZE}")
+    return size
+
+
+if __name__ == '__main__':
+
+    # Create the command-line argument options
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-chunk", "--chunkSize", type=chunk_size_arg, default=4096,
+                            help="Chunk size in bytes, a multiple of the row size")
+    parser.add_argument("-erased", "--erasedValue", type=lambda var: int(var, 0), default=0,
+                            help="Value of the rows left out of a sparse CYACD2 file")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+    root_parser = subparsers.add_parser("root", help="Print the root of an unsigned image")
+    root_parser.add_argument("in_intel_hex",
+                            help="Path to the unsigned intel hex file")
+    cyacd2_parser = subparsers.add_parser("cyacd2", help="Add the chunk hashes to a CYACD2 file")
+    cyacd2_parser.add_argument("in_cyacd2",
+                            help="Path to the input CYACD2 file")
+    cyacd2_parser.add_argument("out_cyacd2",
+                            help="Path to the output CYACD2 file, may be the input file")
+
+    # Parse arguments
+    options = parser.parse_args()
+
+    if options.command == "root":
+        # The payload is read as imgtool reads it
+        payload = IntelHex(options.in_intel_hex).tobinarray().tobytes()
+        print(f"0x{merkle_root(chunk_leaves(payload, options.chunkSize)).hex()}")
+    else:
+        with open(options.in_cyacd2, 'r', encoding='ascii') as cyacd2_f:
+            cyacd2_lines = cyacd2_f.read().splitlines()
+
+        cyacd2_lines = add_cyacd2_chunk_hashes(cyacd2_lines, options.chunkSize, options.erasedValue)
+
+        with open(options.out_cyacd2, 'w', encoding='ascii') as cyacd2_f:
+            for item in cyacd2_lines:
+                cyacd2_f.write(f"{item}\n")
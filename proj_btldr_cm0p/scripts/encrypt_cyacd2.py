@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import os
+
+from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
+
+# This script encrypts the rows of a CYACD2 file for the encrypted DFU
+# (DFU_ENCRYPTION=1). A random AES-128 key is generated for the image and the
+# row data is encrypted with it in CTR mode. The counter of the first block
+# of a row is the row address divided by 16, as a 128-bit big-endian number,
+# see dfu_decrypt.c. The image key is wrapped with the key-encryption key
+# (AES-128 ECB) and stored in the "@EIV:" line, which the DFU host sends with
+# the Set EI Vector command.
+# Example Usage:
+# encrypt_cyacd2.py --kek 000102030405060708090A0B0C0D0E0F \
+# proj_cm4_UPGRADE.cyacd2 proj_cm4_UPGRADE.cyacd2
+
+AES_BLOCK_SIZE = 16
+KEY_SIZE = 16
+EIV_PREFIX = "@EIV:"
+APPINFO_PREFIX = "@APPINFO:"
+
+
+def wrap_key(kek, key):
+    """Wraps the image key with the key-encryption key
+
+    Args:
+        kek: 16-byte key-encryption key
+        key: 16-byte image key
+
+    Returns:
+        bytes: Wrapped key
+    """
+    encryptor = Cipher(algorithms.AES(kek), modes.ECB()).encryptor()
+    return encryptor.update(key) + encryptor.finalize()
+
+
+def encrypt_row(key, address, data):
+    """Encrypts the data of one CYACD2 row
+
+    Args:
+        key: 16-byte image key
+        address: Address of the row
+        data: Row data, a multiple of the AES block size
+
+    Returns:
+        bytes: Encrypted row data
+    """
+    counter = (address // AES_BLOCK_SIZE).to_bytes(AES_BLOCK_SIZE, 'big')
+    encryptor = Cipher(algorithms.AES(key), modes.CTR(counter)).encryptor()
+    return encryptor.update(data) + encryptor.finalize()
+
+
+def encrypt_cyacd2(lines, kek, key):
+    """Encrypts the rows of a CYACD2 file and adds the wrapped key
+
+    Args:
+        lines: Lines of the CYACD2 file
+        kek: 16-byte key-encryption key
+        key: 16-byte image key
+
+    Returns:
+        list: Lines of the encrypted CYACD2 file
+    """
+    if any(line.startswith(EIV_PREFIX) for line in lines):
+        raise ValueError("The CYACD2 file is already encrypted")
+
+    out_lines = [lines[0], f"{EIV_PREFIX}{wrap_key(kek, key).hex().upper()}"]
+
+    for line in lines[1:]:
+        if not line.startswith(":"):
+            out_lines.append(line)
+            continue
+
+        # The address is stored little-endian
+        address = int.from_bytes(bytes.fromhex(line[1:9]), 'little')
+        data = bytes.fromhex(line[9:])
+        if len(data) % AES_BLOCK_SIZE != 0:
+            raise ValueError(f"Row 0x{address:08X} is not a multiple of {AES_BLOCK_SIZE} bytes")
+
+        out_lines.append(f":{line[1:9]}{encrypt_row(key, address, data).hex().upper()}")
+
+    return out_lines
+
+
+def key_arg(var):
+    """Internal function to parse a 16-byte key in hex
+
+    Args:
+        var (str): Key in hex
+
+    Returns:
+        bytes: The key
+    """
+    key = bytes.fromhex(var)
+    if len(key) != KEY_SIZE:
+        raise argparse.ArgumentTypeError(f"The key must be {KEY_SIZE} bytes")
+    return key
+
+
+if __name__ == '__main__':
+
+    # Create the command-line argument options
+    parser = argparse.ArgumentParser()
+    parser.add_argument("in_cyacd2",
+                            help="Path to the input CYACD2 file")
+    parser.add_argument("out_cyacd2",
+                            help="Path to the output CYACD2 file, may be the input file")
+    parser.add_argument("--kek", type=key_arg, required=True,
+                            help="Key-encryption key in hex, user key #1 of the secure key storage")
+
+    # Parse arguments
+    options = parser.parse_args()
+    if options.kek == bytes(KEY_SIZE):
+        parser.error("The key-encryption key is all zeros, provision user key #1 with your own key")
+
+    with open(options.in_cyacd2, 'r', encoding='ascii') as cyacd2_f:
+        cyacd2_lines = cyacd2_f.read().splitlines()
+
+    # A new key for every image
+    cyacd2_lines = encrypt_cyacd2(cyacd2_lines, options.kek, os.urandom(KEY_SIZE))
+
+    with open(options.out_cyacd2, 'w', encoding='ascii') as cyacd2_f:
+        for item in cyacd2_lines:
+            cyacd2_f.write(f"{item}\n")
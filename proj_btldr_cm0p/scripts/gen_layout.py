@@ -0,0 +1,675 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+from check_layout import check_layout, FLASH_ROW_SIZE, SMPU_MIN_REGION_SIZE
+
+# This script generates the memory layout of a target from its description
+# (shared/layout/TARGET_<target>/layout.json). It places the flash and SRAM
+# regions, grows the "fill" regions into the space left over, and fits each
+# SMPU protection of the description into SMPU regions and sub-regions. It
+# writes next to the description:
+#   layout.mk      - make variables included by common.mk, which passes them
+#                    to the projects as defines and linker symbols
+#   cy_ps_layout.h - SMPU configs used by cy_ps_prot_units.c
+# Both files hold every variant of the layout (USE_EXT_FLASH, swap upgrade
+# and MCUBOOT_IMAGE_NUMBER), so they are committed and only need to be
+# generated again after the description is changed. With --check, the files
+# are compared with the description instead and the build fails if they are
+# out of date or if the layout is invalid.
+# The layout selected by the options is printed with the SMPU regions, the
+# flash lost to SMPU alignment padding and the space reclaimed by the fill
+# regions.
+# Example Usage:
+# gen_layout.py ../shared/layout/TARGET_CY8CKIT-062-WIFI-BT/layout.json
+# gen_layout.py --check --ext-flash ../shared/layout/TARGET_CY8CKIT-062-WIFI-BT/layout.json
+
+LAYOUT_MK = "layout.mk"
+LAYOUT_HEADER = "cy_ps_layout.h"
+
+# Number of sub-regions in an SMPU region
+SMPU_SUBREGION_NR = 8
+
+# Largest SMPU region (CY_PROT_SIZE_4GB)
+SMPU_MAX_REGION_SIZE = 1 << 32
+
+# Granularity used to grow the SRAM regions
+SRAM_GRANULE = 0x100
+
+# Minimum number of sectors accepted by the MCUboot library
+MIN_IMG_SECTORS = 32
+
+# Make variables (start, size) of the regions
+FLASH_VARIABLES = {
+    "bootloader": ("CM0P_BTLDR_FLASH_START", "CM0P_BTLDR_FLASH_SIZE"),
+    "protected_storage": ("PROTECTED_MEM_START", "PROTECTED_MEM_SIZE"),
+    "cm0p_app": ("CM0P_APP_FLASH_START", "CM0P_APP_FLASH_SIZE"),
+    "cm4_app": ("CM4_APP_FLASH_START", "CM4_APP_FLASH_SIZE"),
+    "secondary_slot": ("MCUBOOT_SECONDARY_SLOT_START_ADDR", None),
+    "scratch": ("MCUBOOT_SCRATCH_START_ADDR", "MCUBOOT_SCRATCH_SIZE"),
+    "swap_status": ("MCUBOOT_SWAP_STATUS_START_ADDR", "MCUBOOT_SWAP_STATUS_SIZE"),
+}
+SRAM_VARIABLES = {
+    "cm0p_sram": ("CM0P_APP_SRAM_START", "CM0P_APP_SRAM_SIZE"),
+    "shared_sram": ("SHARED_SRAM_START", "SHARED_SRAM_SIZE"),
+    "cm4_sram": ("CM4_APP_SRAM_START", "CM4_APP_SRAM_SIZE"),
+    "system_sram": (None, None),
+}
+
+MK_HEADER = """################################################################################
+# \\file layout.mk
+# \\version 1.0
+#
+# \\brief
+# Memory layout of {target}.
+# Generated by proj_btldr_cm0p/scripts/gen_layout.py from layout.json, do not
+# edit. See README.md.
+#
+################################################################################
+# \\copyright
+# Copyright 2022-2025, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+"""
+
+HEADER_HEADER = """/******************************************************************************
+* File Name: cy_ps_layout.h
+*
+* Description: SMPU configs of the memory layout of {target}.
+*   Generated by proj_btldr_cm0p/scripts/gen_layout.py from layout.json, do
+*   not edit. <NAME>_ADDR, <NAME>_REGION_SIZE and <NAME>_SUBREGIONS configure
+*   one SMPU struct that protects exactly <NAME>_START to <NAME>_END.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PS_LAYOUT_H
+#define CY_PS_LAYOUT_H
+
+"""
+
+
+class LayoutError(Exception):
+    pass
+
+
+def parse_number(value):
+    """Convert a number of the description
+
+    Args:
+        value: int or string in decimal or hex
+
+    Returns:
+        int: value
+    """
+    return value if isinstance(value, int) else int(value, 0)
+
+
+def size_name(size=int):
+    """Name of the CY_PROT_SIZE_xxx value of an SMPU region size
+
+    Args:
+        size: region size in bytes
+
+    Returns:
+        str: CY_PROT_SIZE_xxx
+    """
+    for shift, unit in ((30, "GB"), (20, "MB"), (10, "KB"), (0, "B")):
+        if size >= 1 << shift:
+            return f"CY_PROT_SIZE_{size >> shift}{unit}"
+
+
+def fit_smpu(start=int, end=int):
+    """Find the smallest SMPU region that covers exactly [start, end) with its sub-regions
+
+    Same rule as prot_units_fit_region() in cy_ps_prot_units.c.
+
+    Args:
+        start: start of the range
+        end: end of the range
+
+    Returns:
+        tuple: region start, region size, disabled sub-regions mask, or None
+    """
+    region = SMPU_MIN_REGION_SIZE
+    while region <= SMPU_MAX_REGION_SIZE:
+        subregion = region // SMPU_SUBREGION_NR
+        base = start & ~(region - 1)
+        if end <= base + region and (start - base) % subregion == 0 and (end - start) % subregion == 0:
+            first = (start - base) // subregion
+            last = (end - base) // subregion
+            enabled = ((1 << last) - 1) & ~((1 << first) - 1)
+            return base, region, 0xFF & ~enabled
+        region <<= 1
+    return None
+
+
+def cover_smpu(start=int, end=int, max_structs=int):
+    """Cover [start, end) with SMPU regions, each one covering the longest possible part
+
+    Args:
+        start: start of the range
+        end: end of the range
+        max_structs: number of SMPU structs that can be used
+
+    Returns:
+        list: (part start, part end, region start, region size, disabled sub-regions) or None
+    """
+    parts = list()
+    while start < end:
+        if len(parts) == max_structs:
+            return None
+        part_end = None
+        region = SMPU_MIN_REGION_SIZE
+        while region <= SMPU_MAX_REGION_SIZE:
+            subregion = region // SMPU_SUBREGION_NR
+            base = start & ~(region - 1)
+            if (start - base) % subregion == 0:
+                candidate = min(end, base + region)
+                candidate -= (candidate - start) % subregion
+                if candidate > start and (part_end is None or candidate > part_end):
+                    part_end = candidate
+            region <<= 1
+        if part_end is None:
+            return None
+        parts.append((start, part_end, *fit_smpu(start, part_end)))
+        start = part_end
+    return parts
+
+
+class Memory:
+    """Regions of one memory (internal flash or SRAM) of the description"""
+
+    def __init__(self, name, desc, regions, granule):
+        self.name = name
+        self.start = parse_number(desc["start"])
+        self.size = parse_number(desc["size"])
+        self.regions = regions
+        self.granule = granule
+
+    def place(self, fill_size, external=()):
+        """Place the regions from the start of the memory, the "at_end" ones at its end
+
+        Args:
+            fill_size: size of the fill region
+            external: names of the regions placed in the external flash
+
+        Returns:
+            dict: region name to (start, size)
+        """
+        layout = dict()
+        end = self.start + self.size
+        for region in reversed([region for region in self.regions if region.get("at_end")]):
+            end -= parse_number(region["size"])
+            layout[region["name"]] = (end, parse_number(region["size"]))
+
+        cursor = self.start
+        for region in self.regions:
+            if region.get("at_end") or region["name"] in external:
+                continue
+            if region.get("fill"):
+                size = fill_size
+            elif "mirror" in region:
+                size = sum(layout[name][1] for name in region["mirror"])
+            else:
+                size = parse_number(region["size"])
+            layout[region["name"]] = (cursor, size)
+            cursor += size
+        return layout
+
+    def region(self, name):
+        return next(region for region in self.regions if region["name"] == name)
+
+    def fits(self, layout):
+        """Check that the regions do not overlap and stay inside the memory"""
+        areas = sorted(layout.values())
+        if areas[0][0] < self.start or areas[-1][0] + areas[-1][1] > self.start + self.size:
+            return False
+        return all(start + size <= next_start for (start, size), (next_start, _) in zip(areas, areas[1:]))
+
+
+def group_range(group, layout):
+    """Memory range of an SMPU protection, limited to the regions placed in this memory
+
+    Args:
+        group: protection of the description
+        layout: region name to (start, size)
+
+    Returns:
+        tuple: start, end, or None if no region of the protection is in this memory
+    """
+    areas = sorted(layout[name] for name in group["regions"] if name in layout)
+    if not areas:
+        return None
+    for (start, size), (next_start, _) in zip(areas, areas[1:]):
+        if start + size != next_start:
+            raise LayoutError(f"SMPU {group['name']}: regions are not contiguous")
+    return areas[0][0], areas[-1][0] + areas[-1][1]
+
+
+def fit_groups(groups, layout):
+    """Fit the SMPU protections of a memory
+
+    Args:
+        groups: protections of the description
+        layout: region name to (start, size)
+
+    Returns:
+        dict: protection name to list of SMPU parts, or None if a protection does not fit
+    """
+    fitted = dict()
+    for group in groups:
+        bounds = group_range(group, layout)
+        if bounds is None:
+            continue
+        parts = cover_smpu(*bounds, group.get("structs", 1))
+        if parts is None:
+            return None
+        fitted[group["name"]] = parts
+    return fitted
+
+
+def pack(memory, groups, external=()):
+    """Pack the regions of a memory
+
+    The fill region is grown to the largest size with which the regions fit
+    in the memory and every SMPU protection fits in its SMPU structs.
+
+    Args:
+        memory: Memory
+        groups: protections of the description, of all upgrade modes
+        external: names of the regions placed in the external flash
+
+    Returns:
+        tuple: region name to (start, size), fill region name, declared fill size
+    """
+    fill = [region for region in memory.regions if region.get("fill")]
+    if len(fill) != 1:
+        raise LayoutError(f"{memory.name}: exactly one region must have \"fill\" set")
+    fill = fill[0]
+    declared = parse_number(fill["size"])
+
+    # Upper bound: all the space left, shared with the regions mirroring the fill region
+    layout = memory.place(0, external)
+    used = sum(size for _, size in layout.values())
+    copies = 1 + sum(1 for region in memory.regions
+                     if fill["name"] in region.get("mirror", ()) and region["name"] not in external)
+    fill_size = (memory.size - used) // copies
+    fill_size -= fill_size % memory.granule
+
+    while fill_size >= declared:
+        layout = memory.place(fill_size, external)
+        if memory.fits(layout) and fit_groups(groups, layout) is not None:
+            return layout, fill["name"], declared
+        fill_size -= memory.granule
+
+    raise LayoutError(f"{memory.name}: {fill['name']} does not fit with its declared size 0x{declared:X}")
+
+
+class Layout:
+    """One variant of the memory layout of a target"""
+
+    def __init__(self, desc, ext_flash, swap):
+        self.desc = desc
+        self.ext_flash = ext_flash
+        self.swap = swap
+        self.flash = Memory("flash", desc["flash"], desc["flash_regions"], FLASH_ROW_SIZE)
+        self.sram = Memory("sram", desc["sram"], desc["sram_regions"], SRAM_GRANULE)
+        self.header_size = parse_number(desc["mcuboot_header_size"])
+
+        groups = desc["smpu"]
+        self.groups = [group for group in groups if group.get("swap", swap) == swap]
+
+        external = [region["name"] for region in self.flash.regions if region.get("external")] if ext_flash else []
+        self.flash_layout, flash_fill, flash_declared = pack(self.flash, groups, external)
+        self.sram_layout, sram_fill, sram_declared = pack(self.sram, groups)
+        self.fills = [(flash_fill, flash_declared, self.flash_layout[flash_fill][1]),
+                      (sram_fill, sram_declared, self.sram_layout[sram_fill][1])]
+
+        self.ext = None
+        if ext_flash:
+            ext = desc["ext_flash"]
+            self.ext = (parse_number(ext["start"]), parse_number(ext["erase_size"]),
+                        parse_number(ext["secondary_offset"]))
+            for name in external:
+                size = sum(self.flash_layout[mirror][1] for mirror in self.flash.region(name)["mirror"])
+                self.flash_layout[name] = (self.ext[0] + self.ext[2], size)
+
+        self.smpu = dict()
+        for layout in (self.flash_layout, self.sram_layout):
+            internal = {name: area for name, area in layout.items() if not self.is_external(area[0])}
+            self.smpu.update(fit_groups(self.groups, internal))
+
+    def is_external(self, address):
+        return self.ext is not None and address >= self.ext[0]
+
+    def slot_size(self):
+        return self.flash_layout["cm0p_app"][1] + self.flash_layout["cm4_app"][1]
+
+    def images(self, image_number):
+        """MCUboot image slots: (primary start, secondary start, slot size) per image"""
+        primary = self.flash_layout["cm0p_app"][0]
+        secondary = self.flash_layout["secondary_slot"][0]
+        if image_number == 1:
+            return [(primary, secondary, self.slot_size())]
+        cm0p_size = self.flash_layout["cm0p_app"][1]
+        return [(primary, secondary, cm0p_size),
+                (self.flash_layout["cm4_app"][0], secondary + cm0p_size, self.flash_layout["cm4_app"][1])]
+
+    def check(self, image_number, direct_xip=False):
+        """Check the variant with check_layout.py
+
+        Returns:
+            tuple: list of (name, start, size) sorted by address, list of errors
+        """
+        areas = [(name, start, size) for name, (start, size) in self.flash_layout.items()
+                 if name not in ("cm0p_app", "cm4_app", "secondary_slot")]
+        smpu_regions = [(name, part[2], part[3]) for name, parts in self.smpu.items()
+                        for part in parts if part[2] >= self.flash.start]
+        ext = self.ext[:2] if self.ext else None
+        layout, errors = check_layout((self.flash.start, self.flash.size), self.header_size, areas,
+                                      self.images(image_number), smpu_regions, ext)
+
+        if direct_xip and not self.is_external(self.flash_layout["secondary_slot"][0]):
+            start = self.flash_layout["secondary_slot"][0]
+            if fit_smpu(start, start + self.flash_layout["cm0p_app"][1]) is None:
+                errors.append("direct-XIP: the CM0+ App Flash region of the secondary slot cannot be protected "
+                              "by one SMPU region")
+        return layout, errors
+
+    def variables(self):
+        """Make variables of the variant"""
+        variables = dict()
+        for names, layout in ((FLASH_VARIABLES, self.flash_layout), (SRAM_VARIABLES, self.sram_layout)):
+            for name, (start_var, size_var) in names.items():
+                if name in layout:
+                    if start_var:
+                        variables[start_var] = layout[name][0]
+                    if size_var:
+                        variables[size_var] = layout[name][1]
+
+        variables["CM0P_BTLDR_SRAM_START"] = variables["CM0P_APP_SRAM_START"]
+        variables["CM0P_BTLDR_SRAM_SIZE"] = variables["CM0P_APP_SRAM_SIZE"]
+        slot_size = self.slot_size()
+        variables["MCUBOOT_PRIMARY_SLOT_START_ADDR"] = self.flash_layout["cm0p_app"][0]
+        variables["MCUBOOT_SLOT_SIZE"] = slot_size
+        variables["TOTAL_APP_FLASH_SIZE"] = slot_size * 2
+        variables["CM4_APP_SECONDARY_FLASH_START"] = (self.flash_layout["secondary_slot"][0]
+                                                      + self.flash_layout["cm0p_app"][1])
+        sectors = max(MIN_IMG_SECTORS, slot_size // FLASH_ROW_SIZE)
+        variables["MCUBOOT_MAX_IMG_SECTORS"] = str(sectors)
+        return variables
+
+    def smpu_blocks(self):
+        """cy_ps_layout.h macros of the variant, one block of lines per SMPU struct"""
+        blocks = dict()
+        for name, parts in self.smpu.items():
+            for index, (start, end, base, region, disabled) in enumerate(parts, start=1):
+                prefix = f"CY_PS_LAYOUT_{name.upper()}" + (f"_{index}" if index > 1 else "")
+                macros = ((f"{prefix}_ADDR", f"(0x{base:08X}UL)"),
+                          (f"{prefix}_REGION_SIZE", f"({size_name(region)})"),
+                          (f"{prefix}_SUBREGIONS", f"(0x{disabled:02X}U)"),
+                          (f"{prefix}_START", f"(0x{start:08X}UL)"),
+                          (f"{prefix}_END", f"(0x{end:08X}UL)"))
+                blocks[prefix] = [f"#define {macro:<44} {value}" for macro, value in macros] + [""]
+        return blocks
+
+    def report(self, image_number):
+        """Print the layout, the SMPU regions and the packing result"""
+        layout, _ = self.check(image_number)
+        print(f"{'Area':<20} {'Start':>10} {'End':>10} {'Size':>10}")
+        for name, start, size in layout:
+            print(f"{name:<20} 0x{start:08X} 0x{start + size:08X} 0x{size:08X}")
+        for name, (start, size) in sorted(self.sram_layout.items(), key=lambda area: area[1]):
+            print(f"{name:<20} 0x{start:08X} 0x{start + size:08X} 0x{size:08X}")
+
+        print(f"\n{'SMPU':<22} {'Region':>10} {'Size':<18} {'Disabled':>8} {'Protects':>22}")
+        for name, parts in self.smpu.items():
+            for index, (start, end, base, region, disabled) in enumerate(parts, start=1):
+                label = name + (f" ({index})" if len(parts) > 1 else "")
+                print(f"{label:<22} 0x{base:08X} {size_name(region):<18} "
+                      f"{'':>4}0x{disabled:02X} 0x{start:08X}-0x{end:08X}")
+
+        print()
+        for memory, layout in ((self.flash, self.flash_layout), (self.sram, self.sram_layout)):
+            internal = [size for start, size in layout.values() if not self.is_external(start)]
+            print(f"{memory.name}: 0x{memory.size - sum(internal):X} bytes unused after SMPU alignment")
+        for name, declared, packed in self.fills:
+            print(f"{name}: 0x{packed:X} bytes, 0x{packed - declared:X} bytes reclaimed over the declared 0x{declared:X}")
+
+
+def load(path):
+    """Load a layout description and all its supported variants
+
+    Returns:
+        tuple: target name, description, dict of (ext_flash, swap) to Layout
+    """
+    with open(path, "r") as desc_file:
+        desc = json.load(desc_file)
+    target = os.path.basename(os.path.dirname(os.path.abspath(path))).replace("TARGET_", "", 1)
+
+    has_scratch = any(region["name"] == "scratch" for region in desc["flash_regions"])
+    variants = dict()
+    for ext_flash in ((False, True) if "ext_flash" in desc else (False,)):
+        # The swap upgrade needs the scratch area and is not supported with the external flash
+        for swap in ((False, True) if has_scratch and not ext_flash else (False,)):
+            variants[(ext_flash, swap)] = Layout(desc, ext_flash, swap)
+    return target, desc, variants
+
+
+def make_blocks(values_by_key, condition, emit):
+    """Emit the lines of two variants, the common lines once and the others in an if/else block
+
+    Args:
+        values_by_key: dict of False/True to list of lines
+        condition: (if line, else line, end line)
+        emit: list the lines are appended to
+    """
+    off, on = values_by_key.get(False, []), values_by_key.get(True)
+    if on is None:
+        emit.extend(off)
+        return
+    emit.extend(line for line in off if line in on)
+    only_on = [line for line in on if line not in off]
+    only_off = [line for line in off if line not in on]
+    if only_on or only_off:
+        emit.append(condition[0])
+        emit.extend(only_on)
+        if only_off:
+            emit.append(condition[1])
+            emit.extend(only_off)
+        emit.append(condition[2])
+
+
+def generate_mk(target, desc, variants):
+    """Generate layout.mk"""
+    lines = [
+        f"START_OF_FLASH=0x{parse_number(desc['flash']['start']):08X}",
+        f"DEVICE_FLASH_SIZE=0x{parse_number(desc['flash']['size']):X}",
+        f"START_OF_SRAM=0x{parse_number(desc['sram']['start']):08X}",
+        f"DEVICE_SRAM_SIZE=0x{parse_number(desc['sram']['size']):X}",
+        f"MCUBOOT_HEADER_SIZE=0x{parse_number(desc['mcuboot_header_size']):X}",
+    ]
+    if "ext_flash" in desc:
+        ext = desc["ext_flash"]
+        lines += [f"EXT_FLASH_START=0x{parse_number(ext['start']):08X}",
+                  f"EXT_FLASH_ERASE_SIZE=0x{parse_number(ext['erase_size']):X}",
+                  f"EXT_FLASH_SECONDARY_OFFSET=0x{parse_number(ext['secondary_offset']):X}"]
+
+    def format_variables(layout):
+        return [f"{name}={value}" if isinstance(value, str) else
+                f"{name}=0x{value:08X}" if name.endswith(("_START", "_ADDR")) else f"{name}=0x{value:X}"
+                for name, value in layout.variables().items()]
+
+    values = {ext_flash: format_variables(layout) for (ext_flash, swap), layout in variants.items() if not swap}
+    make_blocks(values, ("ifeq ($(USE_EXT_FLASH), 1)", "else", "endif"), lines)
+    return MK_HEADER.format(target=target) + "\n".join(lines) + "\n"
+
+
+def generate_header(target, variants):
+    """Generate cy_ps_layout.h
+
+    An SMPU struct that is the same in all the variants of a branch is
+    emitted once in the branch, the others in #if blocks.
+    """
+    blocks = {key: layout.smpu_blocks() for key, layout in variants.items()}
+    prefixes = list()
+    for variant_blocks in blocks.values():
+        prefixes.extend(prefix for prefix in variant_blocks if prefix not in prefixes)
+
+    # Variant key index and macro of each dimension
+    dimensions = ((1, "MCUBOOT_SWAP_USING_STATUS"), (0, "CY_BOOT_USE_EXTERNAL_FLASH"))
+
+    def emit(keys, dims, emitted):
+        lines = list()
+        common = [prefix for prefix in prefixes if prefix not in emitted
+                  and blocks[keys[0]].get(prefix) is not None
+                  and all(blocks[key].get(prefix) == blocks[keys[0]][prefix] for key in keys)]
+        for prefix in common:
+            lines.extend(blocks[keys[0]][prefix])
+        emitted = emitted | set(common)
+        if dims:
+            index, macro = dims[0]
+            on = [key for key in keys if key[index]]
+            off = [key for key in keys if not key[index]]
+            if on and off:
+                on_lines = emit(on, dims[1:], emitted)
+                off_lines = emit(off, dims[1:], emitted)
+                if on_lines:
+                    lines.append(f"#if defined({macro})")
+                    lines.extend(on_lines)
+                    if off_lines:
+                        lines.append("#else")
+                        lines.extend(off_lines)
+                    lines.extend((f"#endif /* {macro} */", ""))
+                elif off_lines:
+                    lines.append(f"#if !defined({macro})")
+                    lines.extend(off_lines)
+                    lines.extend((f"#endif /* !{macro} */", ""))
+            else:
+                lines.extend(emit(keys, dims[1:], emitted))
+        return lines
+
+    lines = emit(list(blocks), dimensions, set())
+    return (HEADER_HEADER.format(target=target) + "\n".join(lines)
+            + "\n#endif /* CY_PS_LAYOUT_H */\n\n/* [] END OF FILE */\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the memory layout of a target from its description")
+    parser.add_argument("layout", help="Layout description (layout.json)")
+    parser.add_argument("--check", action="store_true",
+                        help="Check that the generated files are up to date instead of writing them")
+    parser.add_argument("--ext-flash", action="store_true", help="Report the USE_EXT_FLASH=1 layout")
+    parser.add_argument("--swap", action="store_true", help="Report the swap upgrade layout")
+    parser.add_argument("--direct-xip", action="store_true", help="Check the layout for direct-XIP")
+    parser.add_argument("--image-number", type=int, choices=(1, 2), default=1,
+                        help="Number of MCUboot images")
+    args = parser.parse_args()
+
+    try:
+        target, desc, variants = load(args.layout)
+    except (LayoutError, KeyError, ValueError) as error:
+        print(f"Layout error: {error}", file=sys.stderr)
+        sys.exit(1)
+
+    errors = list()
+    for (ext_flash, swap), layout in variants.items():
+        for image_number in ((1,) if ext_flash else (1, 2)):
+            _, variant_errors = layout.check(image_number)
+            errors.extend(error for error in variant_errors if error not in errors)
+
+    selected = variants.get((args.ext_flash, args.swap))
+    if selected is None:
+        errors.append("The selected variant is not supported by this target")
+    else:
+        selected.report(args.image_number)
+        errors.extend(selected.check(args.image_number, args.direct_xip)[1])
+
+    out_dir = os.path.dirname(os.path.abspath(args.layout))
+    outputs = {LAYOUT_MK: generate_mk(target, desc, variants), LAYOUT_HEADER: generate_header(target, variants)}
+    for name, content in outputs.items():
+        path = os.path.join(out_dir, name)
+        if args.check:
+            try:
+                with open(path, "r", newline="") as out_file:
+                    current = out_file.read()
+            except OSError:
+                current = None
+            if current != content:
+                errors.append(f"{path} is out of date, run gen_layout.py {args.layout}")
+        elif not errors:
+            with open(path, "w", newline="\n") as out_file:
+                out_file.write(content)
+
+    for error in errors:
+        print(f"Layout error: {error}", file=sys.stderr)
+    sys.exit(1 if errors else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -28,8 +28,13 @@ from intelhex import IntelHex
 # -chk=sum \
 # -id=0x1020304  \
 # -size=0x10000  \
+# -erased=0 \
 # input.hex \
 # output.cyacd2
+#
+# With -erased, the rows that hold only the erased value are left out of the
+# file. Their ranges are listed in rows at ERASE_RANGE_ADDR ahead of the image
+# rows, and the DFU erases them instead (see erase_ranges() in dfu_user.c).
 
 
 PACKET_CHECKSUM_TYPE = {
@@ -39,6 +44,11 @@ PACKET_CHECKSUM_TYPE = {
 
 APPID_DEFAULT = 1
 
+# Must match dfu_user.h
+ERASE_RANGE_ADDR = 0x60010000
+ERASE_RANGE_ROWS = 16
+ERASE_RANGE_MAGIC = 0x31535245
+
 
 def generate_appinfo(intel_hex=IntelHex()):
     """
@@ -145,6 +155,53 @@ def main(intel_hex_file=str, flash_row=int, cyacd_row_list=list):
         prev_segment_end = end_addr
 
 
+def make_sparse(cyacd_row_list=list, erased_value=int, flash_row=int):
+    """Leaves out the rows that hold only the erased value and adds the rows
+    listing their ranges ahead of the image rows
+
+    Args:
+        cyacd_row_list: list of string of the cyacd2 file, header and
+                        application info followed by the rows
+        erased_value: value of an erased flash byte
+        flash_row: size of the cyacd2 row
+
+    Returns:
+        list: list of string of the sparse cyacd2 file
+    """
+    erased_data = f"{erased_value:02X}" * flash_row
+    rows = []
+    ranges = []
+
+    for row in cyacd_row_list[2:]:
+        if row[9:] != erased_data:
+            rows.append(row)
+            continue
+        address = int.from_bytes(bytes.fromhex(row[1:9]), 'little')
+        if ranges and address < ranges[-1][0] + ranges[-1][1]:
+            continue
+        if ranges and address == ranges[-1][0] + ranges[-1][1]:
+            ranges[-1][1] += flash_row
+        else:
+            ranges.append([address, flash_row])
+
+    ranges_per_row = (flash_row - 8) // 8
+    if len(ranges) > ERASE_RANGE_ROWS * ranges_per_row:
+        raise ValueError(f"Too many erase ranges: {len(ranges)}")
+
+    range_rows = []
+    for index in range(0, len(ranges), ranges_per_row):
+        chunk = ranges[index:index + ranges_per_row]
+        data = (ERASE_RANGE_MAGIC.to_bytes(4, 'little') + len(chunk).to_bytes(4, 'little')
+                + b"".join(addr.to_bytes(4, 'little') + length.to_bytes(4, 'little')
+                           for addr, length in chunk))
+        add_cyacd_row(range_rows, ERASE_RANGE_ADDR + (index // ranges_per_row) * flash_row,
+                      data.hex().upper(), flash_row)
+
+    print(f"Sparse: {len(cyacd_row_list) - 2} rows, {len(rows)} written, "
+          f"{len(ranges)} erase ranges")
+    return cyacd_row_list[:2] + range_rows + rows
+
+
 def write_cyacd2_file(cyacd2_file=str, cyacd_row_list=list):
     """Write file in the cyacd2 format
 
@@ -250,6 +307,10 @@ if __name__ == '__main__':
     parser.add_argument("-size", "--applicationSize", type=auto_int, default=0,
                             action='store', required=False,
                             help="File version number 1-byte value")
+    parser.add_argument("-erased", "--erasedValue", type=auto_int, default=None,
+                            action='store', required=False,
+                            help="Leave out the rows with only this byte value "
+                                 "and add erase ranges for them")
 
     # Parse arguments
     options = parser.parse_args()
@@ -267,5 +328,9 @@ if __name__ == '__main__':
     # Generates main part of the CYACD2 file and write in the file
     main(options.in_intel_hex, options.fileRowSize, cyacd2_rows)
 
+    # Leave out the erased rows
+    if options.erasedValue is not None:
+        cyacd2_rows = make_sparse(cyacd2_rows, options.erasedValue, options.fileRowSize)
+
     # Write row data into the CYACD2 file
     write_cyacd2_file(options.out_cyacd2, cyacd2_rows)
@@ -16,147 +16,119 @@ See the License for the specific language governing permissions and
 limitations under the License.
 """
 
-import subprocess
+import argparse
+import os
 import sys
 
-# This script converts an RSA public key in .pub format
-# to a C-array
+from cryptography.hazmat.primitives import serialization
+from cryptography.hazmat.primitives.asymmetric import rsa
+
+# This script converts RSA keys in PEM format (public key, or private key
+# without password) to the C arrays of cy_ps_stc_public_key_t: the modulus,
+# the exponent and the Barrett coefficient, inverse modulo and rBar used by
+# the Crypto block. The coefficients are checked before they are written:
+# each one against its definition, then by a Barrett and a Montgomery
+# reduction.
+# Without -header, the arrays of the key are printed, or written to the file
+# given with -out, to be pasted into cy_ps_keystorage.c.
+# With -header, a header with the CY_PS_PUBLIC_KEY(base) initializer of the
+# public key in SFlash is written, only if its contents change. The build
+# generates keys/cy_ps_public_key.h this way from the RSA signing key
+# (SIGN_KEY_FILE_RSA).
 # Example Usage:
 # rsa_to_c.py \
 # <path to public key>/rsa_public_generated.txt \
 # -out <path to output directory>/rsa_to_c_generated.txt
+# rsa_to_c.py -header keys/cy_ps_public_key.h keys/cypress-test-rsa-2048.pem
 
 integer_types = (int,)
 
+# Signature schemes (CY_PS_PUBLIC_KEY_*) of the supported key lengths
+SIGNATURE_SCHEMES = {
+    2048: "CY_PS_PUBLIC_KEY_RSA_2048",
+    1024: "CY_PS_PUBLIC_KEY_RSA_1024",
+}
 
-def main():
-    """ Main function
+# Size of expData in cy_ps_stc_public_key_t, in bytes
+EXP_SIZE = 32
 
-    Build the strings to print out the public key modulus and exponent.
-    """
-    if len(sys.argv) < 2:
-        print("Usage: %s <public_key_file_name> [-norev] [-out <file_name>]" % sys.argv[0])
-        return 1
-    is_reverse = True
-    out_file_name = ''
-    for idx in range(len(sys.argv)):
-        if "-norev" == sys.argv[idx]:
-            is_reverse = False
-        if "-out" == sys.argv[idx]:
-            out_file_name = sys.argv[idx + 1]
+HEADER_GUARD = "CY_PS_PUBLIC_KEY_H"
 
-    # list to collect bytes of modulus
-    modulus_list = []
 
-    # string that will contain the parsed RSA exponent
-    rsa_exp = ""
+def main():
+    """ Main function
 
-    # containt the length in bits of an RSA modulus
-    key_len = 0
+    Reads the key and prints its arrays, or writes the header.
+    """
+    parser = argparse.ArgumentParser(
+        description="Convert an RSA key to the C arrays of cy_ps_stc_public_key_t")
+    parser.add_argument("key_file", help="RSA key in PEM format")
+    parser.add_argument("-norev", action="store_true",
+                        help="print the arrays most significant byte first")
+    parser.add_argument("-out", metavar="file_name",
+                        help="write the arrays to this file")
+    parser.add_argument("-header", metavar="file_name",
+                        help="write the cy_ps_stc_public_key_t initializer to "
+                             "this header")
+    args = parser.parse_args()
 
     try:
-        # build openssl command line
-        cmd_line = ['openssl', 'rsa', '-text', '-pubin', '-in',
-                    sys.argv[1],
-                    '-noout']
-
-        output, error = subprocess.Popen(
-            cmd_line, universal_newlines=True,
-            stdout=subprocess.PIPE, stderr=subprocess.PIPE).communicate()
-
-        # check for errors (warnings ignored)
-        lines = error.split("\n")
-        error_lines = []
-        for line in lines:
-            if (len(line) != 0) and (("WARNING:" in line) == False):
-                error_lines.append(line)
-        if len(error_lines) != 0:
-            print("OpenSSL call failed" + "\n" + " ".join(cmd_line) + "\n" + str(error_lines))
-            return 1
-
-        modulus_found = False
-        for line in output.split("\n"):
-            if "Public-Key" in line:
-                # get length of RSA modulus
-                key_len = int(''.join(filter(str.isdigit, line)))
-            if "Modulus" in line:
-                # modulus record is found
-                modulus_found = True
-                continue
-            if "Exponent" in line:
-                modulus_found = False
-                # Exponent record is found
-                rsa_exp = line.split(" ")[2][1:-1]
-            if modulus_found:
-                # Collect bytes of modulus to list
-                modulus_list = modulus_list + line.strip().split(":")
-    except subprocess.CalledProcessError as err:
-        print("OpenSSL call failed with errorcode=" + str(err.returncode) \
-              + "\n" + str(err.cmd) + "\n" + str(err.output))
+        modulo, exponent = read_rsa_key(args.key_file)
+        coefs = calculate_additional_rsa_key_coefs(modulo)
+        check_rsa_key_coefs(modulo, *coefs)
+    except (OSError, ValueError, TypeError) as err:
+        print("%s: %s" % (args.key_file, err))
         return 1
 
-    # Normalize data
-    # Remove empty strings from modulus_list
-    modulus_list = [i for i in modulus_list if i]
-    if (len(modulus_list) == key_len // 8 + 1) and (int(modulus_list[0]) == 0):
-        # remove first zero byte
-        modulus_list.pop(0)
-
-    # Check parsed data
-    if not key_len:
-        print("Key length was not gotten by parsing.")
-        return 1
-    if len(modulus_list) != (key_len // 8):
-        print("Length of parsed Modulus (%s) is not equal to Key length (%s)." % (key_len, len(modulus_list) * 8))
-        return 1
-
-    modulus_hex_str = "".join(modulus_list)
-    (barret, inv_modulo, r_bar) = calculate_additional_rsa_key_coefs(modulus_hex_str)
-
-    barret_list = convert_hexstr_to_list(barret, is_reverse)
-    # add three zero bytes
-    barret_list = ([0] * 3 + barret_list) if not is_reverse else (barret_list + [0] * 3)
-
-    barret_str = build_returned_string(barret_list)
-    barret_str = ".barrettData =\n{\n%s\n}," % barret_str
+    if args.header is None:
+        text = build_key_arrays(modulo, exponent, coefs, not args.norev)
+        if not args.out:
+            print(text)
+        else:
+            with open(args.out, 'w') as outfile:
+                outfile.write(text + "\n")
+        return 0
 
-    inv_modulo_list = convert_hexstr_to_list(inv_modulo, is_reverse)
-    inv_modulo_str = build_returned_string(inv_modulo_list)
-    inv_modulo_str = ".inverseModuloData =\n{\n%s\n}," % inv_modulo_str
+    text = build_header(args.key_file, modulo, exponent, coefs,
+                        os.path.dirname(os.path.abspath(args.header)))
+    try:
+        with open(args.header) as infile:
+            if infile.read() == text:
+                return 0
+    except OSError:
+        pass
+    with open(args.header, 'w') as outfile:
+        outfile.write(text)
+    print("Generated %s from %s" % (args.header, args.key_file))
+    return 0
 
-    r_bar_list = convert_hexstr_to_list(r_bar, is_reverse)
-    r_bar_str = build_returned_string(r_bar_list)
-    r_bar_str = ".rBarData =\n{\n%s\n}," % r_bar_str
 
-    rsa_exp_list = convert_hexstr_to_list(rsa_exp, is_reverse)
-    rsa_exp_list_len = len(rsa_exp_list)
-    if rsa_exp_list_len % 4 != 0:
-        rsa_exp_list = ([0] * (4 - (rsa_exp_list_len % 4)) + rsa_exp_list) if not is_reverse \
-            else (rsa_exp_list + [0] * (4 - (rsa_exp_list_len % 4)))
+def read_rsa_key(key_file):
+    ''' Read the modulus and public exponent of an RSA key.
+        parameter:
+            key_file - public key or private key without password, in PEM
+                       format (PKCS#1, PKCS#8 or SubjectPublicKeyInfo)
+        return:
+            tuple( modulus, exponent )
+    '''
+    with open(key_file, 'rb') as infile:
+        pem = infile.read()
 
-    rsa_exp_str = build_returned_string(rsa_exp_list)
-    rsa_exp_str = ".expData =\n{\n%s\n}," % rsa_exp_str
-
-    # Check and apply is_reverse flag
-    if is_reverse:
-        modulus_list.reverse()
-    modulus_str = build_returned_string(modulus_list)
-    modulus_str = ".moduloData =\n{\n%s\n}," % modulus_str
-
-    if not out_file_name:
-        print(modulus_str)
-        print(rsa_exp_str)
-        print(barret_str)
-        print(inv_modulo_str)
-        print(r_bar_str)
+    if b"PRIVATE KEY" in pem:
+        key = serialization.load_pem_private_key(pem, password=None).public_key()
     else:
-        with open(out_file_name, 'w') as outfile:
-            outfile.write(modulus_str + "\n")
-            outfile.write(rsa_exp_str + "\n")
-            outfile.write(barret_str + "\n")
-            outfile.write(inv_modulo_str + "\n")
-            outfile.write(r_bar_str + "\n")
-    return 0
+        key = serialization.load_pem_public_key(pem)
+    if not isinstance(key, rsa.RSAPublicKey):
+        raise ValueError("not an RSA key")
+
+    numbers = key.public_numbers()
+    if numbers.n.bit_length() not in SIGNATURE_SCHEMES:
+        raise ValueError("RSA-%d is not supported, only %s" %
+                         (numbers.n.bit_length(),
+                          ", ".join("RSA-%d" % bits for bits in SIGNATURE_SCHEMES)))
+    if (numbers.e.bit_length() + 7) // 8 > EXP_SIZE:
+        raise ValueError("The exponent is longer than %d bytes" % EXP_SIZE)
+    return numbers.n, numbers.e
 
 
 def extended_euclid(modulo):
@@ -227,6 +199,44 @@ def calculate_additional_rsa_key_coefs(modulo):
     return ret_arrays
 
 
+def check_rsa_key_coefs(modulo, barret_coef, inverse_modulo, r_bar):
+    ''' Check the additional coefficients of an RSA key against their
+        definitions, then use them for a Barrett and a Montgomery reduction
+        of (n - 1)^2 and compare with the remainder of the division.
+        parameters:
+            modulo - part of RSA key
+            barret_coef, inverse_modulo, r_bar - coefficients of the modulo
+        raise:
+            ValueError if a coefficient is wrong
+    '''
+    k = modulo.bit_length()
+    r = 1 << k
+
+    if modulo % 2 == 0:
+        raise ValueError("Modulus must be odd")
+    if not (barret_coef * modulo <= r * r < (barret_coef + 1) * modulo):
+        raise ValueError("Wrong Barrett coefficient")
+    if not (0 <= r_bar < modulo) or (r - r_bar) % modulo != 0:
+        raise ValueError("Wrong rBar")
+    # r * r' - n * n' = 1 for an integer r'
+    if not (0 < inverse_modulo < r) or (modulo * inverse_modulo + 1) % r != 0:
+        raise ValueError("Wrong inverse modulo")
+
+    x = (modulo - 1) * (modulo - 1)
+
+    # Barrett reduction: the estimated quotient is at most 2 too small
+    q = ((x >> (k - 1)) * barret_coef) >> (k + 1)
+    rem = x - q * modulo
+    if not (0 <= rem < 3 * modulo) or rem % modulo != x % modulo:
+        raise ValueError("Barrett reduction with the coefficients failed")
+
+    # Montgomery reduction: x * r^-1 mod n
+    m = ((x % r) * inverse_modulo) % r
+    t = x + m * modulo
+    if t % r != 0 or ((t // r) * r) % modulo != x % modulo:
+        raise ValueError("Montgomery reduction with the coefficients failed")
+
+
 def convert_hexstr_to_list(s, reversed=False):
     '''Converts a string likes '0001aaff...' to list [0, 1, 170, 255].
         Also an input parameter can be an integer, in this case it will be
@@ -248,6 +258,102 @@ def convert_hexstr_to_list(s, reversed=False):
     return l
 
 
+def build_key_lists(modulo, exponent, coefs, is_reverse):
+    ''' Build the byte lists of the arrays of cy_ps_stc_public_key_t.
+        parameters:
+            modulo, exponent - RSA key
+            coefs - tuple( barret_coef, inverse_modulo, r_bar )
+            is_reverse - least significant byte first
+        return:
+            list of ( field name, byte list )
+    '''
+    (barret, inv_modulo, r_bar) = coefs
+    key_bytes = modulo.bit_length() // 8
+
+    barret_list = convert_hexstr_to_list(barret, is_reverse)
+    # add three zero bytes
+    barret_list = ([0] * 3 + barret_list) if not is_reverse else (barret_list + [0] * 3)
+
+    inv_modulo_list = convert_hexstr_to_list(inv_modulo, is_reverse)
+    r_bar_list = convert_hexstr_to_list(r_bar, is_reverse)
+
+    rsa_exp_list = convert_hexstr_to_list(exponent, is_reverse)
+    rsa_exp_list_len = len(rsa_exp_list)
+    if rsa_exp_list_len % 4 != 0:
+        rsa_exp_list = ([0] * (4 - (rsa_exp_list_len % 4)) + rsa_exp_list) if not is_reverse \
+            else (rsa_exp_list + [0] * (4 - (rsa_exp_list_len % 4)))
+
+    modulus_list = list(modulo.to_bytes(key_bytes, "little" if is_reverse else "big"))
+
+    return [("moduloData", modulus_list),
+            ("expData", rsa_exp_list),
+            ("barrettData", barret_list),
+            ("inverseModuloData", pad_list(inv_modulo_list, key_bytes, is_reverse)),
+            ("rBarData", pad_list(r_bar_list, key_bytes, is_reverse))]
+
+
+def pad_list(inp_list, length, is_reverse):
+    """Pads a byte list with zeros up to the key length, on the side of its
+    most significant byte
+    """
+    pad = [0] * (length - len(inp_list))
+    return (inp_list + pad) if is_reverse else (pad + inp_list)
+
+
+def build_key_arrays(modulo, exponent, coefs, is_reverse):
+    """Builds the arrays of one key, to be pasted into cy_ps_keystorage.c
+    """
+    return "\n".join(".%s =\n{\n%s\n}," % (name, build_returned_string(data))
+                     for name, data in build_key_lists(modulo, exponent, coefs, is_reverse))
+
+
+def build_initializer(key_file, modulo, exponent, coefs):
+    """Builds the CY_PS_PUBLIC_KEY(base) macro: a cy_ps_stc_public_key_t
+    initializer for a key stored at the address base
+    """
+    key_bytes = modulo.bit_length() // 8
+    lines = [
+        "/* %s: RSA-%d, exponent %d */" % (key_file, modulo.bit_length(), exponent),
+        "#define CY_PS_PUBLIC_KEY(base)",
+        "{",
+        "    .objSize = sizeof(cy_ps_stc_public_key_t),",
+        "    .signatureScheme = %s," % SIGNATURE_SCHEMES[modulo.bit_length()],
+        "    .publicKeyStruct =",
+        "    {",
+        "        .moduloAddr         = (base) + offsetof(cy_ps_stc_public_key_t, moduloData),",
+        "        .moduloSize         = CY_PS_PUBLIC_KEY_SIZEOF_BYTE * %du," % key_bytes,
+        "        .expAddr            = (base) + offsetof(cy_ps_stc_public_key_t, expData),",
+        "        .expSize            = CY_PS_PUBLIC_KEY_SIZEOF_BYTE * CY_PS_PUBLIC_KEY_EXPLENGTH,",
+        "        .barrettAddr        = (base) + offsetof(cy_ps_stc_public_key_t, barrettData),",
+        "        .inverseModuloAddr  = (base) + offsetof(cy_ps_stc_public_key_t, inverseModuloData),",
+        "        .rBarAddr           = (base) + offsetof(cy_ps_stc_public_key_t, rBarData),",
+        "    },",
+    ]
+    for name, data in build_key_lists(modulo, exponent, coefs, True):
+        lines += ["    .%s =" % name, "    {"]
+        lines += ["    " + line for line in build_returned_string(data).split("\n")]
+        lines += ["    },"]
+    lines += ["}"]
+
+    width = max(len(line) for line in lines[1:])
+    return "\n".join([lines[0]] + ["%-*s \\" % (width, line) for line in lines[1:-1]] + [lines[-1]])
+
+
+def build_header(key_file, modulo, exponent, coefs, header_dir):
+    """Builds the header with the initializer of the public key in SFlash
+    """
+    name = os.path.relpath(os.path.abspath(key_file), header_dir).replace(os.sep, "/")
+    text = ["/* Autogenerated by rsa_to_c.py, do not edit. */",
+            "#ifndef %s" % HEADER_GUARD,
+            "#define %s" % HEADER_GUARD,
+            "",
+            build_initializer(name, modulo, exponent, coefs),
+            "",
+            "#endif /* %s */" % HEADER_GUARD,
+            ""]
+    return "\n".join(text)
+
+
 def build_returned_string(inp_list):
     """Converts a list to a C-style array of hexadecimal numbers string
     """
@@ -266,5 +372,4 @@ def build_returned_string(inp_list):
 
 
 if __name__ == "__main__":
-    main()
-
+    sys.exit(main())
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+# This script decodes the FreeRTOS run-time statistics reports printed by the
+# CM4 user application built with RTOS_STATS=1 ("RTOS_STATS:<hex>" lines)
+# from a serial terminal log. The CPU load of each task is computed between
+# two consecutive reports of the same boot. Lines split by other output fail
+# the CRC check and are skipped.
+# Example Usage:
+# rtos_stats.py decode uart.log
+# rtos_stats.py decode uart.log --all
+# rtos_stats.py decode - < uart.log
+
+RECORD_PREFIX = "RTOS_STATS:"
+
+# Must match rtos_stats.h
+RTOS_STATS_MAGIC = 0x54535452
+RTOS_STATS_VERSION = 1
+RTOS_STATS_HEADER = struct.Struct("<IHHIIIIIII")
+RTOS_STATS_TASK = struct.Struct("<16sIIIBBH")
+RTOS_STATS_CRC = struct.Struct("<I")
+COUNTER_MASK = 0xFFFFFFFF
+
+# eTaskState
+TASK_STATES = ["running", "ready", "blocked", "suspended", "deleted", "invalid"]
+
+
+class Report:
+    """One decoded report"""
+
+    def __init__(self, raw):
+        if len(raw) < RTOS_STATS_HEADER.size:
+            raise ValueError(f"Bad record length {len(raw)}")
+        (magic, version, count, self.tasks, self.timer_hz, self.total_time,
+         self.tick_count, self.heap_size, self.heap_used, self.heap_arena) = RTOS_STATS_HEADER.unpack_from(raw)
+        if magic != RTOS_STATS_MAGIC or version != RTOS_STATS_VERSION:
+            raise ValueError(f"Unsupported record: magic 0x{magic:08X}, version {version}")
+
+        size = RTOS_STATS_HEADER.size + count * RTOS_STATS_TASK.size
+        if len(raw) != size + RTOS_STATS_CRC.size:
+            raise ValueError(f"Bad record length {len(raw)}")
+        (crc,) = RTOS_STATS_CRC.unpack_from(raw, size)
+        if crc != zlib.crc32(raw[:size]):
+            raise ValueError("Bad record CRC")
+
+        # Task number to (name, run time, stack free, priority, state)
+        self.entries = dict()
+        for i in range(count):
+            name, number, run_time, stack_free, priority, state, _ = RTOS_STATS_TASK.unpack_from(
+                raw, RTOS_STATS_HEADER.size + i * RTOS_STATS_TASK.size)
+            name = name.split(b"\0", 1)[0].decode("ascii", errors="replace")
+            self.entries[number] = (name, run_time, stack_free, priority, state)
+
+    def follows(self, previous):
+        """True if this report was taken after previous in the same boot"""
+        return previous is not None and self.tick_count >= previous.tick_count
+
+
+def read_log(path=str):
+    """Decode all reports in a log
+
+    Args:
+        path: serial terminal log file, or "-" for the standard input
+
+    Returns:
+        tuple: list of reports, number of skipped lines
+    """
+    reports = list()
+    skipped = 0
+    log = sys.stdin if path == "-" else open(path, "r", errors="ignore")
+    with log:
+        for line in log:
+            pos = line.find(RECORD_PREFIX)
+            if pos < 0:
+                continue
+            try:
+                reports.append(Report(bytes.fromhex(line[pos + len(RECORD_PREFIX):].strip())))
+            except ValueError:
+                skipped += 1
+
+    if not reports:
+        raise ValueError(f"No RTOS stats report found in {path}")
+    return reports, skipped
+
+
+def task_loads(report, previous):
+    """CPU load of each task since the previous report, or since the start
+
+    Args:
+        report: report
+        previous: previous report of the same boot, or None
+
+    Returns:
+        dict: task number to CPU load in percent
+    """
+    if previous is None:
+        elapsed = report.total_time
+    else:
+        elapsed = (report.total_time - previous.total_time) & COUNTER_MASK
+
+    loads = dict()
+    for number, entry in report.entries.items():
+        run_time = entry[1]
+        if previous is not None and number in previous.entries:
+            run_time = (run_time - previous.entries[number][1]) & COUNTER_MASK
+        loads[number] = run_time * 100.0 / elapsed if elapsed else 0.0
+    return loads
+
+
+def print_report(report, previous):
+    if previous is None:
+        print(f"Since start, tick {report.tick_count}:")
+    else:
+        seconds = ((report.total_time - previous.total_time) & COUNTER_MASK) / report.timer_hz
+        print(f"Tick {previous.tick_count} to {report.tick_count} ({seconds:.3f} s):")
+
+    loads = task_loads(report, previous)
+    print(f"  {'Task':<16} {'CPU':>7} {'Stack free':>11} {'Prio':>5}  State")
+    for number, (name, _, stack_free, priority, state) in sorted(
+            report.entries.items(), key=lambda item: -loads[item[0]]):
+        state_name = TASK_STATES[state] if state < len(TASK_STATES) else str(state)
+        print(f"  {name:<16} {loads[number]:>6.2f}% {stack_free:>11} {priority:>5}  {state_name}")
+    if len(report.entries) < report.tasks:
+        print(f"  {report.tasks - len(report.entries)} task(s) did not fit in the report")
+
+
+def decode(log_file, show_all):
+    reports, skipped = read_log(log_file)
+    print(f"{log_file}: {len(reports)} report(s), {skipped} line(s) skipped")
+
+    if reports[-1].timer_hz == 0:
+        print("Run time counter not available, no 32-bit TCPWM counter was free")
+
+    # Lowest free stack of each task over all the reports
+    stack_min = dict()
+    previous = None
+    for report in reports:
+        if not report.follows(previous):
+            previous = None
+        if report.timer_hz and (show_all or report is reports[-1]):
+            print_report(report, previous)
+        for name, _, stack_free, _, _ in report.entries.values():
+            stack_min[name] = min(stack_free, stack_min.get(name, stack_free))
+        previous = report
+
+    last = reports[-1]
+    print("Lowest free stack (bytes):")
+    for name, stack_free in sorted(stack_min.items(), key=lambda item: item[1]):
+        print(f"  {name:<16} {stack_free:>11}")
+    # The arena only grows, but freed blocks in it are not counted: the
+    # peak of the used bytes is at most the arena, not equal to it
+    print(f"Heap (bytes): size {last.heap_size}, used {last.heap_used}, "
+          f"free {last.heap_size - last.heap_used}, taken by malloc {last.heap_arena}, "
+          f"never taken {last.heap_size - last.heap_arena}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the FreeRTOS run-time statistics reports")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    decode_parser = subparsers.add_parser("decode", help="Print the task CPU load, stack and heap usage of a log")
+    decode_parser.add_argument("log", help="Serial terminal log, or - for the standard input")
+    decode_parser.add_argument("--all", action="store_true", help="Print the CPU load of every report interval")
+
+    args = parser.parse_args()
+    try:
+        decode(args.log, args.all)
+    except ValueError as error:
+        sys.exit(str(error))
+
+
+if __name__ == "__main__":
+    main()
@@ -52,10 +52,34 @@
 extern "C" {
 #endif
 
+/* Device and offset of the secondary slots. External flash areas are
+ * addressed by their SMIF XIP address, see cy_smif_psoc6.c.
+ */
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+#ifndef CY_BOOT_EXTERNAL_DEVICE_INDEX
+#define CY_BOOT_EXTERNAL_DEVICE_INDEX       (0u)
+#endif
+#define CY_BOOT_SECONDARY_DEVICE_ID         FLASH_DEVICE_EXTERNAL_FLASH(CY_BOOT_EXTERNAL_DEVICE_INDEX)
+#define CY_BOOT_SECONDARY_OFFSET(addr)      (addr)
+#else
+#define CY_BOOT_SECONDARY_DEVICE_ID         FLASH_DEVICE_INTERNAL_FLASH
+#define CY_BOOT_SECONDARY_OFFSET(addr)      ((addr) - CY_START_OF_FLASH)
+#endif
+
 /* Declare the flash partitions structures */
 static struct flash_area bootloader;
 static struct flash_area primary_1;
 static struct flash_area secondary_1;
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+static struct flash_area primary_2;
+static struct flash_area secondary_2;
+#endif
+#ifdef MCUBOOT_SWAP_USING_SCRATCH
+static struct flash_area scratch;
+#endif
+#ifdef MCUBOOT_SWAP_USING_STATUS
+static struct flash_area status;
+#endif
 
 static struct flash_area bootloader =
 {
@@ -76,17 +100,65 @@ static struct flash_area primary_1 =
 static struct flash_area secondary_1 =
 {
     .fa_id = FLASH_AREA_IMG_1_SECONDARY,
-    .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
-    .fa_off = CY_BOOT_SECONDARY_1_START_ADDRESS - CY_START_OF_FLASH,
+    .fa_device_id = CY_BOOT_SECONDARY_DEVICE_ID,
+    .fa_off = CY_BOOT_SECONDARY_OFFSET(CY_BOOT_SECONDARY_1_START_ADDRESS),
     .fa_size = CY_BOOT_SECONDARY_1_SIZE
 };
 
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/* Image 1 is the CM0+ app, image 2 is the CM4 app placed right after it */
+static struct flash_area primary_2 =
+{
+    .fa_id = FLASH_AREA_IMG_2_PRIMARY,
+    .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
+    .fa_off = CY_BOOT_PRIMARY_2_START_ADDRESS - CY_START_OF_FLASH,
+    .fa_size = CY_BOOT_PRIMARY_2_SIZE
+};
+
+static struct flash_area secondary_2 =
+{
+    .fa_id = FLASH_AREA_IMG_2_SECONDARY,
+    .fa_device_id = CY_BOOT_SECONDARY_DEVICE_ID,
+    .fa_off = CY_BOOT_SECONDARY_OFFSET(CY_BOOT_SECONDARY_2_START_ADDRESS),
+    .fa_size = CY_BOOT_SECONDARY_2_SIZE
+};
+#endif
+
+#ifdef MCUBOOT_SWAP_USING_SCRATCH
+static struct flash_area scratch =
+{
+    .fa_id = FLASH_AREA_IMAGE_SCRATCH,
+    .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
+    .fa_off = CY_BOOT_SCRATCH_START_ADDRESS - CY_START_OF_FLASH,
+    .fa_size = CY_BOOT_SCRATCH_SIZE
+};
+#endif
+
+#ifdef MCUBOOT_SWAP_USING_STATUS
+/* Swap status partition, must hold the status of both slots and the scratch */
+#ifdef BOOT_SWAP_STATUS_SIZE
+_Static_assert(CY_BOOT_SWAP_STATUS_SIZE >= BOOT_SWAP_STATUS_SIZE, "Swap status partition is too small");
+#endif
+
+static struct flash_area status =
+{
+    .fa_id = FLASH_AREA_IMAGE_SWAP_STATUS,
+    .fa_device_id = FLASH_DEVICE_INTERNAL_FLASH,
+    .fa_off = CY_BOOT_SWAP_STATUS_START_ADDRESS - CY_START_OF_FLASH,
+    .fa_size = CY_BOOT_SWAP_STATUS_SIZE
+};
+#endif
+
 /* Use external Flash Map Descriptors */
 struct flash_area *boot_area_descs[] =
 {
     &bootloader,
     &primary_1,
     &secondary_1,
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+    &primary_2,
+    &secondary_2,
+#endif
 #ifdef MCUBOOT_SWAP_USING_SCRATCH
     &scratch,
 #endif
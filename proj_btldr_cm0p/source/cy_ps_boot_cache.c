@@ -0,0 +1,332 @@
+/******************************************************************************
+* File Name: cy_ps_boot_cache.c
+*
+* Description: This file contains the validated-image cache of the fast-boot
+*   mode. After the primary slot is validated by boot_go(), a copy of its
+*   image header and TLV trailer (which holds the image hash and signature)
+*   is recorded in the last row of the protected storage together with a
+*   flash generation counter. On a warm reset, boot_go() is skipped when
+*   no upgrade is pending and the header, trailer and counter are unchanged.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "cy_ps_boot_cache.h"
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define BOOT_CACHE_RECORD_MAGIC         (0x33435642UL)      /* "BVC3", changes with the record layout */
+#define BOOT_CACHE_MAX_TRAILER          (452u)
+#define BOOT_CACHE_CRC32_POLY           (0xEDB88320UL)
+
+/* Resets that may skip the validation. Any other reset cause forces a full
+ * validation.
+ */
+#define BOOT_CACHE_WARM_RESETS          (CY_SYSLIB_RESET_HWWDT | CY_SYSLIB_RESET_SOFT)
+
+#define BOOT_CACHE_SLOT                 ((const uint8_t *)CY_BOOT_PRIMARY_1_START_ADDRESS)
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************/
+/* Layout of the cache record in flash */
+typedef struct
+{
+    uint32_t magic;                     /* BOOT_CACHE_RECORD_MAGIC */
+    uint32_t generation;                /* Flash generation counter */
+    uint32_t verified_generation;       /* Generation of the validated image */
+    uint32_t fast_boots;                /* Consecutive boots without validation */
+    uint32_t row_writes;                /* Writes of the row since it was last torn or erased */
+    uint32_t trailer_len;               /* Number of used trailer bytes */
+    struct image_header header;         /* Image header of the validated image */
+    uint8_t  trailer[BOOT_CACHE_MAX_TRAILER];
+    uint32_t crc;                       /* CRC32 of the fields above */
+} boot_cache_record_t;
+
+_Static_assert(sizeof(boot_cache_record_t) == CY_FLASH_SIZEOF_ROW, "Cache record must be one flash row");
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Record buffer for the flash writes */
+static boot_cache_record_t boot_cache_buf;
+
+/*******************************************************************************
+ * Function Name: boot_cache_crc32
+ *******************************************************************************
+ * Summary:
+ *  Calculates the CRC32 (IEEE 802.3) of a buffer.
+ *
+ * Parameters:
+ *  data - Pointer to the data
+ *  size - Number of bytes
+ *
+ * Return:
+ *  uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t boot_cache_crc32(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0UL; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (crc >> 1U) ^ (BOOT_CACHE_CRC32_POLY & (0UL - (crc & 1UL)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: boot_cache_record_valid
+ *******************************************************************************
+ * Summary:
+ *  Checks the magic and CRC of the cache record in flash.
+ *
+ * Parameters:
+ *  record - Pointer to the record
+ *
+ * Return:
+ *  bool - true if the record is intact
+ *
+ *******************************************************************************/
+static bool boot_cache_record_valid(const boot_cache_record_t *record)
+{
+    return (record->magic == BOOT_CACHE_RECORD_MAGIC) &&
+           (record->trailer_len <= BOOT_CACHE_MAX_TRAILER) &&
+           (record->crc == boot_cache_crc32((const uint8_t *)record, offsetof(boot_cache_record_t, crc)));
+}
+
+/*******************************************************************************
+ * Function Name: boot_cache_get_trailer
+ *******************************************************************************
+ * Summary:
+ *  Locates the TLV trailer (protected and unprotected TLVs) of the image in
+ *  the primary slot.
+ *
+ * Parameters:
+ *  trailer - Returns the address of the trailer
+ *  len     - Returns the size of the trailer
+ *
+ * Return:
+ *  bool - false if the slot holds no image or the trailer cannot be cached
+ *
+ *******************************************************************************/
+static bool boot_cache_get_trailer(const uint8_t **trailer, uint32_t *len)
+{
+    const struct image_header *hdr = (const struct image_header *)BOOT_CACHE_SLOT;
+    struct image_tlv_info info;
+    uint32_t offset;
+
+    if ((hdr->ih_magic != IMAGE_MAGIC) || (hdr->ih_img_size > CY_BOOT_PRIMARY_1_SIZE))
+    {
+        return false;
+    }
+
+    offset = (uint32_t)hdr->ih_hdr_size + hdr->ih_img_size;
+    if ((offset + hdr->ih_protect_tlv_size + sizeof(info)) > CY_BOOT_PRIMARY_1_SIZE)
+    {
+        return false;
+    }
+
+    (void)memcpy(&info, &BOOT_CACHE_SLOT[offset + hdr->ih_protect_tlv_size], sizeof(info));
+    *len = (uint32_t)hdr->ih_protect_tlv_size + info.it_tlv_tot;
+    *trailer = &BOOT_CACHE_SLOT[offset];
+
+    return (info.it_magic == IMAGE_TLV_INFO_MAGIC) &&
+           (*len <= BOOT_CACHE_MAX_TRAILER) &&
+           ((offset + *len) <= CY_BOOT_PRIMARY_1_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: boot_cache_write
+ *******************************************************************************
+ * Summary:
+ *  Writes boot_cache_buf to flash unless the record is already up to date.
+ *  The row write count of the record in flash is carried over and
+ *  incremented; no write is done once it reaches
+ *  CY_PS_BOOT_CACHE_MAX_ROW_WRITES.
+ *
+ * Return:
+ *  bool - true if the record in flash matches boot_cache_buf
+ *
+ *******************************************************************************/
+static bool boot_cache_write(void)
+{
+    const boot_cache_record_t *record = (const boot_cache_record_t *)CY_PS_BOOT_CACHE_ADDR;
+
+    boot_cache_buf.row_writes = boot_cache_record_valid(record) ? record->row_writes : 0UL;
+    boot_cache_buf.crc = boot_cache_crc32((const uint8_t *)&boot_cache_buf, offsetof(boot_cache_record_t, crc));
+
+    if (memcmp(&boot_cache_buf, record, sizeof(boot_cache_buf)) == 0)
+    {
+        return true;
+    }
+
+    if (boot_cache_buf.row_writes >= CY_PS_BOOT_CACHE_MAX_ROW_WRITES)
+    {
+        return false;
+    }
+
+    boot_cache_buf.row_writes++;
+    boot_cache_buf.crc = boot_cache_crc32((const uint8_t *)&boot_cache_buf, offsetof(boot_cache_record_t, crc));
+
+    /* A torn write leaves an invalid record, which only forces a full
+     * validation on the next boot.
+     */
+    return (Cy_Flash_WriteRow(CY_PS_BOOT_CACHE_ADDR, (const uint32_t *)&boot_cache_buf) == CY_FLASH_DRV_SUCCESS);
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_cache_lookup
+ *******************************************************************************
+ * Summary:
+ *  Decides if the validation of the primary slot can be skipped. When an
+ *  upgrade is pending, the flash generation counter is incremented before
+ *  boot_go() writes to the primary slot. Must be called instead of boot_go();
+ *  boot_go() is still required for any result other than
+ *  CY_PS_BOOT_CACHE_HIT.
+ *
+ *  The number of consecutive fast boots is kept in the cache record, which
+ *  the user apps on CM4 cannot access. It is written before the validation
+ *  is skipped, so a fast boot is allowed only if the count could be stored.
+ *  Each fast boot thus writes the row once; once the row has been written
+ *  CY_PS_BOOT_CACHE_MAX_ROW_WRITES times, every boot is validated.
+ *
+ * Parameters:
+ *  rsp - Filled with the primary slot image on CY_PS_BOOT_CACHE_HIT
+ *
+ * Return:
+ *  cy_en_ps_boot_cache_result_t - The reason for the decision
+ *
+ *******************************************************************************/
+cy_en_ps_boot_cache_result_t cy_ps_boot_cache_lookup(struct boot_rsp *rsp)
+{
+    const boot_cache_record_t *record = (const boot_cache_record_t *)CY_PS_BOOT_CACHE_ADDR;
+    const uint8_t *trailer = NULL;
+    uint32_t trailer_len = 0UL;
+    cy_en_ps_boot_cache_result_t result;
+
+    if (boot_swap_type() != BOOT_SWAP_TYPE_NONE)
+    {
+        if (boot_cache_record_valid(record) && (record->verified_generation == record->generation))
+        {
+            (void)memcpy(&boot_cache_buf, record, sizeof(boot_cache_buf));
+            boot_cache_buf.generation++;
+            (void)boot_cache_write();
+        }
+        result = CY_PS_BOOT_CACHE_PENDING;
+    }
+    else if ((Cy_SysLib_GetResetReason() & BOOT_CACHE_WARM_RESETS) == 0UL)
+    {
+        result = CY_PS_BOOT_CACHE_COLD;
+    }
+    else if (boot_cache_record_valid(record) && (record->row_writes >= CY_PS_BOOT_CACHE_MAX_ROW_WRITES))
+    {
+        result = CY_PS_BOOT_CACHE_WORN;
+    }
+    else if (!boot_cache_record_valid(record) ||
+             (record->verified_generation != record->generation) ||
+             !boot_cache_get_trailer(&trailer, &trailer_len) ||
+             (memcmp(&record->header, BOOT_CACHE_SLOT, sizeof(record->header)) != 0) ||
+             (record->trailer_len != trailer_len) ||
+             (memcmp(record->trailer, trailer, trailer_len) != 0))
+    {
+        result = CY_PS_BOOT_CACHE_MISS;
+    }
+    else if (record->fast_boots >= CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL)
+    {
+        result = CY_PS_BOOT_CACHE_PERIODIC;
+    }
+    else
+    {
+        (void)memcpy(&boot_cache_buf, record, sizeof(boot_cache_buf));
+        boot_cache_buf.fast_boots++;
+        result = boot_cache_write() ? CY_PS_BOOT_CACHE_HIT : CY_PS_BOOT_CACHE_MISS;
+    }
+
+    if (result == CY_PS_BOOT_CACHE_HIT)
+    {
+        rsp->br_hdr = (const struct image_header *)BOOT_CACHE_SLOT;
+        rsp->br_flash_dev_id = (uint8_t)FLASH_DEVICE_INTERNAL_FLASH;
+        rsp->br_image_off = CY_BOOT_PRIMARY_1_START_ADDRESS - CY_START_OF_FLASH;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_cache_update
+ *******************************************************************************
+ * Summary:
+ *  Records the image in the primary slot as validated and clears the count
+ *  of fast boots. Must be called only after boot_go() succeeded. The flash
+ *  row is written only when the record changes.
+ *
+ *******************************************************************************/
+void cy_ps_boot_cache_update(void)
+{
+    const boot_cache_record_t *record = (const boot_cache_record_t *)CY_PS_BOOT_CACHE_ADDR;
+    const uint8_t *trailer = NULL;
+    uint32_t trailer_len = 0UL;
+
+    if (!boot_cache_get_trailer(&trailer, &trailer_len))
+    {
+        return;
+    }
+
+    (void)memset(&boot_cache_buf, 0, sizeof(boot_cache_buf));
+    boot_cache_buf.magic = BOOT_CACHE_RECORD_MAGIC;
+    boot_cache_buf.generation = boot_cache_record_valid(record) ? record->generation : 0UL;
+    boot_cache_buf.verified_generation = boot_cache_buf.generation;
+    boot_cache_buf.trailer_len = trailer_len;
+    (void)memcpy(&boot_cache_buf.header, BOOT_CACHE_SLOT, sizeof(boot_cache_buf.header));
+    (void)memcpy(boot_cache_buf.trailer, trailer, trailer_len);
+
+    (void)boot_cache_write();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,106 @@
+/******************************************************************************
+* File Name: cy_ps_boot_cache.h
+*
+* Description: Header file for the validated-image cache used by the
+*   fast-boot mode of the bootloader.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CY_PS_BOOT_CACHE_H
+#define CY_PS_BOOT_CACHE_H
+
+#include "bootutil/image.h"
+#include "bootutil/bootutil.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************************
+*               Macros
+***************************************/
+/* Set FAST_BOOT to 1 in the Makefile to skip the validation of an unchanged
+ * primary slot on warm resets.
+ */
+#ifndef FAST_BOOT
+#define FAST_BOOT                               (0u)
+#endif
+
+/* Number of consecutive fast boots after which the primary slot is fully
+ * validated again.
+ */
+#ifndef CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL
+#define CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL    (16u)
+#endif
+
+/* Number of writes of the cache row after which the cache stops skipping
+ * the validation. Each fast boot writes the row once, so this bounds the
+ * wear of a reset loop well below the flash endurance (100 k cycles).
+ */
+#ifndef CY_PS_BOOT_CACHE_MAX_ROW_WRITES
+#define CY_PS_BOOT_CACHE_MAX_ROW_WRITES         (50000u)
+#endif
+
+/* The cache record uses the last row of the protected storage */
+#define CY_PS_BOOT_CACHE_ADDR                   (PROTECTED_MEM_START + PROTECTED_MEM_SIZE - CY_FLASH_SIZEOF_ROW)
+
+/***************************************
+*               Structures
+***************************************/
+typedef enum
+{
+    CY_PS_BOOT_CACHE_HIT = 0U,                  /* Validation skipped */
+    CY_PS_BOOT_CACHE_COLD,                      /* Power-on, external or fault reset */
+    CY_PS_BOOT_CACHE_PERIODIC,                  /* CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL reached */
+    CY_PS_BOOT_CACHE_PENDING,                   /* Upgrade pending in the secondary slot */
+    CY_PS_BOOT_CACHE_MISS,                      /* No record, or the image or generation changed */
+    CY_PS_BOOT_CACHE_WORN                       /* CY_PS_BOOT_CACHE_MAX_ROW_WRITES reached */
+} cy_en_ps_boot_cache_result_t;
+
+/*******************************************************************************
+* Functions
+*******************************************************************************/
+cy_en_ps_boot_cache_result_t cy_ps_boot_cache_lookup(struct boot_rsp *rsp);
+void cy_ps_boot_cache_update(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CY_PS_BOOT_CACHE_H */
+
+/* [] END OF FILE */
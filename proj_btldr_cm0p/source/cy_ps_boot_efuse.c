@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name: cy_ps_boot_efuse.c
+*
+* Description: This file reads the lifecycle and access restriction eFuse
+*   bytes in one pass and publishes them in the shared SRAM, so that the user
+*   applications do not need SROM system calls to read them. The bootloader
+*   itself always reads the eFuses and never uses a snapshot left in the
+*   shared SRAM.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+
+#include <string.h>
+#include "cy_pdl.h"
+#include "cy_ps_boot_efuse.h"
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_efuse_publish
+ *******************************************************************************
+ * Summary:
+ *  Reads the CY_PS_BOOT_EFUSE_COUNT eFuse bytes starting at
+ *  CY_PS_BOOT_EFUSE_OFFSET into the shared SRAM. The magic is written last,
+ *  and only when all the reads succeeded, so that the applications never see
+ *  a partial snapshot.
+ *
+ * Return:
+ *  cy_en_efuse_status_t - CY_EFUSE_SUCCESS, or the status of the first read
+ *  that failed
+ *
+ *******************************************************************************/
+cy_en_efuse_status_t cy_ps_boot_efuse_publish(void)
+{
+    cy_stc_ps_boot_efuse_t *efuse = &CY_PS_BOOT_SHARED->efuse;
+    cy_en_efuse_status_t status = CY_EFUSE_SUCCESS;
+
+    memset(efuse, 0, sizeof(*efuse));
+
+    for (uint32_t i = 0UL; (i < CY_PS_BOOT_EFUSE_COUNT) && (CY_EFUSE_SUCCESS == status); i++)
+    {
+        status = Cy_EFUSE_GetEfuseByte(CY_PS_BOOT_EFUSE_OFFSET + i, &efuse->bytes[i]);
+    }
+
+    if (CY_EFUSE_SUCCESS == status)
+    {
+        efuse->version = CY_PS_BOOT_EFUSE_VERSION;
+        efuse->count = CY_PS_BOOT_EFUSE_COUNT;
+        efuse->crc = cy_ps_boot_efuse_crc32(efuse);
+        efuse->magic = CY_PS_BOOT_EFUSE_MAGIC;
+    }
+
+    return status;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: cy_ps_boot_log.c
+*
+* Description: This file contains the deferred, tokenized bootloader logging.
+*   Log entries are appended to the boot log record in the shared SRAM and
+*   are printed by the CM4 user application, or by the bootloader itself
+*   when no bootable image is found.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include "cy_pdl.h"
+#include "cy_ps_boot_log.h"
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_log_init
+ *******************************************************************************
+ * Summary:
+ *  Clears the boot log record. Must be called before the first
+ *  CY_PS_BOOT_LOG().
+ *
+ *******************************************************************************/
+void cy_ps_boot_log_init(void)
+{
+    cy_stc_ps_boot_log_t *log = &CY_PS_BOOT_SHARED->log;
+
+#if (BOOT_LOG_DEFERRED == 1u)
+    log->magic   = CY_PS_BOOT_LOG_MAGIC;
+#else
+    /* The messages are printed, the CM4 user app has no record to report */
+    log->magic   = 0UL;
+#endif
+    log->version = CY_PS_BOOT_LOG_VERSION;
+    log->count   = 0U;
+    log->dropped = 0UL;
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_log_write
+ *******************************************************************************
+ * Summary:
+ *  Appends one entry to the boot log record. Entries that do not fit are
+ *  counted and dropped. Called by CY_PS_BOOT_LOG().
+ *
+ * Parameters:
+ *  token - Address of the format string in the .cy_ps_log_fmt section
+ *  args  - Pointer to the arguments
+ *  nargs - Number of arguments
+ *
+ *******************************************************************************/
+void cy_ps_boot_log_write(uint32_t token, const uint32_t *args, uint32_t nargs)
+{
+    cy_stc_ps_boot_log_t *log = &CY_PS_BOOT_SHARED->log;
+
+    if ((log->count + 1UL + nargs) > CY_PS_BOOT_LOG_MAX_WORDS)
+    {
+        log->dropped++;
+        return;
+    }
+
+    log->data[log->count++] = (nargs << CY_PS_BOOT_LOG_NARGS_Pos) | (token & CY_PS_BOOT_LOG_TOKEN_Msk);
+    for (uint32_t i = 0UL; i < nargs; i++)
+    {
+        log->data[log->count++] = args[i];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_log_dump
+ *******************************************************************************
+ * Summary:
+ *  Prints the boot log record over the debug UART as a "BOOT_LOG:<hex>" line
+ *  for the boot_log.py host script.
+ *
+ *******************************************************************************/
+void cy_ps_boot_log_dump(void)
+{
+    const cy_stc_ps_boot_log_t *log = &CY_PS_BOOT_SHARED->log;
+    const uint8_t *raw = (const uint8_t *)log;
+    uint32_t raw_size = offsetof(cy_stc_ps_boot_log_t, data) + (log->count * sizeof(uint32_t));
+
+    printf("BOOT_LOG:");
+    for (uint32_t i = 0UL; i < raw_size; i++)
+    {
+        printf("%02X", raw[i]);
+    }
+    printf("\r\n");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name: cy_ps_boot_log.h
+*
+* Description: Header file for the deferred, tokenized bootloader logging.
+*   CY_PS_BOOT_LOG() stores the address of its format string and its
+*   arguments in the shared SRAM instead of printing them over the debug
+*   UART. The format strings are placed in the .cy_ps_log_fmt section,
+*   which is not loaded to the device, and are looked up by the
+*   boot_log.py host script.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CY_PS_BOOT_LOG_H
+#define CY_PS_BOOT_LOG_H
+
+#include "cy_syslib.h"
+#include "bootutil/bootutil_log.h"
+#include "cy_ps_boot_shared.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************************
+*               Macros
+***************************************/
+/* Set BOOT_LOG_DEFERRED to 1 in the Makefile to record the messages in the
+ * shared SRAM instead of printing them synchronously with BOOT_LOG_INF.
+ */
+#ifndef BOOT_LOG_DEFERRED
+#define BOOT_LOG_DEFERRED               (0u)
+#endif
+
+#if (BOOT_LOG_DEFERRED == 1u)
+/* Arguments are stored as 32-bit words; string arguments are not supported. */
+#define CY_PS_BOOT_LOG(fmt, ...)                                                        \
+    do                                                                                  \
+    {                                                                                   \
+        CY_SECTION(".cy_ps_log_fmt") __USED static const char cy_ps_log_fmt[] = fmt;    \
+        const uint32_t cy_ps_log_args[] = { 0UL, ##__VA_ARGS__ };                       \
+        cy_ps_boot_log_write((uint32_t)cy_ps_log_fmt, &cy_ps_log_args[1],               \
+                             (sizeof(cy_ps_log_args) / sizeof(uint32_t)) - 1UL);        \
+    } while (0)
+#else
+#define CY_PS_BOOT_LOG(fmt, ...)        BOOT_LOG_INF(fmt, ##__VA_ARGS__)
+#endif
+
+/*******************************************************************************
+* Functions
+*******************************************************************************/
+void cy_ps_boot_log_init(void);
+void cy_ps_boot_log_write(uint32_t token, const uint32_t *args, uint32_t nargs);
+void cy_ps_boot_log_dump(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CY_PS_BOOT_LOG_H */
+
+/* [] END OF FILE */
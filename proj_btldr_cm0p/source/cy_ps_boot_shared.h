@@ -0,0 +1,238 @@
+/******************************************************************************
+* File Name: cy_ps_boot_shared.h
+*
+* Description: Layout of the data handed over by the bootloader to the user
+*   applications in the shared SRAM. This header is also included by the
+*   CM4 user application.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PS_BOOT_SHARED_H
+#define CY_PS_BOOT_SHARED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************************
+*               Macros
+***************************************/
+/* Boot timing record */
+#define CY_PS_BOOT_TIMING_MAGIC         (0x54544F42UL)  /* "BOTT" */
+#define CY_PS_BOOT_TIMING_VERSION       (1U)
+#define CY_PS_BOOT_TIMING_MAX_MARKS     (16U)
+
+/* Phase names in the order of cy_en_ps_boot_phase_t */
+#define CY_PS_BOOT_PHASE_NAMES          { "init", "efuse", "prot_units", "boot_go", "do_boot" }
+
+/* Boot log record */
+#define CY_PS_BOOT_LOG_MAGIC            (0x474F4C42UL)  /* "BLOG" */
+#define CY_PS_BOOT_LOG_VERSION          (1U)
+#define CY_PS_BOOT_LOG_MAX_WORDS        (256U)
+
+/* Each log entry is a header word followed by its argument words. The token
+ * is the offset of the format string in the .cy_ps_log_fmt section of the
+ * bootloader ELF file.
+ */
+#define CY_PS_BOOT_LOG_TOKEN_Msk        (0x00FFFFFFUL)
+#define CY_PS_BOOT_LOG_NARGS_Pos        (24U)
+
+/* Security counters of the images, copied from the protected storage */
+#define CY_PS_BOOT_SECURITY_CNT_MAGIC   (0x544E4353UL)  /* "SCNT" */
+#define CY_PS_BOOT_SECURITY_CNT_MAX_IMAGES  (2U)
+
+/* Snapshot of the lifecycle and access restriction eFuse bytes. The bytes
+ * are contiguous in the eFuse map, starting with DEAD_ACCESS_RESTRICT0.
+ */
+#define CY_PS_BOOT_EFUSE_MAGIC          (0x53554645UL)  /* "EFUS" */
+#define CY_PS_BOOT_EFUSE_VERSION        (1U)
+#define CY_PS_BOOT_EFUSE_OFFSET         (0x027U)        /* eFuse byte offset of bytes[0] */
+#define CY_PS_BOOT_EFUSE_COUNT          (5U)
+#define CY_PS_BOOT_EFUSE_CRC32_POLY     (0xEDB88320UL)
+
+/* Indexes in cy_stc_ps_boot_efuse_t.bytes */
+#define CY_PS_BOOT_EFUSE_DEAD_ACCESS0   (0U)
+#define CY_PS_BOOT_EFUSE_DEAD_ACCESS1   (1U)
+#define CY_PS_BOOT_EFUSE_SECURE_ACCESS0 (2U)
+#define CY_PS_BOOT_EFUSE_SECURE_ACCESS1 (3U)
+#define CY_PS_BOOT_EFUSE_LIFECYCLE      (4U)
+
+/* Security counter that imgtool derives from an image version when signing
+ * with "-s auto"
+ */
+#define CY_PS_SECURITY_CNT_FROM_VERSION(major, minor, revision) \
+        (((uint32_t)(major) << 24U) + ((uint32_t)(minor) << 16U) + (uint32_t)(revision))
+
+/* Shared data is placed at the start of the shared SRAM by the linker scripts
+ * (.cy_boot_shared section, BOOT_SHARED_SRAM_SIZE bytes).
+ */
+#define CY_PS_BOOT_SHARED               ((cy_stc_ps_boot_shared_t *)SHARED_SRAM_START)
+
+/***************************************
+*               Structures
+***************************************/
+/* Boot phases. A mark is recorded at the end of each phase. */
+typedef enum
+{
+    CY_PS_BOOT_PHASE_INIT = 0U,         /* Device, BSP and retarget-io initialization */
+    CY_PS_BOOT_PHASE_EFUSE,             /* Lifecycle and access restriction eFuse reads */
+    CY_PS_BOOT_PHASE_PROT_UNITS,        /* Protection units configuration */
+    CY_PS_BOOT_PHASE_BOOT_GO,           /* MCUboot image validation and upgrade */
+    CY_PS_BOOT_PHASE_DO_BOOT,           /* Preparing the jump to the user application */
+    CY_PS_BOOT_PHASE_COUNT
+} cy_en_ps_boot_phase_t;
+
+typedef struct
+{
+    uint32_t phase;                     /* cy_en_ps_boot_phase_t */
+    uint32_t ticks;                     /* Timer ticks since the bootloader started */
+} cy_stc_ps_boot_mark_t;
+
+typedef struct
+{
+    uint32_t magic;                     /* CY_PS_BOOT_TIMING_MAGIC */
+    uint16_t version;                   /* CY_PS_BOOT_TIMING_VERSION */
+    uint16_t count;                     /* Number of recorded marks */
+    uint32_t clock_hz;                  /* Timer tick frequency */
+    cy_stc_ps_boot_mark_t marks[CY_PS_BOOT_TIMING_MAX_MARKS];
+} cy_stc_ps_boot_timing_t;
+
+typedef struct
+{
+    uint32_t magic;                     /* CY_PS_BOOT_LOG_MAGIC */
+    uint16_t version;                   /* CY_PS_BOOT_LOG_VERSION */
+    uint16_t count;                     /* Number of used data words */
+    uint32_t dropped;                   /* Number of entries that did not fit */
+    uint32_t data[CY_PS_BOOT_LOG_MAX_WORDS];
+} cy_stc_ps_boot_log_t;
+
+typedef struct
+{
+    uint32_t magic;                     /* CY_PS_BOOT_SECURITY_CNT_MAGIC */
+    uint32_t count;                     /* Number of images */
+    uint32_t counters[CY_PS_BOOT_SECURITY_CNT_MAX_IMAGES];
+} cy_stc_ps_boot_security_cnt_t;
+
+typedef struct
+{
+    uint32_t magic;                     /* CY_PS_BOOT_EFUSE_MAGIC */
+    uint16_t version;                   /* CY_PS_BOOT_EFUSE_VERSION */
+    uint16_t count;                     /* CY_PS_BOOT_EFUSE_COUNT */
+    uint8_t bytes[CY_PS_BOOT_EFUSE_COUNT];  /* eFuse bytes from CY_PS_BOOT_EFUSE_OFFSET */
+    uint8_t reserved[3];
+    uint32_t crc;                       /* CRC32 of the fields from version */
+} cy_stc_ps_boot_efuse_t;
+
+typedef struct
+{
+    cy_stc_ps_boot_timing_t timing;
+    cy_stc_ps_boot_log_t log;
+    cy_stc_ps_boot_security_cnt_t security_cnt;
+    cy_stc_ps_boot_efuse_t efuse;
+} cy_stc_ps_boot_shared_t;
+
+_Static_assert(sizeof(cy_stc_ps_boot_shared_t) <= BOOT_SHARED_SRAM_SIZE, "Boot shared data exceeds BOOT_SHARED_SRAM_SIZE");
+
+/*******************************************************************************
+* Functions
+*******************************************************************************/
+/*******************************************************************************
+ * Function Name: cy_ps_boot_efuse_crc32
+ *******************************************************************************
+ * Summary:
+ *  Calculates the CRC32 (IEEE 802.3) of the eFuse snapshot fields between
+ *  magic and crc. The magic is left out because it is written after the CRC.
+ *
+ * Parameters:
+ *  efuse - Pointer to the snapshot
+ *
+ * Return:
+ *  uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static inline uint32_t cy_ps_boot_efuse_crc32(const cy_stc_ps_boot_efuse_t *efuse)
+{
+    const uint8_t *data = (const uint8_t *)efuse;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = offsetof(cy_stc_ps_boot_efuse_t, version); i < offsetof(cy_stc_ps_boot_efuse_t, crc); i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (crc >> 1U) ^ (CY_PS_BOOT_EFUSE_CRC32_POLY & (0UL - (crc & 1UL)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_efuse_valid
+ *******************************************************************************
+ * Summary:
+ *  Checks the magic, version and CRC of the eFuse snapshot published by the
+ *  bootloader. The snapshot is only published when all the eFuse reads
+ *  succeeded, so the applications read the eFuses through the SROM when this
+ *  returns false.
+ *
+ * Parameters:
+ *  efuse - Pointer to the snapshot
+ *
+ * Return:
+ *  bool - true if the snapshot can be used
+ *
+ *******************************************************************************/
+static inline bool cy_ps_boot_efuse_valid(const cy_stc_ps_boot_efuse_t *efuse)
+{
+    return (CY_PS_BOOT_EFUSE_MAGIC == efuse->magic) &&
+           (CY_PS_BOOT_EFUSE_VERSION == efuse->version) &&
+           (CY_PS_BOOT_EFUSE_COUNT == efuse->count) &&
+           (cy_ps_boot_efuse_crc32(efuse) == efuse->crc);
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CY_PS_BOOT_SHARED_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,163 @@
+/******************************************************************************
+* File Name: cy_ps_boot_timing.c
+*
+* Description: This file contains the boot phase timing recorder. SysTick is
+*   clocked from the IMO so that the tick rate does not change when
+*   cybsp_init() configures the system clocks. The end of each boot phase
+*   is recorded in the shared SRAM for the user applications to report.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "cy_ps_boot_timing.h"
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define BOOT_TIMING_SYSTICK_RELOAD      (0x00FFFFFFUL)      /* Full 24-bit SysTick range */
+#define BOOT_TIMING_CLOCK_HZ            (CY_SYSCLK_IMO_FREQ)
+#define BOOT_TIMING_CALLBACK_NUM        (0UL)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Number of SysTick reloads since the timer was started */
+static volatile uint32_t boot_timing_wraps = 0UL;
+
+/*******************************************************************************
+ * Function Name: boot_timing_systick_callback
+ *******************************************************************************
+ * Summary:
+ *  SysTick callback, counts the timer reloads.
+ *
+ *******************************************************************************/
+static void boot_timing_systick_callback(void)
+{
+    boot_timing_wraps++;
+}
+
+/*******************************************************************************
+ * Function Name: boot_timing_get_ticks
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of ticks since cy_ps_boot_timing_init() was called.
+ *
+ * Return:
+ *  uint32_t - Elapsed ticks
+ *
+ *******************************************************************************/
+static uint32_t boot_timing_get_ticks(void)
+{
+    uint32_t intr_state = Cy_SysLib_EnterCriticalSection();
+    uint32_t wraps = boot_timing_wraps;
+    uint32_t count = Cy_SysTick_GetValue();
+
+    /* Account for a reload that happened while interrupts are masked */
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0UL)
+    {
+        wraps++;
+        count = Cy_SysTick_GetValue();
+    }
+
+    Cy_SysLib_ExitCriticalSection(intr_state);
+
+    return (wraps * (BOOT_TIMING_SYSTICK_RELOAD + 1UL)) + (BOOT_TIMING_SYSTICK_RELOAD - count);
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_timing_init
+ *******************************************************************************
+ * Summary:
+ *  Clears the boot timing record and starts the timer. Must be called at the
+ *  start of main().
+ *
+ *******************************************************************************/
+void cy_ps_boot_timing_init(void)
+{
+    cy_stc_ps_boot_timing_t *timing = &CY_PS_BOOT_SHARED->timing;
+
+    timing->magic    = 0UL;
+    timing->version  = CY_PS_BOOT_TIMING_VERSION;
+    timing->count    = 0U;
+    timing->clock_hz = BOOT_TIMING_CLOCK_HZ;
+
+    boot_timing_wraps = 0UL;
+
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_IMO, BOOT_TIMING_SYSTICK_RELOAD);
+    (void)Cy_SysTick_SetCallback(BOOT_TIMING_CALLBACK_NUM, &boot_timing_systick_callback);
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_timing_mark
+ *******************************************************************************
+ * Summary:
+ *  Records the end of a boot phase. Marks beyond CY_PS_BOOT_TIMING_MAX_MARKS
+ *  are dropped.
+ *
+ * Parameters:
+ *  phase - The boot phase that just completed
+ *
+ *******************************************************************************/
+void cy_ps_boot_timing_mark(cy_en_ps_boot_phase_t phase)
+{
+    cy_stc_ps_boot_timing_t *timing = &CY_PS_BOOT_SHARED->timing;
+
+    if (timing->count < CY_PS_BOOT_TIMING_MAX_MARKS)
+    {
+        timing->marks[timing->count].phase = (uint32_t)phase;
+        timing->marks[timing->count].ticks = boot_timing_get_ticks();
+        timing->count++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_boot_timing_deinit
+ *******************************************************************************
+ * Summary:
+ *  Stops the timer and marks the record as complete. Must be called before
+ *  jumping to the user application.
+ *
+ *******************************************************************************/
+void cy_ps_boot_timing_deinit(void)
+{
+    Cy_SysTick_Disable();
+    Cy_SysTick_DisableInterrupt();
+    (void)Cy_SysTick_SetCallback(BOOT_TIMING_CALLBACK_NUM, NULL);
+
+    CY_PS_BOOT_SHARED->timing.magic = CY_PS_BOOT_TIMING_MAGIC;
+}
+
+/* [] END OF FILE */
@@ -44,6 +44,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "cy_syslib.h"
+#include "../keys/cy_ps_public_key.h"
 
 #if defined(__cplusplus)
 extern "C" {
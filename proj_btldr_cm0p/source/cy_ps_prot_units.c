@@ -40,6 +40,7 @@
 *******************************************************************************/
 
 #include <source/cy_ps_prot_units.h>
+#include "cy_ps_layout.h"
 
 /*******************************************************************************
  * Macros
@@ -47,16 +48,70 @@
 #define PROT_UNITS_ALL_PC_MASK      (0x00007FFFUL)  /* Mask for all supported PC values */
 #define PROT_UNITS_DEVICE_PC_MASK   (PROT_UNITS_ALL_PC_MASK & ~CY_PROT_SMPU_PC_LIMIT_MASK) /* Mask for device PC values */
 
-#define PROT_UNITS_FLASH_SIZE_2MB   0x00200000UL
-#define PROT_UNITS_FLASH_SIZE_1MB   0x00100000UL
-#define PROT_UNITS_FLASH_SIZE_512KB 0x00080000UL
-#define PROT_UNITS_FLASH_SIZE_256KB 0x00040000UL
+#define PROT_UNITS_SUBREGION_NR     (8UL)           /* Number of sub-regions in an SMPU region */
 
-#define PROT_UNITS_SRAM_SIZE_1MB    0x00100000UL
-#define PROT_UNITS_SRAM_SIZE_512KB  0x00080000UL
-#define PROT_UNITS_SRAM_SIZE_288KB  0x00048000UL
-#define PROT_UNITS_SRAM_SIZE_256KB  0x00040000UL
-#define PROT_UNITS_SRAM_SIZE_128KB  0x00020000UL
+/* CY_PROT_SIZE_xxx encodes a region of 2^(value + 1) bytes */
+#define PROT_UNITS_REGION_BYTES(size)       (2UL << (uint32_t)(size))
+#define PROT_UNITS_SUBREGION_BYTES(size)    (PROT_UNITS_REGION_BYTES(size) / PROT_UNITS_SUBREGION_NR)
+
+/* Disabled sub-regions of a region at addr that enable exactly [start, end) */
+#define PROT_UNITS_SUBREGION_MASK(addr, size, start, end) \
+        (0xFFUL & ~(((1UL << (((end) - (addr)) / PROT_UNITS_SUBREGION_BYTES(size))) - 1UL) & \
+                   ~((1UL << (((start) - (addr)) / PROT_UNITS_SUBREGION_BYTES(size))) - 1UL)))
+
+/* Checks at compile time that the SMPU config generated into cy_ps_layout.h
+ * for a layout region is valid and protects exactly the region.
+ */
+#define PROT_UNITS_CHECK_LAYOUT(name) \
+    _Static_assert((CY_PS_LAYOUT_##name##_ADDR % PROT_UNITS_REGION_BYTES(CY_PS_LAYOUT_##name##_REGION_SIZE)) == 0UL, \
+                   "SMPU " #name ": address must be aligned to the region size"); \
+    _Static_assert((CY_PS_LAYOUT_##name##_START >= CY_PS_LAYOUT_##name##_ADDR) && \
+                   (CY_PS_LAYOUT_##name##_END <= (CY_PS_LAYOUT_##name##_ADDR + PROT_UNITS_REGION_BYTES(CY_PS_LAYOUT_##name##_REGION_SIZE))), \
+                   "SMPU " #name ": layout region must be inside the SMPU region"); \
+    _Static_assert((((CY_PS_LAYOUT_##name##_START - CY_PS_LAYOUT_##name##_ADDR) % PROT_UNITS_SUBREGION_BYTES(CY_PS_LAYOUT_##name##_REGION_SIZE)) == 0UL) && \
+                   (((CY_PS_LAYOUT_##name##_END - CY_PS_LAYOUT_##name##_ADDR) % PROT_UNITS_SUBREGION_BYTES(CY_PS_LAYOUT_##name##_REGION_SIZE)) == 0UL), \
+                   "SMPU " #name ": layout region must be made of whole sub-regions"); \
+    _Static_assert(CY_PS_LAYOUT_##name##_SUBREGIONS == PROT_UNITS_SUBREGION_MASK(CY_PS_LAYOUT_##name##_ADDR, \
+                   CY_PS_LAYOUT_##name##_REGION_SIZE, CY_PS_LAYOUT_##name##_START, CY_PS_LAYOUT_##name##_END), \
+                   "SMPU " #name ": sub-regions must enable exactly the layout region")
+
+/*******************************************************************************
+ * Layout checks
+ *******************************************************************************/
+/* The SMPU configs come from shared/layout/TARGET_<target>/cy_ps_layout.h,
+ * generated from the same description as the defines set by common.mk.
+ * A generated file that does not match the description fails the build here.
+ */
+PROT_UNITS_CHECK_LAYOUT(CM0P_BTLDR_FLASH);
+PROT_UNITS_CHECK_LAYOUT(PROTECTED_STORAGE);
+PROT_UNITS_CHECK_LAYOUT(CM0P_APP_FLASH);
+PROT_UNITS_CHECK_LAYOUT(CM4_APP_FLASH);
+#ifdef CY_PS_LAYOUT_CM4_APP_FLASH_2_ADDR
+PROT_UNITS_CHECK_LAYOUT(CM4_APP_FLASH_2);
+#endif
+#ifdef CY_PS_LAYOUT_SCRATCH_FLASH_ADDR
+PROT_UNITS_CHECK_LAYOUT(SCRATCH_FLASH);
+#endif
+#ifdef CY_PS_LAYOUT_SWAP_STATUS_FLASH_ADDR
+PROT_UNITS_CHECK_LAYOUT(SWAP_STATUS_FLASH);
+#endif
+PROT_UNITS_CHECK_LAYOUT(CM0P_SRAM);
+PROT_UNITS_CHECK_LAYOUT(SHARED_SRAM);
+PROT_UNITS_CHECK_LAYOUT(CM4_SRAM);
+#ifdef CY_PS_LAYOUT_CM4_SRAM_2_ADDR
+PROT_UNITS_CHECK_LAYOUT(CM4_SRAM_2);
+#endif
+
+_Static_assert(CY_PS_LAYOUT_PROTECTED_STORAGE_START == PROTECTED_MEM_START,
+               "cy_ps_layout.h does not match PROTECTED_MEM_START");
+_Static_assert(CY_PS_LAYOUT_CM0P_APP_FLASH_START == CM0P_APP_FLASH_START,
+               "cy_ps_layout.h does not match CM0P_APP_FLASH_START");
+_Static_assert(CY_PS_LAYOUT_CM4_APP_FLASH_START == CM4_APP_FLASH_START,
+               "cy_ps_layout.h does not match CM4_APP_FLASH_START");
+_Static_assert(CY_PS_LAYOUT_SHARED_SRAM_START == SHARED_SRAM_START,
+               "cy_ps_layout.h does not match SHARED_SRAM_START");
+_Static_assert(CY_PS_LAYOUT_CM4_SRAM_START == CM4_APP_SRAM_START,
+               "cy_ps_layout.h does not match CM4_APP_SRAM_START");
 
 /*******************************************************************************
  * Structures
@@ -65,9 +120,9 @@
 /* ------------------------ FLASH Setup ---------------------------- */
 /* Slave SMPU config for CM0+ Bootloader Flash region */
 static const cy_stc_smpu_cfg_t cm0p_btldr_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CY_FLASH_BASE),          /* Start of CM0+ Btldr Flash */
-        .regionSize = CY_PROT_SIZE_128KB,                /* Region size of 128KB */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS7), /* Exclude last sub-region */
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM0P_BTLDR_FLASH_ADDR),    /* Start of CM0+ Btldr Flash */
+        .regionSize = CY_PS_LAYOUT_CM0P_BTLDR_FLASH_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM0P_BTLDR_FLASH_SUBREGIONS),
         .userPermission = CY_PROT_PERM_RX,               /* Full access to PC=1,2 */
         .privPermission = CY_PROT_PERM_RX,               /* Full access to PC=1,2 */
         .secure = true,                                  /* Secure access only */
@@ -77,69 +132,88 @@ static const cy_stc_smpu_cfg_t cm0p_btldr_flash_prot_cfg_s = {
 
 /* Slave SMPU config for Protected Storage region */
 static const cy_stc_smpu_cfg_t protected_storage_prot_cfg_s = {
-        .address = (uint32_t *)(PROTECTED_MEM_START),    /* Start of Protected Storage */
-        .regionSize = CY_PROT_SIZE_16KB,                 /* Region size of 16KB */
-        .subregions = (uint8_t)(0x00),                   /* Include all sub-regions */
-        .userPermission = CY_PROT_PERM_RWX,              /* Full access to PC=2 */
-        .privPermission = CY_PROT_PERM_RWX,              /* Full access to PC=2 */
+        .address = (uint32_t *)(CY_PS_LAYOUT_PROTECTED_STORAGE_ADDR),   /* Start of Protected Storage */
+        .regionSize = CY_PS_LAYOUT_PROTECTED_STORAGE_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_PROTECTED_STORAGE_SUBREGIONS),
+        .userPermission = CY_PROT_PERM_RWX,              /* Full access to PC=1,2 */
+        .privPermission = CY_PROT_PERM_RWX,              /* Full access to PC=1,2 */
         .secure = true,                                  /* Secure access only */
         .pcMatch = false,
-        .pcMask = (uint16_t)CY_PROT_PCMASK2 /* Only allow PC=2 */
+        .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK2) /* Only allow PC=1,2 */
 };
 
 /* Slave SMPU config for CM0+ Application Flash region */
 static const cy_stc_smpu_cfg_t cm0p_app_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CM0P_APP_FLASH_START),    /* Start of CM0+ App Flash */
-#if CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_2MB
-        .regionSize = CY_PROT_SIZE_128KB,                 /* Region size of 128KB */
-#elif CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_1MB
-        .regionSize = CY_PROT_SIZE_128KB,                 /* Region size of 128KB */
-#elif CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_512KB
-        .regionSize = CY_PROT_SIZE_64KB,                  /* Region size of 64KB */
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM0P_APP_FLASH_ADDR),      /* Start of CM0+ App Flash */
+        .regionSize = CY_PS_LAYOUT_CM0P_APP_FLASH_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM0P_APP_FLASH_SUBREGIONS),
+#if (FAST_BOOT == 1u)
+        .userPermission = CY_PROT_PERM_RX,                /* Read-only for PC=1,2, the bootloader may skip its validation */
+        .privPermission = CY_PROT_PERM_RX,
 #else
-        .regionSize = CY_PROT_SIZE_32KB,                  /* Region size of 32KB */
-#endif
-        .subregions = (uint8_t)(0x00),                    /* Include all sub-regions */
         .userPermission = CY_PROT_PERM_RWX,               /* Full access to PC=1,2 */
         .privPermission = CY_PROT_PERM_RWX,               /* Full access to PC=1,2 */
+#endif
         .secure = true,                                   /* Secure access only */
         .pcMatch = false,
         .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK2) /* Only allow PC=1,2 */
 };
 
-/* For 512K and 1M devices only */
-#if (CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_1MB) || (CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_512KB)
-/* Slave SMPU config for CM4 and Secondary Slot Application Flash region */
-static const cy_stc_smpu_cfg_t cm4_secondary_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CY_START_OF_FLASH),         /* Start of Flash */
-#if CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_1MB
-        .regionSize = CY_PROT_SIZE_1MB,                     /* Region size 1M, subregion = 128K */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS0 \
-                | CY_PROT_SUBREGION_DIS1),                  /* Disable subregions 0,1 only */
-#elif CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_512KB
-        .regionSize = CY_PROT_SIZE_512KB,                   /* Region size 512KB, subregion = 64K */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS0 \
-                        | CY_PROT_SUBREGION_DIS1 \
-                        | CY_PROT_SUBREGION_DIS2),          /* Disable subregions 0,1,2 only */
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/* Image 1 (CM0+ app) must exactly fill the region above and image 2 (CM4 app)
+ * must start where the CM4 App Flash region starts. The secondary slots of
+ * both images stay inside the secondary slot region.
+ */
+_Static_assert(CY_BOOT_PRIMARY_1_SIZE == (CM4_APP_FLASH_START - CM0P_APP_FLASH_START),
+               "Image 1 primary slot must match the CM0+ App Flash region");
+_Static_assert(CY_BOOT_PRIMARY_2_START_ADDRESS == CM4_APP_FLASH_START,
+               "Image 2 primary slot must start at the CM4 App Flash region");
+_Static_assert(CY_BOOT_SECONDARY_2_START_ADDRESS == (CY_BOOT_SECONDARY_1_START_ADDRESS + CY_BOOT_SECONDARY_1_SIZE),
+               "Image 2 secondary slot must follow the image 1 secondary slot");
+#endif
+
+#if (FAST_BOOT == 1u)
+/* Slave SMPU config for the CM4 part of the primary slot. The bootloader may
+ * skip the validation of the primary slot, so the slot must stay read-only
+ * after boot_go(). The struct takes precedence over the CM4 App Flash struct,
+ * which leaves the secondary slot writable for the DFU. The CM4 part may need
+ * two structs. Address and size are set by prot_units_fit_two_regions().
+ */
+static const cy_stc_smpu_cfg_t cm4_app_primary_flash_prot_cfg_s = {
+        .userPermission = CY_PROT_PERM_RX,                /* Read-only for PC=1,4 */
+        .privPermission = CY_PROT_PERM_RX,
+        .secure = false,
+        .pcMatch = false,
+        .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4) /* Only allow PC=1,4 */
+};
+
+/* CM4 part of the primary slot */
+#define PROT_UNITS_CM4_PRIMARY_START    (CM4_APP_FLASH_START)
+#define PROT_UNITS_CM4_PRIMARY_SIZE     (CY_BOOT_PRIMARY_1_START_ADDRESS + CY_BOOT_PRIMARY_1_SIZE - CM4_APP_FLASH_START)
 #endif
-        .userPermission = CY_PROT_PERM_RWX,                 /* Access is RWX for PC=1,4 */
+
+#if defined(MCUBOOT_DIRECT_XIP)
+/* Slave SMPU config for the CM0+ App Flash region of the slot that is not
+ * executed. The DFU running on CM4 writes the next image to this slot.
+ * Address and size are set by prot_units_fit_region().
+ */
+static const cy_stc_smpu_cfg_t cm0p_app_update_flash_prot_cfg_s = {
+        .userPermission = CY_PROT_PERM_RWX,               /* Access is RWX for PC=1,4 */
         .privPermission = CY_PROT_PERM_RWX,
         .secure = false,
         .pcMatch = false,
         .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4) /* Only allow PC=1,4 */
 };
+
+/* Start of the slot the user apps execute from */
+static uint32_t app_slot_start = CY_BOOT_PRIMARY_1_START_ADDRESS;
 #endif
 
-/* For 2M devices only */
-#if CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_2MB
+/* Slave SMPU config for CM4 and Secondary Slot Application Flash region */
 static const cy_stc_smpu_cfg_t cm4_app_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CY_START_OF_FLASH),       /* Start of Flash */
-        .regionSize = CY_PROT_SIZE_2MB,                   /* Region size 2M, subregion = 256K */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS0 \
-                | CY_PROT_SUBREGION_DIS4 \
-                | CY_PROT_SUBREGION_DIS5 \
-                | CY_PROT_SUBREGION_DIS6 \
-                | CY_PROT_SUBREGION_DIS7),                /* Disable subregions 0,4,5,6,7 only */
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM4_APP_FLASH_ADDR),       /* Start of the SMPU region */
+        .regionSize = CY_PS_LAYOUT_CM4_APP_FLASH_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM4_APP_FLASH_SUBREGIONS),
         .userPermission = CY_PROT_PERM_RWX,               /* Access is RWX for PC=1,4 */
         .privPermission = CY_PROT_PERM_RWX,
         .secure = false,
@@ -147,21 +221,27 @@ static const cy_stc_smpu_cfg_t cm4_app_flash_prot_cfg_s = {
         .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4) /* Only allow PC=1,4 */
 };
 
-static const cy_stc_smpu_cfg_t secondary_slot_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CY_BOOT_SECONDARY_1_START_ADDRESS),  /* Start of secondary slot */
-        .regionSize = CY_PROT_SIZE_1MB,                              /* Region size 1M, subregion = 128K */
-        .subregions = (uint8)(CY_PROT_SUBREGION_DIS7),               /* Disable the last subregion only */
-        .userPermission = CY_PROT_PERM_RWX,                          /* Access is RWX for PC=1,4 */
+#ifdef CY_PS_LAYOUT_CM4_APP_FLASH_2_ADDR
+/* On 2M devices, the CM4 and Secondary Slot Application Flash region does not
+ * fit one SMPU region. This config protects the part the one above leaves out.
+ */
+static const cy_stc_smpu_cfg_t cm4_app_flash_2_prot_cfg_s = {
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM4_APP_FLASH_2_ADDR),     /* Start of the SMPU region */
+        .regionSize = CY_PS_LAYOUT_CM4_APP_FLASH_2_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM4_APP_FLASH_2_SUBREGIONS),
+        .userPermission = CY_PROT_PERM_RWX,               /* Access is RWX for PC=1,4 */
         .privPermission = CY_PROT_PERM_RWX,
         .secure = false,
         .pcMatch = false,
-        .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4)        /* Only allow PC=1,4 */
+        .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4) /* Only allow PC=1,4 */
 };
+#endif
 
+#ifdef CY_PS_LAYOUT_SCRATCH_FLASH_ADDR
 static const cy_stc_smpu_cfg_t scratch_flash_prot_cfg_s = {
-        .address = (uint32_t *)(CY_BOOT_SCRATCH_START_ADDRESS),  /* Start of secondary slot */
-        .regionSize = CY_PROT_SIZE_128KB,                        /* Region size 1M, subregion = 128K */
-        .subregions = (uint8)(0x00),                             /* Include all regions */
+        .address = (uint32_t *)(CY_PS_LAYOUT_SCRATCH_FLASH_ADDR),       /* Start of scratch area */
+        .regionSize = CY_PS_LAYOUT_SCRATCH_FLASH_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_SCRATCH_FLASH_SUBREGIONS),
         .userPermission = CY_PROT_PERM_RW,                       /* Access is RW for PC=1,4 */
         .privPermission = CY_PROT_PERM_RW,
         .secure = true,
@@ -170,6 +250,22 @@ static const cy_stc_smpu_cfg_t scratch_flash_prot_cfg_s = {
 };
 #endif
 
+#ifdef CY_PS_LAYOUT_SWAP_STATUS_FLASH_ADDR
+/* The CM4 app requests the upgrade and confirms the new image by writing the
+ * image trailer kept in the swap status partition.
+ */
+static const cy_stc_smpu_cfg_t swap_status_flash_prot_cfg_s = {
+        .address = (uint32_t *)(CY_PS_LAYOUT_SWAP_STATUS_FLASH_ADDR),   /* Start of swap status partition */
+        .regionSize = CY_PS_LAYOUT_SWAP_STATUS_FLASH_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_SWAP_STATUS_FLASH_SUBREGIONS),
+        .userPermission = CY_PROT_PERM_RW,                           /* Access is RW for PC=1,4 */
+        .privPermission = CY_PROT_PERM_RW,
+        .secure = false,
+        .pcMatch = false,
+        .pcMask = (uint16_t)(CY_PROT_PCMASK1|CY_PROT_PCMASK4)        /* Only allow PC=1,4 */
+};
+#endif
+
 /* ------------------------ SRAM Setup ---------------------------- */
 /* Slave SMPU config for CM0+ Application SRAM region
  * The IPC pipes/semaphores used by the system for communication between
@@ -180,21 +276,9 @@ static const cy_stc_smpu_cfg_t scratch_flash_prot_cfg_s = {
  * on the SMPU SRAM memory map described in the readme.
  */
 static const cy_stc_smpu_cfg_t cm0p_sram_prot_cfg_s = {
-        .address = (uint32_t *)(CY_SRAM_BASE),             /* Beginning of SRAM  */
-#if CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_1MB
-        .regionSize = CY_PROT_SIZE_256KB,                  /* 256K of SRAM, sub-region = 32K */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS6
-                | CY_PROT_SUBREGION_DIS7),                 /* Exclude (6,7) regions */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_288KB
-        .regionSize = CY_PROT_SIZE_64KB,                   /* 64K of SRAM, sub-region = 8K */
-        .subregions = (uint8_t)(0x00),                     /* Exclude first sub-region */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_256KB
-        .regionSize = CY_PROT_SIZE_64KB,                   /* 64K of SRAM, sub-region = 8K */
-        .subregions = (uint8_t)(0x00),                     /* Exclude first sub-region */
-#else
-        .regionSize = CY_PROT_SIZE_16KB,                   /* 16K of SRAM */
-        .subregions = 0x00,                                /* Include all sub-regions */
-#endif
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM0P_SRAM_ADDR),           /* Beginning of SRAM */
+        .regionSize = CY_PS_LAYOUT_CM0P_SRAM_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM0P_SRAM_SUBREGIONS),
         .userPermission = CY_PROT_PERM_RWX,                /* Read/Write only for PC=1,2 */
         .privPermission = CY_PROT_PERM_RWX,
         .secure = true,                                    /* Secure access only */
@@ -204,17 +288,9 @@ static const cy_stc_smpu_cfg_t cm0p_sram_prot_cfg_s = {
 
 /* Slave SMPU config for Shared SRAM region */
 static const cy_stc_smpu_cfg_t shared_sram_prot_cfg_s = {
-        .address = (uint32_t *)(SHARED_SRAM_START),     /* Beginning of Shared SRAM  */
-#if CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_1MB
-        .regionSize = CY_PROT_SIZE_64KB,                /* 64K of SRAM */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_288KB
-        .regionSize = CY_PROT_SIZE_32KB,                 /* 32K of SRAM */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_256KB
-        .regionSize = CY_PROT_SIZE_32KB,                 /* 32K of SRAM */
-#else
-        .regionSize = CY_PROT_SIZE_16KB,                 /* 16K of SRAM */
-#endif
-        .subregions = (uint8_t)(0x00),                   /* Include all sub-regions */
+        .address = (uint32_t *)(CY_PS_LAYOUT_SHARED_SRAM_ADDR),         /* Beginning of Shared SRAM */
+        .regionSize = CY_PS_LAYOUT_SHARED_SRAM_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_SHARED_SRAM_SUBREGIONS),
         .userPermission = CY_PROT_PERM_RW,               /* Read/Write no execute  */
         .privPermission = CY_PROT_PERM_RW,
         .secure = false,
@@ -231,29 +307,31 @@ static const cy_stc_smpu_cfg_t shared_sram_prot_cfg_s = {
  * on the SMPU SRAM memory map described in the readme.
  */
 static const cy_stc_smpu_cfg_t cm4_sram_prot_cfg_s = {
-        .address = (uint32_t *)(CY_SRAM_BASE),                    /* Beginning of SRAM  */
-#if CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_1MB
-        .regionSize = CY_PROT_SIZE_1MB,                           /* 1MB with 128KB subregions of SRAM */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS0 |
-                CY_PROT_SUBREGION_DIS1),                          /* Disable (0,1) regions */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_288KB
-        .regionSize = CY_PROT_SIZE_256KB,                         /* 256K with 32KB subregions of SRAM */
-        .subregions = (uint8_t)(CY_PROT_SUBREGION_DIS0 |
-                CY_PROT_SUBREGION_DIS1 | CY_PROT_SUBREGION_DIS2), /* Disable (0,1,2) regions */
-#elif CY_SRAM_SIZE == PROT_UNITS_SRAM_SIZE_256KB
-        .regionSize = CY_PROT_SIZE_256KB,                         /* 256K with 32KB subregions of SRAM */
-        .subregions = (uint8_t)(uint8_t)(CY_PROT_SUBREGION_DIS0 |
-                CY_PROT_SUBREGION_DIS1 | CY_PROT_SUBREGION_DIS2), /* Disable (0,1,2) regions */
-#else
-        .regionSize = CY_PROT_SIZE_128KB,         /* 128K with 16KB subregions of SRAM */
-        .subregions = 0x00,                       /* Include all sub-regions */
-#endif
-        .userPermission = CY_PROT_PERM_RWX,       /* Read/Write no execute  */
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM4_SRAM_ADDR),            /* Start of the SMPU region */
+        .regionSize = CY_PS_LAYOUT_CM4_SRAM_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM4_SRAM_SUBREGIONS),
+        .userPermission = CY_PROT_PERM_RWX,               /* Read/Write no execute  */
+        .privPermission = CY_PROT_PERM_RWX,
+        .secure = false,
+        .pcMatch = false,
+        .pcMask = (uint16_t)(CY_PROT_PCMASK4)             /* Only allow PC=4 to R/W */
+};
+
+#ifdef CY_PS_LAYOUT_CM4_SRAM_2_ADDR
+/* On 288K SRAM devices, the CM4 App SRAM region does not fit one SMPU
+ * region. This config protects the part the one above leaves out.
+ */
+static const cy_stc_smpu_cfg_t cm4_sram_2_prot_cfg_s = {
+        .address = (uint32_t *)(CY_PS_LAYOUT_CM4_SRAM_2_ADDR),          /* Start of the SMPU region */
+        .regionSize = CY_PS_LAYOUT_CM4_SRAM_2_REGION_SIZE,
+        .subregions = (uint8_t)(CY_PS_LAYOUT_CM4_SRAM_2_SUBREGIONS),
+        .userPermission = CY_PROT_PERM_RWX,               /* Read/Write no execute  */
         .privPermission = CY_PROT_PERM_RWX,
         .secure = false,
         .pcMatch = false,
-        .pcMask = (uint16_t)(CY_PROT_PCMASK4)     /* Only allow PC=4 to R/W */
+        .pcMask = (uint16_t)(CY_PROT_PCMASK4)             /* Only allow PC=4 to R/W */
 };
+#endif
 
 /* Common Master SMPU config for all SMPUs */
 static const cy_stc_smpu_cfg_t smpu_prot_cfg_m = {
@@ -293,6 +371,137 @@ static const cy_stc_ppu_prog_cfg_t prog_prot_cfg_m = {
 };
 #endif
 
+#if defined(MCUBOOT_DIRECT_XIP) || (FAST_BOOT == 1u)
+/*******************************************************************************
+ * Function Name: prot_units_fit_region
+ ********************************************************************************
+ * Summary:
+ *   Sets the region and sub-regions of an SMPU config to cover exactly the
+ *   flash range [addr, addr + size). The smallest power-of-two region that is
+ *   aligned on its size and holds the range in whole sub-regions is used.
+ *
+ * Parameters:
+ *   addr - Start of the range
+ *   size - Size of the range in bytes
+ *   cfg - SMPU config to update
+ *
+ * Return:
+ *   CY_PROT_SUCCESS if the range can be covered by one SMPU struct,
+ *   CY_PROT_BAD_PARAM otherwise
+ *
+ *******************************************************************************/
+static cy_en_prot_status_t prot_units_fit_region(uint32_t addr, uint32_t size, cy_stc_smpu_cfg_t *cfg)
+{
+    /* CY_PROT_SIZE_xxx encodes a region of 2^(value + 1) bytes */
+    for(uint32_t region_size = (uint32_t)CY_PROT_SIZE_256B; region_size <= (uint32_t)CY_PROT_SIZE_2MB; region_size++)
+    {
+        uint32_t region_bytes = 2UL << region_size;
+        uint32_t subregion_bytes = region_bytes / PROT_UNITS_SUBREGION_NR;
+        uint32_t region_start = addr & ~(region_bytes - 1UL);
+
+        if(((addr + size) <= (region_start + region_bytes)) &&
+           (((addr - region_start) % subregion_bytes) == 0UL) &&
+           ((size % subregion_bytes) == 0UL))
+        {
+            uint32_t first = (addr - region_start) / subregion_bytes;
+            uint32_t last = first + (size / subregion_bytes);
+            uint8_t disabled = 0xFFU;
+
+            for(uint32_t idx = first; idx < last; idx++)
+            {
+                disabled &= (uint8_t)~(1UL << idx);
+            }
+
+            cfg->address = (uint32_t *)region_start;
+            cfg->regionSize = (cy_en_prot_size_t)region_size;
+            cfg->subregions = disabled;
+            return CY_PROT_SUCCESS;
+        }
+    }
+
+    return CY_PROT_BAD_PARAM;
+}
+#endif
+
+#if (FAST_BOOT == 1u)
+/*******************************************************************************
+ * Function Name: prot_units_fit_two_regions
+ ********************************************************************************
+ * Summary:
+ *   Sets two SMPU configs to cover exactly the flash range [addr, addr + size).
+ *   The first config covers the longest part of the range from addr that one
+ *   region holds in whole sub-regions, and the second config the rest.
+ *
+ * Parameters:
+ *   addr - Start of the range
+ *   size - Size of the range in bytes
+ *   first - SMPU config to update with the start of the range
+ *   second - SMPU config to update with the rest of the range
+ *
+ * Return:
+ *   CY_PROT_SUCCESS if the range can be covered by two SMPU structs,
+ *   CY_PROT_BAD_PARAM otherwise. When one struct is enough, both configs
+ *   cover the whole range.
+ *
+ *******************************************************************************/
+static cy_en_prot_status_t prot_units_fit_two_regions(uint32_t addr, uint32_t size,
+                                                      cy_stc_smpu_cfg_t *first, cy_stc_smpu_cfg_t *second)
+{
+    cy_en_prot_status_t status;
+    uint32_t head = 0UL;
+
+    /* CY_PROT_SIZE_xxx encodes a region of 2^(value + 1) bytes */
+    for(uint32_t region_size = (uint32_t)CY_PROT_SIZE_256B; region_size <= (uint32_t)CY_PROT_SIZE_2MB; region_size++)
+    {
+        uint32_t region_bytes = 2UL << region_size;
+        uint32_t subregion_bytes = region_bytes / PROT_UNITS_SUBREGION_NR;
+        uint32_t region_start = addr & ~(region_bytes - 1UL);
+
+        if(((addr - region_start) % subregion_bytes) == 0UL)
+        {
+            uint32_t len = region_start + region_bytes - addr;
+
+            len = (len < size) ? len : size;
+            len -= len % subregion_bytes;
+            head = (len > head) ? len : head;
+        }
+    }
+
+    status = (head != 0UL) ? prot_units_fit_region(addr, head, first) : CY_PROT_BAD_PARAM;
+
+    if(head < size)
+    {
+        status = (status == CY_PROT_SUCCESS) ? prot_units_fit_region(addr + head, size - head, second) : status;
+    }
+    else
+    {
+        *second = *first;
+    }
+
+    return status;
+}
+#endif
+
+#if defined(MCUBOOT_DIRECT_XIP)
+/*******************************************************************************
+ * Function Name: prot_units_set_app_slot
+ ********************************************************************************
+ * Summary:
+ *   Selects the slot the user apps execute from in direct-XIP mode. The CM0+
+ *   App Flash region of this slot gets the protection of the CM0+ App Flash
+ *   and the one of the other slot is opened to CM4 for the DFU.
+ *   Must be called before prot_units_init().
+ *
+ * Parameters:
+ *   slot_start - Start address of the slot selected by MCUboot
+ *
+ *******************************************************************************/
+void prot_units_set_app_slot(uint32_t slot_start)
+{
+    app_slot_start = slot_start;
+}
+#endif
+
 /*******************************************************************************
  * Function Name: prot_units_init
  ********************************************************************************
@@ -326,35 +535,66 @@ cy_en_prot_status_t prot_units_init(void)
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT12, &cm0p_sram_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT12) : status;
 
+#if defined(MCUBOOT_DIRECT_XIP)
+    /* SMPU 11 - CM0+ App Flash of the executed slot */
+    cy_stc_smpu_cfg_t app_flash_cfg = cm0p_app_flash_prot_cfg_s;
+    uint32_t update_slot_start = (app_slot_start == CY_BOOT_PRIMARY_1_START_ADDRESS) ?
+            CY_BOOT_SECONDARY_1_START_ADDRESS : CY_BOOT_PRIMARY_1_START_ADDRESS;
+
+    status = (status == CY_PROT_SUCCESS) ? prot_units_fit_region(app_slot_start, CM4_APP_FLASH_START - CM0P_APP_FLASH_START, &app_flash_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT11, &app_flash_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT11) : status;
+
+    /* SMPU 3 - CM0+ App Flash of the slot updated by the DFU */
+    cy_stc_smpu_cfg_t update_flash_cfg = cm0p_app_update_flash_prot_cfg_s;
+
+    status = (status == CY_PROT_SUCCESS) ? prot_units_fit_region(update_slot_start, CM4_APP_FLASH_START - CM0P_APP_FLASH_START, &update_flash_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT3, &update_flash_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT3) : status;
+#else
     /* SMPU 11 - CM0+ App Flash */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT11, &cm0p_app_flash_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT11) : status;
+#endif
+
+#if (FAST_BOOT == 1u)
+    /* SMPU 15, 14 - CM4 part of the primary slot, read-only */
+    cy_stc_smpu_cfg_t primary_flash_cfg = cm4_app_primary_flash_prot_cfg_s;
+    cy_stc_smpu_cfg_t primary_flash_2_cfg = cm4_app_primary_flash_prot_cfg_s;
+
+    status = (status == CY_PROT_SUCCESS) ? prot_units_fit_two_regions(PROT_UNITS_CM4_PRIMARY_START, PROT_UNITS_CM4_PRIMARY_SIZE, &primary_flash_cfg, &primary_flash_2_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT15, &primary_flash_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT15) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT14, &primary_flash_2_cfg) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT14) : status;
+#endif
 
     /* SMPU 10 - Shared SRAM */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT10, &shared_sram_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT10) : status;
 
-    /* For 512K and 1M devices only */
-#if (CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_1MB) || (CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_512KB)
     /* SMPU 9 - CM4 App + Secondary Slot Flash */
-    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT9, &cm4_secondary_flash_prot_cfg_s) : status;
-    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT9) : status;
-
-    /* For 2M devices only */
-#elif (CY_FLASH_SIZE == PROT_UNITS_FLASH_SIZE_2MB)
-    /* SMPU 9 - CM4 App Flash */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT9, &cm4_app_flash_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT9) : status;
 
-    /* SMPU 8 - Secondary Slot Flash */
-    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT8, &secondary_slot_flash_prot_cfg_s) : status;
+#ifdef CY_PS_LAYOUT_CM4_APP_FLASH_2_ADDR
+    /* SMPU 8 - CM4 App + Secondary Slot Flash, second part */
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT8, &cm4_app_flash_2_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT8) : status;
+#endif
 
+#ifdef CY_PS_LAYOUT_SCRATCH_FLASH_ADDR
     /* SMPU 6 - Scratch Flash */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT6, &scratch_flash_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT6) : status;
 #endif
 
+#ifdef CY_PS_LAYOUT_SWAP_STATUS_FLASH_ADDR
+    /* SMPU 4 - Swap Status Flash */
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT4, &swap_status_flash_prot_cfg_s) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT4) : status;
+#endif
+
     /* SMPU 7 - Protected Storage Flash */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT7, &protected_storage_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT7) : status;
@@ -363,6 +603,12 @@ cy_en_prot_status_t prot_units_init(void)
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT5, &cm4_sram_prot_cfg_s) : status;
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT5) : status;
 
+#ifdef CY_PS_LAYOUT_CM4_SRAM_2_ADDR
+    /* SMPU 2 - CM4 App SRAM, second part */
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT2, &cm4_sram_2_prot_cfg_s) : status;
+    status = (status == CY_PROT_SUCCESS) ? Cy_Prot_EnableSmpuSlaveStruct(PROT_SMPU_SMPU_STRUCT2) : status;
+#endif
+
 #if(CY_IP_MXPERI_VERSION == 1u)
     /* PPU RG - MS_CTL (Bus master control in SMPU) */
     status = (status == CY_PROT_SUCCESS) ? Cy_Prot_ConfigPpuFixedRgSlaveStruct(PERI_GR_PPU_RG_SMPU, &ms_ctl_prot_cfg_s) : status;
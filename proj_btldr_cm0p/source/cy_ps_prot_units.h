@@ -48,6 +48,10 @@
 *******************************************************************************/
 cy_en_prot_status_t prot_units_init(void);
 
+#if defined(MCUBOOT_DIRECT_XIP)
+void prot_units_set_app_slot(uint32_t slot_start);
+#endif
+
 #endif /* CY_PS_PROT_UNITS_H */
 
 /* [] END OF FILE */
@@ -0,0 +1,414 @@
+/******************************************************************************
+* File Name: cy_ps_security_cnt.c
+*
+* Description: This file contains the non-volatile image security counters
+*   used by MCUboot for the rollback protection (MCUBOOT_HW_ROLLBACK_PROT).
+*   The counters are kept in two rows of the protected storage, which only
+*   PC=1,2 can access. Each update writes the row that does not hold the
+*   newest record, so a reset during the write leaves the previous counters
+*   in place. A counter never decreases. Once a counter is recorded, damaged
+*   records make the bootloader refuse every image.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "bootutil/security_cnt.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "cy_ps_security_cnt.h"
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define SECURITY_CNT_RECORD_MAGIC       (0x31434E53UL)      /* "SNC1", changes with the record layout */
+#define SECURITY_CNT_CRC32_POLY         (0xEDB88320UL)
+#define SECURITY_CNT_ERASED_VAL         (0x00U)
+
+/* Results of security_cnt_newest() besides a row index */
+#define SECURITY_CNT_NONE               (-1)    /* No counter recorded yet */
+#define SECURITY_CNT_CORRUPT            (-2)    /* Counters recorded, but no intact record left */
+
+/*******************************************************************************
+ * Structures
+ *******************************************************************************/
+/* Layout of one counter record in flash */
+typedef struct
+{
+    uint32_t magic;                     /* SECURITY_CNT_RECORD_MAGIC */
+    uint32_t seq;                       /* Incremented by each update, may wrap */
+    uint32_t counters[CY_PS_BOOT_SECURITY_CNT_MAX_IMAGES];
+    uint8_t  reserved[CY_FLASH_SIZEOF_ROW - (3u * sizeof(uint32_t)) - (CY_PS_BOOT_SECURITY_CNT_MAX_IMAGES * sizeof(uint32_t))];
+    uint32_t crc;                       /* CRC32 of the fields above */
+} security_cnt_record_t;
+
+_Static_assert(sizeof(security_cnt_record_t) == CY_FLASH_SIZEOF_ROW, "Counter record must be one flash row");
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Record buffer for the flash writes */
+static security_cnt_record_t security_cnt_buf;
+
+/*******************************************************************************
+ * Function Name: security_cnt_crc32
+ *******************************************************************************
+ * Summary:
+ *  Calculates the CRC32 (IEEE 802.3) of a buffer.
+ *
+ * Parameters:
+ *  data - Pointer to the data
+ *  size - Number of bytes
+ *
+ * Return:
+ *  uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t security_cnt_crc32(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0UL; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0UL; bit < 8UL; bit++)
+        {
+            crc = (crc >> 1U) ^ (SECURITY_CNT_CRC32_POLY & (0UL - (crc & 1UL)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_row
+ *******************************************************************************
+ * Summary:
+ *  Returns the counter record stored in one of the two rows.
+ *
+ * Parameters:
+ *  row - Row index, 0 or 1
+ *
+ * Return:
+ *  const security_cnt_record_t* - Pointer to the record in flash
+ *
+ *******************************************************************************/
+static const security_cnt_record_t *security_cnt_row(uint32_t row)
+{
+    return (const security_cnt_record_t *)(CY_PS_SECURITY_CNT_ADDR + (row * CY_FLASH_SIZEOF_ROW));
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_record_valid
+ *******************************************************************************
+ * Summary:
+ *  Checks the magic and CRC of a counter record in flash. Rows torn by a
+ *  reset during erase or program fail the CRC check.
+ *
+ * Parameters:
+ *  record - Pointer to the record
+ *
+ * Return:
+ *  bool - true if the record is intact
+ *
+ *******************************************************************************/
+static bool security_cnt_record_valid(const security_cnt_record_t *record)
+{
+    return (record->magic == SECURITY_CNT_RECORD_MAGIC) &&
+           (record->crc == security_cnt_crc32((const uint8_t *)record, offsetof(security_cnt_record_t, crc)));
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_row_erased
+ *******************************************************************************
+ * Summary:
+ *  Checks whether a row has never been written since the protected storage
+ *  was erased.
+ *
+ * Parameters:
+ *  row - Row index, 0 or 1
+ *
+ * Return:
+ *  bool - true if every byte of the row holds the erased value
+ *
+ *******************************************************************************/
+static bool security_cnt_row_erased(uint32_t row)
+{
+    const uint8_t *data = (const uint8_t *)security_cnt_row(row);
+
+    for (uint32_t i = 0UL; i < CY_FLASH_SIZEOF_ROW; i++)
+    {
+        if (data[i] != SECURITY_CNT_ERASED_VAL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_newest
+ *******************************************************************************
+ * Summary:
+ *  Finds the newest intact counter record. When both rows are intact, the
+ *  sequence numbers are compared with serial number arithmetic so that the
+ *  comparison still holds after the sequence number wraps.
+ *
+ *  The first update writes a record with all counters at 0 to row 1 before
+ *  it writes row 0, so row 0 stays erased until a counter is recorded and
+ *  an intact record is left in one of the rows from then on. Without an
+ *  intact record, an erased row 0 means that no counter was recorded yet.
+ *  Anything else means that the records were damaged, and the counters are
+ *  unknown.
+ *
+ * Return:
+ *  int32_t - Index of the row holding the newest record, SECURITY_CNT_NONE
+ *  or SECURITY_CNT_CORRUPT
+ *
+ *******************************************************************************/
+static int32_t security_cnt_newest(void)
+{
+    bool valid0 = security_cnt_record_valid(security_cnt_row(0u));
+    bool valid1 = security_cnt_record_valid(security_cnt_row(1u));
+
+    if (valid0 && valid1)
+    {
+        return ((int32_t)(security_cnt_row(1u)->seq - security_cnt_row(0u)->seq) > 0) ? 1 : 0;
+    }
+
+    if (valid0 || valid1)
+    {
+        return valid0 ? 0 : 1;
+    }
+
+    return security_cnt_row_erased(0u) ? SECURITY_CNT_NONE : SECURITY_CNT_CORRUPT;
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_read
+ *******************************************************************************
+ * Summary:
+ *  Reads the counter of an image from the newest record. Images without a
+ *  recorded counter have the counter 0.
+ *
+ * Parameters:
+ *  image_id - Index of the image
+ *  value    - Returns the counter value
+ *
+ * Return:
+ *  bool - false if the records are damaged. The counter is then unknown and
+ *  no image must be accepted.
+ *
+ *******************************************************************************/
+static bool security_cnt_read(uint32_t image_id, uint32_t *value)
+{
+    int32_t newest = security_cnt_newest();
+
+    if (newest == SECURITY_CNT_CORRUPT)
+    {
+        return false;
+    }
+
+    *value = (newest == SECURITY_CNT_NONE) ? 0UL : security_cnt_row((uint32_t)newest)->counters[image_id];
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: security_cnt_write
+ *******************************************************************************
+ * Summary:
+ *  Seals the record buffer with its CRC and writes it to a row.
+ *
+ * Parameters:
+ *  row - Row index, 0 or 1
+ *
+ * Return:
+ *  bool - true if the row holds the record
+ *
+ *******************************************************************************/
+static bool security_cnt_write(uint32_t row)
+{
+    security_cnt_buf.magic = SECURITY_CNT_RECORD_MAGIC;
+    security_cnt_buf.crc = security_cnt_crc32((const uint8_t *)&security_cnt_buf, offsetof(security_cnt_record_t, crc));
+
+    if (CY_FLASH_DRV_SUCCESS != Cy_Flash_WriteRow(CY_PS_SECURITY_CNT_ADDR + (row * CY_FLASH_SIZEOF_ROW), (const uint32_t *)&security_cnt_buf))
+    {
+        return false;
+    }
+
+    return (memcmp(&security_cnt_buf, security_cnt_row(row), sizeof(security_cnt_buf)) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: boot_nv_security_counter_init
+ *******************************************************************************
+ * Summary:
+ *  Initializes the security counters. The records in flash need no
+ *  initialization.
+ *
+ * Return:
+ *  fih_int - FIH_SUCCESS
+ *
+ *******************************************************************************/
+fih_int boot_nv_security_counter_init(void)
+{
+    return FIH_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: boot_nv_security_counter_get
+ *******************************************************************************
+ * Summary:
+ *  Reads the security counter of an image. MCUboot refuses an image whose
+ *  security counter TLV is lower than this value.
+ *
+ * Parameters:
+ *  image_id     - Index of the image
+ *  security_cnt - Returns the counter value
+ *
+ * Return:
+ *  fih_int - FIH_SUCCESS, or FIH_FAILURE for an unknown image or damaged
+ *  records, in which case MCUboot refuses the image
+ *
+ *******************************************************************************/
+fih_int boot_nv_security_counter_get(uint32_t image_id, fih_int *security_cnt)
+{
+    uint32_t value;
+
+    if ((security_cnt == NULL) || (image_id >= MCUBOOT_IMAGE_NUMBER) || !security_cnt_read(image_id, &value))
+    {
+        return FIH_FAILURE;
+    }
+
+    *security_cnt = fih_int_encode((int)value);
+
+    return FIH_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: boot_nv_security_counter_update
+ *******************************************************************************
+ * Summary:
+ *  Raises the security counter of an image to the value of the image that
+ *  MCUboot is about to boot. A lower value never replaces a higher one, and
+ *  the flash is written only when the counter increases.
+ *
+ * Parameters:
+ *  image_id         - Index of the image
+ *  img_security_cnt - Security counter TLV of the image
+ *
+ * Return:
+ *  int32_t - 0 on success, -1 if the image is unknown, the records are
+ *  damaged or the write failed
+ *
+ *******************************************************************************/
+int32_t boot_nv_security_counter_update(uint32_t image_id, uint32_t img_security_cnt)
+{
+    int32_t newest = security_cnt_newest();
+    uint32_t target_row;
+
+    if ((image_id >= MCUBOOT_IMAGE_NUMBER) || (newest == SECURITY_CNT_CORRUPT))
+    {
+        return -1;
+    }
+
+    (void)memset(&security_cnt_buf, 0, sizeof(security_cnt_buf));
+    if (newest >= 0)
+    {
+        (void)memcpy(&security_cnt_buf, security_cnt_row((uint32_t)newest), sizeof(security_cnt_buf));
+    }
+
+    if (img_security_cnt <= security_cnt_buf.counters[image_id])
+    {
+        return 0;
+    }
+
+    /* First counter: record all counters at 0 in row 1, so that row 0 is
+     * written only once an intact record exists (see security_cnt_newest())
+     */
+    if (newest == SECURITY_CNT_NONE)
+    {
+        if (!security_cnt_write(1u))
+        {
+            return -1;
+        }
+        newest = 1;
+    }
+
+    /* Write the row that does not hold the newest record. If the write is
+     * interrupted, that row fails the CRC check and the newest record is kept.
+     */
+    target_row = (newest == 0) ? 1u : 0u;
+
+    security_cnt_buf.seq++;
+    security_cnt_buf.counters[image_id] = img_security_cnt;
+
+    return security_cnt_write(target_row) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: cy_ps_security_cnt_publish
+ *******************************************************************************
+ * Summary:
+ *  Copies the security counters to the boot shared data. The DFU in the CM4
+ *  app, which cannot read the protected storage, uses them to refuse an
+ *  older image before it is transferred. The copy is only a hint: the
+ *  bootloader checks the counters again before it boots an image. With
+ *  damaged records, the highest counter is published, as the bootloader
+ *  accepts no image.
+ *
+ *******************************************************************************/
+void cy_ps_security_cnt_publish(void)
+{
+    cy_stc_ps_boot_security_cnt_t *shared = &CY_PS_BOOT_SHARED->security_cnt;
+
+    (void)memset(shared, 0, sizeof(*shared));
+    for (uint32_t image_id = 0UL; image_id < MCUBOOT_IMAGE_NUMBER; image_id++)
+    {
+        if (!security_cnt_read(image_id, &shared->counters[image_id]))
+        {
+            shared->counters[image_id] = UINT32_MAX;
+        }
+    }
+    shared->count = MCUBOOT_IMAGE_NUMBER;
+    shared->magic = CY_PS_BOOT_SECURITY_CNT_MAGIC;
+}
+
+/* [] END OF FILE */
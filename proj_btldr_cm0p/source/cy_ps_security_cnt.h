@@ -0,0 +1,79 @@
+/******************************************************************************
+* File Name: cy_ps_security_cnt.h
+*
+* Description: Header file for the image security counters kept in the
+*   protected storage by the bootloader.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CY_PS_SECURITY_CNT_H
+#define CY_PS_SECURITY_CNT_H
+
+#include "cy_ps_boot_shared.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/***************************************
+*               Macros
+***************************************/
+/* The counter record uses two rows of the protected storage, right before the
+ * row of the validated-image cache (see cy_ps_boot_cache.h).
+ */
+#define CY_PS_SECURITY_CNT_ROWS         (2u)
+#define CY_PS_SECURITY_CNT_ADDR         (PROTECTED_MEM_START + PROTECTED_MEM_SIZE - \
+                                         ((CY_PS_SECURITY_CNT_ROWS + 1u) * CY_FLASH_SIZEOF_ROW))
+
+_Static_assert(MCUBOOT_IMAGE_NUMBER <= CY_PS_BOOT_SECURITY_CNT_MAX_IMAGES, "One security counter is kept per image");
+
+/*******************************************************************************
+* Functions
+*******************************************************************************/
+/* The MCUboot hooks, boot_nv_security_counter_init(),
+ * boot_nv_security_counter_get() and boot_nv_security_counter_update(), are
+ * declared in bootutil/security_cnt.h.
+ */
+void cy_ps_security_cnt_publish(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CY_PS_SECURITY_CNT_H */
+
+/* [] END OF FILE */
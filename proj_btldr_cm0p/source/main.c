@@ -64,6 +64,11 @@
 #include "cy_ps_prot_units.h"
 #include "cy_ps_keystorage.h"
 #include "cy_ps_efuse.h"
+#include "cy_ps_boot_timing.h"
+#include "cy_ps_boot_log.h"
+#include "cy_ps_boot_cache.h"
+#include "cy_ps_security_cnt.h"
+#include "cy_ps_boot_efuse.h"
 
 /*******************************************************************************
  * Macros
@@ -81,13 +86,6 @@
  */
 #define UART_TX_COMPLETE_POLL_COUNT      (10UL)
 
-/* EFuse Register Offsets */
-#define LIFECYCLE_EFUSE_OFFSET           0x02B
-#define DEAD_ACCESS0_EFUSE_OFFSET        0x027
-#define DEAD_ACCESS1_EFUSE_OFFSET        0x028
-#define SECURE_ACCESS0_EFUSE_OFFSET      0x029
-#define SECURE_ACCESS1_EFUSE_OFFSET      0x02A
-
 /* Flashboot Access Control Register Masks */
 #define CY_FB_AP_CTL_CM0_ENABLE_MASK     ( (uint32_t)1u <<  0u)
 #define CY_FB_AP_CTL_CM4_ENABLE_MASK     ( (uint32_t)1u <<  1u)
@@ -110,7 +108,7 @@
  * Function prototypes
  *******************************************************************************/
 static void deinit_hw(void);
-static void do_boot(void);
+static void do_boot(struct boot_rsp *rsp);
 
 #if (CONFIGURE_SWJ_PINS == 1u)
 static void configure_swj(void);
@@ -206,11 +204,16 @@ static const uint8_t cy_ps_appSignature[CY_PS_SECURE_DIGSIG_SIZE] = {0u};
 int main(void)
 {
     cy_rslt_t result;
-    uint8_t lifecycle, dead_access0, dead_access1, secure_access0, secure_access1;
+    cy_en_efuse_status_t efuse_status;
+    const uint8_t *efuse = CY_PS_BOOT_SHARED->efuse.bytes;
 
     /* Structure holding the address to boot from */
     struct boot_rsp rsp;
 
+    /* Start recording the boot phase timing */
+    cy_ps_boot_timing_init();
+    cy_ps_boot_log_init();
+
     /* Certain PSoC 6 devices enable CM4 by default at startup. It must be
      * either disabled or enabled & running a valid application for flash write
      * to work from CM0+. Flash writes may be required for updating the image
@@ -233,68 +236,135 @@ int main(void)
 
     /* Initialize retarget-io to redirect the printf output */
     cy_retarget_io_pdl_init(CY_RETARGET_IO_BAUDRATE);
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_INIT);
 
-    /* Get lifecycle states and access restrictions */
-    Cy_EFUSE_GetEfuseByte(LIFECYCLE_EFUSE_OFFSET,      &lifecycle);
-    Cy_EFUSE_GetEfuseByte(DEAD_ACCESS0_EFUSE_OFFSET,   &dead_access0);
-    Cy_EFUSE_GetEfuseByte(DEAD_ACCESS1_EFUSE_OFFSET,   &dead_access1);
-    Cy_EFUSE_GetEfuseByte(SECURE_ACCESS0_EFUSE_OFFSET, &secure_access0);
-    Cy_EFUSE_GetEfuseByte(SECURE_ACCESS1_EFUSE_OFFSET, &secure_access1);
-
-    BOOT_LOG_INF("\r\n=======================================================================");
-    BOOT_LOG_INF("MCUboot Bootloader Started (CPU: CM0+)  %s %s",  __DATE__, __TIME__);
-    BOOT_LOG_INF("Device lifecycle=0x%02x, dead0=0x%02x, dead1=0x%02x, secure0=0x%02x, " \
-            "\r\nsecure1=0x%02x \r\n", lifecycle, dead_access0, dead_access1, secure_access0, \
-            secure_access1);
+    /* Get lifecycle states and access restrictions, and publish them for the
+     * user applications
+     */
+    efuse_status = cy_ps_boot_efuse_publish();
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_EFUSE);
+
+    CY_PS_BOOT_LOG("\r\n=======================================================================");
+    CY_PS_BOOT_LOG("MCUboot Bootloader Started (CPU: CM0+)  " __DATE__ " " __TIME__);
+    CY_PS_BOOT_LOG("Device lifecycle=0x%02x, dead0=0x%02x, dead1=0x%02x, secure0=0x%02x, " \
+            "\r\nsecure1=0x%02x \r\n", efuse[CY_PS_BOOT_EFUSE_LIFECYCLE], \
+            efuse[CY_PS_BOOT_EFUSE_DEAD_ACCESS0], efuse[CY_PS_BOOT_EFUSE_DEAD_ACCESS1], \
+            efuse[CY_PS_BOOT_EFUSE_SECURE_ACCESS0], efuse[CY_PS_BOOT_EFUSE_SECURE_ACCESS1]);
+    if (CY_EFUSE_SUCCESS != efuse_status)
+    {
+        CY_PS_BOOT_LOG("eFuse read failed: 0x%08x, no snapshot published", (unsigned int) efuse_status);
+    }
 
     /* Get current PC value */
     uint32_t active_pc = Cy_Prot_GetActivePC(CPUSS_MS_ID_CM0);
-    BOOT_LOG_INF("Active PC value: 0x%02X", (int) active_pc);
+    CY_PS_BOOT_LOG("Active PC value: 0x%02X", (int) active_pc);
 
 #if (CONFIGURE_SWJ_PINS == 1u)
 
     /* Check current status of debug access ports */
-    BOOT_LOG_INF("CPUSS_AP_CTL: 0x%08X, CPUSS_DP_STATUS: 0x%08X  \r\n", \
+    CY_PS_BOOT_LOG("CPUSS_AP_CTL: 0x%08X, CPUSS_DP_STATUS: 0x%08X  \r\n", \
             (int) CPUSS_AP_CTL, (int) CPUSS_DP_STATUS);
 
     /* Configure the SWJ pins */
     configure_swj();
 
     /* Check status of debug access ports after modification */
-    BOOT_LOG_INF("CPUSS_AP_CTL after modification: 0x%08X, CPUSS_DP_STATUS: " \
+    CY_PS_BOOT_LOG("CPUSS_AP_CTL after modification: 0x%08X, CPUSS_DP_STATUS: " \
             "0x%08X \r\n", (int) CPUSS_AP_CTL, (int) CPUSS_DP_STATUS);
 #endif
 
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    /* Initialize the external flash that holds the secondary slot. If this
+     * fails, MCUboot cannot read the secondary slot and boots the primary slot.
+     */
+    cy_en_smif_status_t qspi_status = qspi_init_sfdp(CY_BOOT_EXTERNAL_SMIF_ID);
+
+    if (qspi_status == CY_SMIF_SUCCESS)
+    {
+        CY_PS_BOOT_LOG("External memory initialized using SFDP");
+    }
+    else
+    {
+        CY_PS_BOOT_LOG("External memory initialization using SFDP failed: 0x%08X", (int) qspi_status);
+    }
+#endif
+
+#if defined(MCUBOOT_DIRECT_XIP)
+    /* In direct-XIP mode, the protection of the user app flash depends on the
+     * slot it executes from. Select and validate the image before the
+     * protection units are locked.
+     */
+    int boot_status = boot_go(&rsp);
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_BOOT_GO);
+
+    if (boot_status == 0)
+    {
+        prot_units_set_app_slot(CY_START_OF_FLASH + rsp.br_image_off);
+    }
+#elif (FAST_BOOT == 1u)
+    /* With fast boot, the protection units make the primary slot read-only,
+     * also for the bootloader. Validate or upgrade the image before the
+     * protection units are locked.
+     */
+    int boot_status = 0;
+    cy_en_ps_boot_cache_result_t cache_result = cy_ps_boot_cache_lookup(&rsp);
+
+    if (cache_result != CY_PS_BOOT_CACHE_HIT)
+    {
+        boot_status = boot_go(&rsp);
+        if (boot_status == 0)
+        {
+            cy_ps_boot_cache_update();
+        }
+    }
+    CY_PS_BOOT_LOG("Fast boot: %u (0 = validation skipped)", (unsigned int) cache_result);
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_BOOT_GO);
+#endif
+
     /* Configure the protection units */
-    BOOT_LOG_INF("Configuring protection units...");
+    CY_PS_BOOT_LOG("Configuring protection units...");
 
     result = prot_units_init();
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_PROT_UNITS);
 
     if(result != CY_PROT_SUCCESS)
     {
-        BOOT_LOG_INF("Protection units setup failed!\r\n");
+        CY_PS_BOOT_LOG("Protection units setup failed!\r\n");
+#if (BOOT_LOG_DEFERRED == 1u)
+        cy_ps_boot_log_dump();
+#endif
         CY_ASSERT(0);
     }
 
-    BOOT_LOG_INF("Protection units configured successfully!");
+    CY_PS_BOOT_LOG("Protection units configured successfully!");
 
     /* Get current PC value */
     active_pc = Cy_Prot_GetActivePC(CPUSS_MS_ID_CM0);
-    BOOT_LOG_INF("Active PC value after protection unit " \
+    CY_PS_BOOT_LOG("Active PC value after protection unit " \
             "configuration: 0x%02X\r\n", (int) active_pc);
 
     /* Validate user application */
-    if (boot_go(&rsp) == 0)
+#if defined(MCUBOOT_DIRECT_XIP) || (FAST_BOOT == 1u)
+    /* Done before configuring the protection units */
+#else
+    int boot_status = boot_go(&rsp);
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_BOOT_GO);
+#endif
+
+    /* Let the DFU in the CM4 app know the security counters of the images */
+    cy_ps_security_cnt_publish();
+
+    if (boot_status == 0)
     {
-        BOOT_LOG_INF("User Application validated successfully\r\n");
-        BOOT_LOG_INF("--- rsp Addr             0x%08X\r\n", (int) &rsp);
-        BOOT_LOG_INF("--- HDR Addr             0x%08X", (int) &rsp.br_hdr);
-        BOOT_LOG_INF("--- br_flash_div_id      0x%08X", (int) rsp.br_flash_dev_id);
-        BOOT_LOG_INF("--- br_image_off         0x%08X", (int) rsp.br_image_off);
-        BOOT_LOG_INF("--- ih_load_addr         0x%08X", (int) rsp.br_hdr->ih_load_addr);
-        BOOT_LOG_INF("--- ih_img_size          0x%08X", (int) rsp.br_hdr->ih_img_size);
-        BOOT_LOG_INF("--- ih_hdr_size          0x%08X", (int) rsp.br_hdr->ih_hdr_size);
-        BOOT_LOG_INF("--- ih_protect_tlv_size  0x%08X\r\n", (int) rsp.br_hdr->ih_protect_tlv_size);
+        CY_PS_BOOT_LOG("User Application validated successfully\r\n");
+        CY_PS_BOOT_LOG("--- rsp Addr             0x%08X\r\n", (int) &rsp);
+        CY_PS_BOOT_LOG("--- HDR Addr             0x%08X", (int) &rsp.br_hdr);
+        CY_PS_BOOT_LOG("--- br_flash_div_id      0x%08X", (int) rsp.br_flash_dev_id);
+        CY_PS_BOOT_LOG("--- br_image_off         0x%08X", (int) rsp.br_image_off);
+        CY_PS_BOOT_LOG("--- ih_load_addr         0x%08X", (int) rsp.br_hdr->ih_load_addr);
+        CY_PS_BOOT_LOG("--- ih_img_size          0x%08X", (int) rsp.br_hdr->ih_img_size);
+        CY_PS_BOOT_LOG("--- ih_hdr_size          0x%08X", (int) rsp.br_hdr->ih_hdr_size);
+        CY_PS_BOOT_LOG("--- ih_protect_tlv_size  0x%08X\r\n", (int) rsp.br_hdr->ih_protect_tlv_size);
 
         /* Initialize the watchdog timer. It should be updated from the user application
          * to mark successful start up of the application. If the watchdog is not updated,
@@ -304,13 +374,17 @@ int main(void)
         cy_wdg_init(WDT_TIME_OUT_MS);
 
         /* Jump to user application */
-        do_boot();
+        do_boot(&rsp);
     }
     else
     {
-        BOOT_LOG_INF("MCUboot Bootloader found no bootable image.");
-        BOOT_LOG_INF("--- rsp Addr     0x%08X", (int) &rsp);
-        BOOT_LOG_INF("--- HDR Addr     0x%08X", (int) rsp.br_hdr);
+        CY_PS_BOOT_LOG("MCUboot Bootloader found no bootable image.");
+        CY_PS_BOOT_LOG("--- rsp Addr     0x%08X", (int) &rsp);
+        CY_PS_BOOT_LOG("--- HDR Addr     0x%08X", (int) rsp.br_hdr);
+#if (BOOT_LOG_DEFERRED == 1u)
+        /* No user application will report the log, print it here */
+        cy_ps_boot_log_dump();
+#endif
 
         /* Wait for UART transfer to complete */
         cy_retarget_io_wait_tx_complete(CYBSP_UART_HW, UART_TX_COMPLETE_POLL_COUNT);
@@ -349,14 +423,17 @@ static void deinit_hw(void)
     /* Deinitialize the UART pins */
     Cy_GPIO_Port_Deinit(CYBSP_DEBUG_UART_RX_PORT);
     Cy_GPIO_Port_Deinit(CYBSP_DEBUG_UART_TX_PORT);
+
+    /* Stop the boot timing timer and publish the record */
+    cy_ps_boot_timing_deinit();
 }
 
 /******************************************************************************
  * Function Name: do_boot
  ******************************************************************************
  * Summary:
- *  This function jumps to the user application address defined in the linker
- *  script
+ *  This function jumps to the user application of the slot selected by
+ *  MCUboot. The CM0+ image starts right after the MCUboot header.
  *
  * Parameters:
  *  rsp - Pointer to a structure holding the address to boot from.
@@ -365,19 +442,20 @@ static void deinit_hw(void)
  *  None
  *
  ******************************************************************************/
-static void do_boot(void)
+static void do_boot(struct boot_rsp *rsp)
 {
     static uint32_t appStartAddr = 0u;
     static uint32_t appStackPtr  = 0u;
 
 #define RESET_VECTOR_POS (0x04)
 
-    /* CM0P_APP_FLASH_START and MCUBOOT_HEADER_SIZE is defined in Makefiles */
-    uint32_t *CM0_App_Stack_Ptr = (uint32_t *)(CM0P_APP_FLASH_START + MCUBOOT_HEADER_SIZE);
-    uint32_t *CM0_App_PC_Ptr    = (uint32_t *)(CM0P_APP_FLASH_START + MCUBOOT_HEADER_SIZE + RESET_VECTOR_POS);
+    /* The slot offset is relative to the start of the internal flash */
+    uint32_t app_vector_table = CY_START_OF_FLASH + rsp->br_image_off + rsp->br_hdr->ih_hdr_size;
+    uint32_t *CM0_App_Stack_Ptr = (uint32_t *)(app_vector_table);
+    uint32_t *CM0_App_PC_Ptr    = (uint32_t *)(app_vector_table + RESET_VECTOR_POS);
 
-    BOOT_LOG_INF("CM0 app stack: 0x%08X", (int) *CM0_App_Stack_Ptr);
-    BOOT_LOG_INF("CM0 app PC:    0x%08X", (int) *CM0_App_PC_Ptr);
+    CY_PS_BOOT_LOG("CM0 app stack: 0x%08X", (int) *CM0_App_Stack_Ptr);
+    CY_PS_BOOT_LOG("CM0 app PC:    0x%08X", (int) *CM0_App_PC_Ptr);
 
     /* Get the user application start address and stack pointer address */
     appStartAddr = *CM0_App_PC_Ptr;
@@ -386,8 +464,9 @@ static void do_boot(void)
     /* Set the main stack pointer to the user app stack pointer */
     __set_MSP(appStackPtr);
 
-    BOOT_LOG_INF("Starting User Application on CM0+. Please wait...");
+    CY_PS_BOOT_LOG("Starting User Application on CM0+. Please wait...");
     cy_retarget_io_wait_tx_complete(CYBSP_UART_HW, UART_TX_COMPLETE_POLL_COUNT);
+    cy_ps_boot_timing_mark(CY_PS_BOOT_PHASE_DO_BOOT);
 
     /* De-initialize all hardware resources before jumping */
     deinit_hw();
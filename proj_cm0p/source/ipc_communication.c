@@ -153,6 +153,9 @@ uint32_t ipc_rcv_msg_from_cm4(void)
         CY_ASSERT(status == CY_IPC_DRV_SUCCESS);
     }
 
+    /* Release the channel so that the CM4 can send the next message */
+    (void)Cy_IPC_Drv_LockRelease(ipc_intr_cm0p_addr, CY_IPC_NO_NOTIFICATION);
+
     return message;
 }
 
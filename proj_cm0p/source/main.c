@@ -45,6 +45,11 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "ipc_communication.h"
+#include "prot_storage.h"
+#include <string.h>
+#if defined(DFU_ENCRYPTION)
+#include "../proj_btldr_cm0p/source/cy_ps_keystorage.h"
+#endif
 
 /*******************************************************************************
  * Macros
@@ -75,6 +80,24 @@
 #error "[UserApp] Please define the image type: BOOT_IMAGE or UPGRADE_IMAGE\n"
 #endif
 
+/* Interval at which the IPC commands are processed */
+#define IPC_POLL_INTERVAL_MS           (10u)
+
+/* Requests that carry data are only accepted in the shared SRAM after the
+ * boot shared data.
+ */
+#define IPC_REQUEST_AREA_START         (SHARED_SRAM_START + BOOT_SHARED_SRAM_SIZE)
+#define IPC_REQUEST_AREA_END           (SHARED_SRAM_START + SHARED_SRAM_SIZE)
+
+#if defined(DFU_ENCRYPTION)
+/* The key-encryption key of the DFU images is user key #1 of the secure key
+ * storage in the bootloader flash, which only PC=1,2 can read.
+ */
+#define DFU_KEK_INDEX                  (0u)
+#endif
+
+_Static_assert(IPC_RECORD_SIZE == PROT_STORAGE_MAX_RECORD_SIZE, "IPC record size does not match the protected storage");
+
 /*******************************************************************************
  * Global Variables
  *******************************************************************************/
@@ -85,12 +108,16 @@ uint32_t msg_cmd = 0;
  * Function prototypes
  *******************************************************************************/
 void cm0p_msg_callback(void);
+static void write_record(uint32_t request_addr);
+#if defined(DFU_ENCRYPTION)
+static void unwrap_key(uint32_t request_addr);
+#endif
 
 /* Protected storage can be used for storing any critical data.
- * It is static in this code example for simplicity, but can be
- * modified by the user to their own implementation.
+ * Static data is placed in the first row of the protected storage. The
+ * remaining rows hold the journaled records, see prot_storage.c.
  */
-CY_SECTION(".protected_storage") static const uint32_t device_id = 0xAA55AA55;
+CY_SECTION(".cy_prot_storage") static const uint32_t device_id = 0xAA55AA55;
 
 /******************************************************************************
  * Function Name: main
@@ -109,6 +136,7 @@ CY_SECTION(".protected_storage") static const uint32_t device_id = 0xAA55AA55;
 int main(void)
 {
     cy_rslt_t result;
+    uint32_t led_elapsed_ms = 0u;
 
     /* Enable global interrupts */
     __enable_irq();
@@ -126,20 +154,34 @@ int main(void)
     /* Initialize the LED pin to strong drive mode */
     cyhal_gpio_init(USER_LED, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, true);
 
+    /* Recover the journaled records from the protected storage */
+    if (prot_storage_init() == PROT_STORAGE_ERR_FLASH)
+    {
+        CY_ASSERT(0);
+    }
+
     /* Init the IPC communication for CM0+ */
     setup_ipc_communication_cm0p();
 
     for (;;)
     {
         /* Add a delay */
-        cyhal_system_delay_ms(LED_TOGGLE_INTERVAL_MS);
+        cyhal_system_delay_ms(IPC_POLL_INTERVAL_MS);
 
         /* Toggle the LED */
-        cyhal_gpio_toggle(USER_LED);
+        led_elapsed_ms += IPC_POLL_INTERVAL_MS;
+        if (led_elapsed_ms >= LED_TOGGLE_INTERVAL_MS)
+        {
+            led_elapsed_ms = 0u;
+            cyhal_gpio_toggle(USER_LED);
+        }
 
         /* Process IPC commands */
         switch (msg_cmd)
         {
+            case 0:
+                break;
+
             case IPC_CMD_READ_DATA:
 
                 /* Send the unique device ID to CM4 to be printed */
@@ -148,6 +190,11 @@ int main(void)
                 break;
 
             default:
+                /* Commands that carry data send the address of the request */
+                write_record(msg_cmd);
+#if defined(DFU_ENCRYPTION)
+                unwrap_key(msg_cmd);
+#endif
                 break;
         }
 
@@ -178,4 +225,106 @@ void cm0p_msg_callback(void)
     Cy_IPC_Drv_ClearInterrupt(ipc_intr_cm0p_addr, IPC_CH0_INTR_RELEASE_MASK, IPC_CH0_INTR_ACQUIRE_MASK);
 }
 
+/*******************************************************************************
+ * Function Name: write_record
+ ********************************************************************************
+ * Summary:
+ *   Writes a record of the CM4 to the journal of the protected storage. The
+ *   record is copied out of the shared SRAM first, so that the CM4 cannot
+ *   change it while it is written. The CM4 can only write the records from
+ *   IPC_RECORD_ID_CM4_FIRST on.
+ *
+ * Parameters:
+ *   request_addr - Address of the ipc_write_record_t request
+ *
+ *******************************************************************************/
+static void write_record(uint32_t request_addr)
+{
+    ipc_write_record_t *request = (ipc_write_record_t *)request_addr;
+    uint8_t data[IPC_RECORD_SIZE];
+    uint8_t id;
+    uint8_t length;
+    prot_storage_status_t status = PROT_STORAGE_ERR_PARAM;
+
+    if ((request_addr < IPC_REQUEST_AREA_START) ||
+        (request_addr > (IPC_REQUEST_AREA_END - sizeof(ipc_write_record_t))) ||
+        ((request_addr % sizeof(uint32_t)) != 0u) ||
+        (request->cmd != IPC_CMD_WRITE_RECORD))
+    {
+        return;
+    }
+
+    id = request->id;
+    length = request->length;
+    (void)memcpy(data, request->data, IPC_RECORD_SIZE);
+
+    if (id >= IPC_RECORD_ID_CM4_FIRST)
+    {
+        status = prot_storage_write(id, data, length);
+    }
+
+    __DSB();
+    request->status = (status == PROT_STORAGE_SUCCESS) ? IPC_STATUS_DONE : IPC_STATUS_ERROR;
+}
+
+#if defined(DFU_ENCRYPTION)
+/*******************************************************************************
+ * Function Name: unwrap_key
+ ********************************************************************************
+ * Summary:
+ *   Unwraps the key of an encrypted DFU image for the CM4. The image key is
+ *   wrapped with AES-128 ECB under the key-encryption key, which the CM4
+ *   cannot read. The request is only accepted from the shared SRAM, so that
+ *   the CM4 cannot make the CM0+ write to other memory.
+ *
+ * Parameters:
+ *   request_addr - Address of the ipc_unwrap_key_t request
+ *
+ *******************************************************************************/
+static void unwrap_key(uint32_t request_addr)
+{
+    ipc_unwrap_key_t *request = (ipc_unwrap_key_t *)request_addr;
+    const uint8_t *kek = (const uint8_t *)SFLASH->TOC2_KEY_BLOCK_ADDR + (DFU_KEK_INDEX * CY_PS_SECURE_KEY_LENGTH);
+    cy_stc_crypto_aes_state_t aes_state = { 0 };
+    CY_ALIGN(4) cy_stc_crypto_aes_buffers_t aes_buffers;
+    CY_ALIGN(4) uint8_t key[IPC_KEY_SIZE];
+    cy_en_crypto_status_t crypto_status;
+
+    if ((request_addr < IPC_REQUEST_AREA_START) ||
+        (request_addr > (IPC_REQUEST_AREA_END - sizeof(ipc_unwrap_key_t))) ||
+        ((request_addr % sizeof(uint32_t)) != 0u) ||
+        (request->cmd != IPC_CMD_UNWRAP_KEY))
+    {
+        return;
+    }
+
+    (void)memcpy(key, request->key, IPC_KEY_SIZE);
+
+    crypto_status = Cy_Crypto_Core_Enable(CRYPTO);
+
+    if (crypto_status == CY_CRYPTO_SUCCESS)
+    {
+        crypto_status = Cy_Crypto_Core_Aes_Init(CRYPTO, kek, CY_CRYPTO_KEY_AES_128, &aes_state, &aes_buffers);
+    }
+
+    if (crypto_status == CY_CRYPTO_SUCCESS)
+    {
+        crypto_status = Cy_Crypto_Core_Aes_Ecb(CRYPTO, CY_CRYPTO_DECRYPT, key, key, &aes_state);
+        (void)Cy_Crypto_Core_Aes_Free(CRYPTO, &aes_state);
+    }
+
+    if (crypto_status == CY_CRYPTO_SUCCESS)
+    {
+        (void)memcpy(request->key, key, IPC_KEY_SIZE);
+    }
+
+    /* Do not leave key material on the stack */
+    (void)memset(key, 0, sizeof(key));
+    (void)memset(&aes_buffers, 0, sizeof(aes_buffers));
+
+    __DSB();
+    request->status = (crypto_status == CY_CRYPTO_SUCCESS) ? IPC_STATUS_DONE : IPC_STATUS_ERROR;
+}
+#endif /* DFU_ENCRYPTION */
+
 /* [] END OF FILE */
@@ -0,0 +1,623 @@
+/******************************************************************************
+* File Name:   prot_storage.c
+*
+* Description: This file contains a journaled record store on top of the
+*              protected storage flash area. Updates are appended as
+*              sequence-numbered, CRC protected rows so that a reset in the
+*              middle of a flash write never corrupts committed data.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "prot_storage.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The first row of the protected storage holds the static data placed in the
+ * .cy_prot_storage section by the linker. The last three rows hold the
+ * security counters and the validated-image cache of the bootloader. The
+ * journal uses the remaining rows.
+ */
+#define PROT_STORAGE_JOURNAL_START      (PROTECTED_MEM_START + CY_FLASH_SIZEOF_ROW)
+#define PROT_STORAGE_JOURNAL_ROWS       ((PROTECTED_MEM_SIZE / CY_FLASH_SIZEOF_ROW) - 4u)
+
+#define PROT_STORAGE_ROW_MAGIC          (0x50534A33UL)  /* "PSJ3", changes with the row layout */
+#define PROT_STORAGE_ROW_HDR_SIZE       (16u)
+#define PROT_STORAGE_PAYLOAD_SIZE       (CY_FLASH_SIZEOF_ROW - PROT_STORAGE_ROW_HDR_SIZE)
+
+#define PROT_STORAGE_FLAG_COMMIT        (0x01u)         /* Last row of a transaction */
+#define PROT_STORAGE_FLAG_SNAPSHOT      (0x02u)         /* Transaction holds the complete record set */
+
+/* Each record in a row is stored as ID, length and data bytes */
+#define PROT_STORAGE_ENTRY_HDR_SIZE     (2u)
+#define PROT_STORAGE_ENTRIES_PER_ROW    (PROT_STORAGE_PAYLOAD_SIZE / (PROT_STORAGE_ENTRY_HDR_SIZE + PROT_STORAGE_MAX_RECORD_SIZE))
+
+/* Worst case number of rows needed to write a snapshot of all the records.
+ * The journal always keeps this many rows free so that a snapshot can be
+ * written without overwriting the previous one.
+ */
+#define PROT_STORAGE_SNAPSHOT_ROWS      ((PROT_STORAGE_MAX_RECORDS + PROT_STORAGE_ENTRIES_PER_ROW - 1u) / PROT_STORAGE_ENTRIES_PER_ROW)
+
+#define PROT_STORAGE_CRC32_POLY         (0xEDB88320UL)
+
+_Static_assert(PROT_STORAGE_JOURNAL_ROWS >= (2u * PROT_STORAGE_SNAPSHOT_ROWS) + 1u, "Protected storage is too small for the journal");
+_Static_assert(PROT_STORAGE_MAX_RECORD_SIZE <= UINT8_MAX, "Record length must fit in one byte");
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Layout of one journal row in flash */
+typedef struct
+{
+    uint32_t magic;                     /* PROT_STORAGE_ROW_MAGIC */
+    uint32_t seq;                       /* Row sequence number, row = (seq - 1) % rows */
+    uint8_t  txn_index;                 /* Index of this row in its transaction */
+    uint8_t  flags;                     /* PROT_STORAGE_FLAG_xxx */
+    uint16_t payload_len;               /* Number of used payload bytes */
+    uint32_t crc;                       /* CRC32 of the header fields above and the payload */
+    uint8_t  payload[PROT_STORAGE_PAYLOAD_SIZE];
+} prot_storage_row_t;
+
+_Static_assert(sizeof(prot_storage_row_t) == CY_FLASH_SIZEOF_ROW, "Journal row must be one flash row");
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* RAM copy of the committed records. A length of zero marks an empty record. */
+static uint8_t record_len[PROT_STORAGE_MAX_RECORDS];
+static uint8_t record_data[PROT_STORAGE_MAX_RECORDS][PROT_STORAGE_MAX_RECORD_SIZE];
+
+/* Sequence number of the next row to be written */
+static uint32_t next_seq = 1u;
+
+/* Sequence number of the first row of the latest snapshot (or the first row
+ * ever written). Rows before it are no longer needed and can be reused.
+ */
+static uint32_t base_seq = 1u;
+
+/* Row buffer used for programming */
+static prot_storage_row_t row_buf;
+
+/*******************************************************************************
+ * Function Name: prot_storage_crc32
+ ********************************************************************************
+ * Summary:
+ *   Calculates the CRC32 (IEEE 802.3) of a buffer. The result of a previous
+ *   call can be passed as the initial value to continue the calculation.
+ *
+ * Parameters:
+ *   crc  - CRC of the preceding data or 0
+ *   data - Pointer to the data
+ *   size - Number of bytes
+ *
+ * Return:
+ *   uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t prot_storage_crc32(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    crc = ~crc;
+
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1u) ^ (PROT_STORAGE_CRC32_POLY & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_row_crc
+ ********************************************************************************
+ * Summary:
+ *   Calculates the CRC of a journal row, excluding the CRC field itself.
+ *
+ * Parameters:
+ *   row - Pointer to the row
+ *
+ * Return:
+ *   uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t prot_storage_row_crc(const prot_storage_row_t *row)
+{
+    uint32_t crc = prot_storage_crc32(0u, (const uint8_t *)row, offsetof(prot_storage_row_t, crc));
+
+    return prot_storage_crc32(crc, row->payload, sizeof(row->payload));
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_row_addr
+ ********************************************************************************
+ * Summary:
+ *   Returns the flash address of the journal row holding a sequence number.
+ *
+ * Parameters:
+ *   seq - Row sequence number
+ *
+ * Return:
+ *   const prot_storage_row_t* - Pointer to the row in flash
+ *
+ *******************************************************************************/
+static const prot_storage_row_t *prot_storage_row_addr(uint32_t seq)
+{
+    uint32_t row = (seq - 1u) % PROT_STORAGE_JOURNAL_ROWS;
+
+    return (const prot_storage_row_t *)(PROT_STORAGE_JOURNAL_START + (row * CY_FLASH_SIZEOF_ROW));
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_row_is_valid
+ ********************************************************************************
+ * Summary:
+ *   Checks whether the row at the position of a sequence number was
+ *   completely written with that sequence number. Rows torn by a reset during
+ *   erase or program fail the CRC check.
+ *
+ * Parameters:
+ *   seq - Expected row sequence number
+ *
+ * Return:
+ *   bool - true if the row is valid
+ *
+ *******************************************************************************/
+static bool prot_storage_row_is_valid(uint32_t seq)
+{
+    const prot_storage_row_t *row = prot_storage_row_addr(seq);
+
+    return (row->magic == PROT_STORAGE_ROW_MAGIC) &&
+           (row->seq == seq) &&
+           (row->payload_len <= PROT_STORAGE_PAYLOAD_SIZE) &&
+           (row->crc == prot_storage_row_crc(row));
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_apply_row
+ ********************************************************************************
+ * Summary:
+ *   Applies the records stored in a journal row to the RAM copy.
+ *
+ * Parameters:
+ *   row - Pointer to the row in flash
+ *
+ *******************************************************************************/
+static void prot_storage_apply_row(const prot_storage_row_t *row)
+{
+    uint32_t offset = 0u;
+
+    while ((offset + PROT_STORAGE_ENTRY_HDR_SIZE) <= row->payload_len)
+    {
+        uint8_t id = row->payload[offset];
+        uint8_t length = row->payload[offset + 1u];
+
+        if ((id >= PROT_STORAGE_MAX_RECORDS) || (length > PROT_STORAGE_MAX_RECORD_SIZE) ||
+            ((offset + PROT_STORAGE_ENTRY_HDR_SIZE + length) > row->payload_len))
+        {
+            break;
+        }
+
+        record_len[id] = length;
+        (void)memcpy(record_data[id], &row->payload[offset + PROT_STORAGE_ENTRY_HDR_SIZE], length);
+
+        offset += PROT_STORAGE_ENTRY_HDR_SIZE + length;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_rows_needed
+ ********************************************************************************
+ * Summary:
+ *   Returns the number of journal rows needed to store a set of records.
+ *
+ * Parameters:
+ *   records - Array of records
+ *   count   - Number of records
+ *
+ * Return:
+ *   uint32_t - Number of rows
+ *
+ *******************************************************************************/
+static uint32_t prot_storage_rows_needed(const prot_storage_record_t *records, uint32_t count)
+{
+    uint32_t rows = 1u;
+    uint32_t used = 0u;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        uint32_t entry_size = PROT_STORAGE_ENTRY_HDR_SIZE + records[i].length;
+
+        if ((used + entry_size) > PROT_STORAGE_PAYLOAD_SIZE)
+        {
+            rows++;
+            used = 0u;
+        }
+
+        used += entry_size;
+    }
+
+    return rows;
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_write_txn
+ ********************************************************************************
+ * Summary:
+ *   Appends a transaction to the journal. The records are packed into
+ *   consecutive rows and only the last row carries the commit flag, so the
+ *   transaction is ignored by the recovery unless all of its rows were
+ *   written.
+ *
+ * Parameters:
+ *   records - Array of records
+ *   count   - Number of records
+ *   flags   - PROT_STORAGE_FLAG_SNAPSHOT or 0
+ *
+ * Return:
+ *   prot_storage_status_t - PROT_STORAGE_SUCCESS or PROT_STORAGE_ERR_FLASH
+ *
+ *******************************************************************************/
+static prot_storage_status_t prot_storage_write_txn(const prot_storage_record_t *records, uint32_t count, uint8_t flags)
+{
+    uint32_t first_seq = next_seq;
+    uint32_t i = 0u;
+    uint8_t txn_index = 0u;
+
+    do
+    {
+        (void)memset(&row_buf, 0, sizeof(row_buf));
+
+        row_buf.magic = PROT_STORAGE_ROW_MAGIC;
+        row_buf.seq = next_seq;
+        row_buf.txn_index = txn_index;
+
+        while ((i < count) &&
+               ((row_buf.payload_len + PROT_STORAGE_ENTRY_HDR_SIZE + records[i].length) <= PROT_STORAGE_PAYLOAD_SIZE))
+        {
+            row_buf.payload[row_buf.payload_len] = records[i].id;
+            row_buf.payload[row_buf.payload_len + 1u] = records[i].length;
+            if (records[i].length != 0u)
+            {
+                (void)memcpy(&row_buf.payload[row_buf.payload_len + PROT_STORAGE_ENTRY_HDR_SIZE], records[i].data, records[i].length);
+            }
+
+            row_buf.payload_len += PROT_STORAGE_ENTRY_HDR_SIZE + records[i].length;
+            i++;
+        }
+
+        row_buf.flags = (i == count) ? (flags | PROT_STORAGE_FLAG_COMMIT) : flags;
+        row_buf.crc = prot_storage_row_crc(&row_buf);
+
+        if (CY_FLASH_DRV_SUCCESS != Cy_Flash_WriteRow((uint32_t)prot_storage_row_addr(next_seq), (const uint32_t *)&row_buf))
+        {
+            return PROT_STORAGE_ERR_FLASH;
+        }
+
+        next_seq++;
+        txn_index++;
+    } while (i < count);
+
+    if ((flags & PROT_STORAGE_FLAG_SNAPSHOT) != 0u)
+    {
+        base_seq = first_seq;
+    }
+
+    return PROT_STORAGE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_write_snapshot
+ ********************************************************************************
+ * Summary:
+ *   Appends a snapshot of all the records in the RAM copy to the journal.
+ *   Once committed, every row written before the snapshot can be reused.
+ *
+ * Return:
+ *   prot_storage_status_t - PROT_STORAGE_SUCCESS or PROT_STORAGE_ERR_FLASH
+ *
+ *******************************************************************************/
+static prot_storage_status_t prot_storage_write_snapshot(void)
+{
+    prot_storage_record_t records[PROT_STORAGE_MAX_RECORDS];
+    uint32_t count = 0u;
+
+    for (uint8_t id = 0u; id < PROT_STORAGE_MAX_RECORDS; id++)
+    {
+        if (record_len[id] != 0u)
+        {
+            records[count].id = id;
+            records[count].length = record_len[id];
+            records[count].data = record_data[id];
+            count++;
+        }
+    }
+
+    return prot_storage_write_txn(records, count, PROT_STORAGE_FLAG_SNAPSHOT);
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_init
+ ********************************************************************************
+ * Summary:
+ *   Recovers the records from the journal. Must be called once before using
+ *   the other functions. The CRC of each journal row is checked at most
+ *   twice, once to find the head and once to walk the chain, and each
+ *   committed row is replayed once, so the time it takes is bounded by the
+ *   size of the protected storage.
+ *
+ *   1. The newest valid row is the head of the journal.
+ *   2. Walking back from the head, the rows with consecutive sequence numbers
+ *      form the chain of usable history.
+ *   3. The latest committed snapshot in the chain is the base. Transactions
+ *      after the base are replayed when their commit row is found. Rows of
+ *      a transaction interrupted by a reset have no commit row and are
+ *      skipped.
+ *
+ * Return:
+ *   prot_storage_status_t - PROT_STORAGE_SUCCESS, or PROT_STORAGE_ERR_CORRUPT
+ *   if the history before the chain was lost. In that case the records that
+ *   could be recovered are written as a new snapshot.
+ *
+ *******************************************************************************/
+prot_storage_status_t prot_storage_init(void)
+{
+    prot_storage_status_t status = PROT_STORAGE_SUCCESS;
+    uint32_t head_seq = 0u;
+    uint32_t chain_start;
+    uint32_t base = 0u;
+
+    (void)memset(record_len, 0, sizeof(record_len));
+    (void)memset(record_data, 0, sizeof(record_data));
+
+    /* Find the head of the journal */
+    for (uint32_t row = 0u; row < PROT_STORAGE_JOURNAL_ROWS; row++)
+    {
+        const prot_storage_row_t *row_addr = (const prot_storage_row_t *)(PROT_STORAGE_JOURNAL_START + (row * CY_FLASH_SIZEOF_ROW));
+
+        if ((row_addr->seq > head_seq) && (((row_addr->seq - 1u) % PROT_STORAGE_JOURNAL_ROWS) == row) &&
+            prot_storage_row_is_valid(row_addr->seq))
+        {
+            head_seq = row_addr->seq;
+        }
+    }
+
+    if (head_seq == 0u)
+    {
+        /* Empty journal */
+        next_seq = 1u;
+        base_seq = 1u;
+
+        return PROT_STORAGE_SUCCESS;
+    }
+
+    /* Find the oldest row of the chain ending at the head. The chain leaves
+     * room for a snapshot, so that the recovery snapshot below does not
+     * overwrite rows that a reset during its write would need again. Commits
+     * keep the same number of rows free, so a valid base is never cut off.
+     */
+    chain_start = head_seq;
+    while ((chain_start > 1u) &&
+           ((head_seq - chain_start + 1u) < (PROT_STORAGE_JOURNAL_ROWS - PROT_STORAGE_SNAPSHOT_ROWS)) &&
+           prot_storage_row_is_valid(chain_start - 1u))
+    {
+        chain_start--;
+    }
+
+    /* Find the latest committed snapshot in the chain */
+    for (uint32_t seq = head_seq; (seq >= chain_start) && (base == 0u); seq--)
+    {
+        const prot_storage_row_t *row = prot_storage_row_addr(seq);
+        uint8_t snapshot_commit = PROT_STORAGE_FLAG_SNAPSHOT | PROT_STORAGE_FLAG_COMMIT;
+
+        if (((row->flags & snapshot_commit) == snapshot_commit) && ((seq - row->txn_index) >= chain_start))
+        {
+            base = seq - row->txn_index;
+        }
+    }
+
+    if (base == 0u)
+    {
+        /* Without a snapshot the chain must start at the first row ever written */
+        base = chain_start;
+        if (chain_start != 1u)
+        {
+            status = PROT_STORAGE_ERR_CORRUPT;
+        }
+    }
+
+    /* Replay the committed transactions */
+    for (uint32_t seq = base; seq <= head_seq; seq++)
+    {
+        const prot_storage_row_t *row = prot_storage_row_addr(seq);
+
+        if (((row->flags & PROT_STORAGE_FLAG_COMMIT) != 0u) && (row->txn_index <= (seq - base)))
+        {
+            for (uint32_t txn_seq = seq - row->txn_index; txn_seq <= seq; txn_seq++)
+            {
+                prot_storage_apply_row(prot_storage_row_addr(txn_seq));
+            }
+        }
+    }
+
+    next_seq = head_seq + 1u;
+    base_seq = base;
+
+    if (status == PROT_STORAGE_ERR_CORRUPT)
+    {
+        /* Start a new history from what could be recovered */
+        (void)prot_storage_write_snapshot();
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_read
+ ********************************************************************************
+ * Summary:
+ *   Reads a record from the RAM copy of the committed records.
+ *
+ * Parameters:
+ *   id     - Record ID
+ *   data   - Buffer to store the record data
+ *   length - In: size of the buffer. Out: length of the record.
+ *
+ * Return:
+ *   prot_storage_status_t - PROT_STORAGE_SUCCESS, PROT_STORAGE_ERR_PARAM or
+ *   PROT_STORAGE_ERR_NOT_FOUND
+ *
+ *******************************************************************************/
+prot_storage_status_t prot_storage_read(uint8_t id, uint8_t *data, uint8_t *length)
+{
+    if ((id >= PROT_STORAGE_MAX_RECORDS) || (data == NULL) || (length == NULL))
+    {
+        return PROT_STORAGE_ERR_PARAM;
+    }
+
+    if (record_len[id] == 0u)
+    {
+        return PROT_STORAGE_ERR_NOT_FOUND;
+    }
+
+    if (*length < record_len[id])
+    {
+        return PROT_STORAGE_ERR_PARAM;
+    }
+
+    (void)memcpy(data, record_data[id], record_len[id]);
+    *length = record_len[id];
+
+    return PROT_STORAGE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_write
+ ********************************************************************************
+ * Summary:
+ *   Updates a single record. A length of zero deletes the record.
+ *
+ * Parameters:
+ *   id     - Record ID
+ *   data   - Record data
+ *   length - Length of the record data
+ *
+ * Return:
+ *   prot_storage_status_t - See prot_storage_commit()
+ *
+ *******************************************************************************/
+prot_storage_status_t prot_storage_write(uint8_t id, const uint8_t *data, uint8_t length)
+{
+    prot_storage_record_t record = { .id = id, .length = length, .data = data };
+
+    return prot_storage_commit(&record, 1u);
+}
+
+/*******************************************************************************
+ * Function Name: prot_storage_commit
+ ********************************************************************************
+ * Summary:
+ *   Updates one or more records atomically. After a reset either all or none
+ *   of the updates are visible. When the journal runs out of free rows, the
+ *   updates are merged into a new snapshot instead.
+ *
+ * Parameters:
+ *   records - Array of record updates
+ *   count   - Number of updates, 1 to PROT_STORAGE_MAX_RECORDS
+ *
+ * Return:
+ *   prot_storage_status_t - PROT_STORAGE_SUCCESS, PROT_STORAGE_ERR_PARAM or
+ *   PROT_STORAGE_ERR_FLASH
+ *
+ *******************************************************************************/
+prot_storage_status_t prot_storage_commit(const prot_storage_record_t *records, uint32_t count)
+{
+    prot_storage_status_t status;
+    uint32_t free_rows;
+
+    if ((records == NULL) || (count == 0u) || (count > PROT_STORAGE_MAX_RECORDS))
+    {
+        return PROT_STORAGE_ERR_PARAM;
+    }
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        if ((records[i].id >= PROT_STORAGE_MAX_RECORDS) || (records[i].length > PROT_STORAGE_MAX_RECORD_SIZE) ||
+            ((records[i].length != 0u) && (records[i].data == NULL)))
+        {
+            return PROT_STORAGE_ERR_PARAM;
+        }
+    }
+
+    free_rows = PROT_STORAGE_JOURNAL_ROWS - (next_seq - base_seq);
+
+    /* Update the RAM copy first, it is reloaded from flash if the write fails */
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        record_len[records[i].id] = records[i].length;
+        if (records[i].length != 0u)
+        {
+            (void)memcpy(record_data[records[i].id], records[i].data, records[i].length);
+        }
+    }
+
+    if ((prot_storage_rows_needed(records, count) + PROT_STORAGE_SNAPSHOT_ROWS) > free_rows)
+    {
+        status = prot_storage_write_snapshot();
+    }
+    else
+    {
+        status = prot_storage_write_txn(records, count, 0u);
+    }
+
+    if (status != PROT_STORAGE_SUCCESS)
+    {
+        (void)prot_storage_init();
+    }
+
+    return status;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name:   prot_storage.h
+*
+* Description: This file contains definitions of constants, structures and
+*              function prototypes for the journaled protected storage.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef PROT_STORAGE_H
+#define PROT_STORAGE_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of records that can be held in the protected storage */
+#define PROT_STORAGE_MAX_RECORDS        (16u)
+
+/* Maximum size of a single record in bytes */
+#define PROT_STORAGE_MAX_RECORD_SIZE    (28u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef enum
+{
+    PROT_STORAGE_SUCCESS = 0,           /* Operation completed successfully */
+    PROT_STORAGE_ERR_PARAM,             /* Invalid record ID, size or count */
+    PROT_STORAGE_ERR_NOT_FOUND,         /* The requested record is empty */
+    PROT_STORAGE_ERR_FLASH,             /* Flash row write failed */
+    PROT_STORAGE_ERR_CORRUPT            /* Journal history lost, recovered what was left */
+} prot_storage_status_t;
+
+/* Single record update. A length of zero deletes the record. */
+typedef struct
+{
+    uint8_t id;
+    uint8_t length;
+    const uint8_t *data;
+} prot_storage_record_t;
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+prot_storage_status_t prot_storage_init(void);
+prot_storage_status_t prot_storage_read(uint8_t id, uint8_t *data, uint8_t *length);
+prot_storage_status_t prot_storage_write(uint8_t id, const uint8_t *data, uint8_t length);
+prot_storage_status_t prot_storage_commit(const prot_storage_record_t *records, uint32_t count);
+
+#endif /* PROT_STORAGE_H */
+
+/* [] END OF FILE */
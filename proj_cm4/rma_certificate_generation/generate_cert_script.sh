@@ -1,15 +1,7 @@
 #!/bin/bash
 echo "This is a shell script for generating RMA certificate"
-gcc unsigned_cert_generator.c -o unsigned_certificate.o
-#three parameters passed as arguments to unsigned_certificate.o are the device unique ID(12-byte) passed in 4-byte each
-sudo ./unsigned_certificate.o $1 $2 $3
-sleep 1
-echo "unsigned certificate generated..."
-openssl dgst -sha256 -binary -sign ./rsa_private.pem -out ./signed_certificate.bin ./unsigned_certificate.bin
-sleep 1
-echo "Signature Generated..."
-openssl dgst -sha256 -verify "./rsa_public.pem"  -signature "./signed_certificate.bin" "./unsigned_certificate.bin"
-echo "Signature Verified..."
-gcc signed_cert_generator.c -o signed_certificate.o
-sudo ./signed_certificate.o $1 $2 $3
-echo "Signature appended and RMA certificate available in certificate.c file"
\ No newline at end of file
+gcc -O2 rma_cert.c -o rma_cert -lcrypto -lpthread || exit 1
+#three parameters passed as arguments to rma_cert are the device unique ID(12-byte) passed in 4-byte each
+#the certificate is signed with rsa_private.pem and verified with rsa_public.pem
+./rma_cert --key ./rsa_private.pem --pubkey ./rsa_public.pem --out ./certificate.c $1 $2 $3 || exit 1
+echo "RMA certificate available in certificate.c file"
@@ -0,0 +1,986 @@
+/******************************************************************************
+* File Name:   rma_cert.c
+*
+* Description: Generates the RMA certificates (transit_rma_param_t) of one or
+*   more devices from their 12-byte unique IDs. The certificate of a device is
+*   the SROM RMA parameter block: opcode, object size, command ID, unique ID
+*   and the RSASSA-PKCS1-v1_5 SHA-256 signature of the object size, command ID
+*   and unique ID, made with the private key paired with the public key in
+*   SFlash. The signatures are made with libcrypto by one thread per core, and
+*   each one is verified with the public key (--pubkey) before it is written.
+*
+*   The unique IDs are given on the command line for one device, or read from
+*   a CSV file (one "unique_id_0,unique_id_1,unique_id_2" line per device) or
+*   a JSON file (an array of [id0, id1, id2] arrays or of objects with the
+*   keys "unique_id_0", "unique_id_1" and "unique_id_2"). The IDs are numbers,
+*   or strings such as "0x118c84f4".
+*
+*   The certificates are written as:
+*   c     - C source with rmaParam for one device (as before, to be copied to
+*           main.c) or the rmaParams array for several devices
+*   bin   - transit_rma_param_t of each device, 280 bytes each
+*   index - an index for provisioning stations: a 16-byte header ("RMAI",
+*           version, record size, count, all 32-bit little-endian), then one
+*           268-byte record per device (unique ID words, signature), sorted by
+*           unique ID so that a device can be looked up with a binary search.
+*           The opcode, object size and command ID are the same for all the
+*           devices and are not stored.
+*
+*   With --bench N, N certificates are signed with 1, 2, 4... --threads
+*   threads and the certificates per second are printed.
+*
+*   Build:
+*   gcc -O2 -o rma_cert rma_cert.c -lcrypto -lpthread
+*
+*   Example Usage:
+*   rma_cert --key rsa_private.pem --pubkey rsa_public.pem 0x118c84f4 0x01af2c10 0x007a0415
+*   rma_cert --key rsa_private.pem --pubkey rsa_public.pem --input uids.csv --format index --out rma.idx
+*   rma_cert --key rsa_private.pem --bench 2000
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/err.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* transit_rma_param_t constants (see main.c) */
+#define RMA_OPCODE                  (0x28000000u)
+#define RMA_OBJECT_SIZE             (0x14u)
+#define RMA_CMD_ID                  (0x120028F0u)
+#define RMA_SIGNATURE_SIZE          (256u)
+
+/* Signed data: object size, command ID, unique ID */
+#define RMA_SIGNED_SIZE             (RMA_OBJECT_SIZE)
+
+/* transit_rma_param_t: opcode, signed data, signature */
+#define RMA_PARAM_SIZE              (4u + RMA_SIGNED_SIZE + RMA_SIGNATURE_SIZE)
+
+/* Index file */
+#define RMA_INDEX_MAGIC             "RMAI"
+#define RMA_INDEX_VERSION           (1u)
+#define RMA_INDEX_HEADER_SIZE       (16u)
+#define RMA_INDEX_RECORD_SIZE       (12u + RMA_SIGNATURE_SIZE)
+
+/* Largest number of threads */
+#define RMA_THREADS_MAX             (256u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Certificate of one device */
+typedef struct
+{
+    uint32_t unique_id[3];
+    uint8_t signature[RMA_SIGNATURE_SIZE];
+    bool signed_ok;
+} rma_cert_t;
+
+/* Certificates shared by the signing threads */
+typedef struct
+{
+    rma_cert_t *certs;
+    uint32_t count;
+    uint32_t next;                  /* Next certificate to sign */
+    EVP_PKEY *key;
+    EVP_PKEY *pubkey;               /* Key used to verify the signatures, or NULL */
+} rma_batch_t;
+
+/* Output formats */
+typedef enum
+{
+    FORMAT_C,
+    FORMAT_BIN,
+    FORMAT_INDEX
+} rma_format_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const struct option rma_cert_options[] =
+{
+    { "key",     required_argument, NULL, 'k' },
+    { "pubkey",  required_argument, NULL, 'p' },
+    { "input",   required_argument, NULL, 'i' },
+    { "format",  required_argument, NULL, 'f' },
+    { "out",     required_argument, NULL, 'o' },
+    { "threads", required_argument, NULL, 't' },
+    { "bench",   required_argument, NULL, 'b' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: now_s
+ ********************************************************************************
+ * Summary:
+ *   Returns the monotonic time in seconds.
+ *
+ *******************************************************************************/
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/*******************************************************************************
+ * Function Name: put_u32
+ ********************************************************************************
+ * Summary:
+ *   Stores a 32-bit value in little-endian order.
+ *
+ *******************************************************************************/
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/*******************************************************************************
+ * Function Name: parse_uid
+ ********************************************************************************
+ * Summary:
+ *   Parses one 32-bit word of a unique ID: a decimal, or hexadecimal with 0x,
+ *   number.
+ *
+ * Parameters:
+ *   text   - Text of the word
+ *   length - Length of the text
+ *   value  - Parsed word
+ *
+ * Return:
+ *   int - 0 on success, -1 if the text is not a 32-bit number
+ *
+ *******************************************************************************/
+static int parse_uid(const char *text, size_t length, uint32_t *value)
+{
+    char buffer[24];
+    char *end;
+    unsigned long long number;
+
+    if ((length == 0u) || (length >= sizeof(buffer)) || !isxdigit((unsigned char)text[0]))
+    {
+        return -1;
+    }
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    number = strtoull(buffer, &end, 0);
+    if ((*end != '\0') || (number > UINT32_MAX))
+    {
+        return -1;
+    }
+    *value = (uint32_t)number;
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: add_cert
+ ********************************************************************************
+ * Summary:
+ *   Appends a device to the batch.
+ *
+ *******************************************************************************/
+static int add_cert(rma_batch_t *batch, uint32_t *capacity, const uint32_t unique_id[3])
+{
+    if (batch->count == *capacity)
+    {
+        uint32_t grown = (*capacity == 0u) ? 64u : (*capacity * 2u);
+        rma_cert_t *certs = realloc(batch->certs, grown * sizeof(rma_cert_t));
+
+        if (certs == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+        batch->certs = certs;
+        *capacity = grown;
+    }
+
+    memset(&batch->certs[batch->count], 0, sizeof(rma_cert_t));
+    memcpy(batch->certs[batch->count].unique_id, unique_id, sizeof(batch->certs[0].unique_id));
+    batch->count++;
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_csv
+ ********************************************************************************
+ * Summary:
+ *   Reads the unique IDs of a CSV file: three words per line, separated by
+ *   commas or spaces. Empty lines, lines starting with # and a header line
+ *   are skipped.
+ *
+ *******************************************************************************/
+static int read_csv(const char *path, char *text, rma_batch_t *batch, uint32_t *capacity)
+{
+    uint32_t line_nr = 0u;
+
+    for (char *line = strtok(text, "\n"); line != NULL; line = strtok(NULL, "\n"))
+    {
+        uint32_t unique_id[3];
+        uint32_t words = 0u;
+        bool text_field = false;    /* The line starts with a field that is not a number */
+        char *p = line;
+
+        line_nr++;
+        while (isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if ((*p == '\0') || (*p == '#'))
+        {
+            continue;
+        }
+
+        while ((*p != '\0') && (words <= 3u))
+        {
+            size_t length = strcspn(p, ", \t\r");
+
+            if (length != 0u)
+            {
+                if ((words == 3u) || (parse_uid(p, length, &unique_id[words]) != 0))
+                {
+                    text_field = (words == 0u);
+                    words = 4u;
+                    break;
+                }
+                words++;
+            }
+            p += length;
+            p += (*p != '\0') ? 1 : 0;
+        }
+
+        if (words != 3u)
+        {
+            if (text_field && (line_nr == 1u))
+            {
+                continue;   /* Header */
+            }
+            fprintf(stderr, "%s:%u: expected three unique ID words\n", path, line_nr);
+            return -1;
+        }
+        if (add_cert(batch, capacity, unique_id) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: json_skip
+ ********************************************************************************
+ * Summary:
+ *   Skips white space.
+ *
+ *******************************************************************************/
+static const char *json_skip(const char *p)
+{
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+/*******************************************************************************
+ * Function Name: json_token
+ ********************************************************************************
+ * Summary:
+ *   Reads a string or number token.
+ *
+ * Parameters:
+ *   p      - Start of the token
+ *   text   - Start of the token text, without the quotes
+ *   length - Length of the token text
+ *
+ * Return:
+ *   const char* - End of the token, or NULL if it is not a string or number
+ *
+ *******************************************************************************/
+static const char *json_token(const char *p, const char **text, size_t *length)
+{
+    if (*p == '"')
+    {
+        const char *end = strchr(p + 1, '"');
+
+        if (end == NULL)
+        {
+            return NULL;
+        }
+        *text = p + 1;
+        *length = (size_t)(end - (p + 1));
+        return end + 1;
+    }
+
+    *text = p;
+    *length = strspn(p, "0123456789abcdefABCDEFxX+-.");
+    return (*length != 0u) ? (p + *length) : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: read_json
+ ********************************************************************************
+ * Summary:
+ *   Reads the unique IDs of a JSON file: an array of [id0, id1, id2] arrays
+ *   or of objects with the keys unique_id_0, unique_id_1 and unique_id_2.
+ *   Other keys of the objects are ignored if their values are strings or
+ *   numbers.
+ *
+ *******************************************************************************/
+static int read_json(const char *path, const char *text, rma_batch_t *batch, uint32_t *capacity)
+{
+    const char *p = json_skip(text);
+
+    if (*p++ != '[')
+    {
+        fprintf(stderr, "%s: expected an array\n", path);
+        return -1;
+    }
+
+    for (p = json_skip(p); *p != ']'; )
+    {
+        uint32_t unique_id[3];
+        uint32_t found = 0u;
+        const char *value;
+        size_t length;
+        char close = (*p == '[') ? ']' : '}';
+
+        if ((*p != '[') && (*p != '{'))
+        {
+            fprintf(stderr, "%s:%ld: expected an array or object\n", path, (long)(p - text));
+            return -1;
+        }
+
+        for (p = json_skip(p + 1); (p != NULL) && (*p != close); )
+        {
+            int word = (int)found;
+
+            if (close == '}')
+            {
+                const char *key;
+                size_t key_length;
+
+                p = json_token(p, &key, &key_length);
+                p = (p != NULL) ? json_skip(p) : NULL;
+                if ((p == NULL) || (*p != ':'))
+                {
+                    p = NULL;
+                    break;
+                }
+                p = json_skip(p + 1);
+                word = ((key_length == 11u) && (strncmp(key, "unique_id_", 10u) == 0) &&
+                        (key[10] >= '0') && (key[10] <= '2')) ? (key[10] - '0') : -1;
+            }
+
+            p = json_token(p, &value, &length);
+            if ((p == NULL) || ((word >= 0) && ((word > 2) || (parse_uid(value, length, &unique_id[word]) != 0))))
+            {
+                p = NULL;
+                break;
+            }
+            if (word >= 0)
+            {
+                found |= (close == '}') ? (1u << word) : 0u;
+                found += (close == ']') ? 1u : 0u;
+            }
+
+            p = json_skip(p);
+            if (*p == ',')
+            {
+                p = json_skip(p + 1);
+            }
+        }
+
+        if ((p == NULL) || (found != ((close == ']') ? 3u : 7u)))
+        {
+            fprintf(stderr, "%s: device %u: expected three unique ID words\n", path, batch->count);
+            return -1;
+        }
+        if (add_cert(batch, capacity, unique_id) != 0)
+        {
+            return -1;
+        }
+
+        p = json_skip(p + 1);
+        if (*p == ',')
+        {
+            p = json_skip(p + 1);
+        }
+        else if (*p != ']')
+        {
+            fprintf(stderr, "%s:%ld: expected , or ]\n", path, (long)(p - text));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_input
+ ********************************************************************************
+ * Summary:
+ *   Reads the unique IDs of a CSV or JSON file. A file starting with [ is
+ *   read as JSON.
+ *
+ *******************************************************************************/
+static int read_input(const char *path, rma_batch_t *batch)
+{
+    FILE *fp = fopen(path, "rb");
+    uint32_t capacity = 0u;
+    char *text;
+    long size;
+    int rc;
+
+    if (fp == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    text = malloc((size_t)size + 1u);
+    if ((text == NULL) || (fread(text, 1u, (size_t)size, fp) != (size_t)size))
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(fp);
+        free(text);
+        return -1;
+    }
+    text[size] = '\0';
+    fclose(fp);
+
+    rc = (*json_skip(text) == '[') ? read_json(path, text, batch, &capacity) : read_csv(path, text, batch, &capacity);
+    free(text);
+
+    if ((rc == 0) && (batch->count == 0u))
+    {
+        fprintf(stderr, "%s: no devices\n", path);
+        rc = -1;
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: sign_worker
+ ********************************************************************************
+ * Summary:
+ *   Signing thread: takes the next certificate of the batch until all are
+ *   signed, and verifies each signature.
+ *
+ *******************************************************************************/
+static void *sign_worker(void *arg)
+{
+    rma_batch_t *batch = arg;
+    EVP_MD_CTX *md = EVP_MD_CTX_new();
+    uint8_t data[RMA_SIGNED_SIZE];
+
+    put_u32(&data[0], RMA_OBJECT_SIZE);
+    put_u32(&data[4], RMA_CMD_ID);
+
+    for (;;)
+    {
+        uint32_t i = __atomic_fetch_add(&batch->next, 1u, __ATOMIC_RELAXED);
+        rma_cert_t *cert;
+        size_t length = RMA_SIGNATURE_SIZE;
+
+        if ((md == NULL) || (i >= batch->count))
+        {
+            break;
+        }
+        cert = &batch->certs[i];
+        put_u32(&data[8], cert->unique_id[0]);
+        put_u32(&data[12], cert->unique_id[1]);
+        put_u32(&data[16], cert->unique_id[2]);
+
+        cert->signed_ok = (EVP_DigestSignInit(md, NULL, EVP_sha256(), NULL, batch->key) == 1) &&
+                          (EVP_DigestSign(md, cert->signature, &length, data, sizeof(data)) == 1) &&
+                          (length == RMA_SIGNATURE_SIZE);
+        (void)EVP_MD_CTX_reset(md);
+
+        if (cert->signed_ok && (batch->pubkey != NULL))
+        {
+            cert->signed_ok = (EVP_DigestVerifyInit(md, NULL, EVP_sha256(), NULL, batch->pubkey) == 1) &&
+                              (EVP_DigestVerify(md, cert->signature, RMA_SIGNATURE_SIZE, data, sizeof(data)) == 1);
+            (void)EVP_MD_CTX_reset(md);
+        }
+    }
+
+    EVP_MD_CTX_free(md);
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: sign_batch
+ ********************************************************************************
+ * Summary:
+ *   Signs all the certificates of the batch with the given number of
+ *   threads.
+ *
+ * Return:
+ *   uint32_t - Number of certificates that could not be signed or verified
+ *
+ *******************************************************************************/
+static uint32_t sign_batch(rma_batch_t *batch, uint32_t threads)
+{
+    pthread_t tids[RMA_THREADS_MAX];
+    uint32_t started = 0u;
+    uint32_t failed = 0u;
+
+    batch->next = 0u;
+    threads = (threads < batch->count) ? threads : batch->count;
+
+    for (uint32_t i = 1u; i < threads; i++)
+    {
+        if (pthread_create(&tids[started], NULL, sign_worker, batch) == 0)
+        {
+            started++;
+        }
+    }
+    (void)sign_worker(batch);
+    for (uint32_t i = 0u; i < started; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+
+    for (uint32_t i = 0u; i < batch->count; i++)
+    {
+        if (!batch->certs[i].signed_ok)
+        {
+            fprintf(stderr, "Signing failed for 0x%08x 0x%08x 0x%08x\n", batch->certs[i].unique_id[0],
+                    batch->certs[i].unique_id[1], batch->certs[i].unique_id[2]);
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+/*******************************************************************************
+ * Function Name: write_c_cert
+ ********************************************************************************
+ * Summary:
+ *   Writes the initializer of one transit_rma_param_t.
+ *
+ *******************************************************************************/
+static void write_c_cert(FILE *fp, const rma_cert_t *cert, const char *indent)
+{
+    fprintf(fp, "%s{\n"
+            "%s    .opcode = 0x%08X,\n"
+            "%s    .obj_size = 0x%08X,\n"
+            "%s    .cmd_id = 0x%08X,\n"
+            "%s    .unique_id_0 = 0x%08x,\n"
+            "%s    .unique_id_1 = 0x%08x,\n"
+            "%s    .unique_id_2 = 0x%08x,\n"
+            "%s    .signature = {",
+            indent, indent, RMA_OPCODE, indent, RMA_OBJECT_SIZE, indent, RMA_CMD_ID,
+            indent, cert->unique_id[0], indent, cert->unique_id[1], indent, cert->unique_id[2], indent);
+
+    for (uint32_t i = 0u; i < RMA_SIGNATURE_SIZE; i++)
+    {
+        fprintf(fp, "%s0x%02x", (i == 0u) ? "" : (((i % 16u) == 0u) ? ",\n" : ", "), cert->signature[i]);
+    }
+    fprintf(fp, "}\n%s}", indent);
+}
+
+/*******************************************************************************
+ * Function Name: write_c
+ ********************************************************************************
+ * Summary:
+ *   Writes the certificates as C source: rmaParam for one device, as
+ *   generate_cert_script.sh always did, or the rmaParams array.
+ *
+ *******************************************************************************/
+static void write_c(FILE *fp, const rma_batch_t *batch)
+{
+    fprintf(fp, "\n"
+            "typedef struct {\n"
+            "    uint32_t opcode;\n"
+            "    uint32_t obj_size;\n"
+            "    uint32_t cmd_id;\n"
+            "    uint32_t unique_id_0;\n"
+            "    uint32_t unique_id_1;\n"
+            "    uint32_t unique_id_2;\n"
+            "    uint8_t signature[256];\n"
+            "} transit_rma_param_t;\n"
+            "\n");
+
+    if (batch->count == 1u)
+    {
+        fprintf(fp, "/* RMA Certificate to be sent to the device */ \n"
+                "transit_rma_param_t rmaParam = \n");
+        write_c_cert(fp, &batch->certs[0], "");
+        fprintf(fp, ";\n");
+        return;
+    }
+
+    fprintf(fp, "/* RMA Certificates of %u devices */\n"
+            "transit_rma_param_t rmaParams[%u] = \n{\n", batch->count, batch->count);
+    for (uint32_t i = 0u; i < batch->count; i++)
+    {
+        write_c_cert(fp, &batch->certs[i], "    ");
+        fprintf(fp, "%s\n", (i + 1u < batch->count) ? "," : "");
+    }
+    fprintf(fp, "};\n");
+}
+
+/*******************************************************************************
+ * Function Name: compare_uid
+ ********************************************************************************
+ * Summary:
+ *   qsort comparison of two certificates by unique ID.
+ *
+ *******************************************************************************/
+static int compare_uid(const void *a, const void *b)
+{
+    const rma_cert_t *x = a;
+    const rma_cert_t *y = b;
+
+    for (uint32_t i = 0u; i < 3u; i++)
+    {
+        if (x->unique_id[i] != y->unique_id[i])
+        {
+            return (x->unique_id[i] < y->unique_id[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: write_binary
+ ********************************************************************************
+ * Summary:
+ *   Writes the certificates as transit_rma_param_t records, or as the index
+ *   file.
+ *
+ *******************************************************************************/
+static int write_binary(FILE *fp, rma_batch_t *batch, rma_format_t format)
+{
+    uint8_t record[RMA_PARAM_SIZE];
+    uint8_t *p;
+
+    if (format == FORMAT_INDEX)
+    {
+        qsort(batch->certs, batch->count, sizeof(rma_cert_t), compare_uid);
+        memcpy(&record[0], RMA_INDEX_MAGIC, 4u);
+        put_u32(&record[4], RMA_INDEX_VERSION);
+        put_u32(&record[8], RMA_INDEX_RECORD_SIZE);
+        put_u32(&record[12], batch->count);
+        if (fwrite(record, 1u, RMA_INDEX_HEADER_SIZE, fp) != RMA_INDEX_HEADER_SIZE)
+        {
+            return -1;
+        }
+    }
+
+    for (uint32_t i = 0u; i < batch->count; i++)
+    {
+        const rma_cert_t *cert = &batch->certs[i];
+
+        p = record;
+        if (format == FORMAT_BIN)
+        {
+            put_u32(&p[0], RMA_OPCODE);
+            put_u32(&p[4], RMA_OBJECT_SIZE);
+            put_u32(&p[8], RMA_CMD_ID);
+            p += 12;
+        }
+        put_u32(&p[0], cert->unique_id[0]);
+        put_u32(&p[4], cert->unique_id[1]);
+        put_u32(&p[8], cert->unique_id[2]);
+        memcpy(&p[12], cert->signature, RMA_SIGNATURE_SIZE);
+        p += 12u + RMA_SIGNATURE_SIZE;
+
+        if (fwrite(record, 1u, (size_t)(p - record), fp) != (size_t)(p - record))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_key
+ ********************************************************************************
+ * Summary:
+ *   Reads an RSA-2048 private or public key in PEM format.
+ *
+ *******************************************************************************/
+static EVP_PKEY *read_key(const char *path, bool private_key)
+{
+    FILE *fp = fopen(path, "r");
+    EVP_PKEY *key;
+
+    if (fp == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    key = private_key ? PEM_read_PrivateKey(fp, NULL, NULL, NULL) : PEM_read_PUBKEY(fp, NULL, NULL, NULL);
+    fclose(fp);
+
+    if (key == NULL)
+    {
+        fprintf(stderr, "%s: not a PEM %s key\n", path, private_key ? "private" : "public");
+        ERR_print_errors_fp(stderr);
+        return NULL;
+    }
+    if ((EVP_PKEY_base_id(key) != EVP_PKEY_RSA) || (EVP_PKEY_size(key) != (int)RMA_SIGNATURE_SIZE))
+    {
+        fprintf(stderr, "%s: not an RSA-2048 key\n", path);
+        EVP_PKEY_free(key);
+        return NULL;
+    }
+
+    return key;
+}
+
+/*******************************************************************************
+ * Function Name: run_bench
+ ********************************************************************************
+ * Summary:
+ *   Signs count certificates of generated unique IDs with 1, 2, 4... threads
+ *   and prints the certificates per second.
+ *
+ *******************************************************************************/
+static int run_bench(rma_batch_t *batch, uint32_t count, uint32_t threads)
+{
+    uint32_t capacity = 0u;
+    double base = 0.0;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        uint32_t unique_id[3] = { 0x118c0000u + i, 0x01af2c10u ^ (i * 2654435761u), 0x007a0415u };
+
+        if (add_cert(batch, &capacity, unique_id) != 0)
+        {
+            return 2;
+        }
+    }
+
+    printf("%8s %10s %12s %8s\n", "Threads", "Time s", "Certs/s", "Speedup");
+    for (uint32_t n = 1u; ; n = ((n * 2u) < threads) ? (n * 2u) : threads)
+    {
+        double start = now_s();
+        double seconds;
+
+        if (sign_batch(batch, n) != 0u)
+        {
+            return 1;
+        }
+        seconds = now_s() - start;
+        base = (n == 1u) ? seconds : base;
+        printf("%8u %10.3f %12.1f %8.2f\n", n, seconds, count / seconds, base / seconds);
+
+        if (n == threads)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Reads the keys and the unique IDs, signs the certificates and writes
+ *   them.
+ *
+ * Return:
+ *   int - 0 on success, 1 if a certificate could not be signed or verified,
+ *         2 on a usage, key, input or output error
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *key_path = NULL;
+    const char *pubkey_path = NULL;
+    const char *input_path = NULL;
+    const char *out_path = NULL;
+    rma_format_t format = FORMAT_C;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = (cpus > 0) ? (uint32_t)cpus : 1u;
+    uint32_t bench = 0u;
+    rma_batch_t batch = { 0 };
+    uint32_t capacity = 0u;
+    bool usage = false;
+    FILE *fp;
+    int opt;
+    int rc;
+
+    while ((opt = getopt_long(argc, argv, "", rma_cert_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'k': key_path = optarg; break;
+            case 'p': pubkey_path = optarg; break;
+            case 'i': input_path = optarg; break;
+            case 'o': out_path = optarg; break;
+            case 't': threads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': bench = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'f':
+                if (strcmp(optarg, "c") == 0)
+                {
+                    format = FORMAT_C;
+                }
+                else if (strcmp(optarg, "bin") == 0)
+                {
+                    format = FORMAT_BIN;
+                }
+                else if (strcmp(optarg, "index") == 0)
+                {
+                    format = FORMAT_INDEX;
+                }
+                else
+                {
+                    usage = true;
+                }
+                break;
+            default: usage = true; break;
+        }
+    }
+
+    threads = (threads > RMA_THREADS_MAX) ? RMA_THREADS_MAX : threads;
+    if (usage || (key_path == NULL) || (threads == 0u) ||
+        ((bench == 0u) && ((input_path != NULL) ? (optind != argc) : ((argc - optind) != 3))))
+    {
+        fprintf(stderr, "Usage: %s --key private.pem [--pubkey public.pem] [--threads N]\n"
+                "       [--format c|bin|index] [--out file] (--input uids.csv|uids.json | UID0 UID1 UID2)\n"
+                "       %s --key private.pem [--pubkey public.pem] [--threads N] --bench N\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+
+    batch.key = read_key(key_path, true);
+    batch.pubkey = (pubkey_path != NULL) ? read_key(pubkey_path, false) : NULL;
+    if ((batch.key == NULL) || ((pubkey_path != NULL) && (batch.pubkey == NULL)))
+    {
+        EVP_PKEY_free(batch.key);
+        return 2;
+    }
+
+    if (bench != 0u)
+    {
+        rc = run_bench(&batch, bench, threads);
+    }
+    else
+    {
+        rc = 0;
+        if (input_path != NULL)
+        {
+            rc = (read_input(input_path, &batch) == 0) ? 0 : 2;
+        }
+        else
+        {
+            uint32_t unique_id[3];
+
+            for (uint32_t i = 0u; (rc == 0) && (i < 3u); i++)
+            {
+                if (parse_uid(argv[optind + i], strlen(argv[optind + i]), &unique_id[i]) != 0)
+                {
+                    fprintf(stderr, "%s: not a 32-bit unique ID word\n", argv[optind + i]);
+                    rc = 2;
+                }
+            }
+            rc = (rc == 0) ? ((add_cert(&batch, &capacity, unique_id) == 0) ? 0 : 2) : rc;
+        }
+
+        rc = ((rc == 0) && (sign_batch(&batch, threads) != 0u)) ? 1 : rc;
+
+        if (rc == 0)
+        {
+            fp = (out_path != NULL) ? fopen(out_path, (format == FORMAT_C) ? "w" : "wb") : stdout;
+            if (fp == NULL)
+            {
+                perror(out_path);
+                rc = 2;
+            }
+            else
+            {
+                if (format == FORMAT_C)
+                {
+                    write_c(fp, &batch);
+                }
+                else
+                {
+                    rc = (write_binary(fp, &batch, format) == 0) ? 0 : 2;
+                }
+                rc = ((fp != stdout) && (fclose(fp) != 0)) ? 2 : rc;
+            }
+        }
+
+        if ((rc == 0) && (out_path != NULL))
+        {
+            printf("%u RMA certificate%s %s in %s\n", batch.count, (batch.count == 1u) ? "" : "s",
+                   (batch.pubkey != NULL) ? "signed and verified" : "signed", out_path);
+        }
+    }
+
+    free(batch.certs);
+    EVP_PKEY_free(batch.key);
+    EVP_PKEY_free(batch.pubkey);
+
+    return rc;
+}
+
+/* [] END OF FILE */
@@ -87,7 +87,18 @@ extern uint32_t SystemCoreClock;
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
+/* The run time counter is a TCPWM counter when RTOS_STATS is set by the
+ * Makefile, see rtos_stats.c.
+ */
+#if defined(RTOS_STATS)
+extern void rtos_stats_timer_init(void);
+extern uint32_t rtos_stats_timer_read(void);
+#define configGENERATE_RUN_TIME_STATS           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() rtos_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        rtos_stats_timer_read()
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
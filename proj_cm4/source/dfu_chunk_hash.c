@@ -0,0 +1,529 @@
+/******************************************************************************
+* File Name:   dfu_chunk_hash.c
+*
+* Description: This file checks each chunk of an image as soon as its last
+*              row is written, so that a corrupted transfer is detected at
+*              the chunk instead of after the whole image. The hashes of the
+*              chunks are sent ahead of the image as rows at
+*              DFU_CHUNK_HASH_ADDR. They are the leaves of a Merkle tree,
+*              whose root is signed into the image as a protected TLV and is
+*              checked when the image is validated.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <string.h>
+#include "cy_pdl.h"
+#include "dfu_chunk_hash.h"
+#include "dfu_flash.h"
+
+#if defined(DFU_CHUNK_HASH)
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define CHUNK_HASH_META_SIZE            (sizeof(dfu_chunk_hash_meta_t) + (DFU_CHUNK_HASH_MAX_CHUNKS * DFU_CHUNK_HASH_SIZE))
+#define CHUNK_HASH_META_ROWS            ((CHUNK_HASH_META_SIZE + CY_FLASH_SIZEOF_ROW - 1u) / CY_FLASH_SIZEOF_ROW)
+
+/* Subtrees pending while the root is calculated: one per bit of the chunk
+ * count, plus the chunk being added.
+ */
+#define CHUNK_HASH_STACK_DEPTH          (11u)
+
+/* Domain separation of the leaf and node hashes, as in RFC 6962 */
+#define CHUNK_HASH_LEAF_PREFIX          (0x00u)
+#define CHUNK_HASH_NODE_PREFIX          (0x01u)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Chunk hashes as received, the header followed by the hashes */
+CY_ALIGN(4) static uint8_t chunk_meta[CHUNK_HASH_META_ROWS * CY_FLASH_SIZEOF_ROW];
+
+/* Next row of the chunk hashes expected from the host */
+static uint32_t chunk_meta_next_row = 0u;
+
+/* Set once all the chunk hashes are received and match their root */
+static bool chunk_meta_valid = false;
+
+/* First chunk not checked yet. The last rows of a chunk may be left out of a
+ * sparse CYACD2 file, then the chunk is checked when a later row is written.
+ */
+static uint32_t chunk_next_check = 0u;
+
+/* Address of the last chunk that did not match its hash, not reported yet */
+static uint32_t chunk_bad_addr = 0u;
+static bool chunk_bad = false;
+
+/*******************************************************************************
+ * Function Name: chunk_hash_count
+ *******************************************************************************
+ * Summary:
+ *  Returns the number of chunks of the image described by the header.
+ *
+ * Parameters:
+ *  meta - Header of the chunk hashes
+ *
+ * Return:
+ *  uint32_t - Number of chunks
+ *
+ *******************************************************************************/
+static uint32_t chunk_hash_count(const dfu_chunk_hash_meta_t *meta)
+{
+    return (meta->payload_size + meta->chunk_size - 1u) / meta->chunk_size;
+}
+
+/*******************************************************************************
+ * Function Name: chunk_hash_leaf
+ *******************************************************************************
+ * Summary:
+ *  Calculates the leaf hash of a chunk written to the flash,
+ *  SHA256(0x00 | chunk).
+ *
+ * Parameters:
+ *  address - Address of the chunk
+ *  size    - Size of the chunk
+ *  digest  - Returns the hash
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the hash was calculated
+ *
+ *******************************************************************************/
+static cy_en_dfu_status_t chunk_hash_leaf(uint32_t address, uint32_t size, uint8_t *digest)
+{
+    static const uint8_t prefix = CHUNK_HASH_LEAF_PREFIX;
+    cy_stc_crypto_sha_state_t hash_state = { 0 };
+
+    /* Row of the chunk being hashed */
+    CY_ALIGN(4) static uint8_t chunk_row[CY_FLASH_SIZEOF_ROW];
+
+#if defined(CY_CRYPTO_CFG_HW_V2_ENABLE)
+    cy_stc_crypto_v2_sha256_buffers_t sha_256_buffers = {0};
+#else
+    cy_stc_crypto_v1_sha256_buffers_t sha_256_buffers = {0};
+#endif
+
+    cy_en_crypto_status_t crypto_status = Cy_Crypto_Core_Enable(CRYPTO);
+
+    if (CY_CRYPTO_SUCCESS == crypto_status)
+    {
+        crypto_status = Cy_Crypto_Core_Sha_Init(CRYPTO, &hash_state, CY_CRYPTO_MODE_SHA256, &sha_256_buffers);
+    }
+
+    if (CY_CRYPTO_SUCCESS == crypto_status)
+    {
+        crypto_status = Cy_Crypto_Core_Sha_Start(CRYPTO, &hash_state);
+    }
+
+    if (CY_CRYPTO_SUCCESS == crypto_status)
+    {
+        crypto_status = Cy_Crypto_Core_Sha_Update(CRYPTO, &hash_state, &prefix, sizeof(prefix));
+    }
+
+    while ((size != 0u) && (CY_CRYPTO_SUCCESS == crypto_status))
+    {
+        uint32_t row_size = (size >= CY_FLASH_SIZEOF_ROW) ? CY_FLASH_SIZEOF_ROW : size;
+
+        if (dfu_flash_read(address, chunk_row, row_size) != CY_DFU_SUCCESS)
+        {
+            crypto_status = CY_CRYPTO_HW_ERROR;
+            break;
+        }
+
+        crypto_status = Cy_Crypto_Core_Sha_Update(CRYPTO, &hash_state, chunk_row, row_size);
+
+        address += row_size;
+        size -= row_size;
+    }
+
+    if (CY_CRYPTO_SUCCESS == crypto_status)
+    {
+        crypto_status = Cy_Crypto_Core_Sha_Finish(CRYPTO, &hash_state, digest);
+    }
+
+    (void)Cy_Crypto_Core_Sha_Free(CRYPTO, &hash_state);
+
+    return (CY_CRYPTO_SUCCESS == crypto_status) ? CY_DFU_SUCCESS : CY_DFU_ERROR_DATA;
+}
+
+/*******************************************************************************
+ * Function Name: chunk_hash_node
+ *******************************************************************************
+ * Summary:
+ *  Calculates the hash of a tree node, SHA256(0x01 | left | right).
+ *
+ * Parameters:
+ *  digest - Returns the hash, may be the same buffer as left or right
+ *  left   - Hash of the left subtree
+ *  right  - Hash of the right subtree
+ *
+ * Return:
+ *  cy_en_crypto_status_t - CY_CRYPTO_SUCCESS if the hash was calculated
+ *
+ *******************************************************************************/
+static cy_en_crypto_status_t chunk_hash_node(uint8_t *digest, const uint8_t *left, const uint8_t *right)
+{
+    CY_ALIGN(4) uint8_t node[1u + (2u * DFU_CHUNK_HASH_SIZE)];
+
+    node[0] = CHUNK_HASH_NODE_PREFIX;
+    (void)memcpy(&node[1], left, DFU_CHUNK_HASH_SIZE);
+    (void)memcpy(&node[1u + DFU_CHUNK_HASH_SIZE], right, DFU_CHUNK_HASH_SIZE);
+
+    return Cy_Crypto_Core_Sha(CRYPTO, node, sizeof(node), digest, CY_CRYPTO_MODE_SHA256);
+}
+
+/*******************************************************************************
+ * Function Name: chunk_hash_root
+ *******************************************************************************
+ * Summary:
+ *  Calculates the Merkle root of the chunk hashes. The tree has the shape of
+ *  RFC 6962: the left subtree holds the largest power of two leaves smaller
+ *  than the leaf count. The leaves are added one by one, and two subtrees of
+ *  the same size are merged as soon as they are complete.
+ *
+ * Parameters:
+ *  leaves - Chunk hashes
+ *  count  - Number of chunk hashes, 1 to DFU_CHUNK_HASH_MAX_CHUNKS
+ *  root   - Returns the root
+ *
+ * Return:
+ *  cy_en_crypto_status_t - CY_CRYPTO_SUCCESS if the root was calculated
+ *
+ *******************************************************************************/
+static cy_en_crypto_status_t chunk_hash_root(const uint8_t *leaves, uint32_t count, uint8_t *root)
+{
+    CY_ALIGN(4) static uint8_t stack[CHUNK_HASH_STACK_DEPTH][DFU_CHUNK_HASH_SIZE];
+    uint32_t leaf_count[CHUNK_HASH_STACK_DEPTH];
+    uint32_t depth = 0u;
+    cy_en_crypto_status_t crypto_status = Cy_Crypto_Core_Enable(CRYPTO);
+
+    for (uint32_t i = 0u; (i < count) && (CY_CRYPTO_SUCCESS == crypto_status); i++)
+    {
+        (void)memcpy(stack[depth], &leaves[i * DFU_CHUNK_HASH_SIZE], DFU_CHUNK_HASH_SIZE);
+        leaf_count[depth] = 1u;
+        depth++;
+
+        while ((depth >= 2u) && (leaf_count[depth - 1u] == leaf_count[depth - 2u]) &&
+               (CY_CRYPTO_SUCCESS == crypto_status))
+        {
+            crypto_status = chunk_hash_node(stack[depth - 2u], stack[depth - 2u], stack[depth - 1u]);
+            leaf_count[depth - 2u] *= 2u;
+            depth--;
+        }
+    }
+
+    /* Merge the remaining subtrees from the right */
+    while ((depth >= 2u) && (CY_CRYPTO_SUCCESS == crypto_status))
+    {
+        crypto_status = chunk_hash_node(stack[depth - 2u], stack[depth - 2u], stack[depth - 1u]);
+        leaf_count[depth - 2u] += leaf_count[depth - 1u];
+        depth--;
+    }
+
+    (void)memcpy(root, stack[0], DFU_CHUNK_HASH_SIZE);
+
+    return crypto_status;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_is_meta
+ *******************************************************************************
+ * Summary:
+ *  Tells if a row address is one of the chunk hash rows.
+ *
+ * Parameters:
+ *  address - Row address
+ *
+ * Return:
+ *  bool - true for a chunk hash row
+ *
+ *******************************************************************************/
+bool dfu_chunk_hash_is_meta(uint32_t address)
+{
+    return (address >= DFU_CHUNK_HASH_ADDR) && ((address - DFU_CHUNK_HASH_ADDR) < sizeof(chunk_meta));
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_write_meta
+ *******************************************************************************
+ * Summary:
+ *  Stores a row of the chunk hashes. The rows must be sent in order; the
+ *  first row starts a new list. Once the last row is received, the root of
+ *  the chunk hashes must match the root in the header.
+ *
+ * Parameters:
+ *  address - Row address
+ *  row     - Row data
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the row was accepted, else
+ *                       CY_DFU_ERROR_DATA
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_chunk_hash_write_meta(uint32_t address, const uint8_t *row)
+{
+    const dfu_chunk_hash_meta_t *meta = (const dfu_chunk_hash_meta_t *)chunk_meta;
+    uint32_t row_num = (address - DFU_CHUNK_HASH_ADDR) / CY_FLASH_SIZEOF_ROW;
+    CY_ALIGN(4) uint8_t root[DFU_CHUNK_HASH_SIZE];
+
+    if (row_num == 0u)
+    {
+        chunk_meta_valid = false;
+        chunk_meta_next_row = 0u;
+    }
+
+    if ((row_num != chunk_meta_next_row) || (chunk_meta_valid))
+    {
+        return CY_DFU_ERROR_DATA;
+    }
+
+    (void)memcpy(&chunk_meta[row_num * CY_FLASH_SIZEOF_ROW], row, CY_FLASH_SIZEOF_ROW);
+    chunk_meta_next_row++;
+
+    if ((meta->magic != DFU_CHUNK_HASH_MAGIC) || (meta->payload_size == 0u) ||
+        (meta->chunk_size == 0u) || ((meta->chunk_size % CY_FLASH_SIZEOF_ROW) != 0u) ||
+        ((meta->payload_addr % CY_FLASH_SIZEOF_ROW) != 0u) ||
+        (chunk_hash_count(meta) > DFU_CHUNK_HASH_MAX_CHUNKS))
+    {
+        chunk_meta_next_row = 0u;
+        return CY_DFU_ERROR_DATA;
+    }
+
+    if ((chunk_meta_next_row * CY_FLASH_SIZEOF_ROW) >=
+        (sizeof(dfu_chunk_hash_meta_t) + (chunk_hash_count(meta) * DFU_CHUNK_HASH_SIZE)))
+    {
+        if ((chunk_hash_root(&chunk_meta[sizeof(dfu_chunk_hash_meta_t)], chunk_hash_count(meta), root) != CY_CRYPTO_SUCCESS) ||
+            (memcmp(root, meta->root, DFU_CHUNK_HASH_SIZE) != 0))
+        {
+            chunk_meta_next_row = 0u;
+            return CY_DFU_ERROR_DATA;
+        }
+
+        chunk_meta_valid = true;
+        chunk_next_check = 0u;
+    }
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: chunk_hash_check_chunk
+ *******************************************************************************
+ * Summary:
+ *  Reads a chunk back from the flash and compares its hash with the received
+ *  one. A chunk that does not match is kept for dfu_chunk_hash_bad_chunk(),
+ *  and is checked again by the next row written after it.
+ *
+ * Parameters:
+ *  meta      - Header of the chunk hashes
+ *  chunk_num - Index of the chunk
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS, or CY_DFU_ERROR_DATA if the chunk
+ *                       does not match its hash
+ *
+ *******************************************************************************/
+static cy_en_dfu_status_t chunk_hash_check_chunk(const dfu_chunk_hash_meta_t *meta, uint32_t chunk_num)
+{
+    CY_ALIGN(4) uint8_t digest[DFU_CHUNK_HASH_SIZE];
+    uint32_t chunk_start = chunk_num * meta->chunk_size;
+    uint32_t chunk_end = chunk_start + meta->chunk_size;
+
+    if (chunk_end > meta->payload_size)
+    {
+        chunk_end = meta->payload_size;
+    }
+
+    if ((chunk_hash_leaf(meta->payload_addr + chunk_start, chunk_end - chunk_start, digest) != CY_DFU_SUCCESS) ||
+        (memcmp(digest, &chunk_meta[sizeof(dfu_chunk_hash_meta_t) + (chunk_num * DFU_CHUNK_HASH_SIZE)],
+                DFU_CHUNK_HASH_SIZE) != 0))
+    {
+        chunk_bad_addr = meta->payload_addr + chunk_start;
+        chunk_bad = true;
+        chunk_next_check = chunk_num;
+        return CY_DFU_ERROR_DATA;
+    }
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_check_row
+ *******************************************************************************
+ * Summary:
+ *  Checks the chunk that a written row completes against its hash, and the
+ *  earlier chunks not checked yet because their last rows were left out of
+ *  a sparse transfer. The chunks are read back from the flash, so that the
+ *  check also covers the write. Rows of an image without chunk hashes, and
+ *  rows that do not complete a chunk, are accepted.
+ *
+ * Parameters:
+ *  address - Address of the written row
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS, or CY_DFU_ERROR_DATA if a chunk
+ *                       does not match its hash and must be sent again, see
+ *                       dfu_chunk_hash_bad_chunk()
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_chunk_hash_check_row(uint32_t address)
+{
+    const dfu_chunk_hash_meta_t *meta = (const dfu_chunk_hash_meta_t *)chunk_meta;
+    uint32_t row_end, chunk_num, chunk_end;
+
+    /* Header and TLV area rows are not part of a chunk */
+    if ((!chunk_meta_valid) || (address < meta->payload_addr) ||
+        ((address - meta->payload_addr) >= meta->payload_size))
+    {
+        return CY_DFU_SUCCESS;
+    }
+
+    row_end = address + CY_FLASH_SIZEOF_ROW - meta->payload_addr;
+    if (row_end > meta->payload_size)
+    {
+        row_end = meta->payload_size;
+    }
+
+    chunk_num = (row_end - 1u) / meta->chunk_size;
+    chunk_end = (chunk_num + 1u) * meta->chunk_size;
+    if (chunk_end > meta->payload_size)
+    {
+        chunk_end = meta->payload_size;
+    }
+
+    /* The chunks before this row were all sent or erased. A chunk that did
+     * not match stays here until it is sent again: by its last row, or by
+     * the next row when its last rows were left out.
+     */
+    while (chunk_next_check < chunk_num)
+    {
+        if (chunk_hash_check_chunk(meta, chunk_next_check++) != CY_DFU_SUCCESS)
+        {
+            return CY_DFU_ERROR_DATA;
+        }
+    }
+
+    if (row_end != chunk_end)
+    {
+        return CY_DFU_SUCCESS;
+    }
+
+    if (chunk_next_check == chunk_num)
+    {
+        chunk_next_check++;
+    }
+
+    return chunk_hash_check_chunk(meta, chunk_num);
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_check_root
+ *******************************************************************************
+ * Summary:
+ *  Checks that the chunk hashes received for an image have the root signed
+ *  into the image. Images transferred without chunk hashes pass.
+ *
+ * Parameters:
+ *  payload_addr - Address of the image payload
+ *  payload_size - Size of the image payload
+ *  root         - Root from the protected TLV area, NULL if the image has
+ *                 no such TLV
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS, or CY_DFU_ERROR_VERIFY if the chunk
+ *                       hashes do not belong to the image
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_chunk_hash_check_root(uint32_t payload_addr, uint32_t payload_size, const uint8_t *root)
+{
+    const dfu_chunk_hash_meta_t *meta = (const dfu_chunk_hash_meta_t *)chunk_meta;
+
+    if ((!chunk_meta_valid) || (meta->payload_addr != payload_addr))
+    {
+        return CY_DFU_SUCCESS;
+    }
+
+    if ((root == NULL) || (meta->payload_size != payload_size) ||
+        (memcmp(root, meta->root, DFU_CHUNK_HASH_SIZE) != 0))
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_bad_chunk
+ *******************************************************************************
+ * Summary:
+ *  Reports a chunk that did not match its hash, once. The transfer can go on:
+ *  the host sends the rows of the chunk again.
+ *
+ * Parameters:
+ *  address - Returns the address of the chunk
+ *
+ * Return:
+ *  bool - true if a chunk did not match since the last call
+ *
+ *******************************************************************************/
+bool dfu_chunk_hash_bad_chunk(uint32_t *address)
+{
+    bool bad = chunk_bad;
+
+    *address = chunk_bad_addr;
+    chunk_bad = false;
+
+    return bad;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_chunk_hash_reset
+ *******************************************************************************
+ * Summary:
+ *  Forgets the chunk hashes at the end of a transfer.
+ *
+ *******************************************************************************/
+void dfu_chunk_hash_reset(void)
+{
+    chunk_meta_valid = false;
+    chunk_meta_next_row = 0u;
+    chunk_next_check = 0u;
+    chunk_bad = false;
+}
+
+#endif /* DFU_CHUNK_HASH */
+
+/* [] END OF FILE */
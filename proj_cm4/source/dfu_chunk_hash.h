@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name:   dfu_chunk_hash.h
+*
+* Description: This file contains the definitions and function prototypes
+*              for checking the chunks of an image against the chunk hashes
+*              received ahead of the image in the DFU transfer.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef DFU_CHUNK_HASH_H
+#define DFU_CHUNK_HASH_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "cy_dfu.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* The chunk hashes are sent as rows at this address, which is not mapped on
+ * the device, see chunk_hash.py.
+ */
+#define DFU_CHUNK_HASH_ADDR             (0x60000000UL)
+
+#define DFU_CHUNK_HASH_MAGIC            (0x314B4843UL)  /* "CHK1" */
+
+/* Maximum number of chunks of an image */
+#define DFU_CHUNK_HASH_MAX_CHUNKS       (512u)
+
+/* Protected TLV holding the Merkle root of the chunk hashes */
+#define IMAGE_TLV_CHUNK_ROOT            (0xA0)
+
+#define DFU_CHUNK_HASH_SIZE             (32u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Header of the chunk hashes, followed by the hash of each chunk */
+typedef struct
+{
+    uint32_t magic;                     /* DFU_CHUNK_HASH_MAGIC */
+    uint32_t payload_addr;              /* Address of the image payload */
+    uint32_t payload_size;              /* Size of the image payload */
+    uint32_t chunk_size;                /* Chunk size, a multiple of the row size */
+    uint8_t root[DFU_CHUNK_HASH_SIZE];  /* Merkle root of the chunk hashes */
+} dfu_chunk_hash_meta_t;
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+bool dfu_chunk_hash_is_meta(uint32_t address);
+cy_en_dfu_status_t dfu_chunk_hash_write_meta(uint32_t address, const uint8_t *row);
+cy_en_dfu_status_t dfu_chunk_hash_check_row(uint32_t address);
+cy_en_dfu_status_t dfu_chunk_hash_check_root(uint32_t payload_addr, uint32_t payload_size, const uint8_t *root);
+bool dfu_chunk_hash_bad_chunk(uint32_t *address);
+void dfu_chunk_hash_reset(void);
+
+#endif /* DFU_CHUNK_HASH_H */
+
+/* [] END OF FILE */
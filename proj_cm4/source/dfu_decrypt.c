@@ -0,0 +1,241 @@
+/******************************************************************************
+* File Name:   dfu_decrypt.c
+*
+* Description: This file decrypts the rows of an encrypted DFU image before
+*              they are written to the update slot. The image is encrypted
+*              with AES-128 in CTR mode using a key per image. The host sends
+*              that key wrapped with the key-encryption key in the EI vector
+*              of the DFU session. The key-encryption key is only readable by
+*              the CM0+ app, which unwraps the image key through IPC.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <string.h>
+#include "cy_pdl.h"
+#include "dfu_decrypt.h"
+#include "ipc_communication.h"
+
+#if defined(DFU_ENCRYPTION)
+
+#if (CY_IP_MXCRYPTO == 0u)
+#error "Device does not support Crypto HW block. DFU_ENCRYPTION needs the \
+AES of the Crypto HW block"
+#endif
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define DFU_DECRYPT_BLOCK_SIZE          (CY_CRYPTO_AES_BLOCK_SIZE)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* EI vector of the DFU session, set by the Set EI Vector DFU command */
+CY_ALIGN(4) static uint8_t dfu_eiv[IPC_KEY_SIZE];
+
+/* Wrapped key for which dfu_key holds the unwrapped key */
+CY_ALIGN(4) static uint8_t dfu_key_wrapped[IPC_KEY_SIZE];
+
+/* Unwrapped image key */
+CY_ALIGN(4) static uint8_t dfu_key[IPC_KEY_SIZE];
+static bool dfu_key_valid = false;
+
+/* Key unwrap request, the CM0+ app only accepts requests in the shared SRAM */
+CY_SECTION(".shared_ram") static ipc_unwrap_key_t dfu_unwrap_request;
+
+/*******************************************************************************
+ * Function Name: dfu_decrypt_clear
+ *******************************************************************************
+ * Summary:
+ *  Clears a buffer holding key material. The volatile access keeps the
+ *  compiler from removing the stores.
+ *
+ * Parameters:
+ *  data - Pointer to the buffer
+ *  size - Number of bytes
+ *
+ *******************************************************************************/
+static void dfu_decrypt_clear(void *data, uint32_t size)
+{
+    volatile uint8_t *p = (volatile uint8_t *)data;
+
+    while (size-- != 0u)
+    {
+        *p++ = 0u;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dfu_decrypt_unwrap_key
+ *******************************************************************************
+ * Summary:
+ *  Asks the CM0+ app to unwrap the key received in the EI vector and waits
+ *  for the result.
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if dfu_key holds the image key
+ *
+ *******************************************************************************/
+static cy_en_dfu_status_t dfu_decrypt_unwrap_key(void)
+{
+    uint32_t wait_ms = DFU_DECRYPT_UNWRAP_TIMEOUT_MS;
+
+    dfu_unwrap_request.cmd = IPC_CMD_UNWRAP_KEY;
+    dfu_unwrap_request.status = IPC_STATUS_PENDING;
+    (void)memcpy(dfu_unwrap_request.key, dfu_eiv, IPC_KEY_SIZE);
+
+    /* Make the request visible to the CM0+ before it is notified */
+    __DSB();
+    ipc_send_msg_to_cm0p((uint32_t)&dfu_unwrap_request);
+
+    while ((dfu_unwrap_request.status == IPC_STATUS_PENDING) && (wait_ms != 0u))
+    {
+        Cy_SysLib_Delay(1u);
+        wait_ms--;
+    }
+
+    if (dfu_unwrap_request.status != IPC_STATUS_DONE)
+    {
+        dfu_decrypt_clear(dfu_unwrap_request.key, IPC_KEY_SIZE);
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    (void)memcpy(dfu_key, dfu_unwrap_request.key, IPC_KEY_SIZE);
+    (void)memcpy(dfu_key_wrapped, dfu_eiv, IPC_KEY_SIZE);
+    dfu_decrypt_clear(dfu_unwrap_request.key, IPC_KEY_SIZE);
+    dfu_key_valid = true;
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_decrypt_init
+ *******************************************************************************
+ * Summary:
+ *  Attaches the EI vector buffer to the DFU parameters and forgets the key
+ *  of a previous session. Must be called before Cy_DFU_Init().
+ *
+ * Parameters:
+ *  params - Pointer to the DFU parameters
+ *
+ *******************************************************************************/
+void dfu_decrypt_init(cy_stc_dfu_params_t *params)
+{
+    dfu_decrypt_clear(dfu_eiv, sizeof(dfu_eiv));
+    dfu_decrypt_clear(dfu_key, sizeof(dfu_key));
+    dfu_key_valid = false;
+
+    params->encryptionVector = dfu_eiv;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_decrypt_row
+ *******************************************************************************
+ * Summary:
+ *  Decrypts the data of a row in place. The CTR counter of the first block
+ *  of the row is the row address divided by the AES block size, as a 128-bit
+ *  big-endian number, so each row can be decrypted on its own. The image key
+ *  is unwrapped when the first row arrives or when the EI vector changes.
+ *
+ * Parameters:
+ *  address - Address the row is written to
+ *  data    - Pointer to the row data
+ *  length  - Number of bytes, a multiple of the AES block size
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the row was decrypted,
+ *  CY_DFU_ERROR_VERIFY if no key was received or it cannot be unwrapped
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_decrypt_row(uint32_t address, uint8_t *data, uint32_t length)
+{
+    static const uint8_t no_key[IPC_KEY_SIZE] = { 0u };
+
+    cy_stc_crypto_aes_state_t aes_state = { 0 };
+    CY_ALIGN(4) cy_stc_crypto_aes_buffers_t aes_buffers;
+    CY_ALIGN(4) uint8_t counter[DFU_DECRYPT_BLOCK_SIZE] = { 0u };
+    CY_ALIGN(4) uint8_t stream_block[DFU_DECRYPT_BLOCK_SIZE];
+    uint32_t src_offset = 0u;
+    uint32_t block_num = address / DFU_DECRYPT_BLOCK_SIZE;
+    cy_en_crypto_status_t crypto_status;
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+    /* Plain images are refused when the encryption is enabled */
+    if ((memcmp(dfu_eiv, no_key, IPC_KEY_SIZE) == 0) || ((length % DFU_DECRYPT_BLOCK_SIZE) != 0u))
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    if ((!dfu_key_valid) || (memcmp(dfu_eiv, dfu_key_wrapped, IPC_KEY_SIZE) != 0))
+    {
+        status = dfu_decrypt_unwrap_key();
+    }
+
+    if (status == CY_DFU_SUCCESS)
+    {
+        counter[12] = (uint8_t)(block_num >> 24u);
+        counter[13] = (uint8_t)(block_num >> 16u);
+        counter[14] = (uint8_t)(block_num >> 8u);
+        counter[15] = (uint8_t)(block_num);
+
+        crypto_status = Cy_Crypto_Core_Enable(CRYPTO);
+
+        if (crypto_status == CY_CRYPTO_SUCCESS)
+        {
+            crypto_status = Cy_Crypto_Core_Aes_Init(CRYPTO, dfu_key, CY_CRYPTO_KEY_AES_128,
+                                                    &aes_state, &aes_buffers);
+        }
+
+        if (crypto_status == CY_CRYPTO_SUCCESS)
+        {
+            crypto_status = Cy_Crypto_Core_Aes_Ctr(CRYPTO, &aes_state, length, &src_offset,
+                                                   counter, stream_block, data, data);
+            (void)Cy_Crypto_Core_Aes_Free(CRYPTO, &aes_state);
+        }
+
+        dfu_decrypt_clear(stream_block, sizeof(stream_block));
+        dfu_decrypt_clear(&aes_buffers, sizeof(aes_buffers));
+
+        status = (crypto_status == CY_CRYPTO_SUCCESS) ? CY_DFU_SUCCESS : CY_DFU_ERROR_VERIFY;
+    }
+
+    return status;
+}
+
+#endif /* DFU_ENCRYPTION */
+
+/* [] END OF FILE */
@@ -0,0 +1,491 @@
+/******************************************************************************
+* File Name:   dfu_flash.c
+*
+* Description: This file implements the flash access layer used by the DFU.
+*              The update slot is either in the internal flash, written one
+*              row at a time, or in the external QSPI flash. External writes go
+*              through the MCUboot flash area API: consecutive rows are
+*              collected in a program buffer and each erase sector is erased
+*              when the DFU writes to it for the first time.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <string.h>
+#include "cy_pdl.h"
+#include "dfu_flash.h"
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+#include "flash_map_backend/flash_map_backend.h"
+#include "sysflash/sysflash.h"
+#include "flash_qspi.h"
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Chunk size used to compare flash content with a buffer */
+#define DFU_FLASH_CMP_CHUNK_SIZE        (64u)
+
+#define DFU_FLASH_NO_SECTOR             (0xFFFFFFFFUL)
+
+_Static_assert((DFU_FLASH_PROG_BUF_SIZE % CY_FLASH_SIZEOF_ROW) == 0u,
+               "The program buffer must hold whole rows");
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Secondary slot in the external flash */
+static const struct flash_area *ext_area = NULL;
+
+/* Erase sector size of the external flash */
+static uint32_t ext_erase_size;
+
+/* Sector that was erased last, relative to the start of the slot */
+static uint32_t ext_erased_sector = DFU_FLASH_NO_SECTOR;
+
+/* Rows waiting to be programmed */
+static struct
+{
+    uint32_t address;                   /* Address of the first row */
+    uint32_t length;                    /* Number of bytes in the buffer */
+    CY_ALIGN(4) uint8_t data[DFU_FLASH_PROG_BUF_SIZE];
+} prog_buf;
+
+/*******************************************************************************
+ * Function Name: dfu_flash_ext_contains
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a range is inside the secondary slot in the external flash.
+ *
+ * Parameters:
+ *   address - Start address of the range (SMIF XIP address)
+ *   length  - Length of the range in bytes
+ *
+ * Return:
+ *   bool - true if the range is inside the slot
+ *
+ *******************************************************************************/
+static bool dfu_flash_ext_contains(uint32_t address, uint32_t length)
+{
+    return (ext_area != NULL) && (address >= ext_area->fa_off) &&
+           (length <= ext_area->fa_size) &&
+           ((address - ext_area->fa_off) <= (ext_area->fa_size - length));
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: dfu_flash_init
+ ********************************************************************************
+ * Summary:
+ *   Initializes the external flash and opens the secondary slot when the slot
+ *   is in the external flash. Does nothing otherwise.
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS or CY_DFU_ERROR_UNKNOWN
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_init(void)
+{
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (qspi_init_sfdp(CY_BOOT_EXTERNAL_SMIF_ID) != CY_SMIF_SUCCESS)
+    {
+        return CY_DFU_ERROR_UNKNOWN;
+    }
+
+    if (flash_area_open(FLASH_AREA_IMG_1_SECONDARY, &ext_area) != 0)
+    {
+        ext_area = NULL;
+        return CY_DFU_ERROR_UNKNOWN;
+    }
+
+    /* The slot must start on an erase sector so that erasing it does not
+     * touch other data.
+     */
+    ext_erase_size = qspi_get_erase_size();
+    if ((ext_erase_size == 0u) || ((ext_area->fa_off % ext_erase_size) != 0u))
+    {
+        flash_area_close(ext_area);
+        ext_area = NULL;
+        return CY_DFU_ERROR_UNKNOWN;
+    }
+
+    ext_erased_sector = DFU_FLASH_NO_SECTOR;
+    prog_buf.length = 0u;
+#endif
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_is_external
+ ********************************************************************************
+ * Summary:
+ *   Checks whether an address is in the secondary slot in the external flash.
+ *
+ * Parameters:
+ *   address - Address to check
+ *
+ * Return:
+ *   bool - true if the address is in the external flash slot
+ *
+ *******************************************************************************/
+bool dfu_flash_is_external(uint32_t address)
+{
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    return dfu_flash_ext_contains(address, 1u);
+#else
+    (void) address;
+    return false;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_erased_val
+ ********************************************************************************
+ * Summary:
+ *   Returns the value of an erased byte at an address. It is used to fill the
+ *   rows erased by the DFU erase command.
+ *
+ * Parameters:
+ *   address - Address of the row
+ *
+ * Return:
+ *   uint8_t - Erased value
+ *
+ *******************************************************************************/
+uint8_t dfu_flash_erased_val(uint32_t address)
+{
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (dfu_flash_is_external(address))
+    {
+        return flash_area_erased_val(ext_area);
+    }
+#else
+    (void) address;
+#endif
+
+    /* Internal flash rows are cleared to 0, see ERASED_VALUE in the Makefile */
+    return 0u;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_flush
+ ********************************************************************************
+ * Summary:
+ *   Programs the rows collected in the program buffer. Every erase sector
+ *   that the rows are in is erased first, unless it is the sector that was
+ *   erased last and the rows do not start at its beginning. The DFU writes
+ *   the rows in ascending order, so every sector is erased once per transfer.
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS or CY_DFU_ERROR_DATA
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_flush(void)
+{
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+    if (prog_buf.length != 0u)
+    {
+        uint32_t offset = prog_buf.address - ext_area->fa_off;
+        uint32_t last_sector = (offset + prog_buf.length - 1u) / ext_erase_size;
+
+        for (uint32_t sector = offset / ext_erase_size; (sector <= last_sector) && (status == CY_DFU_SUCCESS); sector++)
+        {
+            uint32_t sector_offset = sector * ext_erase_size;
+
+            if ((sector != ext_erased_sector) || (sector_offset == offset))
+            {
+                /* The last sector may extend past the end of the slot */
+                uint32_t erase_size = ext_area->fa_size - sector_offset;
+                erase_size = (erase_size < ext_erase_size) ? erase_size : ext_erase_size;
+
+                status = (flash_area_erase(ext_area, sector_offset, erase_size) == 0) ? CY_DFU_SUCCESS : CY_DFU_ERROR_DATA;
+                ext_erased_sector = (status == CY_DFU_SUCCESS) ? sector : DFU_FLASH_NO_SECTOR;
+            }
+        }
+
+        if (status == CY_DFU_SUCCESS)
+        {
+            status = (flash_area_write(ext_area, offset, prog_buf.data, prog_buf.length) == 0) ? CY_DFU_SUCCESS : CY_DFU_ERROR_DATA;
+        }
+
+        prog_buf.length = 0u;
+    }
+
+    return status;
+#else
+    return CY_DFU_SUCCESS;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_write_row
+ ********************************************************************************
+ * Summary:
+ *   Writes one flash row. Internal rows are programmed immediately. External
+ *   rows are added to the program buffer, which is programmed when it is full
+ *   or when the next row does not follow the buffered ones.
+ *
+ * Parameters:
+ *   address - Row address, aligned to CY_FLASH_SIZEOF_ROW
+ *   data    - Row data, CY_FLASH_SIZEOF_ROW bytes
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS, CY_DFU_ERROR_ADDRESS or
+ *                        CY_DFU_ERROR_DATA
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_write_row(uint32_t address, const uint8_t *data)
+{
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (dfu_flash_is_external(address))
+    {
+        if (!dfu_flash_ext_contains(address, CY_FLASH_SIZEOF_ROW))
+        {
+            return CY_DFU_ERROR_ADDRESS;
+        }
+
+        if ((prog_buf.length != 0u) && (address != (prog_buf.address + prog_buf.length)))
+        {
+            status = dfu_flash_flush();
+        }
+
+        if (prog_buf.length == 0u)
+        {
+            prog_buf.address = address;
+        }
+
+        (void) memcpy(&prog_buf.data[prog_buf.length], data, CY_FLASH_SIZEOF_ROW);
+        prog_buf.length += CY_FLASH_SIZEOF_ROW;
+
+        if ((status == CY_DFU_SUCCESS) && (prog_buf.length == DFU_FLASH_PROG_BUF_SIZE))
+        {
+            status = dfu_flash_flush();
+        }
+
+        return status;
+    }
+#endif
+
+    if (Cy_Flash_WriteRow(address, (const uint32_t *)data) != CY_FLASH_DRV_SUCCESS)
+    {
+        status = CY_DFU_ERROR_DATA;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_erase
+ ********************************************************************************
+ * Summary:
+ *   Erases whole rows. Internal rows are erased with the largest erase unit
+ *   that fits in the range. In the external flash, every erase sector that
+ *   the range touches is erased, so the range must be erased before the rows
+ *   around it in the same sectors are written.
+ *
+ * Parameters:
+ *   address - Start address, aligned to CY_FLASH_SIZEOF_ROW
+ *   length  - Number of bytes, a multiple of CY_FLASH_SIZEOF_ROW
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS, CY_DFU_ERROR_ADDRESS or
+ *                        CY_DFU_ERROR_DATA
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_erase(uint32_t address, uint32_t length)
+{
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+    uint32_t end = address + length;
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (dfu_flash_is_external(address))
+    {
+        uint32_t offset, erase_end;
+
+        if (!dfu_flash_ext_contains(address, length))
+        {
+            return CY_DFU_ERROR_ADDRESS;
+        }
+
+        status = dfu_flash_flush();
+        if ((status == CY_DFU_SUCCESS) && (length != 0u))
+        {
+            /* The slot starts on a sector, the last sector may extend past its end */
+            offset = ((address - ext_area->fa_off) / ext_erase_size) * ext_erase_size;
+            erase_end = (((address - ext_area->fa_off) + length + ext_erase_size - 1u) / ext_erase_size) * ext_erase_size;
+            erase_end = (erase_end < ext_area->fa_size) ? erase_end : ext_area->fa_size;
+
+            if (flash_area_erase(ext_area, offset, erase_end - offset) != 0)
+            {
+                status = CY_DFU_ERROR_DATA;
+            }
+            ext_erased_sector = DFU_FLASH_NO_SECTOR;
+        }
+
+        return status;
+    }
+#endif
+
+    while ((address < end) && (status == CY_DFU_SUCCESS))
+    {
+        cy_en_flashdrv_status_t flash_status;
+        uint32_t size;
+
+        if (((address % DFU_FLASH_SECTOR_SIZE) == 0u) && ((end - address) >= DFU_FLASH_SECTOR_SIZE))
+        {
+            flash_status = Cy_Flash_EraseSector(address);
+            size = DFU_FLASH_SECTOR_SIZE;
+        }
+        else if (((address % DFU_FLASH_SUBSECTOR_SIZE) == 0u) && ((end - address) >= DFU_FLASH_SUBSECTOR_SIZE))
+        {
+            flash_status = Cy_Flash_EraseSubsector(address);
+            size = DFU_FLASH_SUBSECTOR_SIZE;
+        }
+        else
+        {
+            flash_status = Cy_Flash_EraseRow(address);
+            size = CY_FLASH_SIZEOF_ROW;
+        }
+
+        status = (flash_status == CY_FLASH_DRV_SUCCESS) ? CY_DFU_SUCCESS : CY_DFU_ERROR_DATA;
+        address += size;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_read
+ ********************************************************************************
+ * Summary:
+ *   Reads flash content. Rows still in the program buffer are programmed
+ *   first.
+ *
+ * Parameters:
+ *   address - Start address
+ *   data    - Destination buffer
+ *   length  - Number of bytes to read
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS, CY_DFU_ERROR_ADDRESS or
+ *                        CY_DFU_ERROR_DATA
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_read(uint32_t address, void *data, uint32_t length)
+{
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (dfu_flash_is_external(address))
+    {
+        cy_en_dfu_status_t status = dfu_flash_ext_contains(address, length) ? dfu_flash_flush() : CY_DFU_ERROR_ADDRESS;
+
+        if ((status == CY_DFU_SUCCESS) &&
+            (flash_area_read(ext_area, address - ext_area->fa_off, data, length) != 0))
+        {
+            status = CY_DFU_ERROR_DATA;
+        }
+
+        return status;
+    }
+#endif
+
+    (void) memcpy(data, (const void *)address, length);
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_compare
+ ********************************************************************************
+ * Summary:
+ *   Compares flash content with a buffer.
+ *
+ * Parameters:
+ *   address - Start address
+ *   data    - Buffer to compare with
+ *   length  - Number of bytes to compare
+ *
+ * Return:
+ *   cy_en_dfu_status_t - CY_DFU_SUCCESS if equal, CY_DFU_ERROR_VERIFY if
+ *                        different, or the dfu_flash_read() error
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_compare(uint32_t address, const void *data, uint32_t length)
+{
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+#ifdef CY_BOOT_USE_EXTERNAL_FLASH
+    if (dfu_flash_is_external(address))
+    {
+        CY_ALIGN(4) uint8_t chunk[DFU_FLASH_CMP_CHUNK_SIZE];
+        const uint8_t *expected = (const uint8_t *)data;
+
+        while ((length != 0u) && (status == CY_DFU_SUCCESS))
+        {
+            uint32_t chunk_size = (length < DFU_FLASH_CMP_CHUNK_SIZE) ? length : DFU_FLASH_CMP_CHUNK_SIZE;
+
+            status = dfu_flash_read(address, chunk, chunk_size);
+            if ((status == CY_DFU_SUCCESS) && (memcmp(chunk, expected, chunk_size) != 0))
+            {
+                status = CY_DFU_ERROR_VERIFY;
+            }
+
+            address += chunk_size;
+            expected += chunk_size;
+            length -= chunk_size;
+        }
+
+        return status;
+    }
+#endif
+
+    if (memcmp(data, (const void *)address, length) != 0)
+    {
+        status = CY_DFU_ERROR_VERIFY;
+    }
+
+    return status;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,79 @@
+/******************************************************************************
+* File Name:   dfu_flash.h
+*
+* Description: This file contains the function prototypes of the flash access
+*              layer used by the DFU to write and read the update slot, in the
+*              internal flash or in the external QSPI flash.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef DFU_FLASH_H
+#define DFU_FLASH_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "cy_dfu.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Consecutive rows written to the external flash are collected in a buffer of
+ * this size and programmed in one operation.
+ */
+#define DFU_FLASH_PROG_BUF_SIZE         (4096u)
+
+/* Erase units of the internal flash: a sector and a subsector of 8 rows */
+#define DFU_FLASH_SECTOR_SIZE           (0x40000u)
+#define DFU_FLASH_SUBSECTOR_SIZE        (8u * CY_FLASH_SIZEOF_ROW)
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+cy_en_dfu_status_t dfu_flash_init(void);
+bool dfu_flash_is_external(uint32_t address);
+uint8_t dfu_flash_erased_val(uint32_t address);
+cy_en_dfu_status_t dfu_flash_write_row(uint32_t address, const uint8_t *data);
+cy_en_dfu_status_t dfu_flash_erase(uint32_t address, uint32_t length);
+cy_en_dfu_status_t dfu_flash_flush(void);
+cy_en_dfu_status_t dfu_flash_read(uint32_t address, void *data, uint32_t length);
+cy_en_dfu_status_t dfu_flash_compare(uint32_t address, const void *data, uint32_t length);
+
+#endif /* DFU_FLASH_H */
+
+/* [] END OF FILE */
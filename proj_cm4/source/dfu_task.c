@@ -53,6 +53,13 @@
 #include "cy_retarget_io_pdl.h"
 #include "ipc_communication.h"
 #include "dfu_user.h"
+#include "dfu_flash.h"
+#include "dfu_decrypt.h"
+#include "dfu_chunk_hash.h"
+#include "eeprom_store.h"
+#if !defined(MCUBOOT_OVERWRITE_ONLY)
+#include "bootutil/bootutil.h"
+#endif
 
 /****************************************************************************
  * Macros
@@ -82,6 +89,18 @@
 
 #define DFU_UART_POLL_COUNT (10u)
 
+/****************************************************************************
+ * Structures
+ *****************************************************************************/
+/* DFU history, kept in the protected storage by the CM0+ app */
+typedef struct
+{
+    uint32_t dfu_count;                 /* Successful DFU transfers */
+    uint8_t version_major;              /* Version of the image that received the update */
+    uint8_t version_minor;
+    uint16_t version_build;
+} dfu_history_t;
+
 /****************************************************************************
  * Functions Prototypes
  *****************************************************************************/
@@ -142,11 +161,39 @@ void dfu_task(void)
     /* DFU params, used to configure DFU */
     cy_stc_dfu_params_t dfu_params;
 
+    /* Number of successful DFU transfers, kept in the emulated EEPROM */
+    uint32_t dfu_count = 0u;
+    uint8_t dfu_count_len = sizeof(dfu_count);
+
+    /* DFU history, written to the protected storage after each transfer */
+    dfu_history_t dfu_history =
+    {
+        .version_major = APP_VERSION_MAJOR,
+        .version_minor = APP_VERSION_MINOR,
+        .version_build = APP_VERSION_BUILD
+    };
+
+#if defined(DFU_CHUNK_HASH)
+    /* Chunk of the image that did not match its hash */
+    uint32_t bad_chunk_addr;
+#endif
+
     /* Initialize dfu_params structure */
     dfu_params.timeout          = paramsTimeout;
     dfu_params.dataBuffer       = &buffer[0];
     dfu_params.packetBuffer     = &packet[0];
 
+    /* Initialize the flash holding the update slot */
+    status = dfu_flash_init();
+
+    /* Stop program execution if the update slot cannot be accessed */
+    CY_ASSERT(CY_DFU_SUCCESS == status);
+
+#if defined(DFU_ENCRYPTION)
+    /* Receive the wrapped image key of encrypted images in the EI vector */
+    dfu_decrypt_init(&dfu_params);
+#endif
+
     /* Initialize the DFU */
     status = Cy_DFU_Init(&state, &dfu_params);
 
@@ -179,6 +226,10 @@ void dfu_task(void)
     /* Initialize DFU communication */
     Cy_DFU_TransportStart();
 
+    /* Load the records stored in the emulated EEPROM */
+    (void)eeprom_store_init();
+    (void)eeprom_store_read(EEPROM_STORE_ID_DFU_COUNT, (uint8_t *)&dfu_count, &dfu_count_len);
+
     /* Get unique device ID from protected storage via IPC */
     ipc_send_msg_to_cm0p(IPC_CMD_READ_DATA);
 
@@ -189,6 +240,7 @@ void dfu_task(void)
 
     /* Print message on serial terminal */
     printf("%s", message);
+    printf("Successful DFU transfers: %u\r\n", (unsigned int) dfu_count);
     cyhal_system_delay_ms(1000);
 
     while(1)
@@ -201,6 +253,21 @@ void dfu_task(void)
             /* Print the device ID received from CM0+ */
             printf("Unique Device ID received: 0x%08X\n\r", (unsigned int) msg_value);
 
+#if !defined(MCUBOOT_OVERWRITE_ONLY)
+            /*
+             * Both CPUs are up, make the running images permanent. Otherwise
+             * MCUboot reverts the swap on the next reset. Nothing is written
+             * for an image that is already confirmed.
+             */
+            for (int image = 0; image < MCUBOOT_IMAGE_NUMBER; image++)
+            {
+                if (boot_set_confirmed_multi(image) != 0)
+                {
+                    printf("Failed to confirm image %d\r\n", image + 1);
+                }
+            }
+#endif
+
             printf("Starting DFU operation\r\n");
 
             dfu_start_flag = true;
@@ -224,6 +291,35 @@ void dfu_task(void)
                 {
                     printf("Validation successful\r\n");
 
+#if !defined(MCUBOOT_OVERWRITE_ONLY)
+                    /* Request a test swap of each image written by the
+                     * transfer, the new images have to confirm themselves
+                     */
+                    for (int image = 0; image < MCUBOOT_IMAGE_NUMBER; image++)
+                    {
+                        if (((dfu_user_validated_images() & (1UL << image)) != 0UL) &&
+                            (boot_set_pending_multi(image, 0) != 0))
+                        {
+                            printf("Failed to request the upgrade of image %d\r\n", image + 1);
+                        }
+                    }
+#endif
+
+                    /* Update the DFU counter before switching to the new image */
+                    dfu_count++;
+                    if ((eeprom_store_write(EEPROM_STORE_ID_DFU_COUNT, (const uint8_t *)&dfu_count, sizeof(dfu_count)) != EEPROM_STORE_SUCCESS) ||
+                        (eeprom_store_flush() != EEPROM_STORE_SUCCESS))
+                    {
+                        printf("Failed to update the DFU counter\r\n");
+                    }
+
+                    /* Keep the DFU history where the CM4 cannot change it later */
+                    dfu_history.dfu_count = dfu_count;
+                    if (!ipc_write_record(IPC_RECORD_ID_DFU_HISTORY, (const uint8_t *)&dfu_history, sizeof(dfu_history)))
+                    {
+                        printf("Failed to update the DFU history\r\n");
+                    }
+
 #ifdef DFU_STATUS_LED
                     /* Set the LED to ON */
                     cyhal_gpio_write(DFU_STATUS_LED, CYBSP_LED_STATE_ON);
@@ -287,10 +383,23 @@ void dfu_task(void)
                         Cy_DFU_TransportReset();
                     }
                 }
+#if defined(DFU_CHUNK_HASH)
+                else if (dfu_chunk_hash_bad_chunk(&bad_chunk_addr))
+                {
+                    /* Keep the transfer going, the host sends the chunk again */
+                    count = 0u;
+                    printf("Chunk at 0x%08X corrupted, waiting for it again\r\n", (unsigned int) bad_chunk_addr);
+                }
+#endif
                 else
                 {
                     count = 0u;
 
+                    if (dfu_user_header_result() != DFU_HEADER_OK)
+                    {
+                        printf("Image header rejected: %d\r\n", (int) dfu_user_header_result());
+                    }
+
                     /* Delay because Transport still may be sending error response to a host */
                     cyhal_system_delay_ms(paramsTimeout);
                     Cy_DFU_Init(&state, &dfu_params);
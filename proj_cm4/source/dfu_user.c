@@ -45,7 +45,11 @@
 #include "cy_pdl.h"
 #include "cy_flash.h"
 #include "cy_dfu.h"
+#include "dfu_flash.h"
+#include "dfu_decrypt.h"
+#include "dfu_chunk_hash.h"
 #include "../proj_btldr_cm0p/keys/ecc-public-key-p256.h"
+#include "../proj_btldr_cm0p/source/cy_ps_boot_shared.h"
 
 #if (CY_IP_MXCRYPTO == 0u)
 #error "Device does not support Crypto HW block. Use a different device \
@@ -56,7 +60,42 @@ MbedTLS software implementation (out of scope of this code example)."
 static uint32_t IsMultipleOf(uint32_t value, uint32_t multiple);
 static cy_rslt_t extract_pub_key(char *pub_key_der_in, uint8_t length, char *pub_key_out);
 static cy_rslt_t signature_der_to_asn1(uint8_t *sign_in, uint8_t *sign_out);
-static void calculate_sha256_digest(uint8_t* message_start_addr, uint32_t message_size, uint8_t* calc_sha256_digest);
+static cy_en_dfu_status_t calculate_sha256_digest(uint32_t message_start_addr, uint32_t message_size, uint8_t* calc_sha256_digest);
+static cy_en_dfu_status_t validate_image(uint32_t secondary_slot_start_addr);
+static cy_en_dfu_status_t check_header_row(uint32_t address, const uint8_t *row);
+static cy_en_dfu_status_t erase_ranges(const uint8_t *row);
+#if defined(MCUBOOT_HW_ROLLBACK_PROT) || defined(DFU_CHUNK_HASH)
+static cy_en_dfu_status_t read_prot_tlv(uint32_t prot_tlv_start_addr, uint32_t prot_tlv_size,
+        uint16_t type, void *value, uint16_t length);
+#endif
+#if defined(MCUBOOT_HW_ROLLBACK_PROT)
+static uint32_t security_cnt_min(uint32_t secondary_slot_start_addr);
+static cy_en_dfu_status_t check_security_cnt(uint32_t secondary_slot_start_addr,
+        uint32_t prot_tlv_start_addr, uint32_t prot_tlv_size);
+#endif
+#if defined(DFU_CHUNK_HASH)
+static cy_en_dfu_status_t check_chunk_root(uint32_t payload_addr, uint32_t payload_size,
+        uint32_t prot_tlv_size);
+#endif
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+/* Secondary slots of image 1 (CM0+ app) and image 2 (CM4 app) */
+#define DFU_IMAGE_CM0P_SLOT_START   (CY_DFU_APP1_VERIFY_START)
+#define DFU_IMAGE_CM4_SLOT_START    (CY_DFU_APP1_VERIFY_START + (CM4_APP_FLASH_START - CM0P_APP_FLASH_START))
+#define DFU_IMAGE_CM0P_MASK         (1UL << 0u)
+#define DFU_IMAGE_CM4_MASK          (1UL << 1u)
+
+/* Images written since the last validation, any of DFU_IMAGE_xxx_MASK */
+static uint32_t dfu_written_images = 0UL;
+#endif
+
+/* Images validated by the last successful Cy_DFU_ValidateApp() */
+static uint32_t dfu_validated_images = 0UL;
+
+/* Result of the last image header check */
+static dfu_header_result_t dfu_header_result = DFU_HEADER_OK;
+
+_Static_assert(sizeof(dfu_erase_range_row_t) == CY_FLASH_SIZEOF_ROW, "Erase ranges must fill one flash row");
 
 /*******************************************************************************
 * Function Name: IsMultipleOf
@@ -96,6 +135,10 @@ cy_en_dfu_status_t Cy_DFU_WriteData (uint32_t address, uint32_t length, uint32_t
     const uint32_t maxEmEepromAddress = CY_EM_EEPROM_BASE + CY_EM_EEPROM_SIZE;
 
     cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+    bool erase_range_row = false;
+#if defined(DFU_CHUNK_HASH)
+    bool chunk_hash_row = false;
+#endif
 
     /* Set primary slot application range */
     uint32_t startAddress = CY_DFU_APP0_VERIFY_START;
@@ -117,9 +160,21 @@ cy_en_dfu_status_t Cy_DFU_WriteData (uint32_t address, uint32_t length, uint32_t
 
     /* Check if the address is inside the valid range */
     if ( ( (minUFlashAddress <= address) && (address < maxUFlashAddress) )
-            || ( (minEmEepromAddress <= address) && (address < maxEmEepromAddress) )  )
+            || ( (minEmEepromAddress <= address) && (address < maxEmEepromAddress) )
+            || dfu_flash_is_external(address) )
     {   /* Do nothing, this is an allowed memory range to update to */
     }
+    else if ( (DFU_ERASE_RANGE_ADDR <= address) &&
+              (address < (DFU_ERASE_RANGE_ADDR + (DFU_ERASE_RANGE_ROWS * CY_FLASH_SIZEOF_ROW))) )
+    {   /* The rows left out of a sparse file are erased, not written */
+        erase_range_row = true;
+    }
+#if defined(DFU_CHUNK_HASH)
+    else if (dfu_chunk_hash_is_meta(address))
+    {   /* The chunk hashes are kept in RAM, they are not written to the flash */
+        chunk_hash_row = true;
+    }
+#endif
     else
     {
         status = CY_DFU_ERROR_ADDRESS;
@@ -129,11 +184,58 @@ cy_en_dfu_status_t Cy_DFU_WriteData (uint32_t address, uint32_t length, uint32_t
     {
         if ((ctl & CY_DFU_IOCTL_ERASE) != 0U)
         {
-            (void) memset(params->dataBuffer, 0, CY_FLASH_SIZEOF_ROW);
+            (void) memset(params->dataBuffer, dfu_flash_erased_val(address), CY_FLASH_SIZEOF_ROW);
+        }
+        else
+        {
+#if defined(DFU_ENCRYPTION)
+            /* Decrypt the row in place, the checks and the write see plain data */
+            status = dfu_decrypt_row(address, params->dataBuffer, CY_FLASH_SIZEOF_ROW);
+
+            if (status == CY_DFU_SUCCESS)
+#endif
+            {
+                /* Reject a bad image when its header arrives, not after the transfer */
+                status = check_header_row(address, params->dataBuffer);
+            }
+        }
+    }
+
+    if ( (status == CY_DFU_SUCCESS) && erase_range_row )
+    {
+        return ((ctl & CY_DFU_IOCTL_ERASE) != 0U) ? CY_DFU_SUCCESS : erase_ranges(params->dataBuffer);
+    }
+
+#if defined(DFU_CHUNK_HASH)
+    if ( (status == CY_DFU_SUCCESS) && chunk_hash_row )
+    {
+        return ((ctl & CY_DFU_IOCTL_ERASE) != 0U) ? CY_DFU_SUCCESS : dfu_chunk_hash_write_meta(address, params->dataBuffer);
+    }
+#endif
+
+    if (status == CY_DFU_SUCCESS)
+    {
+        status = dfu_flash_write_row(address, params->dataBuffer);
+
+#if defined(DFU_CHUNK_HASH)
+        /* Check the chunk completed by this row, the host sends it again on an error */
+        if ( (status == CY_DFU_SUCCESS) && ((ctl & CY_DFU_IOCTL_ERASE) == 0U) )
+        {
+            status = dfu_chunk_hash_check_row(address);
         }
+#endif
 
-        cy_en_flashdrv_status_t fstatus =  Cy_Flash_WriteRow(address, (uint32_t*)params->dataBuffer);
-        status = (fstatus == CY_FLASH_DRV_SUCCESS) ? CY_DFU_SUCCESS : CY_DFU_ERROR_DATA;
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+        /* Remember which image is being updated, so that only that one is validated */
+        if ( (DFU_IMAGE_CM0P_SLOT_START <= address) && (address < DFU_IMAGE_CM4_SLOT_START) )
+        {
+            dfu_written_images |= DFU_IMAGE_CM0P_MASK;
+        }
+        else if ( (DFU_IMAGE_CM4_SLOT_START <= address) && (address < (CY_DFU_APP1_VERIFY_START + CY_DFU_APP1_VERIFY_LENGTH)) )
+        {
+            dfu_written_images |= DFU_IMAGE_CM4_MASK;
+        }
+#endif
     }
     return (status);
 }
@@ -168,7 +270,8 @@ cy_en_dfu_status_t Cy_DFU_ReadData (uint32_t address, uint32_t length, uint32_t
 
     /* Check if the address is inside the valid range */
     if ( ( (minUFlashAddress <= address) && (address < maxUFlashAddress) )
-            || ( (minEmEepromAddress <= address) && (address < maxEmEepromAddress) )  )
+            || ( (minEmEepromAddress <= address) && (address < maxEmEepromAddress) )
+            || dfu_flash_is_external(address) )
     {   /* Do nothing, this is an allowed memory range to update to */
     }
     else
@@ -181,13 +284,19 @@ cy_en_dfu_status_t Cy_DFU_ReadData (uint32_t address, uint32_t length, uint32_t
     {
         if ((ctl & CY_DFU_IOCTL_COMPARE) == 0U)
         {
-            (void) memcpy(params->dataBuffer, (const void *)address, length);
-            status = CY_DFU_SUCCESS;
+            status = dfu_flash_read(address, params->dataBuffer, length);
         }
         else
         {
-            status = ( memcmp(params->dataBuffer, (const void *)address, length) == 0 )
-                             ? CY_DFU_SUCCESS : CY_DFU_ERROR_VERIFY;
+#if defined(DFU_ENCRYPTION)
+            /* The host sends the encrypted data to compare */
+            status = dfu_decrypt_row(address, params->dataBuffer, length);
+
+            if (status == CY_DFU_SUCCESS)
+#endif
+            {
+                status = dfu_flash_compare(address, params->dataBuffer, length);
+            }
         }
     }
     return (status);
@@ -231,6 +340,98 @@ cy_en_dfu_status_t Cy_DFU_GetAppMetadata(uint32_t appId, uint32_t *verifyAddress
  * Summary:
  *  This is a weak function that is part of the DFU middleware that is
  *  overridden here to support the validation of imgtool signed images.
+ *  With two MCUboot images, each image written by the DFU is validated in
+ *  its own secondary slot.
+ *
+ * Parameters:
+ *  appID - ID of the application to be updated
+ *  *params - pointer to DFU parameters structure (cy_stc_dfu_params_t)
+ *
+ * Return:
+ *  cy_en_dfu_status_t - DFU operation status
+ *
+ ******************************************************************************/
+cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *params)
+{
+    cy_en_dfu_status_t status;
+
+    (void) appId;
+    (void) params;
+
+    /* Program the rows still buffered for the external flash */
+    if (dfu_flash_flush() != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_DATA;
+    }
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+    status = (dfu_written_images != 0UL) ? CY_DFU_SUCCESS : CY_DFU_ERROR_VERIFY;
+
+    if ( (status == CY_DFU_SUCCESS) && ((dfu_written_images & DFU_IMAGE_CM0P_MASK) != 0UL) )
+    {
+        status = validate_image(DFU_IMAGE_CM0P_SLOT_START);
+    }
+
+    if ( (status == CY_DFU_SUCCESS) && ((dfu_written_images & DFU_IMAGE_CM4_MASK) != 0UL) )
+    {
+        status = validate_image(DFU_IMAGE_CM4_SLOT_START);
+    }
+
+    dfu_validated_images = (status == CY_DFU_SUCCESS) ? dfu_written_images : 0UL;
+
+    /* The next transfer starts from scratch */
+    dfu_written_images = 0UL;
+#else
+    status = validate_image(CY_DFU_APP1_VERIFY_START);
+
+    dfu_validated_images = (status == CY_DFU_SUCCESS) ? 1UL : 0UL;
+#endif
+
+#if defined(DFU_CHUNK_HASH)
+    dfu_chunk_hash_reset();
+#endif
+
+    return status;
+}
+
+/******************************************************************************
+ * Function Name: dfu_user_validated_images
+ ******************************************************************************
+ * Summary:
+ *  Returns the MCUboot images validated by the last Cy_DFU_ValidateApp()
+ *  call, so that only those are marked for the upgrade.
+ *
+ * Return:
+ *  uint32_t - Bit n set for the image index n, 0 if the validation failed
+ *
+ ******************************************************************************/
+uint32_t dfu_user_validated_images(void)
+{
+    return dfu_validated_images;
+}
+
+/******************************************************************************
+ * Function Name: dfu_user_header_result
+ ******************************************************************************
+ * Summary:
+ *  Returns the result of the last image header check. A header rejected by
+ *  Cy_DFU_WriteData() stops the transfer with the DFU status given in
+ *  check_header_row(); this result tells the reason.
+ *
+ * Return:
+ *  dfu_header_result_t - DFU_HEADER_OK or the reason of the rejection
+ *
+ ******************************************************************************/
+dfu_header_result_t dfu_user_header_result(void)
+{
+    return dfu_header_result;
+}
+
+/******************************************************************************
+ * Function Name: validate_image
+ ******************************************************************************
+ * Summary:
+ *  Validates an imgtool signed image stored in a secondary slot.
  *
  * Note: Image should have the following structure:
  * +---------------------------+
@@ -238,6 +439,15 @@ cy_en_dfu_status_t Cy_DFU_GetAppMetadata(uint32_t appId, uint32_t *verifyAddress
  * +---------------------------+
  * | Payload                   |
  * +---------------------------+
+ * | Protected TLV area        |
+ * | +-----------------------+ |
+ * | | TLV area header       | |
+ * | +-----------------------+ |
+ * | | Dependency (optional) | |
+ * | +-----------------------+ |
+ * | | Security counter      | |
+ * | +-----------------------+ |
+ * +---------------------------+
  * | TLV area                  |
  * | +-----------------------+ |
  * | | TLV area header       | |
@@ -250,24 +460,26 @@ cy_en_dfu_status_t Cy_DFU_GetAppMetadata(uint32_t appId, uint32_t *verifyAddress
  * | +-----------------------| |
  * +---------------------------+
  *
- * If the protected_tlv is added, this function must be modified
- * appropriately.
+ * The protected TLV area is optional. It is covered by the SHA256 hash and,
+ * with rollback protection, must hold the security counter.
  *
  * Parameters:
- *  appID - ID of the application to be updated
- *  *params - pointer to DFU parameters structure (cy_stc_dfu_params_t)
+ *  secondary_slot_start_addr - Start address of the secondary slot
  *
  * Return:
  *  cy_en_dfu_status_t - DFU operation status
  *
  ******************************************************************************/
-cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *params)
+static cy_en_dfu_status_t validate_image(uint32_t secondary_slot_start_addr)
 {
-    uint32_t secondary_slot_start_addr = CY_DFU_APP1_VERIFY_START;
     uint32_t secondary_image_size = 0;
     uint16_t *p_trailer;
     uint32_t trailer_start_addr;
-    uint32_t image_magic = 0, header_size = 0;
+
+    /* TLV area copy, the slot may be in the external flash */
+    CY_ALIGN(4) static uint16_t trailer[TLV_AREA_READ_SIZE / sizeof(uint16_t)];
+    uint32_t image_magic = 0, header_sizes = 0;
+    uint32_t header_size, prot_tlv_size;
     uint8_t signature_length;
     uint32_t crypto_status;
     uint8_t validation_status;
@@ -286,7 +498,10 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
     CY_ALIGN(4) unsigned char ecdsa_pub_x_y[ECC_PUB_KEY_SIZE];
 
     /* Get header magic */
-    memcpy(&image_magic, (void *) secondary_slot_start_addr + HEADER_MAGIC_OFFSET, WORD_LEN);
+    if(dfu_flash_read(secondary_slot_start_addr + HEADER_MAGIC_OFFSET, &image_magic, WORD_LEN) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_DATA;
+    }
 
     /* Check if image header magic is valid */
     if(image_magic != IMAGE_MAGIC)
@@ -294,8 +509,13 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
         return CY_DFU_ERROR_VERIFY;
     }
 
-    /* Get the header size */
-    memcpy(&header_size, (void *) secondary_slot_start_addr + HEADER_SIZE_OFFSET, WORD_LEN);
+    /* Get the header size and the protected TLV area size, two 16-bit fields */
+    if(dfu_flash_read(secondary_slot_start_addr + HEADER_SIZE_OFFSET, &header_sizes, WORD_LEN) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_DATA;
+    }
+    header_size = header_sizes & 0xFFFFu;
+    prot_tlv_size = header_sizes >> 16u;
 
     /* Make sure the header size matches with what's defined in the makefile */
     if(header_size != MCUBOOT_HEADER_SIZE)
@@ -304,11 +524,35 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
     }
 
     /* Get the size of the image payload */
-    memcpy(&secondary_image_size, (void *) secondary_slot_start_addr + IMAGE_SIZE_OFFSET, WORD_LEN);
+    if(dfu_flash_read(secondary_slot_start_addr + IMAGE_SIZE_OFFSET, &secondary_image_size, WORD_LEN) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_DATA;
+    }
 
-    /* Get trailer start address (image size + header size) */
-    trailer_start_addr = (uint32_t) (secondary_slot_start_addr + secondary_image_size + header_size);
-    p_trailer = (uint16_t *) trailer_start_addr;
+#if defined(MCUBOOT_HW_ROLLBACK_PROT)
+    /* Check the security counter signed into the protected TLV area */
+    if(check_security_cnt(secondary_slot_start_addr, secondary_slot_start_addr + header_size + secondary_image_size,
+                          prot_tlv_size) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+#endif
+
+#if defined(DFU_CHUNK_HASH)
+    /* The chunk hashes received ahead of the image must have the signed root */
+    if(check_chunk_root(secondary_slot_start_addr + header_size, secondary_image_size, prot_tlv_size) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+#endif
+
+    /* Get trailer start address (header size + image size + protected TLV area size) */
+    trailer_start_addr = (uint32_t) (secondary_slot_start_addr + header_size + secondary_image_size + prot_tlv_size);
+    if(dfu_flash_read(trailer_start_addr, trailer, TLV_AREA_READ_SIZE) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+    p_trailer = trailer;
 
     /* Verify trailer magic */
     if(*(p_trailer + TLV_MAGIC_OFFSET) != IMAGE_TLV_INFO_MAGIC)
@@ -345,6 +589,12 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
         ++signature_length;
     }
 
+    /* The signature must be in the copied part of the TLV area */
+    if(signature_length > (TLV_AREA_READ_SIZE - (TLV_SIG_OFFSET * sizeof(uint16_t))))
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
     /* Create a buffer for the ECDSA signature */
     uint8_t ecdsa_der_signature[signature_length];
 
@@ -378,13 +628,16 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
         CY_ASSERT(crypto_status == CY_CRYPTO_SUCCESS);
     }
 
-    /* Variables to calculate the hash of image + header */
-    uint32_t message_size = secondary_image_size + header_size;
+    /* Variables to calculate the hash of header + image + protected TLV area */
+    uint32_t message_size = header_size + secondary_image_size + prot_tlv_size;
     uint8_t calc_sha256_digest[32] = {0};
     volatile uint32_t compare_result;
 
-    /* Calculate the SHA256 hash of image + header */
-    calculate_sha256_digest((uint8_t *) secondary_slot_start_addr, message_size, calc_sha256_digest);
+    /* Calculate the SHA256 hash of header + image + protected TLV area */
+    if(calculate_sha256_digest(secondary_slot_start_addr, message_size, calc_sha256_digest) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
 
     /* Check if the calculated SHA matches the one in the trailer */
     compare_result = Cy_Crypto_Core_MemCmp(CRYPTO, calc_sha256_digest, trailer_hash,
@@ -422,26 +675,362 @@ cy_en_dfu_status_t Cy_DFU_ValidateApp(uint32_t appId, cy_stc_dfu_params_t *param
     return CY_DFU_SUCCESS;
 }
 
+/******************************************************************************
+ * Function Name: check_header_row
+ ******************************************************************************
+ * Summary:
+ *  Checks the MCUboot image header in the first row of a secondary slot
+ *  before the row is written, so that an image that would fail the
+ *  validation is rejected before the rest of it is transferred. The header
+ *  must have the image magic and MCUBOOT_HEADER_SIZE, and the image must fit
+ *  in the slot. With rollback protection, the security counter derived from
+ *  the version as imgtool does with "-s auto" must not be lower than the
+ *  counter of the installed image. The result is kept for
+ *  dfu_user_header_result().
+ *
+ * Parameters:
+ *  address - Address of the row
+ *  *row - Row data
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS for an accepted header or another
+ *                       row, else CY_DFU_ERROR_DATA (magic, header size),
+ *                       CY_DFU_ERROR_LENGTH (image size) or
+ *                       CY_DFU_ERROR_VERIFY (version)
+ *
+ ******************************************************************************/
+static cy_en_dfu_status_t check_header_row(uint32_t address, const uint8_t *row)
+{
+    uint32_t image_magic, image_size, slot_room;
+    uint16_t header_size, prot_tlv_size;
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+    if (address == DFU_IMAGE_CM0P_SLOT_START)
+    {
+        slot_room = CY_BOOT_SECONDARY_1_SIZE;
+    }
+    else if (address == DFU_IMAGE_CM4_SLOT_START)
+    {
+        slot_room = CY_BOOT_SECONDARY_2_SIZE;
+    }
+    else
+    {
+        return CY_DFU_SUCCESS;
+    }
+#else
+    if (address != CY_DFU_APP1_VERIFY_START)
+    {
+        return CY_DFU_SUCCESS;
+    }
+    slot_room = CY_BOOT_SECONDARY_1_SIZE;
+#endif
+
+    (void) memcpy(&image_magic, &row[HEADER_MAGIC_OFFSET], sizeof(image_magic));
+    (void) memcpy(&header_size, &row[HEADER_SIZE_OFFSET], sizeof(header_size));
+    (void) memcpy(&prot_tlv_size, &row[HEADER_PROT_TLV_SIZE_OFFSET], sizeof(prot_tlv_size));
+    (void) memcpy(&image_size, &row[IMAGE_SIZE_OFFSET], sizeof(image_size));
+
+    dfu_header_result = DFU_HEADER_OK;
+
+    if (image_magic != IMAGE_MAGIC)
+    {
+        dfu_header_result = DFU_HEADER_BAD_MAGIC;
+        status = CY_DFU_ERROR_DATA;
+    }
+    else if (header_size != MCUBOOT_HEADER_SIZE)
+    {
+        dfu_header_result = DFU_HEADER_BAD_SIZE;
+        status = CY_DFU_ERROR_DATA;
+    }
+    else
+    {
+        /* Header, image and protected TLV area must fit in the slot */
+        slot_room -= header_size;
+        if ( (prot_tlv_size > slot_room) || (image_size > (slot_room - prot_tlv_size)) )
+        {
+            dfu_header_result = DFU_HEADER_TOO_LARGE;
+            status = CY_DFU_ERROR_LENGTH;
+        }
+#if defined(MCUBOOT_HW_ROLLBACK_PROT)
+        else
+        {
+            uint16_t revision;
+            uint32_t security_cnt;
+
+            (void) memcpy(&revision, &row[HEADER_VERSION_OFFSET + 2u], sizeof(revision));
+            security_cnt = CY_PS_SECURITY_CNT_FROM_VERSION(row[HEADER_VERSION_OFFSET],
+                                                           row[HEADER_VERSION_OFFSET + 1u], revision);
+
+            if (security_cnt < security_cnt_min(address))
+            {
+                dfu_header_result = DFU_HEADER_OLD_VERSION;
+                status = CY_DFU_ERROR_VERIFY;
+            }
+        }
+#endif
+    }
+
+    return status;
+}
+
+/******************************************************************************
+ * Function Name: erase_ranges
+ ******************************************************************************
+ * Summary:
+ *  Erases the ranges listed in a row of erase ranges. A sparse CYACD2 file
+ *  leaves out the rows that hold only the erased value and sends their
+ *  ranges ahead of the image rows, so that erasing a range does not clear
+ *  rows already written in the same external flash sector. Like the rows
+ *  written by Cy_DFU_WriteData(), a range must be in the user flash or the
+ *  external flash slot, and not in the running application.
+ *
+ * Parameters:
+ *  *row - Row data, a dfu_erase_range_row_t
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS, CY_DFU_ERROR_DATA for a bad row or
+ *                       erase error, or CY_DFU_ERROR_ADDRESS for a range out
+ *                       of the allowed memory
+ *
+ ******************************************************************************/
+static cy_en_dfu_status_t erase_ranges(const uint8_t *row)
+{
+    const uint32_t minUFlashAddress = CY_FLASH_BASE + CY_BOOT_BOOTLOADER_SIZE;
+    const uint32_t maxUFlashAddress = CY_FLASH_BASE + CY_FLASH_SIZE;
+    const uint32_t startAddress = CY_DFU_APP0_VERIFY_START;
+    const uint32_t endAddress = CY_DFU_APP0_VERIFY_START + CY_DFU_APP0_VERIFY_LENGTH;
+    const dfu_erase_range_row_t *erase_row = (const dfu_erase_range_row_t *)row;
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+    if ( (erase_row->magic != DFU_ERASE_RANGE_MAGIC) || (erase_row->count > DFU_ERASE_RANGE_MAX) )
+    {
+        return CY_DFU_ERROR_DATA;
+    }
+
+    for (uint32_t i = 0u; (i < erase_row->count) && (status == CY_DFU_SUCCESS); i++)
+    {
+        uint32_t address = erase_row->ranges[i].address;
+        uint32_t length = erase_row->ranges[i].length;
+
+        if ( (IsMultipleOf(address, CY_FLASH_SIZEOF_ROW) == 0U) || (IsMultipleOf(length, CY_FLASH_SIZEOF_ROW) == 0U) )
+        {
+            status = CY_DFU_ERROR_DATA;
+        }
+        else if ( (address < endAddress) && (startAddress < (address + length)) )
+        {   /* It is forbidden to erase the currently running application */
+            status = CY_DFU_ERROR_ADDRESS;
+        }
+        else if ( dfu_flash_is_external(address) ||
+                  ( (minUFlashAddress <= address) && (length <= (maxUFlashAddress - address)) ) )
+        {
+            status = dfu_flash_erase(address, length);
+        }
+        else
+        {
+            status = CY_DFU_ERROR_ADDRESS;
+        }
+    }
+
+    return status;
+}
+
+#if defined(MCUBOOT_HW_ROLLBACK_PROT)
+/******************************************************************************
+ * Function Name: security_cnt_min
+ ******************************************************************************
+ * Summary:
+ *  Returns the security counter that the bootloader holds for the image of a
+ *  secondary slot. The bootloader publishes the counters in the boot shared
+ *  data. The bootloader enforces the counter on its own, the DFU checks
+ *  only save transferring an image that would be rejected anyway.
+ *
+ * Parameters:
+ *  secondary_slot_start_addr - Start address of the secondary slot
+ *
+ * Return:
+ *  uint32_t - Lowest accepted security counter, 0 if none was published
+ *
+ ******************************************************************************/
+static uint32_t security_cnt_min(uint32_t secondary_slot_start_addr)
+{
+    const cy_stc_ps_boot_security_cnt_t *security_cnt = &CY_PS_BOOT_SHARED->security_cnt;
+    uint32_t image_id = 0UL;
+
+#if (MCUBOOT_IMAGE_NUMBER == 2)
+    if (secondary_slot_start_addr == DFU_IMAGE_CM4_SLOT_START)
+    {
+        image_id = 1UL;
+    }
+#else
+    (void) secondary_slot_start_addr;
+#endif
+
+    if ( (security_cnt->magic != CY_PS_BOOT_SECURITY_CNT_MAGIC) || (image_id >= security_cnt->count) )
+    {
+        return 0UL;
+    }
+
+    return security_cnt->counters[image_id];
+}
+
+/******************************************************************************
+ * Function Name: check_security_cnt
+ ******************************************************************************
+ * Summary:
+ *  Checks the security counter TLV in the protected TLV area of an image.
+ *  The TLV is covered by the image hash, which validate_image() checks.
+ *
+ * Parameters:
+ *  secondary_slot_start_addr - Start address of the secondary slot
+ *  prot_tlv_start_addr - Start address of the protected TLV area
+ *  prot_tlv_size - Size of the protected TLV area from the image header
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the counter is not lower than the
+ *                       one held by the bootloader
+ *
+ ******************************************************************************/
+static cy_en_dfu_status_t check_security_cnt(uint32_t secondary_slot_start_addr,
+        uint32_t prot_tlv_start_addr, uint32_t prot_tlv_size)
+{
+    uint32_t security_cnt;
+
+    /* An image without the security counter TLV is refused */
+    if (read_prot_tlv(prot_tlv_start_addr, prot_tlv_size, IMAGE_TLV_SEC_CNT,
+                      &security_cnt, sizeof(security_cnt)) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    return (security_cnt < security_cnt_min(secondary_slot_start_addr)) ?
+           CY_DFU_ERROR_VERIFY : CY_DFU_SUCCESS;
+}
+#endif /* MCUBOOT_HW_ROLLBACK_PROT */
+
+#if defined(DFU_CHUNK_HASH)
+/******************************************************************************
+ * Function Name: check_chunk_root
+ ******************************************************************************
+ * Summary:
+ *  Checks that the chunk hashes received ahead of an image have the Merkle
+ *  root of the chunk root TLV in the protected TLV area. The TLV is covered
+ *  by the image hash, which validate_image() checks.
+ *
+ * Parameters:
+ *  payload_addr - Start address of the image payload
+ *  payload_size - Size of the image payload from the image header
+ *  prot_tlv_size - Size of the protected TLV area from the image header
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the image was transferred without
+ *                       chunk hashes or with the chunk hashes of the image
+ *
+ ******************************************************************************/
+static cy_en_dfu_status_t check_chunk_root(uint32_t payload_addr, uint32_t payload_size,
+        uint32_t prot_tlv_size)
+{
+    CY_ALIGN(4) uint8_t root[DFU_CHUNK_HASH_SIZE];
+    bool has_root = (read_prot_tlv(payload_addr + payload_size, prot_tlv_size, IMAGE_TLV_CHUNK_ROOT,
+                                   root, sizeof(root)) == CY_DFU_SUCCESS);
+
+    return dfu_chunk_hash_check_root(payload_addr, payload_size, has_root ? root : NULL);
+}
+#endif /* DFU_CHUNK_HASH */
+
+#if defined(MCUBOOT_HW_ROLLBACK_PROT) || defined(DFU_CHUNK_HASH)
+/******************************************************************************
+ * Function Name: read_prot_tlv
+ ******************************************************************************
+ * Summary:
+ *  Reads the value of a TLV in the protected TLV area of an image.
+ *
+ * Parameters:
+ *  prot_tlv_start_addr - Start address of the protected TLV area
+ *  prot_tlv_size - Size of the protected TLV area from the image header
+ *  type - TLV type
+ *  *value - Returns the TLV value
+ *  length - Expected length of the TLV value
+ *
+ * Return:
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the TLV was found with the
+ *                       expected length, else CY_DFU_ERROR_VERIFY
+ *
+ ******************************************************************************/
+static cy_en_dfu_status_t read_prot_tlv(uint32_t prot_tlv_start_addr, uint32_t prot_tlv_size,
+        uint16_t type, void *value, uint16_t length)
+{
+#define TLV_INFO_SIZE            (4u)
+#define TLV_HEADER_SIZE          (4u)
+
+    CY_ALIGN(4) uint8_t prot_tlv[PROT_TLV_AREA_READ_SIZE];
+    uint32_t offset = TLV_INFO_SIZE;
+    uint16_t tlv_type, tlv_len;
+
+    /* An image without the protected TLV area has no such TLV */
+    if ( (prot_tlv_size < (TLV_INFO_SIZE + TLV_HEADER_SIZE + length)) ||
+         (prot_tlv_size > PROT_TLV_AREA_READ_SIZE) )
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    if (dfu_flash_read(prot_tlv_start_addr, prot_tlv, prot_tlv_size) != CY_DFU_SUCCESS)
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    /* The info header holds the magic and the size of the whole area */
+    (void) memcpy(&tlv_type, &prot_tlv[0], sizeof(tlv_type));
+    (void) memcpy(&tlv_len, &prot_tlv[2], sizeof(tlv_len));
+    if ( (tlv_type != IMAGE_TLV_PROT_INFO_MAGIC) || (tlv_len != prot_tlv_size) )
+    {
+        return CY_DFU_ERROR_VERIFY;
+    }
+
+    while ((offset + TLV_HEADER_SIZE) <= prot_tlv_size)
+    {
+        (void) memcpy(&tlv_type, &prot_tlv[offset], sizeof(tlv_type));
+        (void) memcpy(&tlv_len, &prot_tlv[offset + 2u], sizeof(tlv_len));
+        offset += TLV_HEADER_SIZE;
+
+        if ( (tlv_type == type) && (tlv_len == length) && ((offset + length) <= prot_tlv_size) )
+        {
+            (void) memcpy(value, &prot_tlv[offset], length);
+
+            return CY_DFU_SUCCESS;
+        }
+
+        offset += tlv_len;
+    }
+
+    return CY_DFU_ERROR_VERIFY;
+}
+#endif
+
 /******************************************************************************
  * Function Name: calculate_sha256_digest
  ******************************************************************************
  * Summary:
- *  This function calculates the SHA256 digest.
+ *  This function calculates the SHA256 digest. The message is read through
+ *  the DFU flash layer one chunk at a time, so that it can be in the external
+ *  flash.
  *
  * Parameters:
- *  *message_start_addr - Starting address of the message to be hashed
+ *  message_start_addr - Starting address of the message to be hashed
  *  message_size - The size of the message
  *  *calc_sha256_digest - Stores the result of the SHA256 hash operation
  *
  * Return:
- *  void
+ *  cy_en_dfu_status_t - CY_DFU_SUCCESS if the digest was calculated
  *
  ******************************************************************************/
-static void calculate_sha256_digest(uint8_t* message_start_addr, uint32_t message_size, uint8_t* calc_sha256_digest)
+static cy_en_dfu_status_t calculate_sha256_digest(uint32_t message_start_addr, uint32_t message_size, uint8_t* calc_sha256_digest)
 {
     cy_stc_crypto_sha_state_t hash_state = { 0 };
-    uint8_t* message_ptr;
-    message_ptr = (uint8_t *) message_start_addr;
+    uint32_t message_addr = message_start_addr;
+
+    /* Chunk of the message being hashed */
+    CY_ALIGN(4) static uint8_t message_chunk[SHA256_READ_CHUNK_SIZE];
 
 #if defined(CY_CRYPTO_CFG_HW_V2_ENABLE)
     cy_stc_crypto_v2_sha256_buffers_t sha_256_buffers = {0};
@@ -463,12 +1052,18 @@ static void calculate_sha256_digest(uint8_t* message_start_addr, uint32_t messag
     /* Process all chunks of the message */
     while ((message_size != 0) && (CY_CRYPTO_SUCCESS == crypto_status))
     {
-        uint32_t chunk_size = (message_size >= CY_CRYPTO_SHA256_BLOCK_SIZE) ?
-        CY_CRYPTO_SHA256_BLOCK_SIZE : message_size;
+        uint32_t chunk_size = (message_size >= SHA256_READ_CHUNK_SIZE) ?
+        SHA256_READ_CHUNK_SIZE : message_size;
 
-        crypto_status = Cy_Crypto_Core_Sha_Update(CRYPTO, &hash_state, message_ptr, chunk_size);
+        if (dfu_flash_read(message_addr, message_chunk, chunk_size) != CY_DFU_SUCCESS)
+        {
+            crypto_status = CY_CRYPTO_HW_ERROR;
+            break;
+        }
 
-        message_ptr += chunk_size;
+        crypto_status = Cy_Crypto_Core_Sha_Update(CRYPTO, &hash_state, message_chunk, chunk_size);
+
+        message_addr += chunk_size;
         message_size -= chunk_size;
     }
 
@@ -483,6 +1078,8 @@ static void calculate_sha256_digest(uint8_t* message_start_addr, uint32_t messag
     {
         crypto_status = Cy_Crypto_Core_Sha_Free(CRYPTO, &hash_state);
     }
+
+    return (CY_CRYPTO_SUCCESS == crypto_status) ? CY_DFU_SUCCESS : CY_DFU_ERROR_VERIFY;
 }
 
 /******************************************************************************
@@ -111,8 +111,14 @@ extern "C" {
 /* A non-zero value enables the Get Metadata DFU command */
 #define CY_DFU_OPT_GET_METADATA    (0)
 
-/* A non-zero value enables the Set EI Vector DFU command */
+/* A non-zero value enables the Set EI Vector DFU command. The encrypted DFU
+ * images use it to send the wrapped image key, see dfu_decrypt.c.
+ */
+#if defined(DFU_ENCRYPTION)
+#define CY_DFU_OPT_SET_EIVECTOR    (1)
+#else
 #define CY_DFU_OPT_SET_EIVECTOR    (0)
+#endif
 
 /*
 * A non-zero value allows writing metadata
@@ -129,16 +135,20 @@ extern "C" {
 /* MCUBoot specific macros */
 #define IMAGE_MAGIC                 0x96F3B83D
 #define IMAGE_TLV_INFO_MAGIC        0x6907
+#define IMAGE_TLV_PROT_INFO_MAGIC   0x6908
 #define IMAGE_TLV_KEYHASH           0x01   /* hash of the public key */
 #define IMAGE_TLV_SHA256            0x10   /* SHA256 of image hdr and body */
 #define IMAGE_TLV_ECDSA256          0x22   /* ECDSA of hash output */
+#define IMAGE_TLV_SEC_CNT           0x50   /* security counter */
 
 /* Header macros */
 #define HEADER_MAGIC_OFFSET        (0x00)
 #define HEADER_LOAD_ADDR_OFFSET    (0x04)
 #define HEADER_SIZE_OFFSET         (0x08)
+#define HEADER_PROT_TLV_SIZE_OFFSET (0x0A)
 #define IMAGE_SIZE_OFFSET          (0x0C)
 #define PAYLOAD_OFFSET             (0x10)
+#define HEADER_VERSION_OFFSET      (0x14)
 
 /* Trailer macros */
 #define TLV_MAGIC_OFFSET           (0u)
@@ -153,6 +163,56 @@ extern "C" {
 #define TLV_SIG_LEN_OFFSET         (39u)
 #define TLV_SIG_OFFSET             (40u)
 
+/* Bytes of the TLV area copied for validation: the hash, key hash and
+ * signature TLVs with the longest DER encoded ECDSA P-256 signature.
+ */
+#define TLV_AREA_READ_SIZE         (160u)
+
+/* Bytes of the protected TLV area copied for validation: the dependency,
+ * security counter and chunk root TLVs.
+ */
+#define PROT_TLV_AREA_READ_SIZE    (64u)
+
+/* Size of the chunks read from the secondary slot to hash the image */
+#define SHA256_READ_CHUNK_SIZE     (512u)
+
+/* Rows left out of a sparse CYACD2 file (hextocyacd2.py -erased) because
+ * they hold only the erased value are erased instead of written. The file
+ * lists their ranges in rows at this unmapped address, ahead of the image
+ * rows.
+ */
+#define DFU_ERASE_RANGE_ADDR       (0x60010000UL)
+#define DFU_ERASE_RANGE_ROWS       (16u)
+#define DFU_ERASE_RANGE_MAGIC      (0x31535245UL)  /* "ERS1" */
+#define DFU_ERASE_RANGE_MAX        ((CY_FLASH_SIZEOF_ROW - 8u) / 8u)
+
+/* Row of erase ranges */
+typedef struct
+{
+    uint32_t magic;                     /* DFU_ERASE_RANGE_MAGIC */
+    uint32_t count;                     /* Number of ranges used */
+    struct
+    {
+        uint32_t address;               /* Start address, row aligned */
+        uint32_t length;                /* Number of bytes, whole rows */
+    } ranges[DFU_ERASE_RANGE_MAX];
+} dfu_erase_range_row_t;
+
+/* Result of the image header check done when the first row of a secondary
+ * slot is written, before the rest of the image is transferred.
+ */
+typedef enum
+{
+    DFU_HEADER_OK = 0,                  /* Header accepted */
+    DFU_HEADER_BAD_MAGIC,               /* No MCUboot image header at the start of the slot */
+    DFU_HEADER_BAD_SIZE,                /* Header size differs from MCUBOOT_HEADER_SIZE */
+    DFU_HEADER_TOO_LARGE,               /* Image does not fit in the slot */
+    DFU_HEADER_OLD_VERSION              /* Security counter lower than the installed image */
+} dfu_header_result_t;
+
+dfu_header_result_t dfu_user_header_result(void);
+uint32_t dfu_user_validated_images(void);
+
 #if !defined(CY_DOXYGEN)
     #if defined(__ARMCC_VERSION)
         #include "dfu_common.h"
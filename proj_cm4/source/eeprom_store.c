@@ -0,0 +1,563 @@
+/******************************************************************************
+* File Name:   eeprom_store.c
+*
+* Description: This file contains a wear-leveled record store for the
+*              emulated EEPROM flash region (CY_EM_EEPROM_BASE). Records are
+*              cached in RAM, small writes are batched, and the batches are
+*              appended to the region one row at a time in a circular order so
+*              that every row wears at the same rate.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "eeprom_store.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define EEPROM_STORE_ROW_MAGIC          (0x45455331UL)  /* "EES1", changes with the row layout */
+#define EEPROM_STORE_ROW_HDR_SIZE       (20u)
+#define EEPROM_STORE_PAYLOAD_SIZE       (CY_FLASH_SIZEOF_ROW - EEPROM_STORE_ROW_HDR_SIZE)
+
+/* Each record in a row is stored as ID, length and data bytes */
+#define EEPROM_STORE_ENTRY_HDR_SIZE     (2u)
+
+#define EEPROM_STORE_CRC32_POLY         (0xEDB88320UL)
+
+/* All the records must fit in the rows that are not being recycled */
+_Static_assert((EEPROM_STORE_MAX_RECORDS * (EEPROM_STORE_ENTRY_HDR_SIZE + EEPROM_STORE_MAX_RECORD_SIZE)) <
+                 ((EEPROM_STORE_ROWS - 1u) * EEPROM_STORE_PAYLOAD_SIZE), "Emulated EEPROM region is too small");
+_Static_assert(EEPROM_STORE_MAX_RECORDS <= 32u, "Dirty flags are stored in a 32-bit mask");
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Layout of one row in flash */
+typedef struct
+{
+    uint32_t magic;                     /* EEPROM_STORE_ROW_MAGIC */
+    uint32_t seq;                       /* Row sequence number, row = (seq - 1) % rows */
+    uint32_t erase_count;               /* Number of times this row has been written */
+    uint16_t payload_len;               /* Number of used payload bytes */
+    uint16_t reserved;
+    uint32_t crc;                       /* CRC32 of the header fields above and the payload */
+    uint8_t  payload[EEPROM_STORE_PAYLOAD_SIZE];
+} eeprom_store_row_t;
+
+_Static_assert(sizeof(eeprom_store_row_t) == CY_FLASH_SIZEOF_ROW, "EEPROM row must be one flash row");
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* RAM lookup cache holding the latest value of every record */
+static uint8_t cache_len[EEPROM_STORE_MAX_RECORDS];
+static uint8_t cache_data[EEPROM_STORE_MAX_RECORDS][EEPROM_STORE_MAX_RECORD_SIZE];
+
+/* Sequence number of the row holding the latest flash copy of a record,
+ * 0 if the record is not in flash.
+ */
+static uint32_t cache_seq[EEPROM_STORE_MAX_RECORDS];
+
+/* Records updated in the cache but not yet written to flash */
+static uint32_t dirty_mask;
+
+/* Erase counter of every row */
+static uint32_t erase_count[EEPROM_STORE_ROWS];
+
+/* Sequence number of the next row to be written */
+static uint32_t next_seq = 1u;
+
+/* Row buffer used for programming */
+static eeprom_store_row_t row_buf;
+
+/*******************************************************************************
+ * Function Name: eeprom_store_crc32
+ ********************************************************************************
+ * Summary:
+ *   Calculates the CRC32 (IEEE 802.3) of a buffer. The result of a previous
+ *   call can be passed as the initial value to continue the calculation.
+ *
+ * Parameters:
+ *   crc  - CRC of the preceding data or 0
+ *   data - Pointer to the data
+ *   size - Number of bytes
+ *
+ * Return:
+ *   uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t eeprom_store_crc32(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    crc = ~crc;
+
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1u) ^ (EEPROM_STORE_CRC32_POLY & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_row_crc
+ ********************************************************************************
+ * Summary:
+ *   Calculates the CRC of a row, excluding the CRC field itself.
+ *
+ * Parameters:
+ *   row - Pointer to the row
+ *
+ * Return:
+ *   uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t eeprom_store_row_crc(const eeprom_store_row_t *row)
+{
+    uint32_t crc = eeprom_store_crc32(0u, (const uint8_t *)row, offsetof(eeprom_store_row_t, crc));
+
+    return eeprom_store_crc32(crc, row->payload, sizeof(row->payload));
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_row_addr
+ ********************************************************************************
+ * Summary:
+ *   Returns the flash address of the row holding a sequence number.
+ *
+ * Parameters:
+ *   seq - Row sequence number
+ *
+ * Return:
+ *   const eeprom_store_row_t* - Pointer to the row in flash
+ *
+ *******************************************************************************/
+static const eeprom_store_row_t *eeprom_store_row_addr(uint32_t seq)
+{
+    uint32_t row = (seq - 1u) % EEPROM_STORE_ROWS;
+
+    return (const eeprom_store_row_t *)(CY_EM_EEPROM_BASE + (row * CY_FLASH_SIZEOF_ROW));
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_row_is_valid
+ ********************************************************************************
+ * Summary:
+ *   Checks whether the row at the position of a sequence number was
+ *   completely written with that sequence number.
+ *
+ * Parameters:
+ *   seq - Expected row sequence number
+ *
+ * Return:
+ *   bool - true if the row is valid
+ *
+ *******************************************************************************/
+static bool eeprom_store_row_is_valid(uint32_t seq)
+{
+    const eeprom_store_row_t *row = eeprom_store_row_addr(seq);
+
+    return (seq != 0u) &&
+           (row->magic == EEPROM_STORE_ROW_MAGIC) &&
+           (row->seq == seq) &&
+           (row->payload_len <= EEPROM_STORE_PAYLOAD_SIZE) &&
+           (row->crc == eeprom_store_row_crc(row));
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_next_entry
+ ********************************************************************************
+ * Summary:
+ *   Returns the offset of the next well-formed record entry in a row payload.
+ *
+ * Parameters:
+ *   row    - Pointer to the row
+ *   offset - Offset of the current entry
+ *
+ * Return:
+ *   uint32_t - Offset of the next entry, or the payload length if there are
+ *   no more entries
+ *
+ *******************************************************************************/
+static uint32_t eeprom_store_next_entry(const eeprom_store_row_t *row, uint32_t offset)
+{
+    uint32_t next = offset + EEPROM_STORE_ENTRY_HDR_SIZE + row->payload[offset + 1u];
+
+    return (next <= row->payload_len) ? next : row->payload_len;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_entry_is_valid
+ ********************************************************************************
+ * Summary:
+ *   Checks the ID and length of the record entry at an offset of a row.
+ *
+ * Parameters:
+ *   row    - Pointer to the row
+ *   offset - Offset of the entry
+ *
+ * Return:
+ *   bool - true if the entry is valid
+ *
+ *******************************************************************************/
+static bool eeprom_store_entry_is_valid(const eeprom_store_row_t *row, uint32_t offset)
+{
+    return ((offset + EEPROM_STORE_ENTRY_HDR_SIZE) <= row->payload_len) &&
+           (row->payload[offset] < EEPROM_STORE_MAX_RECORDS) &&
+           (row->payload[offset + 1u] <= EEPROM_STORE_MAX_RECORD_SIZE) &&
+           ((offset + EEPROM_STORE_ENTRY_HDR_SIZE + row->payload[offset + 1u]) <= row->payload_len);
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_write_row
+ ********************************************************************************
+ * Summary:
+ *   Programs the next row in the circular order. The row following the one
+ *   being written is the oldest one and is recycled by the next call, so its
+ *   live records are copied into this row first. This keeps the next row to
+ *   be erased free of live data, and a reset during the row program loses
+ *   nothing. The remaining space is filled with dirty records.
+ *
+ * Return:
+ *   eeprom_store_status_t - EEPROM_STORE_SUCCESS or EEPROM_STORE_ERR_FLASH
+ *
+ *******************************************************************************/
+static eeprom_store_status_t eeprom_store_write_row(void)
+{
+    uint32_t seq = next_seq;
+    uint32_t row = (seq - 1u) % EEPROM_STORE_ROWS;
+    uint32_t oldest_seq = seq + 1u - EEPROM_STORE_ROWS;
+    uint32_t written_mask = 0u;
+
+    (void)memset(&row_buf, 0, sizeof(row_buf));
+
+    /* Carry forward the live records of the oldest row as they are */
+    if ((seq >= EEPROM_STORE_ROWS) && eeprom_store_row_is_valid(oldest_seq))
+    {
+        const eeprom_store_row_t *oldest = eeprom_store_row_addr(oldest_seq);
+
+        for (uint32_t offset = 0u; eeprom_store_entry_is_valid(oldest, offset);
+             offset = eeprom_store_next_entry(oldest, offset))
+        {
+            uint8_t id = oldest->payload[offset];
+            uint32_t entry_size = EEPROM_STORE_ENTRY_HDR_SIZE + oldest->payload[offset + 1u];
+
+            if (cache_seq[id] != oldest_seq)
+            {
+                continue;
+            }
+
+            if (oldest->payload[offset + 1u] == 0u)
+            {
+                /* No older copy is left for a deleted record to hide */
+                cache_seq[id] = 0u;
+                continue;
+            }
+
+            (void)memcpy(&row_buf.payload[row_buf.payload_len], &oldest->payload[offset], entry_size);
+            row_buf.payload_len += entry_size;
+            written_mask |= (1UL << id);
+        }
+    }
+
+    /* Fill the rest of the row with dirty records */
+    for (uint8_t id = 0u; id < EEPROM_STORE_MAX_RECORDS; id++)
+    {
+        uint32_t entry_size = EEPROM_STORE_ENTRY_HDR_SIZE + cache_len[id];
+
+        if (((dirty_mask & (1UL << id)) != 0u) && ((row_buf.payload_len + entry_size) <= EEPROM_STORE_PAYLOAD_SIZE))
+        {
+            row_buf.payload[row_buf.payload_len] = id;
+            row_buf.payload[row_buf.payload_len + 1u] = cache_len[id];
+            (void)memcpy(&row_buf.payload[row_buf.payload_len + EEPROM_STORE_ENTRY_HDR_SIZE], cache_data[id], cache_len[id]);
+            row_buf.payload_len += entry_size;
+            written_mask |= (1UL << id);
+        }
+    }
+
+    row_buf.magic = EEPROM_STORE_ROW_MAGIC;
+    row_buf.seq = seq;
+    row_buf.erase_count = erase_count[row] + 1u;
+    row_buf.crc = eeprom_store_row_crc(&row_buf);
+
+    if (CY_FLASH_DRV_SUCCESS != Cy_Flash_WriteRow((uint32_t)eeprom_store_row_addr(seq), (const uint32_t *)&row_buf))
+    {
+        return EEPROM_STORE_ERR_FLASH;
+    }
+
+    erase_count[row]++;
+    next_seq++;
+
+    for (uint8_t id = 0u; id < EEPROM_STORE_MAX_RECORDS; id++)
+    {
+        if ((written_mask & (1UL << id)) != 0u)
+        {
+            cache_seq[id] = seq;
+        }
+    }
+
+    /* Dirty records that were only carried forward with their old value stay dirty */
+    for (uint32_t offset = 0u; eeprom_store_entry_is_valid(&row_buf, offset);
+         offset = eeprom_store_next_entry(&row_buf, offset))
+    {
+        uint8_t id = row_buf.payload[offset];
+
+        if ((row_buf.payload[offset + 1u] == cache_len[id]) &&
+            (memcmp(&row_buf.payload[offset + EEPROM_STORE_ENTRY_HDR_SIZE], cache_data[id], cache_len[id]) == 0))
+        {
+            dirty_mask &= ~(1UL << id);
+        }
+    }
+
+    return EEPROM_STORE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_init
+ ********************************************************************************
+ * Summary:
+ *   Loads the records and the row erase counters from flash. Must be called
+ *   once before using the other functions.
+ *
+ * Return:
+ *   eeprom_store_status_t - EEPROM_STORE_SUCCESS
+ *
+ *******************************************************************************/
+eeprom_store_status_t eeprom_store_init(void)
+{
+    uint32_t head_seq = 0u;
+    uint32_t max_erase_count = 0u;
+    uint32_t first_seq;
+
+    (void)memset(cache_len, 0, sizeof(cache_len));
+    (void)memset(cache_data, 0, sizeof(cache_data));
+    (void)memset(cache_seq, 0, sizeof(cache_seq));
+    dirty_mask = 0u;
+
+    /* Find the newest row and read the erase counters */
+    for (uint32_t row = 0u; row < EEPROM_STORE_ROWS; row++)
+    {
+        const eeprom_store_row_t *row_addr = (const eeprom_store_row_t *)(CY_EM_EEPROM_BASE + (row * CY_FLASH_SIZEOF_ROW));
+
+        erase_count[row] = 0u;
+
+        if ((((row_addr->seq - 1u) % EEPROM_STORE_ROWS) == row) && eeprom_store_row_is_valid(row_addr->seq))
+        {
+            erase_count[row] = row_addr->erase_count;
+            max_erase_count = (row_addr->erase_count > max_erase_count) ? row_addr->erase_count : max_erase_count;
+            head_seq = (row_addr->seq > head_seq) ? row_addr->seq : head_seq;
+        }
+    }
+
+    /* The counter of a row torn by a reset is lost, assume the worst case */
+    for (uint32_t row = 0u; (head_seq != 0u) && (row < EEPROM_STORE_ROWS); row++)
+    {
+        if (erase_count[row] == 0u)
+        {
+            erase_count[row] = ((row < head_seq) ? max_erase_count : 0u);
+        }
+    }
+
+    /* Replay the rows from the oldest to the newest */
+    first_seq = (head_seq >= EEPROM_STORE_ROWS) ? (head_seq - EEPROM_STORE_ROWS + 1u) : 1u;
+    for (uint32_t seq = first_seq; seq <= head_seq; seq++)
+    {
+        const eeprom_store_row_t *row = eeprom_store_row_addr(seq);
+
+        if (!eeprom_store_row_is_valid(seq))
+        {
+            continue;
+        }
+
+        for (uint32_t offset = 0u; eeprom_store_entry_is_valid(row, offset);
+             offset = eeprom_store_next_entry(row, offset))
+        {
+            uint8_t id = row->payload[offset];
+
+            cache_len[id] = row->payload[offset + 1u];
+            (void)memcpy(cache_data[id], &row->payload[offset + EEPROM_STORE_ENTRY_HDR_SIZE], cache_len[id]);
+            cache_seq[id] = seq;
+        }
+    }
+
+    next_seq = head_seq + 1u;
+
+    return EEPROM_STORE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_read
+ ********************************************************************************
+ * Summary:
+ *   Reads a record from the RAM cache, including updates that have not been
+ *   flushed yet.
+ *
+ * Parameters:
+ *   id     - Record ID
+ *   data   - Buffer to store the record data
+ *   length - In: size of the buffer. Out: length of the record.
+ *
+ * Return:
+ *   eeprom_store_status_t - EEPROM_STORE_SUCCESS, EEPROM_STORE_ERR_PARAM or
+ *   EEPROM_STORE_ERR_NOT_FOUND
+ *
+ *******************************************************************************/
+eeprom_store_status_t eeprom_store_read(uint8_t id, uint8_t *data, uint8_t *length)
+{
+    if ((id >= EEPROM_STORE_MAX_RECORDS) || (data == NULL) || (length == NULL))
+    {
+        return EEPROM_STORE_ERR_PARAM;
+    }
+
+    if (cache_len[id] == 0u)
+    {
+        return EEPROM_STORE_ERR_NOT_FOUND;
+    }
+
+    if (*length < cache_len[id])
+    {
+        return EEPROM_STORE_ERR_PARAM;
+    }
+
+    (void)memcpy(data, cache_data[id], cache_len[id]);
+    *length = cache_len[id];
+
+    return EEPROM_STORE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_write
+ ********************************************************************************
+ * Summary:
+ *   Updates a record in the RAM cache. A length of zero deletes the record.
+ *   The update is written to flash together with other pending updates by
+ *   eeprom_store_flush(), or as soon as the pending updates fill a row.
+ *   Writing the value a record already has does not touch the flash.
+ *
+ * Parameters:
+ *   id     - Record ID
+ *   data   - Record data
+ *   length - Length of the record data
+ *
+ * Return:
+ *   eeprom_store_status_t - EEPROM_STORE_SUCCESS, EEPROM_STORE_ERR_PARAM or
+ *   EEPROM_STORE_ERR_FLASH
+ *
+ *******************************************************************************/
+eeprom_store_status_t eeprom_store_write(uint8_t id, const uint8_t *data, uint8_t length)
+{
+    uint32_t pending = 0u;
+
+    if ((id >= EEPROM_STORE_MAX_RECORDS) || (length > EEPROM_STORE_MAX_RECORD_SIZE) ||
+        ((length != 0u) && (data == NULL)))
+    {
+        return EEPROM_STORE_ERR_PARAM;
+    }
+
+    if ((length == cache_len[id]) && ((length == 0u) || (memcmp(data, cache_data[id], length) == 0)))
+    {
+        return EEPROM_STORE_SUCCESS;
+    }
+
+    cache_len[id] = length;
+    if (length != 0u)
+    {
+        (void)memcpy(cache_data[id], data, length);
+    }
+    dirty_mask |= (1UL << id);
+
+    for (uint8_t i = 0u; i < EEPROM_STORE_MAX_RECORDS; i++)
+    {
+        if ((dirty_mask & (1UL << i)) != 0u)
+        {
+            pending += EEPROM_STORE_ENTRY_HDR_SIZE + cache_len[i];
+        }
+    }
+
+    return (pending >= EEPROM_STORE_PAYLOAD_SIZE) ? eeprom_store_flush() : EEPROM_STORE_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_flush
+ ********************************************************************************
+ * Summary:
+ *   Writes all the pending updates to flash.
+ *
+ * Return:
+ *   eeprom_store_status_t - EEPROM_STORE_SUCCESS or EEPROM_STORE_ERR_FLASH
+ *
+ *******************************************************************************/
+eeprom_store_status_t eeprom_store_flush(void)
+{
+    eeprom_store_status_t status = EEPROM_STORE_SUCCESS;
+
+    while ((dirty_mask != 0u) && (status == EEPROM_STORE_SUCCESS))
+    {
+        status = eeprom_store_write_row();
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: eeprom_store_get_erase_count
+ ********************************************************************************
+ * Summary:
+ *   Returns the number of times a row of the store has been erased and
+ *   programmed.
+ *
+ * Parameters:
+ *   row - Row index, 0 to EEPROM_STORE_ROWS - 1
+ *
+ * Return:
+ *   uint32_t - The erase counter, 0 for an invalid row index
+ *
+ *******************************************************************************/
+uint32_t eeprom_store_get_erase_count(uint32_t row)
+{
+    return (row < EEPROM_STORE_ROWS) ? erase_count[row] : 0u;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name:   eeprom_store.h
+*
+* Description: This file contains definitions of constants, structures and
+*              function prototypes for the wear-leveled record store in the
+*              emulated EEPROM flash region.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef EEPROM_STORE_H
+#define EEPROM_STORE_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of flash rows used by the store */
+#define EEPROM_STORE_ROWS               (CY_EM_EEPROM_SIZE / CY_FLASH_SIZEOF_ROW)
+
+/* Number of records that can be held in the store */
+#define EEPROM_STORE_MAX_RECORDS        (32u)
+
+/* Maximum size of a single record in bytes */
+#define EEPROM_STORE_MAX_RECORD_SIZE    (32u)
+
+/* Record IDs used by this application */
+#define EEPROM_STORE_ID_DFU_COUNT       (0u)    /* Number of successful DFU transfers */
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef enum
+{
+    EEPROM_STORE_SUCCESS = 0,           /* Operation completed successfully */
+    EEPROM_STORE_ERR_PARAM,             /* Invalid record ID or size */
+    EEPROM_STORE_ERR_NOT_FOUND,         /* The requested record is empty */
+    EEPROM_STORE_ERR_FLASH              /* Flash row write failed */
+} eeprom_store_status_t;
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+eeprom_store_status_t eeprom_store_init(void);
+eeprom_store_status_t eeprom_store_read(uint8_t id, uint8_t *data, uint8_t *length);
+eeprom_store_status_t eeprom_store_write(uint8_t id, const uint8_t *data, uint8_t length);
+eeprom_store_status_t eeprom_store_flush(void);
+uint32_t eeprom_store_get_erase_count(uint32_t row);
+
+#endif /* EEPROM_STORE_H */
+
+/* [] END OF FILE */
@@ -40,7 +40,10 @@
 *******************************************************************************/
 
 /* Include header files */
+#include <string.h>
 #include "cy_pdl.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include "ipc_communication.h"
 
 /*******************************************************************************
@@ -48,6 +51,17 @@
  ******************************************************************************/
 extern void cm4_msg_callback(void);
 
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Record write request, the CM0+ app only accepts requests in the shared SRAM */
+CY_SECTION(".shared_ram") static ipc_write_record_t record_request;
+
+/* True while the CM0+ app may still be reading record_request. The shared
+ * SRAM is not initialized, so its status is only valid after a request.
+ */
+static bool record_request_busy = false;
+
 /*******************************************************************************
  * Function Name: ipc_send_msg_to_cm0p
  ********************************************************************************
@@ -105,9 +119,91 @@ uint32_t ipc_rcv_msg_from_cm0p(void)
         CY_ASSERT(0);
     }
 
+    /* Release the channel so that the CM0p can send the next message */
+    (void)Cy_IPC_Drv_LockRelease(ipc_intr_cm4_addr, CY_IPC_NO_NOTIFICATION);
+
     return message;
 }
 
+/*******************************************************************************
+ * Function Name: ipc_wait_record
+ ********************************************************************************
+ * Summary:
+ *   Waits for the CM0+ app to complete the record write request. The calling
+ *   task sleeps between the checks, so the other tasks keep running.
+ *
+ * Return:
+ *   bool - true if no request is pending
+ *
+ *******************************************************************************/
+static bool ipc_wait_record(void)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (record_request_busy && (record_request.status == IPC_STATUS_PENDING) &&
+           ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(IPC_RECORD_TIMEOUT_MS)))
+    {
+        vTaskDelay(1u);
+    }
+
+    if (record_request.status != IPC_STATUS_PENDING)
+    {
+        record_request_busy = false;
+    }
+
+    return !record_request_busy;
+}
+
+/*******************************************************************************
+ * Function Name: ipc_write_record
+ ********************************************************************************
+ * Summary:
+ *   Asks the CM0+ app to write a record to the protected storage, which the
+ *   CM4 cannot write itself, and waits for the result. Must be called from a
+ *   task. A request that timed out is waited for again before the request
+ *   buffer is reused; the write is refused if it is still pending.
+ *
+ * Parameters:
+ *   id     - Record ID, IPC_RECORD_ID_CM4_FIRST or higher
+ *   data   - Record data
+ *   length - Number of data bytes, up to IPC_RECORD_SIZE. Zero deletes the
+ *            record.
+ *
+ * Return:
+ *   bool - true if the record was written
+ *
+ *******************************************************************************/
+bool ipc_write_record(uint8_t id, const uint8_t *data, uint8_t length)
+{
+    if ((length > IPC_RECORD_SIZE) || ((length != 0u) && (data == NULL)))
+    {
+        return false;
+    }
+
+    /* The CM0+ app may still be committing the previous request */
+    if (!ipc_wait_record())
+    {
+        return false;
+    }
+
+    record_request.cmd = IPC_CMD_WRITE_RECORD;
+    record_request.status = IPC_STATUS_PENDING;
+    record_request.id = id;
+    record_request.length = length;
+    (void)memset(record_request.data, 0, IPC_RECORD_SIZE);
+    if (length != 0u)
+    {
+        (void)memcpy(record_request.data, data, length);
+    }
+
+    /* Make the request visible to the CM0+ before it is notified */
+    __DSB();
+    record_request_busy = true;
+    ipc_send_msg_to_cm0p((uint32_t)&record_request);
+
+    return (ipc_wait_record() && (record_request.status == IPC_STATUS_DONE));
+}
+
 /*******************************************************************************
  * Function Name: setup_ipc_communication_cm4
  ********************************************************************************
@@ -67,15 +67,63 @@
 #define IPC_CH1_INTR_ACQUIRE_MASK       (1UL << CM4_IPC_INT_STRUCT_NUM)
 
 #define IPC_CMD_READ_DATA               0x01
+#define IPC_CMD_UNWRAP_KEY              0x02
+#define IPC_CMD_WRITE_RECORD            0x03
+
+/* Status of a request placed in the shared SRAM */
+#define IPC_STATUS_PENDING              (0u)
+#define IPC_STATUS_DONE                 (1u)
+#define IPC_STATUS_ERROR                (2u)
+
+#define IPC_KEY_SIZE                    (16u)
+
+/* Protected storage records. The CM4 can only write the records from
+ * IPC_RECORD_ID_CM4_FIRST on, the lower IDs are kept for the CM0+ app.
+ */
+#define IPC_RECORD_SIZE                 (28u)
+#define IPC_RECORD_ID_CM4_FIRST         (8u)
+#define IPC_RECORD_ID_DFU_HISTORY       (IPC_RECORD_ID_CM4_FIRST)
+
+/* Time the CM0+ app gets to write a record */
+#define IPC_RECORD_TIMEOUT_MS           (100u)
 
 #define IPC_INTR_PRIORITY               (3)
 
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Key unwrap request. Commands that carry data are placed in the shared SRAM
+ * and the message word holds the address of the request. The CM0+ app
+ * replaces the wrapped key with the unwrapped key and then sets the status.
+ */
+typedef struct
+{
+    uint32_t cmd;                       /* IPC_CMD_UNWRAP_KEY */
+    volatile uint32_t status;           /* IPC_STATUS_xxx */
+    uint8_t key[IPC_KEY_SIZE];          /* Wrapped key in, unwrapped key out */
+} ipc_unwrap_key_t;
+
+/* Protected storage record write request. The CM0+ app writes the record to
+ * the journal of the protected storage and then sets the status. A length
+ * of zero deletes the record.
+ */
+typedef struct
+{
+    uint32_t cmd;                       /* IPC_CMD_WRITE_RECORD */
+    volatile uint32_t status;           /* IPC_STATUS_xxx */
+    uint8_t id;                         /* Record ID */
+    uint8_t length;                     /* Number of data bytes */
+    uint8_t reserved[2];
+    uint8_t data[IPC_RECORD_SIZE];
+} ipc_write_record_t;
+
 /*******************************************************************************
 * Function prototypes
 *******************************************************************************/
 void setup_ipc_communication_cm4(void);
 void ipc_send_msg_to_cm0p(uint32_t message);
 uint32_t ipc_rcv_msg_from_cm0p(void);
+bool ipc_write_record(uint8_t id, const uint8_t *data, uint8_t length);
 
 #endif /* IPC_COMMUNICATION_H */
 
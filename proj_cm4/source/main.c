@@ -55,45 +55,31 @@
 /* User task header files */
 #include "dfu_task.h"
 
-#define CY_RMA_OPCODE                       (0x28000000UL)                      /* The SROM API opcode for RMA lifecycle stage conversion */
-#define CY_RMA_CMD_ID                       (0x120028F0UL)
-#define CY_OPCODE_SUCCESS                   (0xA0000000UL)                      /* The command completed with no errors */
-#define CY_OPCODE_STS_Msk                   (0xF0000000UL)                      /* The status mask of the SROM API return value */
-#define CY_IPC_STRUCT                       (Cy_IPC_Drv_GetIpcBaseAddress(CY_IPC_CHAN_SYSCALL)) /* IPC structure to be used */
-#define CY_IPC_NOTIFY_STRUCT0               (0x1UL << CY_IPC_INTR_SYSCALL1)     /* IPC notify bit for IPC_STRUCT0 (dedicated to System Call) */
-#define CY_RMA_OBJECT_SIZE                  (20 + 256)                           /* 20 bytes - fixed object size + 256 bytes of signature (can go upto 256 bytes)*/
+/* RMA certificate check and transition */
+#include "rma.h"
 
-#define CY_READ_UID_OPCODE                  (0x1F000000UL)                      /* The SROM API opcode to read Unique ID */
+/* Asynchronous SROM system calls */
+#include "srom_syscall.h"
+
+/* FreeRTOS run-time statistics report */
+#include "rtos_stats.h"
+
+/* Data handed over by the bootloader */
+#include "../proj_btldr_cm0p/source/cy_ps_boot_shared.h"
 
 #define SUCCESS                             (0)
 #define FAILED                              (!SUCCESS)
 
-#define PROTECTED_MEM_SIZE                  0x4000
-#define PROTECTED_MEM_START_ADDR            0x1001C000
-#define PROTECTED_MEM_ROW_SIZE              0x200
+#define EFUSE_BITS_PER_BYTE                 (8u)
 
-#define IPC_STATUS_WAIT_TIME_S               60u                                 /* maximum wait time for IPC Lock */
-#define DELAY_IPC_STATUS_CHECK_MS            1000u                               /* delay for checking the IPC status */
+/* eFuse byte of the lifecycle stage bits, and one bit of this byte */
+#define LIFECYCLE_EFUSE_BYTE                (offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE) / EFUSE_BITS_PER_BYTE)
+#define LIFECYCLE_EFUSE_BIT(byte, stage)    ((((uint32_t)(byte) >> (offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE.stage) % EFUSE_BITS_PER_BYTE)) & 1u) != 0u)
 
-typedef struct
-{
-    uint32_t unique_id_0;
-    uint32_t unique_id_1;
-    uint32_t unique_id_2;
-}read_uid_param_t;
+_Static_assert(LIFECYCLE_EFUSE_BYTE == (CY_PS_BOOT_EFUSE_OFFSET + CY_PS_BOOT_EFUSE_LIFECYCLE), "Lifecycle byte is not in the boot eFuse snapshot");
 
 read_uid_param_t uid_param;
 
-typedef struct {
-    uint32_t opcode;
-    uint32_t obj_size;
-    uint32_t cmd_id;
-    uint32_t unique_id_0;
-    uint32_t unique_id_1;
-    uint32_t unique_id_2;
-    uint8_t signature[256];
-} transit_rma_param_t;
-
 /* RMA Certificate to be sent to the device. It is unique per device */
 transit_rma_param_t rmaParam =
 {
@@ -124,57 +110,6 @@ transit_rma_param_t rmaParam =
 /********************************/
 /*          Functions           */
 /********************************/
-#if (TRANSITION_TO_RMA)
-/******************************************************************************
- * Function Name: TransitionToRMA
- ******************************************************************************
- * Summary:
- *  This function invokes the RMA syscall via IPC, and checks for the return
- *  code.
- *
- * Return:
- *  CY_IPC_DRV_SUCCESS on success
- *  CY_IPC_DRV_ERROR on failure
- *
- ******************************************************************************/
-static uint32_t TransitionToRMA(const transit_rma_param_t *paramRMA)
-{
-    uint32_t result = FAILED;
-    uint32_t elapsedTime = 0;
-
-    /* Send the IPC message */
-    if (Cy_IPC_Drv_SendMsgPtr(CY_IPC_STRUCT, CY_IPC_NOTIFY_STRUCT0, (const void*)paramRMA) == CY_IPC_DRV_SUCCESS)
-    {
-        /* Wait for the IPC structure to be freed */
-        while (elapsedTime < IPC_STATUS_WAIT_TIME_S)
-        {
-            if (Cy_IPC_Drv_IsLockAcquired(CY_IPC_STRUCT) == false)
-                break;
-
-            /* Delay by 1s before checking again */
-            Cy_SysLib_Delay(DELAY_IPC_STATUS_CHECK_MS);
-            elapsedTime++;
-        }
-
-        /* The result of the SROM API call is returned to the opcode variable */
-        if ((paramRMA->opcode & CY_OPCODE_STS_Msk) == CY_OPCODE_SUCCESS)
-        {
-            printf("\r\nTransition to RMA successful!!!");
-        }
-        else
-        {
-            printf("\r\nTransition to RMA Failed!!! ... ERR_STATUS: 0x%lx\r\n", paramRMA->opcode);
-        }
-
-        result = CY_IPC_DRV_SUCCESS;
-    }
-    else
-        result = CY_IPC_DRV_ERROR;
-
-    return result;
-}
-#endif /* TRANSITION_TO_RMA */
-
 void ReadUniqueID(read_uid_param_t  *uid_param)
 {
 
@@ -195,6 +130,81 @@ void ReadUniqueID(read_uid_param_t  *uid_param)
     printf("ReadUniqueID : Device unique ID is: 0x%08lx 0x%08lx 0x%08lx \r\n", uid_param->unique_id_0, uid_param->unique_id_1, uid_param->unique_id_2);
 }
 
+/******************************************************************************
+ * Function Name: PrintBootTiming
+ ******************************************************************************
+ * Summary:
+ *  This function prints the boot phase timing recorded by the bootloader in
+ *  the shared SRAM. Each phase is printed with the time since the bootloader
+ *  started and its own duration. The raw record is printed as well for the
+ *  boot_timing.py host script.
+ *
+ ******************************************************************************/
+static void PrintBootTiming(void)
+{
+    static const char *phase_names[] = CY_PS_BOOT_PHASE_NAMES;
+    const cy_stc_ps_boot_timing_t *timing = &CY_PS_BOOT_SHARED->timing;
+    const uint8_t *raw = (const uint8_t *)timing;
+    uint32_t raw_size;
+    uint32_t prev_ticks = 0;
+
+    if ((timing->magic != CY_PS_BOOT_TIMING_MAGIC) || (timing->version != CY_PS_BOOT_TIMING_VERSION) ||
+        (timing->count > CY_PS_BOOT_TIMING_MAX_MARKS) || (timing->clock_hz == 0))
+    {
+        printf("Boot timing : not available\r\n");
+        return;
+    }
+
+    printf("Boot timing (us) :\r\n");
+    for (uint32_t i = 0; i < timing->count; i++)
+    {
+        const char *name = (timing->marks[i].phase < CY_PS_BOOT_PHASE_COUNT) ? phase_names[timing->marks[i].phase] : "unknown";
+        uint32_t total_us = (uint32_t)(((uint64_t)timing->marks[i].ticks * 1000000u) / timing->clock_hz);
+        uint32_t phase_us = (uint32_t)(((uint64_t)(timing->marks[i].ticks - prev_ticks) * 1000000u) / timing->clock_hz);
+
+        printf("  %-12s %8lu (+%lu)\r\n", name, (unsigned long)total_us, (unsigned long)phase_us);
+        prev_ticks = timing->marks[i].ticks;
+    }
+
+    raw_size = offsetof(cy_stc_ps_boot_timing_t, marks) + (timing->count * sizeof(cy_stc_ps_boot_mark_t));
+    printf("BOOT_TIMING:");
+    for (uint32_t i = 0; i < raw_size; i++)
+    {
+        printf("%02X", raw[i]);
+    }
+    printf("\r\n");
+}
+
+/******************************************************************************
+ * Function Name: PrintBootLog
+ ******************************************************************************
+ * Summary:
+ *  This function prints the deferred bootloader log record from the shared
+ *  SRAM as a "BOOT_LOG:<hex>" line. The messages are rebuilt from the
+ *  bootloader ELF file by the boot_log.py host script.
+ *
+ ******************************************************************************/
+static void PrintBootLog(void)
+{
+    const cy_stc_ps_boot_log_t *log = &CY_PS_BOOT_SHARED->log;
+    const uint8_t *raw = (const uint8_t *)log;
+    uint32_t raw_size;
+
+    if ((log->magic != CY_PS_BOOT_LOG_MAGIC) || (log->version != CY_PS_BOOT_LOG_VERSION) ||
+        (log->count > CY_PS_BOOT_LOG_MAX_WORDS))
+    {
+        return;
+    }
+
+    raw_size = offsetof(cy_stc_ps_boot_log_t, data) + (log->count * sizeof(uint32_t));
+    printf("BOOT_LOG:");
+    for (uint32_t i = 0; i < raw_size; i++)
+    {
+        printf("%02X", raw[i]);
+    }
+    printf("\r\n");
+}
+
 /******************************************************************************
  * Function Name: main
  ******************************************************************************
@@ -213,11 +223,10 @@ void ReadUniqueID(read_uid_param_t  *uid_param)
 int main(void)
 {
     cy_rslt_t result;
+    const cy_stc_ps_boot_efuse_t *boot_efuse = &CY_PS_BOOT_SHARED->efuse;
+    srom_syscall_status_t efuse_status;
+    uint8_t lifecycle = 0u;
     bool bitval_secure, bitval_normal, bitval_secdbg, bitval_rma;
-    uint32_t bit_secure_stage = offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE.SECURE);
-    uint32_t bit_normal_stage = offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE.NORMAL);
-    uint32_t bit_secure_debug_stage = offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE.SECURE_WITH_DEBUG);
-    uint32_t bit_secure_rma = offsetof(cy_stc_efuse_data_t, LIFECYCLE_STAGE.RMA);
 
     /* Update watchdog timer to mark successful start up of application */
     cy_wdg_kick();
@@ -230,15 +239,34 @@ int main(void)
     /* Enable global interrupts */
     __enable_irq();
 
+    /* SROM system calls complete on the IPC release interrupt */
+    result = srom_syscall_init();
+    CY_ASSERT(result == CY_RSLT_SUCCESS);
+
     (void) result; /* To avoid compiler warning in release build */
 
     cy_retarget_io_pdl_init(CY_RETARGET_IO_BAUDRATE);
 
-    /* Get lifecycle states and access restrictions */
-    Cy_EFUSE_GetEfuseBit(bit_normal_stage, &bitval_normal);
-    Cy_EFUSE_GetEfuseBit(bit_secure_debug_stage, &bitval_secdbg);
-    Cy_EFUSE_GetEfuseBit(bit_secure_stage, &bitval_secure);
-    Cy_EFUSE_GetEfuseBit(bit_secure_rma, &bitval_rma);
+    /* Get lifecycle states. The stage bits are in one eFuse byte, taken from
+     * the snapshot published by the bootloader. Without a valid snapshot the
+     * byte is read with a single system call.
+     */
+    if (cy_ps_boot_efuse_valid(boot_efuse))
+    {
+        lifecycle = boot_efuse->bytes[CY_PS_BOOT_EFUSE_LIFECYCLE];
+    }
+    else
+    {
+        efuse_status = srom_syscall_read_efuse_byte(LIFECYCLE_EFUSE_BYTE, &lifecycle);
+        if (efuse_status != SROM_SYSCALL_DONE)
+        {
+            printf("Life Cycle Stage : eFuse read %s\r\n", srom_syscall_status_name(efuse_status));
+        }
+    }
+    bitval_normal = LIFECYCLE_EFUSE_BIT(lifecycle, NORMAL);
+    bitval_secdbg = LIFECYCLE_EFUSE_BIT(lifecycle, SECURE_WITH_DEBUG);
+    bitval_secure = LIFECYCLE_EFUSE_BIT(lifecycle, SECURE);
+    bitval_rma = LIFECYCLE_EFUSE_BIT(lifecycle, RMA);
 
     if(bitval_rma)
     {
@@ -260,20 +288,43 @@ int main(void)
     /* Read and print the 12byte Unique ID of silicon. It is required to generate RMA certificate */
     ReadUniqueID(&uid_param);
 
+    /* Print how long each bootloader phase took */
+    PrintBootTiming();
+
+    /* Print the bootloader log for the boot_log.py host script */
+    PrintBootLog();
+
     /* Delay by 100ms to clear the print buffer before dfu_task */
     Cy_SysLib_Delay(100);
 
 #if (TRANSITION_TO_RMA)
-    uint32_t rma_api_result;
+    srom_syscall_status_t rma_api_result;
+    rma_cert_status_t cert_status;
 
-    rma_api_result = TransitionToRMA(&rmaParam);
-    printf("\r\nTransitionToRMA IPC status: 0x%lx\r\n", rma_api_result);
+    /* Check the certificate before the SROM call: a certificate of another
+     * device or with a bad signature is rejected at once
+     */
+    cert_status = rma_check_certificate(&rmaParam, &uid_param);
+    if (cert_status == RMA_CERT_OK)
+    {
+        rma_api_result = rma_transition(&rmaParam);
+        printf("\r\nTransitionToRMA syscall status: %s\r\n", srom_syscall_status_name(rma_api_result));
+    }
+    else
+    {
+        printf("\r\nRMA certificate rejected: %s\r\n", rma_cert_status_name(cert_status));
+    }
 #else
     /* Create one task:
      * dfu_task - task that configures the DFU to upgrade the firmware
      */
     xTaskCreate((void *)dfu_task, "DFU Task", DFU_TASK_STACK_SIZE, NULL, DFU_TASK_PRIORITY, NULL);
 
+#if defined(RTOS_STATS)
+    /* Print the task CPU time, stack and heap usage periodically */
+    xTaskCreate(rtos_stats_task, "RTOS Stats", RTOS_STATS_TASK_STACK_SIZE, NULL, RTOS_STATS_TASK_PRIORITY, NULL);
+#endif
+
     /* Start the scheduler */
     vTaskStartScheduler();
 
@@ -0,0 +1,284 @@
+/******************************************************************************
+* File Name:   rma.c
+*
+* Description: This file checks an RMA certificate against the unique ID of
+*              the device and the public key in SFlash before it is handed to
+*              the SROM with srom_syscall.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "rma.h"
+
+/* Public key structure in SFlash */
+#include "../proj_btldr_cm0p/source/cy_ps_keystorage.h"
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define RMA_SHA256_SIZE                 (32u)
+
+/* Offset of the digest in the RSASSA-PKCS1-v1_5 encoded message:
+ * 0x00 0x01 PS 0x00 DigestInfo digest, PS being 0xFF bytes
+ */
+#define RMA_EM_DIGEST_INFO_SIZE         (19u)
+#define RMA_EM_DIGEST_OFFSET            (CY_RMA_SIGNATURE_SIZE - RMA_SHA256_SIZE)
+#define RMA_EM_PADDING_END              (RMA_EM_DIGEST_OFFSET - RMA_EM_DIGEST_INFO_SIZE - 1u)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* DER encoding of the SHA-256 AlgorithmIdentifier, RFC 8017 section 9.2 */
+static const uint8_t rma_digest_info[RMA_EM_DIGEST_INFO_SIZE] =
+{
+    0x30u, 0x31u, 0x30u, 0x0Du, 0x06u, 0x09u, 0x60u, 0x86u, 0x48u, 0x01u,
+    0x65u, 0x03u, 0x04u, 0x02u, 0x01u, 0x05u, 0x00u, 0x04u, 0x20u
+};
+
+/*******************************************************************************
+ * Function Name: rma_get_public_key
+ *******************************************************************************
+ * Summary:
+ *  Returns the public key in SFlash if it is an RSA-2048 key. The RMA
+ *  certificate is checked by the SROM with this key.
+ *
+ * Return:
+ *  const cy_ps_stc_public_key_t* - Public key, NULL if not provisioned
+ *
+ *******************************************************************************/
+static const cy_ps_stc_public_key_t *rma_get_public_key(void)
+{
+    const cy_ps_stc_public_key_t *key = (const cy_ps_stc_public_key_t *)&SFLASH->PUBLIC_KEY;
+
+    if ((key->objSize != sizeof(cy_ps_stc_public_key_t)) ||
+        (key->signatureScheme != CY_PS_PUBLIC_KEY_RSA_2048) ||
+        (key->publicKeyStruct.moduloSize != (CY_PS_PUBLIC_KEY_MODULOLENGTH * CY_PS_PUBLIC_KEY_SIZEOF_BYTE)) ||
+        (key->publicKeyStruct.expSize > (CY_PS_PUBLIC_KEY_EXPLENGTH * CY_PS_PUBLIC_KEY_SIZEOF_BYTE)))
+    {
+        return NULL;
+    }
+
+    return key;
+}
+
+/*******************************************************************************
+ * Function Name: rma_check_signature
+ *******************************************************************************
+ * Summary:
+ *  Checks the RSASSA-PKCS1-v1_5 SHA-256 signature of the certificate. The
+ *  signed data are the 20 bytes from obj_size to unique_id_2, as sent to the
+ *  SROM. The signature is raised to the public exponent by the crypto block
+ *  and compared with the expected encoded message.
+ *
+ * Parameters:
+ *  cert - RMA certificate
+ *  key  - Public key in SFlash
+ *
+ * Return:
+ *  rma_cert_status_t - RMA_CERT_OK if the signature is valid
+ *
+ *******************************************************************************/
+static rma_cert_status_t rma_check_signature(const transit_rma_param_t *cert, const cy_ps_stc_public_key_t *key)
+{
+    CY_ALIGN(4) uint8_t digest[RMA_SHA256_SIZE];
+    CY_ALIGN(4) uint8_t signature[CY_RMA_SIGNATURE_SIZE];
+    CY_ALIGN(4) uint8_t message[CY_RMA_SIGNATURE_SIZE];
+    CY_ALIGN(4) uint8_t expected[CY_RMA_SIGNATURE_SIZE];
+    cy_stc_crypto_rsa_pub_key_t rsa_key =
+    {
+        .moduloPtr        = (uint8_t *)key->moduloData,
+        .moduloLength     = key->publicKeyStruct.moduloSize,
+        .pubExpPtr        = (uint8_t *)key->expData,
+        .pubExpLength     = key->publicKeyStruct.expSize,
+        .barretCoefPtr    = (uint8_t *)key->barrettData,
+        .inverseModuloPtr = (uint8_t *)key->inverseModuloData,
+        .rBarPtr          = (uint8_t *)key->rBarData
+    };
+
+    cy_en_crypto_status_t crypto_status = Cy_Crypto_Core_Enable(CRYPTO);
+
+    if (crypto_status == CY_CRYPTO_SUCCESS)
+    {
+        crypto_status = Cy_Crypto_Core_Sha(CRYPTO, (const uint8_t *)&cert->obj_size, CY_RMA_OBJ_SIZE,
+                                           digest, CY_CRYPTO_MODE_SHA256);
+    }
+
+    if (crypto_status == CY_CRYPTO_SUCCESS)
+    {
+        /* The signature is big-endian, the crypto block works on
+         * little-endian numbers
+         */
+        memcpy(signature, cert->signature, sizeof(signature));
+        Cy_Crypto_Core_InvertEndianness(signature, sizeof(signature));
+
+        crypto_status = Cy_Crypto_Core_Rsa_Proc(CRYPTO, &rsa_key, signature, sizeof(signature), message);
+    }
+
+    if (crypto_status != CY_CRYPTO_SUCCESS)
+    {
+        return RMA_CERT_CRYPTO_ERROR;
+    }
+
+    Cy_Crypto_Core_InvertEndianness(message, sizeof(message));
+
+    /* Expected encoded message */
+    expected[0] = 0x00u;
+    expected[1] = 0x01u;
+    memset(&expected[2], 0xFF, RMA_EM_PADDING_END - 2u);
+    expected[RMA_EM_PADDING_END] = 0x00u;
+    memcpy(&expected[RMA_EM_PADDING_END + 1u], rma_digest_info, sizeof(rma_digest_info));
+    memcpy(&expected[RMA_EM_DIGEST_OFFSET], digest, sizeof(digest));
+
+    if (Cy_Crypto_Core_MemCmp(CRYPTO, message, expected, sizeof(expected)) != 0u)
+    {
+        return RMA_CERT_BAD_SIGNATURE;
+    }
+
+    return RMA_CERT_OK;
+}
+
+/*******************************************************************************
+ * Function Name: rma_check_certificate
+ *******************************************************************************
+ * Summary:
+ *  Checks an RMA certificate before it is sent to the SROM: the header, the
+ *  unique ID of the device and the signature with the public key in SFlash.
+ *  A certificate rejected here would be rejected by the SROM as well, but
+ *  only after the system call completes.
+ *
+ * Parameters:
+ *  cert - RMA certificate
+ *  uid  - Unique ID of the device, see ReadUniqueID()
+ *
+ * Return:
+ *  rma_cert_status_t - RMA_CERT_OK if the certificate can be sent to the SROM
+ *
+ *******************************************************************************/
+rma_cert_status_t rma_check_certificate(const transit_rma_param_t *cert, const read_uid_param_t *uid)
+{
+    const cy_ps_stc_public_key_t *key;
+
+    if ((cert->opcode != CY_RMA_OPCODE) || (cert->obj_size != CY_RMA_OBJ_SIZE) ||
+        (cert->cmd_id != CY_RMA_CMD_ID))
+    {
+        return RMA_CERT_BAD_HEADER;
+    }
+
+    if ((cert->unique_id_0 != uid->unique_id_0) || (cert->unique_id_1 != uid->unique_id_1) ||
+        (cert->unique_id_2 != uid->unique_id_2))
+    {
+        return RMA_CERT_UID_MISMATCH;
+    }
+
+    key = rma_get_public_key();
+    if (key == NULL)
+    {
+        return RMA_CERT_NO_KEY;
+    }
+
+    return rma_check_signature(cert, key);
+}
+
+/*******************************************************************************
+ * Function Name: rma_cert_status_name
+ *******************************************************************************
+ * Summary:
+ *  Returns the name of the result of a certificate check, for the logs.
+ *
+ * Parameters:
+ *  status - Result of rma_check_certificate()
+ *
+ * Return:
+ *  const char* - Name of the result
+ *
+ *******************************************************************************/
+const char *rma_cert_status_name(rma_cert_status_t status)
+{
+    switch (status)
+    {
+        case RMA_CERT_OK:               return "OK";
+        case RMA_CERT_BAD_HEADER:       return "bad opcode, object size or command ID";
+        case RMA_CERT_UID_MISMATCH:     return "unique ID of another device";
+        case RMA_CERT_NO_KEY:           return "no RSA-2048 public key in SFlash";
+        case RMA_CERT_BAD_SIGNATURE:    return "signature does not match the SFlash public key";
+        case RMA_CERT_CRYPTO_ERROR:     return "crypto block error";
+        default:                        return "unknown";
+    }
+}
+
+/*******************************************************************************
+ * Function Name: rma_transition
+ *******************************************************************************
+ * Summary:
+ *  Sends the RMA certificate to the SROM and waits until the SROM releases
+ *  the system call IPC structure, up to IPC_STATUS_WAIT_TIME_S seconds.
+ *
+ * Parameters:
+ *  cert - RMA certificate, the SROM returns its status in the opcode
+ *
+ * Return:
+ *  srom_syscall_status_t - SROM_SYSCALL_DONE if the SROM completed the call,
+ *  see the opcode for its status
+ *
+ *******************************************************************************/
+srom_syscall_status_t rma_transition(transit_rma_param_t *cert)
+{
+    volatile uint32_t *params = &cert->opcode;
+    srom_syscall_status_t status;
+
+    status = srom_syscall_call(params, IPC_STATUS_WAIT_TIME_S * 1000u);
+
+    /* The result of the SROM API call is returned to the opcode variable */
+    if (status != SROM_SYSCALL_DONE)
+    {
+        printf("\r\nTransition to RMA not completed: %s\r\n", srom_syscall_status_name(status));
+    }
+    else if ((params[0] & SROM_SYSCALL_STS_Msk) == SROM_SYSCALL_STS_SUCCESS)
+    {
+        printf("\r\nTransition to RMA successful!!!");
+    }
+    else
+    {
+        printf("\r\nTransition to RMA Failed!!! ... ERR_STATUS: 0x%lx\r\n", params[0]);
+    }
+
+    return status;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name:   rma.h
+*
+* Description: This file contains the definitions and function prototypes
+*              for checking an RMA certificate on the device and handing it
+*              to the SROM to transition the device to the RMA lifecycle
+*              stage.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef RMA_H
+#define RMA_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cy_pdl.h"
+#include "srom_syscall.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CY_RMA_OPCODE                       (0x28000000UL)                      /* The SROM API opcode for RMA lifecycle stage conversion */
+#define CY_RMA_CMD_ID                       (0x120028F0UL)
+#define CY_RMA_OBJ_SIZE                     (0x00000014UL)                      /* Size of the signed part of the certificate */
+#define CY_RMA_OBJECT_SIZE                  (20 + 256)                           /* 20 bytes - fixed object size + 256 bytes of signature (can go upto 256 bytes)*/
+#define CY_RMA_SIGNATURE_SIZE               (256u)                              /* RSASSA-PKCS1-v1_5-2048 signature */
+
+#define CY_READ_UID_OPCODE                  (0x1F000000UL)                      /* The SROM API opcode to read Unique ID */
+
+#define IPC_STATUS_WAIT_TIME_S              60u                                 /* maximum wait time for IPC Lock */
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t unique_id_0;
+    uint32_t unique_id_1;
+    uint32_t unique_id_2;
+}read_uid_param_t;
+
+typedef struct {
+    uint32_t opcode;
+    uint32_t obj_size;
+    uint32_t cmd_id;
+    uint32_t unique_id_0;
+    uint32_t unique_id_1;
+    uint32_t unique_id_2;
+    uint8_t signature[CY_RMA_SIGNATURE_SIZE];
+} transit_rma_param_t;
+
+/* Result of the check of an RMA certificate */
+typedef enum
+{
+    RMA_CERT_OK,                        /* The SROM can be called */
+    RMA_CERT_BAD_HEADER,                /* Wrong opcode, object size or command ID */
+    RMA_CERT_UID_MISMATCH,              /* Certificate of another device */
+    RMA_CERT_NO_KEY,                    /* No RSA-2048 public key in SFlash */
+    RMA_CERT_BAD_SIGNATURE,             /* Not signed with the SFlash key */
+    RMA_CERT_CRYPTO_ERROR               /* The crypto block failed */
+} rma_cert_status_t;
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+rma_cert_status_t rma_check_certificate(const transit_rma_param_t *cert, const read_uid_param_t *uid);
+const char *rma_cert_status_name(rma_cert_status_t status);
+srom_syscall_status_t rma_transition(transit_rma_param_t *cert);
+
+#endif /* RMA_H */
+
+/* [] END OF FILE */
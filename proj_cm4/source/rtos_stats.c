@@ -0,0 +1,270 @@
+/******************************************************************************
+* File Name:   rtos_stats.c
+*
+* Description: This file implements the FreeRTOS run-time statistics report.
+*              A free-running TCPWM counter is the run time counter of
+*              FreeRTOS, and a low-priority task prints the run time, the
+*              lowest free stack space and the priority of each task with
+*              the heap usage as a "RTOS_STATS:<hex>" line on the debug UART.
+*              The rtos_stats.py host script decodes the lines.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <malloc.h>
+#include "cy_pdl.h"
+#include "cyhal.h"
+#include "rtos_stats.h"
+
+/* FreeRTOS header files */
+#include "task.h"
+
+#if defined(RTOS_STATS)
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define RTOS_STATS_PREFIX               "RTOS_STATS:"
+
+/* Largest report: header, task entries and CRC */
+#define RTOS_STATS_REPORT_MAX           (sizeof(rtos_stats_header_t) + \
+                                         (RTOS_STATS_MAX_TASKS * sizeof(rtos_stats_task_t)) + sizeof(uint32_t))
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Heap section of the linker script */
+extern char __HeapBase[];
+extern char __HeapLimit[];
+
+/* Run time counter, free running */
+static cyhal_timer_t stats_timer;
+static bool stats_timer_ready = false;
+
+/* Buffers of the report task */
+static TaskStatus_t stats_status[RTOS_STATS_MAX_TASKS];
+static uint8_t stats_report[RTOS_STATS_REPORT_MAX];
+static char stats_line[sizeof(RTOS_STATS_PREFIX) + (2u * RTOS_STATS_REPORT_MAX) + 2u];
+
+/*******************************************************************************
+ * Function Name: stats_crc32
+ *******************************************************************************
+ * Summary:
+ *   Calculates the CRC32 (IEEE 802.3) of a buffer.
+ *
+ * Parameters:
+ *   data - Pointer to the data
+ *   size - Number of bytes
+ *
+ * Return:
+ *   uint32_t - The CRC value
+ *
+ *******************************************************************************/
+static uint32_t stats_crc32(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1u) ^ (RTOS_STATS_CRC32_POLY & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: rtos_stats_timer_init
+ *******************************************************************************
+ * Summary:
+ *  Starts the run time counter. Called by vTaskStartScheduler() through
+ *  portCONFIGURE_TIMER_FOR_RUN_TIME_STATS(). The period needs a 32-bit
+ *  TCPWM counter; if none is free, the run times stay 0 and the reports
+ *  hold a timer frequency of 0.
+ *
+ *******************************************************************************/
+void rtos_stats_timer_init(void)
+{
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0u,
+        .period = 0xFFFFFFFFUL,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = true,
+        .value = 0u
+    };
+    cy_rslt_t result;
+
+    result = cyhal_timer_init(&stats_timer, NC, NULL);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_configure(&stats_timer, &timer_cfg);
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_set_frequency(&stats_timer, RTOS_STATS_TIMER_FREQUENCY_HZ);
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_start(&stats_timer);
+    }
+
+    stats_timer_ready = (result == CY_RSLT_SUCCESS);
+}
+
+/*******************************************************************************
+ * Function Name: rtos_stats_timer_read
+ *******************************************************************************
+ * Summary:
+ *  Returns the run time counter. Called by FreeRTOS on each context switch
+ *  through portGET_RUN_TIME_COUNTER_VALUE().
+ *
+ * Return:
+ *  uint32_t - Counter value, in 1/RTOS_STATS_TIMER_FREQUENCY_HZ s
+ *
+ *******************************************************************************/
+uint32_t rtos_stats_timer_read(void)
+{
+    return stats_timer_ready ? cyhal_timer_read(&stats_timer) : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: stats_build_report
+ *******************************************************************************
+ * Summary:
+ *  Fills the report buffer with the state of the tasks and of the heap.
+ *
+ * Return:
+ *  uint32_t - Size of the report in bytes
+ *
+ *******************************************************************************/
+static uint32_t stats_build_report(void)
+{
+    rtos_stats_header_t header;
+    rtos_stats_task_t entry;
+    struct mallinfo heap = mallinfo();
+    uint32_t total_time = 0u;
+    uint32_t count;
+    uint32_t size;
+    uint32_t crc;
+
+    /* 0 if the tasks do not fit in stats_status */
+    count = (uint32_t)uxTaskGetSystemState(stats_status, RTOS_STATS_MAX_TASKS, &total_time);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = RTOS_STATS_MAGIC;
+    header.version = RTOS_STATS_VERSION;
+    header.count = (uint16_t)count;
+    header.tasks = (uint32_t)uxTaskGetNumberOfTasks();
+    header.timer_hz = stats_timer_ready ? RTOS_STATS_TIMER_FREQUENCY_HZ : 0u;
+    header.total_time = total_time;
+    header.tick_count = (uint32_t)xTaskGetTickCount();
+    header.heap_size = (uint32_t)(__HeapLimit - __HeapBase);
+    header.heap_used = (uint32_t)heap.uordblks;
+    header.heap_arena = (uint32_t)heap.arena;
+
+    memcpy(stats_report, &header, sizeof(header));
+    size = sizeof(header);
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, stats_status[i].pcTaskName, sizeof(entry.name));
+        entry.number = (uint32_t)stats_status[i].xTaskNumber;
+        entry.run_time = stats_status[i].ulRunTimeCounter;
+        entry.stack_free = (uint32_t)stats_status[i].usStackHighWaterMark * sizeof(StackType_t);
+        entry.priority = (uint8_t)stats_status[i].uxCurrentPriority;
+        entry.state = (uint8_t)stats_status[i].eCurrentState;
+
+        memcpy(&stats_report[size], &entry, sizeof(entry));
+        size += sizeof(entry);
+    }
+
+    crc = stats_crc32(stats_report, size);
+    memcpy(&stats_report[size], &crc, sizeof(crc));
+
+    return size + sizeof(crc);
+}
+
+/*******************************************************************************
+ * Function Name: rtos_stats_task
+ *******************************************************************************
+ * Summary:
+ *  Prints a report every RTOS_STATS_PERIOD_MS. The line is formatted first
+ *  and printed with one call, but another task printing at the same time
+ *  can still split it; the host script drops lines with a bad CRC.
+ *
+ * Parameters:
+ *  arg - Unused
+ *
+ *******************************************************************************/
+void rtos_stats_task(void *arg)
+{
+    static const char hex_digits[] = "0123456789ABCDEF";
+    TickType_t last_wake = xTaskGetTickCount();
+
+    (void)arg;
+
+    for (;;)
+    {
+        uint32_t size = stats_build_report();
+        char *p = stats_line;
+
+        memcpy(p, RTOS_STATS_PREFIX, sizeof(RTOS_STATS_PREFIX) - 1u);
+        p += sizeof(RTOS_STATS_PREFIX) - 1u;
+        for (uint32_t i = 0u; i < size; i++)
+        {
+            *p++ = hex_digits[stats_report[i] >> 4u];
+            *p++ = hex_digits[stats_report[i] & 0x0Fu];
+        }
+        *p = '\0';
+
+        printf("%s\r\n", stats_line);
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(RTOS_STATS_PERIOD_MS));
+    }
+}
+
+#endif /* RTOS_STATS */
+
+/* [] END OF FILE */
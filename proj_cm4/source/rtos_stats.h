@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   rtos_stats.h
+*
+* Description: This file contains the definitions and function prototypes
+*              of the FreeRTOS run-time statistics report. The run time of
+*              each task is counted on a hardware timer, and a binary report
+*              of the task CPU time, stack and heap usage is printed
+*              periodically on the debug UART.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef RTOS_STATS_H
+#define RTOS_STATS_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frequency of the run time counter. The counter is 32 bits wide and wraps
+ * after about 11.9 hours; the host script uses the difference between two
+ * reports, so the report period must be shorter.
+ */
+#define RTOS_STATS_TIMER_FREQUENCY_HZ   (100000u)
+
+/* Report period, set by RTOS_STATS_PERIOD_MS in the Makefile */
+#ifndef RTOS_STATS_PERIOD_MS
+#define RTOS_STATS_PERIOD_MS            (5000u)
+#endif
+
+/* Maximum number of tasks in a report */
+#define RTOS_STATS_MAX_TASKS            (8u)
+
+#define RTOS_STATS_TASK_STACK_SIZE      (configMINIMAL_STACK_SIZE * 2)
+#define RTOS_STATS_TASK_PRIORITY        (1u)
+
+/* Report record, printed as "RTOS_STATS:<hex>" */
+#define RTOS_STATS_MAGIC                (0x54535452UL)  /* "RTST" */
+#define RTOS_STATS_VERSION              (1u)
+#define RTOS_STATS_CRC32_POLY           (0xEDB88320UL)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* Report header. The task entries and a CRC32 of the header and the entries
+ * follow it.
+ */
+typedef struct
+{
+    uint32_t magic;                     /* RTOS_STATS_MAGIC */
+    uint16_t version;                   /* RTOS_STATS_VERSION */
+    uint16_t count;                     /* Number of task entries */
+    uint32_t tasks;                     /* Number of tasks, more than count if they did not fit */
+    uint32_t timer_hz;                  /* Run time counter frequency, 0 if the timer is not available */
+    uint32_t total_time;                /* Run time counter when the report was taken */
+    uint32_t tick_count;                /* FreeRTOS tick count */
+    uint32_t heap_size;                 /* Size of the heap section */
+    uint32_t heap_used;                 /* Bytes allocated */
+    uint32_t heap_arena;                /* Bytes taken from the heap section by malloc, never returned */
+} rtos_stats_header_t;
+
+typedef struct
+{
+    char name[configMAX_TASK_NAME_LEN]; /* Task name, NUL padded */
+    uint32_t number;                    /* Task number, unique until the task is deleted */
+    uint32_t run_time;                  /* Run time counter of the task */
+    uint32_t stack_free;                /* Lowest free stack space, in bytes */
+    uint8_t priority;                   /* Current priority */
+    uint8_t state;                      /* eTaskState */
+    uint16_t reserved;
+} rtos_stats_task_t;
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+/* Run time counter of FreeRTOS, see FreeRTOSConfig.h */
+void rtos_stats_timer_init(void);
+uint32_t rtos_stats_timer_read(void);
+
+void rtos_stats_task(void *arg);
+
+#endif /* RTOS_STATS_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,451 @@
+/******************************************************************************
+* File Name:   srom_syscall.c
+*
+* Description: This file implements the asynchronous SROM system calls of the
+*              CM4. The parameters are sent on the system call IPC structure
+*              and the call completes on the IPC release interrupt. A timer
+*              enforces the timeout of the call.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#include "cy_pdl.h"
+#include "cyhal.h"
+#include "srom_syscall.h"
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ * Macros
+ *******************************************************************************/
+#define SYSCALL_TIMER_FREQUENCY_HZ      (10000u)
+#define SYSCALL_TIMER_TICKS_PER_MS      (SYSCALL_TIMER_FREQUENCY_HZ / 1000u)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Timer of the timeout, one-shot */
+static cyhal_timer_t syscall_timer;
+static bool syscall_ready = false;
+
+/* Call in progress */
+static volatile srom_syscall_status_t syscall_state = SROM_SYSCALL_DONE;
+static srom_syscall_callback_t syscall_callback = NULL;
+static void *syscall_callback_arg = NULL;
+
+/* Time left after the current timer period */
+static uint32_t syscall_remaining_ms = 0u;
+
+/* Task waiting in srom_syscall_call() */
+static TaskHandle_t syscall_task = NULL;
+
+/* Parameters of srom_syscall_read_efuse_byte(), read by the SROM */
+static volatile uint32_t syscall_efuse_opcode;
+
+/*******************************************************************************
+ * Function Name: syscall_start_timer
+ *******************************************************************************
+ * Summary:
+ *  Starts the next timer period: the rest of the timeout, at most
+ *  SROM_SYSCALL_CHECK_MS.
+ *
+ *******************************************************************************/
+static void syscall_start_timer(void)
+{
+    uint32_t period_ms = (syscall_remaining_ms < SROM_SYSCALL_CHECK_MS) ? syscall_remaining_ms : SROM_SYSCALL_CHECK_MS;
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0u,
+        .period = (period_ms * SYSCALL_TIMER_TICKS_PER_MS) - 1u,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = false,
+        .value = 0u
+    };
+
+    syscall_remaining_ms -= period_ms;
+
+    (void)cyhal_timer_stop(&syscall_timer);
+    (void)cyhal_timer_configure(&syscall_timer, &timer_cfg);
+    (void)cyhal_timer_start(&syscall_timer);
+}
+
+/*******************************************************************************
+ * Function Name: syscall_complete
+ *******************************************************************************
+ * Summary:
+ *  Ends the call in progress and calls its callback. Called from the IPC and
+ *  timer interrupts, which have the same priority.
+ *
+ * Parameters:
+ *  status - SROM_SYSCALL_DONE or SROM_SYSCALL_TIMEOUT
+ *
+ *******************************************************************************/
+static void syscall_complete(srom_syscall_status_t status)
+{
+    if (syscall_state != SROM_SYSCALL_PENDING)
+    {
+        return;
+    }
+
+    (void)cyhal_timer_stop(&syscall_timer);
+    syscall_state = status;
+
+    if (syscall_callback != NULL)
+    {
+        syscall_callback(status, syscall_callback_arg);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: syscall_release_isr
+ *******************************************************************************
+ * Summary:
+ *  IPC interrupt handler, called when the SROM releases the system call IPC
+ *  structure.
+ *
+ *******************************************************************************/
+static void syscall_release_isr(void)
+{
+    IPC_INTR_STRUCT_Type *ipc_intr_addr = Cy_IPC_Drv_GetIntrBaseAddr(SROM_SYSCALL_IPC_INT_STRUCT_NUM);
+
+    Cy_IPC_Drv_ClearInterrupt(ipc_intr_addr, SROM_SYSCALL_IPC_INTR_RELEASE_MASK, 0u);
+
+    if (Cy_IPC_Drv_IsLockAcquired(SROM_SYSCALL_IPC_STRUCT) == false)
+    {
+        syscall_complete(SROM_SYSCALL_DONE);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: syscall_timer_isr
+ *******************************************************************************
+ * Summary:
+ *  Timer callback, at the end of each period of the timeout. Completes the
+ *  call if the IPC structure was released without a release interrupt, or
+ *  when the timeout is reached.
+ *
+ * Parameters:
+ *  callback_arg - Not used
+ *  event        - Not used
+ *
+ *******************************************************************************/
+static void syscall_timer_isr(void *callback_arg, cyhal_timer_event_t event)
+{
+    (void)callback_arg;
+    (void)event;
+
+    if (Cy_IPC_Drv_IsLockAcquired(SROM_SYSCALL_IPC_STRUCT) == false)
+    {
+        syscall_complete(SROM_SYSCALL_DONE);
+    }
+    else if (syscall_remaining_ms == 0u)
+    {
+        syscall_complete(SROM_SYSCALL_TIMEOUT);
+    }
+    else
+    {
+        syscall_start_timer();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: syscall_notify_task
+ *******************************************************************************
+ * Summary:
+ *  Completion callback of srom_syscall_call() when the scheduler is running,
+ *  wakes up the waiting task.
+ *
+ * Parameters:
+ *  status - Not used, see syscall_state
+ *  arg    - Not used
+ *
+ *******************************************************************************/
+static void syscall_notify_task(srom_syscall_status_t status, void *arg)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    (void)status;
+    (void)arg;
+
+    vTaskNotifyGiveFromISR(syscall_task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_init
+ *******************************************************************************
+ * Summary:
+ *  Enables the release interrupt of the system call IPC structure and
+ *  allocates the timer of the timeouts.
+ *
+ * Return:
+ *  cy_rslt_t - CY_RSLT_SUCCESS if the system calls can be used
+ *
+ *******************************************************************************/
+cy_rslt_t srom_syscall_init(void)
+{
+    IPC_INTR_STRUCT_Type *ipc_intr_addr = Cy_IPC_Drv_GetIntrBaseAddr(SROM_SYSCALL_IPC_INT_STRUCT_NUM);
+    cy_stc_sysint_t ipc_intr_config =
+    {
+        .intrSrc = (IRQn_Type) SROM_SYSCALL_IPC_INTR_NUM,
+        .intrPriority = SROM_SYSCALL_INTR_PRIORITY
+    };
+    cy_rslt_t result;
+
+    result = cyhal_timer_init(&syscall_timer, NC, NULL);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cyhal_timer_set_frequency(&syscall_timer, SYSCALL_TIMER_FREQUENCY_HZ);
+    }
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+    cyhal_timer_register_callback(&syscall_timer, syscall_timer_isr, NULL);
+    cyhal_timer_enable_event(&syscall_timer, CYHAL_TIMER_IRQ_TERMINAL_COUNT, SROM_SYSCALL_INTR_PRIORITY, true);
+
+    /* Interrupt on the release of the system call IPC structure. Whether the
+     * SROM notifies this structure depends on the release mask it uses, the
+     * timer checks the structure as well.
+     */
+    Cy_IPC_Drv_ClearInterrupt(ipc_intr_addr, SROM_SYSCALL_IPC_INTR_RELEASE_MASK, 0u);
+    Cy_IPC_Drv_SetInterruptMask(ipc_intr_addr, SROM_SYSCALL_IPC_INTR_RELEASE_MASK, 0u);
+    (void)Cy_SysInt_Init(&ipc_intr_config, &syscall_release_isr);
+    NVIC_EnableIRQ(ipc_intr_config.intrSrc);
+
+    syscall_ready = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_submit
+ *******************************************************************************
+ * Summary:
+ *  Sends a system call to the SROM and returns at once. The callback is
+ *  called from an interrupt when the SROM releases the IPC structure or when
+ *  the timeout is reached. The SROM returns its status in the first word of
+ *  the parameters. After a timeout, the SROM may still write the parameters
+ *  and the IPC structure stays busy until it is released.
+ *
+ * Parameters:
+ *  params     - Parameters in SRAM, the opcode in the first word
+ *  timeout_ms - Timeout of the call, 1 ms or more
+ *  callback   - Completion callback, can be NULL
+ *  arg        - Argument of the callback
+ *
+ * Return:
+ *  srom_syscall_status_t - SROM_SYSCALL_PENDING if the call was sent,
+ *  SROM_SYSCALL_BUSY if another call holds the IPC structure
+ *
+ *******************************************************************************/
+srom_syscall_status_t srom_syscall_submit(volatile uint32_t *params, uint32_t timeout_ms,
+                                          srom_syscall_callback_t callback, void *arg)
+{
+    srom_syscall_status_t status = SROM_SYSCALL_PENDING;
+    uint32_t interrupt_state;
+
+    if ((syscall_ready == false) || (timeout_ms == 0u))
+    {
+        return SROM_SYSCALL_FAILED;
+    }
+
+    /* The interrupts see the new call only once it is sent */
+    interrupt_state = Cy_SysLib_EnterCriticalSection();
+
+    if (syscall_state == SROM_SYSCALL_PENDING)
+    {
+        status = SROM_SYSCALL_BUSY;
+    }
+    else
+    {
+        syscall_callback = callback;
+        syscall_callback_arg = arg;
+        syscall_remaining_ms = timeout_ms;
+
+        if (Cy_IPC_Drv_SendMsgPtr(SROM_SYSCALL_IPC_STRUCT, SROM_SYSCALL_IPC_NOTIFY_STRUCT0, (const void *)params) == CY_IPC_DRV_SUCCESS)
+        {
+            syscall_state = SROM_SYSCALL_PENDING;
+            syscall_start_timer();
+        }
+        else
+        {
+            status = SROM_SYSCALL_BUSY;
+        }
+    }
+
+    Cy_SysLib_ExitCriticalSection(interrupt_state);
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_status
+ *******************************************************************************
+ * Summary:
+ *  Returns the state of the last call sent.
+ *
+ * Return:
+ *  srom_syscall_status_t - SROM_SYSCALL_PENDING, SROM_SYSCALL_DONE or
+ *  SROM_SYSCALL_TIMEOUT
+ *
+ *******************************************************************************/
+srom_syscall_status_t srom_syscall_status(void)
+{
+    return syscall_state;
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_call
+ *******************************************************************************
+ * Summary:
+ *  Sends a system call and waits for its completion. A task waits for a
+ *  notification from the completion callback. Before the scheduler is
+ *  started, the CPU sleeps until the interrupt that completes the call.
+ *
+ * Parameters:
+ *  params     - Parameters in SRAM, the opcode in the first word
+ *  timeout_ms - Timeout of the call
+ *
+ * Return:
+ *  srom_syscall_status_t - SROM_SYSCALL_DONE, SROM_SYSCALL_TIMEOUT,
+ *  SROM_SYSCALL_BUSY or SROM_SYSCALL_FAILED
+ *
+ *******************************************************************************/
+srom_syscall_status_t srom_syscall_call(volatile uint32_t *params, uint32_t timeout_ms)
+{
+    srom_syscall_status_t status;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+        syscall_task = xTaskGetCurrentTaskHandle();
+        status = srom_syscall_submit(params, timeout_ms, syscall_notify_task, NULL);
+        if (status == SROM_SYSCALL_PENDING)
+        {
+            /* The timer ends the call, the wait is not bounded again here */
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            status = syscall_state;
+        }
+    }
+    else
+    {
+        status = srom_syscall_submit(params, timeout_ms, NULL, NULL);
+
+        /* The interrupts are masked between the check and __WFI so that a
+         * completion in between is not missed: a pending interrupt still
+         * ends __WFI.
+         */
+        while (status == SROM_SYSCALL_PENDING)
+        {
+            __disable_irq();
+            if (syscall_state == SROM_SYSCALL_PENDING)
+            {
+                __WFI();
+            }
+            __enable_irq();
+            status = syscall_state;
+        }
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_read_efuse_byte
+ *******************************************************************************
+ * Summary:
+ *  Reads an eFuse byte, as Cy_EFUSE_GetEfuseByte() without busy waiting.
+ *
+ * Parameters:
+ *  offset - Offset of the byte, offsetof(cy_stc_efuse_data_t, ...) / 8
+ *  value  - Returns the byte
+ *
+ * Return:
+ *  srom_syscall_status_t - SROM_SYSCALL_DONE if the byte was read
+ *
+ *******************************************************************************/
+srom_syscall_status_t srom_syscall_read_efuse_byte(uint32_t offset, uint8_t *value)
+{
+    srom_syscall_status_t status;
+
+    syscall_efuse_opcode = SROM_EFUSE_OPCODE_READ_FUSE_BYTE | (offset << SROM_EFUSE_OPCODE_OFFSET_Pos);
+
+    status = srom_syscall_call(&syscall_efuse_opcode, SROM_EFUSE_TIMEOUT_MS);
+    if (status == SROM_SYSCALL_DONE)
+    {
+        if ((syscall_efuse_opcode & SROM_SYSCALL_STS_Msk) == SROM_SYSCALL_STS_SUCCESS)
+        {
+            *value = (uint8_t)(syscall_efuse_opcode & SROM_EFUSE_OPCODE_DATA_Msk);
+        }
+        else
+        {
+            status = SROM_SYSCALL_FAILED;
+        }
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: srom_syscall_status_name
+ *******************************************************************************
+ * Summary:
+ *  Returns the name of a system call state, for the logs.
+ *
+ * Parameters:
+ *  status - State of a system call
+ *
+ * Return:
+ *  const char* - Name of the state
+ *
+ *******************************************************************************/
+const char *srom_syscall_status_name(srom_syscall_status_t status)
+{
+    switch (status)
+    {
+        case SROM_SYSCALL_PENDING:      return "pending";
+        case SROM_SYSCALL_DONE:         return "done";
+        case SROM_SYSCALL_TIMEOUT:      return "timeout";
+        case SROM_SYSCALL_BUSY:         return "busy";
+        case SROM_SYSCALL_FAILED:       return "failed";
+        default:                        return "unknown";
+    }
+}
+
+/* [] END OF FILE */
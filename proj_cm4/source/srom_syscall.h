@@ -0,0 +1,116 @@
+/******************************************************************************
+* File Name:   srom_syscall.h
+*
+* Description: This file contains the definitions and function prototypes
+*              of the asynchronous SROM system calls of the CM4. A call is
+*              sent on the system call IPC structure and completes when the
+*              SROM releases the structure.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef SROM_SYSCALL_H
+#define SROM_SYSCALL_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "cy_pdl.h"
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define SROM_SYSCALL_IPC_STRUCT             (Cy_IPC_Drv_GetIpcBaseAddress(CY_IPC_CHAN_SYSCALL)) /* IPC structure to be used */
+#define SROM_SYSCALL_IPC_NOTIFY_STRUCT0     (0x1UL << CY_IPC_INTR_SYSCALL1)     /* IPC notify bit for IPC_STRUCT0 (dedicated to System Call) */
+
+/* IPC interrupt structure notified when the SROM releases the system call
+ * IPC structure. Structures 8 and 9 are used by ipc_communication.c.
+ */
+#define SROM_SYSCALL_IPC_INT_STRUCT_NUM     (10)
+#define SROM_SYSCALL_IPC_INTR_NUM           (cpuss_interrupts_ipc_10_IRQn)
+#define SROM_SYSCALL_IPC_INTR_RELEASE_MASK  (1UL << CY_IPC_CHAN_SYSCALL)
+#define SROM_SYSCALL_INTR_PRIORITY          (3u)
+
+/* The status of the call is returned by the SROM in the first word of the
+ * parameters
+ */
+#define SROM_SYSCALL_STS_Msk                (0xF0000000UL)
+#define SROM_SYSCALL_STS_SUCCESS            (0xA0000000UL)
+
+/* The release of the IPC structure is checked at least this often, in case
+ * the SROM does not notify SROM_SYSCALL_IPC_INT_STRUCT_NUM
+ */
+#define SROM_SYSCALL_CHECK_MS               (100u)
+
+/* Read of an eFuse byte */
+#define SROM_EFUSE_OPCODE_READ_FUSE_BYTE    (0x03000000UL)
+#define SROM_EFUSE_OPCODE_OFFSET_Pos        (8u)
+#define SROM_EFUSE_OPCODE_DATA_Msk          (0xFFUL)
+#define SROM_EFUSE_TIMEOUT_MS               (10u)
+
+/*******************************************************************************
+* Structures
+*******************************************************************************/
+/* State of a system call */
+typedef enum
+{
+    SROM_SYSCALL_PENDING,               /* Sent, the IPC structure is not released yet */
+    SROM_SYSCALL_DONE,                  /* Released, the SROM status is in the parameters */
+    SROM_SYSCALL_TIMEOUT,               /* Not released within the timeout */
+    SROM_SYSCALL_BUSY,                  /* The IPC structure is held by another call */
+    SROM_SYSCALL_FAILED                 /* The SROM returned an error status */
+} srom_syscall_status_t;
+
+/* Called once per call, from the IPC or timer interrupt, with
+ * SROM_SYSCALL_DONE or SROM_SYSCALL_TIMEOUT
+ */
+typedef void (*srom_syscall_callback_t)(srom_syscall_status_t status, void *arg);
+
+/*******************************************************************************
+* Function prototypes
+*******************************************************************************/
+cy_rslt_t srom_syscall_init(void);
+srom_syscall_status_t srom_syscall_submit(volatile uint32_t *params, uint32_t timeout_ms,
+                                          srom_syscall_callback_t callback, void *arg);
+srom_syscall_status_t srom_syscall_status(void);
+srom_syscall_status_t srom_syscall_call(volatile uint32_t *params, uint32_t timeout_ms);
+srom_syscall_status_t srom_syscall_read_efuse_byte(uint32_t offset, uint8_t *value);
+const char *srom_syscall_status_name(srom_syscall_status_t status);
+
+#endif /* SROM_SYSCALL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name: cy_ps_layout.h
+*
+* Description: SMPU configs of the memory layout of CY8CKIT-062-BLE.
+*   Generated by proj_btldr_cm0p/scripts/gen_layout.py from layout.json, do
+*   not edit. <NAME>_ADDR, <NAME>_REGION_SIZE and <NAME>_SUBREGIONS configure
+*   one SMPU struct that protects exactly <NAME>_START to <NAME>_END.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PS_LAYOUT_H
+#define CY_PS_LAYOUT_H
+
+#define CY_PS_LAYOUT_CM0P_BTLDR_FLASH_ADDR           (0x10000000UL)
+#define CY_PS_LAYOUT_CM0P_BTLDR_FLASH_REGION_SIZE    (CY_PROT_SIZE_128KB)
+#define CY_PS_LAYOUT_CM0P_BTLDR_FLASH_SUBREGIONS     (0x80U)
+#define CY_PS_LAYOUT_CM0P_BTLDR_FLASH_START          (0x10000000UL)
+#define CY_PS_LAYOUT_CM0P_BTLDR_FLASH_END            (0x1001C000UL)
+
+#define CY_PS_LAYOUT_PROTECTED_STORAGE_ADDR          (0x1001C000UL)
+#define CY_PS_LAYOUT_PROTECTED_STORAGE_REGION_SIZE   (CY_PROT_SIZE_16KB)
+#define CY_PS_LAYOUT_PROTECTED_STORAGE_SUBREGIONS    (0x00U)
+#define CY_PS_LAYOUT_PROTECTED_STORAGE_START         (0x1001C000UL)
+#define CY_PS_LAYOUT_PROTECTED_STORAGE_END           (0x10020000UL)
+
+#define CY_PS_LAYOUT_CM0P_APP_FLASH_ADDR             (0x10020000UL)
+#define CY_PS_LAYOUT_CM0P_APP_FLASH_REGION_SIZE      (CY_PROT_SIZE_128KB)
+#define CY_PS_LAYOUT_CM0P_APP_FLASH_SUBREGIONS       (0x00U)
+#define CY_PS_LAYOUT_CM0P_APP_FLASH_START            (0x10020000UL)
+#define CY_PS_LAYOUT_CM0P_APP_FLASH_END              (0x10040000UL)
+
+#define CY_PS_LAYOUT_CM4_APP_FLASH_ADDR              (0x10000000UL)
+#define CY_PS_LAYOUT_CM4_APP_FLASH_REGION_SIZE       (CY_PROT_SIZE_1MB)
+#define CY_PS_LAYOUT_CM4_APP_FLASH_SUBREGIONS        (0x03U)
+#define CY_PS_LAYOUT_CM4_APP_FLASH_START             (0x10040000UL)
+#define CY_PS_LAYOUT_CM4_APP_FLASH_END               (0x10100000UL)
+
+#define CY_PS_LAYOUT_CM0P_SRAM_ADDR                  (0x08000000UL)
+#define CY_PS_LAYOUT_CM0P_SRAM_REGION_SIZE           (CY_PROT_SIZE_64KB)
+#define CY_PS_LAYOUT_CM0P_SRAM_SUBREGIONS            (0x00U)
+#define CY_PS_LAYOUT_CM0P_SRAM_START                 (0x08000000UL)
+#define CY_PS_LAYOUT_CM0P_SRAM_END                   (0x08010000UL)
+
+#define CY_PS_LAYOUT_SHARED_SRAM_ADDR                (0x08010000UL)
+#define CY_PS_LAYOUT_SHARED_SRAM_REGION_SIZE         (CY_PROT_SIZE_32KB)
+#define CY_PS_LAYOUT_SHARED_SRAM_SUBREGIONS          (0x00U)
+#define CY_PS_LAYOUT_SHARED_SRAM_START               (0x08010000UL)
+#define CY_PS_LAYOUT_SHARED_SRAM_END                 (0x08018000UL)
+
+#define CY_PS_LAYOUT_CM4_SRAM_ADDR                   (0x08000000UL)
+#define CY_PS_LAYOUT_CM4_SRAM_REGION_SIZE            (CY_PROT_SIZE_256KB)
+#define CY_PS_LAYOUT_CM4_SRAM_SUBREGIONS             (0x07U)
+#define CY_PS_LAYOUT_CM4_SRAM_START                  (0x08018000UL)
+#define CY_PS_LAYOUT_CM4_SRAM_END                    (0x08040000UL)
+
+#define CY_PS_LAYOUT_CM4_SRAM_2_ADDR                 (0x08040000UL)
+#define CY_PS_LAYOUT_CM4_SRAM_2_REGION_SIZE          (CY_PROT_SIZE_32KB)
+#define CY_PS_LAYOUT_CM4_SRAM_2_SUBREGIONS           (0x00U)
+#define CY_PS_LAYOUT_CM4_SRAM_2_START                (0x08040000UL)
+#define CY_PS_LAYOUT_CM4_SRAM_2_END                  (0x08048000UL)
+
+#endif /* CY_PS_LAYOUT_H */
+
+/* [] END OF FILE */
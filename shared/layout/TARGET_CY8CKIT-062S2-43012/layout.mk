@@ -0,0 +1,70 @@
+################################################################################
+# \file layout.mk
+# \version 1.0
+#
+# \brief
+# Memory layout of CY8CKIT-062S2-43012.
+# Generated by proj_btldr_cm0p/scripts/gen_layout.py from layout.json, do not
+# edit. See README.md.
+#
+################################################################################
+# \copyright
+# Copyright 2022-2025, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+START_OF_FLASH=0x10000000
+DEVICE_FLASH_SIZE=0x200000
+START_OF_SRAM=0x08000000
+DEVICE_SRAM_SIZE=0x100000
+MCUBOOT_HEADER_SIZE=0x400
+EXT_FLASH_START=0x18000000
+EXT_FLASH_ERASE_SIZE=0x40000
+EXT_FLASH_SECONDARY_OFFSET=0x0
+CM0P_BTLDR_FLASH_START=0x10000000
+CM0P_BTLDR_FLASH_SIZE=0x1C000
+PROTECTED_MEM_START=0x1001C000
+PROTECTED_MEM_SIZE=0x4000
+CM0P_APP_FLASH_START=0x10020000
+CM0P_APP_FLASH_SIZE=0x20000
+CM4_APP_FLASH_START=0x10040000
+MCUBOOT_SCRATCH_START_ADDR=0x101E0000
+MCUBOOT_SCRATCH_SIZE=0x18000
+MCUBOOT_SWAP_STATUS_START_ADDR=0x101F8000
+MCUBOOT_SWAP_STATUS_SIZE=0x8000
+CM0P_APP_SRAM_START=0x08000000
+CM0P_APP_SRAM_SIZE=0x30000
+SHARED_SRAM_START=0x08030000
+SHARED_SRAM_SIZE=0x10000
+CM4_APP_SRAM_START=0x08040000
+CM4_APP_SRAM_SIZE=0xBF800
+CM0P_BTLDR_SRAM_START=0x08000000
+CM0P_BTLDR_SRAM_SIZE=0x30000
+MCUBOOT_PRIMARY_SLOT_START_ADDR=0x10020000
+ifeq ($(USE_EXT_FLASH), 1)
+CM4_APP_FLASH_SIZE=0x1A0000
+MCUBOOT_SECONDARY_SLOT_START_ADDR=0x18000000
+MCUBOOT_SLOT_SIZE=0x1C0000
+TOTAL_APP_FLASH_SIZE=0x380000
+CM4_APP_SECONDARY_FLASH_START=0x18020000
+MCUBOOT_MAX_IMG_SECTORS=3584
+else
+CM4_APP_FLASH_SIZE=0xC0000
+MCUBOOT_SECONDARY_SLOT_START_ADDR=0x10100000
+MCUBOOT_SLOT_SIZE=0xE0000
+TOTAL_APP_FLASH_SIZE=0x1C0000
+CM4_APP_SECONDARY_FLASH_START=0x10120000
+MCUBOOT_MAX_IMG_SECTORS=1792
+endif
@@ -0,0 +1,868 @@
+/******************************************************************************
+* File Name: dfu_chunk_hash_sim.c
+*
+* Description: Host harness for the chunk hashes of the DFU in the CM4
+*   project (dfu_chunk_hash.c, DFU_CHUNK_HASH=1). The SHA-256 of the crypto
+*   block is replaced by a software SHA-256, and dfu_flash_read() reads a
+*   simulated update slot that the harness writes row by row, as the DFU
+*   does.
+*
+*   The tests check that:
+*   - The root of the chunk hashes (chunk_hash_root()) matches the roots of
+*     chunk_hash.py and a recursive RFC 6962 reference for 1 to
+*     DFU_CHUNK_HASH_MAX_CHUNKS chunks, and a wrong root refuses the list.
+*   - Malformed or out-of-order chunk hash rows are refused.
+*   - dfu_chunk_hash_check_row() accepts a clean transfer, reports a
+*     corrupted chunk once at its last row, and accepts it when it is sent
+*     again; the chunks of a sparse transfer are checked by a later row.
+*   - dfu_chunk_hash_check_root() only accepts the root signed into the image.
+*
+*   Build:
+*   gcc -o dfu_chunk_hash_sim -DDFU_CHUNK_HASH
+*       -Itools/dfu_chunk_hash_sim/host_include -Iproj_cm4/source
+*       proj_cm4/source/dfu_chunk_hash.c
+*       tools/dfu_chunk_hash_sim/dfu_chunk_hash_sim.c
+*
+*   Example Usage:
+*   dfu_chunk_hash_sim
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "cy_pdl.h"
+#include "dfu_chunk_hash.h"
+#include "dfu_flash.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Simulated update slot, the image header takes the first two rows */
+#define SIM_SLOT_ADDR                   (0x10080000UL)
+#define SIM_SLOT_SIZE                   (0x48000UL)
+#define SIM_PAYLOAD_ADDR                (SIM_SLOT_ADDR + 0x400UL)
+
+/* Erased value of the internal flash, see ERASED_VALUE in the Makefile */
+#define SIM_ERASED_VAL                  (0x00u)
+
+/* Payload data of the golden roots, byte i of the payload is i * 13 + 5 */
+#define SIM_PATTERN(i)                  ((uint8_t)(((i) * 13u) + 5u))
+
+/* Largest list of chunk hashes, with its header */
+#define SIM_META_SIZE                   (sizeof(dfu_chunk_hash_meta_t) + \
+                                         (DFU_CHUNK_HASH_MAX_CHUNKS * DFU_CHUNK_HASH_SIZE))
+#define SIM_META_ROWS                   ((SIM_META_SIZE + CY_FLASH_SIZEOF_ROW - 1u) / CY_FLASH_SIZEOF_ROW)
+
+/* How a row is written by write_payload() */
+#define SIM_ROW_WRITE                   (0u)
+#define SIM_ROW_SKIP                    (1u)    /* Left out of a sparse transfer */
+#define SIM_ROW_CORRUPT                 (2u)    /* One byte written wrong */
+
+#define SIM_SHA256_ROUNDS               (64u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Root computed by chunk_hash.py for a payload of the SIM_PATTERN data */
+typedef struct
+{
+    uint32_t chunk_size;
+    uint32_t payload_size;
+    uint8_t root[DFU_CHUNK_HASH_SIZE];
+} sim_golden_root_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const uint32_t sha256_k[SIM_SHA256_ROUNDS] =
+{
+    0x428A2F98UL, 0x71374491UL, 0xB5C0FBCFUL, 0xE9B5DBA5UL, 0x3956C25BUL, 0x59F111F1UL, 0x923F82A4UL, 0xAB1C5ED5UL,
+    0xD807AA98UL, 0x12835B01UL, 0x243185BEUL, 0x550C7DC3UL, 0x72BE5D74UL, 0x80DEB1FEUL, 0x9BDC06A7UL, 0xC19BF174UL,
+    0xE49B69C1UL, 0xEFBE4786UL, 0x0FC19DC6UL, 0x240CA1CCUL, 0x2DE92C6FUL, 0x4A7484AAUL, 0x5CB0A9DCUL, 0x76F988DAUL,
+    0x983E5152UL, 0xA831C66DUL, 0xB00327C8UL, 0xBF597FC7UL, 0xC6E00BF3UL, 0xD5A79147UL, 0x06CA6351UL, 0x14292967UL,
+    0x27B70A85UL, 0x2E1B2138UL, 0x4D2C6DFCUL, 0x53380D13UL, 0x650A7354UL, 0x766A0ABBUL, 0x81C2C92EUL, 0x92722C85UL,
+    0xA2BFE8A1UL, 0xA81A664BUL, 0xC24B8B70UL, 0xC76C51A3UL, 0xD192E819UL, 0xD6990624UL, 0xF40E3585UL, 0x106AA070UL,
+    0x19A4C116UL, 0x1E376C08UL, 0x2748774CUL, 0x34B0BCB5UL, 0x391C0CB3UL, 0x4ED8AA4AUL, 0x5B9CCA4FUL, 0x682E6FF3UL,
+    0x748F82EEUL, 0x78A5636FUL, 0x84C87814UL, 0x8CC70208UL, 0x90BEFFFAUL, 0xA4506CEBUL, 0xBEF9A3F7UL, 0xC67178F2UL
+};
+
+static const uint32_t sha256_init[8] =
+{
+    0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL, 0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+/* Roots printed by merkle_root(chunk_leaves()) of chunk_hash.py */
+static const sim_golden_root_t golden_roots[] =
+{
+    {
+        1024u, 1024u,
+        { 0xD6, 0x3D, 0xE4, 0x52, 0x67, 0x53, 0xF6, 0x6C, 0x3A, 0xBF, 0x1B, 0xD2, 0xA8, 0x66, 0x4E, 0xF8,
+          0xC2, 0x85, 0x96, 0x4D, 0xD3, 0x0E, 0x33, 0x12, 0x00, 0xF9, 0xDE, 0x30, 0x10, 0xCC, 0x6D, 0xE9 }
+    },
+    {
+        1024u, 4820u,
+        { 0x7E, 0xD4, 0x5F, 0xE9, 0x9A, 0xF3, 0x4D, 0x6B, 0x87, 0x96, 0xAF, 0x72, 0x43, 0x00, 0xF7, 0x30,
+          0xAE, 0x8B, 0x15, 0xB6, 0x4E, 0x44, 0xAC, 0x99, 0x5A, 0xC5, 0x8A, 0x11, 0x05, 0x92, 0x4C, 0x1F }
+    },
+    {
+        1024u, 7168u,
+        { 0xC1, 0xEF, 0x3E, 0x41, 0x88, 0x74, 0xA7, 0x91, 0x91, 0xAA, 0x88, 0xCB, 0x24, 0xF9, 0xC9, 0xA0,
+          0xB1, 0xA5, 0xF7, 0xF5, 0x83, 0x80, 0x7E, 0x7E, 0x08, 0xAB, 0x97, 0x8C, 0x7B, 0x59, 0xD7, 0x5C }
+    },
+    {
+        512u, 262044u,
+        { 0x72, 0x2C, 0x83, 0x30, 0x98, 0xEA, 0xC5, 0x91, 0x33, 0x82, 0xD4, 0x91, 0xB7, 0x58, 0xDD, 0x6B,
+          0x57, 0xFE, 0xC8, 0x67, 0xC6, 0x42, 0xCE, 0xBA, 0xB5, 0x16, 0xB1, 0xF1, 0xDF, 0x3A, 0x41, 0x17 }
+    }
+};
+
+/* Simulated update slot */
+static uint8_t sim_slot[SIM_SLOT_SIZE];
+
+/* Image payload as built, before it is written */
+static uint8_t sim_payload[SIM_SLOT_SIZE];
+
+/* List of chunk hashes sent ahead of the image */
+CY_ALIGN(4) static uint8_t sim_meta[SIM_META_ROWS * CY_FLASH_SIZEOF_ROW];
+
+static uint32_t sha_inits;
+static uint32_t sha_frees;
+
+static uint32_t checks;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: sha256_block
+ ********************************************************************************
+ * Summary:
+ *   Processes one 64-byte block (FIPS 180-4, 6.2.2).
+ *
+ *******************************************************************************/
+#define SHA256_ROTR(x, n)               (((x) >> (n)) | ((x) << (32u - (n))))
+
+static void sha256_block(uint32_t hash[8], const uint8_t block[CY_CRYPTO_SHA256_BLOCK_SIZE])
+{
+    uint32_t w[SIM_SHA256_ROUNDS];
+    uint32_t v[8];
+
+    for (uint32_t i = 0u; i < 16u; i++)
+    {
+        w[i] = ((uint32_t)block[4u * i] << 24u) | ((uint32_t)block[(4u * i) + 1u] << 16u) |
+               ((uint32_t)block[(4u * i) + 2u] << 8u) | (uint32_t)block[(4u * i) + 3u];
+    }
+    for (uint32_t i = 16u; i < SIM_SHA256_ROUNDS; i++)
+    {
+        uint32_t s0 = SHA256_ROTR(w[i - 15u], 7u) ^ SHA256_ROTR(w[i - 15u], 18u) ^ (w[i - 15u] >> 3u);
+        uint32_t s1 = SHA256_ROTR(w[i - 2u], 17u) ^ SHA256_ROTR(w[i - 2u], 19u) ^ (w[i - 2u] >> 10u);
+
+        w[i] = w[i - 16u] + s0 + w[i - 7u] + s1;
+    }
+
+    memcpy(v, hash, sizeof(v));
+    for (uint32_t i = 0u; i < SIM_SHA256_ROUNDS; i++)
+    {
+        uint32_t s1 = SHA256_ROTR(v[4], 6u) ^ SHA256_ROTR(v[4], 11u) ^ SHA256_ROTR(v[4], 25u);
+        uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        uint32_t t1 = v[7] + s1 + ch + sha256_k[i] + w[i];
+        uint32_t s0 = SHA256_ROTR(v[0], 2u) ^ SHA256_ROTR(v[0], 13u) ^ SHA256_ROTR(v[0], 22u);
+        uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+
+        memmove(&v[1], &v[0], 7u * sizeof(uint32_t));
+        v[4] += t1;
+        v[0] = t1 + s0 + maj;
+    }
+
+    for (uint32_t i = 0u; i < 8u; i++)
+    {
+        hash[i] += v[i];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: Cy_Crypto_Core_Enable
+ ********************************************************************************
+ * Summary:
+ *   Software stand-in of the SHA-256 functions of the crypto block used by
+ *   dfu_chunk_hash.c.
+ *
+ *******************************************************************************/
+cy_en_crypto_status_t Cy_Crypto_Core_Enable(CRYPTO_Type *base)
+{
+    (void)base;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Init(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                              cy_en_crypto_sha_mode_t mode, void *shaBuffers)
+{
+    (void)base;
+
+    if ((mode != CY_CRYPTO_MODE_SHA256) || (shaBuffers == NULL))
+    {
+        return CY_CRYPTO_BAD_PARAMS;
+    }
+
+    hashState->buffers = (cy_stc_crypto_v1_sha256_buffers_t *)shaBuffers;
+    sha_inits++;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Start(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState)
+{
+    (void)base;
+
+    memcpy(hashState->buffers->hash, sha256_init, sizeof(sha256_init));
+    hashState->blockIdx = 0u;
+    hashState->messageSize = 0u;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Update(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                                uint8_t const *message, uint32_t messageSize)
+{
+    cy_stc_crypto_v1_sha256_buffers_t *ctx = hashState->buffers;
+
+    (void)base;
+
+    for (uint32_t i = 0u; i < messageSize; i++)
+    {
+        ctx->block[hashState->blockIdx++] = message[i];
+        if (hashState->blockIdx == CY_CRYPTO_SHA256_BLOCK_SIZE)
+        {
+            sha256_block(ctx->hash, ctx->block);
+            hashState->blockIdx = 0u;
+        }
+    }
+    hashState->messageSize += messageSize;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Finish(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                                uint8_t *digest)
+{
+    cy_stc_crypto_v1_sha256_buffers_t *ctx = hashState->buffers;
+    uint64_t bits = hashState->messageSize * 8u;
+    uint8_t pad = 0x80u;
+
+    (void)Cy_Crypto_Core_Sha_Update(base, hashState, &pad, 1u);
+    pad = 0x00u;
+    while (hashState->blockIdx != (CY_CRYPTO_SHA256_BLOCK_SIZE - 8u))
+    {
+        (void)Cy_Crypto_Core_Sha_Update(base, hashState, &pad, 1u);
+    }
+    for (uint32_t i = 8u; i-- != 0u;)
+    {
+        pad = (uint8_t)(bits >> (8u * i));
+        (void)Cy_Crypto_Core_Sha_Update(base, hashState, &pad, 1u);
+    }
+
+    for (uint32_t i = 0u; i < 8u; i++)
+    {
+        digest[4u * i] = (uint8_t)(ctx->hash[i] >> 24u);
+        digest[(4u * i) + 1u] = (uint8_t)(ctx->hash[i] >> 16u);
+        digest[(4u * i) + 2u] = (uint8_t)(ctx->hash[i] >> 8u);
+        digest[(4u * i) + 3u] = (uint8_t)(ctx->hash[i]);
+    }
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Free(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState)
+{
+    (void)base;
+    hashState->buffers = NULL;
+    sha_frees++;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Sha(CRYPTO_Type *base, uint8_t const *message, uint32_t messageSize,
+                                         uint8_t *digest, cy_en_crypto_sha_mode_t mode)
+{
+    cy_stc_crypto_v1_sha256_buffers_t buffers;
+    cy_stc_crypto_sha_state_t state = { 0 };
+    cy_en_crypto_status_t status = Cy_Crypto_Core_Sha_Init(base, &state, mode, &buffers);
+
+    if (status == CY_CRYPTO_SUCCESS)
+    {
+        (void)Cy_Crypto_Core_Sha_Start(base, &state);
+        (void)Cy_Crypto_Core_Sha_Update(base, &state, message, messageSize);
+        (void)Cy_Crypto_Core_Sha_Finish(base, &state, digest);
+        (void)Cy_Crypto_Core_Sha_Free(base, &state);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_flash_read
+ ********************************************************************************
+ * Summary:
+ *   Reads the simulated update slot, in place of dfu_flash.c.
+ *
+ *******************************************************************************/
+cy_en_dfu_status_t dfu_flash_read(uint32_t address, void *data, uint32_t length)
+{
+    if ((address < SIM_SLOT_ADDR) || (length > SIM_SLOT_SIZE) ||
+        ((address - SIM_SLOT_ADDR) > (SIM_SLOT_SIZE - length)))
+    {
+        return CY_DFU_ERROR_ADDRESS;
+    }
+
+    memcpy(data, &sim_slot[address - SIM_SLOT_ADDR], length);
+
+    return CY_DFU_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: sha256
+ ********************************************************************************
+ * Summary:
+ *   SHA-256 of a prefix byte and a buffer, for the reference tree.
+ *
+ *******************************************************************************/
+static void sha256(uint8_t prefix, const uint8_t *data, uint32_t size, uint8_t *digest)
+{
+    cy_stc_crypto_v1_sha256_buffers_t buffers;
+    cy_stc_crypto_sha_state_t state = { .buffers = &buffers };
+
+    (void)Cy_Crypto_Core_Sha_Start(CRYPTO, &state);
+    (void)Cy_Crypto_Core_Sha_Update(CRYPTO, &state, &prefix, 1u);
+    (void)Cy_Crypto_Core_Sha_Update(CRYPTO, &state, data, size);
+    (void)Cy_Crypto_Core_Sha_Finish(CRYPTO, &state, digest);
+}
+
+/*******************************************************************************
+ * Function Name: reference_root
+ ********************************************************************************
+ * Summary:
+ *   Merkle root of RFC 6962, 2.1, computed recursively as in chunk_hash.py:
+ *   the left subtree holds the largest power of two leaves smaller than the
+ *   leaf count.
+ *
+ *******************************************************************************/
+static void reference_root(const uint8_t *leaves, uint32_t count, uint8_t *root)
+{
+    uint8_t node[2u * DFU_CHUNK_HASH_SIZE];
+    uint32_t split = 1u;
+
+    if (count == 1u)
+    {
+        memcpy(root, leaves, DFU_CHUNK_HASH_SIZE);
+        return;
+    }
+
+    while ((split * 2u) < count)
+    {
+        split *= 2u;
+    }
+
+    reference_root(leaves, split, node);
+    reference_root(&leaves[split * DFU_CHUNK_HASH_SIZE], count - split, &node[DFU_CHUNK_HASH_SIZE]);
+    sha256(0x01u, node, sizeof(node), root);
+}
+
+/*******************************************************************************
+ * Function Name: build_image
+ ********************************************************************************
+ * Summary:
+ *   Fills the payload with the SIM_PATTERN data, or with the erased value in
+ *   the rows of skip_rows, erases the slot, and builds the list of chunk
+ *   hashes with the reference root.
+ *
+ * Parameters:
+ *   chunk_size   - Chunk size
+ *   payload_size - Payload size
+ *   skip_rows    - Payload row to leave out of the transfer, or UINT32_MAX
+ *
+ * Return:
+ *   uint32_t - Number of chunks
+ *
+ *******************************************************************************/
+static uint32_t build_image(uint32_t chunk_size, uint32_t payload_size, uint32_t skip_row)
+{
+    dfu_chunk_hash_meta_t *meta = (dfu_chunk_hash_meta_t *)sim_meta;
+    uint8_t *leaves = &sim_meta[sizeof(dfu_chunk_hash_meta_t)];
+    uint32_t count = (payload_size + chunk_size - 1u) / chunk_size;
+
+    for (uint32_t i = 0u; i < payload_size; i++)
+    {
+        sim_payload[i] = ((i / CY_FLASH_SIZEOF_ROW) == skip_row) ? SIM_ERASED_VAL : SIM_PATTERN(i);
+    }
+    memset(sim_slot, SIM_ERASED_VAL, sizeof(sim_slot));
+    memset(sim_meta, 0, sizeof(sim_meta));
+
+    meta->magic = DFU_CHUNK_HASH_MAGIC;
+    meta->payload_addr = SIM_PAYLOAD_ADDR;
+    meta->payload_size = payload_size;
+    meta->chunk_size = chunk_size;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        uint32_t size = ((i + 1u) == count) ? (payload_size - (i * chunk_size)) : chunk_size;
+
+        sha256(0x00u, &sim_payload[i * chunk_size], size, &leaves[i * DFU_CHUNK_HASH_SIZE]);
+    }
+    reference_root(leaves, count, meta->root);
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: send_meta
+ ********************************************************************************
+ * Summary:
+ *   Sends the rows of the list of chunk hashes as the DFU does.
+ *
+ * Return:
+ *   cy_en_dfu_status_t - Status of the last row sent
+ *
+ *******************************************************************************/
+static cy_en_dfu_status_t send_meta(uint32_t count)
+{
+    uint32_t rows = (sizeof(dfu_chunk_hash_meta_t) + (count * DFU_CHUNK_HASH_SIZE) + CY_FLASH_SIZEOF_ROW - 1u) /
+                    CY_FLASH_SIZEOF_ROW;
+    cy_en_dfu_status_t status = CY_DFU_SUCCESS;
+
+    for (uint32_t row = 0u; (row < rows) && (status == CY_DFU_SUCCESS); row++)
+    {
+        status = dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR + (row * CY_FLASH_SIZEOF_ROW),
+                                           &sim_meta[row * CY_FLASH_SIZEOF_ROW]);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: write_row
+ ********************************************************************************
+ * Summary:
+ *   Writes a payload row to the slot as set by mode, then checks it as
+ *   dfu_user.c does after the write.
+ *
+ * Return:
+ *   cy_en_dfu_status_t - Result of dfu_chunk_hash_check_row(), or
+ *                        CY_DFU_SUCCESS for a row left out
+ *
+ *******************************************************************************/
+static cy_en_dfu_status_t write_row(uint32_t row, uint32_t mode)
+{
+    uint32_t offset = row * CY_FLASH_SIZEOF_ROW;
+    uint8_t *dst = &sim_slot[(SIM_PAYLOAD_ADDR - SIM_SLOT_ADDR) + offset];
+
+    if (mode == SIM_ROW_SKIP)
+    {
+        return CY_DFU_SUCCESS;
+    }
+
+    /* The payload of the last row is followed by the TLV area, not simulated */
+    memcpy(dst, &sim_payload[offset], CY_FLASH_SIZEOF_ROW);
+    if (mode == SIM_ROW_CORRUPT)
+    {
+        dst[CY_FLASH_SIZEOF_ROW / 3u] ^= 0x10u;
+    }
+
+    return dfu_chunk_hash_check_row(SIM_PAYLOAD_ADDR + offset);
+}
+
+/*******************************************************************************
+ * Function Name: check
+ ********************************************************************************
+ * Summary:
+ *   Counts a check and prints it if it failed.
+ *
+ * Return:
+ *   bool - ok
+ *
+ *******************************************************************************/
+static bool check(bool ok, const char *what, uint32_t step)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("  FAIL: %s, step %" PRIu32 "\n", what, step);
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: report
+ ********************************************************************************
+ * Summary:
+ *   Prints the outcome of a test.
+ *
+ *******************************************************************************/
+static void report(const char *name, uint32_t first_failure)
+{
+    printf("%-28s %s\n", name, (failures == first_failure) ? "passed" : "FAILED");
+}
+
+/*******************************************************************************
+ * Function Name: test_sha256
+ ********************************************************************************
+ * Summary:
+ *   The software SHA-256 matches the "abc" example of FIPS 180-4 and a
+ *   message of several blocks.
+ *
+ *******************************************************************************/
+static void test_sha256(void)
+{
+    static const uint8_t abc_digest[CY_CRYPTO_SHA256_DIGEST_SIZE] =
+    {
+        0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+        0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+    };
+    static const uint8_t long_digest[CY_CRYPTO_SHA256_DIGEST_SIZE] =
+    {
+        0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8, 0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+        0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67, 0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1
+    };
+    static const char long_msg[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    const uint32_t first_failure = failures;
+    uint8_t digest[CY_CRYPTO_SHA256_DIGEST_SIZE];
+
+    (void)Cy_Crypto_Core_Sha(CRYPTO, (const uint8_t *)"abc", 3u, digest, CY_CRYPTO_MODE_SHA256);
+    (void)check(memcmp(digest, abc_digest, sizeof(digest)) == 0, "wrong digest of \"abc\"", 1u);
+    (void)Cy_Crypto_Core_Sha(CRYPTO, (const uint8_t *)long_msg, sizeof(long_msg) - 1u, digest, CY_CRYPTO_MODE_SHA256);
+    (void)check(memcmp(digest, long_digest, sizeof(digest)) == 0, "wrong digest of two blocks", 2u);
+
+    report("Software SHA-256", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_root
+ ********************************************************************************
+ * Summary:
+ *   The root computed by chunk_hash_root() when the list is received
+ *   matches the roots of chunk_hash.py and of the reference tree for every
+ *   chunk count, and a list with a wrong root is refused.
+ *
+ *******************************************************************************/
+static void test_root(void)
+{
+    dfu_chunk_hash_meta_t *meta = (dfu_chunk_hash_meta_t *)sim_meta;
+    const uint32_t first_failure = failures;
+
+    for (uint32_t i = 0u; i < (sizeof(golden_roots) / sizeof(golden_roots[0])); i++)
+    {
+        const sim_golden_root_t *golden = &golden_roots[i];
+        uint32_t count = build_image(golden->chunk_size, golden->payload_size, UINT32_MAX);
+
+        (void)check(memcmp(meta->root, golden->root, DFU_CHUNK_HASH_SIZE) == 0,
+                    "reference root differs from chunk_hash.py", count);
+        (void)check(send_meta(count) == CY_DFU_SUCCESS, "list with the root of chunk_hash.py refused", count);
+    }
+
+    for (uint32_t count = 1u; count <= DFU_CHUNK_HASH_MAX_CHUNKS; count++)
+    {
+        (void)build_image(CY_FLASH_SIZEOF_ROW, count * CY_FLASH_SIZEOF_ROW, UINT32_MAX);
+        if (!check(send_meta(count) == CY_DFU_SUCCESS, "list refused", count))
+        {
+            continue;
+        }
+
+        meta->root[count % DFU_CHUNK_HASH_SIZE] ^= 0x01u;
+        (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "list with a wrong root accepted", count);
+        meta->root[count % DFU_CHUNK_HASH_SIZE] ^= 0x01u;
+
+        /* A changed leaf changes the root */
+        sim_meta[sizeof(dfu_chunk_hash_meta_t) + (((count - 1u) * DFU_CHUNK_HASH_SIZE))] ^= 0x80u;
+        (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "list with a wrong leaf accepted", count);
+    }
+    (void)check(sha_inits == sha_frees, "hash state not freed", 0u);
+
+    report("Root of the chunk hashes", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_meta
+ ********************************************************************************
+ * Summary:
+ *   Malformed headers and rows out of order are refused, and the first row
+ *   starts the list again.
+ *
+ *******************************************************************************/
+static void test_meta(void)
+{
+    dfu_chunk_hash_meta_t *meta = (dfu_chunk_hash_meta_t *)sim_meta;
+    const uint32_t first_failure = failures;
+    uint32_t count = build_image(1024u, 40u * 1024u, UINT32_MAX);
+
+    (void)check(dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR + CY_FLASH_SIZEOF_ROW,
+                                          &sim_meta[CY_FLASH_SIZEOF_ROW]) == CY_DFU_ERROR_DATA,
+                "second row accepted first", 1u);
+    (void)check((dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR, sim_meta) == CY_DFU_SUCCESS) &&
+                (dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR, sim_meta) == CY_DFU_SUCCESS) &&
+                (dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR + (2u * CY_FLASH_SIZEOF_ROW),
+                                           &sim_meta[2u * CY_FLASH_SIZEOF_ROW]) == CY_DFU_ERROR_DATA),
+                "row skipped after a restart", 2u);
+    (void)check(send_meta(count) == CY_DFU_SUCCESS, "list refused after a restart", 3u);
+    (void)check(dfu_chunk_hash_write_meta(DFU_CHUNK_HASH_ADDR + CY_FLASH_SIZEOF_ROW,
+                                          &sim_meta[CY_FLASH_SIZEOF_ROW]) == CY_DFU_ERROR_DATA,
+                "row accepted after a complete list", 4u);
+
+    meta->magic ^= 1u;
+    (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "wrong magic accepted", 5u);
+    meta->magic ^= 1u;
+
+    meta->chunk_size = 1000u;
+    (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "chunk size not a multiple of the row accepted", 6u);
+
+    meta->chunk_size = CY_FLASH_SIZEOF_ROW;
+    meta->payload_size = (DFU_CHUNK_HASH_MAX_CHUNKS + 1u) * CY_FLASH_SIZEOF_ROW;
+    (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "too many chunks accepted", 7u);
+
+    meta->payload_size = 0u;
+    (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "empty payload accepted", 8u);
+
+    meta->payload_size = 40u * 1024u;
+    meta->payload_addr = SIM_PAYLOAD_ADDR + 4u;
+    (void)check(send_meta(count) == CY_DFU_ERROR_DATA, "unaligned payload accepted", 9u);
+
+    dfu_chunk_hash_reset();
+    report("Chunk hash rows", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: resend_chunk
+ ********************************************************************************
+ * Summary:
+ *   Writes the rows first to last again, with the row corrupt_row written
+ *   wrong and the row skip_row left out.
+ *
+ * Return:
+ *   uint32_t - Number of rows refused
+ *
+ *******************************************************************************/
+static uint32_t resend_chunk(uint32_t first, uint32_t last, uint32_t corrupt_row, uint32_t skip_row)
+{
+    uint32_t refused = 0u;
+
+    for (uint32_t row = first; row <= last; row++)
+    {
+        uint32_t mode = (row == corrupt_row) ? SIM_ROW_CORRUPT : ((row == skip_row) ? SIM_ROW_SKIP : SIM_ROW_WRITE);
+
+        if (write_row(row, mode) != CY_DFU_SUCCESS)
+        {
+            refused++;
+        }
+    }
+
+    return refused;
+}
+
+/*******************************************************************************
+ * Function Name: transfer
+ ********************************************************************************
+ * Summary:
+ *   Writes all payload rows in order, with the row corrupt_row written wrong
+ *   and the row skip_row left out, then checks that only the chunk of
+ *   corrupt_row was refused and reported, and that it is refused again when
+ *   sent again corrupted and accepted when sent again correctly.
+ *
+ *******************************************************************************/
+static void transfer(uint32_t chunk_size, uint32_t payload_size, uint32_t corrupt_row, uint32_t skip_row,
+                     uint32_t step)
+{
+    uint32_t rows = (payload_size + CY_FLASH_SIZEOF_ROW - 1u) / CY_FLASH_SIZEOF_ROW;
+    uint32_t rows_per_chunk = chunk_size / CY_FLASH_SIZEOF_ROW;
+    uint32_t count = build_image(chunk_size, payload_size, skip_row);
+    uint32_t refused = 0u;
+    uint32_t refused_row = UINT32_MAX;
+    uint32_t bad_addr = 0u;
+    bool bad;
+
+    dfu_chunk_hash_reset();
+    if (!check(send_meta(count) == CY_DFU_SUCCESS, "list refused", step))
+    {
+        return;
+    }
+
+    /* The image header rows are not part of a chunk */
+    (void)check(dfu_chunk_hash_check_row(SIM_SLOT_ADDR) == CY_DFU_SUCCESS, "header row refused", step);
+
+    for (uint32_t row = 0u; row < rows; row++)
+    {
+        uint32_t mode = (row == corrupt_row) ? SIM_ROW_CORRUPT : ((row == skip_row) ? SIM_ROW_SKIP : SIM_ROW_WRITE);
+
+        if (write_row(row, mode) != CY_DFU_SUCCESS)
+        {
+            refused++;
+            refused_row = row;
+
+            bad = dfu_chunk_hash_bad_chunk(&bad_addr);
+            (void)check(bad && (bad_addr == (SIM_PAYLOAD_ADDR + ((corrupt_row / rows_per_chunk) * chunk_size))),
+                        "wrong chunk reported", step);
+            (void)check(!dfu_chunk_hash_bad_chunk(&bad_addr), "chunk reported twice", step);
+
+            /* The host sends the rows of the chunk again, first with the
+             * same row corrupted, then correctly
+             */
+            (void)check(resend_chunk(corrupt_row / rows_per_chunk * rows_per_chunk, row, corrupt_row, skip_row) == 1u,
+                        "corrupted chunk accepted when sent again", step);
+            (void)check(dfu_chunk_hash_bad_chunk(&bad_addr), "chunk sent again not reported", step);
+            (void)check(resend_chunk(corrupt_row / rows_per_chunk * rows_per_chunk, row, UINT32_MAX, skip_row) == 0u,
+                        "resent chunk refused", step);
+        }
+    }
+
+    if (corrupt_row == UINT32_MAX)
+    {
+        (void)check(refused == 0u, "clean transfer refused", step);
+    }
+    else
+    {
+        /* The chunk is refused by its last row, or by the next row written
+         * when its last rows were left out
+         */
+        uint32_t chunk_last = (((corrupt_row / rows_per_chunk) + 1u) * rows_per_chunk) - 1u;
+
+        chunk_last = (chunk_last < rows) ? chunk_last : (rows - 1u);
+        if ((skip_row == chunk_last) && (chunk_last + 1u < rows))
+        {
+            chunk_last++;
+        }
+        (void)check((refused == 1u) && (refused_row == chunk_last), "corrupted chunk not refused at its end", step);
+    }
+
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, payload_size, ((dfu_chunk_hash_meta_t *)sim_meta)->root) ==
+                CY_DFU_SUCCESS, "signed root refused", step);
+}
+
+/*******************************************************************************
+ * Function Name: test_check_row
+ ********************************************************************************
+ * Summary:
+ *   Transfers with and without a corrupted row, and with the last row of a
+ *   chunk left out of a sparse transfer.
+ *
+ *******************************************************************************/
+static void test_check_row(void)
+{
+    const uint32_t first_failure = failures;
+    const uint32_t chunk = 4096u;
+    const uint32_t size = (9u * chunk) + 700u;
+
+    transfer(chunk, size, UINT32_MAX, UINT32_MAX, 1u);
+    transfer(chunk, size, 0u, UINT32_MAX, 2u);
+    transfer(chunk, size, 13u, UINT32_MAX, 3u);
+    transfer(chunk, size, 15u, UINT32_MAX, 4u);
+    transfer(chunk, size, (size - 1u) / CY_FLASH_SIZEOF_ROW, UINT32_MAX, 5u);
+    transfer(chunk, size, UINT32_MAX, 23u, 6u);
+    transfer(chunk, size, 17u, 23u, 7u);
+    transfer(CY_FLASH_SIZEOF_ROW, 64u * CY_FLASH_SIZEOF_ROW, 31u, UINT32_MAX, 8u);
+
+    /* Rows of an image without chunk hashes are accepted */
+    dfu_chunk_hash_reset();
+    (void)build_image(chunk, size, UINT32_MAX);
+    (void)check(write_row(2u, SIM_ROW_CORRUPT) == CY_DFU_SUCCESS, "row refused without a list", 9u);
+    (void)check(write_row(7u, SIM_ROW_CORRUPT) == CY_DFU_SUCCESS, "row refused without a list", 9u);
+
+    report("Row checks", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_check_root
+ ********************************************************************************
+ * Summary:
+ *   The list must belong to the validated image: its root must be the one
+ *   signed into the image and the payload must have the same size.
+ *
+ *******************************************************************************/
+static void test_check_root(void)
+{
+    dfu_chunk_hash_meta_t *meta = (dfu_chunk_hash_meta_t *)sim_meta;
+    const uint32_t first_failure = failures;
+    uint8_t root[DFU_CHUNK_HASH_SIZE];
+    uint32_t count = build_image(1024u, 5000u, UINT32_MAX);
+
+    dfu_chunk_hash_reset();
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, 5000u, NULL) == CY_DFU_SUCCESS,
+                "image refused without a list", 1u);
+
+    (void)check(send_meta(count) == CY_DFU_SUCCESS, "list refused", 2u);
+    memcpy(root, meta->root, sizeof(root));
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, 5000u, root) == CY_DFU_SUCCESS, "signed root refused", 2u);
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, 5000u, NULL) == CY_DFU_ERROR_VERIFY,
+                "image without a root accepted", 3u);
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, 5512u, root) == CY_DFU_ERROR_VERIFY,
+                "other payload size accepted", 4u);
+    root[0] ^= 0x01u;
+    (void)check(dfu_chunk_hash_check_root(SIM_PAYLOAD_ADDR, 5000u, root) == CY_DFU_ERROR_VERIFY,
+                "other root accepted", 5u);
+    (void)check(dfu_chunk_hash_check_root(SIM_SLOT_ADDR + 0x20000UL, 5000u, root) == CY_DFU_SUCCESS,
+                "image of the other slot refused", 6u);
+
+    dfu_chunk_hash_reset();
+    report("Signed root", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Runs the tests.
+ *
+ * Return:
+ *   int - 0 if all the checks passed, 1 otherwise
+ *
+ *******************************************************************************/
+int main(void)
+{
+    test_sha256();
+    test_root();
+    test_meta();
+    test_check_row();
+    test_check_root();
+
+    printf("%" PRIu32 " checks, %" PRIu32 " failed\n", checks, failures);
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
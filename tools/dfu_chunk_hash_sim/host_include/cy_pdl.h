@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host stand-in for the parts of the PDL used by
+*   dfu_chunk_hash.c. The SHA-256 functions of the crypto block are
+*   implemented in software by dfu_chunk_hash_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CY_PDL_H
+#define CY_PDL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CY_ALIGN(align)                 __attribute__((aligned(align)))
+#define CY_FLASH_SIZEOF_ROW             (512u)
+
+#define CY_CRYPTO_SHA256_DIGEST_SIZE    (32u)
+#define CY_CRYPTO_SHA256_BLOCK_SIZE     (64u)
+
+#define CRYPTO                          ((CRYPTO_Type *)NULL)
+
+typedef struct CRYPTO_Type CRYPTO_Type;
+
+typedef enum
+{
+    CY_CRYPTO_SUCCESS = 0x00UL,
+    CY_CRYPTO_BAD_PARAMS = 0x01UL,
+    CY_CRYPTO_HW_NOT_ENABLED = 0x02UL,
+    CY_CRYPTO_HW_ERROR = 0x03UL,
+} cy_en_crypto_status_t;
+
+typedef enum
+{
+    CY_CRYPTO_MODE_SHA256 = 0x02UL,
+} cy_en_crypto_sha_mode_t;
+
+/* Context of the software SHA-256 */
+typedef struct
+{
+    uint32_t hash[8];
+    uint8_t block[CY_CRYPTO_SHA256_BLOCK_SIZE];
+} cy_stc_crypto_v1_sha256_buffers_t;
+
+typedef struct
+{
+    cy_stc_crypto_v1_sha256_buffers_t *buffers;
+    uint32_t blockIdx;
+    uint64_t messageSize;
+} cy_stc_crypto_sha_state_t;
+
+cy_en_crypto_status_t Cy_Crypto_Core_Enable(CRYPTO_Type *base);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Init(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                              cy_en_crypto_sha_mode_t mode, void *shaBuffers);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Start(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Update(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                                uint8_t const *message, uint32_t messageSize);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Finish(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState,
+                                                uint8_t *digest);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha_Free(CRYPTO_Type *base, cy_stc_crypto_sha_state_t *hashState);
+cy_en_crypto_status_t Cy_Crypto_Core_Sha(CRYPTO_Type *base, uint8_t const *message, uint32_t messageSize,
+                                         uint8_t *digest, cy_en_crypto_sha_mode_t mode);
+
+#endif /* CY_PDL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,999 @@
+/******************************************************************************
+* File Name: dfu_decrypt_sim.c
+*
+* Description: Host harness for the decryption of encrypted DFU images in the
+*   CM4 project (dfu_decrypt.c, DFU_ENCRYPTION=1). The crypto block is
+*   replaced by a software AES-128 and the CM0+ app by a stand-in of its key
+*   unwrap, which answers, fails, or does not answer the IPC request.
+*
+*   The tests check that:
+*   - The software AES matches the FIPS-197 example vector.
+*   - Rows encrypted by encrypt_cyacd2.py decrypt to the original data.
+*   - Each row decrypts on its own, in any order.
+*   - A plain image (no EI vector) and a row that is not a multiple of the
+*     AES block size are refused.
+*   - The image key is unwrapped once per EI vector and DFU session, a failed
+*     or unanswered unwrap refuses the row, and no key is left in the request.
+*
+*   With --bench, it measures the rows per second of dfu_decrypt_row() with
+*   the software AES, i.e. the cost of decrypting without the crypto block.
+*
+*   Build:
+*   gcc -O2 -no-pie -Wno-pointer-to-int-cast -o dfu_decrypt_sim
+*       -DDFU_ENCRYPTION -Itools/dfu_decrypt_sim/host_include
+*       -Iproj_cm4/source proj_cm4/source/dfu_decrypt.c
+*       tools/dfu_decrypt_sim/dfu_decrypt_sim.c
+*
+*   The message word of the IPC holds a 32-bit address, so the harness is
+*   linked without PIE to keep its data below 4 GB.
+*
+*   Example Usage:
+*   dfu_decrypt_sim
+*   dfu_decrypt_sim --bench 20000
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <time.h>
+#include "cy_pdl.h"
+#include "cy_dfu.h"
+#include "dfu_decrypt.h"
+#include "ipc_communication.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SIM_ROW_SIZE                    (512u)
+#define SIM_BLOCK_SIZE                  (CY_CRYPTO_AES_BLOCK_SIZE)
+
+/* Rows of the benchmark by default */
+#define SIM_BENCH_ROWS                  (10000u)
+
+/* Row data of the golden vectors, byte i of a row is i * 7 + seed */
+#define SIM_PATTERN(i, seed)            ((uint8_t)(((i) * 7u) + (seed)))
+
+#define NS_PER_US                       (1000u)
+#define NS_PER_S                        (1000000000u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* How the CM0+ stand-in answers a key unwrap request */
+typedef enum
+{
+    SIM_CM0P_DONE,                  /* Key unwrapped */
+    SIM_CM0P_ERROR,                 /* Status set to IPC_STATUS_ERROR */
+    SIM_CM0P_SILENT                 /* Request not answered */
+} sim_cm0p_t;
+
+/* Row encrypted by encrypt_cyacd2.py: first and last block of the ciphertext */
+typedef struct
+{
+    uint32_t address;
+    uint8_t seed;
+    uint8_t first[SIM_BLOCK_SIZE];
+    uint8_t last[SIM_BLOCK_SIZE];
+} sim_golden_row_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const uint8_t aes_sbox[256] =
+{
+    0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+    0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+    0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+    0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+    0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+    0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+    0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+    0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+    0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+    0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+    0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+    0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+    0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+    0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+    0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+    0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+/* Inverse of aes_sbox, filled by aes_init_tables() */
+static uint8_t aes_inv_sbox[256];
+
+/* Key-encryption key of the CM0+ stand-in, the key of the example of encrypt_cyacd2.py */
+static const uint8_t sim_kek[IPC_KEY_SIZE] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+};
+
+/* Image key of the golden vectors and its wrapped value, from wrap_key() of encrypt_cyacd2.py */
+static const uint8_t golden_key[IPC_KEY_SIZE] =
+{
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static const uint8_t golden_wrapped[IPC_KEY_SIZE] =
+{
+    0x1A, 0xB7, 0x29, 0xBB, 0x89, 0x5C, 0x3B, 0xBA, 0xCA, 0xD0, 0x1C, 0x3B, 0xDD, 0x83, 0x0D, 0xC1
+};
+
+/* Rows encrypted with encrypt_row() of encrypt_cyacd2.py. The second row
+ * carries the counter from its low byte to the next one.
+ */
+static const sim_golden_row_t golden_rows[] =
+{
+    {
+        0x10100000UL, 1u,
+        { 0xE0, 0xF5, 0xD5, 0xE3, 0x1E, 0xFF, 0x92, 0xAE, 0xB5, 0x69, 0x09, 0x57, 0xAE, 0x7E, 0x63, 0x0F },
+        { 0xB5, 0x4B, 0x8B, 0x2B, 0xBD, 0x4A, 0x90, 0xAE, 0xA9, 0x4E, 0xB1, 0x8C, 0xE2, 0xD6, 0x41, 0xCB }
+    },
+    {
+        0x101FFE00UL, 2u,
+        { 0x23, 0xC9, 0x11, 0xF4, 0xAB, 0xF8, 0x03, 0x01, 0xBB, 0x17, 0x0C, 0x78, 0xDE, 0xD1, 0x5E, 0x35 },
+        { 0x7A, 0xE0, 0x73, 0xA2, 0xA3, 0xD3, 0xF4, 0xA4, 0xEF, 0xA0, 0xB8, 0x42, 0xF0, 0xD7, 0x35, 0xC4 }
+    }
+};
+
+/* CM0+ stand-in */
+static sim_cm0p_t cm0p_mode = SIM_CM0P_DONE;
+static ipc_unwrap_key_t *last_request;
+static uint32_t unwrap_requests;
+static uint32_t delay_ms;
+
+/* Crypto block stand-in */
+static bool crypto_enabled;
+static uint32_t aes_inits;
+static uint32_t aes_frees;
+
+static cy_stc_dfu_params_t dfu_params;
+
+static uint32_t checks;
+static uint32_t failures;
+
+static const struct option dfu_decrypt_sim_options[] =
+{
+    { "bench", optional_argument, NULL, 'b' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: aes_xtime
+ ********************************************************************************
+ * Summary:
+ *   Multiplies by x in GF(2^8).
+ *
+ *******************************************************************************/
+static uint8_t aes_xtime(uint8_t value)
+{
+    return (uint8_t)((value << 1u) ^ (((value & 0x80u) != 0u) ? 0x1Bu : 0x00u));
+}
+
+/*******************************************************************************
+ * Function Name: aes_mul
+ ********************************************************************************
+ * Summary:
+ *   Multiplies two elements of GF(2^8).
+ *
+ *******************************************************************************/
+static uint8_t aes_mul(uint8_t a, uint8_t b)
+{
+    uint8_t result = 0u;
+
+    while (b != 0u)
+    {
+        if ((b & 1u) != 0u)
+        {
+            result ^= a;
+        }
+        a = aes_xtime(a);
+        b >>= 1u;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: aes_init_tables
+ ********************************************************************************
+ * Summary:
+ *   Fills the inverse S-box.
+ *
+ *******************************************************************************/
+static void aes_init_tables(void)
+{
+    for (uint32_t i = 0u; i < 256u; i++)
+    {
+        aes_inv_sbox[aes_sbox[i]] = (uint8_t)i;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: aes_expand_key
+ ********************************************************************************
+ * Summary:
+ *   Computes the AES-128 round keys (FIPS-197, 5.2).
+ *
+ *******************************************************************************/
+static void aes_expand_key(const uint8_t key[CY_CRYPTO_AES_128_KEY_SIZE],
+                           uint8_t round_keys[CY_CRYPTO_AES_128_ROUND_KEYS])
+{
+    uint8_t rcon = 0x01u;
+
+    memcpy(round_keys, key, CY_CRYPTO_AES_128_KEY_SIZE);
+
+    for (uint32_t i = CY_CRYPTO_AES_128_KEY_SIZE; i < CY_CRYPTO_AES_128_ROUND_KEYS; i += 4u)
+    {
+        uint8_t word[4];
+
+        memcpy(word, &round_keys[i - 4u], sizeof(word));
+        if ((i % CY_CRYPTO_AES_128_KEY_SIZE) == 0u)
+        {
+            uint8_t first = word[0];
+
+            word[0] = aes_sbox[word[1]] ^ rcon;
+            word[1] = aes_sbox[word[2]];
+            word[2] = aes_sbox[word[3]];
+            word[3] = aes_sbox[first];
+            rcon = aes_xtime(rcon);
+        }
+
+        for (uint32_t j = 0u; j < 4u; j++)
+        {
+            round_keys[i + j] = round_keys[i + j - CY_CRYPTO_AES_128_KEY_SIZE] ^ word[j];
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: aes_encrypt_block
+ ********************************************************************************
+ * Summary:
+ *   Encrypts one block with the round keys, byte by byte as a small MCU
+ *   implementation without lookup tables for the rounds does.
+ *
+ *******************************************************************************/
+static void aes_encrypt_block(const uint8_t *round_keys, const uint8_t in[SIM_BLOCK_SIZE],
+                              uint8_t out[SIM_BLOCK_SIZE])
+{
+    uint8_t s[SIM_BLOCK_SIZE];
+    uint8_t t[SIM_BLOCK_SIZE];
+
+    for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+    {
+        s[i] = in[i] ^ round_keys[i];
+    }
+
+    for (uint32_t round = 1u; round <= CY_CRYPTO_AES_128_ROUNDS; round++)
+    {
+        /* SubBytes and ShiftRows, the state is stored column by column */
+        for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+        {
+            t[i] = aes_sbox[s[(i + (4u * (i % 4u))) % SIM_BLOCK_SIZE]];
+        }
+
+        if (round != CY_CRYPTO_AES_128_ROUNDS)
+        {
+            /* MixColumns */
+            for (uint32_t c = 0u; c < SIM_BLOCK_SIZE; c += 4u)
+            {
+                uint8_t all = t[c] ^ t[c + 1u] ^ t[c + 2u] ^ t[c + 3u];
+                uint8_t first = t[c];
+
+                s[c] = t[c] ^ all ^ aes_xtime(t[c] ^ t[c + 1u]);
+                s[c + 1u] = t[c + 1u] ^ all ^ aes_xtime(t[c + 1u] ^ t[c + 2u]);
+                s[c + 2u] = t[c + 2u] ^ all ^ aes_xtime(t[c + 2u] ^ t[c + 3u]);
+                s[c + 3u] = t[c + 3u] ^ all ^ aes_xtime(t[c + 3u] ^ first);
+            }
+        }
+        else
+        {
+            memcpy(s, t, sizeof(s));
+        }
+
+        for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+        {
+            s[i] ^= round_keys[(round * SIM_BLOCK_SIZE) + i];
+        }
+    }
+
+    memcpy(out, s, SIM_BLOCK_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: aes_decrypt_block
+ ********************************************************************************
+ * Summary:
+ *   Decrypts one block with the round keys, for the key unwrap.
+ *
+ *******************************************************************************/
+static void aes_decrypt_block(const uint8_t *round_keys, const uint8_t in[SIM_BLOCK_SIZE],
+                              uint8_t out[SIM_BLOCK_SIZE])
+{
+    uint8_t s[SIM_BLOCK_SIZE];
+    uint8_t t[SIM_BLOCK_SIZE];
+
+    for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+    {
+        s[i] = in[i] ^ round_keys[(CY_CRYPTO_AES_128_ROUNDS * SIM_BLOCK_SIZE) + i];
+    }
+
+    for (uint32_t round = CY_CRYPTO_AES_128_ROUNDS; round-- != 0u;)
+    {
+        /* InvShiftRows and InvSubBytes */
+        for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+        {
+            t[(i + (4u * (i % 4u))) % SIM_BLOCK_SIZE] = aes_inv_sbox[s[i]];
+        }
+
+        for (uint32_t i = 0u; i < SIM_BLOCK_SIZE; i++)
+        {
+            t[i] ^= round_keys[(round * SIM_BLOCK_SIZE) + i];
+        }
+
+        if (round != 0u)
+        {
+            /* InvMixColumns */
+            for (uint32_t c = 0u; c < SIM_BLOCK_SIZE; c += 4u)
+            {
+                for (uint32_t r = 0u; r < 4u; r++)
+                {
+                    s[c + r] = aes_mul(t[c + r], 0x0Eu) ^ aes_mul(t[c + ((r + 1u) % 4u)], 0x0Bu) ^
+                               aes_mul(t[c + ((r + 2u) % 4u)], 0x0Du) ^ aes_mul(t[c + ((r + 3u) % 4u)], 0x09u);
+                }
+            }
+        }
+        else
+        {
+            memcpy(s, t, sizeof(s));
+        }
+    }
+
+    memcpy(out, s, SIM_BLOCK_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: Cy_Crypto_Core_Enable
+ ********************************************************************************
+ * Summary:
+ *   Software stand-in of the crypto block functions used by dfu_decrypt.c.
+ *
+ *******************************************************************************/
+cy_en_crypto_status_t Cy_Crypto_Core_Enable(CRYPTO_Type *base)
+{
+    (void)base;
+    crypto_enabled = true;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Init(CRYPTO_Type *base, uint8_t const *key,
+                                              cy_en_crypto_aes_key_length_t keyLength,
+                                              cy_stc_crypto_aes_state_t *aesState,
+                                              cy_stc_crypto_aes_buffers_t *aesBuffers)
+{
+    (void)base;
+
+    if (!crypto_enabled)
+    {
+        return CY_CRYPTO_HW_NOT_ENABLED;
+    }
+    if ((keyLength != CY_CRYPTO_KEY_AES_128) || (key == NULL) || (aesBuffers == NULL))
+    {
+        return CY_CRYPTO_BAD_PARAMS;
+    }
+
+    aes_expand_key(key, aesBuffers->roundKeys);
+    aesState->buffers = aesBuffers;
+    aesState->keyLength = keyLength;
+    aes_inits++;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Free(CRYPTO_Type *base, cy_stc_crypto_aes_state_t *aesState)
+{
+    (void)base;
+    aesState->buffers = NULL;
+    aes_frees++;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Ecb(CRYPTO_Type *base, cy_en_crypto_dir_mode_t dirMode,
+                                             uint8_t *dst, uint8_t const *src,
+                                             cy_stc_crypto_aes_state_t *aesState)
+{
+    uint8_t block[SIM_BLOCK_SIZE];
+
+    (void)base;
+
+    if (aesState->buffers == NULL)
+    {
+        return CY_CRYPTO_BAD_PARAMS;
+    }
+
+    memcpy(block, src, sizeof(block));
+    if (dirMode == CY_CRYPTO_ENCRYPT)
+    {
+        aes_encrypt_block(aesState->buffers->roundKeys, block, dst);
+    }
+    else
+    {
+        aes_decrypt_block(aesState->buffers->roundKeys, block, dst);
+    }
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: Cy_Crypto_Core_Aes_Ctr
+ ********************************************************************************
+ * Summary:
+ *   AES-CTR as in the PDL: the counter in ivPtr is incremented as a
+ *   big-endian number after each block, srcOffset holds the number of bytes
+ *   of streamBlock already used.
+ *
+ *******************************************************************************/
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Ctr(CRYPTO_Type *base, cy_stc_crypto_aes_state_t *aesState,
+                                             uint32_t srcSize, uint32_t *srcOffset,
+                                             uint8_t ivPtr[CY_CRYPTO_AES_BLOCK_SIZE],
+                                             uint8_t streamBlock[CY_CRYPTO_AES_BLOCK_SIZE],
+                                             uint8_t *dst, uint8_t const *src)
+{
+    uint32_t offset = *srcOffset;
+
+    (void)base;
+
+    if (aesState->buffers == NULL)
+    {
+        return CY_CRYPTO_BAD_PARAMS;
+    }
+
+    for (uint32_t i = 0u; i < srcSize; i++)
+    {
+        if (offset == 0u)
+        {
+            aes_encrypt_block(aesState->buffers->roundKeys, ivPtr, streamBlock);
+            for (uint32_t j = SIM_BLOCK_SIZE; (j-- != 0u) && (++ivPtr[j] == 0u);)
+            {
+            }
+        }
+
+        dst[i] = src[i] ^ streamBlock[offset];
+        offset = (offset + 1u) % SIM_BLOCK_SIZE;
+    }
+
+    *srcOffset = offset;
+
+    return CY_CRYPTO_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: Cy_SysLib_Delay
+ ********************************************************************************
+ * Summary:
+ *   Counts the time waited for the CM0+ app instead of sleeping.
+ *
+ *******************************************************************************/
+void Cy_SysLib_Delay(uint32_t milliseconds)
+{
+    delay_ms += milliseconds;
+}
+
+/*******************************************************************************
+ * Function Name: ipc_send_msg_to_cm0p
+ ********************************************************************************
+ * Summary:
+ *   Stand-in of the key unwrap of the CM0+ app (unwrap_key() in
+ *   proj_cm0p/source/main.c), answered as set by cm0p_mode.
+ *
+ * Parameters:
+ *   message - Address of the ipc_unwrap_key_t request
+ *
+ *******************************************************************************/
+void ipc_send_msg_to_cm0p(uint32_t message)
+{
+    ipc_unwrap_key_t *request = (ipc_unwrap_key_t *)(uintptr_t)message;
+    uint8_t round_keys[CY_CRYPTO_AES_128_ROUND_KEYS];
+
+    last_request = request;
+    unwrap_requests++;
+
+    if ((request->cmd != IPC_CMD_UNWRAP_KEY) || (request->status != IPC_STATUS_PENDING))
+    {
+        request->status = IPC_STATUS_ERROR;
+        return;
+    }
+
+    switch (cm0p_mode)
+    {
+        case SIM_CM0P_DONE:
+            aes_expand_key(sim_kek, round_keys);
+            aes_decrypt_block(round_keys, request->key, request->key);
+            request->status = IPC_STATUS_DONE;
+            break;
+
+        case SIM_CM0P_ERROR:
+            request->status = IPC_STATUS_ERROR;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: wrap_key
+ ********************************************************************************
+ * Summary:
+ *   Wraps an image key with the key-encryption key, as encrypt_cyacd2.py.
+ *
+ *******************************************************************************/
+static void wrap_key(const uint8_t key[IPC_KEY_SIZE], uint8_t wrapped[IPC_KEY_SIZE])
+{
+    uint8_t round_keys[CY_CRYPTO_AES_128_ROUND_KEYS];
+
+    aes_expand_key(sim_kek, round_keys);
+    aes_encrypt_block(round_keys, key, wrapped);
+}
+
+/*******************************************************************************
+ * Function Name: encrypt_row
+ ********************************************************************************
+ * Summary:
+ *   Encrypts a row as encrypt_cyacd2.py, with the counter of the first block
+ *   being the address divided by the block size as a 128-bit number.
+ *
+ *******************************************************************************/
+static void encrypt_row(const uint8_t key[IPC_KEY_SIZE], uint32_t address, uint8_t *data, uint32_t length)
+{
+    uint8_t round_keys[CY_CRYPTO_AES_128_ROUND_KEYS];
+    uint8_t counter[SIM_BLOCK_SIZE] = { 0u };
+    uint8_t stream[SIM_BLOCK_SIZE];
+    uint32_t block_num = address / SIM_BLOCK_SIZE;
+
+    aes_expand_key(key, round_keys);
+    for (uint32_t i = 0u; i < length; i += SIM_BLOCK_SIZE, block_num++)
+    {
+        counter[12] = (uint8_t)(block_num >> 24u);
+        counter[13] = (uint8_t)(block_num >> 16u);
+        counter[14] = (uint8_t)(block_num >> 8u);
+        counter[15] = (uint8_t)(block_num);
+        aes_encrypt_block(round_keys, counter, stream);
+        for (uint32_t j = 0u; j < SIM_BLOCK_SIZE; j++)
+        {
+            data[i + j] ^= stream[j];
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fill_row
+ ********************************************************************************
+ * Summary:
+ *   Fills a row with the pattern of the golden vectors.
+ *
+ *******************************************************************************/
+static void fill_row(uint8_t *data, uint8_t seed)
+{
+    for (uint32_t i = 0u; i < SIM_ROW_SIZE; i++)
+    {
+        data[i] = SIM_PATTERN(i, seed);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: row_is
+ ********************************************************************************
+ * Summary:
+ *   True if a row holds the pattern of the golden vectors.
+ *
+ *******************************************************************************/
+static bool row_is(const uint8_t *data, uint8_t seed)
+{
+    for (uint32_t i = 0u; i < SIM_ROW_SIZE; i++)
+    {
+        if (data[i] != SIM_PATTERN(i, seed))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ ********************************************************************************
+ * Summary:
+ *   Counts a check and prints it if it failed.
+ *
+ * Return:
+ *   bool - ok
+ *
+ *******************************************************************************/
+static bool check(bool ok, const char *what, uint32_t step)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("  FAIL: %s, step %" PRIu32 "\n", what, step);
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: start
+ ********************************************************************************
+ * Summary:
+ *   Starts a DFU session with the EI vector set to wrapped, or to zeros
+ *   when wrapped is NULL.
+ *
+ *******************************************************************************/
+static void start(const uint8_t *wrapped)
+{
+    dfu_decrypt_init(&dfu_params);
+    if (wrapped != NULL)
+    {
+        memcpy(dfu_params.encryptionVector, wrapped, IPC_KEY_SIZE);
+    }
+
+    cm0p_mode = SIM_CM0P_DONE;
+    last_request = NULL;
+    unwrap_requests = 0u;
+    delay_ms = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: report
+ ********************************************************************************
+ * Summary:
+ *   Prints the outcome of a test.
+ *
+ *******************************************************************************/
+static void report(const char *name, uint32_t first_failure)
+{
+    printf("%-28s %s\n", name, (failures == first_failure) ? "passed" : "FAILED");
+}
+
+/*******************************************************************************
+ * Function Name: request_key_cleared
+ ********************************************************************************
+ * Summary:
+ *   True if the last unwrap request does not hold key material anymore.
+ *
+ *******************************************************************************/
+static bool request_key_cleared(void)
+{
+    static const uint8_t no_key[IPC_KEY_SIZE] = { 0u };
+
+    return (last_request != NULL) && (memcmp(last_request->key, no_key, IPC_KEY_SIZE) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: test_aes
+ ********************************************************************************
+ * Summary:
+ *   The software AES matches the example of FIPS-197, appendix C.1.
+ *
+ *******************************************************************************/
+static void test_aes(void)
+{
+    static const uint8_t plain[SIM_BLOCK_SIZE] =
+    {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+    };
+    static const uint8_t cipher[SIM_BLOCK_SIZE] =
+    {
+        0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+    };
+    const uint32_t first_failure = failures;
+    uint8_t round_keys[CY_CRYPTO_AES_128_ROUND_KEYS];
+    uint8_t block[SIM_BLOCK_SIZE];
+
+    aes_expand_key(sim_kek, round_keys);
+    aes_encrypt_block(round_keys, plain, block);
+    (void)check(memcmp(block, cipher, sizeof(block)) == 0, "wrong ciphertext", 1u);
+    aes_decrypt_block(round_keys, cipher, block);
+    (void)check(memcmp(block, plain, sizeof(block)) == 0, "wrong plaintext", 2u);
+
+    wrap_key(golden_key, block);
+    (void)check(memcmp(block, golden_wrapped, sizeof(block)) == 0, "wrapped key differs from encrypt_cyacd2.py", 3u);
+
+    report("Software AES", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_golden
+ ********************************************************************************
+ * Summary:
+ *   The rows encrypted by encrypt_cyacd2.py decrypt to their data. CTR
+ *   decryption of the data gives the ciphertext, which is compared first.
+ *
+ *******************************************************************************/
+static void test_golden(void)
+{
+    const uint32_t first_failure = failures;
+    uint8_t row[SIM_ROW_SIZE];
+
+    start(golden_wrapped);
+    for (uint32_t i = 0u; i < (sizeof(golden_rows) / sizeof(golden_rows[0])); i++)
+    {
+        const sim_golden_row_t *golden = &golden_rows[i];
+
+        fill_row(row, golden->seed);
+        (void)check(dfu_decrypt_row(golden->address, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row refused", i);
+        (void)check((memcmp(row, golden->first, SIM_BLOCK_SIZE) == 0) &&
+                    (memcmp(&row[SIM_ROW_SIZE - SIM_BLOCK_SIZE], golden->last, SIM_BLOCK_SIZE) == 0),
+                    "ciphertext differs from encrypt_cyacd2.py", i);
+
+        (void)check(dfu_decrypt_row(golden->address, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row refused", i);
+        (void)check(row_is(row, golden->seed), "row not decrypted", i);
+    }
+    (void)check(unwrap_requests == 1u, "key unwrapped more than once", 0u);
+    (void)check(request_key_cleared(), "key left in the unwrap request", 0u);
+    (void)check(aes_inits == aes_frees, "AES state not freed", 0u);
+
+    report("encrypt_cyacd2.py rows", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_row_order
+ ********************************************************************************
+ * Summary:
+ *   Rows of an image decrypt in reverse order and when one is sent again,
+ *   since each row has its own counter.
+ *
+ *******************************************************************************/
+static void test_row_order(void)
+{
+    static const uint8_t key[IPC_KEY_SIZE] =
+    {
+        0xA5, 0x5A, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E
+    };
+    const uint32_t first_failure = failures;
+    const uint32_t rows = 8u;
+    uint8_t wrapped[IPC_KEY_SIZE];
+    uint8_t row[SIM_ROW_SIZE];
+
+    wrap_key(key, wrapped);
+    start(wrapped);
+
+    for (uint32_t i = rows; i-- != 0u;)
+    {
+        uint32_t address = 0x10080000UL + (i * SIM_ROW_SIZE);
+
+        fill_row(row, (uint8_t)i);
+        encrypt_row(key, address, row, SIM_ROW_SIZE);
+        (void)check(dfu_decrypt_row(address, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row refused", i);
+        (void)check(row_is(row, (uint8_t)i), "row not decrypted", i);
+    }
+
+    /* The host sends the third row again after an error */
+    fill_row(row, 2u);
+    encrypt_row(key, 0x10080000UL + (2u * SIM_ROW_SIZE), row, SIM_ROW_SIZE);
+    (void)check(dfu_decrypt_row(0x10080000UL + (2u * SIM_ROW_SIZE), row, SIM_ROW_SIZE) == CY_DFU_SUCCESS,
+                "resent row refused", rows);
+    (void)check(row_is(row, 2u), "resent row not decrypted", rows);
+
+    report("Row order", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_refused
+ ********************************************************************************
+ * Summary:
+ *   A row of a plain image and a row that is not a multiple of the block
+ *   size are refused without asking the CM0+ app and without changing them.
+ *
+ *******************************************************************************/
+static void test_refused(void)
+{
+    const uint32_t first_failure = failures;
+    uint8_t row[SIM_ROW_SIZE];
+
+    start(NULL);
+    fill_row(row, 3u);
+    (void)check(dfu_decrypt_row(0x10080000UL, row, SIM_ROW_SIZE) == CY_DFU_ERROR_VERIFY, "plain row accepted", 1u);
+    (void)check(row_is(row, 3u) && (unwrap_requests == 0u), "plain row changed", 1u);
+
+    start(golden_wrapped);
+    (void)check(dfu_decrypt_row(0x10080000UL, row, SIM_ROW_SIZE - 4u) == CY_DFU_ERROR_VERIFY,
+                "partial block accepted", 2u);
+    (void)check(row_is(row, 3u) && (unwrap_requests == 0u), "row with a partial block changed", 2u);
+
+    report("Refused rows", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_unwrap
+ ********************************************************************************
+ * Summary:
+ *   The image key is unwrapped once per EI vector and DFU session. A failed
+ *   or unanswered unwrap refuses the row, the next row tries again, and the
+ *   request never keeps key material.
+ *
+ *******************************************************************************/
+static void test_unwrap(void)
+{
+    static const uint8_t key[IPC_KEY_SIZE] =
+    {
+        0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0xEF, 0xCD, 0xAB, 0x89, 0x67, 0x45, 0x23, 0x01
+    };
+    const uint32_t first_failure = failures;
+    uint8_t wrapped[IPC_KEY_SIZE];
+    uint8_t row[SIM_ROW_SIZE];
+
+    wrap_key(key, wrapped);
+
+    start(golden_wrapped);
+    cm0p_mode = SIM_CM0P_ERROR;
+    fill_row(row, 4u);
+    (void)check(dfu_decrypt_row(0x10080000UL, row, SIM_ROW_SIZE) == CY_DFU_ERROR_VERIFY,
+                "row accepted after a failed unwrap", 1u);
+    (void)check(row_is(row, 4u) && request_key_cleared(), "row changed or key left after a failed unwrap", 1u);
+
+    cm0p_mode = SIM_CM0P_SILENT;
+    (void)check(dfu_decrypt_row(0x10080000UL, row, SIM_ROW_SIZE) == CY_DFU_ERROR_VERIFY,
+                "row accepted without an answer", 2u);
+    (void)check(delay_ms == DFU_DECRYPT_UNWRAP_TIMEOUT_MS, "wrong unwrap timeout", 2u);
+    (void)check(row_is(row, 4u) && request_key_cleared(), "row changed or key left after the timeout", 2u);
+
+    cm0p_mode = SIM_CM0P_DONE;
+    fill_row(row, 5u);
+    encrypt_row(golden_key, 0x10080000UL, row, SIM_ROW_SIZE);
+    (void)check(dfu_decrypt_row(0x10080000UL, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row refused after retry", 3u);
+    (void)check(row_is(row, 5u) && (unwrap_requests == 3u), "row not decrypted after retry", 3u);
+
+    /* A new EI vector in the same session, then a new session with the same one */
+    memcpy(dfu_params.encryptionVector, wrapped, IPC_KEY_SIZE);
+    fill_row(row, 6u);
+    encrypt_row(key, 0x10080200UL, row, SIM_ROW_SIZE);
+    (void)check(dfu_decrypt_row(0x10080200UL, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row of the new key refused", 4u);
+    (void)check(row_is(row, 6u) && (unwrap_requests == 4u), "new EI vector not unwrapped", 4u);
+
+    start(wrapped);
+    fill_row(row, 7u);
+    encrypt_row(key, 0x10080400UL, row, SIM_ROW_SIZE);
+    (void)check(dfu_decrypt_row(0x10080400UL, row, SIM_ROW_SIZE) == CY_DFU_SUCCESS, "row of a new session refused", 5u);
+    (void)check(row_is(row, 7u) && (unwrap_requests == 1u), "key of the previous session reused", 5u);
+    (void)check(aes_inits == aes_frees, "AES state not freed", 5u);
+
+    report("Key unwrap", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: bench
+ ********************************************************************************
+ * Summary:
+ *   Decrypts rows with the software AES and prints the time per row.
+ *
+ * Parameters:
+ *   rows - Number of rows to decrypt
+ *
+ *******************************************************************************/
+static void bench(uint32_t rows)
+{
+    static uint8_t row[SIM_ROW_SIZE];
+    struct timespec begin;
+    struct timespec end;
+    uint64_t elapsed_ns;
+    uint32_t refused = 0u;
+
+    start(golden_wrapped);
+    fill_row(row, 0u);
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (uint32_t i = 0u; i < rows; i++)
+    {
+        if (dfu_decrypt_row(0x10080000UL + ((i * SIM_ROW_SIZE) % 0xE0000UL), row, SIM_ROW_SIZE) != CY_DFU_SUCCESS)
+        {
+            refused++;
+        }
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed_ns = ((uint64_t)(end.tv_sec - begin.tv_sec) * NS_PER_S) + (uint64_t)end.tv_nsec - (uint64_t)begin.tv_nsec;
+    if ((refused != 0u) || (elapsed_ns == 0u))
+    {
+        printf("Benchmark failed, %" PRIu32 " row(s) refused\n", refused);
+        return;
+    }
+
+    printf("Software AES-128-CTR: %" PRIu32 " rows of %u bytes in %.1f ms, %.2f us per row, %.2f MB/s\n",
+           rows, SIM_ROW_SIZE, (double)elapsed_ns / 1e6, (double)elapsed_ns / NS_PER_US / rows,
+           ((double)rows * SIM_ROW_SIZE * 1e3) / (double)elapsed_ns);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Runs the tests, or the benchmark with --bench.
+ *
+ * Return:
+ *   int - 0 if all the checks passed, 1 otherwise
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t bench_rows = 0u;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "", dfu_decrypt_sim_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                bench_rows = (optarg != NULL) ? (uint32_t)strtoul(optarg, NULL, 0) : SIM_BENCH_ROWS;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [--bench[=rows]]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    aes_init_tables();
+
+    if (bench_rows != 0u)
+    {
+        bench(bench_rows);
+        return 0;
+    }
+
+    test_aes();
+    test_golden();
+    test_row_order();
+    test_refused();
+    test_unwrap();
+
+    printf("%" PRIu32 " checks, %" PRIu32 " failed\n", checks, failures);
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
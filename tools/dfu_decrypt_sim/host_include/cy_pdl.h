@@ -0,0 +1,120 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host stand-in for the parts of the PDL used by dfu_decrypt.c.
+*   The crypto block functions are implemented in software by
+*   dfu_decrypt_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CY_PDL_H
+#define CY_PDL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CY_ALIGN(align)                 __attribute__((aligned(align)))
+#define CY_SECTION(name)                __attribute__((section(name)))
+
+#define CY_IP_MXCRYPTO                  (1u)
+#define CY_CRYPTO_AES_BLOCK_SIZE        (16u)
+#define CY_CRYPTO_AES_128_KEY_SIZE      (16u)
+
+/* Rounds and expanded key of AES-128 */
+#define CY_CRYPTO_AES_128_ROUNDS        (10u)
+#define CY_CRYPTO_AES_128_ROUND_KEYS    ((CY_CRYPTO_AES_128_ROUNDS + 1u) * CY_CRYPTO_AES_BLOCK_SIZE)
+
+#define CRYPTO                          ((CRYPTO_Type *)NULL)
+
+typedef struct CRYPTO_Type CRYPTO_Type;
+
+typedef enum
+{
+    CY_CRYPTO_SUCCESS = 0x00UL,
+    CY_CRYPTO_BAD_PARAMS = 0x01UL,
+    CY_CRYPTO_HW_NOT_ENABLED = 0x02UL,
+} cy_en_crypto_status_t;
+
+typedef enum
+{
+    CY_CRYPTO_KEY_AES_128 = 0x00UL,
+    CY_CRYPTO_KEY_AES_192 = 0x01UL,
+    CY_CRYPTO_KEY_AES_256 = 0x02UL,
+} cy_en_crypto_aes_key_length_t;
+
+typedef enum
+{
+    CY_CRYPTO_ENCRYPT = 0x00UL,
+    CY_CRYPTO_DECRYPT = 0x01UL,
+} cy_en_crypto_dir_mode_t;
+
+/* Key schedule of the software AES */
+typedef struct
+{
+    uint8_t roundKeys[CY_CRYPTO_AES_128_ROUND_KEYS];
+} cy_stc_crypto_aes_buffers_t;
+
+typedef struct
+{
+    cy_stc_crypto_aes_buffers_t *buffers;
+    cy_en_crypto_aes_key_length_t keyLength;
+} cy_stc_crypto_aes_state_t;
+
+cy_en_crypto_status_t Cy_Crypto_Core_Enable(CRYPTO_Type *base);
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Init(CRYPTO_Type *base, uint8_t const *key,
+                                              cy_en_crypto_aes_key_length_t keyLength,
+                                              cy_stc_crypto_aes_state_t *aesState,
+                                              cy_stc_crypto_aes_buffers_t *aesBuffers);
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Free(CRYPTO_Type *base, cy_stc_crypto_aes_state_t *aesState);
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Ecb(CRYPTO_Type *base, cy_en_crypto_dir_mode_t dirMode,
+                                             uint8_t *dst, uint8_t const *src,
+                                             cy_stc_crypto_aes_state_t *aesState);
+cy_en_crypto_status_t Cy_Crypto_Core_Aes_Ctr(CRYPTO_Type *base, cy_stc_crypto_aes_state_t *aesState,
+                                             uint32_t srcSize, uint32_t *srcOffset,
+                                             uint8_t ivPtr[CY_CRYPTO_AES_BLOCK_SIZE],
+                                             uint8_t streamBlock[CY_CRYPTO_AES_BLOCK_SIZE],
+                                             uint8_t *dst, uint8_t const *src);
+
+/* Busy wait, simulated by dfu_decrypt_sim.c */
+void Cy_SysLib_Delay(uint32_t milliseconds);
+
+#define __DSB()                         __sync_synchronize()
+
+#endif /* CY_PDL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,1143 @@
+/******************************************************************************
+* File Name: dfu_host.c
+*
+* Description: DFU host that transfers a CYACD2 file to one or more devices
+*   running the CM4 project, each on its own serial port, with the DFU packet
+*   protocol that transport_uart.c carries. The file is read once into a
+*   read-only row table shared by all the devices, with the CRC-32C of each
+*   row. One event loop drives all the ports: each device has its own state
+*   machine and timers, and poll() waits for the next response, free port or
+*   timer of any of them. The host reports the time spent in each phase of
+*   the transfer (entering the DFU, programming the rows, verifying them with
+*   --verify, validating the application and exiting), and the throughput,
+*   retries and failure of each device.
+*
+*   transport_uart.c detects the end of a packet when no byte has been
+*   received for UART_BYTE_TO_BYTE_TIMEOUT_US, and reads the packet from the
+*   RX FIFO of the SCB, so a packet must fit in the FIFO (--packet, 128 bytes
+*   by default) and only one packet can be on its way to a device at a time.
+*   A row larger than a packet is sent as Send Data packets followed by a
+*   Program Data packet. When the device reports a DFU SDK of version 4 or
+*   later, the Send Data packets are sent without a response (command 0x47),
+*   each one --gap-us after the previous one has left the port, so a row
+*   costs one round trip instead of one per packet. --no-pipeline turns this
+*   off.
+*
+*   A row that fails, because its response is lost or corrupted or because
+*   the device reports a checksum or data error, is sent again after a Sync
+*   DFU command, which drops the data the device has buffered. The retries
+*   wait --backoff-ms, doubled after each retry. If the device has left the
+*   DFU session, it is entered again first. A device that fails does not
+*   stop the others.
+*
+*   With --sim N, the host runs against N simulated devices on pseudo
+*   terminals instead of serial ports (see dfu_sim.h). With a list of counts,
+*   for example --sim 1,2,4,8,16, the transfer is repeated for each count
+*   and the scaling with the number of devices is reported.
+*
+*   Build:
+*   gcc -O2 -o dfu_host tools/dfu_host/dfu_host.c tools/dfu_host/dfu_protocol.c tools/dfu_host/dfu_sim.c
+*
+*   Example Usage:
+*   dfu_host --port /dev/ttyACM0 --port /dev/ttyACM1 --baud 115200 cm4_app_UPGRADE.cyacd2
+*   dfu_host --sim 1,2,4,8,16,32 cm4_app_UPGRADE.cyacd2
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "dfu_protocol.h"
+#include "dfu_sim.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Longest backoff between two retries of a row */
+#define DFU_BACKOFF_MAX_MS              (1000u)
+
+/* Number of device counts of a --sim sweep */
+#define DFU_SIM_SWEEP_MAX               (16u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Host settings */
+typedef struct
+{
+    uint32_t baud;
+    uint32_t packet;                /* Largest packet, in bytes */
+    uint32_t timeout_ms;            /* Response timeout */
+    uint32_t validate_timeout_ms;   /* Response timeout of Verify App */
+    uint32_t retries;               /* Retries of a row or command */
+    uint32_t backoff_ms;            /* Wait before the first retry */
+    uint32_t gap_us;                /* Idle time after a packet without response */
+    bool pipeline;
+    bool verify;
+    bool validate;
+    dfu_sim_cfg_t sim;
+} dfu_host_cfg_t;
+
+/* Phases of the transfer */
+typedef enum
+{
+    PHASE_ENTER,
+    PHASE_PROGRAM,
+    PHASE_VERIFY,
+    PHASE_VALIDATE,
+    PHASE_EXIT,
+    PHASE_COUNT
+} dfu_phase_id_t;
+
+/* Counters of one phase of the transfer */
+typedef struct
+{
+    bool run;
+    uint64_t ns;
+    uint32_t packets;
+    uint32_t retries;
+    uint64_t bytes_out;
+    uint64_t bytes_in;
+    uint32_t round_trips;
+    uint64_t rtt_ns;
+    uint64_t rtt_max_ns;
+} dfu_phase_t;
+
+/* Next packet of a device */
+typedef enum
+{
+    DEV_SYNC,                       /* Sync DFU before a retry */
+    DEV_ENTER,                      /* Enter DFU */
+    DEV_EIV,                        /* Set EI Vector */
+    DEV_METADATA,                   /* Set Application Metadata */
+    DEV_ROWS,                       /* Rows of the program or verify phase */
+    DEV_VALIDATE,                   /* Verify App */
+    DEV_EXIT,                       /* Exit DFU */
+    DEV_DONE,
+    DEV_FAILED
+} dfu_dev_state_t;
+
+/* One device and its port */
+typedef struct
+{
+    char name[64];
+    int fd;
+    pid_t sim_pid;
+    dfu_dev_state_t state;
+    dfu_dev_state_t resume;         /* State after the Sync of a retry */
+    dfu_phase_id_t phase_id;
+    dfu_phase_t phases[PHASE_COUNT];
+    uint64_t phase_start;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    bool pipeline;
+    bool entered;                   /* The DFU SDK version has been checked */
+    uint32_t row;                   /* Row being sent */
+    uint32_t offset;                /* Bytes of the row sent */
+    uint32_t pending;               /* Bytes of the Send Data waiting for its response */
+    uint8_t cmd;                    /* Command of the last packet */
+    uint32_t attempt;               /* Retries of the current row or command */
+    bool awaiting;                  /* A response is expected by deadline */
+    uint64_t deadline;
+    uint64_t wake;                  /* Earliest time of the next packet */
+    uint64_t sent_ns;               /* Start of the round trip */
+    int error;                      /* Status of the failure */
+    uint8_t tx[DFU_PACKET_MAX];
+    uint32_t tx_len;
+    uint32_t tx_off;
+    uint8_t rx[DFU_PACKET_MAX];
+    uint32_t rx_len;
+} dfu_device_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static dfu_host_cfg_t host_cfg =
+{
+    .baud = 115200u,
+    .packet = 128u,
+    .timeout_ms = 1000u,
+    .validate_timeout_ms = 30000u,
+    .retries = 3u,
+    .backoff_ms = 20u,
+    .gap_us = 2u * DFU_BYTE_TO_BYTE_TIMEOUT_US,
+    .pipeline = true,
+    .verify = false,
+    .validate = true,
+    .sim =
+    {
+        .row_write_us = 16000u,
+        .latency_us = 1000u,
+        .error_every = 0u,
+    },
+};
+
+static const char *const phase_names[PHASE_COUNT] =
+{
+    [PHASE_ENTER]    = "enter",
+    [PHASE_PROGRAM]  = "program",
+    [PHASE_VERIFY]   = "verify",
+    [PHASE_VALIDATE] = "validate",
+    [PHASE_EXIT]     = "exit",
+};
+
+static const struct option dfu_host_options[] =
+{
+    { "port",                required_argument, NULL, 'p' },
+    { "baud",                required_argument, NULL, 'b' },
+    { "packet",              required_argument, NULL, 'k' },
+    { "timeout-ms",          required_argument, NULL, 't' },
+    { "validate-timeout-ms", required_argument, NULL, 'T' },
+    { "retries",             required_argument, NULL, 'r' },
+    { "backoff-ms",          required_argument, NULL, 'B' },
+    { "gap-us",              required_argument, NULL, 'g' },
+    { "no-pipeline",         no_argument,       NULL, 'P' },
+    { "verify",              no_argument,       NULL, 'v' },
+    { "no-validate",         no_argument,       NULL, 'V' },
+    { "sim",                 required_argument, NULL, 's' },
+    { "sim-row-write-us",    required_argument, NULL, 'w' },
+    { "sim-latency-us",      required_argument, NULL, 'l' },
+    { "sim-error-every",     required_argument, NULL, 'e' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: retryable
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a failed exchange may succeed when it is sent again.
+ *
+ *******************************************************************************/
+static bool retryable(int status)
+{
+    return (status == DFU_HOST_TIMEOUT) || (status == DFU_HOST_BAD_PACKET) ||
+           (status == DFU_STATUS_ERROR_CHECKSUM) || (status == DFU_STATUS_ERROR_DATA) ||
+           (status == DFU_STATUS_ERROR_LENGTH) || (status == DFU_STATUS_ERROR_CMD);
+}
+
+/*******************************************************************************
+ * Function Name: dev_set_phase
+ ********************************************************************************
+ * Summary:
+ *   Ends the current phase of a device and starts the next one.
+ *
+ *******************************************************************************/
+static void dev_set_phase(dfu_device_t *dev, dfu_phase_id_t id, uint64_t now)
+{
+    dev->phases[dev->phase_id].ns += now - dev->phase_start;
+    dev->phase_id = id;
+    dev->phases[id].run = true;
+    dev->phase_start = now;
+}
+
+/*******************************************************************************
+ * Function Name: dev_finish
+ ********************************************************************************
+ * Summary:
+ *   Ends the transfer of a device, with a failure status or
+ *   DFU_STATUS_SUCCESS.
+ *
+ *******************************************************************************/
+static void dev_finish(dfu_device_t *dev, int status, uint64_t now)
+{
+    dev_set_phase(dev, dev->phase_id, now);
+    dev->state = (status == DFU_STATUS_SUCCESS) ? DEV_DONE : DEV_FAILED;
+    dev->error = status;
+    dev->awaiting = false;
+    dev->end_ns = now;
+
+    if (status != DFU_STATUS_SUCCESS)
+    {
+        if (dev->phase_id == PHASE_PROGRAM || dev->phase_id == PHASE_VERIFY)
+        {
+            fprintf(stderr, "%s: %s of row %u: %s\n", dev->name, phase_names[dev->phase_id],
+                    dev->row, dfu_status_name(status));
+        }
+        else
+        {
+            fprintf(stderr, "%s: %s: %s\n", dev->name, phase_names[dev->phase_id], dfu_status_name(status));
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dev_flush_tx
+ ********************************************************************************
+ * Summary:
+ *   Writes what the port accepts of the packet being sent.
+ *
+ * Return:
+ *   int - 0, or DFU_HOST_IO_ERROR
+ *
+ *******************************************************************************/
+static int dev_flush_tx(dfu_device_t *dev)
+{
+    while (dev->tx_off < dev->tx_len)
+    {
+        ssize_t n = write(dev->fd, &dev->tx[dev->tx_off], dev->tx_len - dev->tx_off);
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return (errno == EAGAIN) ? 0 : DFU_HOST_IO_ERROR;
+        }
+        dev->tx_off += (uint32_t)n;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: dev_send
+ ********************************************************************************
+ * Summary:
+ *   Starts sending a command packet. A packet without response is followed
+ *   by its line time and the gap that ends it for transport_uart.c before
+ *   the next one. For a packet with response, the timeout starts when the
+ *   packet should have left the port.
+ *
+ * Parameters:
+ *   dev        - Device
+ *   cmd        - DFU command
+ *   data       - Data of the command
+ *   length     - Length of the data
+ *   timeout_ms - Response timeout, or 0 for a command without response
+ *   now        - Current time
+ *
+ *******************************************************************************/
+static void dev_send(dfu_device_t *dev, uint8_t cmd, const uint8_t *data, uint32_t length,
+                     uint32_t timeout_ms, uint64_t now)
+{
+    dfu_phase_t *phase = &dev->phases[dev->phase_id];
+    uint32_t size = dfu_frame_packet(dev->tx, cmd, data, length);
+    uint64_t line_ns = dfu_line_time_us(size, host_cfg.baud) * 1000u;
+    int rc;
+
+    dev->cmd = cmd;
+    dev->tx_len = size;
+    dev->tx_off = 0u;
+    phase->packets++;
+    phase->bytes_out += size;
+
+    if (timeout_ms == 0u)
+    {
+        dev->wake = now + line_ns + ((uint64_t)host_cfg.gap_us * 1000u);
+    }
+    else
+    {
+        dev->awaiting = true;
+        dev->sent_ns = now;
+        dev->deadline = now + line_ns + ((uint64_t)timeout_ms * 1000000u);
+    }
+
+    rc = dev_flush_tx(dev);
+    if (rc != 0)
+    {
+        dev_finish(dev, rc, now);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dev_send_row_packet
+ ********************************************************************************
+ * Summary:
+ *   Sends the next packet of the current row: Send Data while the rest of
+ *   the row does not fit in one packet, then Program Data or Verify Data.
+ *
+ *******************************************************************************/
+static void dev_send_row_packet(dfu_device_t *dev, const cyacd2_row_t *row, uint64_t now)
+{
+    const uint32_t send_max = host_cfg.packet - DFU_PACKET_OVERHEAD;
+    const uint32_t last_max = send_max - DFU_ROW_CMD_HEADER_SIZE;
+    uint32_t remaining = row->length - dev->offset;
+    uint8_t data[DFU_PACKET_MAX];
+
+    if (remaining > last_max)
+    {
+        uint32_t n = ((remaining - 1u) < send_max) ? (remaining - 1u) : send_max;
+
+        if (dev->pipeline)
+        {
+            dev_send(dev, DFU_CMD_SEND_DATA_WR, &row->data[dev->offset], n, 0u, now);
+            dev->offset += n;
+        }
+        else
+        {
+            dev_send(dev, DFU_CMD_SEND_DATA, &row->data[dev->offset], n, host_cfg.timeout_ms, now);
+            dev->pending = n;
+        }
+        return;
+    }
+
+    dfu_put_u32(&data[0], row->address);
+    dfu_put_u32(&data[4], row->crc);
+    memcpy(&data[DFU_ROW_CMD_HEADER_SIZE], &row->data[dev->offset], remaining);
+    dev_send(dev, (dev->phase_id == PHASE_VERIFY) ? DFU_CMD_VERIFY_DATA : DFU_CMD_PROGRAM_DATA,
+             data, DFU_ROW_CMD_HEADER_SIZE + remaining, host_cfg.timeout_ms, now);
+}
+
+/*******************************************************************************
+ * Function Name: dev_next
+ ********************************************************************************
+ * Summary:
+ *   Sends the next packet of a device that is not waiting for a response.
+ *
+ *******************************************************************************/
+static void dev_next(dfu_device_t *dev, const cyacd2_file_t *file, uint64_t now)
+{
+    uint8_t data[9];
+
+    switch (dev->state)
+    {
+        case DEV_SYNC:
+            dev_send(dev, DFU_CMD_SYNC, NULL, 0u, 0u, now);
+            dev->state = dev->resume;
+            break;
+
+        case DEV_ENTER:
+            dfu_put_u32(data, file->product_id);
+            dev_send(dev, DFU_CMD_ENTER, data, 4u, host_cfg.timeout_ms, now);
+            break;
+
+        case DEV_EIV:
+            dev_send(dev, DFU_CMD_SET_EIVECTOR, file->eiv, file->eiv_length, host_cfg.timeout_ms, now);
+            break;
+
+        case DEV_METADATA:
+            data[0] = file->app_id;
+            dfu_put_u32(&data[1], file->app_start);
+            dfu_put_u32(&data[5], file->app_length);
+            dev_send(dev, DFU_CMD_SET_METADATA, data, 9u, host_cfg.timeout_ms, now);
+            break;
+
+        case DEV_ROWS:
+            /* The DFU metadata rows are not in the flash and cannot be verified */
+            while ((dev->phase_id == PHASE_VERIFY) && (dev->row < file->row_count) &&
+                   (file->rows[dev->row].address >= DFU_META_ADDR))
+            {
+                dev->row++;
+            }
+
+            if (dev->row < file->row_count)
+            {
+                dev_send_row_packet(dev, &file->rows[dev->row], now);
+            }
+            else if ((dev->phase_id == PHASE_PROGRAM) && host_cfg.verify)
+            {
+                dev_set_phase(dev, PHASE_VERIFY, now);
+                dev->row = 0u;
+                dev_next(dev, file, now);
+            }
+            else
+            {
+                dev->state = host_cfg.validate ? DEV_VALIDATE : DEV_EXIT;
+                dev_set_phase(dev, host_cfg.validate ? PHASE_VALIDATE : PHASE_EXIT, now);
+                dev_next(dev, file, now);
+            }
+            break;
+
+        case DEV_VALIDATE:
+            data[0] = file->app_id;
+            dev_send(dev, DFU_CMD_VERIFY_APP, data, 1u, host_cfg.validate_timeout_ms, now);
+            break;
+
+        case DEV_EXIT:
+            /* Exit DFU has no response. The device validates the application
+             * again and starts the update.
+             */
+            dev_send(dev, DFU_CMD_EXIT, NULL, 0u, 0u, now);
+            if (dev->state == DEV_EXIT)
+            {
+                dev_finish(dev, DFU_STATUS_SUCCESS, now);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dev_fail
+ ********************************************************************************
+ * Summary:
+ *   Handles a failed exchange: schedules a retry after the backoff, or ends
+ *   the transfer of the device. The retry starts with a Sync DFU, and with
+ *   Enter DFU if the device has left the DFU session. A row is sent again
+ *   from its start. If a row fails twice while pipelining, pipelining is
+ *   turned off for the device, in case its packets were sent too close
+ *   together.
+ *
+ *******************************************************************************/
+static void dev_fail(dfu_device_t *dev, int status, uint64_t now)
+{
+    uint64_t wait_ms;
+
+    dev->awaiting = false;
+
+    if ((dev->state == DEV_METADATA) && (status == DFU_STATUS_ERROR_CMD))
+    {
+        /* The metadata is not writable on the device (CY_DFU_METADATA_WRITABLE=0) */
+        dev->state = DEV_ROWS;
+        dev->wake = now;
+        dev_set_phase(dev, PHASE_PROGRAM, now);
+        return;
+    }
+
+    if (!retryable(status) || (dev->attempt == host_cfg.retries))
+    {
+        dev_finish(dev, status, now);
+        return;
+    }
+
+    if ((dev->state == DEV_ROWS) && dev->pipeline && (dev->attempt != 0u))
+    {
+        printf("%s: row %u failed twice, pipelining off\n", dev->name, dev->row);
+        dev->pipeline = false;
+    }
+
+    wait_ms = (uint64_t)host_cfg.backoff_ms << ((dev->attempt < 16u) ? dev->attempt : 16u);
+    wait_ms = (wait_ms < DFU_BACKOFF_MAX_MS) ? wait_ms : DFU_BACKOFF_MAX_MS;
+    dev->attempt++;
+    dev->phases[dev->phase_id].retries++;
+
+    /* Drop what is left of the failed exchange */
+    (void)tcflush(dev->fd, TCIOFLUSH);
+    dev->rx_len = 0u;
+    dev->tx_len = 0u;
+    dev->tx_off = 0u;
+    dev->offset = 0u;
+
+    dev->resume = (status == DFU_STATUS_ERROR_CMD) ? DEV_ENTER : dev->state;
+    dev->state = DEV_SYNC;
+    dev->wake = now + (wait_ms * 1000000u);
+}
+
+/*******************************************************************************
+ * Function Name: dev_response
+ ********************************************************************************
+ * Summary:
+ *   Handles the response to the last command of a device.
+ *
+ *******************************************************************************/
+static void dev_response(dfu_device_t *dev, const cyacd2_file_t *file, int status,
+                         const uint8_t *data, uint32_t length, uint64_t now)
+{
+    dfu_phase_t *phase = &dev->phases[dev->phase_id];
+    uint64_t rtt = now - dev->sent_ns;
+
+    phase->round_trips++;
+    phase->rtt_ns += rtt;
+    phase->rtt_max_ns = (rtt > phase->rtt_max_ns) ? rtt : phase->rtt_max_ns;
+
+    if ((status == DFU_STATUS_SUCCESS) && (dev->state == DEV_ENTER) && (length < DFU_ENTER_RESPONSE_SIZE))
+    {
+        status = DFU_HOST_BAD_PACKET;
+    }
+    if (status != DFU_STATUS_SUCCESS)
+    {
+        dev_fail(dev, status, now);
+        return;
+    }
+
+    dev->awaiting = false;
+    dev->wake = now;
+
+    switch (dev->state)
+    {
+        case DEV_ENTER:
+            if ((file->silicon_id != 0u) && (dfu_get_u32(data) != file->silicon_id))
+            {
+                fprintf(stderr, "%s: silicon ID 0x%08X does not match the file (0x%08X)\n",
+                        dev->name, dfu_get_u32(data), file->silicon_id);
+                dev_finish(dev, DFU_STATUS_ERROR_DATA, now);
+                return;
+            }
+            if (!dev->entered)
+            {
+                dev->entered = true;
+                if (dev->pipeline && (data[7] < 4u))
+                {
+                    printf("%s: DFU SDK %u.%u.%u, Send Data without response not supported, pipelining off\n",
+                           dev->name, data[7], data[6], data[5]);
+                    dev->pipeline = false;
+                }
+            }
+            dev->state = (file->eiv_length != 0u) ? DEV_EIV : (file->has_appinfo ? DEV_METADATA : DEV_ROWS);
+            break;
+
+        case DEV_EIV:
+            dev->state = file->has_appinfo ? DEV_METADATA : DEV_ROWS;
+            break;
+
+        case DEV_METADATA:
+            dev->state = DEV_ROWS;
+            break;
+
+        case DEV_ROWS:
+            if (dev->cmd == DFU_CMD_SEND_DATA)
+            {
+                dev->offset += dev->pending;
+            }
+            else
+            {
+                dev->row++;
+                dev->offset = 0u;
+                dev->attempt = 0u;
+            }
+            break;
+
+        case DEV_VALIDATE:
+            if ((length < 1u) || (data[0] != 1u))
+            {
+                fprintf(stderr, "%s: application %u not valid\n", dev->name, file->app_id);
+                dev_finish(dev, DFU_STATUS_ERROR_VERIFY, now);
+                return;
+            }
+            dev->state = DEV_EXIT;
+            dev_set_phase(dev, PHASE_EXIT, now);
+            break;
+
+        default:
+            break;
+    }
+
+    if ((dev->state == DEV_ROWS) && (dev->phase_id == PHASE_ENTER))
+    {
+        dev_set_phase(dev, PHASE_PROGRAM, now);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dev_receive
+ ********************************************************************************
+ * Summary:
+ *   Reads the bytes received on the port of a device and handles the
+ *   complete response packets. Bytes before a SOP are skipped.
+ *
+ *******************************************************************************/
+static void dev_receive(dfu_device_t *dev, const cyacd2_file_t *file, uint64_t now)
+{
+    ssize_t n = read(dev->fd, &dev->rx[dev->rx_len], sizeof(dev->rx) - dev->rx_len);
+
+    if (n <= 0)
+    {
+        if ((n < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+        {
+            return;
+        }
+        dev_finish(dev, DFU_HOST_IO_ERROR, now);
+        return;
+    }
+    dev->rx_len += (uint32_t)n;
+
+    while (dev->rx_len > 0u)
+    {
+        uint32_t skip = 0u, data_len, size;
+
+        while ((skip < dev->rx_len) && (dev->rx[skip] != DFU_SOP))
+        {
+            skip++;
+        }
+        if (skip != 0u)
+        {
+            memmove(dev->rx, &dev->rx[skip], dev->rx_len - skip);
+            dev->rx_len -= skip;
+            continue;
+        }
+        if (dev->rx_len < 4u)
+        {
+            break;
+        }
+
+        data_len = (uint32_t)dev->rx[2] | ((uint32_t)dev->rx[3] << 8);
+        size = data_len + DFU_PACKET_OVERHEAD;
+        if (size > sizeof(dev->rx))
+        {
+            /* Not a packet start */
+            dev->rx[0] = 0u;
+            continue;
+        }
+        if (dev->rx_len < size)
+        {
+            break;
+        }
+
+        dev->phases[dev->phase_id].bytes_in += size;
+        if (dev->awaiting)
+        {
+            if (dfu_check_packet(dev->rx, data_len) != 0)
+            {
+                dev_fail(dev, DFU_HOST_BAD_PACKET, now);
+            }
+            else
+            {
+                dev_response(dev, file, dev->rx[1], &dev->rx[4], data_len, now);
+            }
+        }
+
+        if (dev->rx_len > size)
+        {
+            memmove(dev->rx, &dev->rx[size], dev->rx_len - size);
+        }
+        dev->rx_len = (dev->rx_len > size) ? (dev->rx_len - size) : 0u;
+
+        if ((dev->state == DEV_DONE) || (dev->state == DEV_FAILED))
+        {
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dev_active
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a device still has packets to send or receive.
+ *
+ *******************************************************************************/
+static bool dev_active(const dfu_device_t *dev)
+{
+    return ((dev->state != DEV_DONE) && (dev->state != DEV_FAILED)) ||
+           ((dev->state == DEV_DONE) && (dev->tx_off < dev->tx_len));
+}
+
+/*******************************************************************************
+ * Function Name: run_devices
+ ********************************************************************************
+ * Summary:
+ *   Event loop: transfers the file to all the devices at once.
+ *
+ *******************************************************************************/
+static void run_devices(dfu_device_t *devs, uint32_t count, const cyacd2_file_t *file)
+{
+    struct pollfd *pfds = calloc(count, sizeof(struct pollfd));
+    uint64_t now = dfu_now_ns();
+    bool active = true;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        devs[i].state = DEV_ENTER;
+        devs[i].phase_id = PHASE_ENTER;
+        devs[i].phases[PHASE_ENTER].run = true;
+        devs[i].phase_start = now;
+        devs[i].start_ns = now;
+        devs[i].wake = now;
+        devs[i].pipeline = host_cfg.pipeline;
+    }
+
+    while ((pfds != NULL) && active)
+    {
+        uint64_t next = UINT64_MAX;
+        int timeout_ms;
+
+        now = dfu_now_ns();
+        active = false;
+
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            dfu_device_t *dev = &devs[i];
+
+            if (dev->awaiting && (now >= dev->deadline))
+            {
+                dev_fail(dev, DFU_HOST_TIMEOUT, now);
+            }
+            if ((!dev->awaiting) && (dev->tx_off == dev->tx_len) && (now >= dev->wake) &&
+                (dev->state != DEV_DONE) && (dev->state != DEV_FAILED))
+            {
+                dev_next(dev, file, now);
+            }
+
+            pfds[i].fd = dev_active(dev) ? dev->fd : -1;
+            pfds[i].events = POLLIN | ((dev->tx_off < dev->tx_len) ? POLLOUT : 0);
+            pfds[i].revents = 0;
+
+            if (dev_active(dev))
+            {
+                uint64_t due = dev->awaiting ? dev->deadline : dev->wake;
+
+                active = true;
+                if ((dev->tx_off == dev->tx_len) && (due < next))
+                {
+                    next = due;
+                }
+            }
+        }
+
+        if (!active)
+        {
+            break;
+        }
+
+        timeout_ms = (next == UINT64_MAX) ? -1 :
+                     (next <= now) ? 0 : (int)(((next - now) + 999999u) / 1000000u);
+        if ((poll(pfds, count, timeout_ms) < 0) && (errno != EINTR))
+        {
+            break;
+        }
+
+        now = dfu_now_ns();
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            dfu_device_t *dev = &devs[i];
+
+            if ((pfds[i].revents & POLLOUT) != 0)
+            {
+                int rc = dev_flush_tx(dev);
+
+                if (rc != 0)
+                {
+                    dev_finish(dev, rc, now);
+                }
+            }
+            if ((pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+                dev_receive(dev, file, now);
+            }
+        }
+    }
+
+    free(pfds);
+}
+
+/*******************************************************************************
+ * Function Name: print_report
+ ********************************************************************************
+ * Summary:
+ *   Prints the counters of each phase over all the devices, then the time,
+ *   throughput, retries and result of each device.
+ *
+ *******************************************************************************/
+static void print_report(const dfu_device_t *devs, uint32_t count, const cyacd2_file_t *file, uint64_t wall_ns)
+{
+    uint32_t ok = 0u;
+
+    printf("\n%-9s %12s %8s %8s %10s %10s %14s\n",
+           "Phase", "Time ms avg", "Packets", "Retries", "Bytes out", "Bytes in", "RTT avg/max ms");
+    for (uint32_t p = 0u; p < PHASE_COUNT; p++)
+    {
+        dfu_phase_t sum = { 0 };
+        uint32_t runs = 0u;
+
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            const dfu_phase_t *ph = &devs[i].phases[p];
+
+            if (ph->run)
+            {
+                runs++;
+                sum.ns += ph->ns;
+                sum.packets += ph->packets;
+                sum.retries += ph->retries;
+                sum.bytes_out += ph->bytes_out;
+                sum.bytes_in += ph->bytes_in;
+                sum.round_trips += ph->round_trips;
+                sum.rtt_ns += ph->rtt_ns;
+                sum.rtt_max_ns = (ph->rtt_max_ns > sum.rtt_max_ns) ? ph->rtt_max_ns : sum.rtt_max_ns;
+            }
+        }
+
+        if (runs == 0u)
+        {
+            printf("%-9s %12s\n", phase_names[p], "skipped");
+            continue;
+        }
+
+        printf("%-9s %12.1f %8u %8u %10llu %10llu", phase_names[p], (sum.ns / 1e6) / runs, sum.packets,
+               sum.retries, (unsigned long long)sum.bytes_out, (unsigned long long)sum.bytes_in);
+        if (sum.round_trips != 0u)
+        {
+            printf(" %7.2f/%.2f", (sum.rtt_ns / 1e6) / sum.round_trips, sum.rtt_max_ns / 1e6);
+        }
+        printf("\n");
+    }
+
+    printf("\n%-24s %-7s %8s %9s %8s %s\n", "Device", "Result", "Time s", "KB/s", "Retries", "Error");
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        const dfu_device_t *dev = &devs[i];
+        double seconds = (dev->end_ns - dev->start_ns) / 1e9;
+        uint32_t retries = 0u;
+
+        for (uint32_t p = 0u; p < PHASE_COUNT; p++)
+        {
+            retries += dev->phases[p].retries;
+        }
+        ok += (dev->state == DEV_DONE) ? 1u : 0u;
+
+        if (dev->state == DEV_DONE)
+        {
+            printf("%-24s %-7s %8.2f %9.1f %8u\n", dev->name, "ok", seconds,
+                   (file->row_bytes / 1024.0) / seconds, retries);
+        }
+        else
+        {
+            printf("%-24s %-7s %8.2f %9s %8u %s\n", dev->name, "failed", seconds, "-", retries,
+                   dfu_status_name(dev->error));
+        }
+    }
+
+    printf("\n%u of %u devices updated, %u rows, %llu bytes each, in %.2f s (%.1f KB/s in total, line %.1f KB/s at %u baud)\n",
+           ok, count, file->row_count, (unsigned long long)file->row_bytes, wall_ns / 1e9,
+           ((file->row_bytes * ok) / 1024.0) / (wall_ns / 1e9), (host_cfg.baud / 10.0) / 1024.0, host_cfg.baud);
+}
+
+/*******************************************************************************
+ * Function Name: transfer
+ ********************************************************************************
+ * Summary:
+ *   Opens the ports, or starts the simulated devices, and transfers the file
+ *   to all of them.
+ *
+ * Parameters:
+ *   file     - CYACD2 file
+ *   ports    - Serial ports, or NULL for simulated devices
+ *   count    - Number of devices
+ *   report   - Print the full report, otherwise one line of a --sim sweep
+ *
+ * Return:
+ *   int - 0 if all the devices were updated, 1 if one failed, 2 if a port
+ *         could not be opened
+ *
+ *******************************************************************************/
+static int transfer(const cyacd2_file_t *file, char **ports, uint32_t count, bool report)
+{
+    dfu_device_t *devs = calloc(count, sizeof(dfu_device_t));
+    uint64_t start;
+    uint32_t ok = 0u;
+    int rc = 0;
+
+    if (devs == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+
+    for (uint32_t i = 0u; (rc == 0) && (i < count); i++)
+    {
+        dfu_device_t *dev = &devs[i];
+
+        dev->sim_pid = -1;
+        if (ports != NULL)
+        {
+            snprintf(dev->name, sizeof(dev->name), "%s", ports[i]);
+            dev->fd = dfu_port_open(ports[i], host_cfg.baud);
+        }
+        else
+        {
+            snprintf(dev->name, sizeof(dev->name), "sim%u", i);
+            dev->sim_pid = dfu_sim_start(file, &host_cfg.sim, &dev->fd);
+        }
+        if (dev->fd < 0)
+        {
+            count = i;
+            rc = 2;
+        }
+    }
+
+    start = dfu_now_ns();
+    if (rc == 0)
+    {
+        run_devices(devs, count, file);
+    }
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        ok += (devs[i].state == DEV_DONE) ? 1u : 0u;
+    }
+
+    if ((rc == 0) && report)
+    {
+        print_report(devs, count, file, dfu_now_ns() - start);
+    }
+    else if (rc == 0)
+    {
+        double seconds = (dfu_now_ns() - start) / 1e9;
+        uint64_t rtt_ns = 0u;
+        uint32_t round_trips = 0u;
+
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            rtt_ns += devs[i].phases[PHASE_PROGRAM].rtt_ns;
+            round_trips += devs[i].phases[PHASE_PROGRAM].round_trips;
+        }
+        printf("%7u %7u %10.2f %12.1f %12.1f %12.2f\n", count, ok, seconds,
+               ((file->row_bytes * ok) / 1024.0) / seconds,
+               ((file->row_bytes * ok) / 1024.0) / seconds / count,
+               (round_trips != 0u) ? ((rtt_ns / 1e6) / round_trips) : 0.0);
+    }
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        close(devs[i].fd);
+        if (devs[i].sim_pid > 0)
+        {
+            (void)waitpid(devs[i].sim_pid, NULL, 0);
+        }
+    }
+    free(devs);
+
+    return (rc != 0) ? rc : ((ok == count) ? 0 : 1);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Parses the options, reads the CYACD2 file and transfers it to the ports,
+ *   or to each count of simulated devices.
+ *
+ * Return:
+ *   int - 0 if all the devices were updated, 1 if one failed, 2 on a usage,
+ *         file or port error
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    cyacd2_file_t file;
+    char **ports = calloc((size_t)argc, sizeof(char *));
+    uint32_t port_count = 0u;
+    uint32_t sim_counts[DFU_SIM_SWEEP_MAX];
+    uint32_t sim_sweep = 0u;
+    bool usage = (ports == NULL);
+    int opt;
+    int rc = 0;
+
+    while ((!usage) && ((opt = getopt_long(argc, argv, "", dfu_host_options, NULL)) != -1))
+    {
+        uint32_t value = (uint32_t) strtoul((optarg != NULL) ? optarg : "0", NULL, 0);
+
+        switch (opt)
+        {
+            case 'p': ports[port_count++] = optarg; break;
+            case 'b': host_cfg.baud = value; break;
+            case 'k': host_cfg.packet = value; break;
+            case 't': host_cfg.timeout_ms = value; break;
+            case 'T': host_cfg.validate_timeout_ms = value; break;
+            case 'r': host_cfg.retries = value; break;
+            case 'B': host_cfg.backoff_ms = value; break;
+            case 'g': host_cfg.gap_us = value; break;
+            case 'P': host_cfg.pipeline = false; break;
+            case 'v': host_cfg.verify = true; break;
+            case 'V': host_cfg.validate = false; break;
+            case 's':
+                for (char *count = strtok(optarg, ","); count != NULL; count = strtok(NULL, ","))
+                {
+                    value = (uint32_t) strtoul(count, NULL, 0);
+                    usage = usage || (value == 0u) || (sim_sweep == DFU_SIM_SWEEP_MAX);
+                    if (!usage)
+                    {
+                        sim_counts[sim_sweep++] = value;
+                    }
+                }
+                break;
+            case 'w': host_cfg.sim.row_write_us = value; break;
+            case 'l': host_cfg.sim.latency_us = value; break;
+            case 'e': host_cfg.sim.error_every = value; break;
+            default: usage = true; break;
+        }
+    }
+
+    if (usage || (optind != (argc - 1)) || ((port_count == 0u) == (sim_sweep == 0u)) ||
+        (host_cfg.packet < (DFU_PACKET_OVERHEAD + DFU_ROW_CMD_HEADER_SIZE + 1u)) ||
+        (host_cfg.packet > DFU_PACKET_MAX) || (host_cfg.baud == 0u))
+    {
+        fprintf(stderr, "Usage: %s (--port DEV... | --sim N[,N...]) [--baud N] [--packet N]\n"
+                "       [--timeout-ms N] [--validate-timeout-ms N] [--retries N] [--backoff-ms N]\n"
+                "       [--gap-us N] [--no-pipeline] [--verify] [--no-validate]\n"
+                "       [--sim-row-write-us N] [--sim-latency-us N] [--sim-error-every N]\n"
+                "       file.cyacd2\n", argv[0]);
+        free(ports);
+        return 2;
+    }
+
+    if (cyacd2_load(argv[optind], &file) != 0)
+    {
+        free(ports);
+        return 2;
+    }
+    if (file.checksum_type != 0u)
+    {
+        fprintf(stderr, "Only the sum packet checksum is supported (-chk=sum)\n");
+        cyacd2_free(&file);
+        free(ports);
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    host_cfg.sim.baud = host_cfg.baud;
+
+    if (port_count != 0u)
+    {
+        rc = transfer(&file, ports, port_count, true);
+    }
+    else if (sim_sweep == 1u)
+    {
+        rc = transfer(&file, NULL, sim_counts[0], true);
+    }
+    else
+    {
+        printf("%7s %7s %10s %12s %12s %12s\n", "Devices", "Updated", "Time s", "Total KB/s", "KB/s each", "RTT avg ms");
+        for (uint32_t i = 0u; (i < sim_sweep) && (rc != 2); i++)
+        {
+            int round_rc = transfer(&file, NULL, sim_counts[i], false);
+
+            rc = (round_rc > rc) ? round_rc : rc;
+        }
+    }
+
+    cyacd2_free(&file);
+    free(ports);
+
+    return rc;
+}
+
+/* [] END OF FILE */
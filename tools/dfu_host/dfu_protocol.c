@@ -0,0 +1,621 @@
+/******************************************************************************
+* File Name: dfu_protocol.c
+*
+* Description: DFU packet protocol, CYACD2 file reading and serial port
+*   helpers, see dfu_protocol.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "dfu_protocol.h"
+
+/*******************************************************************************
+ * Function Name: dfu_now_ns
+ ********************************************************************************
+ * Summary:
+ *   Returns the monotonic time in nanoseconds.
+ *
+ *******************************************************************************/
+uint64_t dfu_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_sleep_us
+ ********************************************************************************
+ * Summary:
+ *   Sleeps for a number of microseconds.
+ *
+ *******************************************************************************/
+void dfu_sleep_us(uint64_t us)
+{
+    struct timespec ts = { .tv_sec = (time_t)(us / 1000000u), .tv_nsec = (long)((us % 1000000u) * 1000u) };
+
+    while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR))
+    {
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dfu_line_time_us
+ ********************************************************************************
+ * Summary:
+ *   Time to send a number of bytes over the UART, with 10 bits per byte.
+ *
+ *******************************************************************************/
+uint64_t dfu_line_time_us(uint32_t bytes, uint32_t baud)
+{
+    return ((uint64_t)bytes * 10u * 1000000u) / baud;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_packet_checksum
+ ********************************************************************************
+ * Summary:
+ *   Computes the checksum of a DFU packet: the two's complement of the
+ *   16-bit sum of the bytes from the SOP to the end of the data
+ *   (CY_DFU_OPT_PACKET_CRC=0 in dfu_user.h).
+ *
+ *******************************************************************************/
+uint16_t dfu_packet_checksum(const uint8_t *data, uint32_t length)
+{
+    uint32_t sum = 0u;
+
+    for (uint32_t i = 0u; i < length; i++)
+    {
+        sum += data[i];
+    }
+
+    return (uint16_t)((~sum) + 1u);
+}
+
+/*******************************************************************************
+ * Function Name: dfu_crc32c
+ ********************************************************************************
+ * Summary:
+ *   Computes the CRC-32C of the row data carried by Program and Verify Data.
+ *
+ *******************************************************************************/
+uint32_t dfu_crc32c(const uint8_t *data, uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0u; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_get_u32 / dfu_put_u32
+ ********************************************************************************
+ * Summary:
+ *   Little-endian 32-bit values of the DFU packets.
+ *
+ *******************************************************************************/
+uint32_t dfu_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void dfu_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/*******************************************************************************
+ * Function Name: dfu_status_name
+ ********************************************************************************
+ * Summary:
+ *   Returns the name of a DFU status code or host error.
+ *
+ *******************************************************************************/
+const char *dfu_status_name(int status)
+{
+    switch (status)
+    {
+        case DFU_STATUS_SUCCESS:          return "success";
+        case DFU_STATUS_ERROR_VERIFY:     return "verify error";
+        case DFU_STATUS_ERROR_LENGTH:     return "length error";
+        case DFU_STATUS_ERROR_DATA:       return "data error";
+        case DFU_STATUS_ERROR_CMD:        return "command error";
+        case DFU_STATUS_ERROR_CHECKSUM:   return "checksum error";
+        case DFU_STATUS_ERROR_ROW:        return "row error";
+        case DFU_STATUS_ERROR_ROW_ACCESS: return "row access error";
+        case DFU_STATUS_ERROR_UNKNOWN:    return "unknown error";
+        case DFU_HOST_TIMEOUT:            return "no response";
+        case DFU_HOST_BAD_PACKET:         return "bad response packet";
+        case DFU_HOST_IO_ERROR:           return "port error";
+        default:                          return "error";
+    }
+}
+
+/*******************************************************************************
+ * Function Name: hex_decode
+ ********************************************************************************
+ * Summary:
+ *   Decodes a string of hex digits.
+ *
+ * Return:
+ *   int - Number of bytes decoded, or -1 for an invalid string or a string
+ *         longer than size bytes
+ *
+ *******************************************************************************/
+static int hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t size)
+{
+    if (((hex_len % 2u) != 0u) || ((hex_len / 2u) > size))
+    {
+        return -1;
+    }
+
+    for (size_t i = 0u; i < hex_len; i += 2u)
+    {
+        char byte[3] = { hex[i], hex[i + 1u], '\0' };
+        char *end;
+
+        out[i / 2u] = (uint8_t)strtoul(byte, &end, 16);
+        if (*end != '\0')
+        {
+            return -1;
+        }
+    }
+
+    return (int)(hex_len / 2u);
+}
+
+/*******************************************************************************
+ * Function Name: cyacd2_load
+ ********************************************************************************
+ * Summary:
+ *   Reads a CYACD2 file: the header line, the optional @APPINFO and @EIV
+ *   lines, and the rows.
+ *
+ * Return:
+ *   int - 0 on success, -1 on error
+ *
+ *******************************************************************************/
+int cyacd2_load(const char *path, cyacd2_file_t *file)
+{
+    FILE *fp = fopen(path, "r");
+    char *line = NULL;
+    size_t line_size = 0u;
+    ssize_t len;
+    uint32_t line_num = 0u;
+    uint32_t row_capacity = 0u;
+    size_t data_capacity = 0u, data_used = 0u;
+    int rc = 0;
+
+    memset(file, 0, sizeof(*file));
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while ((rc == 0) && ((len = getline(&line, &line_size, fp)) > 0))
+    {
+        uint8_t header[12];
+
+        while ((len > 0) && ((line[len - 1] == '\n') || (line[len - 1] == '\r')))
+        {
+            line[--len] = '\0';
+        }
+        line_num++;
+
+        if (len == 0)
+        {
+            continue;
+        }
+
+        if (line_num == 1u)
+        {
+            /* Version, silicon ID, silicon revision, checksum type, app ID, product ID */
+            if (hex_decode(line, (size_t)len, header, sizeof(header)) != (int)sizeof(header))
+            {
+                rc = -1;
+            }
+            else
+            {
+                file->silicon_id = dfu_get_u32(&header[1]);
+                file->silicon_rev = header[5];
+                file->checksum_type = header[6];
+                file->app_id = header[7];
+                file->product_id = dfu_get_u32(&header[8]);
+            }
+        }
+        else if (strncmp(line, "@APPINFO:", 9u) == 0)
+        {
+            long start, length;
+
+            if (sscanf(&line[9], "%li,%li", &start, &length) != 2)
+            {
+                rc = -1;
+            }
+            else
+            {
+                file->has_appinfo = true;
+                file->app_start = (uint32_t)start;
+                file->app_length = (uint32_t)length;
+            }
+        }
+        else if (strncmp(line, "@EIV:", 5u) == 0)
+        {
+            int eiv_len = hex_decode(&line[5], (size_t)len - 5u, file->eiv, sizeof(file->eiv));
+
+            if (eiv_len <= 0)
+            {
+                rc = -1;
+            }
+            else
+            {
+                file->eiv_length = (uint32_t)eiv_len;
+            }
+        }
+        else if ((line[0] == ':') && (len > 9))
+        {
+            uint8_t addr[4];
+            size_t data_len = ((size_t)len - 9u) / 2u;
+
+            if (file->row_count == row_capacity)
+            {
+                row_capacity = (row_capacity == 0u) ? 256u : (row_capacity * 2u);
+                file->rows = realloc(file->rows, row_capacity * sizeof(cyacd2_row_t));
+            }
+            if ((data_used + data_len) > data_capacity)
+            {
+                data_capacity = (data_capacity == 0u) ? 0x20000u : (data_capacity * 2u);
+                while ((data_used + data_len) > data_capacity)
+                {
+                    data_capacity *= 2u;
+                }
+                file->row_data = realloc(file->row_data, data_capacity);
+            }
+            if ((file->rows == NULL) || (file->row_data == NULL))
+            {
+                fprintf(stderr, "Out of memory\n");
+                rc = -1;
+            }
+            else if ((hex_decode(&line[1], 8u, addr, sizeof(addr)) != 4) ||
+                     (data_len == 0u) ||
+                     (hex_decode(&line[9], (size_t)len - 9u, &file->row_data[data_used], data_len) != (int)data_len))
+            {
+                rc = -1;
+            }
+            else
+            {
+                /* The data pointers are set once the data buffer has its final address */
+                file->rows[file->row_count].address = dfu_get_u32(addr);
+                file->rows[file->row_count].length = (uint32_t)data_len;
+                file->rows[file->row_count].data = (const uint8_t *)(uintptr_t)data_used;
+                file->row_count++;
+                data_used += data_len;
+            }
+        }
+        else
+        {
+            rc = -1;
+        }
+
+        if (rc != 0)
+        {
+            fprintf(stderr, "%s:%u: invalid line\n", path, line_num);
+        }
+    }
+
+    free(line);
+    fclose(fp);
+
+    if ((rc == 0) && (line_num == 0u))
+    {
+        fprintf(stderr, "%s: empty file\n", path);
+        rc = -1;
+    }
+
+    /* The CRC of each row is computed once for all the devices */
+    for (uint32_t i = 0u; (rc == 0) && (i < file->row_count); i++)
+    {
+        cyacd2_row_t *row = &file->rows[i];
+
+        row->data = file->row_data + (uintptr_t)row->data;
+        row->crc = dfu_crc32c(row->data, row->length);
+        file->row_bytes += row->length;
+    }
+
+    if (rc != 0)
+    {
+        cyacd2_free(file);
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: cyacd2_free
+ ********************************************************************************
+ * Summary:
+ *   Frees the rows of a CYACD2 file.
+ *
+ *******************************************************************************/
+void cyacd2_free(cyacd2_file_t *file)
+{
+    free(file->rows);
+    free(file->row_data);
+    file->rows = NULL;
+    file->row_data = NULL;
+    file->row_count = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_port_open
+ ********************************************************************************
+ * Summary:
+ *   Opens a serial port in raw, non-blocking mode at the given baud rate.
+ *
+ * Return:
+ *   int - File descriptor, or -1 on error
+ *
+ *******************************************************************************/
+int dfu_port_open(const char *path, uint32_t baud)
+{
+    static const struct { uint32_t baud; speed_t speed; } speeds[] =
+    {
+        { 9600u, B9600 }, { 19200u, B19200 }, { 38400u, B38400 }, { 57600u, B57600 },
+        { 115200u, B115200 }, { 230400u, B230400 }, { 460800u, B460800 },
+        { 921600u, B921600 }, { 1000000u, B1000000 }, { 2000000u, B2000000 },
+        { 3000000u, B3000000 },
+    };
+    struct termios tio;
+    speed_t speed = 0;
+    bool configured = false;
+    int fd;
+
+    for (size_t i = 0u; i < (sizeof(speeds) / sizeof(speeds[0])); i++)
+    {
+        if (speeds[i].baud == baud)
+        {
+            speed = speeds[i].speed;
+        }
+    }
+    if (speed == 0)
+    {
+        fprintf(stderr, "Unsupported baud rate %u\n", baud);
+        return -1;
+    }
+
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        (void)cfsetispeed(&tio, speed);
+        (void)cfsetospeed(&tio, speed);
+        configured = (tcsetattr(fd, TCSANOW, &tio) == 0);
+    }
+    if (!configured)
+    {
+        fprintf(stderr, "Cannot configure %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    (void)tcflush(fd, TCIOFLUSH);
+
+    return fd;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_write_all
+ ********************************************************************************
+ * Summary:
+ *   Writes a buffer to a file descriptor, waiting while it is full.
+ *
+ *******************************************************************************/
+int dfu_write_all(int fd, const uint8_t *data, uint32_t length)
+{
+    while (length > 0u)
+    {
+        ssize_t n = write(fd, data, length);
+
+        if (n < 0)
+        {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+            if ((errno == EAGAIN) && (poll(&pfd, 1, -1) >= 0))
+            {
+                continue;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        length -= (uint32_t)n;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_read_timeout
+ ********************************************************************************
+ * Summary:
+ *   Reads exactly length bytes, unless the deadline passes first.
+ *
+ * Return:
+ *   int - 0 on success, DFU_HOST_TIMEOUT or DFU_HOST_IO_ERROR
+ *
+ *******************************************************************************/
+int dfu_read_timeout(int fd, uint8_t *data, uint32_t length, uint64_t deadline_ns)
+{
+    while (length > 0u)
+    {
+        uint64_t now = dfu_now_ns();
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        ssize_t n;
+        int ready;
+
+        if (now >= deadline_ns)
+        {
+            return DFU_HOST_TIMEOUT;
+        }
+
+        ready = poll(&pfd, 1, (int)(((deadline_ns - now) + 999999u) / 1000000u));
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return DFU_HOST_IO_ERROR;
+        }
+        if (ready == 0)
+        {
+            return DFU_HOST_TIMEOUT;
+        }
+
+        n = read(fd, data, length);
+        if (n < 0)
+        {
+            if ((errno == EINTR) || (errno == EAGAIN))
+            {
+                continue;
+            }
+            return DFU_HOST_IO_ERROR;
+        }
+        if (n == 0)
+        {
+            return DFU_HOST_IO_ERROR;
+        }
+        data += n;
+        length -= (uint32_t)n;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_frame_packet
+ ********************************************************************************
+ * Summary:
+ *   Builds a DFU packet around the data.
+ *
+ * Return:
+ *   uint32_t - Length of the packet
+ *
+ *******************************************************************************/
+uint32_t dfu_frame_packet(uint8_t *packet, uint8_t code, const uint8_t *data, uint32_t length)
+{
+    uint16_t checksum;
+
+    packet[0] = DFU_SOP;
+    packet[1] = code;
+    packet[2] = (uint8_t)length;
+    packet[3] = (uint8_t)(length >> 8);
+    if (length != 0u)
+    {
+        memcpy(&packet[4], data, length);
+    }
+    checksum = dfu_packet_checksum(packet, 4u + length);
+    packet[4u + length] = (uint8_t)checksum;
+    packet[5u + length] = (uint8_t)(checksum >> 8);
+    packet[6u + length] = DFU_EOP;
+
+    return length + DFU_PACKET_OVERHEAD;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_check_packet
+ ********************************************************************************
+ * Summary:
+ *   Checks the EOP and the checksum of a complete packet.
+ *
+ * Parameters:
+ *   packet - Packet, from the SOP to the EOP
+ *   length - Length of the packet data, from its length field
+ *
+ * Return:
+ *   int - 0 if the packet is valid, DFU_HOST_BAD_PACKET otherwise
+ *
+ *******************************************************************************/
+int dfu_check_packet(const uint8_t *packet, uint32_t length)
+{
+    uint16_t checksum = (uint16_t)packet[length + 4u] | ((uint16_t)packet[length + 5u] << 8);
+
+    if ((packet[length + 6u] != DFU_EOP) || (dfu_packet_checksum(packet, length + 4u) != checksum))
+    {
+        return DFU_HOST_BAD_PACKET;
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */
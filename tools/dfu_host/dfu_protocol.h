@@ -0,0 +1,162 @@
+/******************************************************************************
+* File Name: dfu_protocol.h
+*
+* Description: DFU packet protocol carried by transport_uart.c, CYACD2 file
+*   reading and serial port helpers shared by the DFU host and the simulated
+*   device.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef DFU_PROTOCOL_H
+#define DFU_PROTOCOL_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* DFU packet framing: SOP, command or status, length (2), data, checksum (2),
+ * EOP
+ */
+#define DFU_SOP                         (0x01u)
+#define DFU_EOP                         (0x17u)
+#define DFU_PACKET_OVERHEAD             (7u)
+#define DFU_PACKET_MAX                  (4096u)
+
+/* DFU commands */
+#define DFU_CMD_VERIFY_APP              (0x31u)
+#define DFU_CMD_SYNC                    (0x35u)
+#define DFU_CMD_SEND_DATA               (0x37u)
+#define DFU_CMD_ENTER                   (0x38u)
+#define DFU_CMD_EXIT                    (0x3Bu)
+#define DFU_CMD_SEND_DATA_WR            (0x47u)
+#define DFU_CMD_PROGRAM_DATA            (0x49u)
+#define DFU_CMD_VERIFY_DATA             (0x4Au)
+#define DFU_CMD_SET_METADATA            (0x4Cu)
+#define DFU_CMD_SET_EIVECTOR            (0x4Du)
+
+/* Status codes of the DFU responses (cy_en_dfu_status_t) */
+#define DFU_STATUS_SUCCESS              (0x00u)
+#define DFU_STATUS_ERROR_VERIFY         (0x02u)
+#define DFU_STATUS_ERROR_LENGTH         (0x03u)
+#define DFU_STATUS_ERROR_DATA           (0x04u)
+#define DFU_STATUS_ERROR_CMD            (0x05u)
+#define DFU_STATUS_ERROR_CHECKSUM       (0x08u)
+#define DFU_STATUS_ERROR_ROW            (0x0Au)
+#define DFU_STATUS_ERROR_ROW_ACCESS     (0x0Bu)
+#define DFU_STATUS_ERROR_UNKNOWN        (0x0Fu)
+
+/* Host errors, outside of the range of the DFU status codes */
+#define DFU_HOST_TIMEOUT                (0x100)
+#define DFU_HOST_BAD_PACKET             (0x101)
+#define DFU_HOST_IO_ERROR               (0x102)
+
+/* Length of the Enter DFU response: silicon ID, silicon revision, DFU SDK
+ * version (build, minor, major)
+ */
+#define DFU_ENTER_RESPONSE_SIZE         (8u)
+
+/* Address, CRC-32C of the row, then the data of a Program or Verify Data */
+#define DFU_ROW_CMD_HEADER_SIZE         (8u)
+
+/* Rows at this address and above hold data for the DFU (chunk hashes, erase
+ * ranges) and are not in the flash, so they are not verified
+ */
+#define DFU_META_ADDR                   (0x60000000u)
+
+/* transport_uart.c: end of packet detection (UART_BYTE_TO_BYTE_TIMEOUT_US)
+ * and time between two polls of the RX FIFO
+ */
+#define DFU_BYTE_TO_BYTE_TIMEOUT_US     (868u)
+#define DFU_POLL_US                     (1000u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* One row of a CYACD2 file */
+typedef struct
+{
+    uint32_t address;
+    uint32_t length;
+    uint32_t crc;                   /* CRC-32C of the data */
+    const uint8_t *data;
+} cyacd2_row_t;
+
+/* Contents of a CYACD2 file, read once and shared by all the devices */
+typedef struct
+{
+    uint32_t silicon_id;
+    uint8_t silicon_rev;
+    uint8_t checksum_type;
+    uint8_t app_id;
+    uint32_t product_id;
+    bool has_appinfo;
+    uint32_t app_start;
+    uint32_t app_length;
+    uint8_t eiv[64];
+    uint32_t eiv_length;
+    cyacd2_row_t *rows;
+    uint32_t row_count;
+    uint64_t row_bytes;             /* Data bytes of all the rows */
+    uint8_t *row_data;
+} cyacd2_file_t;
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+uint64_t dfu_now_ns(void);
+void dfu_sleep_us(uint64_t us);
+uint64_t dfu_line_time_us(uint32_t bytes, uint32_t baud);
+uint16_t dfu_packet_checksum(const uint8_t *data, uint32_t length);
+uint32_t dfu_crc32c(const uint8_t *data, uint32_t length);
+uint32_t dfu_get_u32(const uint8_t *p);
+void dfu_put_u32(uint8_t *p, uint32_t value);
+uint32_t dfu_frame_packet(uint8_t *packet, uint8_t code, const uint8_t *data, uint32_t length);
+int dfu_check_packet(const uint8_t *packet, uint32_t length);
+const char *dfu_status_name(int status);
+int cyacd2_load(const char *path, cyacd2_file_t *file);
+void cyacd2_free(cyacd2_file_t *file);
+int dfu_port_open(const char *path, uint32_t baud);
+int dfu_write_all(int fd, const uint8_t *data, uint32_t length);
+int dfu_read_timeout(int fd, uint8_t *data, uint32_t length, uint64_t deadline_ns);
+
+#endif /* DFU_PROTOCOL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,414 @@
+/******************************************************************************
+* File Name: dfu_sim.c
+*
+* Description: Simulated device for the DFU host, see dfu_sim.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 700
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "dfu_sim.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The simulated device gives up when the host sends nothing for so long */
+#define DFU_SIM_IDLE_TIMEOUT_S          (60u)
+
+/* Highest file descriptor closed in the child process */
+#define DFU_SIM_MAX_FD                  (4096)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* State of a simulated device */
+typedef struct
+{
+    const cyacd2_file_t *file;
+    dfu_sim_cfg_t cfg;
+    int fd;
+    bool entered;
+    uint8_t **rows;                 /* Programmed data of each row of the file */
+    uint32_t programmed;
+    uint32_t last_row;              /* Row found by the last search */
+    uint32_t responses;
+    uint32_t buffered;              /* Bytes received by Send Data */
+    uint8_t buffer[DFU_PACKET_MAX];
+    uint8_t packet[DFU_PACKET_MAX + DFU_PACKET_OVERHEAD];
+    uint8_t response[DFU_PACKET_MAX];
+} dfu_sim_t;
+
+/*******************************************************************************
+ * Function Name: sim_respond
+ ********************************************************************************
+ * Summary:
+ *   Sends a response after its line time and the turnaround of the
+ *   USB-serial bridge. Every cfg.error_every responses, the checksum is
+ *   corrupted.
+ *
+ *******************************************************************************/
+static void sim_respond(dfu_sim_t *sim, uint8_t status, const uint8_t *data, uint32_t length)
+{
+    uint32_t size = dfu_frame_packet(sim->response, status, data, length);
+
+    sim->responses++;
+    if ((sim->cfg.error_every != 0u) && ((sim->responses % sim->cfg.error_every) == 0u))
+    {
+        sim->response[size - 2u] ^= 0x5Au;
+    }
+
+    dfu_sleep_us(dfu_line_time_us(size, sim->cfg.baud) + sim->cfg.latency_us);
+    (void)dfu_write_all(sim->fd, sim->response, size);
+}
+
+/*******************************************************************************
+ * Function Name: sim_find_row
+ ********************************************************************************
+ * Summary:
+ *   Finds the row of the file at an address. The rows are usually sent in
+ *   order, so the search starts after the last row found.
+ *
+ * Return:
+ *   uint32_t - Index of the row, or the number of rows if there is none
+ *
+ *******************************************************************************/
+static uint32_t sim_find_row(dfu_sim_t *sim, uint32_t address, uint32_t length)
+{
+    const cyacd2_file_t *file = sim->file;
+
+    for (uint32_t n = 0u; n < file->row_count; n++)
+    {
+        uint32_t i = (sim->last_row + n) % file->row_count;
+
+        if ((file->rows[i].address == address) && (file->rows[i].length == length))
+        {
+            sim->last_row = i;
+            return i;
+        }
+    }
+
+    return file->row_count;
+}
+
+/*******************************************************************************
+ * Function Name: sim_row_command
+ ********************************************************************************
+ * Summary:
+ *   Handles Program Data and Verify Data: the data received by Send Data and
+ *   the data of the packet make one row, checked against its CRC-32C.
+ *
+ * Return:
+ *   uint8_t - Status code of the response
+ *
+ *******************************************************************************/
+static uint8_t sim_row_command(dfu_sim_t *sim, uint8_t cmd, const uint8_t *data, uint32_t data_len)
+{
+    uint32_t address, crc, length, row_num;
+
+    if ((data_len < DFU_ROW_CMD_HEADER_SIZE) ||
+        ((sim->buffered + data_len - DFU_ROW_CMD_HEADER_SIZE) > sizeof(sim->buffer)))
+    {
+        sim->buffered = 0u;
+        return DFU_STATUS_ERROR_LENGTH;
+    }
+
+    address = dfu_get_u32(data);
+    crc = dfu_get_u32(&data[4]);
+    memcpy(&sim->buffer[sim->buffered], &data[DFU_ROW_CMD_HEADER_SIZE], data_len - DFU_ROW_CMD_HEADER_SIZE);
+    length = sim->buffered + data_len - DFU_ROW_CMD_HEADER_SIZE;
+    sim->buffered = 0u;
+
+    if (dfu_crc32c(sim->buffer, length) != crc)
+    {
+        return DFU_STATUS_ERROR_CHECKSUM;
+    }
+
+    row_num = sim_find_row(sim, address, length);
+    if (row_num == sim->file->row_count)
+    {
+        return DFU_STATUS_ERROR_ROW;
+    }
+
+    if (cmd == DFU_CMD_VERIFY_DATA)
+    {
+        return ((sim->rows[row_num] != NULL) && (memcmp(sim->rows[row_num], sim->buffer, length) == 0)) ?
+               DFU_STATUS_SUCCESS : DFU_STATUS_ERROR_VERIFY;
+    }
+
+    if (sim->rows[row_num] == NULL)
+    {
+        sim->rows[row_num] = malloc(length);
+        if (sim->rows[row_num] == NULL)
+        {
+            return DFU_STATUS_ERROR_UNKNOWN;
+        }
+        sim->programmed++;
+    }
+    memcpy(sim->rows[row_num], sim->buffer, length);
+    dfu_sleep_us(sim->cfg.row_write_us);
+
+    return DFU_STATUS_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: sim_receive
+ ********************************************************************************
+ * Summary:
+ *   Receives the next packet, then takes its line time, the byte-to-byte
+ *   timeout that ends it and half a poll period of transport_uart.c.
+ *
+ * Return:
+ *   int - Length of the packet data, or -1 when the host has gone
+ *
+ *******************************************************************************/
+static int sim_receive(dfu_sim_t *sim)
+{
+    uint64_t deadline = dfu_now_ns() + ((uint64_t)DFU_SIM_IDLE_TIMEOUT_S * 1000000000u);
+    uint32_t data_len;
+
+    do
+    {
+        if (dfu_read_timeout(sim->fd, sim->packet, 1u, deadline) != 0)
+        {
+            return -1;
+        }
+    }
+    while (sim->packet[0] != DFU_SOP);
+
+    if (dfu_read_timeout(sim->fd, &sim->packet[1], 3u, deadline) != 0)
+    {
+        return -1;
+    }
+    data_len = (uint32_t)sim->packet[2] | ((uint32_t)sim->packet[3] << 8);
+    if ((data_len > DFU_PACKET_MAX) ||
+        (dfu_read_timeout(sim->fd, &sim->packet[4], data_len + 3u, deadline) != 0))
+    {
+        return -1;
+    }
+
+    dfu_sleep_us(dfu_line_time_us(data_len + DFU_PACKET_OVERHEAD, sim->cfg.baud) +
+                 DFU_BYTE_TO_BYTE_TIMEOUT_US + (DFU_POLL_US / 2u));
+
+    return (int)data_len;
+}
+
+/*******************************************************************************
+ * Function Name: sim_run
+ ********************************************************************************
+ * Summary:
+ *   Answers the DFU commands until Exit DFU, or until the host closes the
+ *   port or stays silent for DFU_SIM_IDLE_TIMEOUT_S.
+ *
+ *******************************************************************************/
+static void sim_run(dfu_sim_t *sim)
+{
+    const cyacd2_file_t *file = sim->file;
+    int received;
+
+    while ((received = sim_receive(sim)) >= 0)
+    {
+        uint32_t data_len = (uint32_t)received;
+        const uint8_t *data = &sim->packet[4];
+        uint8_t cmd = sim->packet[1];
+        uint8_t status = DFU_STATUS_SUCCESS;
+        uint8_t resp[DFU_ENTER_RESPONSE_SIZE];
+        uint32_t resp_len = 0u;
+        bool respond = true;
+
+        if (dfu_check_packet(sim->packet, data_len) != 0)
+        {
+            sim_respond(sim, DFU_STATUS_ERROR_CHECKSUM, NULL, 0u);
+            continue;
+        }
+
+        if ((!sim->entered) && (cmd != DFU_CMD_ENTER) && (cmd != DFU_CMD_SYNC))
+        {
+            sim_respond(sim, DFU_STATUS_ERROR_CMD, NULL, 0u);
+            continue;
+        }
+
+        switch (cmd)
+        {
+            case DFU_CMD_ENTER:
+                if ((data_len >= 4u) && (dfu_get_u32(data) != file->product_id))
+                {
+                    status = DFU_STATUS_ERROR_DATA;
+                    break;
+                }
+                sim->entered = true;
+                sim->buffered = 0u;
+                dfu_put_u32(resp, file->silicon_id);
+                resp[4] = file->silicon_rev;
+                resp[5] = 0u;
+                resp[6] = DFU_SIM_SDK_VERSION_MINOR;
+                resp[7] = DFU_SIM_SDK_VERSION_MAJOR;
+                resp_len = DFU_ENTER_RESPONSE_SIZE;
+                break;
+
+            case DFU_CMD_SYNC:
+                sim->buffered = 0u;
+                respond = false;
+                break;
+
+            case DFU_CMD_SEND_DATA:
+            case DFU_CMD_SEND_DATA_WR:
+                respond = (cmd == DFU_CMD_SEND_DATA);
+                if ((sim->buffered + data_len) > sizeof(sim->buffer))
+                {
+                    sim->buffered = 0u;
+                    status = DFU_STATUS_ERROR_LENGTH;
+                    break;
+                }
+                memcpy(&sim->buffer[sim->buffered], data, data_len);
+                sim->buffered += data_len;
+                break;
+
+            case DFU_CMD_PROGRAM_DATA:
+            case DFU_CMD_VERIFY_DATA:
+                status = sim_row_command(sim, cmd, data, data_len);
+                break;
+
+            case DFU_CMD_VERIFY_APP:
+                resp[0] = ((data_len == 1u) && (data[0] == file->app_id) && (sim->programmed != 0u)) ? 1u : 0u;
+                resp_len = 1u;
+                break;
+
+            case DFU_CMD_SET_EIVECTOR:
+                break;
+
+            case DFU_CMD_EXIT:
+                return;
+
+            default:
+                /* Including Set Application Metadata: CY_DFU_METADATA_WRITABLE=0 */
+                status = DFU_STATUS_ERROR_CMD;
+                break;
+        }
+
+        if (respond || (status != DFU_STATUS_SUCCESS))
+        {
+            sim_respond(sim, status, resp, (status == DFU_STATUS_SUCCESS) ? resp_len : 0u);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dfu_sim_start
+ ********************************************************************************
+ * Summary:
+ *   Creates a pseudo terminal, opens its slave side as the port of the host
+ *   and starts a simulated device on its master side in a child process.
+ *
+ * Parameters:
+ *   file    - CYACD2 file that the host transfers
+ *   cfg     - Timing and faults of the simulated device
+ *   port_fd - Receives the port of the host, opened by dfu_port_open()
+ *
+ * Return:
+ *   pid_t - Process ID of the simulated device, or -1 on error
+ *
+ *******************************************************************************/
+pid_t dfu_sim_start(const cyacd2_file_t *file, const dfu_sim_cfg_t *cfg, int *port_fd)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    pid_t pid;
+
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0) || (ptsname(master) == NULL))
+    {
+        fprintf(stderr, "Cannot create a pseudo terminal: %s\n", strerror(errno));
+        if (master >= 0)
+        {
+            close(master);
+        }
+        return -1;
+    }
+
+    *port_fd = dfu_port_open(ptsname(master), cfg->baud);
+    if (*port_fd < 0)
+    {
+        close(master);
+        return -1;
+    }
+
+    pid = fork();
+    if (pid == 0)
+    {
+        static dfu_sim_t sim;
+
+        /* Only the own pseudo terminal stays open, so that the device sees
+         * the host close its port
+         */
+        for (int fd = 3; fd < DFU_SIM_MAX_FD; fd++)
+        {
+            if (fd != master)
+            {
+                (void)close(fd);
+            }
+        }
+
+        sim.file = file;
+        sim.cfg = *cfg;
+        sim.fd = master;
+        sim.rows = calloc(file->row_count + 1u, sizeof(uint8_t *));
+        if (sim.rows != NULL)
+        {
+            sim_run(&sim);
+        }
+        _exit(0);
+    }
+    close(master);
+
+    if (pid < 0)
+    {
+        fprintf(stderr, "Cannot start the simulated device: %s\n", strerror(errno));
+        close(*port_fd);
+        *port_fd = -1;
+    }
+
+    return pid;
+}
+
+/* [] END OF FILE */
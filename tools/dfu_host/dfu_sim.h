@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name: dfu_sim.h
+*
+* Description: Simulated device for the DFU host. Each simulated device runs
+*   in a child process on the master side of its own pseudo terminal, and
+*   the host opens the slave side like a serial port. The device answers the
+*   commands of the DFU SDK with the timing of transport_uart.c at the
+*   simulated baud rate, the row write time of the flash and the turnaround
+*   of a USB-serial bridge. The rows of the CYACD2 file are its memory:
+*   Program Data accepts only their addresses, and Verify Data compares with
+*   what was programmed. Verify App accepts any application with programmed
+*   rows: the image signature is not checked.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef DFU_SIM_H
+#define DFU_SIM_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+#include <sys/types.h>
+#include "dfu_protocol.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* DFU SDK version reported by the simulated device: 4.20.0 */
+#define DFU_SIM_SDK_VERSION_MAJOR       (4u)
+#define DFU_SIM_SDK_VERSION_MINOR       (20u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Simulated device timing and faults */
+typedef struct
+{
+    uint32_t baud;                  /* Line rate */
+    uint32_t row_write_us;          /* Row erase and program time */
+    uint32_t latency_us;            /* Turnaround of the USB-serial bridge */
+    uint32_t error_every;           /* Corrupt every Nth response, 0 for none */
+} dfu_sim_cfg_t;
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+pid_t dfu_sim_start(const cyacd2_file_t *file, const dfu_sim_cfg_t *cfg, int *port_fd);
+
+#endif /* DFU_SIM_H */
+
+/* [] END OF FILE */
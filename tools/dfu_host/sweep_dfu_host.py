@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import os
+import platform
+import random
+import subprocess
+import sys
+import tempfile
+
+# This script measures how the DFU host (dfu_host.c) scales with the number
+# of devices. It writes a CYACD2 file of --rows random rows and runs the
+# --sim sweep of dfu_host, which updates 1, 2, 4... simulated devices on
+# pseudo terminals at once, for each line rate, bridge turnaround and
+# pipelining setting. The results are printed as a Markdown table, with the
+# host they were measured on; sweep_results.md holds the committed results.
+# Example Usage:
+# sweep_dfu_host.py --tool ./dfu_host
+# sweep_dfu_host.py --tool ./dfu_host --baud 115200 --latency-us 8000 --counts 1,8,64
+# sweep_dfu_host.py --tool ./dfu_host --out sweep_results.md
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_TOOL = os.path.join(SCRIPT_DIR, "dfu_host")
+
+ROW_SIZE = 512
+ROW_ADDR = 0x10100000
+
+# Header of the CYACD2 file: version 1, silicon ID and revision 0, sum
+# checksum, application 1, product ID 0x01020304
+CYACD2_HEADER = "010000000000000104030201"
+
+
+def write_cyacd2(path, rows, seed):
+    """Writes a CYACD2 file of random rows
+
+    Args:
+        path: Output file
+        rows: Number of rows
+        seed: Seed of the row data
+    """
+    rng = random.Random(seed)
+    with open(path, "w", encoding="ascii") as cyacd2_f:
+        cyacd2_f.write(f"{CYACD2_HEADER}\n@APPINFO:0x{ROW_ADDR:X},0x{rows * ROW_SIZE:X}\n")
+        for row in range(rows):
+            address = (ROW_ADDR + row * ROW_SIZE).to_bytes(4, "little").hex().upper()
+            cyacd2_f.write(f":{address}{rng.randbytes(ROW_SIZE).hex().upper()}\n")
+
+
+def sweep(tool, cyacd2, counts, baud, latency_us, pipeline):
+    """Runs one --sim sweep of dfu_host
+
+    Returns:
+        list: (devices, updated, time s, total KB/s, KB/s each, RTT ms) per count
+    """
+    # dfu_host prints the full report instead of a sweep line for a single
+    # count, so a single count is run twice and the first round is dropped
+    sweep_counts = counts if len(counts) > 1 else counts * 2
+    command = [tool, "--sim", ",".join(str(count) for count in sweep_counts), "--baud", str(baud),
+               "--sim-latency-us", str(latency_us)]
+    if not pipeline:
+        command.append("--no-pipeline")
+    try:
+        result = subprocess.run(command + [cyacd2], capture_output=True, text=True)
+    except OSError as error:
+        raise RuntimeError(f"{tool}: {error}") from error
+    if result.returncode == 2:
+        raise RuntimeError(f"{' '.join(command)} failed:\n{result.stderr}")
+
+    rows = list()
+    for line in result.stdout.splitlines()[1 + len(sweep_counts) - len(counts):]:
+        fields = line.split()
+        rows.append((int(fields[0]), int(fields[1])) + tuple(float(field) for field in fields[2:6]))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure the scaling of dfu_host with simulated devices")
+    parser.add_argument("--tool", default=DEFAULT_TOOL, help="dfu_host (default tools/dfu_host/dfu_host)")
+    parser.add_argument("--rows", type=int, default=161,
+                        help="Rows of the CYACD2 file (default 161, a sparse UPGRADE file)")
+    parser.add_argument("--counts", default="1,2,4,8,16,32,64", help="Device counts (default 1,2,4,8,16,32,64)")
+    parser.add_argument("--baud", type=int, nargs="+", default=[115200, 921600], help="Line rates")
+    parser.add_argument("--latency-us", type=int, nargs="+", default=[1000, 8000],
+                        help="Turnarounds of the USB-serial bridge")
+    parser.add_argument("--seed", type=int, default=1, help="Seed of the row data")
+    parser.add_argument("--out", help="Also write the table to this file")
+
+    args = parser.parse_args()
+    counts = [int(count) for count in args.counts.split(",")]
+
+    lines = ["# DFU host scaling with simulated devices",
+             "",
+             f"Host: {platform.machine()}, {os.cpu_count()} CPU(s), {platform.system()} {platform.release()}; "
+             f"{args.rows} rows of {ROW_SIZE} bytes per device",
+             "",
+             "| Baud | Turnaround | Pipelining | Devices | Updated | Time s | Total KB/s | KB/s each | RTT avg ms |",
+             "|---:|---:|---|---:|---:|---:|---:|---:|---:|"]
+    with tempfile.TemporaryDirectory() as work_dir:
+        cyacd2 = os.path.join(work_dir, "sweep.cyacd2")
+        write_cyacd2(cyacd2, args.rows, args.seed)
+        print(lines[2], flush=True)
+        for baud in args.baud:
+            for latency_us in args.latency_us:
+                for pipeline in (True, False):
+                    try:
+                        results = sweep(args.tool, cyacd2, counts, baud, latency_us, pipeline)
+                    except RuntimeError as error:
+                        sys.exit(str(error))
+                    for devices, updated, seconds, total, each, rtt in results:
+                        line = (f"| {baud} | {latency_us / 1000:g} ms | {'on' if pipeline else 'off'} | {devices} | "
+                                f"{updated} | {seconds:.2f} | {total:.1f} | {each:.1f} | {rtt:.2f} |")
+                        lines.append(line)
+                        print(line, flush=True)
+
+    if args.out:
+        with open(args.out, "w", encoding="ascii") as out_f:
+            out_f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
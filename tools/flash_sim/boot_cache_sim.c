@@ -0,0 +1,651 @@
+/******************************************************************************
+* File Name: boot_cache_sim.c
+*
+* Description: Host harness for the validated-image cache of the bootloader
+*   (cy_ps_boot_cache.c, FAST_BOOT=1). The protected storage and the primary
+*   slot are mapped at their device addresses, so cy_ps_boot_cache.c reads
+*   them directly as on the device. Cy_Flash_WriteRow(), the reset cause,
+*   boot_swap_type(), and boot_go() are simulated: boot_go() accepts the
+*   slot only if it holds the last image that the test signed.
+*
+*   Each test runs a sequence of resets and checks the decision of
+*   cy_ps_boot_cache_lookup() for each of them:
+*   - Warm resets skip the validation at most
+*     CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL times in a row, and cold resets
+*     never skip it.
+*   - A change to the header or the trailer of the image invalidates the
+*     cache. A change to the body only is caught by the next full
+*     validation.
+*   - A pending upgrade invalidates the cache before the primary slot is
+*     written, also when the upgrade is interrupted.
+*   - A fast boot is allowed only if the count of fast boots was stored: a
+*     failed or torn write of the cache row forces a full validation.
+*   - A reset loop writes the cache row at most once per reset, and stops
+*     writing it after CY_PS_BOOT_CACHE_MAX_ROW_WRITES writes.
+*
+*   Build, with the protected storage of the targets (layout.mk) and a
+*   small primary slot:
+*   gcc -o boot_cache_sim -DPROTECTED_MEM_START=0x1001C000UL
+*       -DPROTECTED_MEM_SIZE=0x4000UL -DCY_START_OF_FLASH=0x10000000UL
+*       -DCY_BOOT_PRIMARY_1_START_ADDRESS=0x10020000UL
+*       -DCY_BOOT_PRIMARY_1_SIZE=0x20000UL
+*       -Itools/flash_sim/boot_cache_include -Itools/flash_sim/host_include
+*       -Iproj_btldr_cm0p/source proj_btldr_cm0p/source/cy_ps_boot_cache.c
+*       tools/flash_sim/boot_cache_sim.c
+*
+*   Example Usage:
+*   boot_cache_sim
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include "cy_pdl.h"
+#include "cy_ps_boot_cache.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Image written by the test: header, body, and a TLV area with the size of
+ * a SHA-256 hash and an ECDSA P-256 signature
+ */
+#define SIM_HDR_SIZE                    (0x400u)
+#define SIM_BODY_SIZE                   (0x4000u)
+#define SIM_TLV_SIZE                    (4u + 36u + 76u)
+#define SIM_IMAGE_SIZE                  (SIM_HDR_SIZE + SIM_BODY_SIZE + SIM_TLV_SIZE)
+
+/* Cache record, see boot_cache_record_t */
+#define SIM_RECORD_GENERATION           (4u)
+#define SIM_RECORD_VERIFIED_GENERATION  (8u)
+#define SIM_RECORD_FAST_BOOTS           (12u)
+#define SIM_RECORD_ROW_WRITES           (16u)
+
+/* Erased value of the internal flash */
+#define SIM_ERASED_VAL                  (0x00u)
+
+/* Warm and cold reset causes */
+#define SIM_RESET_SOFT                  (CY_SYSLIB_RESET_SOFT)
+#define SIM_RESET_WDT                   (CY_SYSLIB_RESET_HWWDT)
+#define SIM_RESET_POWER_ON              (0UL)
+#define SIM_RESET_FAULT                 (CY_SYSLIB_RESET_ACT_FAULT)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* How the next write of the cache row ends */
+typedef enum
+{
+    SIM_WRITE_OK,                   /* Row written */
+    SIM_WRITE_ERROR,                /* Write fails without a reset, row unchanged */
+    SIM_WRITE_TORN                  /* Power lost, first half of the row written */
+} sim_write_t;
+
+/* Result of one simulated reset */
+typedef struct
+{
+    cy_en_ps_boot_cache_result_t result;
+    bool validated;                 /* boot_go() ran */
+    bool booted;                    /* An image was started */
+} sim_boot_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t *prot_mem;
+static uint8_t *slot_mem;
+
+/* Copy of the last image signed by the test, accepted by boot_go() */
+static uint8_t signed_image[SIM_IMAGE_SIZE];
+
+static uint32_t reset_reason;
+static int swap_type = BOOT_SWAP_TYPE_NONE;
+static sim_write_t next_write = SIM_WRITE_OK;
+static jmp_buf power_cut;
+
+static uint32_t cache_writes;
+static uint32_t checks;
+static uint32_t failures;
+
+static const char *const result_names[] =
+{
+    "hit", "cold", "periodic", "pending", "miss", "worn"
+};
+
+/*******************************************************************************
+ * Function Name: Cy_Flash_WriteRow
+ ********************************************************************************
+ * Summary:
+ *   Simulated row write of the protected storage. The write ends as set by
+ *   next_write, which is then reset to SIM_WRITE_OK.
+ *
+ *******************************************************************************/
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    sim_write_t mode = next_write;
+    uint8_t *row;
+
+    if ((rowAddr < PROTECTED_MEM_START) || (rowAddr >= (PROTECTED_MEM_START + PROTECTED_MEM_SIZE)) ||
+        ((rowAddr % CY_FLASH_SIZEOF_ROW) != 0u))
+    {
+        fprintf(stderr, "Row write outside the protected storage: 0x%08" PRIX32 "\n", rowAddr);
+        exit(2);
+    }
+
+    row = &prot_mem[rowAddr - PROTECTED_MEM_START];
+    next_write = SIM_WRITE_OK;
+    cache_writes++;
+
+    switch (mode)
+    {
+        case SIM_WRITE_ERROR:
+            return CY_FLASH_DRV_ERR_UNC;
+
+        case SIM_WRITE_TORN:
+            memset(row, SIM_ERASED_VAL, CY_FLASH_SIZEOF_ROW);
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW / 2u);
+            longjmp(power_cut, 1);
+
+        default:
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW);
+            return CY_FLASH_DRV_SUCCESS;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: Cy_SysLib_GetResetReason
+ ********************************************************************************
+ * Summary:
+ *   Simulated reset cause, set by sim_reset().
+ *
+ *******************************************************************************/
+uint32_t Cy_SysLib_GetResetReason(void)
+{
+    return reset_reason;
+}
+
+/*******************************************************************************
+ * Function Name: boot_swap_type
+ ********************************************************************************
+ * Summary:
+ *   Simulated upgrade state of the slots.
+ *
+ *******************************************************************************/
+int boot_swap_type(void)
+{
+    return swap_type;
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_go
+ ********************************************************************************
+ * Summary:
+ *   Simulated boot_go(). Accepts the primary slot if it holds the last
+ *   signed image.
+ *
+ *******************************************************************************/
+static bool sim_boot_go(void)
+{
+    return (memcmp(slot_mem, signed_image, SIM_IMAGE_SIZE) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: sim_sign_image
+ ********************************************************************************
+ * Summary:
+ *   Writes a new image to the primary slot and makes boot_go() accept it.
+ *   The body and the TLVs depend on the version.
+ *
+ *******************************************************************************/
+static void sim_sign_image(uint8_t version)
+{
+    struct image_header *hdr = (struct image_header *)slot_mem;
+    struct image_tlv_info *info = (struct image_tlv_info *)&slot_mem[SIM_HDR_SIZE + SIM_BODY_SIZE];
+
+    memset(slot_mem, SIM_ERASED_VAL, CY_BOOT_PRIMARY_1_SIZE);
+    hdr->ih_magic = IMAGE_MAGIC;
+    hdr->ih_hdr_size = SIM_HDR_SIZE;
+    hdr->ih_img_size = SIM_BODY_SIZE;
+    hdr->ih_ver.iv_major = version;
+
+    for (uint32_t i = 0u; i < SIM_BODY_SIZE; i++)
+    {
+        slot_mem[SIM_HDR_SIZE + i] = (uint8_t)((i * 31u) + version);
+    }
+
+    info->it_magic = IMAGE_TLV_INFO_MAGIC;
+    info->it_tlv_tot = SIM_TLV_SIZE;
+    for (uint32_t i = sizeof(*info); i < SIM_TLV_SIZE; i++)
+    {
+        slot_mem[SIM_HDR_SIZE + SIM_BODY_SIZE + i] = (uint8_t)((i * 7u) ^ version);
+    }
+
+    memcpy(signed_image, slot_mem, SIM_IMAGE_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: sim_reset
+ ********************************************************************************
+ * Summary:
+ *   Runs the boot path of main.c with FAST_BOOT=1 after a reset with the
+ *   given cause. A torn cache row write ends the boot without a result.
+ *
+ *******************************************************************************/
+static sim_boot_t sim_reset(uint32_t reason)
+{
+    static sim_boot_t boot;
+    struct boot_rsp rsp;
+
+    memset(&boot, 0, sizeof(boot));
+    memset(&rsp, 0, sizeof(rsp));
+    reset_reason = reason;
+
+    if (setjmp(power_cut) != 0)
+    {
+        boot.result = CY_PS_BOOT_CACHE_MISS;
+        return boot;
+    }
+
+    boot.result = cy_ps_boot_cache_lookup(&rsp);
+    if (boot.result == CY_PS_BOOT_CACHE_HIT)
+    {
+        boot.booted = (rsp.br_hdr == (const struct image_header *)slot_mem) &&
+                      (rsp.br_image_off == (CY_BOOT_PRIMARY_1_START_ADDRESS - CY_START_OF_FLASH));
+    }
+    else
+    {
+        boot.validated = true;
+        boot.booted = sim_boot_go();
+        if (boot.booted)
+        {
+            cy_ps_boot_cache_update();
+        }
+    }
+
+    return boot;
+}
+
+/*******************************************************************************
+ * Function Name: record_word
+ ********************************************************************************
+ * Summary:
+ *   Reads a word of the cache record in flash.
+ *
+ *******************************************************************************/
+static uint32_t record_word(uint32_t offset)
+{
+    uint32_t value;
+
+    memcpy(&value, &prot_mem[CY_PS_BOOT_CACHE_ADDR - PROTECTED_MEM_START + offset], sizeof(value));
+
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ ********************************************************************************
+ * Summary:
+ *   Counts a check and prints the failed ones.
+ *
+ *******************************************************************************/
+static bool check(bool ok, const char *what, uint32_t reset)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("  FAIL: %s, reset %" PRIu32 "\n", what, reset);
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: check_boot
+ ********************************************************************************
+ * Summary:
+ *   Checks the decision and the outcome of a reset.
+ *
+ *******************************************************************************/
+static void check_boot(sim_boot_t boot, cy_en_ps_boot_cache_result_t result, bool booted, uint32_t reset)
+{
+    char what[80];
+
+    (void)snprintf(what, sizeof(what), "%s instead of %s", result_names[boot.result], result_names[result]);
+    (void)check(boot.result == result, what, reset);
+    (void)check(boot.booted == booted, booted ? "image not started" : "image started", reset);
+}
+
+/*******************************************************************************
+ * Function Name: start
+ ********************************************************************************
+ * Summary:
+ *   Erases the protected storage, signs image version 1, and runs a
+ *   power-on reset, which validates the image and writes the cache record.
+ *
+ *******************************************************************************/
+static void start(void)
+{
+    sim_boot_t boot;
+
+    memset(prot_mem, SIM_ERASED_VAL, PROTECTED_MEM_SIZE);
+    swap_type = BOOT_SWAP_TYPE_NONE;
+    next_write = SIM_WRITE_OK;
+    sim_sign_image(1u);
+
+    boot = sim_reset(SIM_RESET_POWER_ON);
+    check_boot(boot, CY_PS_BOOT_CACHE_COLD, true, 0u);
+}
+
+/*******************************************************************************
+ * Function Name: report
+ ********************************************************************************
+ * Summary:
+ *   Prints the outcome of a test.
+ *
+ *******************************************************************************/
+static void report(const char *name, uint32_t first_failure)
+{
+    printf("%-28s %s\n", name, (failures == first_failure) ? "passed" : "FAILED");
+}
+
+/*******************************************************************************
+ * Function Name: test_resets
+ ********************************************************************************
+ * Summary:
+ *   Warm resets skip the validation at most
+ *   CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL times in a row. The count is read
+ *   back from the cache record. Cold resets always validate.
+ *
+ *******************************************************************************/
+static void test_resets(void)
+{
+    const uint32_t first_failure = failures;
+    const uint32_t resets = 3u * (CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL + 1u);
+    uint32_t fast_boots = 0u;
+
+    start();
+    for (uint32_t reset = 1u; reset <= resets; reset++)
+    {
+        sim_boot_t boot = sim_reset(((reset % 2u) == 0u) ? SIM_RESET_SOFT : SIM_RESET_WDT);
+
+        if (fast_boots < CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL)
+        {
+            check_boot(boot, CY_PS_BOOT_CACHE_HIT, true, reset);
+            fast_boots++;
+        }
+        else
+        {
+            check_boot(boot, CY_PS_BOOT_CACHE_PERIODIC, true, reset);
+            fast_boots = 0u;
+        }
+        (void)check(record_word(SIM_RECORD_FAST_BOOTS) == fast_boots, "fast boot count not stored", reset);
+    }
+
+    (void)check(sim_reset(SIM_RESET_POWER_ON).result == CY_PS_BOOT_CACHE_COLD, "power-on reset skipped", resets + 1u);
+    (void)check(sim_reset(SIM_RESET_FAULT).result == CY_PS_BOOT_CACHE_COLD, "fault reset skipped", resets + 2u);
+    (void)check(record_word(SIM_RECORD_FAST_BOOTS) == 0u, "validation did not clear the count", resets + 2u);
+
+    report("Warm and cold resets", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_image_changes
+ ********************************************************************************
+ * Summary:
+ *   Changes to the header or the trailer invalidate the cache. A change to
+ *   the body is caught by the next full validation.
+ *
+ *******************************************************************************/
+static void test_image_changes(void)
+{
+    const uint32_t first_failure = failures;
+    struct image_header *hdr = (struct image_header *)slot_mem;
+    sim_boot_t boot;
+    uint32_t reset = 1u;
+
+    /* Header */
+    start();
+    hdr->ih_flags ^= 1u;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, false, reset++);
+    hdr->ih_flags ^= 1u;
+
+    /* Trailer: the signature */
+    start();
+    slot_mem[SIM_IMAGE_SIZE - 1u] ^= 0x01u;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, false, reset++);
+
+    /* Trailer: a TLV area that grows */
+    start();
+    ((struct image_tlv_info *)&slot_mem[SIM_HDR_SIZE + SIM_BODY_SIZE])->it_tlv_tot += 4u;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, false, reset++);
+
+    /* Newly signed image in place of the validated one */
+    start();
+    sim_sign_image(2u);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, true, reset++);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_HIT, true, reset++);
+
+    /* Body only: skipped until the count is reached, then refused */
+    start();
+    slot_mem[SIM_HDR_SIZE + 0x100u] ^= 0x01u;
+    for (uint32_t i = 0u; i < CY_PS_BOOT_CACHE_FULL_CHECK_INTERVAL; i++)
+    {
+        check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_HIT, true, reset++);
+    }
+    boot = sim_reset(SIM_RESET_SOFT);
+    check_boot(boot, CY_PS_BOOT_CACHE_PERIODIC, false, reset++);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_PERIODIC, false, reset++);
+
+    report("Image changes", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_upgrade
+ ********************************************************************************
+ * Summary:
+ *   A pending upgrade increments the generation before boot_go() writes the
+ *   primary slot. An upgrade interrupted after the write of the slot, before
+ *   the cache is updated, must not be skipped even if the header and the
+ *   trailer are those of the validated image.
+ *
+ *******************************************************************************/
+static void test_upgrade(void)
+{
+    const uint32_t first_failure = failures;
+    uint32_t generation;
+    uint32_t reset = 1u;
+
+    start();
+    generation = record_word(SIM_RECORD_GENERATION);
+
+    /* Interrupted upgrade: the body was partly overwritten */
+    swap_type = BOOT_SWAP_TYPE_PERM;
+    reset_reason = SIM_RESET_SOFT;
+    {
+        struct boot_rsp rsp;
+
+        (void)check(cy_ps_boot_cache_lookup(&rsp) == CY_PS_BOOT_CACHE_PENDING, "upgrade not detected", reset);
+    }
+    (void)check(record_word(SIM_RECORD_GENERATION) == (generation + 1u), "generation not incremented", reset);
+    (void)check(record_word(SIM_RECORD_VERIFIED_GENERATION) == generation, "validated generation changed", reset);
+    slot_mem[SIM_HDR_SIZE + 0x200u] ^= 0x01u;
+    swap_type = BOOT_SWAP_TYPE_NONE;
+    reset++;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, false, reset++);
+
+    /* Upgrade completed */
+    start();
+    swap_type = BOOT_SWAP_TYPE_PERM;
+    sim_sign_image(2u);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_PENDING, true, reset++);
+    swap_type = BOOT_SWAP_TYPE_NONE;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_HIT, true, reset++);
+    (void)check(record_word(SIM_RECORD_GENERATION) == record_word(SIM_RECORD_VERIFIED_GENERATION),
+                "upgraded image not recorded", reset);
+
+    report("Upgrade", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_write_faults
+ ********************************************************************************
+ * Summary:
+ *   A fast boot whose count cannot be stored runs a full validation. A torn
+ *   record is rejected on the next reset.
+ *
+ *******************************************************************************/
+static void test_write_faults(void)
+{
+    const uint32_t first_failure = failures;
+    uint32_t reset = 1u;
+    uint32_t writes;
+
+    start();
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_HIT, true, reset++);
+
+    /* The count write fails: validated, and the count is cleared */
+    next_write = SIM_WRITE_ERROR;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, true, reset++);
+    (void)check(record_word(SIM_RECORD_FAST_BOOTS) == 0u, "count not cleared", reset - 1u);
+
+    /* The power is lost during the count write */
+    next_write = SIM_WRITE_TORN;
+    (void)sim_reset(SIM_RESET_SOFT);
+    reset++;
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_MISS, true, reset++);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_HIT, true, reset++);
+
+    /* A validation does not write the row if the record is unchanged */
+    (void)sim_reset(SIM_RESET_POWER_ON);
+    writes = cache_writes;
+    check_boot(sim_reset(SIM_RESET_POWER_ON), CY_PS_BOOT_CACHE_COLD, true, reset++);
+    (void)check(cache_writes == writes, "unchanged record written", reset - 1u);
+
+    report("Cache row write faults", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_wear
+ ********************************************************************************
+ * Summary:
+ *   A watchdog reset loop writes the cache row at most once per reset. Once
+ *   the row was written CY_PS_BOOT_CACHE_MAX_ROW_WRITES times, every reset
+ *   validates the image and the row is no longer written.
+ *
+ *******************************************************************************/
+static void test_wear(void)
+{
+    const uint32_t first_failure = failures;
+    const uint32_t max_resets = 2u * CY_PS_BOOT_CACHE_MAX_ROW_WRITES;
+    uint32_t reset = 1u;
+    uint32_t most_writes = 0u;
+    uint32_t writes;
+    sim_boot_t boot;
+
+    start();
+    do
+    {
+        writes = cache_writes;
+        boot = sim_reset(SIM_RESET_WDT);
+        if ((cache_writes - writes) > most_writes)
+        {
+            most_writes = cache_writes - writes;
+        }
+        reset++;
+    } while ((boot.result != CY_PS_BOOT_CACHE_WORN) && (reset <= max_resets));
+
+    (void)check(most_writes == 1u, "not one row write per reset", reset - 1u);
+    (void)check(record_word(SIM_RECORD_ROW_WRITES) == CY_PS_BOOT_CACHE_MAX_ROW_WRITES,
+                "write budget not reached", reset - 1u);
+    check_boot(boot, CY_PS_BOOT_CACHE_WORN, true, reset - 1u);
+
+    /* Warm and cold resets validate without writing the row */
+    writes = cache_writes;
+    check_boot(sim_reset(SIM_RESET_WDT), CY_PS_BOOT_CACHE_WORN, true, reset++);
+    check_boot(sim_reset(SIM_RESET_POWER_ON), CY_PS_BOOT_CACHE_COLD, true, reset++);
+    check_boot(sim_reset(SIM_RESET_SOFT), CY_PS_BOOT_CACHE_WORN, true, reset++);
+    (void)check(cache_writes == writes, "row written after the budget", reset - 1u);
+
+    report("Cache row wear", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Maps the protected storage and the primary slot, and runs the tests.
+ *
+ * Return:
+ *   int - 0 if all checks passed, 1 otherwise
+ *
+ *******************************************************************************/
+int main(void)
+{
+    /* cy_ps_boot_cache.c reads the rows and the slot through their device addresses */
+    prot_mem = mmap((void *)(uintptr_t)PROTECTED_MEM_START, PROTECTED_MEM_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    slot_mem = mmap((void *)(uintptr_t)CY_BOOT_PRIMARY_1_START_ADDRESS, CY_BOOT_PRIMARY_1_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if ((prot_mem != (uint8_t *)(uintptr_t)PROTECTED_MEM_START) ||
+        (slot_mem != (uint8_t *)(uintptr_t)CY_BOOT_PRIMARY_1_START_ADDRESS))
+    {
+        fprintf(stderr, "Cannot map the protected storage and the primary slot\n");
+        return 2;
+    }
+
+    test_resets();
+    test_image_changes();
+    test_upgrade();
+    test_write_faults();
+    test_wear();
+
+    printf("%" PRIu32 " checks, %" PRIu32 " failed\n", checks, failures);
+
+    (void)munmap(prot_mem, PROTECTED_MEM_SIZE);
+    (void)munmap(slot_mem, CY_BOOT_PRIMARY_1_SIZE);
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,707 @@
+/******************************************************************************
+* File Name: boot_sim.c
+*
+* Description: Host harness that runs the MCUboot boot_go() of the
+*   bootloader on the simulated flash. The signed BOOT and UPGRADE HEX files
+*   of the CM4 project are programmed at their addresses, so they land in
+*   the primary and secondary slots of the flash map. Then boot_go() runs
+*   one or more times and each run reports the boot decision, the flash
+*   accesses, the bytes hashed, the signatures verified and the simulated
+*   boot time. The erase cycles of the rows (or external sectors) of each
+*   flash area are counted per run. In swap mode, --confirm marks the booted
+*   image as confirmed after each run, as the CM4 project does; otherwise the
+*   next run swaps the previous image back.
+*
+*   The simulated time adds the busy time of the flash models to the hash
+*   and signature times given by --hash-ns and --verify-us. The default
+*   values are estimates for the CM0+ at 100 MHz with the mbedTLS software
+*   crypto; calibrate them with the boot timing records of a real board
+*   (see scripts/boot_timing.py).
+*
+*   Build, with MCUBOOT the MCUboot library of the bootloader project and
+*   DEFINES the -D options of common.mk for the simulated target (see
+*   flash_map_sim.c) without -DMCUBOOT_HW_ROLLBACK_PROT, plus the upgrade
+*   mode (-DMCUBOOT_OVERWRITE_ONLY, -DMCUBOOT_DIRECT_XIP, or
+*   -DMCUBOOT_SWAP_USING_SCRATCH=1 -DMCUBOOT_SWAP_USING_STATUS=1) and
+*   -DMCUBOOT_MAX_IMG_SECTORS:
+*   gcc -o boot_sim $DEFINES
+*       -DMBEDTLS_CONFIG_FILE='"mcuboot_crypto_config.h"'
+*       -DECC256_KEY_FILE='"cypress-test-ec-p256.pub"'
+*       -Itools/flash_sim -Itools/flash_sim/host_include
+*       -Iproj_btldr_cm0p/source -Iproj_btldr_cm0p/keys
+*       -I$MCUBOOT/boot/bootutil/include -I$MCUBOOT/boot/bootutil/src
+*       -I$MCUBOOT/ext/mbedtls/include
+*       tools/flash_sim/boot_sim.c tools/flash_sim/flash_map_sim.c
+*       tools/flash_sim/int_flash_sim.c tools/flash_sim/spi_nor_sim.c
+*       $MCUBOOT/boot/cypress/MCUBootApp/keys.c $BOOTUTIL_SRC $MBEDTLS_SRC
+*       -Wl,--wrap=mbedtls_sha256_update_ret -Wl,--wrap=mbedtls_ecdsa_verify
+*   where BOOTUTIL_SRC and MBEDTLS_SRC list the C files of
+*   $MCUBOOT/boot/bootutil/src and $MCUBOOT/ext/mbedtls/library.
+*
+*   Example Usage:
+*   boot_sim primary_app_BOOT.hex primary_app_UPGRADE.hex --boots 2
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include "flash_map_sim.h"
+#include "sysflash/sysflash.h"
+#include "bootutil/image.h"
+#include "bootutil/bootutil.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/ecdsa.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Longest line of an Intel HEX file */
+#define HEX_LINE_SIZE                   (600u)
+
+/* Intel HEX record types */
+#define HEX_REC_DATA                    (0x00u)
+#define HEX_REC_EOF                     (0x01u)
+#define HEX_REC_EXT_SEGMENT_ADDR        (0x02u)
+#define HEX_REC_EXT_LINEAR_ADDR         (0x04u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Simulation settings */
+typedef struct
+{
+    int_flash_sim_cfg_t int_cfg;
+    spi_nor_sim_cfg_t ext_cfg;
+    uint32_t hash_ns_per_byte;      /* SHA-256 time per byte */
+    uint32_t verify_us;             /* ECDSA P-256 verification time */
+    uint32_t boots;                 /* Number of boot_go() runs */
+    bool confirm;                   /* Confirm the image after each run */
+} boot_sim_cfg_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static int_flash_sim_t int_dev;
+static spi_nor_sim_t ext_dev;
+static bool ext_used = false;
+
+/* Counters of the crypto operations run by MCUboot */
+static uint64_t hashed_bytes = 0u;
+static uint32_t verified_signatures = 0u;
+
+/* Erase cycles per internal row and external sector before the run */
+static uint32_t *row_cycles_before = NULL;
+static uint32_t *sector_erases_before = NULL;
+
+static boot_sim_cfg_t sim_cfg =
+{
+    .int_cfg =
+    {
+        .size = 0x100000u,
+        .row_size = 512u,
+        .row_write_us = 16000u,
+        .row_erase_us = 11000u,
+        .read_ns_per_byte = 8u,
+    },
+    .ext_cfg =
+    {
+        .size = 0x1000000u,
+        .erase_size = 0x40000u,
+        .page_size = 512u,
+        .page_program_us = 340u,
+        .sector_erase_us = 520000u,
+        .read_mbps = 200u,
+    },
+    .hash_ns_per_byte = 600u,
+    .verify_us = 300000u,
+    .boots = 1u,
+    .confirm = false,
+};
+
+static const struct option boot_sim_options[] =
+{
+    { "flash-size",   required_argument, NULL, 'f' },
+    { "row-write-us", required_argument, NULL, 'w' },
+    { "row-erase-us", required_argument, NULL, 'e' },
+    { "read-ns",      required_argument, NULL, 'r' },
+    { "ext-size",     required_argument, NULL, 'F' },
+    { "ext-erase",    required_argument, NULL, 'E' },
+    { "ext-page",     required_argument, NULL, 'P' },
+    { "hash-ns",      required_argument, NULL, 'h' },
+    { "verify-us",    required_argument, NULL, 'v' },
+    { "boots",        required_argument, NULL, 'b' },
+    { "confirm",      no_argument,       NULL, 'c' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: __wrap_mbedtls_sha256_update_ret
+ ********************************************************************************
+ * Summary:
+ *   Counts the bytes hashed by MCUboot. Linked with
+ *   -Wl,--wrap=mbedtls_sha256_update_ret.
+ *
+ *******************************************************************************/
+int __real_mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen);
+
+int __wrap_mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx, const unsigned char *input, size_t ilen)
+{
+    hashed_bytes += ilen;
+
+    return __real_mbedtls_sha256_update_ret(ctx, input, ilen);
+}
+
+/*******************************************************************************
+ * Function Name: __wrap_mbedtls_ecdsa_verify
+ ********************************************************************************
+ * Summary:
+ *   Counts the signatures verified by MCUboot. Linked with
+ *   -Wl,--wrap=mbedtls_ecdsa_verify.
+ *
+ *******************************************************************************/
+int __real_mbedtls_ecdsa_verify(mbedtls_ecp_group *grp, const unsigned char *buf, size_t blen,
+                                const mbedtls_ecp_point *Q, const mbedtls_mpi *r, const mbedtls_mpi *s);
+
+int __wrap_mbedtls_ecdsa_verify(mbedtls_ecp_group *grp, const unsigned char *buf, size_t blen,
+                                const mbedtls_ecp_point *Q, const mbedtls_mpi *r, const mbedtls_mpi *s)
+{
+    verified_signatures++;
+
+    return __real_mbedtls_ecdsa_verify(grp, buf, blen, Q, r, s);
+}
+
+/*******************************************************************************
+ * Function Name: hex_byte
+ ********************************************************************************
+ * Summary:
+ *   Decodes two hex digits.
+ *
+ * Return:
+ *   int - Byte value or -1 if the digits are invalid
+ *
+ *******************************************************************************/
+static int hex_byte(const char *text)
+{
+    char digits[3] = { text[0], text[1], '\0' };
+    char *end;
+    long value = strtol(digits, &end, 16);
+
+    return (end == &digits[2]) ? (int) value : -1;
+}
+
+/*******************************************************************************
+ * Function Name: store_byte
+ ********************************************************************************
+ * Summary:
+ *   Programs one byte of a HEX file in the simulated flash, without counting
+ *   it as a flash access.
+ *
+ * Return:
+ *   bool - false if the address is in no simulated flash
+ *
+ *******************************************************************************/
+static bool store_byte(uint32_t addr, uint8_t value)
+{
+    if ((addr >= CY_START_OF_FLASH) && ((addr - CY_START_OF_FLASH) < int_dev.cfg.size))
+    {
+        int_dev.mem[addr - CY_START_OF_FLASH] = value;
+        return true;
+    }
+
+    if (ext_used && (addr >= FLASH_MAP_SIM_EXT_BASE) && ((addr - FLASH_MAP_SIM_EXT_BASE) < ext_dev.cfg.size))
+    {
+        ext_dev.mem[addr - FLASH_MAP_SIM_EXT_BASE] = value;
+        return true;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: load_hex
+ ********************************************************************************
+ * Summary:
+ *   Programs an Intel HEX file in the simulated flash. Data outside the
+ *   simulated flash (e.g. eFuse or metadata sections) is skipped.
+ *
+ * Parameters:
+ *   path - HEX file
+ *
+ * Return:
+ *   int - 0 or -1 if the file cannot be read or is invalid
+ *
+ *******************************************************************************/
+static int load_hex(const char *path)
+{
+    char line[HEX_LINE_SIZE];
+    uint32_t base = 0u;
+    uint32_t loaded = 0u;
+    uint32_t skipped = 0u;
+    uint32_t line_num = 0u;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        uint8_t rec[(HEX_LINE_SIZE - 1u) / 2u];
+        uint32_t rec_len = 0u;
+        uint8_t checksum = 0u;
+
+        line_num++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0')
+        {
+            continue;
+        }
+
+        /* Record: count, address (2), type, data, checksum */
+        for (const char *p = &line[1]; (line[0] == ':') && (p[0] != '\0') && (p[1] != '\0'); p += 2)
+        {
+            int value = hex_byte(p);
+            if (value < 0)
+            {
+                break;
+            }
+            rec[rec_len++] = (uint8_t) value;
+            checksum += (uint8_t) value;
+        }
+
+        if ((rec_len < 5u) || (rec_len != (rec[0] + 5u)) || (checksum != 0u))
+        {
+            fprintf(stderr, "%s:%" PRIu32 ": invalid record\n", path, line_num);
+            fclose(file);
+            return -1;
+        }
+
+        uint32_t addr = base + (((uint32_t) rec[1] << 8) | rec[2]);
+
+        switch (rec[3])
+        {
+            case HEX_REC_DATA:
+                for (uint32_t i = 0u; i < rec[0]; i++)
+                {
+                    if (store_byte(addr + i, rec[4u + i]))
+                    {
+                        loaded++;
+                    }
+                    else
+                    {
+                        skipped++;
+                    }
+                }
+                break;
+
+            case HEX_REC_EXT_SEGMENT_ADDR:
+                base = (((uint32_t) rec[4] << 8) | rec[5]) << 4;
+                break;
+
+            case HEX_REC_EXT_LINEAR_ADDR:
+                base = (((uint32_t) rec[4] << 8) | rec[5]) << 16;
+                break;
+
+            default:
+                break;
+        }
+
+        if (rec[3] == HEX_REC_EOF)
+        {
+            break;
+        }
+    }
+
+    fclose(file);
+    printf("%s: %" PRIu32 " bytes programmed, %" PRIu32 " bytes outside the flash skipped\n",
+           path, loaded, skipped);
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: area_digest
+ ********************************************************************************
+ * Summary:
+ *   Computes a FNV-1a digest of a flash area to detect changes made by
+ *   boot_go().
+ *
+ *******************************************************************************/
+static uint32_t area_digest(uint8_t area_id)
+{
+    const struct flash_area *fa;
+    const uint8_t *mem;
+    uint32_t digest = 2166136261UL;
+
+    if ((flash_area_open(area_id, &fa) != 0) || ((mem = flash_map_sim_area_mem(fa)) == NULL))
+    {
+        return 0u;
+    }
+
+    for (uint32_t i = 0u; i < fa->fa_size; i++)
+    {
+        digest = (digest ^ mem[i]) * 16777619UL;
+    }
+
+    return digest;
+}
+
+/*******************************************************************************
+ * Function Name: boot_slot_name
+ ********************************************************************************
+ * Summary:
+ *   Returns the name of the slot of the first image that boot_go() selected.
+ *
+ *******************************************************************************/
+static const char *boot_slot_name(const struct boot_rsp *rsp)
+{
+    const struct flash_area *fa;
+
+    if ((flash_area_open(FLASH_AREA_IMAGE_SECONDARY(0u), &fa) == 0) &&
+        (rsp->br_image_off == fa->fa_off) && (rsp->br_flash_dev_id == fa->fa_device_id))
+    {
+        return "secondary";
+    }
+
+    return "primary";
+}
+
+/*******************************************************************************
+ * Function Name: area_name
+ ********************************************************************************
+ * Summary:
+ *   Returns the name of a flash area of the flash map.
+ *
+ *******************************************************************************/
+static const char *area_name(uint8_t area_id)
+{
+    switch (area_id)
+    {
+        case FLASH_AREA_IMG_1_PRIMARY:      return "primary 1";
+        case FLASH_AREA_IMG_1_SECONDARY:    return "secondary 1";
+        case FLASH_AREA_IMG_2_PRIMARY:      return "primary 2";
+        case FLASH_AREA_IMG_2_SECONDARY:    return "secondary 2";
+        case FLASH_AREA_IMAGE_SCRATCH:      return "scratch";
+        case FLASH_AREA_IMAGE_SWAP_STATUS:  return "swap status";
+        default:                            return "bootloader";
+    }
+}
+
+/*******************************************************************************
+ * Function Name: save_wear
+ ********************************************************************************
+ * Summary:
+ *   Saves the erase cycles of every row and sector before a run.
+ *
+ *******************************************************************************/
+static void save_wear(void)
+{
+    memcpy(row_cycles_before, int_dev.row_cycles,
+           (int_dev.cfg.size / int_dev.cfg.row_size) * sizeof(uint32_t));
+    if (ext_used)
+    {
+        memcpy(sector_erases_before, ext_dev.sector_erases,
+               (ext_dev.cfg.size / ext_dev.cfg.erase_size) * sizeof(uint32_t));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: report_wear
+ ********************************************************************************
+ * Summary:
+ *   Prints, for each flash area, how many of its rows (or external sectors)
+ *   went through an erase cycle during the run and the most cycles of one
+ *   of them. A row write erases the row, so it counts as a cycle.
+ *
+ *******************************************************************************/
+static void report_wear(void)
+{
+    bool cycled = false;
+
+    for (uint32_t i = 0u; boot_area_descs[i] != NULL; i++)
+    {
+        const struct flash_area *fa = boot_area_descs[i];
+        bool external = ((fa->fa_device_id & FLASH_DEVICE_EXTERNAL_FLAG) != 0u);
+        uint32_t unit = external ? ext_dev.cfg.erase_size : int_dev.cfg.row_size;
+        uint32_t first = (external ? (fa->fa_off - FLASH_MAP_SIM_EXT_BASE) : fa->fa_off) / unit;
+        uint32_t count = (fa->fa_size + unit - 1u) / unit;
+        uint32_t touched = 0u;
+        uint32_t max_cycles = 0u;
+
+        for (uint32_t n = first; n < (first + count); n++)
+        {
+            uint32_t cycles = external ? (ext_dev.sector_erases[n] - sector_erases_before[n])
+                                       : (int_dev.row_cycles[n] - row_cycles_before[n]);
+            if (cycles != 0u)
+            {
+                touched++;
+                max_cycles = (cycles > max_cycles) ? cycles : max_cycles;
+            }
+        }
+
+        if (touched != 0u)
+        {
+            printf("  wear:      %-11s %" PRIu32 " of %" PRIu32 " %s cycled, at most %" PRIu32 " times\n",
+                   area_name(fa->fa_id), touched, count, external ? "sectors" : "rows", max_cycles);
+            cycled = true;
+        }
+    }
+
+    if (!cycled)
+    {
+        printf("  wear:      no row or sector cycled\n");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: run_boot
+ ********************************************************************************
+ * Summary:
+ *   Runs boot_go() once and prints the report.
+ *
+ * Parameters:
+ *   boot_num - Run number, from 1
+ *
+ * Return:
+ *   int - Result of boot_go()
+ *
+ *******************************************************************************/
+static int run_boot(uint32_t boot_num)
+{
+    struct boot_rsp rsp;
+    uint32_t primary_before[MCUBOOT_IMAGE_NUMBER];
+    uint32_t secondary_before[MCUBOOT_IMAGE_NUMBER];
+
+    for (uint32_t image = 0u; image < MCUBOOT_IMAGE_NUMBER; image++)
+    {
+        primary_before[image] = area_digest(FLASH_AREA_IMAGE_PRIMARY(image));
+        secondary_before[image] = area_digest(FLASH_AREA_IMAGE_SECONDARY(image));
+    }
+
+    save_wear();
+    int_flash_sim_reset_stats(&int_dev);
+    if (ext_used)
+    {
+        spi_nor_sim_reset_stats(&ext_dev);
+    }
+    hashed_bytes = 0u;
+    verified_signatures = 0u;
+
+    memset(&rsp, 0, sizeof(rsp));
+    int rc = boot_go(&rsp);
+
+    printf("\nBoot %" PRIu32 "\n", boot_num);
+    if (rc == 0)
+    {
+        printf("  result:    boot the %s slot, offset 0x%08" PRIX32 ", version %u.%u.%u+%" PRIu32 "\n",
+               boot_slot_name(&rsp), rsp.br_image_off,
+               rsp.br_hdr->ih_ver.iv_major, rsp.br_hdr->ih_ver.iv_minor,
+               rsp.br_hdr->ih_ver.iv_revision, rsp.br_hdr->ih_ver.iv_build_num);
+    }
+    else
+    {
+        printf("  result:    no bootable image (%d)\n", rc);
+    }
+
+    for (uint32_t image = 0u; image < MCUBOOT_IMAGE_NUMBER; image++)
+    {
+        bool primary_changed = (area_digest(FLASH_AREA_IMAGE_PRIMARY(image)) != primary_before[image]);
+        bool secondary_changed = (area_digest(FLASH_AREA_IMAGE_SECONDARY(image)) != secondary_before[image]);
+        const char *decision = "slots unchanged";
+
+#ifdef MCUBOOT_SWAP_USING_STATUS
+        if (primary_changed &&
+            (area_digest(FLASH_AREA_IMAGE_PRIMARY(image)) == secondary_before[image]) &&
+            (area_digest(FLASH_AREA_IMAGE_SECONDARY(image)) == primary_before[image]))
+        {
+            decision = "swap, images of the primary and secondary slots exchanged";
+        }
+        else
+#endif
+        if (primary_changed)
+        {
+            decision = "upgrade, secondary slot copied to the primary slot";
+        }
+        else if (secondary_changed)
+        {
+            decision = "secondary slot erased, image rejected or already installed";
+        }
+
+        printf("  image %" PRIu32 ":   %s\n", image + 1u, decision);
+    }
+
+    uint64_t flash_ns = int_dev.stats.busy_ns;
+    uint64_t hash_ns = hashed_bytes * sim_cfg.hash_ns_per_byte;
+    uint64_t verify_ns = (uint64_t) verified_signatures * sim_cfg.verify_us * 1000u;
+
+    printf("  internal:  %" PRIu32 " reads, %" PRIu64 " bytes read, %" PRIu32 " row writes, %" PRIu32 " row erases\n",
+           int_dev.stats.reads, int_dev.stats.bytes_read, int_dev.stats.row_writes, int_dev.stats.row_erases);
+    if (ext_used)
+    {
+        flash_ns += ext_dev.stats.busy_ns;
+        printf("  external:  %" PRIu32 " reads, %" PRIu64 " bytes read, %" PRIu32 " page programs, %" PRIu32 " sector erases\n",
+               ext_dev.stats.reads, ext_dev.stats.bytes_read, ext_dev.stats.programs, ext_dev.stats.erases);
+    }
+    report_wear();
+    printf("  crypto:    %" PRIu64 " bytes hashed, %" PRIu32 " signatures verified\n",
+           hashed_bytes, verified_signatures);
+    printf("  time:      %.1f ms (flash %.1f, hash %.1f, signature %.1f)\n",
+           (flash_ns + hash_ns + verify_ns) / 1e6, flash_ns / 1e6, hash_ns / 1e6, verify_ns / 1e6);
+
+#ifdef MCUBOOT_SWAP_USING_STATUS
+    /* The CM4 project confirms the image once it runs, see dfu_task.c */
+    if ((rc == 0) && sim_cfg.confirm)
+    {
+        int confirm_rc = boot_set_confirmed();
+        printf("  confirm:   %s\n", (confirm_rc == 0) ? "image confirmed" : "boot_set_confirmed() failed");
+    }
+#endif
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: uses_external_flash
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a flash area of the flash map is in the external flash.
+ *
+ *******************************************************************************/
+static bool uses_external_flash(void)
+{
+    for (uint32_t i = 0u; boot_area_descs[i] != NULL; i++)
+    {
+        if ((boot_area_descs[i]->fa_device_id & FLASH_DEVICE_EXTERNAL_FLAG) != 0u)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Parses the options, programs the HEX files and runs boot_go().
+ *
+ * Return:
+ *   int - 0 if the last boot_go() run found a bootable image, 1 otherwise
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    int opt;
+    int rc = 0;
+
+    while ((opt = getopt_long(argc, argv, "", boot_sim_options, NULL)) != -1)
+    {
+        uint32_t value = (uint32_t) strtoul((optarg != NULL) ? optarg : "0", NULL, 0);
+
+        switch (opt)
+        {
+            case 'f': sim_cfg.int_cfg.size = value; break;
+            case 'w': sim_cfg.int_cfg.row_write_us = value; break;
+            case 'e': sim_cfg.int_cfg.row_erase_us = value; break;
+            case 'r': sim_cfg.int_cfg.read_ns_per_byte = value; break;
+            case 'F': sim_cfg.ext_cfg.size = value; break;
+            case 'E': sim_cfg.ext_cfg.erase_size = value; break;
+            case 'P': sim_cfg.ext_cfg.page_size = value; break;
+            case 'h': sim_cfg.hash_ns_per_byte = value; break;
+            case 'v': sim_cfg.verify_us = value; break;
+            case 'b': sim_cfg.boots = value; break;
+            case 'c': sim_cfg.confirm = true; break;
+            default:
+                fprintf(stderr, "Usage: %s [--flash-size N] [--row-write-us N] [--row-erase-us N] [--read-ns N]\n"
+                        "       [--ext-size N] [--ext-erase N] [--ext-page N] [--hash-ns N] [--verify-us N]\n"
+                        "       [--boots N] [--confirm] image.hex...\n", argv[0]);
+                return 2;
+        }
+    }
+
+    ext_used = uses_external_flash();
+
+    if ((int_flash_sim_init(&int_dev, &sim_cfg.int_cfg) != INT_FLASH_SIM_OK) ||
+        (ext_used && (spi_nor_sim_init(&ext_dev, &sim_cfg.ext_cfg) != SPI_NOR_SIM_OK)))
+    {
+        fprintf(stderr, "Invalid flash configuration\n");
+        return 2;
+    }
+
+    row_cycles_before = calloc(int_dev.cfg.size / int_dev.cfg.row_size, sizeof(uint32_t));
+    sector_erases_before = ext_used ? calloc(ext_dev.cfg.size / ext_dev.cfg.erase_size, sizeof(uint32_t)) : NULL;
+    if ((row_cycles_before == NULL) || (ext_used && (sector_erases_before == NULL)))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+
+    flash_map_sim_init(&int_dev, ext_used ? &ext_dev : NULL);
+
+    for (int i = optind; i < argc; i++)
+    {
+        if (load_hex(argv[i]) != 0)
+        {
+            return 2;
+        }
+    }
+
+    for (uint32_t boot_num = 1u; boot_num <= sim_cfg.boots; boot_num++)
+    {
+        rc = run_boot(boot_num);
+    }
+
+    int_flash_sim_free(&int_dev);
+    if (ext_used)
+    {
+        spi_nor_sim_free(&ext_dev);
+    }
+    free(row_cycles_before);
+    free(sector_erases_before);
+
+    return (rc == 0) ? 0 : 1;
+}
+
+/* [] END OF FILE */
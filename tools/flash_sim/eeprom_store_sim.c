@@ -0,0 +1,319 @@
+/******************************************************************************
+* File Name: eeprom_store_sim.c
+*
+* Description: Host benchmark of eeprom_store.c of the CM4 project. The
+*   emulated EEPROM region is mapped at its device address, so
+*   eeprom_store.c reads it directly as on the device, and
+*   Cy_Flash_WriteRow() is simulated.
+*
+*   Each update pattern writes records of a given size and number, flushes
+*   after a given number of writes, and reports the rows programmed, the
+*   writes per second the flash allows, the per-row erase counters read
+*   with eeprom_store_get_erase_count(), and the lifetime projected from the
+*   most worn row. The records are reloaded with eeprom_store_init() at the
+*   end and compared with the expected values.
+*
+*   The row write time (--row-write-us), the endurance (--endurance) and the
+*   update rate used for the lifetime in years (--per-day) are estimates;
+*   take them from the device datasheet and the application.
+*
+*   Build:
+*   gcc -o eeprom_store_sim -DCY_EM_EEPROM_BASE=0x14000000UL
+*       -DCY_EM_EEPROM_SIZE=0x8000UL
+*       -Itools/flash_sim/host_include -Iproj_cm4/source
+*       proj_cm4/source/eeprom_store.c tools/flash_sim/eeprom_store_sim.c
+*
+*   Example Usage:
+*   eeprom_store_sim --writes 1000000 --per-day 1440
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include "cy_pdl.h"
+#include "eeprom_store.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Erased value of the internal flash */
+#define SIM_ERASED_VAL                  (0x00u)
+
+#define SIM_DAYS_PER_YEAR               (365.25)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Update pattern */
+typedef struct
+{
+    const char *name;
+    uint32_t records;               /* Records updated, IDs 0 to records - 1 */
+    uint32_t size;                  /* Record size in bytes */
+    uint32_t flush_every;           /* Writes between two flushes */
+    bool random;                    /* Random record order instead of round robin */
+} sim_pattern_t;
+
+/* Simulation settings */
+typedef struct
+{
+    uint32_t writes;                /* eeprom_store_write() calls per pattern */
+    uint32_t row_write_us;          /* Row erase and program time */
+    uint32_t endurance;             /* Erase cycles of a row */
+    uint32_t per_day;               /* Writes per day for the lifetime in years */
+} sim_cfg_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t *sim_mem;
+static uint32_t row_writes;
+static uint32_t seed = 1u;
+
+/* The first pattern is the one of the DFU task: one counter, flushed after
+ * each update.
+ */
+static const sim_pattern_t patterns[] =
+{
+    { "dfu-count",  1u,  4u,  1u, false },
+    { "counters",   4u,  4u,  1u, false },
+    { "settings",   8u, 16u,  8u, true  },
+    { "full",      32u, 32u, 32u, true  },
+};
+
+static sim_cfg_t sim_cfg =
+{
+    .writes = 100000u,
+    .row_write_us = 16000u,
+    .endurance = 100000u,
+    .per_day = 1440u,
+};
+
+static const struct option eeprom_store_sim_options[] =
+{
+    { "writes",       required_argument, NULL, 'n' },
+    { "row-write-us", required_argument, NULL, 'w' },
+    { "endurance",    required_argument, NULL, 'e' },
+    { "per-day",      required_argument, NULL, 'd' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: Cy_Flash_WriteRow
+ ********************************************************************************
+ * Summary:
+ *   Simulated row write.
+ *
+ *******************************************************************************/
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    if ((rowAddr < CY_EM_EEPROM_BASE) || (rowAddr >= (CY_EM_EEPROM_BASE + CY_EM_EEPROM_SIZE)) ||
+        ((rowAddr % CY_FLASH_SIZEOF_ROW) != 0u))
+    {
+        fprintf(stderr, "Row write outside the emulated EEPROM: 0x%08" PRIX32 "\n", rowAddr);
+        exit(2);
+    }
+
+    memcpy(&sim_mem[rowAddr - CY_EM_EEPROM_BASE], data, CY_FLASH_SIZEOF_ROW);
+    row_writes++;
+
+    return CY_FLASH_DRV_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: sim_rand
+ ********************************************************************************
+ * Summary:
+ *   xorshift32 pseudo-random numbers, so that the benchmark gives the same
+ *   result on every host.
+ *
+ *******************************************************************************/
+static uint32_t sim_rand(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return seed;
+}
+
+/*******************************************************************************
+ * Function Name: run_pattern
+ ********************************************************************************
+ * Summary:
+ *   Runs one update pattern on an erased region and prints its line of the
+ *   report.
+ *
+ * Return:
+ *   bool - true if the records reloaded from flash are the expected ones
+ *
+ *******************************************************************************/
+static bool run_pattern(const sim_pattern_t *pattern)
+{
+    static uint8_t expected[EEPROM_STORE_MAX_RECORDS][EEPROM_STORE_MAX_RECORD_SIZE];
+    uint32_t max_erases = 0u;
+    uint32_t min_erases = UINT32_MAX;
+    bool ok = true;
+
+    memset(sim_mem, SIM_ERASED_VAL, CY_EM_EEPROM_SIZE);
+    memset(expected, 0, sizeof(expected));
+    row_writes = 0u;
+    seed = 1u;
+
+    (void)eeprom_store_init();
+
+    for (uint32_t n = 1u; n <= sim_cfg.writes; n++)
+    {
+        uint8_t id = (uint8_t) (pattern->random ? (sim_rand() % pattern->records) : (n % pattern->records));
+
+        /* A counter in the first bytes, so that every write changes the record */
+        memcpy(expected[id], &n, sizeof(n));
+        for (uint32_t b = sizeof(n); b < pattern->size; b++)
+        {
+            expected[id][b] = (uint8_t) (n + b);
+        }
+
+        ok = ok && (eeprom_store_write(id, expected[id], (uint8_t) pattern->size) == EEPROM_STORE_SUCCESS);
+        if ((n % pattern->flush_every) == 0u)
+        {
+            ok = ok && (eeprom_store_flush() == EEPROM_STORE_SUCCESS);
+        }
+    }
+    ok = ok && (eeprom_store_flush() == EEPROM_STORE_SUCCESS);
+
+    for (uint32_t row = 0u; row < EEPROM_STORE_ROWS; row++)
+    {
+        uint32_t erases = eeprom_store_get_erase_count(row);
+
+        max_erases = (erases > max_erases) ? erases : max_erases;
+        min_erases = (erases < min_erases) ? erases : min_erases;
+    }
+
+    /* Reload from flash and compare */
+    (void)eeprom_store_init();
+    for (uint8_t id = 0u; id < pattern->records; id++)
+    {
+        uint8_t data[EEPROM_STORE_MAX_RECORD_SIZE];
+        uint8_t length = sizeof(data);
+
+        ok = ok && (eeprom_store_read(id, data, &length) == EEPROM_STORE_SUCCESS) &&
+             (length == pattern->size) && (memcmp(data, expected[id], length) == 0);
+    }
+
+    double rows_per_write = (double) row_writes / sim_cfg.writes;
+    double writes_per_s = 1e6 / (rows_per_write * sim_cfg.row_write_us);
+    double lifetime = (max_erases != 0u) ? ((double) sim_cfg.endurance * sim_cfg.writes / max_erases) : 0.0;
+
+    printf("%-10s %3" PRIu32 " x %2" PRIu32 " B %5" PRIu32 " %10" PRIu32 " %9.4f %9.1f %7" PRIu32 " %7" PRIu32
+           " %12.3g %8.1f  %s\n",
+           pattern->name, pattern->records, pattern->size, pattern->flush_every, row_writes, rows_per_write,
+           writes_per_s, min_erases, max_erases, lifetime, lifetime / sim_cfg.per_day / SIM_DAYS_PER_YEAR,
+           ok ? "ok" : "FAILED");
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Maps the emulated EEPROM region and runs the update patterns.
+ *
+ * Return:
+ *   int - 0 if the records of all patterns were reloaded correctly
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    int opt;
+    bool ok = true;
+
+    while ((opt = getopt_long(argc, argv, "", eeprom_store_sim_options, NULL)) != -1)
+    {
+        uint32_t value = (uint32_t) strtoul((optarg != NULL) ? optarg : "0", NULL, 0);
+
+        switch (opt)
+        {
+            case 'n': sim_cfg.writes = value; break;
+            case 'w': sim_cfg.row_write_us = value; break;
+            case 'e': sim_cfg.endurance = value; break;
+            case 'd': sim_cfg.per_day = value; break;
+            default:
+                fprintf(stderr, "Usage: %s [--writes N] [--row-write-us N] [--endurance N] [--per-day N]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if ((sim_cfg.writes == 0u) || (sim_cfg.row_write_us == 0u) || (sim_cfg.per_day == 0u))
+    {
+        fprintf(stderr, "Invalid settings\n");
+        return 2;
+    }
+
+    /* eeprom_store.c reads the rows through their device addresses */
+    sim_mem = mmap((void *)(uintptr_t)CY_EM_EEPROM_BASE, CY_EM_EEPROM_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (sim_mem != (uint8_t *)(uintptr_t)CY_EM_EEPROM_BASE)
+    {
+        fprintf(stderr, "Cannot map the emulated EEPROM at 0x%08lX\n", (unsigned long)CY_EM_EEPROM_BASE);
+        return 2;
+    }
+
+    printf("%" PRIu32 " writes per pattern, %" PRIu32 " rows, row write %" PRIu32 " us, endurance %" PRIu32
+           " cycles, %" PRIu32 " writes per day\n",
+           sim_cfg.writes, (uint32_t) EEPROM_STORE_ROWS, sim_cfg.row_write_us, sim_cfg.endurance, sim_cfg.per_day);
+    printf("%-10s %-10s %5s %10s %9s %9s %7s %7s %12s %8s\n", "pattern", "records", "flush", "row writes",
+           "rows/wr", "writes/s", "min er", "max er", "life writes", "years");
+
+    for (uint32_t i = 0u; i < (sizeof(patterns) / sizeof(patterns[0])); i++)
+    {
+        ok = run_pattern(&patterns[i]) && ok;
+    }
+
+    (void)munmap(sim_mem, CY_EM_EEPROM_SIZE);
+
+    return ok ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,543 @@
+/******************************************************************************
+* File Name: flash_map_sim.c
+*
+* Description: MCUboot flash area API over the simulated flash. It
+*   replaces cy_flash_map.c and the QSPI driver of the MCUboot flash PAL when
+*   MCUboot or the CM4 DFU flash layer is built for the host. The flash
+*   areas are the boot_area_descs of the bootloader (cy_flash_map.h):
+*   internal areas are located in an int_flash_sim_t and external areas,
+*   addressed by their SMIF XIP address, in a spi_nor_sim_t. External writes
+*   are split into page programs like the PAL driver does.
+*
+*   The CY_BOOT_* and MCUBOOT_* defines must match the DEFINES set by
+*   common.mk for the simulated target. Example build of the CM4 DFU flash
+*   layer for the default target with USE_EXT_FLASH=1:
+*   gcc -DCY_BOOT_USE_EXTERNAL_FLASH -DCY_BOOT_EXTERNAL_SMIF_ID=1
+*       -DMCUBOOT_IMAGE_NUMBER=1 -DCY_START_OF_FLASH=0x10000000
+*       -DCY_BOOT_BOOTLOADER_SIZE=0x1C000
+*       -DCY_BOOT_PRIMARY_1_START_ADDRESS=0x10020000
+*       -DCY_BOOT_PRIMARY_1_SIZE=0xE0000
+*       -DCY_BOOT_SECONDARY_1_START_ADDRESS=0x18000000
+*       -DCY_BOOT_SECONDARY_1_SIZE=0xE0000
+*       -Itools/flash_sim -Itools/flash_sim/host_include
+*       -Iproj_btldr_cm0p/source -Iproj_cm4/source
+*       proj_cm4/source/dfu_flash.c tools/flash_sim/flash_map_sim.c
+*       tools/flash_sim/int_flash_sim.c tools/flash_sim/spi_nor_sim.c
+*       <test>.c
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "flash_map_sim.h"
+#include "sysflash/sysflash.h"
+#include "flash_qspi.h"
+#include "cy_flash_map.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Simulated devices */
+static int_flash_sim_t *sim_int_dev = NULL;
+static spi_nor_sim_t *sim_ext_dev = NULL;
+
+/*******************************************************************************
+ * Function Name: flash_map_sim_init
+ ********************************************************************************
+ * Summary:
+ *   Sets the devices used by the flash areas.
+ *
+ * Parameters:
+ *   int_dev - Internal flash, starting at CY_START_OF_FLASH
+ *   ext_dev - External flash, starting at FLASH_MAP_SIM_EXT_BASE. NULL if
+ *             no flash area is in the external flash.
+ *
+ *******************************************************************************/
+void flash_map_sim_init(int_flash_sim_t *int_dev, spi_nor_sim_t *ext_dev)
+{
+    sim_int_dev = int_dev;
+    sim_ext_dev = ext_dev;
+}
+
+/*******************************************************************************
+ * Function Name: flash_map_sim_is_external
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a flash area is in the external flash.
+ *
+ *******************************************************************************/
+static bool flash_map_sim_is_external(const struct flash_area *fa)
+{
+    return (fa->fa_device_id & FLASH_DEVICE_EXTERNAL_FLAG) != 0u;
+}
+
+/*******************************************************************************
+ * Function Name: flash_map_sim_check
+ ********************************************************************************
+ * Summary:
+ *   Checks that a range is inside a flash area and that the device of the
+ *   area exists.
+ *
+ *******************************************************************************/
+static int flash_map_sim_check(const struct flash_area *fa, uint32_t off, uint32_t len)
+{
+    if ((fa == NULL) || (len > fa->fa_size) || (off > (fa->fa_size - len)))
+    {
+        return -1;
+    }
+
+    if (flash_map_sim_is_external(fa) ? (sim_ext_dev == NULL) : (sim_int_dev == NULL))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: flash_map_sim_area_mem
+ ********************************************************************************
+ * Summary:
+ *   Returns the content of a flash area, e.g. to program an image before a
+ *   test without counting the accesses.
+ *
+ * Parameters:
+ *   fa - Flash area
+ *
+ * Return:
+ *   uint8_t* - First byte of the area, NULL if the device does not exist
+ *
+ *******************************************************************************/
+uint8_t *flash_map_sim_area_mem(const struct flash_area *fa)
+{
+    if (flash_map_sim_check(fa, 0u, 0u) != 0)
+    {
+        return NULL;
+    }
+
+    return flash_map_sim_is_external(fa) ? &sim_ext_dev->mem[fa->fa_off - FLASH_MAP_SIM_EXT_BASE] :
+                                           &sim_int_dev->mem[fa->fa_off];
+}
+
+/*******************************************************************************
+ * Function Name: qspi_init_sfdp
+ ********************************************************************************
+ * Summary:
+ *   Stands in for the SFDP detection of the external flash.
+ *
+ * Parameters:
+ *   smif_id - Unused
+ *
+ * Return:
+ *   cy_en_smif_status_t - CY_SMIF_SUCCESS if an external flash is simulated
+ *
+ *******************************************************************************/
+cy_en_smif_status_t qspi_init_sfdp(uint32_t smif_id)
+{
+    (void) smif_id;
+
+    return (sim_ext_dev != NULL) ? CY_SMIF_SUCCESS : CY_SMIF_BAD_PARAM;
+}
+
+/*******************************************************************************
+ * Function Name: qspi_get_erase_size
+ ********************************************************************************
+ * Summary:
+ *   Returns the sector erase size of the external flash.
+ *
+ * Return:
+ *   uint32_t - Erase size in bytes, 0 if no external flash is simulated
+ *
+ *******************************************************************************/
+uint32_t qspi_get_erase_size(void)
+{
+    return (sim_ext_dev != NULL) ? sim_ext_dev->cfg.erase_size : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_open
+ ********************************************************************************
+ * Summary:
+ *   Opens a flash area of boot_area_descs.
+ *
+ * Parameters:
+ *   id - Flash area ID
+ *   fa - Returns the flash area
+ *
+ * Return:
+ *   int - 0 or -1 if the area does not exist
+ *
+ *******************************************************************************/
+int flash_area_open(uint8_t id, const struct flash_area **fa)
+{
+    for (uint32_t i = 0u; boot_area_descs[i] != NULL; i++)
+    {
+        if (boot_area_descs[i]->fa_id == id)
+        {
+            *fa = boot_area_descs[i];
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_close
+ ********************************************************************************
+ * Summary:
+ *   Closes a flash area. Nothing to release.
+ *
+ * Parameters:
+ *   fa - Flash area
+ *
+ *******************************************************************************/
+void flash_area_close(const struct flash_area *fa)
+{
+    (void) fa;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_read
+ ********************************************************************************
+ * Summary:
+ *   Reads from a flash area.
+ *
+ * Parameters:
+ *   fa  - Flash area
+ *   off - Offset in the area
+ *   dst - Destination buffer
+ *   len - Number of bytes
+ *
+ * Return:
+ *   int - 0 or an error code
+ *
+ *******************************************************************************/
+int flash_area_read(const struct flash_area *fa, uint32_t off, void *dst, uint32_t len)
+{
+    if (flash_map_sim_check(fa, off, len) != 0)
+    {
+        return -1;
+    }
+
+    return flash_map_sim_is_external(fa) ?
+           spi_nor_sim_read(sim_ext_dev, fa->fa_off - FLASH_MAP_SIM_EXT_BASE + off, dst, len) :
+           int_flash_sim_read(sim_int_dev, fa->fa_off + off, dst, len);
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_write
+ ********************************************************************************
+ * Summary:
+ *   Writes to a flash area. External areas are programmed one page program
+ *   command per page touched.
+ *
+ * Parameters:
+ *   fa  - Flash area
+ *   off - Offset in the area
+ *   src - Data to write
+ *   len - Number of bytes
+ *
+ * Return:
+ *   int - 0 or an error code
+ *
+ *******************************************************************************/
+int flash_area_write(const struct flash_area *fa, uint32_t off, const void *src, uint32_t len)
+{
+    const uint8_t *data = src;
+    int rc = flash_map_sim_check(fa, off, len);
+
+    if ((rc == 0) && !flash_map_sim_is_external(fa))
+    {
+        return int_flash_sim_write(sim_int_dev, fa->fa_off + off, src, len);
+    }
+
+    off += fa->fa_off - FLASH_MAP_SIM_EXT_BASE;
+    while ((rc == 0) && (len != 0u))
+    {
+        uint32_t chunk = sim_ext_dev->cfg.page_size - (off % sim_ext_dev->cfg.page_size);
+        chunk = (chunk < len) ? chunk : len;
+
+        rc = spi_nor_sim_program(sim_ext_dev, off, data, chunk);
+
+        off += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_erase
+ ********************************************************************************
+ * Summary:
+ *   Erases a range of a flash area. Internal areas are erased by rows. In
+ *   external areas, every sector touched by the range is erased and the
+ *   range must start on a sector.
+ *
+ * Parameters:
+ *   fa  - Flash area
+ *   off - Offset in the area
+ *   len - Number of bytes
+ *
+ * Return:
+ *   int - 0 or an error code
+ *
+ *******************************************************************************/
+int flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
+{
+    int rc = flash_map_sim_check(fa, off, len);
+    uint32_t end;
+
+    if ((rc == 0) && !flash_map_sim_is_external(fa))
+    {
+        return int_flash_sim_erase(sim_int_dev, fa->fa_off + off, len);
+    }
+
+    off += fa->fa_off - FLASH_MAP_SIM_EXT_BASE;
+    end = off + len;
+    while ((rc == 0) && (off < end))
+    {
+        rc = spi_nor_sim_erase(sim_ext_dev, off);
+        off += sim_ext_dev->cfg.erase_size;
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_align
+ ********************************************************************************
+ * Summary:
+ *   Returns the write alignment of a flash area.
+ *
+ * Parameters:
+ *   fa - Flash area
+ *
+ * Return:
+ *   uint32_t - FLASH_MAP_SIM_WRITE_ALIGN
+ *
+ *******************************************************************************/
+uint32_t flash_area_align(const struct flash_area *fa)
+{
+    (void) fa;
+
+    return FLASH_MAP_SIM_WRITE_ALIGN;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_erased_val
+ ********************************************************************************
+ * Summary:
+ *   Returns the value of an erased byte of a flash area.
+ *
+ * Parameters:
+ *   fa - Flash area
+ *
+ * Return:
+ *   uint8_t - 0xFF in the external flash, 0x00 in the internal flash
+ *
+ *******************************************************************************/
+uint8_t flash_area_erased_val(const struct flash_area *fa)
+{
+    return flash_map_sim_is_external(fa) ? SPI_NOR_SIM_ERASED_VAL : INT_FLASH_SIM_ERASED_VAL;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_read_is_empty
+ ********************************************************************************
+ * Summary:
+ *   Reads from a flash area and checks whether the range is erased.
+ *
+ * Parameters:
+ *   fa  - Flash area
+ *   off - Offset in the area
+ *   dst - Destination buffer
+ *   len - Number of bytes
+ *
+ * Return:
+ *   int - 1 if erased, 0 if not, -1 on error
+ *
+ *******************************************************************************/
+int flash_area_read_is_empty(const struct flash_area *fa, uint32_t off, void *dst, uint32_t len)
+{
+    const uint8_t *data = dst;
+    uint8_t erased_val = flash_area_erased_val(fa);
+
+    if (flash_area_read(fa, off, dst, len) != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0u; i < len; i++)
+    {
+        if (data[i] != erased_val)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_get_sectors
+ ********************************************************************************
+ * Summary:
+ *   Lists the sectors of a flash area: rows in the internal flash and erase
+ *   sectors in the external flash.
+ *
+ * Parameters:
+ *   fa_id   - Flash area ID
+ *   count   - Size of the sectors array on input, number of sectors on
+ *             output
+ *   sectors - Returns the sectors
+ *
+ * Return:
+ *   int - 0 or -1 if the area does not exist or has too many sectors
+ *
+ *******************************************************************************/
+int flash_area_get_sectors(int fa_id, uint32_t *count, struct flash_sector *sectors)
+{
+    const struct flash_area *fa;
+    uint32_t sector_size;
+    uint32_t num_sectors = 0u;
+
+    if ((flash_area_open((uint8_t) fa_id, &fa) != 0) || (flash_map_sim_check(fa, 0u, 0u) != 0))
+    {
+        return -1;
+    }
+
+    sector_size = flash_map_sim_is_external(fa) ? sim_ext_dev->cfg.erase_size : sim_int_dev->cfg.row_size;
+
+    for (uint32_t off = 0u; off < fa->fa_size; off += sector_size)
+    {
+        if (num_sectors >= *count)
+        {
+            return -1;
+        }
+
+        sectors[num_sectors].fs_off = off;
+        sectors[num_sectors].fs_size = ((fa->fa_size - off) < sector_size) ? (fa->fa_size - off) : sector_size;
+        num_sectors++;
+    }
+
+    *count = num_sectors;
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_id_from_multi_image_slot
+ ********************************************************************************
+ * Summary:
+ *   Returns the flash area ID of a slot of an image.
+ *
+ * Parameters:
+ *   image_index - Image index, 0 for the first image
+ *   slot        - 0 primary, 1 secondary, 2 scratch
+ *
+ * Return:
+ *   int - Flash area ID or -1
+ *
+ *******************************************************************************/
+int flash_area_id_from_multi_image_slot(int image_index, int slot)
+{
+    switch (slot)
+    {
+        case 0:
+            return FLASH_AREA_IMAGE_PRIMARY((uint32_t) image_index);
+        case 1:
+            return FLASH_AREA_IMAGE_SECONDARY((uint32_t) image_index);
+        case 2:
+            return FLASH_AREA_IMAGE_SCRATCH;
+        default:
+            return -1;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_id_from_image_slot
+ ********************************************************************************
+ * Summary:
+ *   Returns the flash area ID of a slot of the first image.
+ *
+ * Parameters:
+ *   slot - 0 primary, 1 secondary, 2 scratch
+ *
+ * Return:
+ *   int - Flash area ID or -1
+ *
+ *******************************************************************************/
+int flash_area_id_from_image_slot(int slot)
+{
+    return flash_area_id_from_multi_image_slot(0, slot);
+}
+
+/*******************************************************************************
+ * Function Name: flash_area_id_to_multi_image_slot
+ ********************************************************************************
+ * Summary:
+ *   Returns the slot of an image that a flash area holds.
+ *
+ * Parameters:
+ *   image_index - Image index, 0 for the first image
+ *   area_id     - Flash area ID
+ *
+ * Return:
+ *   int - 0 primary, 1 secondary or -1
+ *
+ *******************************************************************************/
+int flash_area_id_to_multi_image_slot(int image_index, int area_id)
+{
+    if (area_id == FLASH_AREA_IMAGE_PRIMARY((uint32_t) image_index))
+    {
+        return 0;
+    }
+
+    if (area_id == FLASH_AREA_IMAGE_SECONDARY((uint32_t) image_index))
+    {
+        return 1;
+    }
+
+    return -1;
+}
+
+/* [] END OF FILE */
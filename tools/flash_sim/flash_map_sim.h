@@ -0,0 +1,75 @@
+/******************************************************************************
+* File Name: flash_map_sim.h
+*
+* Description: MCUboot flash map over the simulated internal and
+*   external flash, see flash_map_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef FLASH_MAP_SIM_H
+#define FLASH_MAP_SIM_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include "int_flash_sim.h"
+#include "spi_nor_sim.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Start of the SMIF XIP region, external flash areas are addressed from it */
+#define FLASH_MAP_SIM_EXT_BASE          (0x18000000UL)
+
+/* Write alignment reported to MCUboot, matches --align of imgtool */
+#define FLASH_MAP_SIM_WRITE_ALIGN       (8u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Flash map of the bootloader, see cy_flash_map.h */
+extern struct flash_area *boot_area_descs[];
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+void flash_map_sim_init(int_flash_sim_t *int_dev, spi_nor_sim_t *ext_dev);
+uint8_t *flash_map_sim_area_mem(const struct flash_area *fa);
+
+#endif /* FLASH_MAP_SIM_H */
+
+/* [] END OF FILE */
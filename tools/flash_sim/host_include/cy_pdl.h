@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host stand-in for the parts of the PDL used by the code
+*   built with the flash simulator.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PDL_H
+#define CY_PDL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CY_ALIGN(align)                 __attribute__((aligned(align)))
+#define CY_FLASH_SIZEOF_ROW             (512u)
+
+typedef enum
+{
+    CY_FLASH_DRV_SUCCESS = 0x00UL,
+    CY_FLASH_DRV_ERR_UNC = 0xFFUL,
+} cy_en_flashdrv_status_t;
+
+typedef enum
+{
+    CY_SMIF_SUCCESS = 0x00UL,
+    CY_SMIF_BAD_PARAM = 0x01UL,
+} cy_en_smif_status_t;
+
+/* Reset causes of Cy_SysLib_GetResetReason() */
+#define CY_SYSLIB_RESET_HWWDT           (0x0001UL)
+#define CY_SYSLIB_RESET_ACT_FAULT       (0x0002UL)
+#define CY_SYSLIB_RESET_SOFT            (0x0010UL)
+
+/* Internal flash rows, provided by the test */
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data);
+
+/* Reset cause, provided by the test */
+uint32_t Cy_SysLib_GetResetReason(void);
+
+#endif /* CY_PDL_H */
+
+/* [] END OF FILE */
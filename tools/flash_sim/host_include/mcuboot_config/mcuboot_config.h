@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name: mcuboot_config.h
+*
+* Description: Host MCUboot configuration used by the boot simulator.
+*   The signature, hash and validation options match the bootloader. The
+*   upgrade mode (MCUBOOT_OVERWRITE_ONLY, MCUBOOT_DIRECT_XIP, or
+*   MCUBOOT_SWAP_USING_SCRATCH with MCUBOOT_SWAP_USING_STATUS),
+*   MCUBOOT_IMAGE_NUMBER and MCUBOOT_MAX_IMG_SECTORS are passed on the
+*   command line with the values set by common.mk.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef MCUBOOT_CONFIG_H
+#define MCUBOOT_CONFIG_H
+
+/* ECDSA P-256 signature and SHA-256 hash computed by mbedTLS */
+#define MCUBOOT_SIGN_EC256
+#define MCUBOOT_USE_MBED_TLS
+
+/* The primary slot is validated on every boot */
+#define MCUBOOT_VALIDATE_PRIMARY_SLOT
+
+#define MCUBOOT_USE_FLASH_AREA_GET_SECTORS
+#define MCUBOOT_FIH_PROFILE_OFF
+
+/* Trailer alignment, matches --align of imgtool */
+#define MCUBOOT_BOOT_MAX_ALIGN          8
+
+#ifndef MCUBOOT_IMAGE_NUMBER
+#define MCUBOOT_IMAGE_NUMBER            1
+#endif
+
+#ifndef MCUBOOT_MAX_IMG_SECTORS
+#error "Define MCUBOOT_MAX_IMG_SECTORS as set by common.mk"
+#endif
+
+/* PSoC 6 swaps only with the status partition, as set by common.mk */
+#if defined(MCUBOOT_SWAP_USING_SCRATCH) != defined(MCUBOOT_SWAP_USING_STATUS)
+#error "Define both MCUBOOT_SWAP_USING_SCRATCH and MCUBOOT_SWAP_USING_STATUS as set by common.mk"
+#endif
+
+#define MCUBOOT_HAVE_LOGGING            1
+
+#define MCUBOOT_WATCHDOG_FEED()         do { } while (0)
+
+#endif /* MCUBOOT_CONFIG_H */
+
+/* [] END OF FILE */
@@ -1,12 +1,12 @@
 /******************************************************************************
-* File Name:   unsigned_cert_generator.c
+* File Name: mcuboot_logging.h
 *
-* Description: This file creates an unsigned_certificate.bin that consists of
-               object size, command id and unique id of the device. This binary
-               is passed as an argument to openssl to create a signed data
+* Description: Host MCUboot log output, printed to stdout.
+*
+* Related Document: See README.md
 *
 *******************************************************************************
-* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
 * an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
 *
 * This software, including source code, documentation and related
@@ -38,45 +38,33 @@
 * so agrees to indemnify Cypress against all liability.
 *******************************************************************************/
 
+#ifndef MCUBOOT_LOGGING_H
+#define MCUBOOT_LOGGING_H
+
 #include <stdio.h>
-#include <stdlib.h>
 
-#define RMA_OBJECT_SIZE    0x14
-#define RMA_CMD_ID    0x120028F0
+#define MCUBOOT_LOG_LEVEL_OFF           0
+#define MCUBOOT_LOG_LEVEL_ERROR         1
+#define MCUBOOT_LOG_LEVEL_WARNING       2
+#define MCUBOOT_LOG_LEVEL_INFO          3
+#define MCUBOOT_LOG_LEVEL_DEBUG         4
+
+#ifndef MCUBOOT_LOG_LEVEL
+#define MCUBOOT_LOG_LEVEL               MCUBOOT_LOG_LEVEL_WARNING
+#endif
+
+#define MCUBOOT_LOG_MODULE_DECLARE(domain)
+#define MCUBOOT_LOG_MODULE_REGISTER(domain)
 
-typedef struct {
-    unsigned int obj_size;
-    unsigned int cmd_id;
-    unsigned int unique_id_0;
-    unsigned int unique_id_1;
-    unsigned int unique_id_2;
-} certificate;
+#define MCUBOOT_LOG_PRINT(level, tag, _fmt, ...) \
+    do { if (MCUBOOT_LOG_LEVEL >= (level)) { printf("[" tag "] " _fmt "\n", ##__VA_ARGS__); } } while (0)
 
-certificate unsigned_cert = 
-{
-    .obj_size = RMA_OBJECT_SIZE,
-    .cmd_id = RMA_CMD_ID,
-};
+#define MCUBOOT_LOG_ERR(_fmt, ...)      MCUBOOT_LOG_PRINT(MCUBOOT_LOG_LEVEL_ERROR, "ERR", _fmt, ##__VA_ARGS__)
+#define MCUBOOT_LOG_WRN(_fmt, ...)      MCUBOOT_LOG_PRINT(MCUBOOT_LOG_LEVEL_WARNING, "WRN", _fmt, ##__VA_ARGS__)
+#define MCUBOOT_LOG_INF(_fmt, ...)      MCUBOOT_LOG_PRINT(MCUBOOT_LOG_LEVEL_INFO, "INF", _fmt, ##__VA_ARGS__)
+#define MCUBOOT_LOG_DBG(_fmt, ...)      MCUBOOT_LOG_PRINT(MCUBOOT_LOG_LEVEL_DEBUG, "DBG", _fmt, ##__VA_ARGS__)
+#define MCUBOOT_LOG_SIM(_fmt, ...)      do { } while (0)
 
-int main(int argc, char** argv) {
-    /* Create the file */
-    FILE *fh = fopen ("unsigned_certificate.bin", "wb");
-    if(argc == 0)
-    {
-        printf("Error: Unique ID not found\r\n");
-    }
-    else
-    {
-        if (fh != NULL)
-        {
-            unsigned_cert.unique_id_0 = strtol(argv[1], NULL, 0);
-            unsigned_cert.unique_id_1 = strtol(argv[2], NULL, 0);
-            unsigned_cert.unique_id_2 = strtol(argv[3], NULL, 0);
-            printf("Input param: %s .. %s .. %s\r\nUnique ID0: %08x Unique ID1: %08x Unique ID2: %08x Certificate size: %lu\r\n", argv[1], argv[2], argv[3], unsigned_cert.unique_id_0, unsigned_cert.unique_id_1, unsigned_cert.unique_id_2, sizeof (unsigned_cert) - sizeof(unsigned int));
+#endif /* MCUBOOT_LOGGING_H */
 
-            fwrite (&unsigned_cert, 1, sizeof (unsigned_cert), fh);
-            fclose (fh);
-        }
-    }
-    return 0;
-}
+/* [] END OF FILE */
@@ -0,0 +1,260 @@
+/******************************************************************************
+* File Name: int_flash_sim.c
+*
+* Description: Simulated PSoC 6 internal flash, see int_flash_sim.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "int_flash_sim.h"
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_init
+ ********************************************************************************
+ * Summary:
+ *   Creates an erased flash.
+ *
+ * Parameters:
+ *   dev - Flash to initialize
+ *   cfg - Geometry and timing. The size must be a multiple of the row size.
+ *
+ * Return:
+ *   int - INT_FLASH_SIM_OK, INT_FLASH_SIM_ERR_ALIGN or INT_FLASH_SIM_ERR_RANGE
+ *         if the memory cannot be allocated
+ *
+ *******************************************************************************/
+int int_flash_sim_init(int_flash_sim_t *dev, const int_flash_sim_cfg_t *cfg)
+{
+    memset(dev, 0, sizeof(*dev));
+
+    if ((cfg->row_size == 0u) || ((cfg->size % cfg->row_size) != 0u))
+    {
+        return INT_FLASH_SIM_ERR_ALIGN;
+    }
+
+    dev->cfg = *cfg;
+    dev->mem = malloc(cfg->size);
+    dev->row_cycles = calloc(cfg->size / cfg->row_size, sizeof(uint32_t));
+    if ((dev->mem == NULL) || (dev->row_cycles == NULL))
+    {
+        int_flash_sim_free(dev);
+        return INT_FLASH_SIM_ERR_RANGE;
+    }
+
+    memset(dev->mem, INT_FLASH_SIM_ERASED_VAL, cfg->size);
+
+    return INT_FLASH_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_free
+ ********************************************************************************
+ * Summary:
+ *   Releases the memory of a flash.
+ *
+ * Parameters:
+ *   dev - Flash
+ *
+ *******************************************************************************/
+void int_flash_sim_free(int_flash_sim_t *dev)
+{
+    free(dev->mem);
+    free(dev->row_cycles);
+    dev->mem = NULL;
+    dev->row_cycles = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_in_range
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a range is inside the flash.
+ *
+ *******************************************************************************/
+static bool int_flash_sim_in_range(const int_flash_sim_t *dev, uint32_t addr, uint32_t len)
+{
+    return (len <= dev->cfg.size) && (addr <= (dev->cfg.size - len));
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_cycle_row
+ ********************************************************************************
+ * Summary:
+ *   Counts one erase cycle of a row.
+ *
+ *******************************************************************************/
+static void int_flash_sim_cycle_row(int_flash_sim_t *dev, uint32_t row)
+{
+    dev->row_cycles[row]++;
+    if (dev->row_cycles[row] > dev->stats.max_row_cycles)
+    {
+        dev->stats.max_row_cycles = dev->row_cycles[row];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_read
+ ********************************************************************************
+ * Summary:
+ *   Reads the flash.
+ *
+ * Parameters:
+ *   dev  - Flash
+ *   addr - Offset from the start of the flash
+ *   data - Destination buffer
+ *   len  - Number of bytes
+ *
+ * Return:
+ *   int - INT_FLASH_SIM_OK or INT_FLASH_SIM_ERR_RANGE
+ *
+ *******************************************************************************/
+int int_flash_sim_read(int_flash_sim_t *dev, uint32_t addr, void *data, uint32_t len)
+{
+    if (!int_flash_sim_in_range(dev, addr, len))
+    {
+        return INT_FLASH_SIM_ERR_RANGE;
+    }
+
+    memcpy(data, &dev->mem[addr], len);
+
+    dev->stats.reads++;
+    dev->stats.bytes_read += len;
+    dev->stats.busy_ns += (uint64_t)len * dev->cfg.read_ns_per_byte;
+
+    return INT_FLASH_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_write
+ ********************************************************************************
+ * Summary:
+ *   Writes the flash. Every row touched by the range is written once, the
+ *   bytes of the row outside the range keep their value.
+ *
+ * Parameters:
+ *   dev  - Flash
+ *   addr - Offset from the start of the flash
+ *   data - Data to write
+ *   len  - Number of bytes
+ *
+ * Return:
+ *   int - INT_FLASH_SIM_OK or INT_FLASH_SIM_ERR_RANGE
+ *
+ *******************************************************************************/
+int int_flash_sim_write(int_flash_sim_t *dev, uint32_t addr, const void *data, uint32_t len)
+{
+    if (!int_flash_sim_in_range(dev, addr, len))
+    {
+        return INT_FLASH_SIM_ERR_RANGE;
+    }
+
+    memcpy(&dev->mem[addr], data, len);
+
+    if (len != 0u)
+    {
+        for (uint32_t row = addr / dev->cfg.row_size; row <= ((addr + len - 1u) / dev->cfg.row_size); row++)
+        {
+            int_flash_sim_cycle_row(dev, row);
+            dev->stats.row_writes++;
+            dev->stats.busy_ns += (uint64_t)dev->cfg.row_write_us * 1000u;
+        }
+    }
+
+    return INT_FLASH_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_erase
+ ********************************************************************************
+ * Summary:
+ *   Erases whole rows.
+ *
+ * Parameters:
+ *   dev  - Flash
+ *   addr - Offset from the start of the flash, aligned to the row size
+ *   len  - Number of bytes, a multiple of the row size
+ *
+ * Return:
+ *   int - INT_FLASH_SIM_OK, INT_FLASH_SIM_ERR_RANGE or INT_FLASH_SIM_ERR_ALIGN
+ *
+ *******************************************************************************/
+int int_flash_sim_erase(int_flash_sim_t *dev, uint32_t addr, uint32_t len)
+{
+    if (!int_flash_sim_in_range(dev, addr, len))
+    {
+        return INT_FLASH_SIM_ERR_RANGE;
+    }
+
+    if (((addr % dev->cfg.row_size) != 0u) || ((len % dev->cfg.row_size) != 0u))
+    {
+        return INT_FLASH_SIM_ERR_ALIGN;
+    }
+
+    memset(&dev->mem[addr], INT_FLASH_SIM_ERASED_VAL, len);
+
+    for (uint32_t row = addr / dev->cfg.row_size; row < ((addr + len) / dev->cfg.row_size); row++)
+    {
+        int_flash_sim_cycle_row(dev, row);
+        dev->stats.row_erases++;
+        dev->stats.busy_ns += (uint64_t)dev->cfg.row_erase_us * 1000u;
+    }
+
+    return INT_FLASH_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: int_flash_sim_reset_stats
+ ********************************************************************************
+ * Summary:
+ *   Clears the operation counters. The erase cycles per row are kept.
+ *
+ * Parameters:
+ *   dev - Flash
+ *
+ *******************************************************************************/
+void int_flash_sim_reset_stats(int_flash_sim_t *dev)
+{
+    uint32_t max_row_cycles = dev->stats.max_row_cycles;
+
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->stats.max_row_cycles = max_row_cycles;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,109 @@
+/******************************************************************************
+* File Name: int_flash_sim.h
+*
+* Description: Simulated PSoC 6 internal flash for host testing. The
+*   flash is written one row at a time: a row write erases and programs the
+*   whole row, like Cy_Flash_WriteRow(). Partial row writes read, modify and
+*   write back the row. An erased row reads as 0x00. The model counts the
+*   operations and the time the flash would be busy.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef INT_FLASH_SIM_H
+#define INT_FLASH_SIM_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Value of an erased byte */
+#define INT_FLASH_SIM_ERASED_VAL        (0x00u)
+
+/* Return codes */
+#define INT_FLASH_SIM_OK                (0)
+#define INT_FLASH_SIM_ERR_RANGE         (-1)    /* Outside the flash */
+#define INT_FLASH_SIM_ERR_ALIGN         (-2)    /* Erase not row aligned */
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Flash geometry and timing */
+typedef struct
+{
+    uint32_t size;                  /* Flash size in bytes */
+    uint32_t row_size;              /* Row size in bytes */
+    uint32_t row_write_us;          /* Row erase and program time */
+    uint32_t row_erase_us;          /* Row erase time */
+    uint32_t read_ns_per_byte;      /* Read time per byte */
+} int_flash_sim_cfg_t;
+
+/* Operation counters */
+typedef struct
+{
+    uint32_t reads;                 /* Read accesses */
+    uint32_t row_writes;            /* Rows erased and programmed */
+    uint32_t row_erases;            /* Rows erased only */
+    uint64_t bytes_read;
+    uint64_t busy_ns;               /* Time spent in reads, writes and erases */
+    uint32_t max_row_cycles;        /* Erase cycles of the most worn row */
+} int_flash_sim_stats_t;
+
+typedef struct
+{
+    int_flash_sim_cfg_t cfg;
+    int_flash_sim_stats_t stats;
+    uint8_t *mem;                   /* Flash content */
+    uint32_t *row_cycles;           /* Erase cycles per row */
+} int_flash_sim_t;
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+int int_flash_sim_init(int_flash_sim_t *dev, const int_flash_sim_cfg_t *cfg);
+void int_flash_sim_free(int_flash_sim_t *dev);
+int int_flash_sim_read(int_flash_sim_t *dev, uint32_t addr, void *data, uint32_t len);
+int int_flash_sim_write(int_flash_sim_t *dev, uint32_t addr, const void *data, uint32_t len);
+int int_flash_sim_erase(int_flash_sim_t *dev, uint32_t addr, uint32_t len);
+void int_flash_sim_reset_stats(int_flash_sim_t *dev);
+
+#endif /* INT_FLASH_SIM_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,637 @@
+/******************************************************************************
+* File Name: prot_storage_sim.c
+*
+* Description: Host harness that cuts the power of prot_storage.c of the CM0+
+*   project at each row write. The protected storage is mapped at its device
+*   address, so prot_storage.c reads it directly as on the device, and
+*   Cy_Flash_WriteRow() is simulated.
+*
+*   The power cut test runs a random workload of commits once to count the
+*   row writes. Then, for each row write and each way a write can be cut
+*   (row erased, row half programmed, row programmed but no return), it runs
+*   the workload again, cuts the power at that write, and checks that
+*   prot_storage_init() recovers the records of either the state before or
+*   the state after the interrupted commit. The workload then continues and
+*   the final records are checked once more. A failed write, which the
+*   driver reports without a reset, must leave the records of the state
+*   before the commit.
+*
+*   The corrupt chain test builds a journal whose history before the chain
+*   was lost and cuts the power while prot_storage_init() writes the
+*   recovery snapshot. The next prot_storage_init() must recover the same
+*   records.
+*
+*   Build, with the protected storage of the targets (layout.mk):
+*   gcc -o prot_storage_sim -DPROTECTED_MEM_START=0x1001C000UL
+*       -DPROTECTED_MEM_SIZE=0x4000UL
+*       -Itools/flash_sim/host_include -Iproj_cm0p/source
+*       proj_cm0p/source/prot_storage.c tools/flash_sim/prot_storage_sim.c
+*
+*   Example Usage:
+*   prot_storage_sim --commits 300 --seed 7
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include "cy_pdl.h"
+#include "prot_storage.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SIM_ROWS                        ((uint32_t) (PROTECTED_MEM_SIZE / CY_FLASH_SIZEOF_ROW))
+
+/* Journal rows of prot_storage.c, see the layout there */
+#define SIM_JOURNAL_START               (PROTECTED_MEM_START + CY_FLASH_SIZEOF_ROW)
+#define SIM_JOURNAL_ROWS                (SIM_ROWS - 4u)
+
+/* Row format of prot_storage.c, used to build damaged journals */
+#define SIM_ROW_MAGIC                   (0x50534A33UL)
+#define SIM_ROW_FLAG_COMMIT             (0x01u)
+#define SIM_ROW_HDR_SIZE                (16u)
+
+/* Erased value of the internal flash */
+#define SIM_ERASED_VAL                  (0x00u)
+
+/* Most record updates in one commit of the workload */
+#define SIM_MAX_UPDATES                 (4u)
+
+#define SIM_CRC32_POLY                  (0xEDB88320UL)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* How the power is cut at a row write */
+typedef enum
+{
+    SIM_CUT_ERASED,                 /* Row erased, nothing programmed */
+    SIM_CUT_HALF,                   /* First half of the row programmed, the rest not settled */
+    SIM_CUT_WRITTEN,                /* Row programmed, reset before the return */
+    SIM_CUT_ERROR,                  /* Write fails without a reset, row unchanged */
+    SIM_CUT_MODES
+} sim_cut_t;
+
+/* One commit of the workload */
+typedef struct
+{
+    uint32_t count;
+    prot_storage_record_t updates[SIM_MAX_UPDATES];
+    uint8_t data[SIM_MAX_UPDATES][PROT_STORAGE_MAX_RECORD_SIZE];
+} sim_commit_t;
+
+/* Expected records */
+typedef struct
+{
+    uint8_t len[PROT_STORAGE_MAX_RECORDS];
+    uint8_t data[PROT_STORAGE_MAX_RECORDS][PROT_STORAGE_MAX_RECORD_SIZE];
+} sim_records_t;
+
+/* Journal row, see prot_storage_row_t */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+    uint8_t  txn_index;
+    uint8_t  flags;
+    uint16_t payload_len;
+    uint32_t crc;
+    uint8_t  payload[CY_FLASH_SIZEOF_ROW - SIM_ROW_HDR_SIZE];
+} sim_row_t;
+
+_Static_assert(sizeof(sim_row_t) == CY_FLASH_SIZEOF_ROW, "Journal row must be one flash row");
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t *sim_mem;
+
+/* Row writes since the last wipe, and the write at which the power is cut */
+static uint32_t write_count;
+static uint32_t cut_at;
+static sim_cut_t cut_mode;
+static jmp_buf power_cut;
+
+/* Writes per row, to report the wear */
+static uint32_t row_writes[SIM_ROWS];
+
+static sim_commit_t *workload;
+static uint32_t workload_len = 200u;
+static uint32_t seed = 1u;
+
+static uint32_t checks;
+static uint32_t failures;
+
+static const char *const cut_names[SIM_CUT_MODES] =
+{
+    "row erased", "row half programmed", "row programmed", "write failed"
+};
+
+static const struct option prot_storage_sim_options[] =
+{
+    { "commits", required_argument, NULL, 'c' },
+    { "seed",    required_argument, NULL, 's' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: Cy_Flash_WriteRow
+ ********************************************************************************
+ * Summary:
+ *   Simulated row write. Cuts the power at write number cut_at by jumping
+ *   back to the test, after leaving the row as set by cut_mode.
+ *
+ *******************************************************************************/
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    uint8_t *row;
+
+    if ((rowAddr < PROTECTED_MEM_START) || (rowAddr >= (PROTECTED_MEM_START + PROTECTED_MEM_SIZE)) ||
+        ((rowAddr % CY_FLASH_SIZEOF_ROW) != 0u))
+    {
+        fprintf(stderr, "Row write outside the protected storage: 0x%08" PRIX32 "\n", rowAddr);
+        exit(2);
+    }
+
+    row = &sim_mem[rowAddr - PROTECTED_MEM_START];
+    write_count++;
+
+    if (write_count != cut_at)
+    {
+        memcpy(row, data, CY_FLASH_SIZEOF_ROW);
+        row_writes[(rowAddr - PROTECTED_MEM_START) / CY_FLASH_SIZEOF_ROW]++;
+        return CY_FLASH_DRV_SUCCESS;
+    }
+
+    switch (cut_mode)
+    {
+        case SIM_CUT_ERASED:
+            memset(row, SIM_ERASED_VAL, CY_FLASH_SIZEOF_ROW);
+            break;
+
+        case SIM_CUT_HALF:
+            /* The bits of the second half did not settle */
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW / 2u);
+            for (uint32_t i = CY_FLASH_SIZEOF_ROW / 2u; i < CY_FLASH_SIZEOF_ROW; i++)
+            {
+                row[i] = (uint8_t) ~((const uint8_t *)data)[i];
+            }
+            break;
+
+        case SIM_CUT_WRITTEN:
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW);
+            break;
+
+        default:
+            return CY_FLASH_DRV_ERR_UNC;
+    }
+
+    longjmp(power_cut, 1);
+}
+
+/*******************************************************************************
+ * Function Name: sim_rand
+ ********************************************************************************
+ * Summary:
+ *   xorshift32 pseudo-random numbers, so that a seed gives the same
+ *   workload on every host.
+ *
+ *******************************************************************************/
+static uint32_t sim_rand(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return seed;
+}
+
+/*******************************************************************************
+ * Function Name: sim_crc32
+ ********************************************************************************
+ * Summary:
+ *   CRC32 (IEEE 802.3) of prot_storage.c.
+ *
+ *******************************************************************************/
+static uint32_t sim_crc32(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    crc = ~crc;
+
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        crc ^= data[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1u) ^ (SIM_CRC32_POLY & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: make_workload
+ ********************************************************************************
+ * Summary:
+ *   Builds the random commits. About one update in eight deletes a record.
+ *
+ *******************************************************************************/
+static void make_workload(void)
+{
+    workload = calloc(workload_len, sizeof(sim_commit_t));
+    if (workload == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+
+    for (uint32_t c = 0u; c < workload_len; c++)
+    {
+        sim_commit_t *commit = &workload[c];
+
+        commit->count = 1u + (sim_rand() % SIM_MAX_UPDATES);
+        for (uint32_t i = 0u; i < commit->count; i++)
+        {
+            commit->updates[i].id = (uint8_t) (sim_rand() % PROT_STORAGE_MAX_RECORDS);
+            commit->updates[i].length = ((sim_rand() % 8u) == 0u) ? 0u :
+                                        (uint8_t) (1u + (sim_rand() % PROT_STORAGE_MAX_RECORD_SIZE));
+            commit->updates[i].data = commit->data[i];
+            for (uint32_t b = 0u; b < commit->updates[i].length; b++)
+            {
+                commit->data[i][b] = (uint8_t) sim_rand();
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: apply_commit
+ ********************************************************************************
+ * Summary:
+ *   Applies a commit to the expected records.
+ *
+ *******************************************************************************/
+static void apply_commit(sim_records_t *records, const sim_commit_t *commit)
+{
+    for (uint32_t i = 0u; i < commit->count; i++)
+    {
+        const prot_storage_record_t *update = &commit->updates[i];
+
+        records->len[update->id] = update->length;
+        memset(records->data[update->id], 0, PROT_STORAGE_MAX_RECORD_SIZE);
+        memcpy(records->data[update->id], update->data, update->length);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: read_records
+ ********************************************************************************
+ * Summary:
+ *   Reads all the records with prot_storage_read().
+ *
+ *******************************************************************************/
+static void read_records(sim_records_t *records)
+{
+    memset(records, 0, sizeof(*records));
+
+    for (uint8_t id = 0u; id < PROT_STORAGE_MAX_RECORDS; id++)
+    {
+        uint8_t length = PROT_STORAGE_MAX_RECORD_SIZE;
+
+        if (prot_storage_read(id, records->data[id], &length) == PROT_STORAGE_SUCCESS)
+        {
+            records->len[id] = length;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: check
+ ********************************************************************************
+ * Summary:
+ *   Counts a check and prints the failed ones.
+ *
+ *******************************************************************************/
+static bool check(bool ok, const char *what, uint32_t cut, sim_cut_t mode)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("  FAIL: %s, cut at row write %" PRIu32 " (%s)\n", what, cut, cut_names[mode]);
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: wipe
+ ********************************************************************************
+ * Summary:
+ *   Erases the protected storage and resets the write counters.
+ *
+ *******************************************************************************/
+static void wipe(void)
+{
+    memset(sim_mem, SIM_ERASED_VAL, PROTECTED_MEM_SIZE);
+    memset(row_writes, 0, sizeof(row_writes));
+    write_count = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: run_workload
+ ********************************************************************************
+ * Summary:
+ *   Runs the workload on an erased protected storage with the power cut at
+ *   row write cut_at (0 for none) and checks the records.
+ *
+ *******************************************************************************/
+static void run_workload(sim_cut_t mode)
+{
+    static sim_records_t expected;
+    static sim_records_t before;
+    static sim_records_t actual;
+    static uint32_t c;
+
+    wipe();
+    cut_mode = mode;
+    memset(&expected, 0, sizeof(expected));
+
+    (void)check(prot_storage_init() == PROT_STORAGE_SUCCESS, "empty journal not recovered", cut_at, mode);
+
+    for (c = 0u; c < workload_len; c++)
+    {
+        before = expected;
+        apply_commit(&expected, &workload[c]);
+
+        if (setjmp(power_cut) == 0)
+        {
+            prot_storage_status_t status = prot_storage_commit(workload[c].updates, workload[c].count);
+
+            if (status == PROT_STORAGE_SUCCESS)
+            {
+                continue;
+            }
+
+            /* The driver reported the failure, the RAM copy was reloaded */
+            read_records(&actual);
+            (void)check((status == PROT_STORAGE_ERR_FLASH) && (memcmp(&actual, &before, sizeof(actual)) == 0),
+                        "failed commit changed the records", cut_at, mode);
+            expected = before;
+            continue;
+        }
+
+        /* Power cut, restart */
+        cut_at = 0u;
+        (void)check(prot_storage_init() == PROT_STORAGE_SUCCESS, "recovery reported an error", write_count, mode);
+        read_records(&actual);
+        if (memcmp(&actual, &before, sizeof(actual)) == 0)
+        {
+            expected = before;
+        }
+        else
+        {
+            (void)check(memcmp(&actual, &expected, sizeof(actual)) == 0,
+                        "records neither before nor after the interrupted commit", write_count, mode);
+        }
+    }
+
+    /* Final state after one more restart */
+    (void)prot_storage_init();
+    read_records(&actual);
+    (void)check(memcmp(&actual, &expected, sizeof(actual)) == 0, "final records differ", cut_at, mode);
+}
+
+/*******************************************************************************
+ * Function Name: test_power_cut
+ ********************************************************************************
+ * Summary:
+ *   Cuts the power at each row write of the workload, in each mode.
+ *
+ *******************************************************************************/
+static void test_power_cut(void)
+{
+    uint32_t writes;
+    uint32_t most_worn = 0u;
+
+    cut_at = 0u;
+    run_workload(SIM_CUT_WRITTEN);
+    writes = write_count;
+
+    for (uint32_t row = 0u; row < SIM_ROWS; row++)
+    {
+        most_worn = (row_writes[row] > most_worn) ? row_writes[row] : most_worn;
+    }
+
+    printf("Power cut: %" PRIu32 " commits, %" PRIu32 " row writes, most written row %" PRIu32 " times\n",
+           workload_len, writes, most_worn);
+
+    for (sim_cut_t mode = SIM_CUT_ERASED; mode < SIM_CUT_MODES; mode++)
+    {
+        uint32_t mode_failures = failures;
+
+        for (uint32_t cut = 1u; cut <= writes; cut++)
+        {
+            cut_at = cut;
+            run_workload(mode);
+        }
+
+        printf("  %-20s %" PRIu32 " cuts, %s\n", cut_names[mode], writes,
+               (failures == mode_failures) ? "passed" : "FAILED");
+    }
+
+    cut_at = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: write_sim_row
+ ********************************************************************************
+ * Summary:
+ *   Writes a committed journal row that sets one record.
+ *
+ *******************************************************************************/
+static void write_sim_row(uint32_t seq, uint8_t id, uint8_t value)
+{
+    sim_row_t row;
+
+    memset(&row, 0, sizeof(row));
+    row.magic = SIM_ROW_MAGIC;
+    row.seq = seq;
+    row.flags = SIM_ROW_FLAG_COMMIT;
+    row.payload[0] = id;
+    row.payload[1] = 1u;
+    row.payload[2] = value;
+    row.payload_len = 3u;
+    row.crc = sim_crc32(0u, (const uint8_t *)&row, offsetof(sim_row_t, crc));
+    row.crc = sim_crc32(row.crc, row.payload, sizeof(row.payload));
+
+    memcpy(&sim_mem[SIM_JOURNAL_START - PROTECTED_MEM_START + (((seq - 1u) % SIM_JOURNAL_ROWS) * CY_FLASH_SIZEOF_ROW)],
+           &row, sizeof(row));
+}
+
+/*******************************************************************************
+ * Function Name: test_corrupt_chain
+ ********************************************************************************
+ * Summary:
+ *   Fills the whole journal with committed rows that are not preceded by a
+ *   snapshot, as left after the loss of the history. The oldest row is the
+ *   only one that sets record PROT_STORAGE_MAX_RECORDS - 1. The recovery
+ *   snapshot is cut in each mode and the next recovery must give the same
+ *   records as the first one.
+ *
+ *******************************************************************************/
+static void test_corrupt_chain(void)
+{
+    static sim_records_t first;
+    static sim_records_t actual;
+    static uint8_t journal[PROTECTED_MEM_SIZE];
+    const uint32_t first_seq = 1000u;
+    uint32_t mode_failures = failures;
+
+    wipe();
+    for (uint32_t i = 0u; i < SIM_JOURNAL_ROWS; i++)
+    {
+        uint8_t id = (i == 0u) ? (PROT_STORAGE_MAX_RECORDS - 1u) : (uint8_t) (i % (PROT_STORAGE_MAX_RECORDS - 1u));
+
+        write_sim_row(first_seq + i, id, (uint8_t) i);
+    }
+    memcpy(journal, sim_mem, sizeof(journal));
+
+    cut_at = 0u;
+    (void)check(prot_storage_init() == PROT_STORAGE_ERR_CORRUPT, "lost history not reported", 0u, SIM_CUT_WRITTEN);
+    read_records(&first);
+
+    printf("Corrupt chain: %" PRIu32 " rows without a snapshot\n", SIM_JOURNAL_ROWS);
+
+    for (sim_cut_t mode = SIM_CUT_ERASED; mode < SIM_CUT_ERROR; mode++)
+    {
+        memcpy(sim_mem, journal, sizeof(journal));
+        write_count = 0u;
+        cut_at = 1u;
+        cut_mode = mode;
+        mode_failures = failures;
+
+        if (setjmp(power_cut) == 0)
+        {
+            (void)prot_storage_init();
+            (void)check(false, "no recovery snapshot written", cut_at, mode);
+        }
+
+        cut_at = 0u;
+        (void)prot_storage_init();
+        read_records(&actual);
+        (void)check(memcmp(&actual, &first, sizeof(actual)) == 0, "second recovery lost records", 1u, mode);
+
+        /* The journal must take new commits */
+        (void)check(prot_storage_write(0u, (const uint8_t *)"new", 3u) == PROT_STORAGE_SUCCESS,
+                    "commit after the recovery failed", 1u, mode);
+        (void)prot_storage_init();
+        first.len[0] = 3u;
+        memset(first.data[0], 0, PROT_STORAGE_MAX_RECORD_SIZE);
+        memcpy(first.data[0], "new", 3u);
+        read_records(&actual);
+        (void)check(memcmp(&actual, &first, sizeof(actual)) == 0, "commit after the recovery lost", 1u, mode);
+
+        printf("  %-20s %s\n", cut_names[mode], (failures == mode_failures) ? "passed" : "FAILED");
+
+        /* Expected records of the next mode */
+        memcpy(sim_mem, journal, sizeof(journal));
+        (void)prot_storage_init();
+        read_records(&first);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Maps the protected storage and runs the tests.
+ *
+ * Return:
+ *   int - 0 if all checks passed, 1 otherwise
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "", prot_storage_sim_options, NULL)) != -1)
+    {
+        uint32_t value = (uint32_t) strtoul((optarg != NULL) ? optarg : "0", NULL, 0);
+
+        switch (opt)
+        {
+            case 'c': workload_len = value; break;
+            case 's': seed = (value != 0u) ? value : 1u; break;
+            default:
+                fprintf(stderr, "Usage: %s [--commits N] [--seed N]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    /* prot_storage.c reads the rows through their device addresses */
+    sim_mem = mmap((void *)(uintptr_t)PROTECTED_MEM_START, PROTECTED_MEM_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (sim_mem != (uint8_t *)(uintptr_t)PROTECTED_MEM_START)
+    {
+        fprintf(stderr, "Cannot map the protected storage at 0x%08lX\n", (unsigned long)PROTECTED_MEM_START);
+        return 2;
+    }
+
+    make_workload();
+    test_power_cut();
+    test_corrupt_chain();
+
+    printf("%" PRIu32 " checks, %" PRIu32 " failed\n", checks, failures);
+
+    free(workload);
+    (void)munmap(sim_mem, PROTECTED_MEM_SIZE);
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,638 @@
+/******************************************************************************
+* File Name: security_cnt_sim.c
+*
+* Description: Host harness for the security counters of the bootloader
+*   (cy_ps_security_cnt.c, MCUBOOT_HW_ROLLBACK_PROT). The protected storage
+*   and the shared SRAM are mapped at their device addresses, so
+*   cy_ps_security_cnt.c reads them directly as on the device.
+*   Cy_Flash_WriteRow() is simulated and can fail or lose power halfway
+*   through a row.
+*
+*   The tests check that:
+*   - A counter only increases, and only an increase writes the flash.
+*   - The newest record is still found after the sequence number wraps.
+*   - A reset during any write of an update leaves the previous counters
+*     or the new ones, and the next update succeeds.
+*   - Once a counter is recorded, damaged records make the bootloader
+*     refuse every image instead of reading the counters as 0.
+*   - The counters published in the shared SRAM let the DFU of the CM4
+*     project refuse an older image from its header, as dfu_user.c does.
+*
+*   Build, with the protected storage and the shared SRAM of the targets
+*   (layout.mk):
+*   gcc -o security_cnt_sim -DPROTECTED_MEM_START=0x1001C000UL
+*       -DPROTECTED_MEM_SIZE=0x4000UL -DSHARED_SRAM_START=0x08030000UL
+*       -DBOOT_SHARED_SRAM_SIZE=0x800 -DMCUBOOT_IMAGE_NUMBER=2
+*       -Itools/flash_sim/security_cnt_include -Itools/flash_sim/host_include
+*       -Iproj_btldr_cm0p/source proj_btldr_cm0p/source/cy_ps_security_cnt.c
+*       tools/flash_sim/security_cnt_sim.c
+*
+*   Example Usage:
+*   security_cnt_sim
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include "cy_pdl.h"
+#include "bootutil/security_cnt.h"
+#include "cy_ps_security_cnt.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Counter record, see security_cnt_record_t */
+#define SIM_RECORD_MAGIC                (0x31434E53UL)
+#define SIM_RECORD_SEQ                  (4u)
+#define SIM_RECORD_COUNTERS             (8u)
+#define SIM_RECORD_CRC                  (CY_FLASH_SIZEOF_ROW - 4u)
+
+/* Erased value of the internal flash */
+#define SIM_ERASED_VAL                  (0x00u)
+
+/* Size of the mapped shared SRAM */
+#define SIM_SHARED_SIZE                 (0x1000u)
+
+/* Result of sim_update() when the power was lost during the update */
+#define SIM_POWER_LOST                  (1)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* How a write of a counter row ends */
+typedef enum
+{
+    SIM_WRITE_OK,                   /* Row written */
+    SIM_WRITE_ERROR,                /* Write fails without a reset, row unchanged */
+    SIM_WRITE_TORN                  /* Power lost, first half of the row written */
+} sim_write_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t *prot_mem;
+static uint8_t *shared_mem;
+
+/* The write number fail_write (from 1) of the next update ends as fail_mode */
+static uint32_t fail_write = 0u;
+static sim_write_t fail_mode = SIM_WRITE_OK;
+static uint32_t update_writes;
+static jmp_buf power_cut;
+
+static uint32_t row_writes;
+static uint32_t checks;
+static uint32_t failures;
+
+/*******************************************************************************
+ * Function Name: Cy_Flash_WriteRow
+ ********************************************************************************
+ * Summary:
+ *   Simulated row write of the protected storage. The write set by
+ *   fail_write ends as set by fail_mode.
+ *
+ *******************************************************************************/
+cy_en_flashdrv_status_t Cy_Flash_WriteRow(uint32_t rowAddr, const uint32_t *data)
+{
+    sim_write_t mode = SIM_WRITE_OK;
+    uint8_t *row;
+
+    if ((rowAddr < PROTECTED_MEM_START) || (rowAddr >= (PROTECTED_MEM_START + PROTECTED_MEM_SIZE)) ||
+        ((rowAddr % CY_FLASH_SIZEOF_ROW) != 0u))
+    {
+        fprintf(stderr, "Row write outside the protected storage: 0x%08" PRIX32 "\n", rowAddr);
+        exit(2);
+    }
+
+    row = &prot_mem[rowAddr - PROTECTED_MEM_START];
+    row_writes++;
+    update_writes++;
+    if (update_writes == fail_write)
+    {
+        mode = fail_mode;
+    }
+
+    switch (mode)
+    {
+        case SIM_WRITE_ERROR:
+            return CY_FLASH_DRV_ERR_UNC;
+
+        case SIM_WRITE_TORN:
+            memset(row, SIM_ERASED_VAL, CY_FLASH_SIZEOF_ROW);
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW / 2u);
+            longjmp(power_cut, 1);
+
+        default:
+            memcpy(row, data, CY_FLASH_SIZEOF_ROW);
+            return CY_FLASH_DRV_SUCCESS;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_crc32
+ ********************************************************************************
+ * Summary:
+ *   CRC32 (IEEE 802.3) of a buffer, to build records in the test.
+ *
+ *******************************************************************************/
+static uint32_t sim_crc32(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0u; i < size; i++)
+    {
+        crc ^= data[i];
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1u) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+ * Function Name: row_mem
+ ********************************************************************************
+ * Summary:
+ *   Returns one of the two counter rows in the protected storage.
+ *
+ *******************************************************************************/
+static uint8_t *row_mem(uint32_t row)
+{
+    return &prot_mem[CY_PS_SECURITY_CNT_ADDR - PROTECTED_MEM_START + (row * CY_FLASH_SIZEOF_ROW)];
+}
+
+/*******************************************************************************
+ * Function Name: row_word
+ ********************************************************************************
+ * Summary:
+ *   Reads a word of a counter row.
+ *
+ *******************************************************************************/
+static uint32_t row_word(uint32_t row, uint32_t offset)
+{
+    uint32_t value;
+
+    memcpy(&value, &row_mem(row)[offset], sizeof(value));
+
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: put_record
+ ********************************************************************************
+ * Summary:
+ *   Writes an intact record to a counter row, as a former update would have.
+ *
+ *******************************************************************************/
+static void put_record(uint32_t row, uint32_t seq, uint32_t counter0, uint32_t counter1)
+{
+    uint8_t *mem = row_mem(row);
+    uint32_t words[4] = { SIM_RECORD_MAGIC, seq, counter0, counter1 };
+    uint32_t crc;
+
+    memset(mem, SIM_ERASED_VAL, CY_FLASH_SIZEOF_ROW);
+    memcpy(mem, words, sizeof(words));
+    crc = sim_crc32(mem, SIM_RECORD_CRC);
+    memcpy(&mem[SIM_RECORD_CRC], &crc, sizeof(crc));
+}
+
+/*******************************************************************************
+ * Function Name: sim_update
+ ********************************************************************************
+ * Summary:
+ *   Runs boot_nv_security_counter_update() as MCUboot does before it boots
+ *   an image.
+ *
+ * Return:
+ *   int - Result of the update, or SIM_POWER_LOST if the power was lost
+ *
+ *******************************************************************************/
+static int sim_update(uint32_t image_id, uint32_t counter)
+{
+    update_writes = 0u;
+
+    if (setjmp(power_cut) != 0)
+    {
+        fail_write = 0u;
+        return SIM_POWER_LOST;
+    }
+
+    int rc = (int)boot_nv_security_counter_update(image_id, counter);
+    fail_write = 0u;
+
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: sim_get
+ ********************************************************************************
+ * Summary:
+ *   Reads a counter as MCUboot does to check an image.
+ *
+ * Return:
+ *   bool - false if the bootloader refuses every image
+ *
+ *******************************************************************************/
+static bool sim_get(uint32_t image_id, uint32_t *counter)
+{
+    fih_int value = FIH_FAILURE;
+
+    if (boot_nv_security_counter_get(image_id, &value) != FIH_SUCCESS)
+    {
+        return false;
+    }
+
+    *counter = (uint32_t)fih_int_decode(value);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: dfu_accepts
+ ********************************************************************************
+ * Summary:
+ *   Early check of the DFU in the CM4 project (security_cnt_min() and
+ *   check_image_header() in dfu_user.c): the security counter derived from
+ *   the version in the image header must not be lower than the published
+ *   counter of the image.
+ *
+ *******************************************************************************/
+static bool dfu_accepts(uint32_t image_id, uint8_t major, uint8_t minor, uint16_t revision)
+{
+    const cy_stc_ps_boot_security_cnt_t *security_cnt = &CY_PS_BOOT_SHARED->security_cnt;
+    uint32_t min = 0u;
+
+    if ((security_cnt->magic == CY_PS_BOOT_SECURITY_CNT_MAGIC) && (image_id < security_cnt->count))
+    {
+        min = security_cnt->counters[image_id];
+    }
+
+    return CY_PS_SECURITY_CNT_FROM_VERSION(major, minor, revision) >= min;
+}
+
+/*******************************************************************************
+ * Function Name: check
+ ********************************************************************************
+ * Summary:
+ *   Counts a check and prints the failed ones.
+ *
+ *******************************************************************************/
+static bool check(bool ok, const char *what, uint32_t step)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("  FAIL: %s, step %" PRIu32 "\n", what, step);
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: check_counter
+ ********************************************************************************
+ * Summary:
+ *   Checks the counter that MCUboot reads for an image.
+ *
+ *******************************************************************************/
+static void check_counter(uint32_t image_id, uint32_t expected, uint32_t step)
+{
+    uint32_t counter = 0u;
+    char what[80];
+
+    if (check(sim_get(image_id, &counter), "counters refused", step))
+    {
+        (void)snprintf(what, sizeof(what), "image %" PRIu32 " counter %" PRIu32 " instead of %" PRIu32,
+                       image_id, counter, expected);
+        (void)check(counter == expected, what, step);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: start
+ ********************************************************************************
+ * Summary:
+ *   Erases the protected storage and the shared SRAM.
+ *
+ *******************************************************************************/
+static void start(void)
+{
+    memset(prot_mem, SIM_ERASED_VAL, PROTECTED_MEM_SIZE);
+    memset(shared_mem, 0, SIM_SHARED_SIZE);
+    fail_write = 0u;
+    fail_mode = SIM_WRITE_OK;
+    row_writes = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: report
+ ********************************************************************************
+ * Summary:
+ *   Prints the outcome of a test.
+ *
+ *******************************************************************************/
+static void report(const char *name, uint32_t first_failure)
+{
+    printf("%-28s %s\n", name, (failures == first_failure) ? "passed" : "FAILED");
+}
+
+/*******************************************************************************
+ * Function Name: test_updates
+ ********************************************************************************
+ * Summary:
+ *   A counter only increases, each image has its own counter, and the flash
+ *   is written only when a counter increases. The first update also writes
+ *   the record with all counters at 0.
+ *
+ *******************************************************************************/
+static void test_updates(void)
+{
+    const uint32_t first_failure = failures;
+
+    start();
+    check_counter(0u, 0u, 1u);
+    check_counter(1u, 0u, 1u);
+    (void)check(boot_nv_security_counter_init() == FIH_SUCCESS, "init failed", 1u);
+
+    (void)check((sim_update(0u, 0u) == 0) && (row_writes == 0u), "counter 0 written", 2u);
+
+    (void)check((sim_update(0u, 5u) == 0) && (row_writes == 2u), "first update not written to both rows", 3u);
+    (void)check((row_word(1u, SIM_RECORD_SEQ) == 0u) && (row_word(1u, SIM_RECORD_COUNTERS) == 0u),
+                "row 1 does not hold the counters at 0", 3u);
+    check_counter(0u, 5u, 3u);
+    check_counter(1u, 0u, 3u);
+
+    (void)check((sim_update(0u, 3u) == 0) && (row_writes == 2u), "lower counter written", 4u);
+    (void)check((sim_update(0u, 5u) == 0) && (row_writes == 2u), "same counter written", 5u);
+    check_counter(0u, 5u, 5u);
+
+    (void)check((sim_update(1u, 7u) == 0) && (row_writes == 3u), "update not written to one row", 6u);
+    check_counter(0u, 5u, 6u);
+    check_counter(1u, 7u, 6u);
+
+    (void)check(sim_update(MCUBOOT_IMAGE_NUMBER, 9u) == -1, "unknown image updated", 7u);
+    (void)check(!sim_get(MCUBOOT_IMAGE_NUMBER, &(uint32_t){ 0u }), "unknown image read", 7u);
+
+    report("Counter updates", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_wrap
+ ********************************************************************************
+ * Summary:
+ *   Updates across the wrap of the sequence number keep finding the newest
+ *   record and alternate between the rows.
+ *
+ *******************************************************************************/
+static void test_wrap(void)
+{
+    const uint32_t first_failure = failures;
+    uint32_t seq = 0xFFFFFFFDUL;
+
+    start();
+    put_record(0u, seq, 10u, 1u);
+    put_record(1u, seq + 1u, 11u, 1u);
+    seq++;
+    check_counter(0u, 11u, 0u);
+
+    for (uint32_t step = 1u; step <= 6u; step++)
+    {
+        uint32_t row = (step % 2u == 1u) ? 0u : 1u;
+
+        seq++;
+        (void)check(sim_update(0u, 11u + step) == 0, "update failed", step);
+        (void)check(row_word(row, SIM_RECORD_SEQ) == seq, "older row not written", step);
+        check_counter(0u, 11u + step, step);
+        check_counter(1u, 1u, step);
+    }
+    (void)check(seq == 4u, "sequence number did not wrap", 6u);
+
+    report("Sequence number wrap", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_power_loss
+ ********************************************************************************
+ * Summary:
+ *   The power is lost or the write fails during each write of an update.
+ *   The counter is then the previous or the new one, never lower, and the
+ *   next update succeeds.
+ *
+ *******************************************************************************/
+static void test_power_loss(void)
+{
+    const uint32_t first_failure = failures;
+    uint32_t step = 1u;
+
+    /* First update: the record with the counters at 0, then the counter */
+    for (uint32_t write = 1u; write <= 2u; write++)
+    {
+        start();
+        fail_write = write;
+        fail_mode = SIM_WRITE_TORN;
+        (void)check(sim_update(0u, 5u) == SIM_POWER_LOST, "no power loss", step);
+        check_counter(0u, 0u, step);
+        (void)check(sim_update(0u, 5u) == 0, "update after the power loss failed", step);
+        check_counter(0u, 5u, step);
+        step++;
+    }
+
+    /* Later updates, writing either row */
+    for (uint32_t row = 0u; row < 2u; row++)
+    {
+        start();
+        put_record(row, 7u, 5u, 2u);
+        put_record(1u - row, 6u, 4u, 2u);
+
+        fail_write = 1u;
+        fail_mode = SIM_WRITE_TORN;
+        (void)check(sim_update(0u, 6u) == SIM_POWER_LOST, "no power loss", step);
+        check_counter(0u, 5u, step);
+        check_counter(1u, 2u, step);
+
+        fail_write = 1u;
+        fail_mode = SIM_WRITE_ERROR;
+        (void)check(sim_update(0u, 6u) == -1, "failed write reported as done", step);
+        check_counter(0u, 5u, step);
+
+        (void)check(sim_update(0u, 6u) == 0, "update after the failures failed", step);
+        check_counter(0u, 6u, step);
+        check_counter(1u, 2u, step);
+        step++;
+    }
+
+    /* Failed write of the first update */
+    start();
+    fail_write = 1u;
+    fail_mode = SIM_WRITE_ERROR;
+    (void)check(sim_update(0u, 5u) == -1, "failed write reported as done", step);
+    check_counter(0u, 0u, step);
+
+    report("Power loss during an update", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_damaged
+ ********************************************************************************
+ * Summary:
+ *   Once a counter is recorded, damaged records refuse every image and are
+ *   not overwritten. Damage to the newest record only falls back to the
+ *   previous one.
+ *
+ *******************************************************************************/
+static void test_damaged(void)
+{
+    const uint32_t first_failure = failures;
+    uint32_t counter;
+
+    /* Both rows damaged */
+    start();
+    (void)sim_update(0u, 5u);
+    (void)sim_update(1u, 3u);
+    row_mem(0u)[SIM_RECORD_COUNTERS] ^= 0x01u;
+    row_mem(1u)[SIM_RECORD_SEQ] ^= 0x80u;
+    row_writes = 0u;
+    (void)check(!sim_get(0u, &counter) && !sim_get(1u, &counter), "damaged counters read", 1u);
+    (void)check((sim_update(0u, 6u) == -1) && (row_writes == 0u), "damaged counters overwritten", 1u);
+
+    /* Only the record of the first update left, then damaged */
+    start();
+    put_record(0u, 1u, 5u, 0u);
+    row_mem(0u)[SIM_RECORD_CRC] ^= 0x01u;
+    (void)check(!sim_get(0u, &counter), "damaged first record read", 2u);
+
+    /* Newest record damaged */
+    start();
+    (void)sim_update(0u, 5u);
+    (void)sim_update(0u, 6u);
+    row_mem(1u)[SIM_RECORD_COUNTERS] ^= 0x01u;
+    check_counter(0u, 5u, 3u);
+
+    /* Erased protected storage, as when the device is provisioned */
+    start();
+    (void)sim_update(0u, 5u);
+    memset(prot_mem, SIM_ERASED_VAL, PROTECTED_MEM_SIZE);
+    check_counter(0u, 0u, 4u);
+
+    report("Damaged records", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: test_early_reject
+ ********************************************************************************
+ * Summary:
+ *   The counters published in the shared SRAM let the DFU refuse an older
+ *   image from its header. With damaged records, every image is refused.
+ *
+ *******************************************************************************/
+static void test_early_reject(void)
+{
+    const uint32_t first_failure = failures;
+
+    /* Nothing published: the DFU leaves the check to the bootloader */
+    start();
+    (void)check(dfu_accepts(0u, 0u, 0u, 0u), "image refused without published counters", 1u);
+
+    (void)sim_update(0u, CY_PS_SECURITY_CNT_FROM_VERSION(1u, 2u, 0u));
+    (void)sim_update(1u, CY_PS_SECURITY_CNT_FROM_VERSION(2u, 0u, 3u));
+    cy_ps_security_cnt_publish();
+
+    (void)check(dfu_accepts(0u, 1u, 2u, 0u), "same version refused", 2u);
+    (void)check(dfu_accepts(0u, 1u, 3u, 0u), "newer version refused", 2u);
+    (void)check(!dfu_accepts(0u, 1u, 1u, 999u), "older version accepted", 2u);
+    (void)check(!dfu_accepts(0u, 0u, 255u, 65535u), "older major version accepted", 2u);
+    (void)check(dfu_accepts(1u, 2u, 0u, 3u), "same version of image 2 refused", 3u);
+    (void)check(!dfu_accepts(1u, 2u, 0u, 2u), "older revision of image 2 accepted", 3u);
+    (void)check(!dfu_accepts(1u, 1u, 2u, 0u), "counter of image 1 used for image 2", 3u);
+
+    row_mem(0u)[SIM_RECORD_COUNTERS] ^= 0x01u;
+    row_mem(1u)[SIM_RECORD_COUNTERS] ^= 0x01u;
+    cy_ps_security_cnt_publish();
+    (void)check(!dfu_accepts(0u, 255u, 0u, 0u) && !dfu_accepts(1u, 255u, 0u, 0u),
+                "image accepted with damaged counters", 4u);
+
+    report("DFU early reject", first_failure);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ *   Maps the protected storage and the shared SRAM and runs the tests.
+ *
+ * Return:
+ *   int - 0 if all the checks passed, 1 otherwise
+ *
+ *******************************************************************************/
+int main(void)
+{
+    /* cy_ps_security_cnt.c reads the rows and writes the shared data through their device addresses */
+    prot_mem = mmap((void *)(uintptr_t)PROTECTED_MEM_START, PROTECTED_MEM_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    shared_mem = mmap((void *)(uintptr_t)SHARED_SRAM_START, SIM_SHARED_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if ((prot_mem != (uint8_t *)(uintptr_t)PROTECTED_MEM_START) ||
+        (shared_mem != (uint8_t *)(uintptr_t)SHARED_SRAM_START))
+    {
+        fprintf(stderr, "Cannot map the protected storage and the shared SRAM\n");
+        return 2;
+    }
+
+    test_updates();
+    test_wrap();
+    test_power_loss();
+    test_damaged();
+    test_early_reject();
+
+    printf("%" PRIu32 " checks, %" PRIu32 " failed\n", checks, failures);
+
+    (void)munmap(prot_mem, PROTECTED_MEM_SIZE);
+    (void)munmap(shared_mem, SIM_SHARED_SIZE);
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,267 @@
+/******************************************************************************
+* File Name: spi_nor_sim.c
+*
+* Description: Simulated SPI NOR flash, see spi_nor_sim.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "spi_nor_sim.h"
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_init
+ ********************************************************************************
+ * Summary:
+ *   Creates an erased device.
+ *
+ * Parameters:
+ *   dev - Device to initialize
+ *   cfg - Geometry and timing. The size must be a multiple of the erase size
+ *         and the erase size a multiple of the page size.
+ *
+ * Return:
+ *   int - SPI_NOR_SIM_OK, SPI_NOR_SIM_ERR_ALIGN or SPI_NOR_SIM_ERR_RANGE
+ *         if the memory cannot be allocated
+ *
+ *******************************************************************************/
+int spi_nor_sim_init(spi_nor_sim_t *dev, const spi_nor_sim_cfg_t *cfg)
+{
+    memset(dev, 0, sizeof(*dev));
+
+    if ((cfg->page_size == 0u) || (cfg->erase_size % cfg->page_size != 0u) ||
+        (cfg->erase_size == 0u) || (cfg->size % cfg->erase_size != 0u))
+    {
+        return SPI_NOR_SIM_ERR_ALIGN;
+    }
+
+    dev->cfg = *cfg;
+    dev->mem = malloc(cfg->size);
+    dev->sector_erases = calloc(cfg->size / cfg->erase_size, sizeof(uint32_t));
+    if ((dev->mem == NULL) || (dev->sector_erases == NULL))
+    {
+        spi_nor_sim_free(dev);
+        return SPI_NOR_SIM_ERR_RANGE;
+    }
+
+    memset(dev->mem, SPI_NOR_SIM_ERASED_VAL, cfg->size);
+
+    return SPI_NOR_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_free
+ ********************************************************************************
+ * Summary:
+ *   Releases the memory of a device.
+ *
+ * Parameters:
+ *   dev - Device
+ *
+ *******************************************************************************/
+void spi_nor_sim_free(spi_nor_sim_t *dev)
+{
+    free(dev->mem);
+    free(dev->sector_erases);
+    dev->mem = NULL;
+    dev->sector_erases = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_in_range
+ ********************************************************************************
+ * Summary:
+ *   Checks whether a range is inside the device.
+ *
+ *******************************************************************************/
+static bool spi_nor_sim_in_range(const spi_nor_sim_t *dev, uint32_t addr, uint32_t len)
+{
+    return (len <= dev->cfg.size) && (addr <= (dev->cfg.size - len));
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_read
+ ********************************************************************************
+ * Summary:
+ *   Reads the device. A read command can cover any range.
+ *
+ * Parameters:
+ *   dev  - Device
+ *   addr - Device address
+ *   data - Destination buffer
+ *   len  - Number of bytes
+ *
+ * Return:
+ *   int - SPI_NOR_SIM_OK or SPI_NOR_SIM_ERR_RANGE
+ *
+ *******************************************************************************/
+int spi_nor_sim_read(spi_nor_sim_t *dev, uint32_t addr, void *data, uint32_t len)
+{
+    if (!spi_nor_sim_in_range(dev, addr, len))
+    {
+        return SPI_NOR_SIM_ERR_RANGE;
+    }
+
+    memcpy(data, &dev->mem[addr], len);
+
+    dev->stats.reads++;
+    dev->stats.bytes_read += len;
+    if (dev->cfg.read_mbps != 0u)
+    {
+        dev->stats.busy_ns += ((uint64_t)len * 8000u) / dev->cfg.read_mbps;
+    }
+
+    return SPI_NOR_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_program
+ ********************************************************************************
+ * Summary:
+ *   Executes one page program command. The range must be inside one page and
+ *   the data must not set bits that are cleared in the flash, i.e. the bytes
+ *   must be erased or programmed with compatible values. The flash is not
+ *   changed when the command is rejected.
+ *
+ * Parameters:
+ *   dev  - Device
+ *   addr - Device address
+ *   data - Data to program
+ *   len  - Number of bytes
+ *
+ * Return:
+ *   int - SPI_NOR_SIM_OK, SPI_NOR_SIM_ERR_RANGE, SPI_NOR_SIM_ERR_PAGE or
+ *         SPI_NOR_SIM_ERR_NOT_ERASED
+ *
+ *******************************************************************************/
+int spi_nor_sim_program(spi_nor_sim_t *dev, uint32_t addr, const void *data, uint32_t len)
+{
+    const uint8_t *src = data;
+
+    if (!spi_nor_sim_in_range(dev, addr, len))
+    {
+        return SPI_NOR_SIM_ERR_RANGE;
+    }
+
+    if ((len == 0u) || ((addr / dev->cfg.page_size) != ((addr + len - 1u) / dev->cfg.page_size)))
+    {
+        return SPI_NOR_SIM_ERR_PAGE;
+    }
+
+    for (uint32_t i = 0u; i < len; i++)
+    {
+        if ((dev->mem[addr + i] & src[i]) != src[i])
+        {
+            return SPI_NOR_SIM_ERR_NOT_ERASED;
+        }
+    }
+
+    for (uint32_t i = 0u; i < len; i++)
+    {
+        dev->mem[addr + i] &= src[i];
+    }
+
+    dev->stats.programs++;
+    dev->stats.bytes_programmed += len;
+    dev->stats.busy_ns += (uint64_t)dev->cfg.page_program_us * 1000u;
+
+    return SPI_NOR_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_erase
+ ********************************************************************************
+ * Summary:
+ *   Executes one sector erase command.
+ *
+ * Parameters:
+ *   dev  - Device
+ *   addr - Device address of the sector, aligned to the erase size
+ *
+ * Return:
+ *   int - SPI_NOR_SIM_OK, SPI_NOR_SIM_ERR_RANGE or SPI_NOR_SIM_ERR_ALIGN
+ *
+ *******************************************************************************/
+int spi_nor_sim_erase(spi_nor_sim_t *dev, uint32_t addr)
+{
+    uint32_t sector = addr / dev->cfg.erase_size;
+
+    if (!spi_nor_sim_in_range(dev, addr, dev->cfg.erase_size))
+    {
+        return SPI_NOR_SIM_ERR_RANGE;
+    }
+
+    if ((addr % dev->cfg.erase_size) != 0u)
+    {
+        return SPI_NOR_SIM_ERR_ALIGN;
+    }
+
+    memset(&dev->mem[addr], SPI_NOR_SIM_ERASED_VAL, dev->cfg.erase_size);
+
+    dev->sector_erases[sector]++;
+    if (dev->sector_erases[sector] > dev->stats.max_sector_erases)
+    {
+        dev->stats.max_sector_erases = dev->sector_erases[sector];
+    }
+
+    dev->stats.erases++;
+    dev->stats.busy_ns += (uint64_t)dev->cfg.sector_erase_us * 1000u;
+
+    return SPI_NOR_SIM_OK;
+}
+
+/*******************************************************************************
+ * Function Name: spi_nor_sim_reset_stats
+ ********************************************************************************
+ * Summary:
+ *   Clears the operation counters. The erase count per sector is kept.
+ *
+ * Parameters:
+ *   dev - Device
+ *
+ *******************************************************************************/
+void spi_nor_sim_reset_stats(spi_nor_sim_t *dev)
+{
+    uint32_t max_sector_erases = dev->stats.max_sector_erases;
+
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->stats.max_sector_erases = max_sector_erases;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name: spi_nor_sim.h
+*
+* Description: Simulated SPI NOR flash for host testing of the code that
+*   writes the secondary slot in the external flash. The model keeps the
+*   flash content in RAM and enforces the NOR rules: a program can only
+*   clear bits and cannot cross a page, an erase sets a whole sector to
+*   0xFF. It also counts the operations and the time the device would be
+*   busy.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SPI_NOR_SIM_H
+#define SPI_NOR_SIM_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Value of an erased byte */
+#define SPI_NOR_SIM_ERASED_VAL          (0xFFu)
+
+/* Return codes */
+#define SPI_NOR_SIM_OK                  (0)
+#define SPI_NOR_SIM_ERR_RANGE           (-1)    /* Outside the device */
+#define SPI_NOR_SIM_ERR_ALIGN           (-2)    /* Erase not sector aligned */
+#define SPI_NOR_SIM_ERR_PAGE            (-3)    /* Program crosses a page */
+#define SPI_NOR_SIM_ERR_NOT_ERASED      (-4)    /* Program sets a cleared bit */
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Device geometry and timing, similar to the values read from SFDP */
+typedef struct
+{
+    uint32_t size;                  /* Device size in bytes */
+    uint32_t erase_size;            /* Sector erase size in bytes */
+    uint32_t page_size;             /* Page program size in bytes */
+    uint32_t page_program_us;       /* Page program time */
+    uint32_t sector_erase_us;       /* Sector erase time */
+    uint32_t read_mbps;             /* Read throughput in Mbit/s */
+} spi_nor_sim_cfg_t;
+
+/* Operation counters */
+typedef struct
+{
+    uint32_t reads;                 /* Read commands */
+    uint32_t programs;              /* Page program commands */
+    uint32_t erases;                /* Sector erase commands */
+    uint64_t bytes_read;
+    uint64_t bytes_programmed;
+    uint64_t busy_ns;               /* Time spent in reads, programs and erases */
+    uint32_t max_sector_erases;     /* Erase count of the most worn sector */
+} spi_nor_sim_stats_t;
+
+typedef struct
+{
+    spi_nor_sim_cfg_t cfg;
+    spi_nor_sim_stats_t stats;
+    uint8_t *mem;                   /* Flash content */
+    uint32_t *sector_erases;        /* Erase count per sector */
+} spi_nor_sim_t;
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+int spi_nor_sim_init(spi_nor_sim_t *dev, const spi_nor_sim_cfg_t *cfg);
+void spi_nor_sim_free(spi_nor_sim_t *dev);
+int spi_nor_sim_read(spi_nor_sim_t *dev, uint32_t addr, void *data, uint32_t len);
+int spi_nor_sim_program(spi_nor_sim_t *dev, uint32_t addr, const void *data, uint32_t len);
+int spi_nor_sim_erase(spi_nor_sim_t *dev, uint32_t addr);
+void spi_nor_sim_reset_stats(spi_nor_sim_t *dev);
+
+#endif /* SPI_NOR_SIM_H */
+
+/* [] END OF FILE */
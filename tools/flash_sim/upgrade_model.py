@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import math
+import sys
+
+# This script computes the flash operations, the erase cycles per row and the
+# time of the first boot after an update for each upgrade mode, with the flash
+# and crypto timings of boot_sim.c. It follows the copy sequences of MCUboot
+# v1.8.1-cypress and is meant for comparing the modes when the MCUboot library
+# needed by boot_sim is not available; boot_sim gives the exact counts.
+# Example Usage:
+# upgrade_model.py
+# upgrade_model.py --image-size 0x40000 --scratch-size 0x18000
+# upgrade_model.py --image-size 0xE0000 --modes swap
+# upgrade_model.py --modes overwrite direct-xip
+
+# Status writes per swap besides the three per scratch-sized chunk: swap
+# size, swap info and magic before the swap, copy done and the secondary
+# magic after it
+SWAP_TRAILER_WRITES = 5
+
+# struct image_header
+IMAGE_HEADER_SIZE = 32
+
+# Copies of each swap status row, the writes alternate between them
+BOOT_SWAP_STATUS_MULT = 2
+
+MODES = ["overwrite", "swap", "direct-xip"]
+
+
+class Cost:
+    """Flash and crypto operations of one boot"""
+
+    def __init__(self, cfg):
+        self.cfg = cfg
+        self.bytes_read = 0
+        self.bytes_hashed = 0
+        self.signatures = 0
+        self.row_writes = 0
+        self.row_erases = 0
+        # Area name to the erase cycles of each row, by row index
+        self.cycles = dict()
+
+    def validate(self, size):
+        """Reads and hashes an image and verifies its signature"""
+        self.bytes_read += size
+        self.bytes_hashed += size
+        self.signatures += 1
+
+    def copy(self, dst_area, dst_offset, size):
+        """Erases the rows of dst_area, then writes them row by row with data read from another area"""
+        first, count = self.rows(dst_offset, size)
+        self.bytes_read += size
+        self.row_erases += count
+        self.row_writes += count
+        # The erase and the row write both cycle the row
+        self.cycle(dst_area, first, count, 2)
+
+    def erase(self, area, offset, size):
+        first, count = self.rows(offset, size)
+        self.row_erases += count
+        self.cycle(area, first, count, 1)
+
+    def status_write(self, count):
+        """Row writes to the swap status partition, alternating between the copies of a row"""
+        self.row_writes += count
+        for i in range(count):
+            self.cycle("swap status", i % BOOT_SWAP_STATUS_MULT, 1, 1)
+
+    def rows(self, offset, size):
+        row_size = self.cfg.row_size
+        first = offset // row_size
+        return first, math.ceil((offset + size) / row_size) - first
+
+    def cycle(self, area, first, count, cycles):
+        rows = self.cycles.setdefault(area, dict())
+        for row in range(first, first + count):
+            rows[row] = rows.get(row, 0) + cycles
+
+    def wear(self):
+        """Area name to (rows cycled, most cycles of one row)"""
+        return {area: (len(rows), max(rows.values())) for area, rows in self.cycles.items()}
+
+    def time_ms(self):
+        """Flash, hash and signature time in ms"""
+        cfg = self.cfg
+        flash = (self.bytes_read * cfg.read_ns / 1e6 + self.row_writes * cfg.row_write_us / 1e3 +
+                 self.row_erases * cfg.row_erase_us / 1e3)
+        return flash, self.bytes_hashed * cfg.hash_ns / 1e6, self.signatures * cfg.verify_us / 1e3
+
+
+def overwrite_boot(cfg):
+    """First boot after an update in overwrite-only mode"""
+    cost = Cost(cfg)
+    cost.validate(cfg.image_size)
+    cost.copy("primary", 0, cfg.image_size)
+    # The header and trailer rows of the secondary slot are erased
+    cost.erase("secondary", 0, cfg.row_size)
+    cost.erase("secondary", cfg.slot_size - cfg.row_size, cfg.row_size)
+    cost.validate(cfg.image_size)
+    return cost
+
+
+def swap_boot(cfg, revert=False):
+    """First boot after an update, or the revert boot, in swap mode"""
+    cost = Cost(cfg)
+    if not revert:
+        cost.validate(cfg.image_size)
+
+    # Each chunk of the image is copied secondary to scratch, primary to
+    # secondary, then scratch to primary, with a status write after each step
+    chunks = 0
+    for offset in range(0, cfg.image_size, cfg.scratch_size):
+        size = min(cfg.scratch_size, cfg.image_size - offset)
+        cost.copy("scratch", 0, size)
+        cost.copy("secondary", offset, size)
+        cost.copy("primary", offset, size)
+        chunks += 1
+    cost.status_write(3 * chunks + SWAP_TRAILER_WRITES)
+
+    cost.validate(cfg.image_size)
+    return cost
+
+
+def direct_xip_boot(cfg):
+    """First boot after an update in direct-XIP mode"""
+    cost = Cost(cfg)
+    # The headers of both slots are read, then only the image with the
+    # highest version is validated and booted where it is
+    cost.bytes_read += 2 * IMAGE_HEADER_SIZE
+    cost.validate(cfg.image_size)
+    return cost
+
+
+def later_boot(cfg):
+    """Boot with no pending update, the same in every mode"""
+    cost = Cost(cfg)
+    cost.validate(cfg.image_size)
+    return cost
+
+
+def boots(cfg):
+    """Boots to report, as (label, cost) pairs"""
+    result = list()
+    if "overwrite" in cfg.modes:
+        result.append(("overwrite", overwrite_boot(cfg)))
+    if "swap" in cfg.modes:
+        result.append(("swap", swap_boot(cfg)))
+        result.append(("swap revert", swap_boot(cfg, revert=True)))
+    if "direct-xip" in cfg.modes:
+        result.append(("direct-xip", direct_xip_boot(cfg)))
+    result.append(("later boots", later_boot(cfg)))
+    return result
+
+
+def print_boots(cfg):
+    print(f"Image 0x{cfg.image_size:X} bytes, scratch 0x{cfg.scratch_size:X} bytes, {cfg.row_size}-byte rows")
+    print(f"  {'Mode':<12} {'Time (ms)':>10} {'Flash':>9} {'Hash':>7} {'Sign.':>7} "
+          f"{'Writes':>7} {'Erases':>7}  Erase cycles per row (rows)")
+    for label, cost in boots(cfg):
+        flash, hash_time, verify = cost.time_ms()
+        wear = ", ".join(f"{area} {most} ({rows})" for area, (rows, most) in cost.wear().items()) or "none"
+        print(f"  {label:<12} {flash + hash_time + verify:>10.0f} {flash:>9.0f} {hash_time:>7.0f} {verify:>7.0f} "
+              f"{cost.row_writes:>7} {cost.row_erases:>7}  {wear}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the flash work of the MCUboot upgrade modes")
+    parser.add_argument("--image-size", type=lambda x: int(x, 0), default=0x40000,
+                        help="Image size with the header and TLVs (default 0x40000)")
+    parser.add_argument("--slot-size", type=lambda x: int(x, 0), default=0xE0000,
+                        help="MCUBOOT_SLOT_SIZE (default 0xE0000)")
+    parser.add_argument("--scratch-size", type=lambda x: int(x, 0), default=0x18000,
+                        help="MCUBOOT_SCRATCH_SIZE (default 0x18000)")
+    parser.add_argument("--row-size", type=int, default=512)
+    parser.add_argument("--row-write-us", type=int, default=16000)
+    parser.add_argument("--row-erase-us", type=int, default=11000)
+    parser.add_argument("--read-ns", type=int, default=8, help="Flash read time per byte")
+    parser.add_argument("--hash-ns", type=int, default=600, help="SHA-256 time per byte")
+    parser.add_argument("--verify-us", type=int, default=300000, help="ECDSA P-256 verification time")
+    parser.add_argument("--modes", nargs="+", choices=MODES, default=MODES)
+
+    cfg = parser.parse_args()
+    if not 0 < cfg.image_size <= cfg.slot_size or cfg.scratch_size < cfg.row_size:
+        sys.exit("The image must fit in the slot and the scratch area must hold at least one row")
+    print_boots(cfg)
+
+
+if __name__ == "__main__":
+    main()
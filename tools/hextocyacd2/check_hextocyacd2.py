@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2022 Cypress Semiconductor Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+# This script checks the native HEX to CYACD2 converter (hextocyacd2.c)
+# against proj_btldr_cm0p/scripts/hextocyacd2.py, which needs the intelhex
+# package of proj_btldr_cm0p/scripts/requirements.txt.
+# The "test" command converts generated HEX files with both and compares the
+# CYACD2 files byte by byte: aligned and unaligned segments, gaps inside and
+# across rows, shuffled and lower-case records, extended segment addresses,
+# the application info options, other row sizes, and sparse files.
+# The "bench" command times both on an UPGRADE-like image: code and data at
+# the start of the slot, the rest padded with the erased value.
+# Example Usage:
+# check_hextocyacd2.py test --tool ./hextocyacd2
+# check_hextocyacd2.py bench --tool ./hextocyacd2 --size 0xE0000 --runs 5
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_TOOL = os.path.join(SCRIPT_DIR, "hextocyacd2")
+DEFAULT_SCRIPT = os.path.join(SCRIPT_DIR, "..", "..", "proj_btldr_cm0p", "scripts", "hextocyacd2.py")
+
+SLOT_ADDR = 0x10100000
+BASE_OPTIONS = ["-row=512", "-chk=sum", "-id=0x1020304"]
+
+
+def hex_record(address, rec_type, data):
+    """Formats one Intel HEX record
+
+    Args:
+        address: 16-bit address field
+        rec_type: Record type
+        data: Record data
+
+    Returns:
+        str: The record
+    """
+    record = bytes([len(data), (address >> 8) & 0xFF, address & 0xFF, rec_type]) + data
+    return f":{(record + bytes([-sum(record) & 0xFF])).hex().upper()}"
+
+
+def hex_lines(segments, rng=None, segment_records=False):
+    """Formats segments as Intel HEX records of 16 bytes
+
+    Args:
+        segments: List of (address, data)
+        rng: Shuffles the records when set
+        segment_records: Uses extended segment address records (type 02)
+                         instead of extended linear address records (type 04)
+
+    Returns:
+        list: The records, each data record preceded by its address record
+    """
+    pairs = list()
+    for start, data in segments:
+        for offset in range(0, len(data), 16):
+            address = start + offset
+            if segment_records:
+                base = address & ~0xFFFF
+                pairs.append([hex_record(0, 2, (base >> 4).to_bytes(2, 'big')),
+                              hex_record(address - base, 0, data[offset:offset + 16])])
+            else:
+                pairs.append([hex_record(0, 4, (address >> 16).to_bytes(2, 'big')),
+                              hex_record(address & 0xFFFF, 0, data[offset:offset + 16])])
+    if rng is not None:
+        rng.shuffle(pairs)
+    return [line for pair in pairs for line in pair] + [hex_record(0, 5, SLOT_ADDR.to_bytes(4, 'big')),
+                                                        hex_record(0, 1, b"")]
+
+
+def write_hex(path, lines, lower=False):
+    with open(path, "w", encoding="ascii", newline="\r\n") as hex_f:
+        for line in lines:
+            hex_f.write(f"{line.lower() if lower else line}\n")
+
+
+def test_cases(rng):
+    """HEX files and options to compare
+
+    Args:
+        rng: Random generator of the data
+
+    Returns:
+        list: (name, HEX records, lower case, converter options)
+    """
+    def data(size, erased_rows=()):
+        block = bytearray(rng.randbytes(size))
+        for offset, length in erased_rows:
+            block[offset:offset + length] = bytes(length)
+        return bytes(block)
+
+    image = [(SLOT_ADDR, data(0x6000, [(0x1000, 0x1400), (0x4E00, 0x1200)]))]
+    gaps = [(SLOT_ADDR + 0x10, data(1000)), (SLOT_ADDR + 0x500, data(300)),
+            (SLOT_ADDR + 0x2000, data(5000)), (SLOT_ADDR + 0x8004, data(17))]
+
+    return [
+        ("aligned", hex_lines([(SLOT_ADDR, data(0x10000))]), False, []),
+        ("unaligned ends", hex_lines([(SLOT_ADDR + 0x31, data(0x2345))]), False, []),
+        ("gaps", hex_lines(gaps), False, []),
+        ("shuffled lower case", hex_lines(gaps, rng), True, []),
+        ("segment records", hex_lines([(0x000F01F0, data(0x9000))], segment_records=True), False, []),
+        ("application info", hex_lines(gaps), False, ["-addr=0x10100000", "-size=0x40000", "-chk=crc", "-ver=2"]),
+        ("row 256", hex_lines(gaps), False, ["-row=256"]),
+        ("row 4096", hex_lines(gaps), False, ["-row=4096"]),
+        ("sparse", hex_lines(image + [(SLOT_ADDR + 0x9000, bytes(0x3000))]), False, ["-erased=0"]),
+        ("sparse gaps", hex_lines(gaps), False, ["-erased=0"]),
+        ("sparse 0xFF", hex_lines([(SLOT_ADDR, data(0x800) + bytes([0xFF]) * 0x1800 + data(0x200))]), False,
+         ["-erased=0xFF"]),
+    ]
+
+
+def convert(command, hex_path, out_path, options):
+    """Runs a converter
+
+    Args:
+        command: Converter command line, without the options and files
+        hex_path: Input HEX file
+        out_path: Output CYACD2 file
+        options: Options, the later ones replace the earlier ones
+
+    Returns:
+        float: Run time in seconds
+    """
+    start = time.perf_counter()
+    result = subprocess.run(command + options + [hex_path, out_path], capture_output=True, text=True)
+    elapsed = time.perf_counter() - start
+    if result.returncode != 0:
+        raise RuntimeError(f"{' '.join(command)} failed:\n{result.stderr}")
+    return elapsed
+
+
+def merge_options(options):
+    """Keeps the last value of each option"""
+    merged = dict()
+    for option in BASE_OPTIONS + options:
+        merged[option.split("=", 1)[0]] = option
+    return list(merged.values())
+
+
+def first_difference(path_a, path_b):
+    """Line number and lines of the first difference of two files, or None"""
+    with open(path_a, encoding="ascii") as file_a, open(path_b, encoding="ascii") as file_b:
+        lines_a = file_a.read().splitlines()
+        lines_b = file_b.read().splitlines()
+    for number, (line_a, line_b) in enumerate(zip(lines_a, lines_b), 1):
+        if line_a != line_b:
+            return number, line_a[:72], line_b[:72]
+    if len(lines_a) != len(lines_b):
+        return min(len(lines_a), len(lines_b)) + 1, f"{len(lines_a)} lines", f"{len(lines_b)} lines"
+    return None
+
+
+def test(args):
+    script = [sys.executable, args.script]
+    cases = test_cases(random.Random(args.seed))
+    failed = 0
+    with tempfile.TemporaryDirectory() as work_dir:
+        for name, lines, lower, options in cases:
+            hex_path = os.path.join(work_dir, "image.hex")
+            py_path = os.path.join(work_dir, "script.cyacd2")
+            native_path = os.path.join(work_dir, "native.cyacd2")
+            write_hex(hex_path, lines, lower)
+            options = merge_options(options)
+            convert(script, hex_path, py_path, options)
+            convert([args.tool], hex_path, native_path, options)
+
+            difference = first_difference(py_path, native_path)
+            if difference is None:
+                print(f"{name:<28} passed")
+            else:
+                failed += 1
+                print(f"{name:<28} FAILED at line {difference[0]}:\n  script {difference[1]}\n"
+                      f"  native {difference[2]}")
+    print(f"{len(cases)} cases, {failed} differ")
+    return 1 if failed else 0
+
+
+def bench(args):
+    rng = random.Random(args.seed)
+    used = min(args.used, args.size)
+    segments = [(SLOT_ADDR, rng.randbytes(used) + bytes(args.size - used))]
+    script = [sys.executable, args.script]
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        hex_path = os.path.join(work_dir, "image.hex")
+        out_path = os.path.join(work_dir, "image.cyacd2")
+        write_hex(hex_path, hex_lines(segments))
+        hex_size = os.path.getsize(hex_path)
+        print(f"Image 0x{args.size:X} bytes, 0x{used:X} bytes used, HEX file {hex_size} bytes, "
+              f"best of {args.runs} runs")
+        print(f"  {'Converter':<10} {'Options':<10} {'Time (ms)':>10} {'HEX MB/s':>9}")
+
+        for label, sparse in (("full", []), ("sparse", ["-erased=0"])):
+            times = dict()
+            for converter, command in (("script", script), ("native", [args.tool])):
+                if converter == "script" and args.native_only:
+                    continue
+                best = min(convert(command, hex_path, out_path, merge_options(sparse)) for _ in range(args.runs))
+                times[converter] = best
+                print(f"  {converter:<10} {label:<10} {best * 1e3:>10.1f} {hex_size / best / 1e6:>9.1f}")
+            if len(times) == 2:
+                print(f"  {'':<10} {label:<10} native is {times['script'] / times['native']:.0f} times faster")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the native HEX to CYACD2 converter with hextocyacd2.py")
+    parser.add_argument("--tool", default=DEFAULT_TOOL, help="Native converter (default tools/hextocyacd2/hextocyacd2)")
+    parser.add_argument("--script", default=DEFAULT_SCRIPT, help="hextocyacd2.py")
+    parser.add_argument("--seed", type=int, default=1, help="Seed of the generated data")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    subparsers.add_parser("test", help="Compare the CYACD2 files of both converters")
+
+    bench_parser = subparsers.add_parser("bench", help="Time both converters")
+    bench_parser.add_argument("--size", type=lambda x: int(x, 0), default=0xE0000,
+                              help="Image size, the slot size by default (0xE0000)")
+    bench_parser.add_argument("--used", type=lambda x: int(x, 0), default=0x40000,
+                              help="Bytes of code and data, the rest is erased (default 0x40000)")
+    bench_parser.add_argument("--runs", type=int, default=3)
+    bench_parser.add_argument("--native-only", action="store_true", help="Do not run hextocyacd2.py")
+
+    args = parser.parse_args()
+    try:
+        sys.exit(test(args) if args.command == "test" else bench(args))
+    except RuntimeError as error:
+        sys.exit(str(error))
+
+
+if __name__ == "__main__":
+    main()
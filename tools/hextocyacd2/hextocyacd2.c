@@ -0,0 +1,921 @@
+/******************************************************************************
+* File Name: hextocyacd2.c
+*
+* Description: Native version of proj_btldr_cm0p/scripts/hextocyacd2.py,
+*   used by the CM4 project post-build when DFU_HEX2CYACD_TOOL is set. It
+*   takes the same options and writes the same CYACD2 file: the header, the
+*   application info and one row per flash row of the HEX data, with the
+*   rows between two HEX segments filled with zeros.
+*
+*   The HEX file is memory-mapped. A first pass checks the records and
+*   indexes the data records; a second pass decodes them in address order
+*   and writes each row as soon as it is complete, so only one row is held
+*   in memory. The hex digits are decoded and encoded through lookup tables.
+*
+*   With -erased, the rows that hold only the erased value are left out and
+*   their ranges are written ahead of the image rows, as the script does.
+*   The rows are then produced twice: once to collect the ranges, once to
+*   write the file.
+*
+*   Build:
+*   gcc -O2 -o hextocyacd2 tools/hextocyacd2/hextocyacd2.c
+*
+*   Example Usage:
+*   hextocyacd2 -row=512 -chk=sum -id=0x1020304 -size=0x10000 -erased=0 input.hex output.cyacd2
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Intel HEX record types */
+#define HEX_REC_DATA                    (0x00u)
+#define HEX_REC_EOF                     (0x01u)
+#define HEX_REC_EXT_SEGMENT_ADDR        (0x02u)
+#define HEX_REC_EXT_LINEAR_ADDR         (0x04u)
+
+/* Marks an invalid character in hex_digit_value */
+#define HEX_DIGIT_INVALID               (0xFFu)
+
+/* Application ID written in the header, APPID_DEFAULT of the script */
+#define CYACD2_APP_ID                   (1u)
+
+/* Largest row size accepted */
+#define CYACD2_ROW_SIZE_MAX             (0x10000u)
+
+/* Erase range rows, must match dfu_user.h */
+#define ERASE_RANGE_ADDR                (0x60010000UL)
+#define ERASE_RANGE_ROWS                (16u)
+#define ERASE_RANGE_MAGIC               (0x31535245UL)
+
+/* Size of the output buffer */
+#define OUT_BUF_SIZE                    (256u * 1024u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Data record of the HEX file */
+typedef struct
+{
+    uint32_t addr;                  /* Address of the first byte */
+    uint32_t len;                   /* Number of data bytes */
+    const char *data;               /* Hex digits of the data in the file */
+} hex_rec_t;
+
+/* Conversion settings, the options of hextocyacd2.py */
+typedef struct
+{
+    uint32_t row_size;
+    uint32_t product_id;
+    uint32_t checksum_type;         /* 0: sum, 1: crc */
+    uint32_t file_version;
+    uint32_t start_addr;            /* 0: application info from the HEX data */
+    uint32_t app_size;
+    bool sparse;                    /* Leave out the erased rows */
+    uint8_t erased_value;
+} cyacd2_cfg_t;
+
+/* Range of rows left out of a sparse file */
+typedef struct
+{
+    uint32_t addr;
+    uint32_t len;
+} erase_range_t;
+
+/* Buffered output file */
+typedef struct
+{
+    FILE *file;
+    char buf[OUT_BUF_SIZE];
+    size_t used;
+    bool failed;
+} out_file_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static cyacd2_cfg_t cfg =
+{
+    .row_size = 0u,
+    .product_id = 0u,
+    .checksum_type = 0u,
+    .file_version = 1u,
+    .start_addr = 0u,
+    .app_size = 0u,
+    .sparse = false,
+    .erased_value = 0u,
+};
+
+/* Data records sorted by address */
+static hex_rec_t *recs = NULL;
+static size_t rec_count = 0u;
+
+/* Row being assembled */
+static uint8_t *row_buf = NULL;
+
+/* Ranges of the erased rows, and whether the rows are produced to collect
+ * them instead of being written
+ */
+static erase_range_t *ranges = NULL;
+static size_t range_count = 0u;
+static size_t range_max = 0u;
+static bool collect_ranges = false;
+
+static out_file_t out;
+
+/* Value of an ASCII hex digit, or HEX_DIGIT_INVALID */
+static uint8_t hex_digit_value[256];
+
+/* Two upper-case hex digits of each byte value */
+static char hex_pair[256][2];
+
+static const struct option hextocyacd2_options[] =
+{
+    { "row",            required_argument, NULL, 'r' },
+    { "fileRowSize",    required_argument, NULL, 'r' },
+    { "id",             required_argument, NULL, 'i' },
+    { "productID",      required_argument, NULL, 'i' },
+    { "chk",            required_argument, NULL, 'c' },
+    { "packetChecksum", required_argument, NULL, 'c' },
+    { "ver",            required_argument, NULL, 'v' },
+    { "fileVersion",    required_argument, NULL, 'v' },
+    { "addr",           required_argument, NULL, 'a' },
+    { "startAddress",   required_argument, NULL, 'a' },
+    { "size",           required_argument, NULL, 's' },
+    { "applicationSize", required_argument, NULL, 's' },
+    { "erased",         required_argument, NULL, 'e' },
+    { "erasedValue",    required_argument, NULL, 'e' },
+    { NULL, 0, NULL, 0 }
+};
+
+/*******************************************************************************
+ * Function Name: init_hex_tables
+ ********************************************************************************
+ * Summary:
+ *   Fills the hex digit decoding and encoding tables.
+ *
+ *******************************************************************************/
+static void init_hex_tables(void)
+{
+    static const char digits[] = "0123456789ABCDEF";
+
+    memset(hex_digit_value, HEX_DIGIT_INVALID, sizeof(hex_digit_value));
+    for (uint32_t i = 0u; i < 16u; i++)
+    {
+        hex_digit_value[(uint8_t) digits[i]] = (uint8_t) i;
+        hex_digit_value[(uint8_t) "0123456789abcdef"[i]] = (uint8_t) i;
+    }
+
+    for (uint32_t i = 0u; i < 256u; i++)
+    {
+        hex_pair[i][0] = digits[i >> 4];
+        hex_pair[i][1] = digits[i & 0x0Fu];
+    }
+}
+
+/*******************************************************************************
+ * Function Name: hex_byte
+ ********************************************************************************
+ * Summary:
+ *   Decodes two hex digits.
+ *
+ * Return:
+ *   int - Byte value or -1 if the digits are invalid
+ *
+ *******************************************************************************/
+static inline int hex_byte(const char *text)
+{
+    uint8_t high = hex_digit_value[(uint8_t) text[0]];
+    uint8_t low = hex_digit_value[(uint8_t) text[1]];
+
+    return ((high | low) > 0x0Fu) ? -1 : (int) ((high << 4) | low);
+}
+
+/*******************************************************************************
+ * Function Name: out_write
+ ********************************************************************************
+ * Summary:
+ *   Appends text to the output file.
+ *
+ *******************************************************************************/
+static void out_write(const char *text, size_t len)
+{
+    if ((out.used + len) > sizeof(out.buf))
+    {
+        if (fwrite(out.buf, 1u, out.used, out.file) != out.used)
+        {
+            out.failed = true;
+        }
+        out.used = 0u;
+    }
+
+    memcpy(&out.buf[out.used], text, len);
+    out.used += len;
+}
+
+/*******************************************************************************
+ * Function Name: out_flush
+ ********************************************************************************
+ * Summary:
+ *   Writes the buffered output to the file.
+ *
+ * Return:
+ *   bool - false if a write failed
+ *
+ *******************************************************************************/
+static bool out_flush(void)
+{
+    if (fwrite(out.buf, 1u, out.used, out.file) != out.used)
+    {
+        out.failed = true;
+    }
+    out.used = 0u;
+
+    return !out.failed && (fflush(out.file) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: out_hex32_le
+ ********************************************************************************
+ * Summary:
+ *   Writes a 32-bit value as 8 hex digits, least significant byte first, as
+ *   change_endian_in_str() of the script does.
+ *
+ *******************************************************************************/
+static void out_hex32_le(uint32_t value)
+{
+    char text[8];
+
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        memcpy(&text[i * 2u], hex_pair[(value >> (i * 8u)) & 0xFFu], 2u);
+    }
+    out_write(text, sizeof(text));
+}
+
+/*******************************************************************************
+ * Function Name: out_row
+ ********************************************************************************
+ * Summary:
+ *   Writes one CYACD2 row: ':', the address and the data of the row.
+ *
+ * Parameters:
+ *   addr - Row address
+ *   data - Row data, or NULL for a row of zeros
+ *
+ *******************************************************************************/
+static void out_row(uint32_t addr, const uint8_t *data)
+{
+    char text[64];
+    uint32_t done = 0u;
+
+    out_write(":", 1u);
+    out_hex32_le(addr);
+
+    while (done < cfg.row_size)
+    {
+        uint32_t count = cfg.row_size - done;
+
+        if (count > (sizeof(text) / 2u))
+        {
+            count = sizeof(text) / 2u;
+        }
+
+        for (uint32_t i = 0u; i < count; i++)
+        {
+            memcpy(&text[i * 2u], hex_pair[(data != NULL) ? data[done + i] : 0u], 2u);
+        }
+        out_write(text, count * 2u);
+        done += count;
+    }
+
+    out_write("\n", 1u);
+}
+
+/*******************************************************************************
+ * Function Name: add_erase_range
+ ********************************************************************************
+ * Summary:
+ *   Adds an erased row to the erase ranges, extending the last range when
+ *   the row follows it.
+ *
+ * Return:
+ *   bool - false if out of memory
+ *
+ *******************************************************************************/
+static bool add_erase_range(uint32_t addr)
+{
+    erase_range_t *last = (range_count > 0u) ? &ranges[range_count - 1u] : NULL;
+
+    /* A row shared by two segments is already in the range */
+    if ((last != NULL) && (addr >= last->addr) && ((addr - last->addr) < last->len))
+    {
+        return true;
+    }
+
+    if ((last != NULL) && (addr == (last->addr + last->len)))
+    {
+        last->len += cfg.row_size;
+        return true;
+    }
+
+    if (range_count == range_max)
+    {
+        range_max = (range_max == 0u) ? 64u : (range_max * 2u);
+        ranges = realloc(ranges, range_max * sizeof(erase_range_t));
+        if (ranges == NULL)
+        {
+            return false;
+        }
+    }
+
+    ranges[range_count].addr = addr;
+    ranges[range_count].len = cfg.row_size;
+    range_count++;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: emit_row
+ ********************************************************************************
+ * Summary:
+ *   Writes a row, or in a sparse file, adds it to the erase ranges when it
+ *   holds only the erased value.
+ *
+ * Parameters:
+ *   addr - Row address
+ *   data - Row data, or NULL for a row of zeros
+ *
+ * Return:
+ *   uint32_t - 1 if the row is written to the file, else 0
+ *
+ *******************************************************************************/
+static uint32_t emit_row(uint32_t addr, const uint8_t *data)
+{
+    if (cfg.sparse)
+    {
+        bool erased = (data == NULL) ? (cfg.erased_value == 0u) : true;
+
+        for (uint32_t i = 0u; (data != NULL) && erased && (i < cfg.row_size); i++)
+        {
+            erased = (data[i] == cfg.erased_value);
+        }
+
+        if (erased)
+        {
+            if (collect_ranges && !add_erase_range(addr))
+            {
+                fprintf(stderr, "Out of memory\n");
+                exit(1);
+            }
+            return 0u;
+        }
+    }
+
+    if (collect_ranges)
+    {
+        return 0u;
+    }
+
+    out_row(addr, data);
+
+    return 1u;
+}
+
+/*******************************************************************************
+ * Function Name: rec_compare
+ ********************************************************************************
+ * Summary:
+ *   qsort() comparison of two data records by address.
+ *
+ *******************************************************************************/
+static int rec_compare(const void *a, const void *b)
+{
+    uint32_t addr_a = ((const hex_rec_t *) a)->addr;
+    uint32_t addr_b = ((const hex_rec_t *) b)->addr;
+
+    return (addr_a > addr_b) - (addr_a < addr_b);
+}
+
+/*******************************************************************************
+ * Function Name: index_hex
+ ********************************************************************************
+ * Summary:
+ *   Checks the records of a HEX file and indexes its data records by
+ *   address. Like the IntelHex library, records overlapping each other are
+ *   refused, and the records after the end-of-file record are ignored.
+ *
+ * Parameters:
+ *   path - HEX file, for the messages
+ *   text - Content of the HEX file
+ *   size - Size of the content
+ *
+ * Return:
+ *   int - 0 or -1 if the file is invalid
+ *
+ *******************************************************************************/
+static int index_hex(const char *path, const char *text, size_t size)
+{
+    const char *end = text + size;
+    const char *line = text;
+    uint32_t base = 0u;
+    uint32_t line_num = 0u;
+    size_t rec_max = 0u;
+    bool sorted = true;
+
+    while (line < end)
+    {
+        const char *line_end = memchr(line, '\n', (size_t) (end - line));
+        const char *next = (line_end != NULL) ? (line_end + 1) : end;
+        uint8_t rec[5];
+        uint8_t checksum = 0u;
+        size_t len;
+
+        if (line_end == NULL)
+        {
+            line_end = end;
+        }
+        while ((line_end > line) && ((line_end[-1] == '\r') || (line_end[-1] == '\n')))
+        {
+            line_end--;
+        }
+
+        line_num++;
+        len = (size_t) (line_end - line);
+        if (len == 0u)
+        {
+            line = next;
+            continue;
+        }
+
+        /* Record: count, address (2), type, data, checksum */
+        if ((line[0] != ':') || (len < 11u) || ((len & 1u) == 0u))
+        {
+            fprintf(stderr, "%s:%" PRIu32 ": invalid record\n", path, line_num);
+            return -1;
+        }
+
+        for (size_t i = 0u; i < ((len - 1u) / 2u); i++)
+        {
+            int value = hex_byte(&line[1u + (i * 2u)]);
+
+            if (value < 0)
+            {
+                fprintf(stderr, "%s:%" PRIu32 ": invalid record\n", path, line_num);
+                return -1;
+            }
+            if (i < sizeof(rec))
+            {
+                rec[i] = (uint8_t) value;
+            }
+            checksum += (uint8_t) value;
+        }
+
+        if ((((len - 1u) / 2u) != (rec[0] + 5u)) || (checksum != 0u))
+        {
+            fprintf(stderr, "%s:%" PRIu32 ": invalid record\n", path, line_num);
+            return -1;
+        }
+
+        if (rec[3] == HEX_REC_EOF)
+        {
+            break;
+        }
+
+        switch (rec[3])
+        {
+            case HEX_REC_DATA:
+                if (rec[0] == 0u)
+                {
+                    break;
+                }
+                if (rec_count == rec_max)
+                {
+                    rec_max = (rec_max == 0u) ? 4096u : (rec_max * 2u);
+                    recs = realloc(recs, rec_max * sizeof(hex_rec_t));
+                    if (recs == NULL)
+                    {
+                        fprintf(stderr, "Out of memory\n");
+                        return -1;
+                    }
+                }
+                recs[rec_count].addr = base + (((uint32_t) rec[1] << 8) | rec[2]);
+                recs[rec_count].len = rec[0];
+                recs[rec_count].data = &line[9];
+                if ((rec_count > 0u) && (recs[rec_count].addr < recs[rec_count - 1u].addr))
+                {
+                    sorted = false;
+                }
+                rec_count++;
+                break;
+
+            case HEX_REC_EXT_SEGMENT_ADDR:
+            case HEX_REC_EXT_LINEAR_ADDR:
+                if (rec[0] != 2u)
+                {
+                    fprintf(stderr, "%s:%" PRIu32 ": invalid record\n", path, line_num);
+                    return -1;
+                }
+                base = (uint32_t) ((hex_byte(&line[9]) << 8) | hex_byte(&line[11]));
+                base <<= (rec[3] == HEX_REC_EXT_LINEAR_ADDR) ? 16u : 4u;
+                break;
+
+            default:
+                break;
+        }
+
+        line = next;
+    }
+
+    /* The compilers emit the records in address order, sort only if not */
+    if (!sorted)
+    {
+        qsort(recs, rec_count, sizeof(hex_rec_t), rec_compare);
+    }
+
+    for (size_t i = 1u; i < rec_count; i++)
+    {
+        if (recs[i].addr < ((uint64_t) recs[i - 1u].addr + recs[i - 1u].len))
+        {
+            fprintf(stderr, "%s: data overlaps at address 0x%08" PRIX32 "\n", path, recs[i].addr);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: write_header
+ ********************************************************************************
+ * Summary:
+ *   Writes the header and the application info lines. Without a start
+ *   address, the application info is taken from the lowest and highest
+ *   address of the HEX data, as generate_appinfo() of the script does.
+ *
+ * Return:
+ *   int - 0 or -1 if the application info cannot be generated
+ *
+ *******************************************************************************/
+static int write_header(void)
+{
+    char text[64];
+    uint32_t start_addr = cfg.start_addr;
+    uint32_t app_size = cfg.app_size;
+    int len;
+
+    len = snprintf(text, sizeof(text), "%02" PRIX32 "0000000000%02" PRIX32 "%02X",
+                   cfg.file_version, cfg.checksum_type, CYACD2_APP_ID);
+    out_write(text, (size_t) len);
+    out_hex32_le(cfg.product_id);
+    out_write("\n", 1u);
+
+    if (start_addr == 0u)
+    {
+        if (rec_count == 0u)
+        {
+            fprintf(stderr, "No data in the HEX file\n");
+            return -1;
+        }
+
+        start_addr = recs[0].addr;
+        app_size = (recs[rec_count - 1u].addr + recs[rec_count - 1u].len - 1u) - start_addr;
+    }
+
+    len = snprintf(text, sizeof(text), "@APPINFO:0x%" PRIX32 ",0x%" PRIX32 "\n", start_addr, app_size);
+    out_write(text, (size_t) len);
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: write_rows
+ ********************************************************************************
+ * Summary:
+ *   Writes the rows of the HEX data in address order. As in the script, the
+ *   first and last rows of a segment of contiguous data are padded with
+ *   zeros, and the whole rows between two segments are written as rows of
+ *   zeros. A row shared by two segments is written once for each of them.
+ *
+ * Return:
+ *   uint32_t - Number of rows written
+ *
+ *******************************************************************************/
+static uint32_t write_rows(void)
+{
+    uint32_t row_mask = cfg.row_size - 1u;
+    uint32_t row_addr = 0u;
+    uint32_t seg_end = 0u;
+    uint32_t rows = 0u;
+    bool row_open = false;
+
+    for (size_t r = 0u; r < rec_count; r++)
+    {
+        const hex_rec_t *rec = &recs[r];
+        uint32_t addr = rec->addr;
+        uint32_t done = 0u;
+
+        /* Start of a new segment: close the last row, fill the gap */
+        if (row_open && (addr != seg_end))
+        {
+            rows += emit_row(row_addr, row_buf);
+            row_open = false;
+
+            for (uint32_t gap = (seg_end + row_mask) & ~row_mask; gap < (addr & ~row_mask); gap += cfg.row_size)
+            {
+                rows += emit_row(gap, NULL);
+            }
+        }
+
+        while (done < rec->len)
+        {
+            uint32_t byte_addr = addr + done;
+            uint32_t offset = byte_addr & row_mask;
+            uint32_t count = rec->len - done;
+
+            if (row_open && ((byte_addr & ~row_mask) != row_addr))
+            {
+                rows += emit_row(row_addr, row_buf);
+                row_open = false;
+            }
+            if (!row_open)
+            {
+                row_addr = byte_addr & ~row_mask;
+                memset(row_buf, 0, cfg.row_size);
+                row_open = true;
+            }
+
+            if (count > (cfg.row_size - offset))
+            {
+                count = cfg.row_size - offset;
+            }
+            for (uint32_t i = 0u; i < count; i++)
+            {
+                row_buf[offset + i] = (uint8_t) hex_byte(&rec->data[(done + i) * 2u]);
+            }
+            done += count;
+        }
+
+        seg_end = addr + rec->len;
+    }
+
+    if (row_open)
+    {
+        rows += emit_row(row_addr, row_buf);
+    }
+
+    return rows;
+}
+
+/*******************************************************************************
+ * Function Name: write_erase_ranges
+ ********************************************************************************
+ * Summary:
+ *   Collects the ranges of the erased rows of a sparse file, and writes the
+ *   rows listing them in the dfu_erase_range_row_t layout of dfu_user.h.
+ *   They go ahead of the image rows. Does nothing for a full file.
+ *
+ * Return:
+ *   int - 0 or -1 if the ranges do not fit in ERASE_RANGE_ROWS rows
+ *
+ *******************************************************************************/
+static int write_erase_ranges(void)
+{
+    uint32_t per_row = (cfg.row_size - 8u) / 8u;
+    uint32_t row_num = 0u;
+
+    if (!cfg.sparse)
+    {
+        return 0;
+    }
+
+    collect_ranges = true;
+    (void) write_rows();
+    collect_ranges = false;
+
+    if (range_count > ((size_t) ERASE_RANGE_ROWS * per_row))
+    {
+        fprintf(stderr, "Too many erase ranges: %zu\n", range_count);
+        return -1;
+    }
+
+    for (size_t first = 0u; first < range_count; first += per_row, row_num++)
+    {
+        uint32_t count = ((range_count - first) < per_row) ? (uint32_t) (range_count - first) : per_row;
+        uint32_t words[2] = { ERASE_RANGE_MAGIC, count };
+
+        memset(row_buf, 0, cfg.row_size);
+        for (uint32_t i = 0u; i < 2u; i++)
+        {
+            for (uint32_t b = 0u; b < 4u; b++)
+            {
+                row_buf[(i * 4u) + b] = (uint8_t) (words[i] >> (b * 8u));
+            }
+        }
+        for (uint32_t r = 0u; r < count; r++)
+        {
+            for (uint32_t b = 0u; b < 4u; b++)
+            {
+                row_buf[8u + (r * 8u) + b] = (uint8_t) (ranges[first + r].addr >> (b * 8u));
+                row_buf[12u + (r * 8u) + b] = (uint8_t) (ranges[first + r].len >> (b * 8u));
+            }
+        }
+
+        out_row(ERASE_RANGE_ADDR + (row_num * cfg.row_size), row_buf);
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: convert
+ ********************************************************************************
+ * Summary:
+ *   Converts a HEX file to a CYACD2 file.
+ *
+ * Parameters:
+ *   in_path  - HEX file
+ *   out_path - CYACD2 file
+ *
+ * Return:
+ *   int - 0 or -1 on an error
+ *
+ *******************************************************************************/
+static int convert(const char *in_path, const char *out_path)
+{
+    struct stat st;
+    const char *text = NULL;
+    uint32_t rows = 0u;
+    int rc = -1;
+    int fd = open(in_path, O_RDONLY);
+
+    if ((fd < 0) || (fstat(fd, &st) != 0))
+    {
+        fprintf(stderr, "%s: cannot open\n", in_path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    if (st.st_size > 0)
+    {
+        text = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+        {
+            fprintf(stderr, "%s: cannot map\n", in_path);
+            close(fd);
+            return -1;
+        }
+        (void) madvise((void *) text, (size_t) st.st_size, MADV_SEQUENTIAL);
+    }
+
+    row_buf = malloc(cfg.row_size);
+    out.file = fopen(out_path, "wb");
+
+    if ((row_buf != NULL) && (out.file != NULL) && (index_hex(in_path, text, (size_t) st.st_size) == 0) &&
+        (write_header() == 0) && (write_erase_ranges() == 0))
+    {
+        rows = write_rows();
+        if (out_flush())
+        {
+            printf("%s: %" PRIu32 " rows written, %zu erase ranges\n", out_path, rows, range_count);
+            rc = 0;
+        }
+        else
+        {
+            fprintf(stderr, "%s: write failed\n", out_path);
+        }
+    }
+    else if (out.file == NULL)
+    {
+        fprintf(stderr, "%s: cannot create\n", out_path);
+    }
+
+    if (out.file != NULL)
+    {
+        fclose(out.file);
+        if (rc != 0)
+        {
+            remove(out_path);
+        }
+    }
+    if (text != NULL)
+    {
+        munmap((void *) text, (size_t) st.st_size);
+    }
+    close(fd);
+    free(row_buf);
+    free(recs);
+    free(ranges);
+
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    bool row_set = false;
+    bool id_set = false;
+
+    init_hex_tables();
+
+    /* Single-dash long options, as "-row=512" */
+    while ((opt = getopt_long_only(argc, argv, "", hextocyacd2_options, NULL)) != -1)
+    {
+        uint32_t value = (uint32_t) strtoul((optarg != NULL) ? optarg : "0", NULL, (opt == 'r') || (opt == 'v') ? 10 : 0);
+
+        switch (opt)
+        {
+            case 'r': cfg.row_size = value; row_set = true; break;
+            case 'i': cfg.product_id = value; id_set = true; break;
+            case 'v': cfg.file_version = value; break;
+            case 'a': cfg.start_addr = value; break;
+            case 's': cfg.app_size = value; break;
+            case 'e': cfg.erased_value = (uint8_t) value; cfg.sparse = true; break;
+            case 'c':
+                if (strcmp(optarg, "sum") == 0)
+                {
+                    cfg.checksum_type = 0u;
+                }
+                else if (strcmp(optarg, "crc") == 0)
+                {
+                    cfg.checksum_type = 1u;
+                }
+                else
+                {
+                    fprintf(stderr, "Invalid checksum type: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            default:
+                row_set = false;
+                optind = argc;
+                break;
+        }
+    }
+
+    /* The row size must be a power of two for the row address masks */
+    if (!row_set || !id_set || ((argc - optind) != 2) || (cfg.row_size == 0u) ||
+        (cfg.row_size > CYACD2_ROW_SIZE_MAX) || ((cfg.row_size & (cfg.row_size - 1u)) != 0u))
+    {
+        fprintf(stderr, "Usage: %s -row=N -id=N [-chk=sum|crc] [-ver=N] [-addr=N] [-size=N] [-erased=N]\n"
+                "       in_intel_hex out_cyacd2\n"
+                "N of -row must be a power of two\n", argv[0]);
+        return 2;
+    }
+
+    return (convert(argv[optind], argv[optind + 1]) == 0) ? 0 : 1;
+}
+
+/* [] END OF FILE */
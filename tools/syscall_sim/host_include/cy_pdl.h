@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Subset of the PDL used by srom_syscall.c, for the host build
+*   of the system call simulator. The IPC driver, interrupt and CPU
+*   functions are implemented by syscall_ipc_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PDL_H
+#define CY_PDL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CY_IPC_CHAN_SYSCALL             (0u)
+#define CY_IPC_INTR_SYSCALL1            (0u)
+
+/* Shared SRAM of the linker scripts (common.mk), see syscall_ipc_sim.c */
+#define SHARED_SRAM_START               ((uintptr_t)syscall_sim_shared_sram)
+#define BOOT_SHARED_SRAM_SIZE           (0x800)
+
+extern uint32_t syscall_sim_shared_sram[BOOT_SHARED_SRAM_SIZE / sizeof(uint32_t)];
+
+typedef enum
+{
+    cpuss_interrupts_ipc_10_IRQn = 33,
+    SYSCALL_SIM_TIMER_IRQn = 100,
+} IRQn_Type;
+
+typedef enum
+{
+    CY_IPC_DRV_SUCCESS = 0x00UL,
+    CY_IPC_DRV_ERROR = 0x01UL,
+} cy_en_ipcdrv_status_t;
+
+typedef enum
+{
+    CY_EFUSE_SUCCESS = 0x00UL,
+    CY_EFUSE_BAD_PARAM = 0x01UL,
+    CY_EFUSE_IPC_BUSY = 0x02UL,
+    CY_EFUSE_ERR_UNC = 0x03UL,
+} cy_en_efuse_status_t;
+
+typedef enum
+{
+    CY_SYSINT_SUCCESS = 0x00UL,
+    CY_SYSINT_BAD_PARAM = 0x01UL,
+} cy_en_sysint_status_t;
+
+typedef struct
+{
+    IRQn_Type intrSrc;
+    uint32_t intrPriority;
+} cy_stc_sysint_t;
+
+/* IPC structure and IPC interrupt structure, see syscall_ipc_sim.c */
+typedef struct
+{
+    volatile bool locked;
+    volatile uint32_t data;
+} IPC_STRUCT_Type;
+
+typedef struct
+{
+    volatile uint32_t intr;
+    volatile uint32_t mask;
+} IPC_INTR_STRUCT_Type;
+
+IPC_STRUCT_Type *Cy_IPC_Drv_GetIpcBaseAddress(uint32_t ipcIndex);
+IPC_INTR_STRUCT_Type *Cy_IPC_Drv_GetIntrBaseAddr(uint32_t ipcIntrIndex);
+cy_en_ipcdrv_status_t Cy_IPC_Drv_SendMsgPtr(IPC_STRUCT_Type *base, uint32_t notifyEventIntr, void const *msgPtr);
+bool Cy_IPC_Drv_IsLockAcquired(IPC_STRUCT_Type const *base);
+void Cy_IPC_Drv_SetInterruptMask(IPC_INTR_STRUCT_Type *base, uint32_t ipcReleaseMask, uint32_t ipcNotifyMask);
+void Cy_IPC_Drv_ClearInterrupt(IPC_INTR_STRUCT_Type *base, uint32_t ipcReleaseMask, uint32_t ipcNotifyMask);
+cy_en_efuse_status_t Cy_EFUSE_GetEfuseByte(uint32_t offset, uint8_t *byteVal);
+cy_en_efuse_status_t Cy_EFUSE_GetEfuseBit(uint32_t bitNum, bool *bitVal);
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t *config, void (*userIsr)(void));
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+
+#endif /* CY_PDL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: cyhal.h
+*
+* Description: Subset of the HAL timer used by srom_syscall.c, for the host
+*   build of the system call simulator. The timer runs on the simulated
+*   time of syscall_ipc_sim.c.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CYHAL_H
+#define CYHAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+#define NC                              (-1)
+
+typedef enum
+{
+    CYHAL_TIMER_DIR_UP,
+    CYHAL_TIMER_DIR_DOWN,
+} cyhal_timer_direction_t;
+
+typedef enum
+{
+    CYHAL_TIMER_IRQ_NONE = 0,
+    CYHAL_TIMER_IRQ_TERMINAL_COUNT = 1,
+    CYHAL_TIMER_IRQ_CAPTURE_COMPARE = 2,
+} cyhal_timer_event_t;
+
+typedef void (*cyhal_timer_event_callback_t)(void *callback_arg, cyhal_timer_event_t event);
+
+typedef struct
+{
+    bool is_continuous;
+    cyhal_timer_direction_t direction;
+    bool is_compare;
+    uint32_t period;
+    uint32_t compare_value;
+    uint32_t value;
+} cyhal_timer_cfg_t;
+
+typedef struct
+{
+    uint32_t frequency_hz;
+    cyhal_timer_cfg_t cfg;
+    bool running;
+    uint64_t expiry_ns;
+    cyhal_timer_event_callback_t callback;
+    void *callback_arg;
+    bool event_enabled;
+} cyhal_timer_t;
+
+cy_rslt_t cyhal_timer_init(cyhal_timer_t *obj, int pin, const void *clk);
+cy_rslt_t cyhal_timer_configure(cyhal_timer_t *obj, const cyhal_timer_cfg_t *cfg);
+cy_rslt_t cyhal_timer_set_frequency(cyhal_timer_t *obj, uint32_t hz);
+void cyhal_timer_register_callback(cyhal_timer_t *obj, cyhal_timer_event_callback_t callback, void *callback_arg);
+void cyhal_timer_enable_event(cyhal_timer_t *obj, cyhal_timer_event_t event, uint8_t intr_priority, bool enable);
+cy_rslt_t cyhal_timer_start(cyhal_timer_t *obj);
+cy_rslt_t cyhal_timer_stop(cyhal_timer_t *obj);
+void cyhal_timer_free(cyhal_timer_t *obj);
+
+#endif /* CYHAL_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,667 @@
+/******************************************************************************
+* File Name: syscall_ipc_sim.c
+*
+* Description: Simulated system call IPC channel, IPC interrupt, HAL timer,
+*   task notifications, blocking eFuse driver and shared SRAM, see
+*   syscall_ipc_sim.h. Only the functions used by srom_syscall.c and
+*   cy_ps_boot_efuse.c are implemented.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "cy_pdl.h"
+#include "cyhal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "syscall_ipc_sim.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SIM_IPC_STRUCT_COUNT            (16u)
+#define SIM_IRQ_COUNT                   (4u)
+#define SIM_NEVER                       (UINT64_MAX)
+
+/* IPC interrupt structure of each IPC interrupt source */
+#define SIM_IPC_INTR_STRUCT(irqn)       ((uint32_t)(irqn) - (uint32_t)cpuss_interrupts_ipc_10_IRQn + 10u)
+
+/* Release bits of the IPC interrupt registers */
+#define SIM_IPC_RELEASE_Msk             (0x0000FFFFUL)
+
+#define SIM_OPCODE_Pos                  (24u)
+#define SIM_OPCODE_READ_FUSE_BYTE       (0x03u)
+#define SIM_OPCODE_TRANSITION_TO_RMA    (0x28u)
+#define SIM_EFUSE_OFFSET_Pos            (8u)
+#define SIM_EFUSE_OFFSET_Msk            (0xFFFFu)
+#define SIM_STS_SUCCESS                 (0xA0000000UL)
+#define SIM_STS_INVALID_EFUSE_ADDR      (0xF0000002UL)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Interrupt registered with Cy_SysInt_Init() or a HAL timer */
+typedef struct
+{
+    IRQn_Type irqn;
+    void (*handler)(void);
+    bool enabled;
+    bool pending;
+} sim_irq_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+syscall_ipc_sim_cfg_t syscall_ipc_sim_cfg =
+{
+    .efuse_read_ns = 20000u,
+    .rma_ns = 1500000000u,
+    .other_ns = 100000u,
+    .rma_status = SIM_STS_SUCCESS,
+    .efuse_error_offset = SYSCALL_SIM_NO_EFUSE_ERROR,
+    .release_notify = true,
+    .hang = false,
+};
+
+syscall_ipc_sim_stats_t syscall_ipc_sim_stats;
+
+uint32_t syscall_sim_shared_sram[BOOT_SHARED_SRAM_SIZE / sizeof(uint32_t)];
+
+static uint64_t sim_now_ns = 0u;
+static bool sim_primask = false;
+
+static IPC_STRUCT_Type sim_ipc[SIM_IPC_STRUCT_COUNT];
+static IPC_INTR_STRUCT_Type sim_ipc_intr[SIM_IPC_STRUCT_COUNT];
+static sim_irq_t sim_irqs[SIM_IRQ_COUNT];
+
+/* Call executed by the SROM */
+static volatile uint32_t *sim_srom_params = NULL;
+static uint64_t sim_srom_done_ns = SIM_NEVER;
+static uint64_t sim_srom_latency_ns = 0u;
+
+/* The HAL timer of srom_syscall.c */
+static cyhal_timer_t *sim_timer = NULL;
+
+/* Task of the simulated scheduler */
+static bool sim_scheduler_running = false;
+static uint32_t sim_task_notify = 0u;
+static int sim_task;
+
+/*******************************************************************************
+ * Function Name: sim_find_irq
+ *******************************************************************************
+ * Summary:
+ *  Returns the entry of an interrupt, allocated on first use.
+ *
+ *******************************************************************************/
+static sim_irq_t *sim_find_irq(IRQn_Type irqn)
+{
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if ((sim_irqs[i].handler != NULL) && (sim_irqs[i].irqn == irqn))
+        {
+            return &sim_irqs[i];
+        }
+    }
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if (sim_irqs[i].handler == NULL)
+        {
+            sim_irqs[i].irqn = irqn;
+            return &sim_irqs[i];
+        }
+    }
+    fprintf(stderr, "syscall_ipc_sim: too many interrupts\n");
+    exit(1);
+}
+
+/*******************************************************************************
+ * Function Name: sim_timer_isr
+ *******************************************************************************
+ * Summary:
+ *  Interrupt handler of the HAL timer, calls the timer callback.
+ *
+ *******************************************************************************/
+static void sim_timer_isr(void)
+{
+    syscall_ipc_sim_stats.timer_irqs++;
+    if ((sim_timer != NULL) && (sim_timer->callback != NULL))
+    {
+        sim_timer->callback(sim_timer->callback_arg, CYHAL_TIMER_IRQ_TERMINAL_COUNT);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_update_ipc_irqs
+ *******************************************************************************
+ * Summary:
+ *  The IPC interrupts are level triggered: pending while a masked release
+ *  bit is set.
+ *
+ *******************************************************************************/
+static void sim_update_ipc_irqs(void)
+{
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if ((sim_irqs[i].handler != NULL) && (sim_irqs[i].irqn != SYSCALL_SIM_TIMER_IRQn))
+        {
+            uint32_t index = SIM_IPC_INTR_STRUCT(sim_irqs[i].irqn);
+
+            sim_irqs[i].pending = ((sim_ipc_intr[index].intr & sim_ipc_intr[index].mask) != 0u);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_run_pending
+ *******************************************************************************
+ * Summary:
+ *  Runs the handlers of the pending interrupts unless the interrupts are
+ *  masked.
+ *
+ *******************************************************************************/
+static void sim_run_pending(void)
+{
+    bool ran = true;
+
+    while (ran && !sim_primask)
+    {
+        ran = false;
+        sim_update_ipc_irqs();
+        for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+        {
+            if (sim_irqs[i].enabled && sim_irqs[i].pending && (sim_irqs[i].handler != NULL))
+            {
+                if (sim_irqs[i].irqn == SYSCALL_SIM_TIMER_IRQn)
+                {
+                    sim_irqs[i].pending = false;
+                }
+                else
+                {
+                    syscall_ipc_sim_stats.ipc_irqs++;
+                }
+                sim_irqs[i].handler();
+                ran = true;
+                break;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_irq_pending
+ *******************************************************************************
+ * Summary:
+ *  Returns true if an enabled interrupt is pending, which ends __WFI().
+ *
+ *******************************************************************************/
+static bool sim_irq_pending(void)
+{
+    sim_update_ipc_irqs();
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        if (sim_irqs[i].enabled && sim_irqs[i].pending && (sim_irqs[i].handler != NULL))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: sim_srom_complete
+ *******************************************************************************
+ * Summary:
+ *  Executes the call sent to the SROM: writes the status to the first word
+ *  of the parameters and releases the system call IPC structure.
+ *
+ *******************************************************************************/
+static void sim_srom_complete(void)
+{
+    uint32_t request = sim_srom_params[0];
+    uint32_t opcode = request >> SIM_OPCODE_Pos;
+
+    if (opcode == SIM_OPCODE_READ_FUSE_BYTE)
+    {
+        uint32_t offset = (request >> SIM_EFUSE_OFFSET_Pos) & SIM_EFUSE_OFFSET_Msk;
+
+        sim_srom_params[0] = ((offset < SYSCALL_SIM_EFUSE_SIZE) && (offset != syscall_ipc_sim_cfg.efuse_error_offset)) ?
+            (SIM_STS_SUCCESS | syscall_ipc_sim_cfg.efuse[offset]) : SIM_STS_INVALID_EFUSE_ADDR;
+    }
+    else if (opcode == SIM_OPCODE_TRANSITION_TO_RMA)
+    {
+        sim_srom_params[0] = syscall_ipc_sim_cfg.rma_status;
+    }
+    else
+    {
+        sim_srom_params[0] = SYSCALL_SIM_STS_INVALID_OPCODE;
+    }
+
+    sim_ipc[CY_IPC_CHAN_SYSCALL].locked = false;
+    sim_srom_params = NULL;
+    sim_srom_done_ns = SIM_NEVER;
+    syscall_ipc_sim_stats.last_done_ns = sim_now_ns;
+
+    /* Release event to the IPC interrupt structures */
+    if (syscall_ipc_sim_cfg.release_notify)
+    {
+        for (uint32_t i = 0; i < SIM_IPC_STRUCT_COUNT; i++)
+        {
+            sim_ipc_intr[i].intr |= (1UL << CY_IPC_CHAN_SYSCALL);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_next_event
+ *******************************************************************************
+ * Summary:
+ *  Returns the time of the next SROM completion or timer expiry.
+ *
+ *******************************************************************************/
+static uint64_t sim_next_event(void)
+{
+    uint64_t next = sim_srom_done_ns;
+
+    if ((sim_timer != NULL) && sim_timer->running && (sim_timer->expiry_ns < next))
+    {
+        next = sim_timer->expiry_ns;
+    }
+    return next;
+}
+
+/*******************************************************************************
+ * Function Name: sim_fire_events
+ *******************************************************************************
+ * Summary:
+ *  Processes the events due at the current time.
+ *
+ *******************************************************************************/
+static void sim_fire_events(void)
+{
+    if (sim_srom_done_ns <= sim_now_ns)
+    {
+        sim_srom_complete();
+    }
+
+    if ((sim_timer != NULL) && sim_timer->running && (sim_timer->expiry_ns <= sim_now_ns))
+    {
+        if (sim_timer->cfg.is_continuous)
+        {
+            sim_timer->expiry_ns += ((uint64_t)sim_timer->cfg.period + 1u) * 1000000000u / sim_timer->frequency_hz;
+        }
+        else
+        {
+            sim_timer->running = false;
+        }
+        if (sim_timer->event_enabled)
+        {
+            sim_find_irq(SYSCALL_SIM_TIMER_IRQn)->pending = true;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_wait_event
+ *******************************************************************************
+ * Summary:
+ *  Advances the time to the next event, like a CPU sleeping until an
+ *  interrupt. Nothing can wake the CPU if no event is scheduled.
+ *
+ *******************************************************************************/
+static void sim_wait_event(void)
+{
+    uint64_t next = sim_next_event();
+
+    if (next == SIM_NEVER)
+    {
+        fprintf(stderr, "syscall_ipc_sim: waiting with no event scheduled at %llu ns\n",
+                (unsigned long long)sim_now_ns);
+        exit(1);
+    }
+    if (next > sim_now_ns)
+    {
+        sim_now_ns = next;
+    }
+    sim_fire_events();
+    syscall_ipc_sim_stats.wakeups++;
+}
+
+/*******************************************************************************
+ * Simulation control, see syscall_ipc_sim.h
+ *******************************************************************************/
+uint64_t syscall_ipc_sim_now_ns(void)
+{
+    return sim_now_ns;
+}
+
+void syscall_ipc_sim_advance_ns(uint64_t ns)
+{
+    uint64_t end = sim_now_ns + ns;
+
+    sim_run_pending();
+    for (uint64_t next = sim_next_event(); next <= end; next = sim_next_event())
+    {
+        sim_now_ns = (next > sim_now_ns) ? next : sim_now_ns;
+        sim_fire_events();
+        sim_run_pending();
+    }
+    sim_now_ns = end;
+}
+
+void syscall_ipc_sim_set_scheduler(bool running)
+{
+    sim_scheduler_running = running;
+    sim_task_notify = 0u;
+}
+
+void syscall_ipc_sim_unhang(void)
+{
+    syscall_ipc_sim_cfg.hang = false;
+    if (sim_srom_params != NULL)
+    {
+        sim_srom_done_ns = sim_now_ns + sim_srom_latency_ns;
+    }
+}
+
+void syscall_ipc_sim_reset_stats(void)
+{
+    syscall_ipc_sim_stats = (syscall_ipc_sim_stats_t){ 0 };
+}
+
+/*******************************************************************************
+ * IPC driver
+ *******************************************************************************/
+IPC_STRUCT_Type *Cy_IPC_Drv_GetIpcBaseAddress(uint32_t ipcIndex)
+{
+    return &sim_ipc[ipcIndex];
+}
+
+IPC_INTR_STRUCT_Type *Cy_IPC_Drv_GetIntrBaseAddr(uint32_t ipcIntrIndex)
+{
+    return &sim_ipc_intr[ipcIntrIndex];
+}
+
+cy_en_ipcdrv_status_t Cy_IPC_Drv_SendMsgPtr(IPC_STRUCT_Type *base, uint32_t notifyEventIntr, void const *msgPtr)
+{
+    uint32_t opcode;
+
+    (void)notifyEventIntr;
+
+    if ((base != &sim_ipc[CY_IPC_CHAN_SYSCALL]) || base->locked)
+    {
+        return CY_IPC_DRV_ERROR;
+    }
+
+    base->locked = true;
+    base->data = (uint32_t)(uintptr_t)msgPtr;
+    sim_srom_params = (volatile uint32_t *)msgPtr;
+    syscall_ipc_sim_stats.calls++;
+
+    opcode = sim_srom_params[0] >> SIM_OPCODE_Pos;
+    sim_srom_latency_ns = (opcode == SIM_OPCODE_READ_FUSE_BYTE) ? syscall_ipc_sim_cfg.efuse_read_ns :
+                          (opcode == SIM_OPCODE_TRANSITION_TO_RMA) ? syscall_ipc_sim_cfg.rma_ns :
+                          syscall_ipc_sim_cfg.other_ns;
+    sim_srom_done_ns = syscall_ipc_sim_cfg.hang ? SIM_NEVER : (sim_now_ns + sim_srom_latency_ns);
+
+    return CY_IPC_DRV_SUCCESS;
+}
+
+bool Cy_IPC_Drv_IsLockAcquired(IPC_STRUCT_Type const *base)
+{
+    return base->locked;
+}
+
+void Cy_IPC_Drv_SetInterruptMask(IPC_INTR_STRUCT_Type *base, uint32_t ipcReleaseMask, uint32_t ipcNotifyMask)
+{
+    base->mask = (ipcReleaseMask & SIM_IPC_RELEASE_Msk) | ((ipcNotifyMask & SIM_IPC_RELEASE_Msk) << 16u);
+}
+
+void Cy_IPC_Drv_ClearInterrupt(IPC_INTR_STRUCT_Type *base, uint32_t ipcReleaseMask, uint32_t ipcNotifyMask)
+{
+    base->intr &= ~((ipcReleaseMask & SIM_IPC_RELEASE_Msk) | ((ipcNotifyMask & SIM_IPC_RELEASE_Msk) << 16u));
+}
+
+/*******************************************************************************
+ * eFuse driver. Like the PDL, it sends the call and then polls the IPC
+ * structure with the CPU busy until the SROM releases it.
+ *******************************************************************************/
+cy_en_efuse_status_t Cy_EFUSE_GetEfuseByte(uint32_t offset, uint8_t *byteVal)
+{
+    static volatile uint32_t params;
+    IPC_STRUCT_Type *ipc = &sim_ipc[CY_IPC_CHAN_SYSCALL];
+
+    params = ((uint32_t)SIM_OPCODE_READ_FUSE_BYTE << SIM_OPCODE_Pos) | (offset << SIM_EFUSE_OFFSET_Pos);
+    if (Cy_IPC_Drv_SendMsgPtr(ipc, CY_IPC_INTR_SYSCALL1, (void const *)&params) != CY_IPC_DRV_SUCCESS)
+    {
+        return CY_EFUSE_IPC_BUSY;
+    }
+
+    while (ipc->locked)
+    {
+        if (sim_srom_done_ns == SIM_NEVER)
+        {
+            fprintf(stderr, "syscall_ipc_sim: Cy_EFUSE_GetEfuseByte with a hung SROM\n");
+            exit(1);
+        }
+        sim_now_ns = (sim_srom_done_ns > sim_now_ns) ? sim_srom_done_ns : sim_now_ns;
+        sim_fire_events();
+    }
+
+    if ((params & 0xF0000000UL) != SIM_STS_SUCCESS)
+    {
+        return CY_EFUSE_ERR_UNC;
+    }
+    *byteVal = (uint8_t)params;
+    return CY_EFUSE_SUCCESS;
+}
+
+cy_en_efuse_status_t Cy_EFUSE_GetEfuseBit(uint32_t bitNum, bool *bitVal)
+{
+    uint8_t byteVal = 0u;
+    cy_en_efuse_status_t status = Cy_EFUSE_GetEfuseByte(bitNum / 8u, &byteVal);
+
+    *bitVal = (((uint32_t)byteVal >> (bitNum % 8u)) & 1u) != 0u;
+    return status;
+}
+
+/*******************************************************************************
+ * Interrupts and CPU
+ *******************************************************************************/
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t *config, void (*userIsr)(void))
+{
+    sim_irq_t *irq = sim_find_irq(config->intrSrc);
+
+    irq->handler = userIsr;
+    return CY_SYSINT_SUCCESS;
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    sim_find_irq(IRQn)->enabled = true;
+    sim_run_pending();
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    sim_find_irq(IRQn)->enabled = false;
+}
+
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    uint32_t saved = sim_primask ? 1u : 0u;
+
+    sim_primask = true;
+    return saved;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus)
+{
+    sim_primask = (savedIntrStatus != 0u);
+    sim_run_pending();
+}
+
+void __disable_irq(void)
+{
+    sim_primask = true;
+}
+
+void __enable_irq(void)
+{
+    sim_primask = false;
+    sim_run_pending();
+}
+
+void __WFI(void)
+{
+    /* A pending interrupt ends __WFI even with the interrupts masked */
+    if (sim_irq_pending())
+    {
+        return;
+    }
+    sim_wait_event();
+    sim_run_pending();
+}
+
+/*******************************************************************************
+ * HAL timer
+ *******************************************************************************/
+cy_rslt_t cyhal_timer_init(cyhal_timer_t *obj, int pin, const void *clk)
+{
+    (void)pin;
+    (void)clk;
+
+    *obj = (cyhal_timer_t){ .frequency_hz = 1000000u };
+    sim_timer = obj;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_configure(cyhal_timer_t *obj, const cyhal_timer_cfg_t *cfg)
+{
+    obj->cfg = *cfg;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_set_frequency(cyhal_timer_t *obj, uint32_t hz)
+{
+    obj->frequency_hz = hz;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_timer_register_callback(cyhal_timer_t *obj, cyhal_timer_event_callback_t callback, void *callback_arg)
+{
+    obj->callback = callback;
+    obj->callback_arg = callback_arg;
+}
+
+void cyhal_timer_enable_event(cyhal_timer_t *obj, cyhal_timer_event_t event, uint8_t intr_priority, bool enable)
+{
+    sim_irq_t *irq = sim_find_irq(SYSCALL_SIM_TIMER_IRQn);
+
+    (void)event;
+    (void)intr_priority;
+
+    obj->event_enabled = enable;
+    irq->handler = sim_timer_isr;
+    irq->enabled = enable;
+}
+
+cy_rslt_t cyhal_timer_start(cyhal_timer_t *obj)
+{
+    obj->running = true;
+    obj->expiry_ns = sim_now_ns + (((uint64_t)obj->cfg.period + 1u) * 1000000000u / obj->frequency_hz);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_timer_stop(cyhal_timer_t *obj)
+{
+    obj->running = false;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_timer_free(cyhal_timer_t *obj)
+{
+    obj->running = false;
+    if (sim_timer == obj)
+    {
+        sim_timer = NULL;
+    }
+}
+
+/*******************************************************************************
+ * Task notifications, a single task
+ *******************************************************************************/
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return sim_scheduler_running ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &sim_task;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    (void)xTaskToNotify;
+
+    sim_task_notify++;
+    syscall_ipc_sim_stats.notifications++;
+    *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    uint32_t value;
+
+    (void)xTicksToWait;
+
+    sim_run_pending();
+    while (sim_task_notify == 0u)
+    {
+        sim_wait_event();
+        sim_run_pending();
+    }
+
+    value = sim_task_notify;
+    sim_task_notify = (xClearCountOnExit != pdFALSE) ? 0u : (sim_task_notify - 1u);
+    return value;
+}
+
+/* [] END OF FILE */
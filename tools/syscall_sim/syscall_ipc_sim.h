@@ -0,0 +1,111 @@
+/******************************************************************************
+* File Name: syscall_ipc_sim.h
+*
+* Description: Simulated system call IPC channel of the PSoC 6 for host
+*   runs of srom_syscall.c. A message sent on the system call IPC
+*   structure is executed by a simulated SROM after a latency set per
+*   opcode; the SROM writes its status to the first word of the parameters
+*   and releases the structure, which raises the release interrupt. The IPC
+*   interrupt, the HAL timer and the task notifications run on a simulated
+*   clock that __WFI() and ulTaskNotifyTake() advance to the next event.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SYSCALL_IPC_SIM_H
+#define SYSCALL_IPC_SIM_H
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SYSCALL_SIM_EFUSE_SIZE          (128u)
+
+/* syscall_ipc_sim_cfg_t.efuse_error_offset when all the eFuse reads succeed */
+#define SYSCALL_SIM_NO_EFUSE_ERROR      (0xFFFFFFFFUL)
+
+/* Status returned by the simulated SROM for an unknown opcode */
+#define SYSCALL_SIM_STS_INVALID_OPCODE  (0xF0000000UL)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Behavior of the simulated SROM */
+typedef struct
+{
+    uint64_t efuse_read_ns;         /* Latency of ReadFuseByte (0x03) */
+    uint64_t rma_ns;                /* Latency of TransitionToRMA (0x28) */
+    uint64_t other_ns;              /* Latency of the other opcodes */
+    uint32_t rma_status;            /* Status returned for TransitionToRMA */
+    uint32_t efuse_error_offset;    /* ReadFuseByte of this offset fails */
+    bool release_notify;            /* Release events sent to the CM4 IPC interrupt structure */
+    bool hang;                      /* Calls are not completed until syscall_ipc_sim_unhang() */
+    uint8_t efuse[SYSCALL_SIM_EFUSE_SIZE];
+} syscall_ipc_sim_cfg_t;
+
+/* Event counters */
+typedef struct
+{
+    uint32_t calls;                 /* Messages sent on the system call IPC structure */
+    uint32_t wakeups;               /* Returns from __WFI() and ulTaskNotifyTake() waits */
+    uint32_t ipc_irqs;              /* Release interrupts handled */
+    uint32_t timer_irqs;            /* Timer interrupts handled */
+    uint32_t notifications;         /* Task notifications given */
+    uint64_t last_done_ns;          /* Time the SROM released the structure */
+} syscall_ipc_sim_stats_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern syscall_ipc_sim_cfg_t syscall_ipc_sim_cfg;
+extern syscall_ipc_sim_stats_t syscall_ipc_sim_stats;
+
+/*******************************************************************************
+ * Function prototypes
+ ******************************************************************************/
+uint64_t syscall_ipc_sim_now_ns(void);
+void syscall_ipc_sim_advance_ns(uint64_t ns);
+void syscall_ipc_sim_set_scheduler(bool running);
+void syscall_ipc_sim_unhang(void);
+void syscall_ipc_sim_reset_stats(void);
+
+#endif /* SYSCALL_IPC_SIM_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,757 @@
+/******************************************************************************
+* File Name: syscall_sim.c
+*
+* Description: Host harness that runs srom_syscall.c of the CM4 project on
+*   the simulated system call IPC channel of syscall_ipc_sim.c. Each
+*   scenario sends one or more system calls and reports their result, when
+*   the SROM completed them, when the caller saw the completion, and how
+*   often the CPU woke up. The last column gives the time the former
+*   TransitionToRMA() loop, which checked the IPC structure every second,
+*   took to see the same completion.
+*
+*   The boot flows compare the eFuse reads of the bootloader and of the CM4
+*   application at startup: the former blocking reads, one srom_syscall.c
+*   read, and the snapshot published in the shared SRAM by
+*   cy_ps_boot_efuse.c of the bootloader project.
+*
+*   The SROM latencies are set with --efuse-us and --rma-ms, and the CPU time
+*   of the snapshot CRC with --crc-ns. They are estimates, the RMA transition
+*   time in particular depends on the device.
+*
+*   Build:
+*   gcc -o syscall_sim -Itools/syscall_sim -Itools/syscall_sim/host_include
+*       -Iproj_cm4/source -Iproj_btldr_cm0p/source
+*       proj_cm4/source/srom_syscall.c proj_btldr_cm0p/source/cy_ps_boot_efuse.c
+*       tools/syscall_sim/syscall_ipc_sim.c tools/syscall_sim/syscall_sim.c
+*
+*   Example Usage:
+*   syscall_sim --rma-ms 2500
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include header files
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "srom_syscall.h"
+#include "rma.h"
+#include "cy_ps_boot_efuse.h"
+#include "syscall_ipc_sim.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* eFuse byte of the lifecycle stage */
+#define SIM_LIFECYCLE_EFUSE_BYTE        (0x2Bu)
+
+/* Bits of the lifecycle stage in its eFuse byte */
+#define SIM_LIFECYCLE_BIT_NORMAL        (0u)
+#define SIM_LIFECYCLE_BIT_SECURE_DEBUG  (1u)
+#define SIM_LIFECYCLE_BIT_SECURE        (2u)
+#define SIM_LIFECYCLE_BIT_RMA           (3u)
+
+/* Timeout of the "timeout" scenario */
+#define SIM_HANG_TIMEOUT_MS             (500u)
+
+/* Work done by the caller between two checks in the "callback" scenario */
+#define SIM_CALLER_SLICE_NS             (1000000u)
+
+/* Check period of the former TransitionToRMA() loop */
+#define SIM_POLL_NS                     (1000000000u)
+
+#define NS_PER_MS                       (1000000u)
+#define NS_PER_US                       (1000u)
+
+/*******************************************************************************
+ * Structures
+ ******************************************************************************/
+/* Result of a scenario */
+typedef struct
+{
+    srom_syscall_status_t status;
+    uint32_t result;                /* First word of the parameters */
+    uint64_t start_ns;
+    uint64_t seen_ns;               /* The caller saw the completion */
+    uint32_t timeout_ms;
+    bool polled;                    /* Compare with the former 1 s loop */
+    const char *note;
+} sim_result_t;
+
+typedef void (*sim_scenario_fn_t)(sim_result_t *result);
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+    sim_scenario_fn_t run;
+} sim_scenario_t;
+
+/* eFuse reads of one CPU during the boot */
+typedef struct
+{
+    uint32_t calls;                 /* System calls */
+    uint64_t ns;                    /* Time spent, including the snapshot CRC */
+} sim_boot_cpu_t;
+
+/* Result of a boot flow */
+typedef struct
+{
+    sim_boot_cpu_t cm0p;            /* Bootloader */
+    sim_boot_cpu_t cm4;             /* CM4 application, before the lifecycle print */
+    uint8_t lifecycle;              /* Lifecycle byte seen by the CM4 application */
+    bool partial;                   /* The bootloader stopped its reads early */
+    const char *note;
+} sim_boot_result_t;
+
+typedef void (*sim_boot_fn_t)(sim_boot_result_t *result);
+
+typedef struct
+{
+    const char *name;
+    const char *description;
+    sim_boot_fn_t run;
+} sim_boot_flow_t;
+
+/* Completion recorded by the callback of the "callback" scenario */
+typedef struct
+{
+    volatile bool done;
+    srom_syscall_status_t status;
+    uint64_t done_ns;
+} sim_callback_record_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static syscall_ipc_sim_cfg_t sim_default_cfg;
+
+/* CPU time of the snapshot CRC, per byte */
+static uint64_t sim_crc_ns_per_byte = 500u;
+
+/* RMA certificate, only the header matters to the simulated SROM */
+static transit_rma_param_t sim_rma_param;
+
+/*******************************************************************************
+ * Function Name: sim_rma_init
+ *******************************************************************************
+ * Summary:
+ *  Fills the RMA parameters, the opcode is overwritten by each call.
+ *
+ *******************************************************************************/
+static void sim_rma_init(void)
+{
+    memset(&sim_rma_param, 0, sizeof(sim_rma_param));
+    sim_rma_param.opcode = CY_RMA_OPCODE;
+    sim_rma_param.obj_size = CY_RMA_OBJ_SIZE;
+    sim_rma_param.cmd_id = CY_RMA_CMD_ID;
+}
+
+/*******************************************************************************
+ * Function Name: sim_rma_call
+ *******************************************************************************
+ * Summary:
+ *  Sends the RMA transition as rma_transition() does and records the result.
+ *
+ *******************************************************************************/
+static void sim_rma_call(sim_result_t *result, uint32_t timeout_ms)
+{
+    sim_rma_init();
+    result->timeout_ms = timeout_ms;
+    result->start_ns = syscall_ipc_sim_now_ns();
+    result->status = srom_syscall_call(&sim_rma_param.opcode, timeout_ms);
+    result->seen_ns = syscall_ipc_sim_now_ns();
+    result->result = sim_rma_param.opcode;
+    result->polled = true;
+}
+
+/*******************************************************************************
+ * Function Name: sim_efuse_call
+ *******************************************************************************
+ * Summary:
+ *  Reads the lifecycle eFuse byte and records the result.
+ *
+ *******************************************************************************/
+static void sim_efuse_call(sim_result_t *result)
+{
+    uint8_t value = 0u;
+
+    result->timeout_ms = SROM_EFUSE_TIMEOUT_MS;
+    result->start_ns = syscall_ipc_sim_now_ns();
+    result->status = srom_syscall_read_efuse_byte(SIM_LIFECYCLE_EFUSE_BYTE, &value);
+    result->seen_ns = syscall_ipc_sim_now_ns();
+    result->result = value;
+}
+
+/*******************************************************************************
+ * Scenarios
+ *******************************************************************************/
+static void sim_scenario_efuse(sim_result_t *result)
+{
+    sim_efuse_call(result);
+    result->note = "result: eFuse byte";
+}
+
+static void sim_scenario_efuse_rtos(sim_result_t *result)
+{
+    syscall_ipc_sim_set_scheduler(true);
+    sim_efuse_call(result);
+    syscall_ipc_sim_set_scheduler(false);
+    result->note = "task notification";
+}
+
+static void sim_scenario_rma(sim_result_t *result)
+{
+    sim_rma_call(result, IPC_STATUS_WAIT_TIME_S * 1000u);
+}
+
+static void sim_scenario_rma_no_notify(sim_result_t *result)
+{
+    syscall_ipc_sim_cfg.release_notify = false;
+    sim_rma_call(result, IPC_STATUS_WAIT_TIME_S * 1000u);
+    result->note = "seen by the timer check";
+}
+
+static void sim_scenario_rma_fail(sim_result_t *result)
+{
+    syscall_ipc_sim_cfg.rma_status = 0xF0000009UL;
+    sim_rma_call(result, IPC_STATUS_WAIT_TIME_S * 1000u);
+    result->note = "SROM error status";
+}
+
+static void sim_scenario_timeout(sim_result_t *result)
+{
+    sim_result_t next;
+
+    syscall_ipc_sim_cfg.hang = true;
+    sim_rma_call(result, SIM_HANG_TIMEOUT_MS);
+    result->polled = false;
+
+    /* The IPC structure stays busy until the SROM releases it */
+    sim_efuse_call(&next);
+    syscall_ipc_sim_unhang();
+    syscall_ipc_sim_advance_ns(syscall_ipc_sim_cfg.rma_ns);
+    result->note = (next.status == SROM_SYSCALL_BUSY) ? "next call: busy" : "next call: not busy!";
+}
+
+static void sim_callback(srom_syscall_status_t status, void *arg)
+{
+    sim_callback_record_t *record = (sim_callback_record_t *)arg;
+
+    record->status = status;
+    record->done_ns = syscall_ipc_sim_now_ns();
+    record->done = true;
+}
+
+static void sim_scenario_callback(sim_result_t *result)
+{
+    sim_callback_record_t record = { 0 };
+    uint32_t slices = 0u;
+    static char note[64];
+
+    sim_rma_init();
+    result->timeout_ms = IPC_STATUS_WAIT_TIME_S * 1000u;
+    result->start_ns = syscall_ipc_sim_now_ns();
+    result->status = srom_syscall_submit(&sim_rma_param.opcode, result->timeout_ms, sim_callback, &record);
+
+    /* The caller keeps working while the SROM runs */
+    while ((result->status == SROM_SYSCALL_PENDING) && !record.done)
+    {
+        syscall_ipc_sim_advance_ns(SIM_CALLER_SLICE_NS);
+        slices++;
+    }
+    if (record.done)
+    {
+        result->status = record.status;
+        result->seen_ns = record.done_ns;
+    }
+    result->result = sim_rma_param.opcode;
+    result->polled = true;
+
+    snprintf(note, sizeof(note), "caller ran %" PRIu32 " ms", slices);
+    result->note = note;
+}
+
+static const sim_scenario_t sim_scenarios[] =
+{
+    { "efuse",          "Lifecycle eFuse byte, release interrupt",           sim_scenario_efuse },
+    { "efuse-rtos",     "Lifecycle eFuse byte from a task",                  sim_scenario_efuse_rtos },
+    { "rma",            "RMA transition, release interrupt",                 sim_scenario_rma },
+    { "rma-no-notify",  "RMA transition, no release event",                  sim_scenario_rma_no_notify },
+    { "rma-fail",       "RMA transition rejected by the SROM",               sim_scenario_rma_fail },
+    { "timeout",        "SROM does not answer",                              sim_scenario_timeout },
+    { "callback",       "RMA transition, completion callback",               sim_scenario_callback },
+};
+
+#define SIM_SCENARIO_COUNT              (sizeof(sim_scenarios) / sizeof(sim_scenarios[0]))
+
+/*******************************************************************************
+ * Function Name: sim_boot_begin
+ *******************************************************************************
+ * Summary:
+ *  Starts the measurement of the eFuse reads of one CPU.
+ *
+ *******************************************************************************/
+static void sim_boot_begin(sim_boot_cpu_t *cpu)
+{
+    cpu->calls = syscall_ipc_sim_stats.calls;
+    cpu->ns = syscall_ipc_sim_now_ns();
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_end
+ *******************************************************************************
+ * Summary:
+ *  Ends the measurement started by sim_boot_begin().
+ *
+ *******************************************************************************/
+static void sim_boot_end(sim_boot_cpu_t *cpu)
+{
+    cpu->calls = syscall_ipc_sim_stats.calls - cpu->calls;
+    cpu->ns = syscall_ipc_sim_now_ns() - cpu->ns;
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_crc
+ *******************************************************************************
+ * Summary:
+ *  Accounts for the CPU time of one CRC of the snapshot, which runs
+ *  instantly on the host.
+ *
+ *******************************************************************************/
+static void sim_boot_crc(void)
+{
+    syscall_ipc_sim_advance_ns((offsetof(cy_stc_ps_boot_efuse_t, crc) - offsetof(cy_stc_ps_boot_efuse_t, version)) *
+                               sim_crc_ns_per_byte);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_cm0p_bytes
+ *******************************************************************************
+ * Summary:
+ *  Bootloader before the snapshot: one Cy_EFUSE_GetEfuseByte() per byte.
+ *
+ *******************************************************************************/
+static void sim_boot_cm0p_bytes(sim_boot_result_t *result)
+{
+    uint8_t value;
+
+    sim_boot_begin(&result->cm0p);
+    for (uint32_t i = 0u; i < CY_PS_BOOT_EFUSE_COUNT; i++)
+    {
+        (void)Cy_EFUSE_GetEfuseByte(CY_PS_BOOT_EFUSE_OFFSET + i, &value);
+    }
+    sim_boot_end(&result->cm0p);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_cm0p_publish
+ *******************************************************************************
+ * Summary:
+ *  Bootloader with the snapshot: cy_ps_boot_efuse_publish().
+ *
+ *******************************************************************************/
+static void sim_boot_cm0p_publish(sim_boot_result_t *result)
+{
+    sim_boot_begin(&result->cm0p);
+    if (cy_ps_boot_efuse_publish() == CY_EFUSE_SUCCESS)
+    {
+        sim_boot_crc();
+    }
+    sim_boot_end(&result->cm0p);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_cm4_bits
+ *******************************************************************************
+ * Summary:
+ *  CM4 application before srom_syscall.c: one blocking Cy_EFUSE_GetEfuseBit()
+ *  per lifecycle stage.
+ *
+ *******************************************************************************/
+static void sim_boot_cm4_bits(sim_boot_result_t *result)
+{
+    static const uint32_t bits[] =
+    {
+        SIM_LIFECYCLE_BIT_NORMAL, SIM_LIFECYCLE_BIT_SECURE_DEBUG, SIM_LIFECYCLE_BIT_SECURE, SIM_LIFECYCLE_BIT_RMA
+    };
+    bool value;
+
+    sim_boot_begin(&result->cm4);
+    result->lifecycle = 0u;
+    for (uint32_t i = 0u; i < (sizeof(bits) / sizeof(bits[0])); i++)
+    {
+        (void)Cy_EFUSE_GetEfuseBit((SIM_LIFECYCLE_EFUSE_BYTE * 8u) + bits[i], &value);
+        result->lifecycle |= (uint8_t)((value ? 1u : 0u) << bits[i]);
+    }
+    sim_boot_end(&result->cm4);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_cm4_syscall
+ *******************************************************************************
+ * Summary:
+ *  CM4 application reading the lifecycle byte with srom_syscall.c.
+ *
+ *******************************************************************************/
+static void sim_boot_cm4_syscall(sim_boot_result_t *result)
+{
+    sim_boot_begin(&result->cm4);
+    (void)srom_syscall_read_efuse_byte(SIM_LIFECYCLE_EFUSE_BYTE, &result->lifecycle);
+    sim_boot_end(&result->cm4);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_cm4_snapshot
+ *******************************************************************************
+ * Summary:
+ *  CM4 application as in main.c: the snapshot if it is valid, otherwise
+ *  one srom_syscall.c read.
+ *
+ *******************************************************************************/
+static void sim_boot_cm4_snapshot(sim_boot_result_t *result)
+{
+    const cy_stc_ps_boot_efuse_t *boot_efuse = &CY_PS_BOOT_SHARED->efuse;
+
+    sim_boot_begin(&result->cm4);
+    if (cy_ps_boot_efuse_valid(boot_efuse))
+    {
+        result->lifecycle = boot_efuse->bytes[CY_PS_BOOT_EFUSE_LIFECYCLE];
+        result->note = "snapshot";
+    }
+    else
+    {
+        (void)srom_syscall_read_efuse_byte(SIM_LIFECYCLE_EFUSE_BYTE, &result->lifecycle);
+        result->note = "no valid snapshot, one SROM read";
+    }
+    if (boot_efuse->magic == CY_PS_BOOT_EFUSE_MAGIC)
+    {
+        sim_boot_crc();
+    }
+    sim_boot_end(&result->cm4);
+}
+
+/*******************************************************************************
+ * Boot flows
+ *******************************************************************************/
+static void sim_boot_blocking(sim_boot_result_t *result)
+{
+    sim_boot_cm0p_bytes(result);
+    sim_boot_cm4_bits(result);
+    result->note = "blocking byte and bit reads";
+}
+
+static void sim_boot_syscall(sim_boot_result_t *result)
+{
+    sim_boot_cm0p_bytes(result);
+    sim_boot_cm4_syscall(result);
+    result->note = "one srom_syscall read";
+}
+
+static void sim_boot_snapshot(sim_boot_result_t *result)
+{
+    sim_boot_cm0p_publish(result);
+    sim_boot_cm4_snapshot(result);
+}
+
+static void sim_boot_bad_crc(sim_boot_result_t *result)
+{
+    sim_boot_cm0p_publish(result);
+
+    /* Shared SRAM overwritten between the bootloader and the application */
+    CY_PS_BOOT_SHARED->efuse.bytes[CY_PS_BOOT_EFUSE_LIFECYCLE] ^= 0x08u;
+    sim_boot_cm4_snapshot(result);
+}
+
+static void sim_boot_read_error(sim_boot_result_t *result)
+{
+    /* The second bootloader read fails, no snapshot is published */
+    syscall_ipc_sim_cfg.efuse_error_offset = CY_PS_BOOT_EFUSE_OFFSET + 1u;
+    sim_boot_cm0p_publish(result);
+    syscall_ipc_sim_cfg.efuse_error_offset = SYSCALL_SIM_NO_EFUSE_ERROR;
+    sim_boot_cm4_snapshot(result);
+    result->partial = true;
+    result->note = "bootloader read failed, one SROM read";
+}
+
+static const sim_boot_flow_t sim_boot_flows[] =
+{
+    { "boot-blocking",   "5 blocking byte reads, then 4 blocking bit reads",  sim_boot_blocking },
+    { "boot-syscall",    "5 blocking byte reads, then 1 srom_syscall read",   sim_boot_syscall },
+    { "boot-snapshot",   "Bootloader publishes the snapshot",                 sim_boot_snapshot },
+    { "boot-bad-crc",    "Snapshot corrupted before the application",         sim_boot_bad_crc },
+    { "boot-read-error", "eFuse read error in the bootloader",                sim_boot_read_error },
+};
+
+#define SIM_BOOT_FLOW_COUNT             (sizeof(sim_boot_flows) / sizeof(sim_boot_flows[0]))
+
+/*******************************************************************************
+ * Function Name: sim_run_boot_flow
+ *******************************************************************************
+ * Summary:
+ *  Runs a boot flow from the default configuration, with uninitialized
+ *  shared SRAM, and prints its line. The time saved is relative to the
+ *  "boot-blocking" flow. It is not computed when the bootloader stopped its
+ *  reads early, as the flow then does less work than the baseline.
+ *
+ *******************************************************************************/
+static void sim_run_boot_flow(const sim_boot_flow_t *flow, uint64_t blocking_ns)
+{
+    sim_boot_result_t result = { .note = "" };
+    uint64_t total_ns;
+    char saved[16] = "n/a";
+
+    syscall_ipc_sim_cfg = sim_default_cfg;
+    syscall_ipc_sim_reset_stats();
+    memset(syscall_sim_shared_sram, 0xA5, sizeof(syscall_sim_shared_sram));
+
+    flow->run(&result);
+
+    total_ns = result.cm0p.ns + result.cm4.ns;
+    if (!result.partial)
+    {
+        (void)snprintf(saved, sizeof(saved), "%.1f", ((double)blocking_ns - (double)total_ns) / NS_PER_US);
+    }
+    printf("%-16s %5" PRIu32 " %9.1f %5" PRIu32 " %9.1f %9.1f %9s      0x%02X  %s\n", flow->name,
+           result.cm0p.calls, (double)result.cm0p.ns / NS_PER_US, result.cm4.calls,
+           (double)result.cm4.ns / NS_PER_US, (double)total_ns / NS_PER_US, saved,
+           result.lifecycle, result.note);
+}
+
+/*******************************************************************************
+ * Function Name: sim_boot_blocking_ns
+ *******************************************************************************
+ * Summary:
+ *  Time of the eFuse reads of the "boot-blocking" flow.
+ *
+ *******************************************************************************/
+static uint64_t sim_boot_blocking_ns(void)
+{
+    sim_boot_result_t result = { .note = "" };
+
+    syscall_ipc_sim_cfg = sim_default_cfg;
+    sim_boot_blocking(&result);
+    return result.cm0p.ns + result.cm4.ns;
+}
+
+/*******************************************************************************
+ * Function Name: sim_polled_ns
+ *******************************************************************************
+ * Summary:
+ *  Time the former loop, which checked the IPC structure then slept for one
+ *  second, took to see a completion, bounded by the timeout.
+ *
+ *******************************************************************************/
+static uint64_t sim_polled_ns(uint64_t done_ns, uint32_t timeout_ms)
+{
+    uint64_t polls = (done_ns + SIM_POLL_NS - 1u) / SIM_POLL_NS;
+    uint64_t limit = ((uint64_t)timeout_ms * NS_PER_MS + SIM_POLL_NS - 1u) / SIM_POLL_NS;
+
+    return ((polls < limit) ? polls : limit) * SIM_POLL_NS;
+}
+
+/*******************************************************************************
+ * Function Name: sim_run_scenario
+ *******************************************************************************
+ * Summary:
+ *  Runs a scenario from the default configuration and prints its line.
+ *
+ *******************************************************************************/
+static void sim_run_scenario(const sim_scenario_t *scenario)
+{
+    sim_result_t result = { .note = "" };
+    uint64_t srom_ns;
+    bool srom_done;
+
+    syscall_ipc_sim_cfg = sim_default_cfg;
+    syscall_ipc_sim_reset_stats();
+
+    scenario->run(&result);
+
+    /* The SROM completed the call before the caller returned */
+    srom_done = (syscall_ipc_sim_stats.calls > 0u) && (syscall_ipc_sim_stats.last_done_ns >= result.start_ns) &&
+                (syscall_ipc_sim_stats.last_done_ns <= result.seen_ns);
+    srom_ns = syscall_ipc_sim_stats.last_done_ns - result.start_ns;
+
+    printf("%-14s %-8s 0x%08" PRIX32, scenario->name, srom_syscall_status_name(result.status), result.result);
+    if (srom_done)
+    {
+        printf(" %12.3f", (double)srom_ns / NS_PER_MS);
+    }
+    else
+    {
+        printf(" %12s", "-");
+    }
+    printf(" %12.3f", (double)(result.seen_ns - result.start_ns) / NS_PER_MS);
+    if (srom_done)
+    {
+        printf(" %10.3f", (double)(result.seen_ns - result.start_ns - srom_ns) / NS_PER_MS);
+    }
+    else
+    {
+        printf(" %10s", "-");
+    }
+    printf(" %7" PRIu32 " %4" PRIu32 " %6" PRIu32, syscall_ipc_sim_stats.wakeups,
+           syscall_ipc_sim_stats.ipc_irqs, syscall_ipc_sim_stats.timer_irqs);
+    if (result.polled && srom_done)
+    {
+        printf(" %12.3f", (double)sim_polled_ns(srom_ns, result.timeout_ms) / NS_PER_MS);
+    }
+    else
+    {
+        printf(" %12s", "-");
+    }
+    printf("  %s\n", result.note);
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ *******************************************************************************/
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+           "  --scenario NAME   Run one scenario (default: all)\n"
+           "  --efuse-us N      SROM time of an eFuse byte read (default 20)\n"
+           "  --rma-ms N        SROM time of the RMA transition (default 1500)\n"
+           "  --crc-ns N        CPU time of the snapshot CRC per byte (default 500)\n"
+           "  --lifecycle 0xNN  Lifecycle eFuse byte (default 0x01, NORMAL)\n"
+           "  --list            List the scenarios\n", name);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *only = NULL;
+    bool found = false;
+    bool header = false;
+    uint64_t blocking_ns;
+
+    sim_default_cfg = syscall_ipc_sim_cfg;
+    sim_default_cfg.efuse[SIM_LIFECYCLE_EFUSE_BYTE] = 0x01u;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--scenario") == 0) && (i + 1 < argc))
+        {
+            only = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--efuse-us") == 0) && (i + 1 < argc))
+        {
+            sim_default_cfg.efuse_read_ns = strtoull(argv[++i], NULL, 0) * 1000u;
+        }
+        else if ((strcmp(argv[i], "--rma-ms") == 0) && (i + 1 < argc))
+        {
+            sim_default_cfg.rma_ns = strtoull(argv[++i], NULL, 0) * NS_PER_MS;
+        }
+        else if ((strcmp(argv[i], "--crc-ns") == 0) && (i + 1 < argc))
+        {
+            sim_crc_ns_per_byte = strtoull(argv[++i], NULL, 0);
+        }
+        else if ((strcmp(argv[i], "--lifecycle") == 0) && (i + 1 < argc))
+        {
+            sim_default_cfg.efuse[SIM_LIFECYCLE_EFUSE_BYTE] = (uint8_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            for (uint32_t s = 0; s < SIM_SCENARIO_COUNT; s++)
+            {
+                printf("%-16s %s\n", sim_scenarios[s].name, sim_scenarios[s].description);
+            }
+            for (uint32_t b = 0; b < SIM_BOOT_FLOW_COUNT; b++)
+            {
+                printf("%-16s %s\n", sim_boot_flows[b].name, sim_boot_flows[b].description);
+            }
+            return 0;
+        }
+        else
+        {
+            usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+
+    if (srom_syscall_init() != CY_RSLT_SUCCESS)
+    {
+        fprintf(stderr, "srom_syscall_init failed\n");
+        return 1;
+    }
+
+    for (uint32_t s = 0; s < SIM_SCENARIO_COUNT; s++)
+    {
+        if ((only == NULL) || (strcmp(only, sim_scenarios[s].name) == 0))
+        {
+            if (!header)
+            {
+                printf("%-14s %-8s %-10s %12s %12s %10s %7s %4s %6s %12s\n", "scenario", "status", "result",
+                       "srom_ms", "seen_ms", "late_ms", "wakeups", "ipc", "timer", "1s_poll_ms");
+                header = true;
+            }
+            sim_run_scenario(&sim_scenarios[s]);
+            found = true;
+        }
+    }
+
+    blocking_ns = sim_boot_blocking_ns();
+    header = false;
+    for (uint32_t b = 0; b < SIM_BOOT_FLOW_COUNT; b++)
+    {
+        if ((only == NULL) || (strcmp(only, sim_boot_flows[b].name) == 0))
+        {
+            if (!header)
+            {
+                printf("%s%-16s %5s %9s %5s %9s %9s %9s %9s  %s\n", found ? "\n" : "", "boot", "cm0p",
+                       "cm0p_us", "cm4", "cm4_us", "total_us", "saved_us", "lifecycle", "note");
+                header = true;
+            }
+            sim_run_boot_flow(&sim_boot_flows[b], blocking_ns);
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        fprintf(stderr, "Unknown scenario: %s\n", only);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */